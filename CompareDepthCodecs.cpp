@@ -0,0 +1,175 @@
+/***********************************************************************
+CompareDepthCodecs - Utility to compare compression ratios and encoding
+and decoding throughput of the available lossless depth frame codecs on
+a recorded depth frame file.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FrameWriter.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/DepthFrameWriter.h>
+#include <Kinect/DepthFrameReader.h>
+#include <Kinect/RansDepthFrameWriter.h>
+#include <Kinect/RansDepthFrameReader.h>
+#include <Kinect/SpatialDepthFrameWriter.h>
+#include <Kinect/SpatialDepthFrameReader.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
+#include <Kinect/KinectV1DepthFrameReader.h>
+
+struct CodecTest // Structure holding the state and statistics of one tested codec
+	{
+	/* Elements: */
+	public:
+	std::string name; // Codec name for reporting
+	std::string fileName; // Name of the temporary file receiving compressed frames
+	IO::FilePtr file; // Temporary file receiving compressed frames
+	Kinect::FrameWriter* writer; // Depth frame writer
+	Kinect::FrameReader* reader; // Depth frame reader
+	size_t compressedSize; // Total size of compressed frames in bytes
+	double encodeTime,decodeTime; // Total encoding and decoding times in seconds
+	unsigned int numMismatches; // Number of frames that did not survive the round trip unchanged
+	
+	/* Constructors and destructors: */
+	CodecTest(const char* sName,const char* sFileName)
+		:name(sName),fileName(sFileName),
+		 file(IO::openFile(sFileName,IO::File::ReadWrite)),
+		 writer(0),reader(0),
+		 compressedSize(0),encodeTime(0.0),decodeTime(0.0),
+		 numMismatches(0)
+		{
+		file->setEndianness(Misc::LittleEndian);
+		}
+	~CodecTest(void)
+		{
+		delete reader;
+		delete writer;
+		file=0;
+		unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	void testFrame(const Kinect::FrameBuffer& frame) // Compresses and decompresses the given frame
+		{
+		/* Compress the frame: */
+		Misc::Timer encodeTimer;
+		compressedSize+=writer->writeFrame(frame);
+		encodeTimer.elapse();
+		encodeTime+=encodeTimer.getTime();
+		file->flush();
+		
+		/* Decompress the frame: */
+		Misc::Timer decodeTimer;
+		Kinect::FrameBuffer decodedFrame=reader->readNextFrame();
+		decodeTimer.elapse();
+		decodeTime+=decodeTimer.getTime();
+		
+		/* Check that the round trip was lossless: */
+		if(decodedFrame.timeStamp!=frame.timeStamp||memcmp(decodedFrame.getData<Kinect::FrameSource::DepthPixel>(),frame.getData<Kinect::FrameSource::DepthPixel>(),frame.getSize().volume()*sizeof(Kinect::FrameSource::DepthPixel))!=0)
+			++numMismatches;
+		}
+	};
+
+int main(int argc,char* argv[])
+	{
+	if(argc<2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <depth frame file name> [<maximum number of frames>]"<<std::endl;
+		return 1;
+		}
+	
+	/* Open a compressed depth stream file: */
+	IO::FilePtr depthFrameFile(IO::openFile(argv[1]));
+	depthFrameFile->setEndianness(Misc::LittleEndian);
+	unsigned int maxNumFrames=argc>=3?atoi(argv[2]):~0U;
+	
+	/* Read the file header and create a depth frame reader for the file: */
+	Kinect::DepthFileHeader depthFileHeader(*depthFrameFile);
+	Kinect::FrameReader* depthFrameReader=depthFileHeader.createReader(*depthFrameFile);
+	Kinect::Size size=depthFrameReader->getSize();
+	std::cout<<"Reading "<<size[0]<<'x'<<size[1]<<" depth frames compressed with the "<<Kinect::getDepthFrameCodecName(depthFileHeader.codec)<<" codec"<<std::endl;
+	
+	/* Create the tested codecs: */
+	const int numCodecs=5;
+	CodecTest* codecs[numCodecs];
+	codecs[0]=new CodecTest("Huffman","CompareDepthCodecsHuffman.tmp");
+	codecs[0]->writer=new Kinect::DepthFrameWriter(*codecs[0]->file,size);
+	codecs[1]=new CodecTest("rANS static","CompareDepthCodecsRansStatic.tmp");
+	codecs[1]->writer=new Kinect::RansDepthFrameWriter(*codecs[1]->file,size,Kinect::RansDepthFrameWriter::STATIC_TABLES);
+	codecs[2]=new CodecTest("rANS per-frame","CompareDepthCodecsRansPerFrame.tmp");
+	codecs[2]->writer=new Kinect::RansDepthFrameWriter(*codecs[2]->file,size,Kinect::RansDepthFrameWriter::PER_FRAME_TABLES);
+	codecs[3]=new CodecTest("Spatial","CompareDepthCodecsSpatial.tmp");
+	codecs[3]->writer=new Kinect::SpatialDepthFrameWriter(*codecs[3]->file,size);
+	codecs[4]=new CodecTest("KinectV1","CompareDepthCodecsKinectV1.tmp");
+	codecs[4]->writer=new Kinect::KinectV1DepthFrameWriter(*codecs[4]->file,size);
+	for(int i=0;i<numCodecs;++i)
+		codecs[i]->file->flush();
+	codecs[0]->reader=new Kinect::DepthFrameReader(*codecs[0]->file);
+	codecs[1]->reader=new Kinect::RansDepthFrameReader(*codecs[1]->file);
+	codecs[2]->reader=new Kinect::RansDepthFrameReader(*codecs[2]->file);
+	codecs[3]->reader=new Kinect::SpatialDepthFrameReader(*codecs[3]->file);
+	codecs[4]->reader=new Kinect::KinectV1DepthFrameReader(*codecs[4]->file);
+	
+	/* Process all frames from the depth frame file: */
+	unsigned int numFrames=0;
+	while(numFrames<maxNumFrames&&!depthFrameFile->eof())
+		{
+		/* Read the next depth frame: */
+		Kinect::FrameBuffer frame=depthFrameReader->readNextFrame();
+		
+		/* Run the frame through all tested codecs: */
+		for(int i=0;i<numCodecs;++i)
+			codecs[i]->testFrame(frame);
+		++numFrames;
+		}
+	delete depthFrameReader;
+	
+	/* Print the results: */
+	double rawSize=double(numFrames)*double(size.volume())*double(sizeof(Kinect::FrameSource::DepthPixel));
+	std::cout<<numFrames<<" frames, "<<size_t(rawSize)<<" bytes uncompressed"<<std::endl;
+	std::cout<<std::setw(16)<<std::left<<"Codec"<<std::right<<std::setw(14)<<"Size"<<std::setw(10)<<"Ratio"<<std::setw(14)<<"Enc MB/s"<<std::setw(14)<<"Dec MB/s"<<std::setw(12)<<"Mismatches"<<std::endl;
+	std::cout<<std::fixed<<std::setprecision(2);
+	for(int i=0;i<numCodecs;++i)
+		{
+		std::cout<<std::setw(16)<<std::left<<codecs[i]->name<<std::right;
+		std::cout<<std::setw(14)<<codecs[i]->compressedSize;
+		std::cout<<std::setw(10)<<rawSize/double(codecs[i]->compressedSize);
+		std::cout<<std::setw(14)<<rawSize/(codecs[i]->encodeTime*1024.0*1024.0);
+		std::cout<<std::setw(14)<<rawSize/(codecs[i]->decodeTime*1024.0*1024.0);
+		std::cout<<std::setw(12)<<codecs[i]->numMismatches<<std::endl;
+		delete codecs[i];
+		}
+	
+	return 0;
+	}
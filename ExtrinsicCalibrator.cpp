@@ -68,6 +68,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/VRDeviceClient.h>
 #include <Kinect/Config.h>
 #include <Kinect/DirectFrameSource.h>
+#include <Kinect/Camera.h>
+#include <Kinect/GravityTracker.h>
 #include <Kinect/OpenDirectFrameSource.h>
 #include <Kinect/MultiplexedFrameSource.h>
 #include <Kinect/ProjectorType.h>
@@ -115,6 +117,9 @@ class ExtrinsicCalibrator:public Vrui::Application
 	
 	Kinect::FrameSource* camera; // 3D video source to calibrate
 	std::string cameraSerialNumber; // Camera's serial number if camera is a direct frame source; some dummy string otherwise
+	Kinect::GravityTracker* gravityTracker; // Tracker for the direction of gravity in camera space if the camera is a Kinect v1 camera and calibration is constrained by gravity; null otherwise
+	bool constrainByGravity; // Flag whether the current calibration's pitch and roll angles are constrained by the direction of gravity
+	Kinect::GravityTracker::Vector cameraUp; // Up direction in camera space used to constrain the current calibration
 	Kinect::DiskExtractor* diskExtractor; // Object to extract disk shapes from a 3D video stream
 	Kinect::ProjectorType* projector; // A projeftor to render the 3D video stream
 	GLMotif::PopupWindow* configurationDialog; // Dialog window to configure the extrinsic calibrator
@@ -168,6 +173,7 @@ class ExtrinsicCalibrator:public Vrui::Application
 	#if RUN_FULL_CALIBRATION
 	Calibration fullCalibration(const std::vector<FullCalibTiePoint>& tiePoints); // Calculates full calibration
 	#endif
+	void alignWithGravity(CameraTransform& transform,const std::vector<Point>& cameraPoints,const std::vector<Point>& trackerPoints,double& rms,double& linf) const; // Corrects the pitch and roll angles of the given camera transformation using the direction of gravity, and recalculates its residuals for the given point pairs
 	bool calcCameraTransform(void); // Calculates the extrinsic camera transformation; returns true if calibration was successful
 	
 	/* Constructors and destructors: */
@@ -861,6 +867,10 @@ ExtrinsicCalibrator::Calibration ExtrinsicCalibrator::fullCalibration(const std:
 		result.rms=ar.rms;
 		result.linf=ar.linf;
 		
+		/* Constrain the camera transformation's pitch and roll angles by the direction of gravity if requested: */
+		if(constrainByGravity)
+			alignWithGravity(result.cameraTransform,p0s,p1s,result.rms,result.linf);
+		
 		return result;
 		}
 	catch(const Math::Matrix::RankDeficientError&)
@@ -877,8 +887,35 @@ ExtrinsicCalibrator::Calibration ExtrinsicCalibrator::fullCalibration(const std:
 
 #endif
 
+void ExtrinsicCalibrator::alignWithGravity(ExtrinsicCalibrator::CameraTransform& transform,const std::vector<ExtrinsicCalibrator::Point>& cameraPoints,const std::vector<ExtrinsicCalibrator::Point>& trackerPoints,double& rms,double& linf) const
+	{
+	/* Rotate the transformation around the centroid of the tracker-space points to keep the fit centered on the data: */
+	Point::AffineCombiner centroidCombiner;
+	for(std::vector<Point>::const_iterator tpIt=trackerPoints.begin();tpIt!=trackerPoints.end();++tpIt)
+		centroidCombiner.addPoint(*tpIt);
+	transform=Kinect::GravityTracker::alignTransform(transform,cameraUp,Kinect::GravityTracker::Vector(Vrui::getUpDirection()),Kinect::GravityTracker::Point(centroidCombiner.getPoint()));
+	
+	/* Recalculate the alignment residuals: */
+	double sumDist2=0.0;
+	double maxDist2=0.0;
+	for(size_t i=0;i<cameraPoints.size();++i)
+		{
+		double dist2=Geometry::sqrDist(transform.transform(CameraTransform::Point(cameraPoints[i])),CameraTransform::Point(trackerPoints[i]));
+		sumDist2+=dist2;
+		if(maxDist2<dist2)
+			maxDist2=dist2;
+		}
+	rms=Math::sqrt(sumDist2/double(cameraPoints.size()));
+	linf=Math::sqrt(maxDist2);
+	}
+
 bool ExtrinsicCalibrator::calcCameraTransform(void)
 	{
+	/* Constrain the calibration by the current direction of gravity if it is known and the camera is not moving: */
+	constrainByGravity=gravityTracker!=0&&!movingCamera&&gravityTracker->hasUpDirection();
+	if(constrainByGravity)
+		cameraUp=gravityTracker->getUpDirection();
+	
 	#if RUN_FULL_CALIBRATION
 	
 	// std::cout<<"Calibration: "<<fullCalibTiePoints.size()<<" tie points";
@@ -971,6 +1008,20 @@ bool ExtrinsicCalibrator::calcCameraTransform(void)
 	/* Calculate the alignment transformation: */
 	cameraTransform=calcOGTransform(tiePoints);
 	
+	/* Constrain the alignment transformation's pitch and roll angles by the direction of gravity if requested: */
+	if(constrainByGravity)
+		{
+		std::vector<Point> p0s;
+		std::vector<Point> p1s;
+		for(std::vector<TiePoint>::const_iterator tpIt=tiePoints.begin();tpIt!=tiePoints.end();++tpIt)
+			{
+			p0s.push_back(tpIt->first);
+			p1s.push_back(tpIt->second);
+			}
+		double rms,linf;
+		alignWithGravity(cameraTransform,p0s,p1s,rms,linf);
+		}
+	
 	/* Calculate the residual: */
 	double rmsd=0.0;
 	for(std::vector<TiePoint>::const_iterator tpIt=tiePoints.begin();tpIt!=tiePoints.end();++tpIt)
@@ -987,6 +1038,7 @@ ExtrinsicCalibrator::ExtrinsicCalibrator(int& argc,char**& argv)
 	:Vrui::Application(argc,argv),
 	 deviceClient(0),trackerIndex(-1),buttonIndex(-1),
 	 diskCenter(Point::origin),
+	 gravityTracker(0),constrainByGravity(false),cameraUp(Kinect::GravityTracker::Vector::zero),
 	 configurationDialog(0),
 	 previousControllerIndex(-1),lastActiveControllerIndex(-1),
 	 calibratingDiskCenter(false),
@@ -997,6 +1049,7 @@ ExtrinsicCalibrator::ExtrinsicCalibrator(int& argc,char**& argv)
 	const char* serverName="localhost:8555";
 	Kinect::MultiplexedFrameSource* remoteSource=0;
 	int cameraIndex=0;
+	bool useGravity=false;
 	unsigned int projectorTriangleDepthRange=30;
 	for(int i=1;i<argc;++i)
 		{
@@ -1049,6 +1102,8 @@ ExtrinsicCalibrator::ExtrinsicCalibrator(int& argc,char**& argv)
 				++i;
 				projectorTriangleDepthRange=atoi(argv[i]);
 				}
+			else if(strcasecmp(argv[i]+1,"gravity")==0)
+				useGravity=true;
 			}
 		}
 	
@@ -1085,6 +1140,24 @@ ExtrinsicCalibrator::ExtrinsicCalibrator(int& argc,char**& argv)
 		Kinect::DirectFrameSource* directCamera=Kinect::openDirectFrameSource(cameraIndex,true);
 		camera=directCamera;
 		cameraSerialNumber=directCamera->getSerialNumber();
+		
+		/* Track the direction of gravity if requested and the camera is a Kinect v1 camera: */
+		Kinect::Camera* kinectCamera=dynamic_cast<Kinect::Camera*>(directCamera);
+		if(useGravity&&kinectCamera!=0)
+			{
+			try
+				{
+				/* Assume that motor devices are enumerated in the same order as camera devices: */
+				kinectCamera->startGravityTracking(cameraIndex);
+				gravityTracker=kinectCamera->getGravityTracker();
+				}
+			catch(const std::runtime_error& err)
+				{
+				Misc::formattedUserError("ExtrinsicCalibrator: Unable to track gravity due to exception %s",err.what());
+				}
+			}
+		else if(useGravity)
+			Misc::formattedConsoleWarning("ExtrinsicCalibrator: Gravity constraint requires a Kinect v1 camera");
 		}
 	
 	/* Create a disk extractor for the 3D video source: */
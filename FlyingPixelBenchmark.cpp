@@ -0,0 +1,127 @@
+/***********************************************************************
+FlyingPixelBenchmark - Utility to measure the effect of flying pixel
+removal on recorded 3D video streams, by triangulating each recorded
+depth frame with and without the flying pixel filter and reporting the
+number of eliminated triangles and the change in processing time.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/Projector.h>
+
+int main(int argc,char* argv[])
+	{
+	if(argc<2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <stream file name base> [<depth ratio> [<curvature> [<triangle depth range>]]]"<<std::endl;
+		return 1;
+		}
+	std::string colorFileName=argv[1];
+	colorFileName.append(".color");
+	std::string depthFileName=argv[1];
+	depthFileName.append(".depth");
+	double depthRatio=argc>=3?atof(argv[2]):0.04;
+	double curvature=argc>=4?atof(argv[3]):0.5;
+	int triangleDepthRange=argc>=5?atoi(argv[4]):-1;
+	
+	/* Create a projector without and a projector with flying pixel removal for the recording's depth camera: */
+	Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+	Kinect::Projector plainProjector(source);
+	Kinect::Projector filteredProjector(source);
+	filteredProjector.setRemoveFlyingPixels(true,depthRatio,curvature);
+	if(triangleDepthRange>=0)
+		{
+		plainProjector.setTriangleDepthRange(Kinect::FrameSource::DepthPixel(triangleDepthRange));
+		filteredProjector.setTriangleDepthRange(Kinect::FrameSource::DepthPixel(triangleDepthRange));
+		}
+	
+	/* Open the depth stream and skip its file header: */
+	IO::FilePtr depthFile=IO::openFile(depthFileName.c_str());
+	depthFile->setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
+	Kinect::FrameReader* depthReader=depthFileHeader.createReader(*depthFile);
+	
+	const Kinect::Size& depthSize=plainProjector.getDepthFrameSize();
+	std::cout<<"Triangulating "<<depthSize[0]<<'x'<<depthSize[1]<<" depth frames with depth ratio "<<depthRatio<<", curvature "<<curvature<<", and triangle depth range "<<plainProjector.getTriangleDepthRange()<<std::endl;
+	
+	/* Triangulate all depth frames with both projectors: */
+	unsigned int numFrames=0;
+	size_t numPlainTriangles=0,numFilteredTriangles=0;
+	size_t numRejectedPixels=0;
+	double plainTime=0.0,filteredTime=0.0;
+	Kinect::MeshBuffer plainMesh,filteredMesh;
+	Kinect::FrameBuffer depthFrame=depthReader->readNextFrame();
+	while(depthFrame.timeStamp!=Math::Constants<double>::max)
+		{
+		/* Triangulate the unfiltered depth frame: */
+		Misc::Timer plainTimer;
+		plainProjector.processDepthFrame(depthFrame,plainMesh);
+		plainTimer.elapse();
+		plainTime+=plainTimer.getTime();
+		numPlainTriangles+=plainMesh.numTriangles;
+		
+		/* Filter and triangulate the depth frame: */
+		Misc::Timer filteredTimer;
+		filteredProjector.processDepthFrame(depthFrame,filteredMesh);
+		filteredTimer.elapse();
+		filteredTime+=filteredTimer.getTime();
+		numFilteredTriangles+=filteredMesh.numTriangles;
+		numRejectedPixels+=filteredProjector.getNumFlyingPixels();
+		
+		/* Read the next depth frame: */
+		++numFrames;
+		depthFrame=depthReader->readNextFrame();
+		}
+	
+	/* Clean up: */
+	delete depthReader;
+	
+	/* Print the results: */
+	std::cout<<numFrames<<" depth frames"<<std::endl;
+	if(numFrames>0)
+		{
+		double nf=double(numFrames);
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Flying pixels removed: "<<double(numRejectedPixels)/nf<<" per frame ("<<100.0*double(numRejectedPixels)/(nf*double(depthSize.volume()))<<"% of all pixels)"<<std::endl;
+		std::cout<<"Triangles without filter: "<<double(numPlainTriangles)/nf<<" per frame"<<std::endl;
+		std::cout<<"Triangles with filter: "<<double(numFilteredTriangles)/nf<<" per frame"<<std::endl;
+		if(numPlainTriangles>0)
+			std::cout<<"Triangles eliminated: "<<double(numPlainTriangles-numFilteredTriangles)/nf<<" per frame ("<<100.0*(1.0-double(numFilteredTriangles)/double(numPlainTriangles))<<"%)"<<std::endl;
+		std::cout<<"Processing without filter: "<<plainTime*1000.0/nf<<" ms/frame"<<std::endl;
+		std::cout<<"Processing with filter: "<<filteredTime*1000.0/nf<<" ms/frame"<<std::endl;
+		std::cout<<"Time saved: "<<(plainTime-filteredTime)*1000.0/nf<<" ms/frame"<<std::endl;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,222 @@
+/***********************************************************************
+HoleFillingBenchmark - Utility to measure the effect of depth hole
+filling on recorded 3D video streams, by triangulating each recorded
+depth frame with and without hole filling and reporting the cost of
+filling and the resulting mesh statistics.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/DepthHoleFiller.h>
+#include <Kinect/Projector.h>
+
+typedef Kinect::FrameSource::DepthPixel DepthPixel;
+
+struct MeshStats // Structure to accumulate mesh statistics over a stream
+	{
+	/* Elements: */
+	public:
+	size_t numVertices; // Total number of valid pixels
+	size_t numTriangles; // Total number of generated triangles
+	size_t numComponents; // Total number of connected surface components
+	double time; // Total processing time in seconds
+	
+	/* Constructors and destructors: */
+	MeshStats(void)
+		:numVertices(0),numTriangles(0),numComponents(0),
+		 time(0.0)
+		{
+		}
+	};
+
+unsigned int findRoot(std::vector<unsigned int>& parents,unsigned int index) // Returns the root of the given pixel's component, compressing the path to it
+	{
+	unsigned int root=index;
+	while(parents[root]!=root)
+		root=parents[root];
+	while(parents[index]!=root)
+		{
+		unsigned int next=parents[index];
+		parents[index]=root;
+		index=next;
+		}
+	return root;
+	}
+
+void countComponents(const Kinect::FrameBuffer& depthFrame,DepthPixel triangleDepthRange,std::vector<unsigned int>& parents,MeshStats& stats) // Counts the valid pixels and the connected surface components in a depth frame
+	{
+	unsigned int width=depthFrame.getSize(0);
+	unsigned int height=depthFrame.getSize(1);
+	const DepthPixel* dPtr=depthFrame.getData<DepthPixel>();
+	const unsigned int maxValidDepth=Kinect::FrameSource::invalidDepth-1;
+	
+	/* Join each valid pixel with its left and upper neighbors if they are valid and within the triangle depth range: */
+	parents.resize(size_t(width)*size_t(height));
+	for(unsigned int y=0;y<height;++y)
+		for(unsigned int x=0;x<width;++x)
+			{
+			unsigned int index=y*width+x;
+			parents[index]=index;
+			unsigned int d=dPtr[index];
+			if(d>=maxValidDepth)
+				continue;
+			++stats.numVertices;
+			for(int n=0;n<2;++n)
+				{
+				if((n==0&&x==0)||(n==1&&y==0))
+					continue;
+				unsigned int nIndex=n==0?index-1:index-width;
+				unsigned int nd=dPtr[nIndex];
+				if(nd<maxValidDepth&&(nd>d?nd-d:d-nd)<=triangleDepthRange)
+					{
+					unsigned int r1=findRoot(parents,index);
+					unsigned int r2=findRoot(parents,nIndex);
+					if(r1!=r2)
+						parents[r1<r2?r2:r1]=r1<r2?r1:r2;
+					}
+				}
+			}
+	
+	/* Count the component roots: */
+	for(unsigned int index=0;index<width*height;++index)
+		if(dPtr[index]<maxValidDepth&&parents[index]==index)
+			++stats.numComponents;
+	}
+
+void printStats(const char* name,const MeshStats& stats,unsigned int numFrames) // Prints per-frame averages of the given mesh statistics
+	{
+	double nf=double(numFrames);
+	std::cout<<std::setw(16)<<std::left<<name<<std::right<<std::setw(14)<<double(stats.numVertices)/nf<<std::setw(14)<<double(stats.numTriangles)/nf<<std::setw(14)<<double(stats.numComponents)/nf<<std::setw(14)<<stats.time*1000.0/nf<<std::endl;
+	}
+
+int main(int argc,char* argv[])
+	{
+	if(argc<2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <stream file name base> [<max hole size> [<depth ratio> [<triangle depth range>]]]"<<std::endl;
+		return 1;
+		}
+	std::string colorFileName=argv[1];
+	colorFileName.append(".color");
+	std::string depthFileName=argv[1];
+	depthFileName.append(".depth");
+	unsigned int maxHoleSize=argc>=3?(unsigned int)(atoi(argv[2])):8U;
+	double depthRatio=argc>=4?atof(argv[3]):0.01;
+	int triangleDepthRange=argc>=5?atoi(argv[4]):-1;
+	
+	/* Create a projector without and a projector with hole filling for the recording's depth camera: */
+	Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+	Kinect::Projector plainProjector(source);
+	Kinect::Projector filledProjector(source);
+	filledProjector.setFillHoles(true,maxHoleSize,depthRatio);
+	if(triangleDepthRange>=0)
+		{
+		plainProjector.setTriangleDepthRange(DepthPixel(triangleDepthRange));
+		filledProjector.setTriangleDepthRange(DepthPixel(triangleDepthRange));
+		}
+	
+	/* Create a separate hole filler to measure the cost of hole filling by itself: */
+	Kinect::DepthHoleFiller holeFiller;
+	holeFiller.setMaxHoleSize(maxHoleSize);
+	holeFiller.setDepthRatio(depthRatio);
+	
+	/* Open the depth stream and skip its file header: */
+	IO::FilePtr depthFile=IO::openFile(depthFileName.c_str());
+	depthFile->setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
+	Kinect::FrameReader* depthReader=depthFileHeader.createReader(*depthFile);
+	
+	const Kinect::Size& depthSize=plainProjector.getDepthFrameSize();
+	DepthPixel tdr=plainProjector.getTriangleDepthRange();
+	std::cout<<"Triangulating "<<depthSize[0]<<'x'<<depthSize[1]<<" depth frames with maximum hole size "<<maxHoleSize<<", depth ratio "<<depthRatio<<", and triangle depth range "<<tdr<<std::endl;
+	
+	/* Triangulate all depth frames with both projectors: */
+	unsigned int numFrames=0;
+	size_t numFilledPixels=0;
+	double fillTime=0.0;
+	MeshStats plainStats,filledStats;
+	std::vector<unsigned int> parents;
+	Kinect::MeshBuffer plainMesh,filledMesh;
+	Kinect::FrameBuffer depthFrame=depthReader->readNextFrame();
+	while(depthFrame.timeStamp!=Math::Constants<double>::max)
+		{
+		/* Triangulate the unfilled depth frame: */
+		Misc::Timer plainTimer;
+		plainProjector.processDepthFrame(depthFrame,plainMesh);
+		plainTimer.elapse();
+		plainStats.time+=plainTimer.getTime();
+		plainStats.numTriangles+=plainMesh.numTriangles;
+		
+		/* Fill and triangulate the depth frame: */
+		Misc::Timer filledTimer;
+		filledProjector.processDepthFrame(depthFrame,filledMesh);
+		filledTimer.elapse();
+		filledStats.time+=filledTimer.getTime();
+		filledStats.numTriangles+=filledMesh.numTriangles;
+		
+		/* Fill the depth frame by itself to measure cost and analyze the filled surface: */
+		Misc::Timer fillTimer;
+		Kinect::FrameBuffer filledFrame=holeFiller.fill(depthFrame);
+		fillTimer.elapse();
+		fillTime+=fillTimer.getTime();
+		numFilledPixels+=holeFiller.getNumFilledPixels();
+		
+		/* Count the surface components in the unfilled and filled frames: */
+		countComponents(depthFrame,tdr,parents,plainStats);
+		countComponents(filledFrame,tdr,parents,filledStats);
+		
+		/* Read the next depth frame: */
+		++numFrames;
+		depthFrame=depthReader->readNextFrame();
+		}
+	
+	/* Clean up: */
+	delete depthReader;
+	
+	/* Print the results: */
+	std::cout<<numFrames<<" depth frames"<<std::endl;
+	if(numFrames>0)
+		{
+		double nf=double(numFrames);
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Holes filled: "<<double(numFilledPixels)/nf<<" pixels per frame ("<<100.0*double(numFilledPixels)/(nf*double(depthSize.volume()))<<"% of all pixels)"<<std::endl;
+		std::cout<<"Hole filling: "<<fillTime*1000.0/nf<<" ms/frame"<<std::endl;
+		std::cout<<std::setw(16)<<std::left<<"Per frame"<<std::right<<std::setw(14)<<"Vertices"<<std::setw(14)<<"Triangles"<<std::setw(14)<<"Components"<<std::setw(14)<<"Time (ms)"<<std::endl;
+		printStats("Without filling",plainStats,numFrames);
+		printStats("With filling",filledStats,numFrames);
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,535 @@
+/***********************************************************************
+InspectRecordings - Utility to scan recorded pairs of color and depth
+stream files without decompressing frames where possible, and report
+frame counts, time stamp gaps and jitter, compressed frame sizes, key
+frame positions, and time stamp skew between streams and cameras.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
+
+/**************
+Helper classes:
+**************/
+
+struct Options // Structure holding analysis and output settings
+	{
+	/* Elements: */
+	public:
+	double gapFactor; // Frame intervals longer than this multiple of the nominal interval are reported as gaps
+	double binWidth; // Width of jitter histogram bins in seconds
+	unsigned int maxListSize; // Maximum number of gaps and key frames listed per stream in text output
+	bool json; // Flag whether to write machine-readable output
+	};
+
+struct StreamScan // Structure holding the results of scanning one stream file
+	{
+	/* Elements: */
+	public:
+	static const int numHalfBins=5; // Number of jitter histogram bins on either side of the nominal interval; the outermost bins collect outliers
+	std::string fileName; // Name of the stream file
+	const char* streamType; // "color" or "depth"
+	std::string codecName; // Name of the stream's codec
+	Kinect::Size frameSize; // Size of the stream's frames
+	size_t headerSize; // Size of the file and stream headers in bytes
+	std::vector<double> timeStamps; // Time stamps of all frames in file order
+	std::vector<size_t> frameSizes; // Sizes of all compressed frames in bytes, including time stamps
+	std::vector<unsigned int> keyFrames; // Indices of all frames at which decompression can start
+	bool truncated; // Flag whether the stream file ended in the middle of a frame
+	double scanTime; // Time taken to scan the stream file in seconds
+	double nominalInterval; // Median interval between consecutive frames
+	double meanInterval; // Mean interval between consecutive frames
+	double intervalStdDev; // Standard deviation of intervals between consecutive frames
+	double minInterval,maxInterval; // Range of intervals between consecutive frames
+	unsigned int numBackwardSteps; // Number of frames whose time stamps are not later than their predecessors'
+	std::vector<unsigned int> gaps; // Indices of frames preceded by a gap
+	size_t numDroppedFrames; // Estimated number of frames lost in all gaps
+	size_t jitterHistogram[2*numHalfBins+1]; // Histogram of frame interval deviations from the nominal interval
+	size_t minFrameSize,maxFrameSize,totalFrameSize; // Compressed frame size statistics in bytes
+	bool hasMetadata; // Flag whether the stream's frames carry device metadata
+	size_t numFrameNumberGaps; // Number of frames whose device frame numbers do not follow their predecessors'
+	size_t numMissingFrameNumbers; // Total number of device frame numbers missing from the stream
+	size_t numFlaggedDrops; // Number of frames flagged by the device driver as following lost frames
+	size_t numCorruptedFrames; // Number of frames flagged by the device driver as partially lost in transfer
+	
+	/* Constructors and destructors: */
+	StreamScan(const std::string& sFileName,const char* sStreamType)
+		:fileName(sFileName),streamType(sStreamType),
+		 headerSize(0),truncated(false),scanTime(0.0),
+		 nominalInterval(0.0),meanInterval(0.0),intervalStdDev(0.0),minInterval(0.0),maxInterval(0.0),
+		 numBackwardSteps(0),numDroppedFrames(0),
+		 minFrameSize(0),maxFrameSize(0),totalFrameSize(0),
+		 hasMetadata(false),numFrameNumberGaps(0),numMissingFrameNumbers(0),numFlaggedDrops(0),numCorruptedFrames(0)
+		{
+		for(int i=0;i<2*numHalfBins+1;++i)
+			jitterHistogram[i]=0;
+		}
+	
+	/* Methods: */
+	double getDuration(void) const // Returns the time between the stream's first and last frames
+		{
+		return timeStamps.size()>=2?timeStamps.back()-timeStamps.front():0.0;
+		}
+	void scan(IO::SeekableFile& file,Kinect::FrameReader& reader) // Reads the time stamps, sizes, and key frame flags of all frames from the given stream file
+		{
+		Misc::Timer scanTimer;
+		frameSize=reader.getSize();
+		headerSize=size_t(file.getReadPos());
+		bool haveFrameNumber=false;
+		Misc::UInt32 lastFrameNumber=0;
+		try
+			{
+			while(true)
+				{
+				/* Skip the next frame: */
+				IO::SeekableFile::Offset frameBegin=file.getReadPos();
+				bool keyFrame;
+				double timeStamp=reader.skipNextFrame(keyFrame);
+				if(timeStamp==Math::Constants<double>::max)
+					break;
+				
+				if(keyFrame)
+					keyFrames.push_back(timeStamps.size());
+				timeStamps.push_back(timeStamp);
+				frameSizes.push_back(size_t(file.getReadPos()-frameBegin));
+				
+				if(hasMetadata)
+					{
+					/* Check the frame's device frame number and drop and corruption flags: */
+					const Kinect::FrameMetadata& md=reader.getLastMetadata();
+					if(md.flags&Kinect::FrameMetadata::HAS_FRAME_NUMBER)
+						{
+						if(haveFrameNumber&&md.frameNumber!=lastFrameNumber+1U)
+							{
+							++numFrameNumberGaps;
+							numMissingFrameNumbers+=size_t(Misc::UInt32(md.frameNumber-lastFrameNumber-1U));
+							}
+						lastFrameNumber=md.frameNumber;
+						haveFrameNumber=true;
+						}
+					if(md.flags&Kinect::FrameMetadata::DROPPED_BEFORE)
+						++numFlaggedDrops;
+					if(md.flags&Kinect::FrameMetadata::CORRUPTED)
+						++numCorruptedFrames;
+					}
+				}
+			}
+		catch(const std::runtime_error&)
+			{
+			/* The file ended in the middle of a frame; keep all complete frames: */
+			truncated=true;
+			}
+		scanTimer.elapse();
+		scanTime=scanTimer.getTime();
+		}
+	void analyze(const Options& options) // Calculates derived statistics
+		{
+		/* Calculate compressed frame size statistics: */
+		if(!frameSizes.empty())
+			{
+			minFrameSize=maxFrameSize=frameSizes.front();
+			for(std::vector<size_t>::iterator fsIt=frameSizes.begin();fsIt!=frameSizes.end();++fsIt)
+				{
+				if(minFrameSize>*fsIt)
+					minFrameSize=*fsIt;
+				if(maxFrameSize<*fsIt)
+					maxFrameSize=*fsIt;
+				totalFrameSize+=*fsIt;
+				}
+			}
+		
+		if(timeStamps.size()<2)
+			return;
+		
+		/* Calculate frame interval statistics: */
+		std::vector<double> intervals;
+		intervals.reserve(timeStamps.size()-1);
+		minInterval=maxInterval=timeStamps[1]-timeStamps[0];
+		double intervalSum=0.0;
+		double intervalSum2=0.0;
+		for(size_t i=1;i<timeStamps.size();++i)
+			{
+			double interval=timeStamps[i]-timeStamps[i-1];
+			intervals.push_back(interval);
+			if(interval<=0.0)
+				++numBackwardSteps;
+			if(minInterval>interval)
+				minInterval=interval;
+			if(maxInterval<interval)
+				maxInterval=interval;
+			intervalSum+=interval;
+			intervalSum2+=interval*interval;
+			}
+		double n=double(intervals.size());
+		meanInterval=intervalSum/n;
+		double variance=intervalSum2/n-meanInterval*meanInterval;
+		intervalStdDev=variance>0.0?Math::sqrt(variance):0.0;
+		
+		/* Use the median interval as the nominal interval, as it is not affected by gaps: */
+		std::vector<double> sortedIntervals=intervals;
+		std::nth_element(sortedIntervals.begin(),sortedIntervals.begin()+sortedIntervals.size()/2,sortedIntervals.end());
+		nominalInterval=sortedIntervals[sortedIntervals.size()/2];
+		
+		/* Find gaps and build the jitter histogram: */
+		for(size_t i=0;i<intervals.size();++i)
+			{
+			if(nominalInterval>0.0&&intervals[i]>nominalInterval*options.gapFactor)
+				{
+				gaps.push_back(i+1);
+				numDroppedFrames+=size_t(Math::floor(intervals[i]/nominalInterval+0.5))-1;
+				}
+			
+			int bin=int(Math::floor((intervals[i]-nominalInterval)/options.binWidth+0.5));
+			if(bin<-numHalfBins)
+				bin=-numHalfBins;
+			if(bin>numHalfBins)
+				bin=numHalfBins;
+			++jitterHistogram[bin+numHalfBins];
+			}
+		}
+	};
+
+struct Skew // Structure holding time stamp skew statistics between two streams
+	{
+	/* Elements: */
+	public:
+	std::string name; // Description of the pair of streams
+	size_t numPairs; // Number of matched frame pairs
+	double mean; // Mean signed time stamp difference
+	double meanAbs; // Mean absolute time stamp difference
+	double maxAbs; // Maximum absolute time stamp difference
+	
+	/* Constructors and destructors: */
+	Skew(const std::string& sName,const std::vector<double>& timeStamps0,const std::vector<double>& timeStamps1) // Matches each time stamp of the first stream with the nearest time stamp of the second stream
+		:name(sName),numPairs(0),mean(0.0),meanAbs(0.0),maxAbs(0.0)
+		{
+		if(timeStamps1.empty())
+			return;
+		
+		size_t j=0;
+		for(std::vector<double>::const_iterator tsIt=timeStamps0.begin();tsIt!=timeStamps0.end();++tsIt)
+			{
+			/* Advance in the second stream while that brings its time stamp closer: */
+			while(j+1<timeStamps1.size()&&Math::abs(timeStamps1[j+1]-*tsIt)<=Math::abs(timeStamps1[j]-*tsIt))
+				++j;
+			double diff=*tsIt-timeStamps1[j];
+			mean+=diff;
+			meanAbs+=Math::abs(diff);
+			if(maxAbs<Math::abs(diff))
+				maxAbs=Math::abs(diff);
+			++numPairs;
+			}
+		if(numPairs>0)
+			{
+			mean/=double(numPairs);
+			meanAbs/=double(numPairs);
+			}
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+Kinect::FrameReader* openColorStream(IO::SeekableFile& file,StreamScan& scan)
+	{
+	/* Read the file header: */
+	file.setEndianness(Misc::LittleEndian);
+	Kinect::ColorFileHeader header(file);
+	scan.codecName=Kinect::getColorFrameCodecName(header.codec);
+	scan.hasMetadata=Kinect::hasColorFrameMetadata(header.formatVersion);
+	
+	/* Create a color frame reader, which reads the codec's stream header: */
+	return header.createReader(file);
+	}
+
+Kinect::FrameReader* openDepthStream(IO::SeekableFile& file,StreamScan& scan)
+	{
+	/* Read the file header: */
+	file.setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader header(file);
+	scan.codecName=Kinect::getDepthFrameCodecName(header.codec);
+	scan.hasMetadata=Kinect::hasDepthFrameMetadata(header.formatVersion);
+	
+	/* Create a depth frame reader, which reads the codec's stream header: */
+	return header.createReader(file);
+	}
+
+void scanStream(StreamScan& scan,const Options& options)
+	{
+	IO::SeekableFilePtr file=IO::openSeekableFile(scan.fileName.c_str());
+	Kinect::FrameReader* reader=strcmp(scan.streamType,"color")==0?openColorStream(*file,scan):openDepthStream(*file,scan);
+	try
+		{
+		scan.scan(*file,*reader);
+		}
+	catch(...)
+		{
+		delete reader;
+		throw;
+		}
+	delete reader;
+	
+	scan.analyze(options);
+	}
+
+std::string jsonString(const std::string& s) // Returns the given string as a quoted JSON string
+	{
+	std::string result="\"";
+	for(std::string::const_iterator sIt=s.begin();sIt!=s.end();++sIt)
+		{
+		if(*sIt=='"'||*sIt=='\\')
+			result.push_back('\\');
+		if((unsigned char)(*sIt)>=0x20U)
+			result.push_back(*sIt);
+		}
+	result.push_back('"');
+	return result;
+	}
+
+void printText(const StreamScan& scan,const Options& options)
+	{
+	std::cout<<scan.fileName<<": "<<scan.streamType<<" stream, codec "<<scan.codecName<<", "<<scan.frameSize[0]<<'x'<<scan.frameSize[1]<<" frames";
+	if(scan.truncated)
+		std::cout<<", truncated";
+	std::cout<<std::endl;
+	
+	double nf=scan.timeStamps.empty()?1.0:double(scan.timeStamps.size());
+	std::cout<<std::fixed<<std::setprecision(3);
+	std::cout<<"  Frames: "<<scan.timeStamps.size()<<" over "<<scan.getDuration()<<" s";
+	if(scan.nominalInterval>0.0)
+		std::cout<<", nominal rate "<<1.0/scan.nominalInterval<<" Hz";
+	std::cout<<std::endl;
+	std::cout<<"  Intervals: nominal "<<scan.nominalInterval*1000.0<<" ms, mean "<<scan.meanInterval*1000.0<<" ms, std dev "<<scan.intervalStdDev*1000.0<<" ms, range "<<scan.minInterval*1000.0<<" - "<<scan.maxInterval*1000.0<<" ms"<<std::endl;
+	if(scan.numBackwardSteps>0)
+		std::cout<<"  Non-increasing time stamps: "<<scan.numBackwardSteps<<std::endl;
+	std::cout<<"  Gaps: "<<scan.gaps.size()<<", estimated "<<scan.numDroppedFrames<<" dropped frames"<<std::endl;
+	for(unsigned int i=0;i<scan.gaps.size()&&i<options.maxListSize;++i)
+		{
+		unsigned int frame=scan.gaps[i];
+		std::cout<<"    Before frame "<<frame<<" at "<<scan.timeStamps[frame]<<" s: "<<(scan.timeStamps[frame]-scan.timeStamps[frame-1])*1000.0<<" ms"<<std::endl;
+		}
+	if(scan.gaps.size()>options.maxListSize)
+		std::cout<<"    ..."<<std::endl;
+	if(scan.hasMetadata)
+		std::cout<<"  Device metadata: "<<scan.numFrameNumberGaps<<" frame number gaps with "<<scan.numMissingFrameNumbers<<" missing frames, "<<scan.numFlaggedDrops<<" frames after device drops, "<<scan.numCorruptedFrames<<" corrupted frames"<<std::endl;
+	
+	std::cout<<"  Jitter histogram (deviation from nominal interval):"<<std::endl;
+	for(int i=0;i<2*StreamScan::numHalfBins+1;++i)
+		{
+		double center=double(i-StreamScan::numHalfBins)*options.binWidth*1000.0;
+		std::cout<<"    "<<(i==0?"<=":i==2*StreamScan::numHalfBins?">=":"  ")<<std::setw(9)<<center<<" ms: "<<scan.jitterHistogram[i]<<std::endl;
+		}
+	
+	std::cout<<std::setprecision(2);
+	std::cout<<"  Frame sizes: mean "<<double(scan.totalFrameSize)/nf/1024.0<<" KB, range "<<double(scan.minFrameSize)/1024.0<<" - "<<double(scan.maxFrameSize)/1024.0<<" KB";
+	if(scan.getDuration()>0.0)
+		std::cout<<", "<<double(scan.totalFrameSize)*8.0/scan.getDuration()/1.0e6<<" Mbit/s";
+	std::cout<<std::endl;
+	if(scan.keyFrames.size()==scan.timeStamps.size())
+		std::cout<<"  Key frames: all"<<std::endl;
+	else
+		{
+		std::cout<<"  Key frames: "<<scan.keyFrames.size()<<" at frames";
+		for(unsigned int i=0;i<scan.keyFrames.size()&&i<options.maxListSize;++i)
+			std::cout<<' '<<scan.keyFrames[i];
+		if(scan.keyFrames.size()>options.maxListSize)
+			std::cout<<" ...";
+		std::cout<<std::endl;
+		}
+	std::cout<<"  Scan time: "<<scan.scanTime*1000.0<<" ms"<<std::endl;
+	}
+
+void printJson(const StreamScan& scan,const Options& options)
+	{
+	std::cout<<std::setprecision(9);
+	std::cout<<"    {\"file\": "<<jsonString(scan.fileName)<<", \"type\": \""<<scan.streamType<<"\", \"codec\": "<<jsonString(scan.codecName);
+	std::cout<<", \"width\": "<<scan.frameSize[0]<<", \"height\": "<<scan.frameSize[1]<<", \"truncated\": "<<(scan.truncated?"true":"false")<<','<<std::endl;
+	std::cout<<"     \"numFrames\": "<<scan.timeStamps.size()<<", \"duration\": "<<scan.getDuration();
+	std::cout<<", \"firstTimeStamp\": "<<(scan.timeStamps.empty()?0.0:scan.timeStamps.front())<<", \"lastTimeStamp\": "<<(scan.timeStamps.empty()?0.0:scan.timeStamps.back())<<','<<std::endl;
+	std::cout<<"     \"nominalInterval\": "<<scan.nominalInterval<<", \"meanInterval\": "<<scan.meanInterval<<", \"intervalStdDev\": "<<scan.intervalStdDev;
+	std::cout<<", \"minInterval\": "<<scan.minInterval<<", \"maxInterval\": "<<scan.maxInterval<<", \"numBackwardSteps\": "<<scan.numBackwardSteps<<','<<std::endl;
+	std::cout<<"     \"numDroppedFrames\": "<<scan.numDroppedFrames<<", \"gaps\": [";
+	for(size_t i=0;i<scan.gaps.size();++i)
+		{
+		unsigned int frame=scan.gaps[i];
+		std::cout<<(i>0?", ":"")<<"{\"frame\": "<<frame<<", \"timeStamp\": "<<scan.timeStamps[frame]<<", \"interval\": "<<scan.timeStamps[frame]-scan.timeStamps[frame-1]<<'}';
+		}
+	std::cout<<"],"<<std::endl;
+	if(scan.hasMetadata)
+		{
+		std::cout<<"     \"numFrameNumberGaps\": "<<scan.numFrameNumberGaps<<", \"numMissingFrameNumbers\": "<<scan.numMissingFrameNumbers;
+		std::cout<<", \"numFlaggedDrops\": "<<scan.numFlaggedDrops<<", \"numCorruptedFrames\": "<<scan.numCorruptedFrames<<','<<std::endl;
+		}
+	std::cout<<"     \"jitterBinWidth\": "<<options.binWidth<<", \"jitterHistogram\": [";
+	for(int i=0;i<2*StreamScan::numHalfBins+1;++i)
+		std::cout<<(i>0?", ":"")<<scan.jitterHistogram[i];
+	std::cout<<"],"<<std::endl;
+	std::cout<<"     \"headerSize\": "<<scan.headerSize<<", \"totalFrameSize\": "<<scan.totalFrameSize<<", \"minFrameSize\": "<<scan.minFrameSize<<", \"maxFrameSize\": "<<scan.maxFrameSize<<','<<std::endl;
+	std::cout<<"     \"keyFrames\": [";
+	for(size_t i=0;i<scan.keyFrames.size();++i)
+		std::cout<<(i>0?", ":"")<<scan.keyFrames[i];
+	std::cout<<"], \"scanTime\": "<<scan.scanTime<<'}';
+	}
+
+void printUsage(const char* appName)
+	{
+	std::cout<<"Usage: "<<appName<<" [ -gap <factor> ] [ -bin <width in ms> ] [ -list <max entries> ] [ -json ] <input file name base>+"<<std::endl;
+	std::cout<<"  Scans the color and depth stream files of each input recording and reports"<<std::endl;
+	std::cout<<"  per-stream frame counts, frame interval statistics, gaps where the interval"<<std::endl;
+	std::cout<<"  exceeds the given multiple of the nominal (median) interval (default 1.5),"<<std::endl;
+	std::cout<<"  a jitter histogram of interval deviations from the nominal interval with the"<<std::endl;
+	std::cout<<"  given bin width (default 2 ms), compressed frame sizes, and key frame"<<std::endl;
+	std::cout<<"  positions, followed by the time stamp skew between each recording's color and"<<std::endl;
+	std::cout<<"  depth streams and between the depth streams of the first and all other"<<std::endl;
+	std::cout<<"  recordings. Text output lists at most the given number of gaps and key"<<std::endl;
+	std::cout<<"  frames per stream (default 20); -json writes all results as a JSON document."<<std::endl;
+	std::cout<<"  Frames are skipped without decompression where the codec allows it."<<std::endl;
+	std::cout<<"  Recordings saved with per-frame device metadata additionally report device"<<std::endl;
+	std::cout<<"  frame number gaps and frames flagged as following drops or as corrupted."<<std::endl;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Options options;
+	options.gapFactor=1.5;
+	options.binWidth=0.002;
+	options.maxListSize=20;
+	options.json=false;
+	std::vector<std::string> inputs;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"gap")==0)
+				{
+				++i;
+				if(i<argc)
+					options.gapFactor=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"bin")==0)
+				{
+				++i;
+				if(i<argc)
+					options.binWidth=atof(argv[i])/1000.0;
+				}
+			else if(strcasecmp(argv[i]+1,"list")==0)
+				{
+				++i;
+				if(i<argc)
+					options.maxListSize=(unsigned int)(atoi(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"json")==0)
+				options.json=true;
+			else if(strcasecmp(argv[i]+1,"h")==0)
+				{
+				printUsage(argv[0]);
+				return 0;
+				}
+			else
+				std::cerr<<"Ignoring unrecognized command line option "<<argv[i]<<std::endl;
+			}
+		else
+			inputs.push_back(argv[i]);
+		}
+	if(inputs.empty()||options.gapFactor<=1.0||options.binWidth<=0.0)
+		{
+		printUsage(argv[0]);
+		return 1;
+		}
+	
+	/* Scan the color and depth streams of all input recordings: */
+	std::vector<StreamScan> scans;
+	for(std::vector<std::string>::iterator iIt=inputs.begin();iIt!=inputs.end();++iIt)
+		{
+		scans.push_back(StreamScan(*iIt+".color","color"));
+		scans.push_back(StreamScan(*iIt+".depth","depth"));
+		}
+	int result=0;
+	for(std::vector<StreamScan>::iterator sIt=scans.begin();sIt!=scans.end();++sIt)
+		{
+		try
+			{
+			scanStream(*sIt,options);
+			}
+		catch(const std::runtime_error& err)
+			{
+			std::cerr<<"Unable to scan "<<sIt->fileName<<" due to exception "<<err.what()<<std::endl;
+			result=1;
+			}
+		}
+	
+	/* Calculate time stamp skew between each recording's streams, and between the first and all other recordings: */
+	std::vector<Skew> skews;
+	for(size_t i=0;i<inputs.size();++i)
+		skews.push_back(Skew(inputs[i]+": depth - color",scans[2*i+1].timeStamps,scans[2*i].timeStamps));
+	for(size_t i=1;i<inputs.size();++i)
+		skews.push_back(Skew(inputs[i]+" depth - "+inputs[0]+" depth",scans[2*i+1].timeStamps,scans[1].timeStamps));
+	
+	/* Print the results: */
+	if(options.json)
+		{
+		std::cout<<"{"<<std::endl<<"  \"streams\": ["<<std::endl;
+		for(std::vector<StreamScan>::iterator sIt=scans.begin();sIt!=scans.end();++sIt)
+			{
+			printJson(*sIt,options);
+			std::cout<<(sIt+1!=scans.end()?",":"")<<std::endl;
+			}
+		std::cout<<"  ],"<<std::endl<<"  \"skews\": ["<<std::endl;
+		for(std::vector<Skew>::iterator sIt=skews.begin();sIt!=skews.end();++sIt)
+			{
+			std::cout<<"    {\"streams\": "<<jsonString(sIt->name)<<", \"numPairs\": "<<sIt->numPairs<<", \"mean\": "<<sIt->mean<<", \"meanAbs\": "<<sIt->meanAbs<<", \"maxAbs\": "<<sIt->maxAbs<<'}';
+			std::cout<<(sIt+1!=skews.end()?",":"")<<std::endl;
+			}
+		std::cout<<"  ]"<<std::endl<<"}"<<std::endl;
+		}
+	else
+		{
+		for(std::vector<StreamScan>::iterator sIt=scans.begin();sIt!=scans.end();++sIt)
+			printText(*sIt,options);
+		std::cout<<"Time stamp skew (nearest frames):"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(3);
+		for(std::vector<Skew>::iterator sIt=skews.begin();sIt!=skews.end();++sIt)
+			std::cout<<"  "<<sIt->name<<": mean "<<sIt->mean*1000.0<<" ms, mean absolute "<<sIt->meanAbs*1000.0<<" ms, max absolute "<<sIt->maxAbs*1000.0<<" ms over "<<sIt->numPairs<<" frames"<<std::endl;
+		}
+	
+	return result;
+	}
@@ -0,0 +1,188 @@
+/***********************************************************************
+BayerDemosaic - Functions to convert raw color frames in Bayer color
+filter array format to RGB color frames.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/BayerDemosaic.h>
+
+#include <string.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <Kinect/FrameBuffer.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int avg(unsigned int v1,unsigned int v2) // Returns the rounded-up average of two color components, like the SSE2 pavgb instruction
+	{
+	return (v1+v2+1U)>>1;
+	}
+
+void padRow(const FrameSource::ColorComponent* row,unsigned int width,FrameSource::ColorComponent* padded) // Copies a frame row into a buffer with one reflected pixel on either side
+	{
+	memcpy(padded+1,row,width);
+	padded[0]=row[1];
+	padded[width+1]=row[width-2];
+	}
+
+void interpolateRow(const FrameSource::ColorComponent* up,const FrameSource::ColorComponent* cur,const FrameSource::ColorComponent* down,unsigned int width,bool redRow,FrameSource::ColorComponent* planes[3]) // Interpolates the RGB planes of a row from padded rows
+	{
+	unsigned int x=0;
+	
+	#ifdef __SSE2__
+	
+	/* Interpolate blocks of 16 pixels: */
+	const __m128i even=_mm_set1_epi16(0x00ff); // Mask selecting pixels at even x positions
+	for(;x+16<=width;x+=16)
+		{
+		__m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i*>(cur+x));
+		__m128i h2=_mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cur+x-1)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(cur+x+1)));
+		__m128i v2=_mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up+x)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(down+x)));
+		__m128i cross=_mm_avg_epu8(h2,v2);
+		__m128i diagUp=_mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up+x-1)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(up+x+1)));
+		__m128i diagDown=_mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down+x-1)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(down+x+1)));
+		__m128i diag=_mm_avg_epu8(diagUp,diagDown);
+		
+		/* Select the interpolated values for even and odd pixels: */
+		__m128i rgb[3];
+		if(redRow)
+			{
+			rgb[0]=_mm_or_si128(_mm_and_si128(even,h2),_mm_andnot_si128(even,c));
+			rgb[1]=_mm_or_si128(_mm_and_si128(even,c),_mm_andnot_si128(even,cross));
+			rgb[2]=_mm_or_si128(_mm_and_si128(even,v2),_mm_andnot_si128(even,diag));
+			}
+		else
+			{
+			rgb[0]=_mm_or_si128(_mm_and_si128(even,diag),_mm_andnot_si128(even,v2));
+			rgb[1]=_mm_or_si128(_mm_and_si128(even,cross),_mm_andnot_si128(even,c));
+			rgb[2]=_mm_or_si128(_mm_and_si128(even,c),_mm_andnot_si128(even,h2));
+			}
+		for(int i=0;i<3;++i)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(planes[i]+x),rgb[i]);
+		}
+	
+	#endif
+	
+	/* Interpolate the remaining pixels: */
+	for(;x<width;++x)
+		{
+		const FrameSource::ColorComponent* uPtr=up+x;
+		const FrameSource::ColorComponent* cPtr=cur+x;
+		const FrameSource::ColorComponent* dPtr=down+x;
+		unsigned int c=cPtr[0];
+		unsigned int h2=avg(cPtr[-1],cPtr[1]);
+		unsigned int v2=avg(uPtr[0],dPtr[0]);
+		unsigned int cross=avg(h2,v2);
+		unsigned int diag=avg(avg(uPtr[-1],uPtr[1]),avg(dPtr[-1],dPtr[1]));
+		unsigned int rgb[3];
+		if(redRow)
+			{
+			if(x%2==0) // Green pixel between red pixels
+				{
+				rgb[0]=h2;
+				rgb[1]=c;
+				rgb[2]=v2;
+				}
+			else // Red pixel
+				{
+				rgb[0]=c;
+				rgb[1]=cross;
+				rgb[2]=diag;
+				}
+			}
+		else
+			{
+			if(x%2==0) // Blue pixel
+				{
+				rgb[0]=diag;
+				rgb[1]=cross;
+				rgb[2]=c;
+				}
+			else // Green pixel between blue pixels
+				{
+				rgb[0]=v2;
+				rgb[1]=c;
+				rgb[2]=h2;
+				}
+			}
+		for(int i=0;i<3;++i)
+			planes[i][x]=FrameSource::ColorComponent(rgb[i]);
+		}
+	}
+
+}
+
+void demosaicBayerBGGR(const FrameSource::ColorComponent* bayer,const Size& size,FrameSource::ColorPixel* rgb)
+	{
+	unsigned int width=size[0];
+	unsigned int height=size[1];
+	
+	/* Allocate three padded source rows and three interpolated color planes: */
+	std::vector<FrameSource::ColorComponent> buffer(size_t(width+2)*3+size_t(width)*3);
+	FrameSource::ColorComponent* paddedRows[3];
+	for(int i=0;i<3;++i)
+		paddedRows[i]=&buffer[0]+(width+2)*i;
+	FrameSource::ColorComponent* planes[3];
+	for(int i=0;i<3;++i)
+		planes[i]=&buffer[0]+(width+2)*3+width*i;
+	
+	/* Process all rows, reflecting rows across the frame's top and bottom edges: */
+	padRow(bayer+width,width,paddedRows[0]);
+	padRow(bayer,width,paddedRows[1]);
+	FrameSource::ColorPixel* rgbRow=rgb;
+	for(unsigned int y=0;y<height;++y,rgbRow+=width)
+		{
+		/* Pad the next row: */
+		unsigned int nextY=y+1<height?y+1:height-2;
+		padRow(bayer+size_t(nextY)*width,width,paddedRows[(y+2)%3]);
+		
+		/* Interpolate the row's color planes; even rows contain blue pixels, odd rows contain red pixels: */
+		interpolateRow(paddedRows[y%3]+1,paddedRows[(y+1)%3]+1,paddedRows[(y+2)%3]+1,width,(y&0x1U)!=0x0U,planes);
+		
+		/* Interleave the color planes into the result row: */
+		FrameSource::ColorPixel* rPtr=rgbRow;
+		for(unsigned int x=0;x<width;++x,++rPtr)
+			for(int i=0;i<3;++i)
+				(*rPtr)[i]=planes[i][x];
+		}
+	}
+
+FrameBuffer demosaicBayerFrame(const FrameBuffer& bayerFrame)
+	{
+	/* Create the result frame: */
+	FrameBuffer result(bayerFrame.getSize(),bayerFrame.getSize().volume()*sizeof(FrameSource::ColorPixel),MemoryAccounting::FRAME_FILTER);
+	result.timeStamp=bayerFrame.timeStamp;
+	result.metadata=bayerFrame.metadata;
+	
+	/* Demosaic the frame: */
+	demosaicBayerBGGR(bayerFrame.getData<FrameSource::ColorComponent>(),bayerFrame.getSize(),result.getData<FrameSource::ColorPixel>());
+	
+	return result;
+	}
+
+}
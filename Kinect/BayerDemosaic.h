@@ -0,0 +1,42 @@
+/***********************************************************************
+BayerDemosaic - Functions to convert raw color frames in Bayer color
+filter array format to RGB color frames.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_BAYERDEMOSAIC_INCLUDED
+#define KINECT_BAYERDEMOSAIC_INCLUDED
+
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+
+/* Forward declarations: */
+namespace Kinect {
+class FrameBuffer;
+}
+
+namespace Kinect {
+
+void demosaicBayerBGGR(const FrameSource::ColorComponent* bayer,const Size& size,FrameSource::ColorPixel* rgb); // Converts a frame of even width and height in BGGR Bayer pattern to RGB using bilinear interpolation; uses SSE2 where available
+FrameBuffer demosaicBayerFrame(const FrameBuffer& bayerFrame); // Returns a new RGB frame demosaiced from the given BGGR Bayer frame, with the same time stamp
+
+}
+
+#endif
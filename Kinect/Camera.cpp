@@ -38,6 +38,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <IO/Directory.h>
 #include <IO/FixedMemoryFile.h>
 #include <Math/Math.h>
+#include <Geometry/GeometryValueCoders.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Margin.h>
 #include <GLMotif/RowColumn.h>
@@ -46,6 +47,11 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GLMotif/TextFieldSlider.h>
 #include <Kinect/Internal/Config.h>
 #include <Kinect/FrameBuffer.h>
+#include <Kinect/Motor.h>
+#include <Kinect/GravityTracker.h>
+#include <Kinect/FloorPlaneRemover.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
+#include <Kinect/KinectV1DepthFrameReader.h>
 
 #define KINECT_CAMERA_DUMP_INIT 0
 
@@ -171,7 +177,8 @@ Camera::StreamingState::StreamingState(libusb_device_handle* handle,unsigned int
 	 transferBuffers(0),transfers(0),numActiveTransfers(0),
 	 frameSize(sFrameSize),rawFrameSize(sRawFrameSize),rawFrameBuffer(new unsigned char[rawFrameSize*2]),
 	 activeBuffer(0),writePtr(rawFrameBuffer),bufferSpace(rawFrameSize),
-	 readyFrame(0),cancelDecoding(false),
+	 haveSequenceNumber(false),nextSequenceNumber(0),frameCounter(0),
+	 readyFrame(0),readyFrameSize(0),lastFrameNumber(0),haveLastFrameNumber(false),cancelDecoding(false),
 	 streamingCallback(sStreamingCallback)
 	{
 	/* Initialize the streaming data structures: */
@@ -257,6 +264,10 @@ void Camera::StreamingState::transferCallback(libusb_transfer* transfer)
 				/* Parse the packet header: */
 				size_t payloadSize=packetSize-12*sizeof(unsigned char); // Each packet has a 12-byte header
 				int packetType=packetPtr[3]-thisPtr->packetFlagBase;
+				unsigned int sequenceNumber=packetPtr[5];
+				bool packetsLost=thisPtr->haveSequenceNumber&&sequenceNumber!=thisPtr->nextSequenceNumber;
+				thisPtr->haveSequenceNumber=true;
+				thisPtr->nextSequenceNumber=(sequenceNumber+1U)&0xffU;
 				
 				/* Check if this is the beginning of a new frame: */
 				if(packetType==0x01)
@@ -276,6 +287,18 @@ void Camera::StreamingState::transferCallback(libusb_transfer* transfer)
 					
 					/* Time-stamp the new frame: */
 					thisPtr->activeFrameTimeStamp=double(now-thisPtr->camera->timeBase);
+					
+					/* Start the new frame's metadata with its frame number and the camera's time stamp from the packet header: */
+					++thisPtr->frameCounter;
+					thisPtr->activeFrameMetadata=FrameMetadata();
+					thisPtr->activeFrameMetadata.frameNumber=thisPtr->frameCounter;
+					thisPtr->activeFrameMetadata.flags|=FrameMetadata::HAS_DEVICE_TIME_STAMP;
+					thisPtr->activeFrameMetadata.deviceTimeStamp=Misc::UInt64(packetPtr[8])|(Misc::UInt64(packetPtr[9])<<8)|(Misc::UInt64(packetPtr[10])<<16)|(Misc::UInt64(packetPtr[11])<<24);
+					}
+				else if(packetsLost)
+					{
+					/* Mark the current frame as corrupted: */
+					thisPtr->activeFrameMetadata.flags|=FrameMetadata::CORRUPTED;
 					}
 				
 				/* Check for a data packet: */
@@ -301,7 +324,9 @@ void Camera::StreamingState::transferCallback(libusb_transfer* transfer)
 						{
 						/* Submit the raw frame to the frame decoder: */
 						thisPtr->readyFrame=thisPtr->rawFrameBuffer+thisPtr->rawFrameSize*thisPtr->activeBuffer;
+						thisPtr->readyFrameSize=thisPtr->rawFrameSize-thisPtr->bufferSpace;
 						thisPtr->readyFrameTimeStamp=thisPtr->activeFrameTimeStamp;
+						thisPtr->readyFrameMetadata=thisPtr->activeFrameMetadata;
 						thisPtr->frameReadyCond.signal();
 						}
 					}
@@ -453,6 +478,7 @@ void* Camera::colorDecodingThreadMethod(void)
 		/* Wait for the next color frame: */
 		ColorComponent* framePtr;
 		double frameTimeStamp;
+		FrameMetadata frameMetadata;
 		{
 		Threads::MutexCond::Lock frameReadyLock(streamers[COLOR]->frameReadyCond);
 		while(!streamers[COLOR]->cancelDecoding&&streamers[COLOR]->readyFrame==0)
@@ -461,14 +487,35 @@ void* Camera::colorDecodingThreadMethod(void)
 			break;
 		framePtr=streamers[COLOR]->readyFrame;
 		frameTimeStamp=streamers[COLOR]->readyFrameTimeStamp;
+		frameMetadata=streamers[COLOR]->readyFrameMetadata;
 		streamers[COLOR]->readyFrame=0;
 		}
 		
-		/* Allocate a new decoded color buffer: */
+		/* Flag the frame if any frames were lost in transfer or overwritten before they could be decoded: */
+		frameMetadata.setFrameNumber(frameMetadata.frameNumber,streamers[COLOR]->lastFrameNumber,streamers[COLOR]->haveLastFrameNumber);
+		
 		unsigned int width=streamers[COLOR]->frameSize[0];
 		unsigned int height=streamers[COLOR]->frameSize[1];
-		FrameBuffer decodedFrame(streamers[COLOR]->frameSize,height*width*sizeof(ColorPixel));
+		if(bayerPassthrough)
+			{
+			/* Copy the raw color buffer into a new Bayer frame, flipping it vertically, which turns the GRBG pattern into BGGR: */
+			FrameBuffer bayerFrame(streamers[COLOR]->frameSize,height*width*sizeof(ColorComponent),MemoryAccounting::CAMERA);
+			bayerFrame.timeStamp=frameTimeStamp;
+			bayerFrame.metadata=frameMetadata;
+			const ColorComponent* rRowPtr=framePtr;
+			ColorComponent* bRowPtr=bayerFrame.getData<ColorComponent>()+(height-1)*width;
+			for(unsigned int y=0;y<height;++y,rRowPtr+=width,bRowPtr-=width)
+				memcpy(bRowPtr,rRowPtr,width*sizeof(ColorComponent));
+			
+			/* Pass the raw color buffer to the streaming callback function: */
+			(*streamers[COLOR]->streamingCallback)(bayerFrame);
+			continue;
+			}
+		
+		/* Allocate a new decoded color buffer: */
+		FrameBuffer decodedFrame(streamers[COLOR]->frameSize,height*width*sizeof(ColorPixel),MemoryAccounting::CAMERA);
 		decodedFrame.timeStamp=frameTimeStamp;
+		decodedFrame.metadata=frameMetadata;
 		
 		/* Decode the raw color buffer (which is in Bayer GRBG pattern): */
 		ptrdiff_t stride=width;
@@ -632,6 +679,7 @@ void* Camera::depthDecodingThreadMethod(void)
 		/* Wait for the next depth frame: */
 		Byte* framePtr;
 		double frameTimeStamp;
+		FrameMetadata frameMetadata;
 		{
 		Threads::MutexCond::Lock frameReadyLock(streamers[DEPTH]->frameReadyCond);
 		while(!streamers[DEPTH]->cancelDecoding&&streamers[DEPTH]->readyFrame==0)
@@ -640,14 +688,19 @@ void* Camera::depthDecodingThreadMethod(void)
 			break;
 		framePtr=streamers[DEPTH]->readyFrame;
 		frameTimeStamp=streamers[DEPTH]->readyFrameTimeStamp;
+		frameMetadata=streamers[DEPTH]->readyFrameMetadata;
 		streamers[DEPTH]->readyFrame=0;
 		}
 		
+		/* Flag the frame if any frames were lost in transfer or overwritten before they could be decoded: */
+		frameMetadata.setFrameNumber(frameMetadata.frameNumber,streamers[DEPTH]->lastFrameNumber,streamers[DEPTH]->haveLastFrameNumber);
+		
 		/* Allocate a new decoded depth buffer: */
 		unsigned int width=streamers[DEPTH]->frameSize[0];
 		unsigned int height=streamers[DEPTH]->frameSize[1];
-		FrameBuffer decodedFrame(streamers[DEPTH]->frameSize,height*width*sizeof(DepthPixel));
+		FrameBuffer decodedFrame(streamers[DEPTH]->frameSize,height*width*sizeof(DepthPixel),MemoryAccounting::CAMERA);
 		decodedFrame.timeStamp=frameTimeStamp;
+		decodedFrame.metadata=frameMetadata;
 		
 		/* Decode the raw depth buffer: */
 		Byte* sPtr=framePtr;
@@ -684,34 +737,6 @@ void* Camera::depthDecodingThreadMethod(void)
 	return 0;
 	}
 
-namespace {
-
-inline unsigned int getNybble(Misc::UInt8*& sPtr,bool& sFull)
-	{
-	unsigned int result;
-	if(sFull)
-		{
-		/* Return the high nybble: */
-		result=(*sPtr>>4)&0x0fU;
-		
-		/* Mark the high nybble read: */
-		sFull=false;
-		}
-	else
-		{
-		/* Return the low nybble: */
-		result=(*sPtr)&0x0fU;
-		
-		/* Go to the next source byte and mark the high nybble unread: */
-		++sPtr;
-		sFull=true;
-		}
-	
-	return result;
-	}
-
-}
-
 void* Camera::compressedDepthDecodingThreadMethod(void)
 	{
 	typedef Misc::UInt8 Byte;
@@ -720,7 +745,9 @@ void* Camera::compressedDepthDecodingThreadMethod(void)
 		{
 		/* Wait for the next depth frame: */
 		Byte* framePtr;
+		size_t frameDataSize;
 		double frameTimeStamp;
+		FrameMetadata frameMetadata;
 		{
 		Threads::MutexCond::Lock frameReadyLock(streamers[DEPTH]->frameReadyCond);
 		while(!streamers[DEPTH]->cancelDecoding&&streamers[DEPTH]->readyFrame==0)
@@ -728,87 +755,51 @@ void* Camera::compressedDepthDecodingThreadMethod(void)
 		if(streamers[DEPTH]->cancelDecoding)
 			break;
 		framePtr=streamers[DEPTH]->readyFrame;
+		frameDataSize=streamers[DEPTH]->readyFrameSize;
 		frameTimeStamp=streamers[DEPTH]->readyFrameTimeStamp;
+		frameMetadata=streamers[DEPTH]->readyFrameMetadata;
 		streamers[DEPTH]->readyFrame=0;
 		}
 		
-		/* Allocate a new decoded depth buffer: */
-		unsigned int width=streamers[DEPTH]->frameSize[0];
-		unsigned int height=streamers[DEPTH]->frameSize[1];
-		FrameBuffer decodedFrame(streamers[DEPTH]->frameSize,height*width*sizeof(DepthPixel));
-		decodedFrame.timeStamp=frameTimeStamp;
+		/* Flag the frame if any frames were lost in transfer or overwritten before they could be decoded: */
+		frameMetadata.setFrameNumber(frameMetadata.frameNumber,streamers[DEPTH]->lastFrameNumber,streamers[DEPTH]->haveLastFrameNumber);
 		
-		/* Decode the raw depth buffer: */
-		Byte* sPtr=framePtr;
-		bool sFull=true;
-		DepthPixel* dRowPtr=decodedFrame.getData<DepthPixel>();
-		dRowPtr+=width*(height-1);
+		/* Check whether background capture, background removal, or floor removal need decoded pixels: */
+		bool processFrame=backgroundCaptureNumFrames>0||removeBackground||removeFloor;
 		
-		/* Process rows: */
-		for(unsigned int y=0;y<height;++y,dRowPtr-=width) // Flip the depth image vertically
+		bool decode=true;
+		if(rawDepthStreamingCallback!=0&&deliverRawDepthFrames)
 			{
-			DepthPixel* dPtr=dRowPtr;
-			DepthPixel* dEnd=dPtr+width;
+			/* Pass a copy of the compressed depth frame to the raw streaming callback function: */
+			KinectV1RawDepthFrame rawFrame;
+			rawFrame.data=FrameBuffer(streamers[DEPTH]->frameSize,frameDataSize,MemoryAccounting::CAMERA);
+			rawFrame.data.timeStamp=frameTimeStamp;
+			rawFrame.data.metadata=frameMetadata;
+			memcpy(rawFrame.data.getData<Byte>(),framePtr,frameDataSize);
+			rawFrame.dataSize=frameDataSize;
+			rawFrame.removedPixels=removeBackground||removeFloor;
+			(*rawDepthStreamingCallback)(rawFrame);
 			
-			/* Process RLE/differential code groups from the raw depth stream: */
-			unsigned int lastPixel=invalidDepth;
-			while(dPtr!=dEnd)
-				{
-				/* Parse the next code group: */
-				unsigned int code=getNybble(sPtr,sFull);
-				if(code==0x0fU) // It's either a literal depth value or a large-step differential
-					{
-					unsigned int value=getNybble(sPtr,sFull);
-					if(value<0x08U) // It's a literal depth value
-						{
-						/* Read the rest of the literal depth value: */
-						for(int i=0;i<3;++i)
-							value=(value<<4)|getNybble(sPtr,sFull);
-						
-						/* Store the depth value: */
-						lastPixel=value;
-						*dPtr=DepthPixel(lastPixel);
-						++dPtr;
-						}
-					else // It's a large-step differential
-						{
-						/* Read the rest of the differential: */
-						value=(value<<4)|getNybble(sPtr,sFull);
-						
-						/* Calculate and store the depth value: */
-						lastPixel=(lastPixel+value)-0xc0U;
-						*dPtr=DepthPixel(lastPixel);
-						++dPtr;
-						}
-					}
-				else if(code==0x0eU) // It's an RLE span
-					{
-					/* Read the repetition count: */
-					unsigned int numReps=getNybble(sPtr,sFull)+1;
-					
-					/* Copy the last pixel value: */
-					while(numReps>0&&dPtr!=dEnd)
-						{
-						*dPtr=DepthPixel(lastPixel);
-						++dPtr;
-						--numReps;
-						}
-					}
-				else // It's a small-step differential
-					{
-					/* Calculate and store the depth value: */
-					lastPixel=(lastPixel+code)-0x06U;
-					*dPtr=DepthPixel(lastPixel);
-					++dPtr;
-					}
-				}
+			/* Skip decoding the frame unless the raw streaming callback's owner or frame processing need it: */
+			decode=decodeRawDepthFrames||processFrame;
 			}
 		
-		/* Handle background capture and removal: */
-		processDepthFrameBackground(decodedFrame);
-		
-		/* Pass the decoded depth buffer to the streaming callback function: */
-		(*streamers[DEPTH]->streamingCallback)(decodedFrame);
+		if(decode)
+			{
+			/* Allocate a new decoded depth buffer: */
+			FrameBuffer decodedFrame(streamers[DEPTH]->frameSize,streamers[DEPTH]->frameSize.volume()*sizeof(DepthPixel),MemoryAccounting::CAMERA);
+			decodedFrame.timeStamp=frameTimeStamp;
+			decodedFrame.metadata=frameMetadata;
+			
+			/* Decode the raw depth buffer: */
+			KinectV1DepthFrameReader::decodeFrame(framePtr,frameDataSize,streamers[DEPTH]->frameSize,decodedFrame.getData<DepthPixel>());
+			
+			/* Handle background capture and removal: */
+			processDepthFrameBackground(decodedFrame);
+			
+			/* Pass the decoded depth buffer to the streaming callback function: */
+			(*streamers[DEPTH]->streamingCallback)(decodedFrame);
+			}
 		}
 	
 	return 0;
@@ -956,7 +947,9 @@ Camera::Camera(libusb_device* sDevice)
 	:device(sDevice),
 	 needAltInterface(false),hasNearMode(false),
 	 messageSequenceNumber(0x2000U),
-	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0)
+	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0),bayerPassthrough(false),
+	 rawDepthStreamingCallback(0),decodeRawDepthFrames(true),deliverRawDepthFrames(true),
+	 gravityTracker(0),alignExtrinsicsWithGravity(false),worldUp(0,0,1)
 	 #if KINECT_CAMERA_DUMP_HEADERS
 	 ,headerFile(0)
 	 #endif
@@ -968,7 +961,9 @@ Camera::Camera(libusb_device* sDevice)
 Camera::Camera(size_t index)
 	:needAltInterface(false),hasNearMode(false),
 	 messageSequenceNumber(0x2000U),
-	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0)
+	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0),bayerPassthrough(false),
+	 rawDepthStreamingCallback(0),decodeRawDepthFrames(true),deliverRawDepthFrames(true),
+	 gravityTracker(0),alignExtrinsicsWithGravity(false),worldUp(0,0,1)
 	 #if KINECT_CAMERA_DUMP_HEADERS
 	 ,headerFile(0)
 	 #endif
@@ -986,7 +981,9 @@ Camera::Camera(size_t index)
 Camera::Camera(const char* serialNumber)
 	:needAltInterface(false),hasNearMode(false),
 	 messageSequenceNumber(0x2000U),
-	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0)
+	 compressDepthFrames(true),smoothDepthFrames(true),irIntensity(30U),nearMode(false),exposure(512),sharpening(0),bayerPassthrough(false),
+	 rawDepthStreamingCallback(0),decodeRawDepthFrames(true),deliverRawDepthFrames(true),
+	 gravityTracker(0),alignExtrinsicsWithGravity(false),worldUp(0,0,1)
 	 #if KINECT_CAMERA_DUMP_HEADERS
 	 ,headerFile(0)
 	 #endif
@@ -1022,6 +1019,12 @@ Camera::~Camera(void)
 	/* Stop streaming if necessary: */
 	if(streamers[0]!=0||streamers[1]!=0)
 		stopStreaming();
+	
+	/* Stop tracking gravity: */
+	delete gravityTracker;
+	
+	/* Delete the raw depth streaming callback: */
+	delete rawDepthStreamingCallback;
 	}
 
 FrameSource::DepthCorrection* Camera::getDepthCorrectionParameters(void)
@@ -1123,6 +1126,18 @@ FrameSource::IntrinsicParameters Camera::getIntrinsicParameters(void)
 	return result;
 	}
 
+FrameSource::ExtrinsicParameters Camera::getExtrinsicParameters(void)
+	{
+	/* Load the calibrated extrinsic parameters: */
+	ExtrinsicParameters result=DirectFrameSource::getExtrinsicParameters();
+	
+	/* Correct the calibrated pitch and roll angles if requested and the direction of gravity is known: */
+	if(alignExtrinsicsWithGravity&&gravityTracker!=0&&gravityTracker->hasUpDirection())
+		result=GravityTracker::alignTransform(result,gravityTracker->getUpDirection(),worldUp);
+	
+	return result;
+	}
+
 const Size& Camera::getActualFrameSize(int camera) const
 	{
 	static const Size actualFrameSizes[2]={Size(640,480),Size(1280,1024)};
@@ -1399,9 +1414,62 @@ void Camera::configure(Misc::ConfigurationFileSection& configFileSection)
 	if(hasNearMode)
 		setNearMode(configFileSection.retrieveValue<bool>("./nearMode",nearMode));
 	
+	/* Select raw Bayer color frame delivery: */
+	setBayerPassthrough(configFileSection.retrieveValue<bool>("./bayerPassthrough",bayerPassthrough));
+	
 	/* Set color camera exposure and sharpening values: */
 	setExposure(configFileSection.retrieveValue<unsigned int>("./colorExposure",getExposure()));
 	setSharpening(configFileSection.retrieveValue<unsigned int>("./colorSharpening",getSharpening()));
+	
+	/* Check whether to track the direction of gravity using the accelerometer in the Kinect's motor unit: */
+	unsigned int motorIndex=configFileSection.retrieveValue<unsigned int>("./motorIndex",0);
+	if(configFileSection.retrieveValue<bool>("./trackGravity",false))
+		{
+		try
+			{
+			startGravityTracking(motorIndex,configFileSection.retrieveValue<double>("./gravityFilterTime",1.0));
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Log an error message and carry on: */
+			Misc::formattedConsoleError("Kinect::Camera::configure: Unable to track gravity due to exception %s",err.what());
+			}
+		
+		/* Correct the extrinsic parameters' pitch and roll angles with the tracked direction of gravity: */
+		setAlignExtrinsicsWithGravity(configFileSection.retrieveValue<bool>("./alignExtrinsicsWithGravity",alignExtrinsicsWithGravity),configFileSection.retrieveValue<Geometry::Vector<double,3> >("./worldUpDirection",worldUp));
+		}
+	
+	/* Align floor detection with gravity as measured by the accelerometer in the Kinect's motor unit: */
+	if(getRemoveFloor()&&configFileSection.retrieveValue<bool>("./floorUseAccelerometer",false))
+		{
+		try
+			{
+			float accels[3];
+			if(gravityTracker!=0)
+				{
+				/* Wait briefly for the gravity tracker's first accelerometer reading: */
+				for(int i=0;i<50&&!gravityTracker->hasUpDirection();++i)
+					usleep(10000);
+				GravityTracker::Vector up=gravityTracker->getUpDirection();
+				for(int i=0;i<3;++i)
+					accels[i]=float(up[i]);
+				}
+			else
+				{
+				/* Read the accelerometer of the motor unit belonging to this camera: */
+				Motor motor(motorIndex);
+				motor.readAccelerometers(accels);
+				}
+			
+			/* The accelerometer's axes are aligned with camera space; the floor remover ignores the vector's sign: */
+			getFloorPlaneRemover().setUpDirection(FloorPlaneRemover::Vector(accels[0],accels[1],accels[2]));
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Log an error message and carry on: */
+			Misc::formattedConsoleError("Kinect::Camera::configure: Unable to read accelerometer due to exception %s",err.what());
+			}
+		}
 	}
 
 void Camera::buildSettingsDialog(GLMotif::RowColumn* settingsDialog)
@@ -1505,7 +1573,7 @@ void Camera::getCalibrationParameters(Camera::CalibrationParameters& calib)
 		IO::FixedMemoryFile replyBuffer(calibrationParameterReplySizes[subset]);
 		if(sendMessage(subset<3?0x0016U:0x0004U,cmdBuffer,subset<3?5:1,replyBuffer.getMemory(),calibrationParameterReplySizes[subset])!=calibrationParameterReplySizes[subset])
 			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Protocol error while requesting parameter subset");
-
+		
 		/* Extract the subset of calibration parameters: */
 		replyBuffer.skip<USBWord>(4); // Skip the reply header
 		replyBuffer.skip<USBWord>(1); // Skip the parameter set size
@@ -1581,6 +1649,56 @@ void Camera::setNearMode(bool newNearMode)
 		}
 	}
 
+void Camera::setBayerPassthrough(bool newBayerPassthrough)
+	{
+	/* Ignore the request while color streaming is active, as consumers rely on a fixed color space: */
+	if(streamers[COLOR]==0)
+		{
+		bayerPassthrough=newBayerPassthrough;
+		colorSpace=bayerPassthrough?BAYER_BGGR:RGB;
+		}
+	}
+
+void Camera::setRawDepthStreamingCallback(Camera::RawDepthStreamingCallback* newRawDepthStreamingCallback,bool newDecodeRawDepthFrames)
+	{
+	if(streamers[DEPTH]!=0)
+		{
+		delete newRawDepthStreamingCallback;
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Cannot change raw depth streaming callback while streaming");
+		}
+	
+	/* Replace the raw depth streaming callback: */
+	delete rawDepthStreamingCallback;
+	rawDepthStreamingCallback=newRawDepthStreamingCallback;
+	decodeRawDepthFrames=newDecodeRawDepthFrames;
+	}
+
+void Camera::setDeliverRawDepthFrames(bool newDeliverRawDepthFrames)
+	{
+	/* Set the flag; the depth decoding thread picks it up with the next frame: */
+	deliverRawDepthFrames=newDeliverRawDepthFrames;
+	}
+
+void Camera::startGravityTracking(size_t motorIndex,double filterTimeConstant)
+	{
+	if(gravityTracker==0)
+		{
+		/* Start tracking gravity: */
+		gravityTracker=new GravityTracker(motorIndex,filterTimeConstant);
+		}
+	else
+		{
+		/* Update the existing tracker's low-pass filter: */
+		gravityTracker->setFilterTimeConstant(filterTimeConstant);
+		}
+	}
+
+void Camera::setAlignExtrinsicsWithGravity(bool newAlignExtrinsicsWithGravity,const Geometry::Vector<double,3>& newWorldUp)
+	{
+	alignExtrinsicsWithGravity=newAlignExtrinsicsWithGravity;
+	worldUp=newWorldUp;
+	}
+
 unsigned int Camera::getExposure(void)
 	{
 	if(streamers[COLOR]!=0)
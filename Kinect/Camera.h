@@ -33,11 +33,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/MutexCond.h>
 #include <Threads/Thread.h>
 #include <USB/Device.h>
+#include <Geometry/Vector.h>
 #if KINECT_CAMERA_DUMP_HEADERS
 #include <IO/File.h>
 #endif
 #include <GLMotif/ToggleButton.h>
 #include <GLMotif/TextFieldSlider.h>
+#include <Kinect/FrameMetadata.h>
 #include <Kinect/DirectFrameSource.h>
 
 /* Forward declarations: */
@@ -53,6 +55,10 @@ class DeviceList;
 namespace IO {
 class File;
 }
+namespace Kinect {
+class GravityTracker;
+struct KinectV1RawDepthFrame;
+}
 
 namespace Kinect {
 
@@ -71,6 +77,8 @@ class Camera:public DirectFrameSource
 		FR_30_HZ // 30 Hz, only possible for 640x480 pixel frames
 		};
 	
+	typedef Misc::FunctionCall<const KinectV1RawDepthFrame&> RawDepthStreamingCallback; // Function call type for receiving depth frames in the camera's native compressed format
+	
 	struct CalibrationParameters // Structure to hold factory calibration parameters read from Kinect camera's non-volatile RAM
 		{
 		/* Elements: */
@@ -144,11 +152,19 @@ class Camera:public DirectFrameSource
 		double activeFrameTimeStamp; // Time stamp for the frame currently being received
 		unsigned char* writePtr; // Current write position in active buffer half
 		size_t bufferSpace; // Number of bytes still to be written into active buffer half
+		bool haveSequenceNumber; // Flag whether a packet has been received since streaming started
+		unsigned int nextSequenceNumber; // 8-bit sequence number expected for the next packet
+		Misc::UInt32 frameCounter; // Number of frames the camera started sending since streaming started
+		FrameMetadata activeFrameMetadata; // Metadata for the frame currently being received
 		
 		Threads::MutexCond frameReadyCond; // Condition variable to signal completion of a new frame to the decoding thread
 		bool readyFrameIntact; // Flag whether the completed frame was received intact
 		unsigned char* volatile readyFrame; // Pointer to buffer half containing the completed frame
+		size_t readyFrameSize; // Number of bytes received for the completed frame
 		double readyFrameTimeStamp; // Time stamp of completed frame
+		FrameMetadata readyFrameMetadata; // Metadata of completed frame
+		Misc::UInt32 lastFrameNumber; // Frame number of the most recently decoded frame, to detect frames lost before decoding
+		bool haveLastFrameNumber; // Flag whether a frame has been decoded since streaming started
 		volatile bool cancelDecoding; // Flag to cancel the deocding thread
 		Threads::Thread decodingThread; // Thread to decode raw frames into user-visible format
 		
@@ -185,7 +201,14 @@ class Camera:public DirectFrameSource
 	bool nearMode; // Flag if "near mode" is enabled on supporting camera devices
 	unsigned int exposure; // Color camera exposure value
 	unsigned int sharpening; // Color camera sharpening value for next streaming operation
+	bool bayerPassthrough; // Flag whether to deliver raw Bayer color frames instead of demosaicing them on capture
+	RawDepthStreamingCallback* rawDepthStreamingCallback; // Callback receiving compressed depth frames as sent by the camera, or null
+	bool decodeRawDepthFrames; // Flag whether depth frames delivered to the raw depth streaming callback are also decoded and passed to the depth streaming callback
+	volatile bool deliverRawDepthFrames; // Flag whether compressed depth frames are currently delivered to the raw depth streaming callback
 	StreamingState* streamers[2]; // Streaming states for color and depth frames
+	GravityTracker* gravityTracker; // Tracker for the direction of gravity using the accelerometer in the camera's motor unit, or null
+	bool alignExtrinsicsWithGravity; // Flag whether to correct pitch and roll of the extrinsic parameters using the tracked direction of gravity
+	Geometry::Vector<double,3> worldUp; // Up direction in world space used to correct the extrinsic parameters
 	
 	#if KINECT_CAMERA_DUMP_HEADERS
 	IO::FilePtr headerFile;
@@ -216,6 +239,7 @@ class Camera:public DirectFrameSource
 	/* Methods from class FrameSource: */
 	virtual DepthCorrection* getDepthCorrectionParameters(void);
 	virtual IntrinsicParameters getIntrinsicParameters(void);
+	virtual ExtrinsicParameters getExtrinsicParameters(void);
 	virtual const Size& getActualFrameSize(int sensor) const;
 	virtual DepthRange getDepthRange(void) const;
 	virtual void startStreaming(StreamingCallback* newColorStreamingCallback,StreamingCallback* newDepthStreamingCallback);
@@ -255,6 +279,19 @@ class Camera:public DirectFrameSource
 		return nearMode;
 		}
 	void setNearMode(bool newNearMode); // Enables or disables "near mode" for camera devices supporting it
+	bool getBayerPassthrough(void) const // Returns true if raw Bayer color frames are delivered
+		{
+		return bayerPassthrough;
+		}
+	void setBayerPassthrough(bool newBayerPassthrough); // Enables or disables delivery of raw Bayer color frames in BAYER_BGGR color space for the next streaming operation
+	void setRawDepthStreamingCallback(RawDepthStreamingCallback* newRawDepthStreamingCallback,bool newDecodeRawDepthFrames =true); // Sets a callback receiving each compressed depth frame as sent by the camera while depth compression is enabled; if the given flag is false, frames are only decoded and passed to the depth streaming callback afterwards while background capture, background removal, or floor removal need decoded pixels; camera adopts the callback object; must not be called while streaming
+	void setDeliverRawDepthFrames(bool newDeliverRawDepthFrames); // Enables or disables delivery of compressed depth frames to the raw depth streaming callback; disabled frames are always decoded; can be called while streaming
+	void startGravityTracking(size_t motorIndex,double filterTimeConstant =1.0); // Starts tracking the direction of gravity using the accelerometer in the index-th Kinect motor device
+	GravityTracker* getGravityTracker(void) // Returns the camera's gravity tracker, or null if gravity is not being tracked
+		{
+		return gravityTracker;
+		}
+	void setAlignExtrinsicsWithGravity(bool newAlignExtrinsicsWithGravity,const Geometry::Vector<double,3>& newWorldUp); // Enables or disables correcting pitch and roll of the extrinsic parameters such that tracked gravity points opposite to the given world-space up direction
 	
 	/* Control methods for the color camera: */
 	unsigned int getExposure(void); // Returns the color camera's exposure value
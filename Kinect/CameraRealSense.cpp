@@ -143,6 +143,10 @@ void handleStreamingError(rs_error* error)
 
 void* CameraRealSense::streamingThreadMethod(void)
 	{
+	/* Keep track of the camera's frame numbers to detect lost frames: */
+	Misc::UInt32 lastFrameNumbers[2]={0,0};
+	bool haveLastFrameNumbers[2]={false,false};
+	
 	try
 		{
 		while(runStreamingThread)
@@ -180,7 +184,7 @@ void* CameraRealSense::streamingThreadMethod(void)
 				handleStreamingError(error);
 				
 				/* Allocate a frame buffer and quantize and flip the depth frame: */
-				FrameBuffer depthFrame(frameSizes[1],frameSizes[1].volume()*sizeof(FrameSource::DepthPixel));
+				FrameBuffer depthFrame(frameSizes[1],frameSizes[1].volume()*sizeof(FrameSource::DepthPixel),MemoryAccounting::CAMERA);
 				depthFrame.timeStamp=timeStamp;
 				FrameSource::DepthPixel* dPtr=depthFrame.getData<FrameSource::DepthPixel>();
 				for(unsigned int y=0;y<frameSizes[1][1];++y,sRowPtr-=frameSizes[1][0])
@@ -195,6 +199,13 @@ void* CameraRealSense::streamingThreadMethod(void)
 						}
 					}
 				
+				/* Attach the camera's frame number and time stamp, converted from milliseconds to microseconds: */
+				depthFrame.metadata.setFrameNumber(Misc::UInt32(rs_get_frame_number(device,RS_STREAM_DEPTH,&error)),lastFrameNumbers[1],haveLastFrameNumbers[1]);
+				handleStreamingError(error);
+				depthFrame.metadata.flags|=FrameMetadata::HAS_DEVICE_TIME_STAMP;
+				depthFrame.metadata.deviceTimeStamp=Misc::UInt64(rs_get_frame_timestamp(device,RS_STREAM_DEPTH,&error)*1000.0+0.5);
+				handleStreamingError(error);
+				
 				/* Let the base class do its frame processing: */
 				processDepthFrameBackground(depthFrame);
 				
@@ -210,12 +221,19 @@ void* CameraRealSense::streamingThreadMethod(void)
 				handleStreamingError(error);
 				
 				/* Allocate a frame buffer and flip the color frame: */
-				FrameBuffer colorFrame(frameSizes[0],frameSizes[0].volume()*sizeof(FrameSource::ColorPixel));
+				FrameBuffer colorFrame(frameSizes[0],frameSizes[0].volume()*sizeof(FrameSource::ColorPixel),MemoryAccounting::CAMERA);
 				colorFrame.timeStamp=timeStamp;
 				FrameSource::ColorPixel* dRowPtr=colorFrame.getData<FrameSource::ColorPixel>();
 				for(unsigned int y=0;y<frameSizes[0][1];++y,sRowPtr-=frameSizes[0][0],dRowPtr+=frameSizes[0][0])
 					memcpy(dRowPtr,sRowPtr,frameSizes[0][0]*sizeof(FrameSource::ColorPixel));
 				
+				/* Attach the camera's frame number and time stamp, converted from milliseconds to microseconds: */
+				colorFrame.metadata.setFrameNumber(Misc::UInt32(rs_get_frame_number(device,RS_STREAM_COLOR,&error)),lastFrameNumbers[0],haveLastFrameNumbers[0]);
+				handleStreamingError(error);
+				colorFrame.metadata.flags|=FrameMetadata::HAS_DEVICE_TIME_STAMP;
+				colorFrame.metadata.deviceTimeStamp=Misc::UInt64(rs_get_frame_timestamp(device,RS_STREAM_COLOR,&error)*1000.0+0.5);
+				handleStreamingError(error);
+				
 				/* Call the streaming callback: */
 				(*colorStreamingCallback)(colorFrame);
 				}
@@ -0,0 +1,198 @@
+/***********************************************************************
+ColorFrameCodecs - Functions to select color frame compression codecs
+by their stream identifiers or names, and to create matching color
+frame writers and readers.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/ColorFrameCodecs.h>
+
+#include <string.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Video/Colorspaces.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/ColorFrameWriter.h>
+#include <Kinect/ColorFrameReader.h>
+#include <Kinect/LosslessColorFrameWriter.h>
+#include <Kinect/LosslessColorFrameReader.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* colorFrameCodecNames[COLOR_CODEC_NUM_CODECS]=
+	{
+	"Theora","Lossless"
+	};
+
+}
+
+const char* getColorFrameCodecName(ColorFrameCodec codec)
+	{
+	if(codec>=COLOR_CODEC_NUM_CODECS)
+		return "Unknown";
+	return colorFrameCodecNames[codec];
+	}
+
+ColorFrameCodec parseColorFrameCodec(const char* codecName)
+	{
+	for(int i=0;i<COLOR_CODEC_NUM_CODECS;++i)
+		if(strcasecmp(codecName,colorFrameCodecNames[i])==0)
+			return ColorFrameCodec(i);
+	
+	throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unknown color frame codec %s",codecName);
+	}
+
+unsigned int getColorFormatVersion(ColorFrameCodec codec,bool withMetadata)
+	{
+	/* Per-frame metadata was introduced in version 4: */
+	if(withMetadata)
+		return 4;
+	
+	/* Keep writing the previous format version for Theora streams so that older readers can read them: */
+	return codec==COLOR_CODEC_THEORA?2:3;
+	}
+
+bool hasColorFrameMetadata(unsigned int colorFormatVersion)
+	{
+	return colorFormatVersion>=4;
+	}
+
+ColorFrameCodec readColorFrameCodec(IO::File& source,unsigned int colorFormatVersion)
+	{
+	/* Streams before version 3 always used the Theora codec: */
+	if(colorFormatVersion<3)
+		return COLOR_CODEC_THEORA;
+	
+	/* Read the codec identifier: */
+	unsigned int codec=source.read<Misc::UInt8>();
+	if(codec>=COLOR_CODEC_NUM_CODECS)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unknown color frame codec %u",codec);
+	return ColorFrameCodec(codec);
+	}
+
+void writeColorFrameCodec(ColorFrameCodec codec,IO::File& sink,unsigned int colorFormatVersion)
+	{
+	if(colorFormatVersion>=3)
+		sink.write<Misc::UInt8>(Misc::UInt8(codec));
+	else if(codec!=COLOR_CODEC_THEORA)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s color frame codec requires color stream format version 3",getColorFrameCodecName(codec));
+	}
+
+FrameWriter* createColorFrameWriter(ColorFrameCodec codec,IO::File& sink,const Size& size,FrameSource::ColorSpace colorSpace)
+	{
+	switch(codec)
+		{
+		case COLOR_CODEC_THEORA:
+			return new ColorFrameWriter(sink,size,colorSpace);
+		
+		case COLOR_CODEC_LOSSLESS:
+			return new LosslessColorFrameWriter(sink,size,colorSpace);
+		
+		default:
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s color frame codec not supported",getColorFrameCodecName(codec));
+		}
+	}
+
+FrameReader* createColorFrameReader(ColorFrameCodec codec,IO::File& source)
+	{
+	switch(codec)
+		{
+		case COLOR_CODEC_THEORA:
+			return new ColorFrameReader(source);
+		
+		case COLOR_CODEC_LOSSLESS:
+			return new LosslessColorFrameReader(source);
+		
+		default:
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s color frame codec not supported",getColorFrameCodecName(codec));
+		}
+	}
+
+FrameSource::ColorSpace getColorSpace(const FrameReader& colorFrameReader)
+	{
+	/* Theora-compressed color frames are returned in Y'CbCr color space unless converted: */
+	const LosslessColorFrameReader* lcfr=dynamic_cast<const LosslessColorFrameReader*>(&colorFrameReader);
+	if(lcfr!=0)
+		return lcfr->getColorSpace();
+	else
+		return FrameSource::YPCBCR;
+	}
+
+void setConvertToRgb(FrameReader& colorFrameReader,bool newConvertToRgb)
+	{
+	LosslessColorFrameReader* lcfr=dynamic_cast<LosslessColorFrameReader*>(&colorFrameReader);
+	if(lcfr!=0)
+		lcfr->setConvertToRgb(newConvertToRgb);
+	else
+		{
+		ColorFrameReader* cfr=dynamic_cast<ColorFrameReader*>(&colorFrameReader);
+		if(cfr!=0)
+			cfr->setConvertToRgb(newConvertToRgb);
+		}
+	}
+
+FrameBuffer convertRgbFrame(const FrameBuffer& rgbFrame,FrameSource::ColorSpace colorSpace)
+	{
+	/* Return the frame itself if it is already in the requested color space: */
+	if(colorSpace==FrameSource::RGB)
+		return rgbFrame;
+	
+	const Size& size=rgbFrame.getSize();
+	const FrameSource::ColorPixel* rPtr=rgbFrame.getData<FrameSource::ColorPixel>();
+	if(colorSpace==FrameSource::BAYER_BGGR)
+		{
+		/* Create the result frame with a single component per pixel: */
+		FrameBuffer result(size,size.volume()*sizeof(FrameSource::ColorComponent),MemoryAccounting::FRAME_FILTER);
+		result.timeStamp=rgbFrame.timeStamp;
+		result.metadata=rgbFrame.metadata;
+		
+		/* Sample each pixel's component from the BGGR pattern; even rows contain blue pixels, odd rows contain red pixels: */
+		FrameSource::ColorComponent* bPtr=result.getData<FrameSource::ColorComponent>();
+		for(unsigned int y=0;y<size[1];++y)
+			for(unsigned int x=0;x<size[0];++x,++rPtr,++bPtr)
+				*bPtr=(*rPtr)[(y&0x1U)!=0x0U?((x&0x1U)!=0x0U?0:1):((x&0x1U)!=0x0U?1:2)];
+		
+		return result;
+		}
+	else
+		{
+		/* Create the result frame: */
+		FrameBuffer result(size,size.volume()*sizeof(FrameSource::ColorPixel),MemoryAccounting::FRAME_FILTER);
+		result.timeStamp=rgbFrame.timeStamp;
+		result.metadata=rgbFrame.metadata;
+		
+		/* Convert all pixels from RGB to Y'CbCr: */
+		FrameSource::ColorPixel* cPtr=result.getData<FrameSource::ColorPixel>();
+		FrameSource::ColorPixel* cEnd=cPtr+size.volume();
+		for(;cPtr!=cEnd;++rPtr,++cPtr)
+			Video::rgbToYpcbcr(rPtr->components,cPtr->components);
+		
+		return result;
+		}
+	}
+
+}
@@ -0,0 +1,64 @@
+/***********************************************************************
+ColorFrameCodecs - Functions to select color frame compression codecs
+by their stream identifiers or names, and to create matching color
+frame writers and readers.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_COLORFRAMECODECS_INCLUDED
+#define KINECT_COLORFRAMECODECS_INCLUDED
+
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+namespace Kinect {
+class FrameBuffer;
+class FrameWriter;
+class FrameReader;
+}
+
+namespace Kinect {
+
+enum ColorFrameCodec // Enumerated type for color frame codecs; values are stored in color stream headers and must never change
+	{
+	COLOR_CODEC_THEORA=0, // Lossy compression to Y'CbCr 4:2:0 using the Theora video codec
+	COLOR_CODEC_LOSSLESS, // Lossless compression using a reversible color transform, gradient prediction, and an interleaved rANS entropy coder
+	COLOR_CODEC_NUM_CODECS
+	};
+
+const char* getColorFrameCodecName(ColorFrameCodec codec); // Returns the name of the given color frame codec
+ColorFrameCodec parseColorFrameCodec(const char* codecName); // Returns the color frame codec of the given name; throws exception if the name is unknown
+unsigned int getColorFormatVersion(ColorFrameCodec codec,bool withMetadata =false); // Returns the lowest color stream format version that can represent the given codec, and per-frame metadata if requested
+bool hasColorFrameMetadata(unsigned int colorFormatVersion); // Returns true if frames in a color stream of the given format version carry metadata
+ColorFrameCodec readColorFrameCodec(IO::File& source,unsigned int colorFormatVersion); // Reads a color frame codec identifier from a color stream header of the given format version
+void writeColorFrameCodec(ColorFrameCodec codec,IO::File& sink,unsigned int colorFormatVersion); // Writes a color frame codec identifier to a color stream header of the given format version
+FrameWriter* createColorFrameWriter(ColorFrameCodec codec,IO::File& sink,const Size& size,FrameSource::ColorSpace colorSpace); // Creates a color frame writer using the given codec
+FrameReader* createColorFrameReader(ColorFrameCodec codec,IO::File& source); // Creates a color frame reader using the given codec
+FrameSource::ColorSpace getColorSpace(const FrameReader& colorFrameReader); // Returns the color space of frames returned by a color frame reader created by createColorFrameReader
+void setConvertToRgb(FrameReader& colorFrameReader,bool newConvertToRgb); // Sets the RGB conversion flag of a color frame reader created by createColorFrameReader
+FrameBuffer convertRgbFrame(const FrameBuffer& rgbFrame,FrameSource::ColorSpace colorSpace); // Returns a new frame converted from RGB to the given color space, sampling raw Bayer patterns from the RGB components, with the same time stamp and metadata
+
+}
+
+#endif
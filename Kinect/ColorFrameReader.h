@@ -54,6 +54,7 @@ class ColorFrameReader:public FrameReader
 	
 	/* Methods from FrameReader: */
 	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
 	
 	/* New methods: */
 	void setConvertToRgb(bool newConvertToRgb); // Sets the RGB color space conversion flag
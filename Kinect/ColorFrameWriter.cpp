@@ -34,9 +34,11 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Video/OggPage.h>
 #include <Video/TheoraInfo.h>
 #include <Video/TheoraComment.h>
+#include <theora/codec.h>
 #endif
 #include <Kinect/FrameBuffer.h>
 #include <Kinect/FrameSource.h>
+#include <Kinect/BayerDemosaic.h>
 
 namespace Kinect {
 
@@ -49,7 +51,8 @@ ColorFrameWriter::ColorFrameWriter(IO::File& sSink,const Size& sSize,FrameSource
 	 sink(sSink)
 	 #if VIDEO_CONFIG_HAVE_THEORA
 	 ,
-	 imageExtractor(0)
+	 imageExtractor(0),demosaic(sColorSpace==FrameSource::BAYER_BGGR),
+	 keyFrameRequested(false),keyFrame(true)
 	 #endif
 	{
 	/* Write the frame size to the sink: */
@@ -77,8 +80,8 @@ ColorFrameWriter::ColorFrameWriter(IO::File& sSink,const Size& sSize,FrameSource
 	/* Set the encoder to maximum speed: */
 	theoraEncoder.setSpeedLevel(theoraEncoder.getMaxSpeedLevel());
 	
-	/* Create the frame converter structures: */
-	if(sColorSpace==FrameSource::RGB)
+	/* Create the frame converter structures; raw Bayer frames are demosaiced to RGB before conversion: */
+	if(sColorSpace!=FrameSource::YPCBCR)
 		imageExtractor=new Video::ImageExtractorRGB8(size);
 	else
 		imageExtractor=new Video::ImageExtractorYpCbCr(size);
@@ -116,23 +119,37 @@ size_t ColorFrameWriter::writeFrame(const FrameBuffer& frame)
 	size_t result=0;
 	
 	/* Write the frame's time stamp to the sink: */
-	sink.write<Misc::Float64>(frame.timeStamp);
-	result+=sizeof(Misc::Float64);
+	result+=writeFrameHeader(sink,frame);
 	
 	#if VIDEO_CONFIG_HAVE_THEORA
 	
+	/* Demosaic the new frame if it is a raw Bayer frame: */
+	FrameBuffer rgbFrame=demosaic?demosaicBayerFrame(frame):frame;
+	
 	/* Convert the new raw RGB frame to Y'CbCr 4:2:0: */
 	Video::FrameBuffer tempFrame;
-	tempFrame.start=const_cast<FrameSource::ColorComponent*>(frame.getData<FrameSource::ColorComponent>()); // It's OK; Theora won't touch the frame, but has an API failure
+	tempFrame.start=const_cast<FrameSource::ColorComponent*>(rgbFrame.getData<FrameSource::ColorComponent>()); // It's OK; Theora won't touch the frame, but has an API failure
 	imageExtractor->extractYpCbCr420(&tempFrame,theoraFrame.planes[0].data,theoraFrame.planes[0].stride,theoraFrame.planes[1].data,theoraFrame.planes[1].stride,theoraFrame.planes[2].data,theoraFrame.planes[2].stride);
 	
-	/* Feed the converted Y'CbCr 4:2:0 frame to the Theora encoder: */
+	/* Feed the converted Y'CbCr 4:2:0 frame to the Theora encoder, temporarily forcing a key frame interval of one frame if a key frame was requested: */
+	if(keyFrameRequested)
+		theoraEncoder.setKeyframeFrequency(1);
 	theoraEncoder.encodeFrame(theoraFrame);
+	if(keyFrameRequested)
+		{
+		theoraEncoder.setKeyframeFrequency(64);
+		keyFrameRequested=false;
+		}
 	
 	/* Write all encoded Theora packets to the sink: */
+	keyFrame=false;
 	Video::TheoraPacket packet;
 	while(theoraEncoder.emitPacket(packet))
 		{
+		/* Check if the packet contains an intra-coded frame: */
+		if(th_packet_iskeyframe(&packet)>0)
+			keyFrame=true;
+		
 		/* Write the packet to the sink: */
 		packet.write(sink);
 		result+=packet.getWireSize();
@@ -143,4 +160,20 @@ size_t ColorFrameWriter::writeFrame(const FrameBuffer& frame)
 	return result;
 	}
 
+bool ColorFrameWriter::wasKeyFrame(void) const
+	{
+	#if VIDEO_CONFIG_HAVE_THEORA
+	return keyFrame;
+	#else
+	return true;
+	#endif
+	}
+
+void ColorFrameWriter::requestKeyFrame(void)
+	{
+	#if VIDEO_CONFIG_HAVE_THEORA
+	keyFrameRequested=true;
+	#endif
+	}
+
 }
@@ -53,7 +53,10 @@ class ColorFrameWriter:public FrameWriter
 	Video::TheoraEncoder theoraEncoder; // Theora encoder object
 	Video::ImageExtractor* imageExtractor; // Extractor to convert RGB or Y'CbCr 4:4:4 images to Y'CbCr 4:2:0 images
 	Video::TheoraFrame theoraFrame; // Frame buffer for frames in Y'CbCr 4:2:0 pixel format
+	bool demosaic; // Flag whether source frames are raw Bayer frames that need to be demosaiced before encoding
+	bool keyFrameRequested; // Flag whether the next frame must be intra-coded
 	#endif
+	bool keyFrame; // Flag whether the most recently written frame was an intra-coded Theora frame
 	
 	/* Constructors and destructors: */
 	public:
@@ -62,6 +65,8 @@ class ColorFrameWriter:public FrameWriter
 	
 	/* Methods from frameWriter: */
 	virtual size_t writeFrame(const FrameBuffer& frame);
+	virtual bool wasKeyFrame(void) const;
+	virtual void requestKeyFrame(void);
 	};
 
 }
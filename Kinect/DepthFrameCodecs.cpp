@@ -0,0 +1,183 @@
+/***********************************************************************
+DepthFrameCodecs - Functions to select depth frame compression codecs
+by their stream identifiers or names, and to create matching depth
+frame writers and readers.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/DepthFrameCodecs.h>
+
+#include <string.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Video/Config.h>
+#include <Kinect/DepthFrameWriter.h>
+#include <Kinect/DepthFrameReader.h>
+#include <Kinect/LossyDepthFrameWriter.h>
+#include <Kinect/LossyDepthFrameReader.h>
+#include <Kinect/RansDepthFrameWriter.h>
+#include <Kinect/RansDepthFrameReader.h>
+#include <Kinect/SpatialDepthFrameWriter.h>
+#include <Kinect/SpatialDepthFrameReader.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
+#include <Kinect/KinectV1DepthFrameReader.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* depthFrameCodecNames[DEPTH_CODEC_NUM_CODECS]=
+	{
+	"Huffman","Theora","Rans","Spatial","KinectV1"
+	};
+
+}
+
+const char* getDepthFrameCodecName(DepthFrameCodec codec)
+	{
+	if(codec>=DEPTH_CODEC_NUM_CODECS)
+		return "Unknown";
+	return depthFrameCodecNames[codec];
+	}
+
+DepthFrameCodec parseDepthFrameCodec(const char* codecName)
+	{
+	for(int i=0;i<DEPTH_CODEC_NUM_CODECS;++i)
+		if(strcasecmp(codecName,depthFrameCodecNames[i])==0)
+			return DepthFrameCodec(i);
+	
+	throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unknown depth frame codec %s",codecName);
+	}
+
+bool isDepthFrameCodecSupported(DepthFrameCodec codec)
+	{
+	switch(codec)
+		{
+		case DEPTH_CODEC_HUFFMAN:
+		case DEPTH_CODEC_RANS:
+		case DEPTH_CODEC_SPATIAL:
+		case DEPTH_CODEC_KINECTV1:
+			return true;
+		
+		case DEPTH_CODEC_THEORA:
+			#if VIDEO_CONFIG_HAVE_THEORA
+			return true;
+			#else
+			return false;
+			#endif
+		
+		default:
+			return false;
+		}
+	}
+
+unsigned int getDepthFormatVersion(DepthFrameCodec codec,bool withMetadata)
+	{
+	/* Per-frame metadata and codec identifiers beyond the old lossy compression flag were both introduced in version 7: */
+	if(withMetadata||codec>DEPTH_CODEC_THEORA)
+		return 7;
+	
+	/* Keep writing the previous format version for Huffman and Theora streams so that older readers can read them: */
+	return 6;
+	}
+
+bool hasDepthFrameMetadata(unsigned int depthFormatVersion)
+	{
+	return depthFormatVersion>=7;
+	}
+
+DepthFrameCodec readDepthFrameCodec(IO::File& source,unsigned int depthFormatVersion)
+	{
+	/* Streams before version 3 always used the Huffman codec: */
+	if(depthFormatVersion<3)
+		return DEPTH_CODEC_HUFFMAN;
+	
+	/* Read the codec identifier, which is a flag for lossy compression before version 7: */
+	unsigned int codec=source.read<Misc::UInt8>();
+	if(codec>=DEPTH_CODEC_NUM_CODECS||(depthFormatVersion<7&&codec>DEPTH_CODEC_THEORA))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unknown depth frame codec %u in depth stream format version %u",codec,depthFormatVersion);
+	return DepthFrameCodec(codec);
+	}
+
+void writeDepthFrameCodec(DepthFrameCodec codec,IO::File& sink,unsigned int depthFormatVersion)
+	{
+	if(depthFormatVersion<7&&codec>DEPTH_CODEC_THEORA)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s depth frame codec requires depth stream format version 7",getDepthFrameCodecName(codec));
+	sink.write<Misc::UInt8>(Misc::UInt8(codec));
+	}
+
+FrameWriter* createDepthFrameWriter(DepthFrameCodec codec,IO::File& sink,const Size& size)
+	{
+	switch(codec)
+		{
+		case DEPTH_CODEC_HUFFMAN:
+			return new DepthFrameWriter(sink,size);
+		
+		#if VIDEO_CONFIG_HAVE_THEORA
+		case DEPTH_CODEC_THEORA:
+			return new LossyDepthFrameWriter(sink,size);
+		#endif
+		
+		case DEPTH_CODEC_RANS:
+			return new RansDepthFrameWriter(sink,size);
+		
+		case DEPTH_CODEC_SPATIAL:
+			return new SpatialDepthFrameWriter(sink,size);
+		
+		case DEPTH_CODEC_KINECTV1:
+			return new KinectV1DepthFrameWriter(sink,size);
+		
+		default:
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s depth frame codec not supported",getDepthFrameCodecName(codec));
+		}
+	}
+
+FrameReader* createDepthFrameReader(DepthFrameCodec codec,IO::File& source)
+	{
+	switch(codec)
+		{
+		case DEPTH_CODEC_HUFFMAN:
+			return new DepthFrameReader(source);
+		
+		#if VIDEO_CONFIG_HAVE_THEORA
+		case DEPTH_CODEC_THEORA:
+			return new LossyDepthFrameReader(source);
+		#endif
+		
+		case DEPTH_CODEC_RANS:
+			return new RansDepthFrameReader(source);
+		
+		case DEPTH_CODEC_SPATIAL:
+			return new SpatialDepthFrameReader(source);
+		
+		case DEPTH_CODEC_KINECTV1:
+			return new KinectV1DepthFrameReader(source);
+		
+		default:
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s depth frame codec not supported",getDepthFrameCodecName(codec));
+		}
+	}
+
+}
@@ -0,0 +1,63 @@
+/***********************************************************************
+DepthFrameCodecs - Functions to select depth frame compression codecs
+by their stream identifiers or names, and to create matching depth
+frame writers and readers.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_DEPTHFRAMECODECS_INCLUDED
+#define KINECT_DEPTHFRAMECODECS_INCLUDED
+
+#include <Kinect/Types.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+namespace Kinect {
+class FrameWriter;
+class FrameReader;
+}
+
+namespace Kinect {
+
+enum DepthFrameCodec // Enumerated type for depth frame codecs; values are stored in depth stream headers and must never change
+	{
+	DEPTH_CODEC_HUFFMAN=0, // Lossless compression using Hilbert curve deltas and static Huffman codes
+	DEPTH_CODEC_THEORA, // Lossy compression using the Theora video codec
+	DEPTH_CODEC_RANS, // Lossless compression using Hilbert curve deltas and an interleaved rANS entropy coder
+	DEPTH_CODEC_SPATIAL, // Lossless compression using a raster-order 2D predictor, context-conditioned residuals, and an interleaved rANS entropy coder
+	DEPTH_CODEC_KINECTV1, // Lossless RLE/differential compression in the native format of first-generation Kinect cameras, whose frames can be passed through without re-encoding
+	DEPTH_CODEC_NUM_CODECS
+	};
+
+const char* getDepthFrameCodecName(DepthFrameCodec codec); // Returns the name of the given depth frame codec
+DepthFrameCodec parseDepthFrameCodec(const char* codecName); // Returns the depth frame codec of the given name; throws exception if the name is unknown
+bool isDepthFrameCodecSupported(DepthFrameCodec codec); // Returns true if the given depth frame codec is supported by this build of the library
+unsigned int getDepthFormatVersion(DepthFrameCodec codec,bool withMetadata =false); // Returns the lowest depth stream format version that can represent the given codec, and per-frame metadata if requested
+bool hasDepthFrameMetadata(unsigned int depthFormatVersion); // Returns true if frames in a depth stream of the given format version carry metadata
+DepthFrameCodec readDepthFrameCodec(IO::File& source,unsigned int depthFormatVersion); // Reads a depth frame codec identifier from a depth stream header of the given format version; throws exception if the identifier is invalid for that version
+void writeDepthFrameCodec(DepthFrameCodec codec,IO::File& sink,unsigned int depthFormatVersion); // Writes a depth frame codec identifier to a depth stream header of the given format version
+FrameWriter* createDepthFrameWriter(DepthFrameCodec codec,IO::File& sink,const Size& size); // Creates a depth frame writer using the given codec; throws exception if the codec is not supported
+FrameReader* createDepthFrameReader(DepthFrameCodec codec,IO::File& source); // Creates a depth frame reader using the given codec; throws exception if the codec is not supported
+
+}
+
+#endif
@@ -97,7 +97,7 @@ DepthFrameReader::~DepthFrameReader(void)
 FrameBuffer DepthFrameReader::readNextFrame(void)
 	{
 	/* Create the result frame: */
-	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel));
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),memoryTag);
 	
 	/* Return a dummy frame if the file is over: */
 	if(source.eof())
@@ -106,8 +106,8 @@ FrameBuffer DepthFrameReader::readNextFrame(void)
 		return result;
 		}
 	
-	/* Read the frame's time stamp from the source: */
-	result.timeStamp=source.read<Misc::Float64>();
+	/* Read the frame's time stamp and metadata from the source: */
+	readFrameHeader(source,result);
 	
 	/* Process all spans: */
 	FrameSource::DepthPixel* resultBuffer=result.getData<FrameSource::DepthPixel>();
@@ -206,4 +206,63 @@ FrameBuffer DepthFrameReader::readNextFrame(void)
 	return result;
 	}
 
+double DepthFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* All frames are compressed independently: */
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	double result=skipFrameHeader(source);
+	
+	/* Walk the frame's spans without storing pixels to find the end of the frame's bit stream: */
+	unsigned int numPixels=size.volume();
+	while(numPixels>0)
+		{
+		if(getBit())
+			{
+			/* Skip the 11-bit unencoded value of the initial pixel: */
+			for(int i=0;i<11;++i)
+				getBit();
+			
+			/* Skip the span's Huffman-encoded pixel value deltas: */
+			while(true)
+				{
+				--numPixels;
+				unsigned int delta=pixelDeltaNumLeaves+pixelDeltaNumLeaves-2U;
+				while(delta>=pixelDeltaNumLeaves)
+					{
+					if(getBit())
+						delta=pixelDeltaNodes[delta-pixelDeltaNumLeaves].right;
+					else
+						delta=pixelDeltaNodes[delta-pixelDeltaNumLeaves].left;
+					}
+				if(delta==0)
+					break;
+				}
+			}
+		else
+			{
+			/* Skip the Huffman-encoded span length: */
+			unsigned int spanLength=spanLengthNumLeaves+spanLengthNumLeaves-2U;
+			while(spanLength>=spanLengthNumLeaves)
+				{
+				if(getBit())
+					spanLength=spanLengthNodes[spanLength-spanLengthNumLeaves].right;
+				else
+					spanLength=spanLengthNodes[spanLength-spanLengthNumLeaves].left;
+				}
+			numPixels-=spanLength+1;
+			}
+		}
+	
+	/* Flush the bit buffer; frames start at byte-boundaries: */
+	flushBits();
+	
+	return result;
+	}
+
 }
@@ -85,6 +85,7 @@ class DepthFrameReader:public FrameReader
 	
 	/* Methods from FrameReader: */
 	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
 	};
 
 }
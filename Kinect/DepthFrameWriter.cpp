@@ -204,8 +204,7 @@ size_t DepthFrameWriter::writeFrame(const FrameBuffer& frame)
 	compressedSize=0;
 	
 	/* Write the frame's time stamp: */
-	sink.write<Misc::Float64>(frame.timeStamp);
-	compressedSize+=sizeof(Misc::Float64);
+	compressedSize+=writeFrameHeader(sink,frame);
 	
 	/* Process all pixels: */
 	const FrameSource::DepthPixel* frameBuffer=frame.getData<FrameSource::DepthPixel>();
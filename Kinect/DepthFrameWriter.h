@@ -37,6 +37,8 @@ namespace Kinect {
 
 class DepthFrameWriter:public FrameWriter
 	{
+	friend class RansDepthFrameWriter;
+	
 	/* Elements: */
 	private:
 	IO::File& sink; // Data sink for the compressed depth frame stream
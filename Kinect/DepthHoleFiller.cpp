@@ -0,0 +1,255 @@
+/***********************************************************************
+DepthHoleFiller - Class to fill small holes in depth frames by
+interpolating across runs of invalid pixels along frame rows and
+columns, processing bands of the frame in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/DepthHoleFiller.h>
+
+#include <string.h>
+#include <Misc/FunctionCalls.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+const unsigned int maxMaxHoleSize=1024; // Upper limit for the maximum hole size, to keep hole lengths within signed 16-bit range
+
+inline bool canFill(unsigned int a,unsigned int b,unsigned int holeSize,unsigned int ratioFactor) // Returns true if a hole of the given size between the two given valid depth values lies on a continuous surface
+	{
+	unsigned int diff=a>b?a-b:b-a;
+	unsigned int threshold=((a<b?a:b)*ratioFactor)>>16;
+	return diff<=threshold*(holeSize+1);
+	}
+
+inline DepthPixel interpolate(unsigned int a,unsigned int b,unsigned int i,unsigned int span) // Returns the depth value at the given step between two depth values
+	{
+	return DepthPixel((a*(span-i)+b*i+span/2)/span);
+	}
+
+size_t fillRow(DepthPixel* row,unsigned int width,unsigned int maxHoleSize,unsigned int ratioFactor) // Fills holes in a single frame row in place; returns number of filled pixels
+	{
+	size_t numFilled=0;
+	unsigned int x=0;
+	while(x<width)
+		{
+		#ifdef __SSE2__
+		
+		/* Skip blocks of eight valid pixels: */
+		__m128i lastValid=_mm_set1_epi16(short(maxValidDepth-1));
+		while(x+8<=width&&_mm_movemask_epi8(_mm_cmpgt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row+x)),lastValid))==0)
+			x+=8;
+		
+		#endif
+		
+		/* Find the beginning of the next hole: */
+		while(x<width&&row[x]<maxValidDepth)
+			++x;
+		if(x>=width)
+			break;
+		
+		/* Find the end of the hole: */
+		unsigned int holeStart=x;
+		while(x<width&&row[x]>=maxValidDepth)
+			++x;
+		
+		/* Fill the hole if it is bounded on both sides, small enough, and lies on a continuous surface: */
+		unsigned int holeSize=x-holeStart;
+		if(holeStart>0&&x<width&&holeSize<=maxHoleSize&&canFill(row[holeStart-1],row[x],holeSize,ratioFactor))
+			{
+			unsigned int a=row[holeStart-1];
+			unsigned int b=row[x];
+			for(unsigned int i=1;i<=holeSize;++i)
+				row[holeStart-1+i]=interpolate(a,b,i,holeSize+1);
+			numFilled+=holeSize;
+			}
+		}
+	
+	return numFilled;
+	}
+
+}
+
+/********************************
+Methods of class DepthHoleFiller:
+********************************/
+
+size_t DepthHoleFiller::fillRows(unsigned int firstRow,unsigned int lastRow)
+	{
+	unsigned int width=frame->getSize(0);
+	DepthPixel* rowPtr=frame->getData<DepthPixel>()+size_t(firstRow)*size_t(width);
+	
+	/* Fill holes along all rows in the band: */
+	size_t result=0;
+	for(unsigned int y=firstRow;y<lastRow;++y,rowPtr+=width)
+		result+=fillRow(rowPtr,width,maxHoleSize,ratioFactor);
+	
+	return result;
+	}
+
+size_t DepthHoleFiller::fillColumns(unsigned int firstColumn,unsigned int lastColumn)
+	{
+	unsigned int width=frame->getSize(0);
+	unsigned int height=frame->getSize(1);
+	DepthPixel* frameData=frame->getData<DepthPixel>();
+	
+	/* Initialize the per-column state of a top-to-bottom sweep; holes touching the top frame edge are not filled: */
+	unsigned int numColumns=lastColumn-firstColumn;
+	DepthPixel lastDepth[bandWidth]; // Most recent valid depth value in each column
+	Misc::UInt16 holeSize[bandWidth]; // Number of invalid pixels since the most recent valid pixel in each column, saturated at the maximum hole size plus one
+	for(unsigned int i=0;i<numColumns;++i)
+		{
+		lastDepth[i]=FrameSource::invalidDepth;
+		holeSize[i]=0;
+		}
+	
+	/* Sweep through the band's rows: */
+	size_t result=0;
+	DepthPixel* rowPtr=frameData+firstColumn;
+	for(unsigned int y=0;y<height;++y,rowPtr+=width)
+		{
+		unsigned int i=0;
+		
+		#ifdef __SSE2__
+		
+		/* Process blocks of eight columns that are valid and not at the end of a hole: */
+		__m128i lastValid=_mm_set1_epi16(short(maxValidDepth-1));
+		__m128i zero=_mm_setzero_si128();
+		for(;i+8<=numColumns;i+=8)
+			{
+			__m128i d=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rowPtr+i));
+			__m128i h=_mm_loadu_si128(reinterpret_cast<const __m128i*>(holeSize+i));
+			__m128i simple=_mm_andnot_si128(_mm_cmpgt_epi16(d,lastValid),_mm_cmpeq_epi16(h,zero));
+			if(_mm_movemask_epi8(simple)!=0xffff)
+				break;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lastDepth+i),d);
+			}
+		
+		#endif
+		
+		/* Process the remaining columns: */
+		for(;i<numColumns;++i)
+			{
+			unsigned int d=rowPtr[i];
+			if(d<maxValidDepth)
+				{
+				/* Fill the hole ending at this pixel if it is bounded on both sides, small enough, and lies on a continuous surface: */
+				unsigned int hs=holeSize[i];
+				if(hs>0&&hs<=maxHoleSize&&lastDepth[i]<maxValidDepth&&canFill(lastDepth[i],d,hs,ratioFactor))
+					{
+					DepthPixel* colPtr=rowPtr+i-size_t(hs)*size_t(width);
+					for(unsigned int j=1;j<=hs;++j,colPtr+=width)
+						*colPtr=interpolate(lastDepth[i],d,j,hs+1);
+					result+=hs;
+					}
+				
+				lastDepth[i]=DepthPixel(d);
+				holeSize[i]=0;
+				}
+			else if(holeSize[i]<=maxHoleSize)
+				++holeSize[i];
+			}
+		}
+	
+	return result;
+	}
+
+void DepthHoleFiller::processBand(unsigned int bandIndex)
+	{
+	/* Fill holes in the band: */
+	unsigned int size=frame->getSize(pass==0?1:0);
+	unsigned int bandSize=pass==0?bandHeight:bandWidth;
+	unsigned int first=bandIndex*bandSize;
+	unsigned int last=size-first<bandSize?size:first+bandSize;
+	size_t numFilled=pass==0?fillRows(first,last):fillColumns(first,last);
+	
+	/* Count the band's filled pixels: */
+	Threads::Mutex::Lock filledLock(filledMutex);
+	numFilledPixels+=numFilled;
+	}
+
+void DepthHoleFiller::runPass(int newPass)
+	{
+	/* Process all bands of the pass in parallel: */
+	pass=newPass;
+	unsigned int numBands=pass==0?(frame->getSize(1)+bandHeight-1)/bandHeight:(frame->getSize(0)+bandWidth-1)/bandWidth;
+	jobPool.run(numBands,Misc::VoidMethodCall<unsigned int,DepthHoleFiller>(this,&DepthHoleFiller::processBand));
+	}
+
+DepthHoleFiller::DepthHoleFiller(unsigned int numThreads)
+	:maxHoleSize(0),depthRatio(0.0),ratioFactor(0),
+	 frame(0),
+	 pass(0),numFilledPixels(0),
+	 jobPool(numThreads)
+	{
+	/* Set default thresholds: */
+	setMaxHoleSize(8);
+	setDepthRatio(0.01);
+	}
+
+DepthHoleFiller::~DepthHoleFiller(void)
+	{
+	}
+
+void DepthHoleFiller::setMaxHoleSize(unsigned int newMaxHoleSize)
+	{
+	/* Clamp the maximum hole size to the range of the per-column hole counters: */
+	maxHoleSize=newMaxHoleSize<maxMaxHoleSize?newMaxHoleSize:maxMaxHoleSize;
+	}
+
+void DepthHoleFiller::setDepthRatio(double newDepthRatio)
+	{
+	/* Clamp the ratio to the range of the fixed-point factor: */
+	depthRatio=newDepthRatio<0.0?0.0:newDepthRatio;
+	double factor=depthRatio*65536.0+0.5;
+	ratioFactor=factor<65535.0?Misc::UInt16(factor):Misc::UInt16(65535);
+	}
+
+FrameBuffer DepthHoleFiller::fill(const FrameBuffer& depthFrame)
+	{
+	/* Create the result frame as a copy of the depth frame: */
+	const Size& size=depthFrame.getSize();
+	FrameBuffer result(size,size.volume()*sizeof(DepthPixel),MemoryAccounting::FRAME_FILTER);
+	result.timeStamp=depthFrame.timeStamp;
+	result.metadata=depthFrame.metadata;
+	memcpy(result.getData<DepthPixel>(),depthFrame.getData<DepthPixel>(),size.volume()*sizeof(DepthPixel));
+	
+	/* Fill holes along rows first, and then fill the remaining holes along columns: */
+	frame=&result;
+	numFilledPixels=0;
+	runPass(0);
+	runPass(1);
+	frame=0;
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,83 @@
+/***********************************************************************
+DepthHoleFiller - Class to fill small holes in depth frames by
+interpolating across runs of invalid pixels along frame rows and
+columns, processing bands of the frame in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_DEPTHHOLEFILLER_INCLUDED
+#define KINECT_DEPTHHOLEFILLER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/SizedTypes.h>
+#include <Threads/Mutex.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ParallelJobPool.h>
+
+namespace Kinect {
+
+class DepthHoleFiller
+	{
+	/* Elements: */
+	private:
+	unsigned int maxHoleSize; // Maximum number of consecutive invalid pixels along a frame row or column that will be filled
+	double depthRatio; // Maximum depth change per pixel across a hole, relative to the smaller depth value bounding the hole
+	Misc::UInt16 ratioFactor; // Depth ratio as 0.16 fixed-point factor
+	static const unsigned int bandHeight=16; // Number of frame rows in each band processed by a single thread during the row pass
+	static const unsigned int bandWidth=64; // Number of frame columns in each band processed by a single thread during the column pass
+	FrameBuffer* frame; // Depth frame currently being filled in place
+	int pass; // Index of the current pass; 0: fill along rows, 1: fill along columns
+	Threads::Mutex filledMutex; // Mutex protecting the filled pixel counter
+	size_t numFilledPixels; // Number of pixels filled in the current frame
+	ParallelJobPool jobPool; // Pool of threads filling bands of the current frame
+	
+	/* Private methods: */
+	size_t fillRows(unsigned int firstRow,unsigned int lastRow); // Fills holes along the given range of rows of the current frame; returns number of filled pixels
+	size_t fillColumns(unsigned int firstColumn,unsigned int lastColumn); // Fills holes along the given range of columns of the current frame; returns number of filled pixels
+	void processBand(unsigned int bandIndex); // Fills holes in the band of the given index of the current pass
+	void runPass(int newPass); // Processes all bands of the current frame in the given pass
+	
+	/* Constructors and destructors: */
+	public:
+	DepthHoleFiller(unsigned int numThreads =2); // Creates a hole filler using the given total number of threads
+	~DepthHoleFiller(void);
+	
+	/* Methods: */
+	unsigned int getMaxHoleSize(void) const // Returns the maximum size of filled holes
+		{
+		return maxHoleSize;
+		}
+	double getDepthRatio(void) const // Returns the relative per-pixel depth change threshold
+		{
+		return depthRatio;
+		}
+	void setMaxHoleSize(unsigned int newMaxHoleSize); // Sets the maximum size of filled holes; must not be called while a frame is being filled
+	void setDepthRatio(double newDepthRatio); // Sets the relative per-pixel depth change threshold; must not be called while a frame is being filled
+	FrameBuffer fill(const FrameBuffer& depthFrame); // Returns a copy of the given depth frame in which all small holes between similar depth values are filled
+	size_t getNumFilledPixels(void) const // Returns the number of pixels filled in the most recently processed frame
+		{
+		return numFilledPixels;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,231 @@
+/***********************************************************************
+DepthTileCuller - Class to determine which tiles of a depth frame can be
+seen from inside a convex world-space view region, and to remove the
+invisible tiles from depth frames before compression.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/DepthTileCuller.h>
+
+#include <string.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class DepthTileCuller:
+********************************/
+
+DepthTileCuller::DepthTileCuller(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps)
+	:tileCorners((numTiles+1)*(numTiles+1)),
+	 tileCorrections(numTiles*numTiles*2)
+	{
+	/* Initialize the projector: */
+	projector.setDepthFrameSize(depthSize);
+	projector.setDepthCorrection(depthCorrection);
+	projector.setIntrinsicParameters(ips);
+	projector.setExtrinsicParameters(eps);
+	
+	/* Calculate the tile grid: */
+	for(int i=0;i<2;++i)
+		for(unsigned int t=0;t<=numTiles;++t)
+			tileEdges[i][t]=(depthSize[i]*t)/numTiles;
+	
+	/* Calculate the undistorted positions of the tile grid's corners: */
+	typedef FrameSource::IntrinsicParameters::Scalar Scalar;
+	typedef FrameSource::IntrinsicParameters::Point2 Point2;
+	std::vector<Point2>::iterator tcIt=tileCorners.begin();
+	for(unsigned int ty=0;ty<=numTiles;++ty)
+		for(unsigned int tx=0;tx<=numTiles;++tx,++tcIt)
+			{
+			Point2 corner(Scalar(tileEdges[0][tx]),Scalar(tileEdges[1][ty]));
+			if(!ips.depthLensDistortion.isIdentity())
+				corner=ips.undistortDepthPixel(corner);
+			*tcIt=corner;
+			}
+	
+	/* Calculate the range of depth correction factors inside each tile: */
+	const FrameSource::DepthCorrection::PixelCorrection* dc=projector.getDepthCorrection();
+	std::vector<FrameSource::DepthCorrection::PixelCorrection>::iterator tcoIt=tileCorrections.begin();
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		for(unsigned int tx=0;tx<numTiles;++tx,tcoIt+=2)
+			{
+			if(dc!=0)
+				{
+				tcoIt[0]=tcoIt[1]=dc[tileEdges[1][ty]*depthSize[0]+tileEdges[0][tx]];
+				for(unsigned int y=tileEdges[1][ty];y<tileEdges[1][ty+1];++y)
+					{
+					const FrameSource::DepthCorrection::PixelCorrection* dcPtr=dc+(y*depthSize[0]+tileEdges[0][tx]);
+					for(unsigned int x=tileEdges[0][tx];x<tileEdges[0][tx+1];++x,++dcPtr)
+						{
+						if(tcoIt[0].scale>dcPtr->scale)
+							tcoIt[0].scale=dcPtr->scale;
+						if(tcoIt[1].scale<dcPtr->scale)
+							tcoIt[1].scale=dcPtr->scale;
+						if(tcoIt[0].offset>dcPtr->offset)
+							tcoIt[0].offset=dcPtr->offset;
+						if(tcoIt[1].offset<dcPtr->offset)
+							tcoIt[1].offset=dcPtr->offset;
+						}
+					}
+				}
+			else
+				{
+				/* Use identity depth correction: */
+				tcoIt[0].scale=tcoIt[1].scale=1.0f;
+				tcoIt[0].offset=tcoIt[1].offset=0.0f;
+				}
+			}
+	}
+
+void DepthTileCuller::calcTileRanges(const FrameBuffer& depthFrame,DepthTileCuller::TileRange tileRanges[DepthTileCuller::numTiles*DepthTileCuller::numTiles]) const
+	{
+	/* Initialize all tile ranges to empty: */
+	for(unsigned int i=0;i<numTiles*numTiles;++i)
+		{
+		tileRanges[i].min=FrameSource::invalidDepth;
+		tileRanges[i].max=0;
+		}
+	
+	/* Process all pixels in row-major order: */
+	unsigned int width=projector.getDepthFrameSize(0);
+	const FrameSource::DepthPixel* dPtr=depthFrame.getData<FrameSource::DepthPixel>();
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		{
+		TileRange* trRow=tileRanges+ty*numTiles;
+		for(unsigned int y=tileEdges[1][ty];y<tileEdges[1][ty+1];++y)
+			{
+			TileRange* tr=trRow;
+			for(unsigned int tx=0;tx<numTiles;++tx,++tr)
+				{
+				const FrameSource::DepthPixel* rowPtr=dPtr+(y*width+tileEdges[0][tx]);
+				const FrameSource::DepthPixel* rowEnd=dPtr+(y*width+tileEdges[0][tx+1]);
+				for(;rowPtr!=rowEnd;++rowPtr)
+					if(*rowPtr!=FrameSource::invalidDepth)
+						{
+						if(tr->min>*rowPtr)
+							tr->min=*rowPtr;
+						if(tr->max<*rowPtr)
+							tr->max=*rowPtr;
+						}
+				}
+			}
+		}
+	}
+
+DepthTileCuller::TileMask DepthTileCuller::calcValidTiles(const DepthTileCuller::TileRange tileRanges[DepthTileCuller::numTiles*DepthTileCuller::numTiles])
+	{
+	TileMask result=0;
+	for(unsigned int i=0;i<numTiles*numTiles;++i)
+		if(tileRanges[i].min<=tileRanges[i].max)
+			result|=TileMask(1)<<i;
+	return result;
+	}
+
+DepthTileCuller::TileMask DepthTileCuller::calcVisibleTiles(const DepthTileCuller::TileRange tileRanges[DepthTileCuller::numTiles*DepthTileCuller::numTiles],const DepthTileCuller::ViewRegion& viewRegion,double margin) const
+	{
+	typedef ProjectorBase::Point Point;
+	
+	TileMask result=0;
+	const TileRange* tr=tileRanges;
+	std::vector<FrameSource::DepthCorrection::PixelCorrection>::const_iterator tcoIt=tileCorrections.begin();
+	TileMask tileBit=1;
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		for(unsigned int tx=0;tx<numTiles;++tx,++tr,tcoIt+=2,tileBit<<=1)
+			{
+			/* Skip tiles without valid pixels: */
+			if(tr->min>tr->max)
+				continue;
+			
+			/* Calculate a conservative range of corrected depth values: */
+			double dMin=double(tcoIt[0].correct(float(tr->min)));
+			double dMax=double(tcoIt[1].correct(float(tr->max)));
+			
+			/* Transform the eight corners of the tile's depth image-space box to world space: */
+			Point corners[8];
+			Point* cPtr=corners;
+			for(unsigned int cy=0;cy<2;++cy)
+				for(unsigned int cx=0;cx<2;++cx)
+					{
+					const FrameSource::IntrinsicParameters::Point2& tc=tileCorners[(ty+cy)*(numTiles+1)+(tx+cx)];
+					*(cPtr++)=projector.worldDepthProjection.transform(Point(tc[0],tc[1],dMin));
+					*(cPtr++)=projector.worldDepthProjection.transform(Point(tc[0],tc[1],dMax));
+					}
+			
+			/* Cull the tile if all its corners are outside one of the view region's planes: */
+			bool visible=true;
+			for(ViewRegion::const_iterator vrIt=viewRegion.begin();visible&&vrIt!=viewRegion.end();++vrIt)
+				{
+				int i;
+				for(i=0;i<8&&vrIt->calcDistance(corners[i])<-margin;++i)
+					;
+				visible=i<8;
+				}
+			if(visible)
+				result|=tileBit;
+			}
+	
+	return result;
+	}
+
+FrameBuffer DepthTileCuller::maskFrame(const FrameBuffer& depthFrame,DepthTileCuller::TileMask visibleTiles) const
+	{
+	/* Create the result frame: */
+	const Size& size=projector.getDepthFrameSize();
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),MemoryAccounting::FRAME_FILTER);
+	result.timeStamp=depthFrame.timeStamp;
+	result.metadata=depthFrame.metadata;
+	
+	/* Copy visible tiles and invalidate invisible ones, one tile row segment at a time: */
+	const FrameSource::DepthPixel* sPtr=depthFrame.getData<FrameSource::DepthPixel>();
+	FrameSource::DepthPixel* dPtr=result.getData<FrameSource::DepthPixel>();
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		for(unsigned int y=tileEdges[1][ty];y<tileEdges[1][ty+1];++y)
+			for(unsigned int tx=0;tx<numTiles;++tx)
+				{
+				size_t rowOffset=y*size[0]+tileEdges[0][tx];
+				size_t rowLength=tileEdges[0][tx+1]-tileEdges[0][tx];
+				if(visibleTiles&(TileMask(1)<<(ty*numTiles+tx)))
+					memcpy(dPtr+rowOffset,sPtr+rowOffset,rowLength*sizeof(FrameSource::DepthPixel));
+				else
+					{
+					FrameSource::DepthPixel* rowPtr=dPtr+rowOffset;
+					for(size_t x=0;x<rowLength;++x,++rowPtr)
+						*rowPtr=FrameSource::invalidDepth;
+					}
+				}
+	
+	return result;
+	}
+
+DepthTileCuller::ViewRegion DepthTileCuller::makeBoxRegion(const ProjectorBase::Point& min,const ProjectorBase::Point& max)
+	{
+	ViewRegion result;
+	for(int i=0;i<3;++i)
+		{
+		Plane::Vector normal(0.0,0.0,0.0);
+		normal[i]=1.0;
+		result.push_back(Plane(normal,min[i]));
+		normal[i]=-1.0;
+		result.push_back(Plane(normal,-max[i]));
+		}
+	return result;
+	}
+
+}
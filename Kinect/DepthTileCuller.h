@@ -0,0 +1,77 @@
+/***********************************************************************
+DepthTileCuller - Class to determine which tiles of a depth frame can be
+seen from inside a convex world-space view region, and to remove the
+invisible tiles from depth frames before compression.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_DEPTHTILECULLER_INCLUDED
+#define KINECT_DEPTHTILECULLER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Geometry/Plane.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ProjectorBase.h>
+
+namespace Kinect {
+
+class DepthTileCuller
+	{
+	/* Embedded classes: */
+	public:
+	typedef Geometry::Plane<double,3> Plane; // Type for planes bounding view regions in world space
+	typedef std::vector<Plane> ViewRegion; // Type for convex view regions as intersections of half-spaces; points p with plane.calcDistance(p)>=0 for all planes are inside
+	typedef Misc::UInt64 TileMask; // Type for bit masks of depth frame tiles in row-major order
+	
+	struct TileRange // Structure for the range of valid depth values in a depth frame tile
+		{
+		/* Elements: */
+		public:
+		FrameSource::DepthPixel min,max; // Smallest and largest valid depth value; min>max if the tile has no valid pixels
+		};
+	
+	static const unsigned int numTiles=8; // Number of tiles in each depth frame dimension
+	static const TileMask allTiles=~TileMask(0); // Tile mask with all tiles set
+	
+	/* Elements: */
+	private:
+	ProjectorBase projector; // Projector holding the camera's intrinsic and extrinsic parameters and per-pixel depth correction
+	unsigned int tileEdges[2][numTiles+1]; // Pixel positions of the tile grid's vertical and horizontal edges
+	std::vector<FrameSource::IntrinsicParameters::Point2> tileCorners; // Undistorted depth image-space positions of the tile grid's corners
+	std::vector<FrameSource::DepthCorrection::PixelCorrection> tileCorrections; // Component-wise minimum and maximum depth correction factors for each tile
+	
+	/* Constructors and destructors: */
+	public:
+	DepthTileCuller(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps); // Creates a tile culler for depth frames of the given size from a camera with the given parameters
+	
+	/* Methods: */
+	void calcTileRanges(const FrameBuffer& depthFrame,TileRange tileRanges[numTiles*numTiles]) const; // Calculates the valid depth value ranges of all tiles of the given depth frame
+	static TileMask calcValidTiles(const TileRange tileRanges[numTiles*numTiles]); // Returns the mask of tiles containing at least one valid pixel
+	TileMask calcVisibleTiles(const TileRange tileRanges[numTiles*numTiles],const ViewRegion& viewRegion,double margin) const; // Returns the mask of non-empty tiles that can intersect the given view region expanded by the given world-space margin
+	FrameBuffer maskFrame(const FrameBuffer& depthFrame,TileMask visibleTiles) const; // Returns a copy of the given depth frame in which all pixels of tiles not in the given mask are invalid
+	static ViewRegion makeBoxRegion(const ProjectorBase::Point& min,const ProjectorBase::Point& max); // Returns a view region representing the given axis-aligned world-space box
+	};
+
+}
+
+#endif
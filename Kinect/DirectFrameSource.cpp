@@ -43,6 +43,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GLMotif/FileSelectionHelper.h>
 #include <Kinect/Internal/Config.h>
 #include <Kinect/FrameBuffer.h>
+#include <Kinect/FloorPlaneRemover.h>
 
 namespace Kinect {
 
@@ -139,6 +140,10 @@ void DirectFrameSource::processDepthFrameBackground(FrameBuffer& depthFrame)
 			if(*dfPtr+backgroundRemovalFuzz>=*bfPtr)
 				*dfPtr=invalidDepth; // Mark the pixel as invalid
 		}
+	
+	/* Check if we're removing the floor: */
+	if(removeFloor)
+		floorPlaneRemover->removeFloor(depthFrame);
 	}
 
 void DirectFrameSource::removeBackgroundToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
@@ -150,6 +155,12 @@ void DirectFrameSource::removeBackgroundToggleCallback(GLMotif::ToggleButton::Va
 		cbData->toggle->setToggle(false);
 	}
 
+void DirectFrameSource::removeFloorToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+	{
+	/* Set the floor removal flag: */
+	setRemoveFloor(cbData->set);
+	}
+
 void DirectFrameSource::captureBackgroundCompleteCallback(DirectFrameSource& source,GLMotif::Button* button)
 	{
 	/* Re-enable the button: */
@@ -210,13 +221,15 @@ void DirectFrameSource::saveBackgroundCallback(GLMotif::FileSelectionDialog::OKC
 DirectFrameSource::DirectFrameSource(void)
 	:backgroundFrame(0),
 	 backgroundCaptureNumFrames(0),backgroundCaptureCallback(0),
-	 removeBackground(false),backgroundRemovalFuzz(3)
+	 removeBackground(false),backgroundRemovalFuzz(3),
+	 floorPlaneRemover(0),removeFloor(false)
 	{
 	}
 
 DirectFrameSource::~DirectFrameSource(void)
 	{
 	delete[] backgroundFrame;
+	delete floorPlaneRemover;
 	}
 
 FrameSource::ExtrinsicParameters DirectFrameSource::getExtrinsicParameters(void)
@@ -297,6 +310,23 @@ void DirectFrameSource::configure(Misc::ConfigurationFileSection& configFileSect
 	
 	/* Enable background removal: */
 	setRemoveBackground(configFileSection.retrieveValue<bool>("./removeBackground",getRemoveBackground()));
+	
+	/* Configure and enable floor removal: */
+	if(configFileSection.retrieveValue<bool>("./removeFloor",getRemoveFloor()))
+		{
+		FloorPlaneRemover& fpr=getFloorPlaneRemover();
+		if(configFileSection.hasTag("./floorUpDirection"))
+			fpr.setUpDirection(configFileSection.retrieveValue<FloorPlaneRemover::Vector>("./floorUpDirection"));
+		if(configFileSection.hasTag("./floorMaxTilt"))
+			fpr.setMaxTilt(configFileSection.retrieveValue<FloorPlaneRemover::Scalar>("./floorMaxTilt"));
+		if(configFileSection.hasTag("./floorInlierDistance"))
+			fpr.setInlierDistance(configFileSection.retrieveValue<FloorPlaneRemover::Scalar>("./floorInlierDistance"));
+		if(configFileSection.hasTag("./floorMargin"))
+			fpr.setRemovalMargin(configFileSection.retrieveValue<FloorPlaneRemover::Scalar>("./floorMargin"));
+		if(configFileSection.hasTag("./floorEstimationInterval"))
+			fpr.setEstimationInterval(configFileSection.retrieveValue<unsigned int>("./floorEstimationInterval"));
+		setRemoveFloor(true);
+		}
 	}
 
 void DirectFrameSource::buildSettingsDialog(GLMotif::RowColumn* settingsDialog)
@@ -335,6 +365,12 @@ void DirectFrameSource::buildSettingsDialog(GLMotif::RowColumn* settingsDialog)
 	GLMotif::Button* saveBackgroundButton=new GLMotif::Button("SaveBackgroundButton",backgroundBox,"Save...");
 	backgroundSelectionHelper->addSaveCallback(saveBackgroundButton,this,&DirectFrameSource::saveBackgroundCallback);
 	
+	GLMotif::ToggleButton* removeFloorToggle=new GLMotif::ToggleButton("RemoveFloorToggle",backgroundBox,"Remove Floor");
+	removeFloorToggle->setBorderWidth(0.0f);
+	removeFloorToggle->setBorderType(GLMotif::Widget::PLAIN);
+	removeFloorToggle->setToggle(removeFloor);
+	removeFloorToggle->getValueChangedCallbacks().add(this,&DirectFrameSource::removeFloorToggleCallback);
+	
 	backgroundBox->manageChild();
 	
 	backgroundMargin->manageChild();
@@ -538,4 +574,21 @@ void DirectFrameSource::setBackgroundRemovalFuzz(int newBackgroundRemovalFuzz)
 	backgroundRemovalFuzz=Misc::SInt16(newBackgroundRemovalFuzz);
 	}
 
+FloorPlaneRemover& DirectFrameSource::getFloorPlaneRemover(void)
+	{
+	/* Create the floor plane remover if it doesn't exist yet: */
+	if(floorPlaneRemover==0)
+		floorPlaneRemover=new FloorPlaneRemover(getActualFrameSize(DEPTH),getIntrinsicParameters());
+	
+	return *floorPlaneRemover;
+	}
+
+void DirectFrameSource::setRemoveFloor(bool newRemoveFloor)
+	{
+	/* Create the floor plane remover before enabling floor removal: */
+	if(newRemoveFloor)
+		getFloorPlaneRemover();
+	removeFloor=newRemoveFloor;
+	}
+
 }
@@ -47,6 +47,9 @@ namespace GLMotif {
 class RowColumn;
 class FileSelectionHelper;
 }
+namespace Kinect {
+class FloorPlaneRemover;
+}
 
 namespace Kinect {
 
@@ -89,14 +92,17 @@ class DirectFrameSource:public FrameSource
 	BackgroundCaptureCallback* backgroundCaptureCallback; // Function to call upon completion of background capture
 	bool removeBackground; // Flag whether to remove background information during frame processing
 	Misc::SInt16 backgroundRemovalFuzz; // Fuzz value for background removal (positive values: more aggressive removal)
+	FloorPlaneRemover* floorPlaneRemover; // Object detecting and removing the floor plane; created on demand
+	bool removeFloor; // Flag whether to remove floor pixels during frame processing
 	Misc::CallbackList intrinsicParametersChangedCallbacks; // List of callbacks to be called when the camera's intrinsic parameters change
 	
 	/* Protected methods: */
-	void processDepthFrameBackground(FrameBuffer& depthFrame); // Runs a newly-decoded depth frame through background capture and/or removal
+	void processDepthFrameBackground(FrameBuffer& depthFrame); // Runs a newly-decoded depth frame through background capture and/or removal, and floor removal
 	
 	/* Private methods: */
 	private:
 	void removeBackgroundToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData); // Called when user toggles the "remove background" button
+	void removeFloorToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData); // Called when user toggles the "remove floor" button
 	void captureBackgroundCompleteCallback(DirectFrameSource& source,GLMotif::Button* button); // Called when a user-requested background capture finishes
 	void captureBackgroundButtonCallback(GLMotif::Button::SelectCallbackData* cbData); // Called when user presses the "capture background" button
 	void backgroundMaxDepthCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData); // Called when user moves the background max depth slider
@@ -137,6 +143,12 @@ class DirectFrameSource:public FrameSource
 		{
 		return backgroundRemovalFuzz;
 		}
+	FloorPlaneRemover& getFloorPlaneRemover(void); // Returns the floor plane remover, creating it for the camera's current depth frame size and intrinsic parameters if it does not exist yet
+	void setRemoveFloor(bool newRemoveFloor); // Enables or disables automatic floor removal
+	bool getRemoveFloor(void) const // Returns the current floor removal flag
+		{
+		return removeFloor;
+		}
 	};
 
 }
@@ -525,6 +525,7 @@ void* DiskExtractor::diskExtractorThreadMethod(void)
 		if(extractionResultCallback!=0)
 			{
 			/* Call the result callback: */
+			extractionTimeStamp=frame.timeStamp;
 			(*extractionResultCallback)(extractionResult);
 			}
 		}
@@ -539,7 +540,7 @@ DiskExtractor::DiskExtractor(const Size& sFrameSize,const FrameSource::DepthCorr
 	 minNumPixels(500),
 	 diskRadius(60),diskRadiusMargin(1.1),diskFlatness(5.0),
 	 keepProcessing(false),
-	 extractionResultCallback(0),
+	 extractionResultCallback(0),extractionTimeStamp(0.0),
 	 trackingPixel(~0x0U),trackingCallback(0)
 	{
 	if(dc!=0)
@@ -562,7 +563,7 @@ DiskExtractor::DiskExtractor(const Size& sFrameSize,const DiskExtractor::PixelDe
 	 minNumPixels(500),
 	 diskRadius(60),diskRadiusMargin(1.1),diskFlatness(5.0),
 	 keepProcessing(false),
-	 extractionResultCallback(0),
+	 extractionResultCallback(0),extractionTimeStamp(0.0),
 	 trackingPixel(~0x0U),trackingCallback(0)
 	{
 	/* Pre-compute a 2D array of image pixel positions with averaging weights: */
@@ -97,6 +97,7 @@ class DiskExtractor
 	FrameBuffer newFrame; // Buffer holding incoming depth image for disk extraction
 	Threads::Thread diskExtractorThread; // Background thread extracting disks from depth images
 	ExtractionResultCallback* extractionResultCallback; // Function called with disk extraction results
+	double extractionTimeStamp; // Time stamp of the depth image from which the most recent disk extraction results were extracted
 	unsigned int trackingPixel; // Linear index of the tracking pixel
 	TrackingCallback* trackingCallback; // Function called with the disk containing a tracked pixel
 	
@@ -146,6 +147,10 @@ class DiskExtractor
 	void setDiskFlatness(Scalar newDiskFlatness); // Sets the maximum along-axis extent of to-be-extracted disks
 	DiskList processFrame(const FrameBuffer& frame) const; // Immediately processes the given frame
 	void startStreaming(ExtractionResultCallback* newExtractionResultCallback); // Starts background processing; class takes ownership of new-allocated function object
+	double getExtractionTimeStamp(void) const // Returns the time stamp of the depth image from which the disks passed to the extraction result callback were extracted; only valid inside the callback
+		{
+		return extractionTimeStamp;
+		}
 	void stopStreaming(void); // Stops background processing
 	void startTracking(TrackingCallback* newTrackingCallback); // Starts tracking a specific pixel in the depth image
 	void setTrackingPixel(unsigned int trackingX,unsigned int trackingY); // Sets the pixel to be tracked
@@ -0,0 +1,597 @@
+/***********************************************************************
+FacadeRayCaster - Class to intersect world-space rays with the facades
+most recently reconstructed from the depth frames of one or more
+calibrated cameras, using per-camera min/max depth pyramids.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FacadeRayCaster.h>
+
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <Math/Math.h>
+#include <Geometry/ProjectiveTransformation.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+const double boxEpsilon=1.0e-3; // Enlargement of pyramid node boxes in depth image space
+
+/* Triangulation of pixel quads, matching Projector; quad corners are indexed 0: (0, 0), 1: (1, 0), 2: (0, 1), 3: (1, 1): */
+const unsigned int quadCaseNumTriangles[16]={0,0,0,0,0,0,0,1,0,0,0,1,0,1,1,2};
+const int quadCaseCorners[16][6]=
+	{
+	{0,0,0,0,0,0},{0,0,0,0,0,0},{0,0,0,0,0,0},{0,0,0,0,0,0},
+	{0,0,0,0,0,0},{0,0,0,0,0,0},{0,0,0,0,0,0},{0,1,2,0,0,0},
+	{0,0,0,0,0,0},{0,0,0,0,0,0},{0,0,0,0,0,0},{0,1,3,0,0,0},
+	{0,0,0,0,0,0},{0,2,3,0,0,0},{1,2,3,0,0,0},{0,1,2,2,1,3}
+	};
+
+inline bool clipInterval(double c0,double c1,double& t0,double& t1) // Clips the given parameter interval to the half-line c0+t*c1>=0; returns false if the interval becomes empty
+	{
+	if(c1>0.0)
+		{
+		double t=-c0/c1;
+		if(t0<t)
+			t0=t;
+		}
+	else if(c1<0.0)
+		{
+		double t=-c0/c1;
+		if(t1>t)
+			t1=t;
+		}
+	else if(c0<0.0)
+		return false;
+	
+	return t0<=t1;
+	}
+
+struct RayState // Structure holding a ray in homogeneous depth image space
+	{
+	/* Elements: */
+	public:
+	double h0[4]; // Homogeneous depth image-space position of the ray's origin, oriented such that points in front of the camera have positive weights
+	double h1[4]; // Homogeneous depth image-space direction of the ray
+	
+	/* Methods: */
+	bool clipBox(const float xy[4],const float z[2],double& t0,double& t1) const // Clips the given parameter interval to the given depth image-space box
+		{
+		/* Clip against the box's six faces, slightly enlarged to keep flat boxes from being missed due to round-off: */
+		const float* bounds[3]={xy,xy+2,z};
+		for(int i=0;i<3;++i)
+			{
+			double min=double(bounds[i][0])-boxEpsilon;
+			double max=double(bounds[i][1])+boxEpsilon;
+			if(!clipInterval(h0[i]-min*h0[3],h1[i]-min*h1[3],t0,t1)||!clipInterval(max*h0[3]-h0[i],max*h1[3]-h1[i],t0,t1))
+				return false;
+			}
+		
+		return true;
+		}
+	};
+
+struct StackEntry // Structure for pending pyramid nodes during ray traversal
+	{
+	/* Elements: */
+	public:
+	unsigned int level; // Pyramid level of the node
+	unsigned int x,y; // Index of the node in its level
+	double t0,t1; // Parameter interval of the ray inside the node
+	};
+
+}
+
+/********************************
+Methods of class FacadeRayCaster:
+********************************/
+
+void FacadeRayCaster::castRay(unsigned int cameraIndex,const FacadeRayCaster::FrameState& state,const FacadeRayCaster::Ray& ray,FacadeRayCaster::Scalar maxLambda,FacadeRayCaster::Hit& hit) const
+	{
+	const Camera& camera=*cameras[cameraIndex];
+	const Size& depthSize=camera.projector.getDepthFrameSize();
+	unsigned int width=depthSize[0];
+	
+	/* Access the frame state: */
+	const float* depths=state.frame.getData<float>();
+	const float* zRanges=depths+depthSize.volume();
+	const Misc::UInt8* cases=reinterpret_cast<const Misc::UInt8*>(zRanges+camera.numNodes*2);
+	
+	/* Transform the ray into homogeneous depth image space: */
+	RayState rs;
+	const Point& o=ray.getOrigin();
+	const Vector& d=ray.getDirection();
+	for(int i=0;i<4;++i)
+		{
+		const Scalar* row=camera.inverseProjection[i];
+		rs.h0[i]=(row[0]*o[0]+row[1]*o[1]+row[2]*o[2]+row[3])*state.frontSign;
+		rs.h1[i]=(row[0]*d[0]+row[1]*d[1]+row[2]*d[2])*state.frontSign;
+		}
+	
+	/* Restrict the ray to the part in front of the camera and the pyramid's root node: */
+	double t0=0.0;
+	double t1=maxLambda<hit.lambda?maxLambda:hit.lambda;
+	const Level& root=camera.levels.back();
+	if(!clipInterval(rs.h0[3],rs.h1[3],t0,t1)||t1<=t0||!rs.clipBox(&camera.xyBounds[root.offset*4],zRanges+root.offset*2,t0,t1))
+		return;
+	
+	/* Traverse the pyramid front-to-back: */
+	StackEntry stack[64];
+	stack[0].level=camera.levels.size()-1;
+	stack[0].x=stack[0].y=0;
+	stack[0].t0=t0;
+	stack[0].t1=t1;
+	unsigned int stackSize=1;
+	double bestT=t1;
+	unsigned int bestCell=0;
+	int bestTriangle=-1;
+	double bestPlane[4]={0.0,0.0,0.0,0.0};
+	while(stackSize>0)
+		{
+		StackEntry node=stack[--stackSize];
+		if(node.t0>bestT)
+			continue;
+		
+		if(node.level==0)
+			{
+			/* Intersect the ray with the quad's triangles: */
+			unsigned int cellIndex=node.y*camera.levels[0].size[0]+node.x;
+			unsigned int caseIndex=cases[cellIndex]&0x0fU;
+			unsigned int triangleMask=cases[cellIndex]>>4;
+			
+			/* Calculate the positions of the quad's corners in depth image space: */
+			double corners[4][3];
+			for(int c=0;c<4;++c)
+				{
+				unsigned int cx=node.x+(c&0x1);
+				unsigned int cy=node.y+(c>>1);
+				size_t index=size_t(cy)*size_t(width)+cx;
+				if(!camera.pixelCenters.empty())
+					{
+					corners[c][0]=camera.pixelCenters[index][0];
+					corners[c][1]=camera.pixelCenters[index][1];
+					}
+				else
+					{
+					corners[c][0]=double(cx)+0.5;
+					corners[c][1]=double(cy)+0.5;
+					}
+				corners[c][2]=depths[index];
+				}
+			
+			const int* qcc=quadCaseCorners[caseIndex];
+			for(unsigned int i=0;i<quadCaseNumTriangles[caseIndex];++i,qcc+=3)
+				{
+				if((triangleMask&(0x1U<<i))==0x0U)
+					continue;
+				
+				/* Calculate the triangle's plane in depth image space: */
+				const double* p0=corners[qcc[0]];
+				const double* p1=corners[qcc[1]];
+				const double* p2=corners[qcc[2]];
+				double e1[3],e2[3];
+				for(int j=0;j<3;++j)
+					{
+					e1[j]=p1[j]-p0[j];
+					e2[j]=p2[j]-p0[j];
+					}
+				double plane[4];
+				plane[0]=e1[1]*e2[2]-e1[2]*e2[1];
+				plane[1]=e1[2]*e2[0]-e1[0]*e2[2];
+				plane[2]=e1[0]*e2[1]-e1[1]*e2[0];
+				plane[3]=-(plane[0]*p0[0]+plane[1]*p0[1]+plane[2]*p0[2]);
+				
+				/* Intersect the ray with the plane: */
+				double denominator=plane[0]*rs.h1[0]+plane[1]*rs.h1[1]+plane[2]*rs.h1[2]+plane[3]*rs.h1[3];
+				if(denominator==0.0)
+					continue;
+				double t=-(plane[0]*rs.h0[0]+plane[1]*rs.h0[1]+plane[2]*rs.h0[2]+plane[3]*rs.h0[3])/denominator;
+				if(t<t0||t>=bestT)
+					continue;
+				
+				/* Check if the intersection point is inside the triangle using its barycentric coordinates in the depth image plane: */
+				double w=rs.h0[3]+t*rs.h1[3];
+				double px=(rs.h0[0]+t*rs.h1[0])/w-p0[0];
+				double py=(rs.h0[1]+t*rs.h1[1])/w-p0[1];
+				double det=e1[0]*e2[1]-e1[1]*e2[0];
+				double b1=(px*e2[1]-py*e2[0])/det;
+				double b2=(e1[0]*py-e1[1]*px)/det;
+				const double epsilon=1.0e-9;
+				if(b1>=-epsilon&&b2>=-epsilon&&b1+b2<=1.0+epsilon)
+					{
+					bestT=t;
+					bestCell=cellIndex;
+					bestTriangle=int(i);
+					for(int j=0;j<4;++j)
+						bestPlane[j]=plane[j];
+					}
+				}
+			}
+		else
+			{
+			/* Collect the node's children that are intersected by the ray: */
+			const Level& childLevel=camera.levels[node.level-1];
+			StackEntry children[4];
+			unsigned int numChildren=0;
+			for(unsigned int cy=node.y*2;cy<node.y*2+2&&cy<childLevel.size[1];++cy)
+				for(unsigned int cx=node.x*2;cx<node.x*2+2&&cx<childLevel.size[0];++cx)
+					{
+					size_t childIndex=childLevel.offset+size_t(cy)*size_t(childLevel.size[0])+cx;
+					const float* z=zRanges+childIndex*2;
+					if(z[0]>z[1])
+						continue;
+					StackEntry child;
+					child.t0=node.t0;
+					child.t1=node.t1<bestT?node.t1:bestT;
+					if(rs.clipBox(&camera.xyBounds[childIndex*4],z,child.t0,child.t1))
+						{
+						child.level=node.level-1;
+						child.x=cx;
+						child.y=cy;
+						
+						/* Insert the child in order of decreasing entry parameter: */
+						unsigned int i;
+						for(i=numChildren;i>0&&children[i-1].t0<child.t0;--i)
+							children[i]=children[i-1];
+						children[i]=child;
+						++numChildren;
+						}
+					}
+			
+			/* Push the children such that the closest one is processed first: */
+			for(unsigned int i=0;i<numChildren;++i)
+				stack[stackSize++]=children[i];
+			}
+		}
+	
+	if(bestTriangle>=0)
+		{
+		/* Store the intersection: */
+		hit.lambda=bestT;
+		hit.cameraIndex=cameraIndex;
+		hit.position=ray(bestT);
+		
+		/* Transform the triangle's plane to world space to calculate its normal vector: */
+		for(int i=0;i<3;++i)
+			{
+			hit.normal[i]=Scalar(0);
+			for(int j=0;j<4;++j)
+				hit.normal[i]+=bestPlane[j]*camera.inverseProjection[j][i];
+			}
+		hit.normal.normalize();
+		if(hit.normal*d>Scalar(0))
+			hit.normal=-hit.normal;
+		}
+	}
+
+FacadeRayCaster::FacadeRayCaster(void)
+	{
+	}
+
+FacadeRayCaster::~FacadeRayCaster(void)
+	{
+	for(std::vector<Camera*>::iterator cIt=cameras.begin();cIt!=cameras.end();++cIt)
+		delete *cIt;
+	}
+
+unsigned int FacadeRayCaster::addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps)
+	{
+	if(depthSize[0]<2||depthSize[1]<2)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size %ux%u is too small",depthSize[0],depthSize[1]);
+	
+	/* Initialize the new camera's projector: */
+	Camera* camera=new Camera;
+	camera->projector.setDepthFrameSize(depthSize);
+	camera->projector.setDepthCorrection(depthCorrection);
+	camera->projector.setIntrinsicParameters(ips);
+	camera->projector.setExtrinsicParameters(eps);
+	
+	/* Pre-compute undistorted pixel centers if the camera has lens distortion: */
+	if(!ips.depthLensDistortion.isIdentity())
+		{
+		camera->pixelCenters.reserve(depthSize.volume());
+		for(unsigned int y=0;y<depthSize[1];++y)
+			for(unsigned int x=0;x<depthSize[0];++x)
+				camera->pixelCenters.push_back(ips.undistortDepthPixel(x,y));
+		}
+	
+	/* Store the projection from world space into homogeneous depth image space: */
+	FrameSource::IntrinsicParameters::PTransform inverseProjection=Geometry::invert(camera->projector.worldDepthProjection);
+	const FrameSource::IntrinsicParameters::PTransform::Matrix& ipm=inverseProjection.getMatrix();
+	for(int i=0;i<4;++i)
+		for(int j=0;j<4;++j)
+			camera->inverseProjection[i][j]=Scalar(ipm(i,j));
+	
+	/* Create the depth pyramid's levels, starting with one node per pixel quad: */
+	Level level;
+	level.size[0]=depthSize[0]-1;
+	level.size[1]=depthSize[1]-1;
+	level.offset=0;
+	camera->levels.push_back(level);
+	while(level.size[0]>1||level.size[1]>1)
+		{
+		level.offset+=size_t(level.size[0])*size_t(level.size[1]);
+		level.size[0]=(level.size[0]+1)/2;
+		level.size[1]=(level.size[1]+1)/2;
+		camera->levels.push_back(level);
+		}
+	camera->numNodes=level.offset+1;
+	
+	/* Calculate the depth image-space x and y ranges of all pixel quads: */
+	camera->xyBounds.resize(camera->numNodes*4);
+	float* qbPtr=&camera->xyBounds[0];
+	for(unsigned int y=0;y<depthSize[1]-1;++y)
+		for(unsigned int x=0;x<depthSize[0]-1;++x,qbPtr+=4)
+			{
+			qbPtr[0]=qbPtr[2]=Math::Constants<float>::max;
+			qbPtr[1]=qbPtr[3]=-Math::Constants<float>::max;
+			for(unsigned int c=0;c<4;++c)
+				{
+				unsigned int cx=x+(c&0x1U);
+				unsigned int cy=y+(c>>1);
+				float p[2];
+				if(!camera->pixelCenters.empty())
+					{
+					const FrameSource::IntrinsicParameters::Point2& pc=camera->pixelCenters[size_t(cy)*size_t(depthSize[0])+cx];
+					p[0]=float(pc[0]);
+					p[1]=float(pc[1]);
+					}
+				else
+					{
+					p[0]=float(cx)+0.5f;
+					p[1]=float(cy)+0.5f;
+					}
+				for(int i=0;i<2;++i)
+					{
+					if(qbPtr[i*2+0]>p[i])
+						qbPtr[i*2+0]=p[i];
+					if(qbPtr[i*2+1]<p[i])
+						qbPtr[i*2+1]=p[i];
+					}
+				}
+			}
+	
+	/* Merge the x and y ranges up the pyramid: */
+	for(unsigned int l=1;l<camera->levels.size();++l)
+		{
+		const Level& child=camera->levels[l-1];
+		const Level& parent=camera->levels[l];
+		float* pbPtr=&camera->xyBounds[parent.offset*4];
+		for(unsigned int y=0;y<parent.size[1];++y)
+			for(unsigned int x=0;x<parent.size[0];++x,pbPtr+=4)
+				{
+				pbPtr[0]=pbPtr[2]=Math::Constants<float>::max;
+				pbPtr[1]=pbPtr[3]=-Math::Constants<float>::max;
+				for(unsigned int cy=y*2;cy<y*2+2&&cy<child.size[1];++cy)
+					for(unsigned int cx=x*2;cx<x*2+2&&cx<child.size[0];++cx)
+						{
+						const float* cbPtr=&camera->xyBounds[(child.offset+size_t(cy)*size_t(child.size[0])+cx)*4];
+						for(int i=0;i<4;i+=2)
+							{
+							if(pbPtr[i]>cbPtr[i])
+								pbPtr[i]=cbPtr[i];
+							if(pbPtr[i+1]<cbPtr[i+1])
+								pbPtr[i+1]=cbPtr[i+1];
+							}
+						}
+				}
+		}
+	
+	/* Start with an empty facade: */
+	camera->frontSign=Scalar(1);
+	
+	cameras.push_back(camera);
+	return cameras.size()-1;
+	}
+
+unsigned int FacadeRayCaster::addCamera(FrameSource& frameSource)
+	{
+	/* Query the frame source's calibration parameters: */
+	FrameSource::DepthCorrection* depthCorrection=frameSource.getDepthCorrectionParameters();
+	unsigned int result=addCamera(frameSource.getActualFrameSize(FrameSource::DEPTH),depthCorrection,frameSource.getIntrinsicParameters(),frameSource.getExtrinsicParameters());
+	delete depthCorrection;
+	
+	return result;
+	}
+
+void FacadeRayCaster::setTriangleDepthRange(unsigned int cameraIndex,FrameSource::DepthPixel newTriangleDepthRange)
+	{
+	if(cameraIndex>=cameras.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid camera index %u",cameraIndex);
+	cameras[cameraIndex]->projector.setTriangleDepthRange(newTriangleDepthRange);
+	}
+
+void FacadeRayCaster::setDepthFrame(unsigned int cameraIndex,const FrameBuffer& depthFrame)
+	{
+	if(cameraIndex>=cameras.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid camera index %u",cameraIndex);
+	Camera& camera=*cameras[cameraIndex];
+	const Size& depthSize=camera.projector.getDepthFrameSize();
+	if(depthFrame.getSize(0)!=depthSize[0]||depthFrame.getSize(1)!=depthSize[1])
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size does not match camera %u",cameraIndex);
+	unsigned int width=depthSize[0];
+	const Level& quads=camera.levels[0];
+	
+	/* Create a new frame state holding corrected depth values, the depth ranges of all pyramid nodes, and the triangulation cases of all quads: */
+	size_t numQuads=size_t(quads.size[0])*size_t(quads.size[1]);
+	FrameBuffer frame(depthSize,(depthSize.volume()+camera.numNodes*2)*sizeof(float)+numQuads*sizeof(Misc::UInt8),MemoryAccounting::PROJECTOR);
+	frame.timeStamp=depthFrame.timeStamp;
+	frame.metadata=depthFrame.metadata;
+	float* depths=frame.getData<float>();
+	float* zRanges=depths+depthSize.volume();
+	Misc::UInt8* cases=reinterpret_cast<Misc::UInt8*>(zRanges+camera.numNodes*2);
+	
+	/* Calculate corrected depth values for all valid pixels: */
+	const DepthPixel* dPtr=depthFrame.getData<DepthPixel>();
+	const FrameSource::DepthCorrection::PixelCorrection* dcPtr=camera.projector.getDepthCorrection();
+	Scalar frontSign=camera.frontSign;
+	bool haveFrontSign=false;
+	for(size_t index=0;index<depthSize.volume();++index)
+		{
+		if(dPtr[index]<maxValidDepth)
+			{
+			depths[index]=dcPtr!=0?dcPtr[index].correct(float(dPtr[index])):float(dPtr[index]);
+			
+			if(!haveFrontSign)
+				{
+				/* Points in front of the camera have the same homogeneous weight sign in depth image space as this pixel in world space: */
+				const FrameSource::IntrinsicParameters::PTransform::Matrix& wdpm=camera.projector.worldDepthProjection.getMatrix();
+				double px,py;
+				if(!camera.pixelCenters.empty())
+					{
+					px=camera.pixelCenters[index][0];
+					py=camera.pixelCenters[index][1];
+					}
+				else
+					{
+					px=double(index%width)+0.5;
+					py=double(index/width)+0.5;
+					}
+				double w=wdpm(3,0)*px+wdpm(3,1)*py+wdpm(3,2)*double(depths[index])+wdpm(3,3);
+				frontSign=w<0.0?Scalar(-1):Scalar(1);
+				haveFrontSign=true;
+				}
+			}
+		else
+			depths[index]=0.0f;
+		}
+	
+	/* Triangulate all pixel quads like Projector and calculate their depth ranges: */
+	unsigned int tdr=camera.projector.getTriangleDepthRange();
+	float* zPtr=zRanges;
+	Misc::UInt8* cPtr=cases;
+	for(unsigned int y=0;y<quads.size[1];++y)
+		{
+		const DepthPixel* dRow=dPtr+size_t(y)*size_t(width);
+		const float* zRow=depths+size_t(y)*size_t(width);
+		for(unsigned int x=0;x<quads.size[0];++x,zPtr+=2,++cPtr)
+			{
+			/* Calculate the quad's validity case index: */
+			unsigned int cornerOffsets[4]={x,x+1,x+width,x+width+1};
+			unsigned int caseIndex=0x0U;
+			for(int c=0;c<4;++c)
+				if(dRow[cornerOffsets[c]]<maxValidDepth)
+					caseIndex|=0x1U<<c;
+			
+			/* Check which of the quad's candidate triangles do not exceed the triangle depth range: */
+			unsigned int triangleMask=0x0U;
+			zPtr[0]=Math::Constants<float>::max;
+			zPtr[1]=-Math::Constants<float>::max;
+			const int* qcc=quadCaseCorners[caseIndex];
+			for(unsigned int i=0;i<quadCaseNumTriangles[caseIndex];++i,qcc+=3)
+				{
+				unsigned int minDepth,maxDepth;
+				minDepth=maxDepth=dRow[cornerOffsets[qcc[0]]];
+				for(int j=1;j<3;++j)
+					{
+					unsigned int d=dRow[cornerOffsets[qcc[j]]];
+					if(minDepth>d)
+						minDepth=d;
+					if(maxDepth<d)
+						maxDepth=d;
+					}
+				if(maxDepth-minDepth<=tdr)
+					{
+					triangleMask|=0x1U<<i;
+					for(int j=0;j<3;++j)
+						{
+						float z=zRow[cornerOffsets[qcc[j]]];
+						if(zPtr[0]>z)
+							zPtr[0]=z;
+						if(zPtr[1]<z)
+							zPtr[1]=z;
+						}
+					}
+				}
+			*cPtr=Misc::UInt8(caseIndex|(triangleMask<<4));
+			}
+		}
+	
+	/* Merge the depth ranges up the pyramid: */
+	for(unsigned int l=1;l<camera.levels.size();++l)
+		{
+		const Level& child=camera.levels[l-1];
+		const Level& parent=camera.levels[l];
+		float* pzPtr=zRanges+parent.offset*2;
+		for(unsigned int y=0;y<parent.size[1];++y)
+			for(unsigned int x=0;x<parent.size[0];++x,pzPtr+=2)
+				{
+				pzPtr[0]=Math::Constants<float>::max;
+				pzPtr[1]=-Math::Constants<float>::max;
+				for(unsigned int cy=y*2;cy<y*2+2&&cy<child.size[1];++cy)
+					for(unsigned int cx=x*2;cx<x*2+2&&cx<child.size[0];++cx)
+						{
+						const float* czPtr=zRanges+(child.offset+size_t(cy)*size_t(child.size[0])+cx)*2;
+						if(pzPtr[0]>czPtr[0])
+							pzPtr[0]=czPtr[0];
+						if(pzPtr[1]<czPtr[1])
+							pzPtr[1]=czPtr[1];
+						}
+				}
+		}
+	
+	/* Replace the camera's current frame state: */
+	{
+	Threads::Spinlock::Lock frameLock(camera.frameMutex);
+	camera.frame=frame;
+	camera.frontSign=frontSign;
+	}
+	}
+
+FacadeRayCaster::Hit FacadeRayCaster::castRay(const FacadeRayCaster::Ray& ray,FacadeRayCaster::Scalar maxLambda) const
+	{
+	Hit result;
+	castRays(1,&ray,maxLambda,&result);
+	return result;
+	}
+
+void FacadeRayCaster::castRays(size_t numRays,const FacadeRayCaster::Ray rays[],FacadeRayCaster::Scalar maxLambda,FacadeRayCaster::Hit hits[]) const
+	{
+	/* Reset all hits: */
+	for(size_t i=0;i<numRays;++i)
+		hits[i]=Hit();
+	
+	for(unsigned int cameraIndex=0;cameraIndex<cameras.size();++cameraIndex)
+		{
+		/* Grab the camera's current frame state: */
+		FrameState state;
+		{
+		Camera& camera=*cameras[cameraIndex];
+		Threads::Spinlock::Lock frameLock(camera.frameMutex);
+		state.frame=camera.frame;
+		state.frontSign=camera.frontSign;
+		}
+		
+		/* Intersect all rays with the camera's facade if it has one: */
+		if(state.frame.isValid())
+			for(size_t i=0;i<numRays;++i)
+				castRay(cameraIndex,state,rays[i],maxLambda,hits[i]);
+		}
+	}
+
+}
@@ -0,0 +1,135 @@
+/***********************************************************************
+FacadeRayCaster - Class to intersect world-space rays with the facades
+most recently reconstructed from the depth frames of one or more
+calibrated cameras, using per-camera min/max depth pyramids.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FACADERAYCASTER_INCLUDED
+#define KINECT_FACADERAYCASTER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Threads/Spinlock.h>
+#include <Math/Constants.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Ray.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ProjectorBase.h>
+
+namespace Kinect {
+
+class FacadeRayCaster
+	{
+	/* Embedded classes: */
+	public:
+	typedef double Scalar; // Scalar type for world space
+	typedef Geometry::Point<Scalar,3> Point; // Type for points in world space
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors in world space
+	typedef Geometry::Ray<Scalar,3> Ray; // Type for rays in world space
+	
+	struct Hit // Structure for the first intersection of a ray with any camera's facade
+		{
+		/* Elements: */
+		public:
+		Scalar lambda; // Ray parameter of the intersection, or Math::Constants<Scalar>::max if the ray did not hit any facade
+		unsigned int cameraIndex; // Index of the camera whose facade was hit
+		Point position; // Intersection point in world space
+		Vector normal; // Unit-length world-space normal vector of the hit facade triangle, facing against the ray's direction
+		
+		/* Constructors and destructors: */
+		Hit(void) // Creates a miss
+			:lambda(Math::Constants<Scalar>::max),cameraIndex(~0U)
+			{
+			}
+		
+		/* Methods: */
+		bool isValid(void) const // Returns true if the ray hit a facade
+			{
+			return lambda<Math::Constants<Scalar>::max;
+			}
+		};
+	
+	private:
+	struct Level // Structure describing one level of a camera's depth pyramid
+		{
+		/* Elements: */
+		public:
+		unsigned int size[2]; // Number of nodes in each dimension
+		size_t offset; // Index of the level's first node in the pyramid's node arrays
+		};
+	
+	struct Camera // Structure holding per-camera ray casting state
+		{
+		/* Elements: */
+		public:
+		ProjectorBase projector; // Projector holding the camera's intrinsic and extrinsic parameters and per-pixel depth correction
+		std::vector<FrameSource::IntrinsicParameters::Point2> pixelCenters; // Undistorted depth image-space pixel centers if the camera has lens distortion; empty otherwise
+		Scalar inverseProjection[4][4]; // Matrix of the projection from world space into homogeneous depth image space
+		std::vector<Level> levels; // Levels of the depth pyramid from individual pixel quads up to the root
+		size_t numNodes; // Total number of nodes in all pyramid levels
+		std::vector<float> xyBounds; // Static depth image-space x and y ranges of all pyramid nodes, four values per node
+		Threads::Spinlock frameMutex; // Mutex protecting the most recent frame state
+		FrameBuffer frame; // Most recent frame state holding corrected depth values, depth ranges of all pyramid nodes, and triangulation cases of all quads
+		Scalar frontSign; // Sign of the homogeneous weight of points in front of the camera in the most recent frame
+		};
+	
+	struct FrameState // Structure holding a consistent copy of a camera's most recent frame state for the duration of a query
+		{
+		/* Elements: */
+		public:
+		FrameBuffer frame; // The frame state
+		Scalar frontSign; // Sign of the homogeneous weight of points in front of the camera
+		};
+	
+	/* Elements: */
+	std::vector<Camera*> cameras; // List of cameras feeding the ray caster
+	
+	/* Private methods: */
+	void castRay(unsigned int cameraIndex,const FrameState& state,const Ray& ray,Scalar maxLambda,Hit& hit) const; // Intersects the given ray with the given camera's facade, and updates the given hit if the new intersection is closer
+	
+	/* Constructors and destructors: */
+	public:
+	FacadeRayCaster(void); // Creates a ray caster without cameras
+	private:
+	FacadeRayCaster(const FacadeRayCaster& source); // Prohibit copy constructor
+	FacadeRayCaster& operator=(const FacadeRayCaster& source); // Prohibit assignment operator
+	public:
+	~FacadeRayCaster(void);
+	
+	/* Methods: */
+	unsigned int addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps); // Adds a camera with the given depth frame size and calibration parameters; returns the camera's index; must not be called while frames are set or rays are cast
+	unsigned int addCamera(FrameSource& frameSource); // Adds a camera using the given frame source's calibration parameters; returns the camera's index; must not be called while frames are set or rays are cast
+	unsigned int getNumCameras(void) const // Returns the number of cameras feeding the ray caster
+		{
+		return cameras.size();
+		}
+	void setTriangleDepthRange(unsigned int cameraIndex,FrameSource::DepthPixel newTriangleDepthRange); // Sets the maximum depth range of facade triangles for the given camera, to match the camera's projector; takes effect with the next depth frame
+	void setDepthFrame(unsigned int cameraIndex,const FrameBuffer& depthFrame); // Replaces the given camera's facade with the one reconstructed from the given depth frame; can be called from a different thread for each camera, concurrently with ray queries
+	Hit castRay(const Ray& ray,Scalar maxLambda =Math::Constants<Scalar>::max) const; // Returns the first intersection of the given ray with any camera's current facade between ray parameters 0 and the given maximum
+	void castRays(size_t numRays,const Ray rays[],Scalar maxLambda,Hit hits[]) const; // Intersects a batch of rays with the same consistent set of facades
+	};
+
+}
+
+#endif
@@ -0,0 +1,392 @@
+/***********************************************************************
+FacadeStitcher - Class to remove redundant surface coverage from the
+depth frames of multiple calibrated cameras before triangulation, by
+assigning each surface region seen by several cameras to the camera
+with the best view of it.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FacadeStitcher.h>
+
+#include <Misc/StdError.h>
+#include <Misc/FunctionCalls.h>
+#include <Math/Math.h>
+#include <Geometry/ProjectiveTransformation.h>
+#include <Kinect/NormalEstimator.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+
+void copyMatrix(const FrameSource::IntrinsicParameters::PTransform& transform,float matrix[4][4]) // Copies the given projective transformation's matrix
+	{
+	const FrameSource::IntrinsicParameters::PTransform::Matrix& m=transform.getMatrix();
+	for(int i=0;i<4;++i)
+		for(int j=0;j<4;++j)
+			matrix[i][j]=float(m(i,j));
+	}
+
+}
+
+/***************************************
+Methods of class FacadeStitcher::Camera:
+***************************************/
+
+FacadeStitcher::Camera::Camera(void)
+	:normalEstimator(0),
+	 numValidPixels(0),numSuppressedPixels(0)
+	{
+	}
+
+FacadeStitcher::Camera::~Camera(void)
+	{
+	delete normalEstimator;
+	}
+
+/*******************************
+Methods of class FacadeStitcher:
+*******************************/
+
+void FacadeStitcher::unprojectFrame(unsigned int cameraIndex)
+	{
+	Camera& camera=*cameras[cameraIndex];
+	const Size& depthSize=camera.projector.getDepthFrameSize();
+	const DepthPixel* dPtr=camera.depthFrame.getData<DepthPixel>();
+	const FrameSource::DepthCorrection::PixelCorrection* dcPtr=camera.projector.getDepthCorrection();
+	const FrameSource::IntrinsicParameters::Point2* pcPtr=camera.pixelCenters.empty()?0:&camera.pixelCenters[0];
+	
+	/* Estimate normal vectors for all pixels: */
+	camera.normalEstimator->estimate(camera.depthFrame,dcPtr,camera.projector.worldDepthProjection,camera.projector.getTriangleDepthRange(),&camera.normals[0]);
+	
+	/* Unproject all valid pixels and calculate their view quality scores: */
+	Point center(camera.center);
+	const float (*m)[4]=camera.worldDepthMatrix;
+	size_t numValidPixels=0;
+	size_t index=0;
+	for(unsigned int y=0;y<depthSize[1];++y)
+		for(unsigned int x=0;x<depthSize[0];++x,++index)
+			{
+			if(dPtr[index]>=maxValidDepth)
+				{
+				camera.scores[index]=0.0f;
+				continue;
+				}
+			
+			/* Calculate the pixel's position in depth image space: */
+			float dip[3];
+			if(pcPtr!=0)
+				{
+				dip[0]=float(pcPtr[index][0]);
+				dip[1]=float(pcPtr[index][1]);
+				}
+			else
+				{
+				dip[0]=float(x)+0.5f;
+				dip[1]=float(y)+0.5f;
+				}
+			dip[2]=dcPtr!=0?dcPtr[index].correct(float(dPtr[index])):float(dPtr[index]);
+			
+			/* Transform the pixel to world space: */
+			float h[4];
+			for(int i=0;i<4;++i)
+				h[i]=m[i][0]*dip[0]+m[i][1]*dip[1]+m[i][2]*dip[2]+m[i][3];
+			Point& p=camera.positions[index];
+			for(int i=0;i<3;++i)
+				p[i]=h[i]/h[3];
+			
+			/*************************************************************
+			Score the pixel by the cosine of the angle between its normal
+			vector and its viewing direction, divided by its squared
+			distance from the camera to account for depth noise growing
+			with distance.
+			*************************************************************/
+			
+			float v[3];
+			float dist2=0.0f;
+			float cosine=0.0f;
+			for(int i=0;i<3;++i)
+				{
+				v[i]=center[i]-p[i];
+				dist2+=v[i]*v[i];
+				cosine+=float(camera.normals[index].components[i])*v[i];
+				}
+			cosine=Math::abs(cosine)/(127.0f*Math::sqrt(dist2));
+			camera.scores[index]=(cosine>1.0e-3f?cosine:1.0e-3f)/(dist2>0.0f?dist2:1.0f);
+			++numValidPixels;
+			}
+	
+	camera.numValidPixels=numValidPixels;
+	}
+
+void FacadeStitcher::findOwners(unsigned int cameraIndex,unsigned int firstRow,unsigned int lastRow)
+	{
+	const Camera& camera=*cameras[cameraIndex];
+	unsigned int width=camera.projector.getDepthFrameSize(0);
+	float maxDist2=maxOverlapDistance*maxOverlapDistance;
+	
+	for(unsigned int y=firstRow;y<lastRow;++y)
+		{
+		size_t index=size_t(y)*size_t(width);
+		for(unsigned int x=0;x<width;++x,++index)
+			{
+			float score=camera.scores[index];
+			if(score==0.0f)
+				{
+				cameras[cameraIndex]->owners[index]=0;
+				continue;
+				}
+			const Point& p=camera.positions[index];
+			
+			/* Check if any other camera has a better view of the same surface: */
+			Misc::UInt8 owner=1;
+			for(unsigned int otherIndex=0;otherIndex<cameras.size()&&owner==1;++otherIndex)
+				{
+				const Camera& other=*cameras[otherIndex];
+				if(otherIndex==cameraIndex||!other.depthFrame.isValid())
+					continue;
+				
+				/* Project the pixel into the other camera's depth image: */
+				const float (*m)[4]=other.depthWorldMatrix;
+				float h[4];
+				for(int i=0;i<4;++i)
+					h[i]=m[i][0]*p[0]+m[i][1]*p[1]+m[i][2]*p[2]+m[i][3];
+				if(h[3]==0.0f)
+					continue;
+				FrameSource::IntrinsicParameters::Point2 dip(h[0]/h[3],h[1]/h[3]);
+				if(!other.pixelCenters.empty())
+					dip=other.projector.getIntrinsicParameters().distortDepthPixel(dip);
+				const Size& otherSize=other.projector.getDepthFrameSize();
+				if(!(dip[0]>=0.0&&dip[0]<double(otherSize[0])&&dip[1]>=0.0&&dip[1]<double(otherSize[1])))
+					continue;
+				size_t otherPixel=size_t(dip[1])*size_t(otherSize[0])+size_t(dip[0]);
+				
+				/* Check if the other camera sees the same surface at that pixel, instead of an occluder or nothing: */
+				float otherScore=other.scores[otherPixel];
+				if(otherScore==0.0f||Geometry::sqrDist(other.positions[otherPixel],p)>maxDist2)
+					continue;
+				
+				/* Give the surface to the camera with the better view, breaking ties by camera index: */
+				if(otherScore>score||(otherScore==score&&otherIndex<cameraIndex))
+					owner=2;
+				}
+			cameras[cameraIndex]->owners[index]=owner;
+			}
+		}
+	}
+
+size_t FacadeStitcher::createStitchedRows(unsigned int cameraIndex,unsigned int firstRow,unsigned int lastRow)
+	{
+	Camera& camera=*cameras[cameraIndex];
+	unsigned int width=camera.projector.getDepthFrameSize(0);
+	unsigned int height=camera.projector.getDepthFrameSize(1);
+	const DepthPixel* in=camera.depthFrame.getData<DepthPixel>();
+	DepthPixel* out=camera.stitchedFrame.getData<DepthPixel>();
+	const Misc::UInt8* owners=&camera.owners[0];
+	
+	size_t result=0;
+	for(unsigned int y=firstRow;y<lastRow;++y)
+		{
+		size_t index=size_t(y)*size_t(width);
+		for(unsigned int x=0;x<width;++x,++index)
+			{
+			out[index]=in[index];
+			if(owners[index]!=2)
+				continue;
+			
+			/* Keep pixels that are next to an owned pixel, to zipper the facades together with one overlapping row of triangles: */
+			bool seam=false;
+			for(unsigned int ny=y>0?y-1:y;ny<=y+1&&ny<height&&!seam;++ny)
+				for(unsigned int nx=x>0?x-1:x;nx<=x+1&&nx<width&&!seam;++nx)
+					seam=owners[size_t(ny)*size_t(width)+nx]==1;
+			if(!seam)
+				{
+				out[index]=FrameSource::invalidDepth;
+				++result;
+				}
+			}
+		}
+	
+	return result;
+	}
+
+void FacadeStitcher::processJob(unsigned int jobIndex)
+	{
+	/* Process the job: */
+	const Job& job=jobs[jobIndex];
+	if(pass==0)
+		unprojectFrame(job.cameraIndex);
+	else if(pass==1)
+		findOwners(job.cameraIndex,job.firstRow,job.lastRow);
+	else
+		{
+		size_t numSuppressed=createStitchedRows(job.cameraIndex,job.firstRow,job.lastRow);
+		
+		/* Count the job's invalidated pixels: */
+		Threads::Mutex::Lock suppressedLock(suppressedMutex);
+		cameras[job.cameraIndex]->numSuppressedPixels+=numSuppressed;
+		}
+	}
+
+void FacadeStitcher::runPass(int newPass,std::vector<FacadeStitcher::Job>& newJobs)
+	{
+	/* Process all jobs of the pass in parallel: */
+	jobs.swap(newJobs);
+	pass=newPass;
+	jobPool.run((unsigned int)(jobs.size()),Misc::VoidMethodCall<unsigned int,FacadeStitcher>(this,&FacadeStitcher::processJob));
+	}
+
+FacadeStitcher::FacadeStitcher(unsigned int numThreads)
+	:maxOverlapDistance(2.0f),
+	 pass(0),
+	 jobPool(numThreads)
+	{
+	}
+
+FacadeStitcher::~FacadeStitcher(void)
+	{
+	for(std::vector<Camera*>::iterator cIt=cameras.begin();cIt!=cameras.end();++cIt)
+		delete *cIt;
+	}
+
+unsigned int FacadeStitcher::addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps)
+	{
+	/* Initialize the new camera's projector: */
+	Camera* camera=new Camera;
+	camera->projector.setDepthFrameSize(depthSize);
+	camera->projector.setDepthCorrection(depthCorrection);
+	camera->projector.setIntrinsicParameters(ips);
+	camera->projector.setExtrinsicParameters(eps);
+	
+	/* Pre-compute undistorted pixel centers if the camera has lens distortion: */
+	if(!ips.depthLensDistortion.isIdentity())
+		{
+		camera->pixelCenters.reserve(depthSize.volume());
+		for(unsigned int y=0;y<depthSize[1];++y)
+			for(unsigned int x=0;x<depthSize[0];++x)
+				camera->pixelCenters.push_back(ips.undistortDepthPixel(x,y));
+		}
+	
+	/* Calculate the camera's center of projection and the projections between depth image space and world space: */
+	camera->center=eps.transform(ProjectorBase::Point::origin);
+	copyMatrix(camera->projector.worldDepthProjection,camera->worldDepthMatrix);
+	copyMatrix(Geometry::invert(camera->projector.worldDepthProjection),camera->depthWorldMatrix);
+	
+	/* Create the camera's normal estimator, which runs inside the stitcher's own jobs: */
+	camera->normalEstimator=new NormalEstimator(1);
+	camera->normalEstimator->setIntrinsicParameters(depthSize,ips);
+	
+	/* Allocate the per-pixel state: */
+	camera->positions.resize(depthSize.volume());
+	camera->normals.resize(depthSize.volume());
+	camera->scores.resize(depthSize.volume(),0.0f);
+	camera->owners.resize(depthSize.volume(),0);
+	
+	cameras.push_back(camera);
+	return cameras.size()-1;
+	}
+
+unsigned int FacadeStitcher::addCamera(FrameSource& frameSource)
+	{
+	/* Query the frame source's calibration parameters: */
+	FrameSource::DepthCorrection* depthCorrection=frameSource.getDepthCorrectionParameters();
+	unsigned int result=addCamera(frameSource.getActualFrameSize(FrameSource::DEPTH),depthCorrection,frameSource.getIntrinsicParameters(),frameSource.getExtrinsicParameters());
+	delete depthCorrection;
+	
+	return result;
+	}
+
+void FacadeStitcher::setTriangleDepthRange(unsigned int cameraIndex,FrameSource::DepthPixel newTriangleDepthRange)
+	{
+	if(cameraIndex>=cameras.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid camera index %u",cameraIndex);
+	cameras[cameraIndex]->projector.setTriangleDepthRange(newTriangleDepthRange);
+	}
+
+void FacadeStitcher::setMaxOverlapDistance(float newMaxOverlapDistance)
+	{
+	maxOverlapDistance=newMaxOverlapDistance;
+	}
+
+void FacadeStitcher::stitch(const FrameBuffer depthFrames[],FrameBuffer stitchedFrames[])
+	{
+	/* Store the meta-frame's new depth frames and unproject them: */
+	std::vector<Job> newJobs;
+	for(unsigned int i=0;i<cameras.size();++i)
+		{
+		Camera& camera=*cameras[i];
+		if(depthFrames[i].isValid())
+			{
+			const Size& depthSize=camera.projector.getDepthFrameSize();
+			if(depthFrames[i].getSize(0)!=depthSize[0]||depthFrames[i].getSize(1)!=depthSize[1])
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size does not match camera %u",i);
+			camera.depthFrame=depthFrames[i];
+			
+			Job job;
+			job.cameraIndex=i;
+			job.firstRow=0;
+			job.lastRow=depthSize[1];
+			newJobs.push_back(job);
+			}
+		}
+	runPass(0,newJobs);
+	
+	/* Create row band jobs for all cameras that have depth frames, and prepare their stitched frames: */
+	std::vector<Job> bandJobs;
+	for(unsigned int i=0;i<cameras.size();++i)
+		{
+		Camera& camera=*cameras[i];
+		if(!camera.depthFrame.isValid())
+			continue;
+		
+		const Size& depthSize=camera.projector.getDepthFrameSize();
+		for(unsigned int firstRow=0;firstRow<depthSize[1];firstRow+=bandHeight)
+			{
+			Job job;
+			job.cameraIndex=i;
+			job.firstRow=firstRow;
+			job.lastRow=depthSize[1]-firstRow<bandHeight?depthSize[1]:firstRow+bandHeight;
+			bandJobs.push_back(job);
+			}
+		
+		camera.stitchedFrame=FrameBuffer(depthSize,depthSize.volume()*sizeof(DepthPixel),MemoryAccounting::FRAME_FILTER);
+		camera.stitchedFrame.timeStamp=camera.depthFrame.timeStamp;
+		camera.stitchedFrame.metadata=camera.depthFrame.metadata;
+		camera.numSuppressedPixels=0;
+		}
+	
+	/* Determine pixel ownership, and then create the stitched frames: */
+	newJobs=bandJobs;
+	runPass(1,newJobs);
+	runPass(2,bandJobs);
+	
+	/* Return the stitched frames: */
+	for(unsigned int i=0;i<cameras.size();++i)
+		stitchedFrames[i]=cameras[i]->stitchedFrame;
+	}
+
+}
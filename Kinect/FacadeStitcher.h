@@ -0,0 +1,138 @@
+/***********************************************************************
+FacadeStitcher - Class to remove redundant surface coverage from the
+depth frames of multiple calibrated cameras before triangulation, by
+assigning each surface region seen by several cameras to the camera
+with the best view of it.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FACADESTITCHER_INCLUDED
+#define KINECT_FACADESTITCHER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/Mutex.h>
+#include <Geometry/Point.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/ProjectorBase.h>
+#include <Kinect/ParallelJobPool.h>
+
+/* Forward declarations: */
+namespace Kinect {
+class NormalEstimator;
+}
+
+namespace Kinect {
+
+class FacadeStitcher
+	{
+	/* Embedded classes: */
+	public:
+	typedef Geometry::Point<float,3> Point; // Type for pixel positions in world space
+	
+	private:
+	struct Camera // Structure holding per-camera stitching state
+		{
+		/* Elements: */
+		public:
+		ProjectorBase projector; // Projector holding the camera's intrinsic and extrinsic parameters and per-pixel depth correction
+		std::vector<FrameSource::IntrinsicParameters::Point2> pixelCenters; // Undistorted depth image-space pixel centers if the camera has lens distortion; empty otherwise
+		ProjectorBase::Point center; // Camera's center of projection in world space
+		float worldDepthMatrix[4][4]; // Projection from depth image space into homogeneous world space
+		float depthWorldMatrix[4][4]; // Projection from world space into homogeneous depth image space
+		NormalEstimator* normalEstimator; // Single-threaded estimator for per-pixel world-space normal vectors
+		FrameBuffer depthFrame; // Most recent depth frame
+		std::vector<Point> positions; // World-space positions of all pixels of the most recent depth frame
+		std::vector<MeshBuffer::PackedNormal> normals; // World-space normal vectors of all pixels of the most recent depth frame
+		std::vector<float> scores; // View quality scores of all pixels of the most recent depth frame; zero for invalid pixels
+		std::vector<Misc::UInt8> owners; // Ownership flags of all pixels in the current meta-frame; 0: invalid, 1: owned, 2: owned by another camera
+		FrameBuffer stitchedFrame; // Stitched depth frame for the current meta-frame
+		size_t numValidPixels; // Number of valid pixels in the most recent depth frame
+		size_t numSuppressedPixels; // Number of valid pixels invalidated in the current meta-frame
+		
+		/* Constructors and destructors: */
+		Camera(void);
+		~Camera(void);
+		};
+	
+	struct Job // Structure for units of work in a processing pass
+		{
+		/* Elements: */
+		public:
+		unsigned int cameraIndex; // Index of the camera to process
+		unsigned int firstRow,lastRow; // Range of depth frame rows to process
+		};
+	
+	/* Elements: */
+	std::vector<Camera*> cameras; // List of cameras feeding the stitcher
+	float maxOverlapDistance; // Maximum world-space distance between pixels of different cameras that see the same surface
+	static const unsigned int bandHeight=32; // Number of frame rows in each job of the row-parallel processing passes
+	int pass; // Current processing pass; 0: unproject new frames, 1: determine pixel ownership, 2: create stitched frames
+	std::vector<Job> jobs; // Jobs of the current pass
+	Threads::Mutex suppressedMutex; // Mutex protecting the cameras' suppressed pixel counters
+	ParallelJobPool jobPool; // Pool of threads processing the jobs of the current pass
+	
+	/* Private methods: */
+	void unprojectFrame(unsigned int cameraIndex); // Calculates world-space positions, normal vectors, and view quality scores for a camera's new depth frame
+	void findOwners(unsigned int cameraIndex,unsigned int firstRow,unsigned int lastRow); // Determines which pixels in the given row range of a camera's depth frame are better seen by another camera
+	size_t createStitchedRows(unsigned int cameraIndex,unsigned int firstRow,unsigned int lastRow); // Writes the given row range of a camera's stitched depth frame; returns number of invalidated pixels
+	void processJob(unsigned int jobIndex); // Processes the job of the given index in the current pass
+	void runPass(int newPass,std::vector<Job>& newJobs); // Processes the given jobs in the given pass using all threads
+	
+	/* Constructors and destructors: */
+	public:
+	FacadeStitcher(unsigned int numThreads =2); // Creates a stitcher without cameras using the given total number of threads
+	private:
+	FacadeStitcher(const FacadeStitcher& source); // Prohibit copy constructor
+	FacadeStitcher& operator=(const FacadeStitcher& source); // Prohibit assignment operator
+	public:
+	~FacadeStitcher(void);
+	
+	/* Methods: */
+	unsigned int addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps); // Adds a camera with the given depth frame size and calibration parameters; returns the camera's index
+	unsigned int addCamera(FrameSource& frameSource); // Adds a camera using the given frame source's calibration parameters; returns the camera's index
+	unsigned int getNumCameras(void) const // Returns the number of cameras feeding the stitcher
+		{
+		return cameras.size();
+		}
+	void setTriangleDepthRange(unsigned int cameraIndex,FrameSource::DepthPixel newTriangleDepthRange); // Sets the maximum depth range of the given camera's triangles, used to detect depth discontinuities
+	float getMaxOverlapDistance(void) const // Returns the maximum distance between pixels considered to see the same surface
+		{
+		return maxOverlapDistance;
+		}
+	void setMaxOverlapDistance(float newMaxOverlapDistance); // Sets the maximum world-space distance between pixels of different cameras considered to see the same surface
+	void stitch(const FrameBuffer depthFrames[],FrameBuffer stitchedFrames[]); // Stitches a meta-frame; depthFrames contains one new depth frame or an invalid frame buffer per camera, where cameras without new frames keep their previous frames; stitchedFrames receives one stitched frame per camera that has a frame
+	size_t getNumValidPixels(unsigned int cameraIndex) const // Returns the number of valid pixels in the given camera's most recent depth frame
+		{
+		return cameras[cameraIndex]->numValidPixels;
+		}
+	size_t getNumSuppressedPixels(unsigned int cameraIndex) const // Returns the number of valid pixels invalidated in the given camera's most recent stitched frame
+		{
+		return cameras[cameraIndex]->numSuppressedPixels;
+		}
+	};
+
+}
+
+#endif
@@ -29,12 +29,11 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/MessageLogger.h>
 #include <IO/OpenFile.h>
 #include <Math/Constants.h>
-#include <Geometry/GeometryMarshallers.h>
-#include <Video/Config.h>
 #include <Kinect/FrameBuffer.h>
-#include <Kinect/ColorFrameReader.h>
-#include <Kinect/DepthFrameReader.h>
-#include <Kinect/LossyDepthFrameReader.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
 
 namespace Kinect {
 
@@ -44,81 +43,54 @@ Methods of class FileFrameSource:
 
 void FileFrameSource::initialize(void)
 	{
-	/* Read the file's format version numbers: */
-	fileFormatVersions[0]=colorFrameFile->read<Misc::UInt32>();
-	fileFormatVersions[1]=depthFrameFile->read<Misc::UInt32>();
+	/* Read the color and depth files' headers: */
+	ColorFileHeader colorFileHeader(*colorFrameFile);
+	DepthFileHeader depthFileHeader(*depthFrameFile);
+	fileFormatVersions[0]=colorFileHeader.formatVersion;
+	fileFormatVersions[1]=depthFileHeader.formatVersion;
 	
-	/* Check if there are per-pixel depth correction coefficients: */
-	if(fileFormatVersions[1]>=4)
+	/* Take the depth correction parameters, or create a dummy depth correction object if the file has none: */
+	depthCorrection=depthFileHeader.detachDepthCorrection();
+	if(depthCorrection!=0&&!depthCorrection->isValid())
 		{
-		/* Read new B-spline based depth correction parameters: */
-		depthCorrection=new DepthCorrection(*depthFrameFile);
-		if(!depthCorrection->isValid())
-			{
-			delete depthCorrection;
-			depthCorrection=0;
-			}
+		delete depthCorrection;
+		depthCorrection=0;
 		}
-	else
-		{
-		if(fileFormatVersions[1]>=2&&depthFrameFile->read<Misc::UInt8>()!=0)
-			{
-			/* Skip the depth correction buffer: */
-			Size size;
-			depthFrameFile->read<Misc::UInt32,unsigned int>(size.getComponents(),2);
-			depthFrameFile->skip<Misc::Float32>(size.volume()*2);
-			}
-		
-		/* Create a dummy depth correction object: */
+	if(fileFormatVersions[1]<4)
 		depthCorrection=new DepthCorrection(0,Size(1,1));
-		}
-	
-	/* Check if the depth stream uses lossy compression: */
-	bool depthIsLossy=fileFormatVersions[1]>=3&&depthFrameFile->read<Misc::UInt8>()!=0;
 	
-	/* Check if the color camera has lens distortion correction parameters: */
-	if(fileFormatVersions[0]>=2)
-		{
-		/* Read the color camera's lens distortion correction parameters: */
-		intrinsicParameters.colorLensDistortion=IntrinsicParameters::readLensDistortion(*colorFrameFile,true);
-		}
-	
-	/* Check if the depth camera has lens distortion correction parameters: */
-	if(fileFormatVersions[1]>=5)
-		{
-		/* Read the depth camera's lens distortion correction parameters: */
-		intrinsicParameters.depthLensDistortion=IntrinsicParameters::readLensDistortion(*depthFrameFile,fileFormatVersions[1]>=6);
-		}
-	
-	/* Read the color and depth projections from their respective files: */
-	intrinsicParameters.colorProjection=Misc::Marshaller<IntrinsicParameters::PTransform>::read(*colorFrameFile);
-	intrinsicParameters.depthProjection=Misc::Marshaller<IntrinsicParameters::PTransform>::read(*depthFrameFile);
+	/* Retrieve the color and depth cameras' intrinsic parameters: */
+	intrinsicParameters.colorLensDistortion=colorFileHeader.lensDistortion;
+	intrinsicParameters.depthLensDistortion=depthFileHeader.lensDistortion;
+	intrinsicParameters.colorProjection=colorFileHeader.projection;
+	intrinsicParameters.depthProjection=depthFileHeader.projection;
 	
 	/* Calculate the image-space transformations: */
 	intrinsicParameters.updateTransforms();
 	
-	/* Read the camera transformation from the depth file: */
-	extrinsicParameters=Misc::Marshaller<ExtrinsicParameters>::read(*depthFrameFile);
+	/* Retrieve the camera transformation from the depth file: */
+	extrinsicParameters=depthFileHeader.extrinsicParameters;
 	
 	/* Create the color and depth frame readers: */
-	colorFrameReader=new ColorFrameReader(*colorFrameFile);
-	if(depthIsLossy)
+	colorFrameReader=colorFileHeader.createReader(*colorFrameFile);
+	try
+		{
+		depthFrameReader=depthFileHeader.createReader(*depthFrameFile);
+		}
+	catch(...)
 		{
-		#if VIDEO_CONFIG_HAVE_THEORA
-		depthFrameReader=new LossyDepthFrameReader(*depthFrameFile);
-		#else
 		delete colorFrameReader;
-		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Lossy depth compression not supported due to lack of Theora library");
-		#endif
+		colorFrameReader=0;
+		throw;
 		}
-	else
-		depthFrameReader=new DepthFrameReader(*depthFrameFile);
+	colorFrameReader->setMemoryTag(MemoryAccounting::FILE_PLAYBACK);
+	depthFrameReader->setMemoryTag(MemoryAccounting::FILE_PLAYBACK);
 	
 	/* Get the depth reader's frame size: */
 	depthSize=depthFrameReader->getSize();
 	
-	/* Set the source color space to Y'CbCr: */
-	colorSpace=YPCBCR;
+	/* Set the source color space to the color reader's color space: */
+	colorSpace=Kinect::getColorSpace(*colorFrameReader);
 	}
 
 void* FileFrameSource::colorStreamingThreadMethod(void)
@@ -191,8 +163,9 @@ void* FileFrameSource::depthStreamingThreadMethod(void)
 		while(runStreamingThreads&&lastTimeStamp<Math::Constants<double>::max)
 			{
 			/* Create a median-filtered depth frame: */
-			FrameBuffer median(depthSize,depthSize.volume()*sizeof(DepthPixel));
+			FrameBuffer median(depthSize,depthSize.volume()*sizeof(DepthPixel),MemoryAccounting::FILE_PLAYBACK);
 			median.timeStamp=depthFrames[nextDepthFrame].timeStamp;
+			median.metadata=depthFrames[nextDepthFrame].metadata;
 			DepthPixel* mPtr=median.getData<DepthPixel>();
 			DepthPixel* mEnd=mPtr+depthSize.volume();
 			const DepthPixel* d0Ptr=depthFrames[0].getData<DepthPixel>();
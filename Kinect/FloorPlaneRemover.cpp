@@ -0,0 +1,364 @@
+/***********************************************************************
+FloorPlaneRemover - Class to detect the floor plane in depth frames
+using a robust plane estimator running at low rate in a background
+thread, and to remove floor pixels from every depth frame.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FloorPlaneRemover.h>
+
+#include <string.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <Math/Math.h>
+#include <Math/Random.h>
+#include <Geometry/PCACalculator.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+const unsigned int sampleStep=4; // Distance between depth pixels sampled for floor plane estimation
+const unsigned int numHypotheses=256; // Number of random floor plane candidates tested per estimation
+const double minInlierFraction=0.05; // Minimum fraction of sampled points that must support a floor plane
+
+size_t removeRow(DepthPixel* row,unsigned int width,float rowBase,float cx,float cd) // Invalidates all pixels in a row whose floor test value rowBase+cx*x+cd*d is not positive; returns number of invalidated pixels
+	{
+	size_t numRemoved=0;
+	unsigned int x=0;
+	
+	#ifdef __SSE2__
+	
+	/* Test blocks of eight pixels: */
+	__m128i zero=_mm_setzero_si128();
+	__m128i invalid=_mm_set1_epi16(short(FrameSource::invalidDepth));
+	__m128 cxv=_mm_set1_ps(cx);
+	__m128 cdv=_mm_set1_ps(cd);
+	__m128 zerof=_mm_setzero_ps();
+	__m128 base=_mm_add_ps(_mm_set1_ps(rowBase),_mm_mul_ps(cxv,_mm_set_ps(3.0f,2.0f,1.0f,0.0f)));
+	__m128 step=_mm_mul_ps(cxv,_mm_set1_ps(4.0f));
+	__m128i removed=_mm_setzero_si128();
+	for(;x+8<=width;x+=8)
+		{
+		__m128i d=_mm_loadu_si128(reinterpret_cast<const __m128i*>(row+x));
+		__m128 dLo=_mm_cvtepi32_ps(_mm_unpacklo_epi16(d,zero));
+		__m128 dHi=_mm_cvtepi32_ps(_mm_unpackhi_epi16(d,zero));
+		__m128 gLo=_mm_add_ps(base,_mm_mul_ps(cdv,dLo));
+		base=_mm_add_ps(base,step);
+		__m128 gHi=_mm_add_ps(base,_mm_mul_ps(cdv,dHi));
+		base=_mm_add_ps(base,step);
+		__m128i floorMask=_mm_packs_epi32(_mm_castps_si128(_mm_cmple_ps(gLo,zerof)),_mm_castps_si128(_mm_cmple_ps(gHi,zerof)));
+		
+		/* Only count valid pixels as removed: */
+		floorMask=_mm_andnot_si128(_mm_cmpgt_epi16(d,_mm_set1_epi16(short(maxValidDepth-1))),floorMask);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row+x),_mm_or_si128(_mm_and_si128(floorMask,invalid),_mm_andnot_si128(floorMask,d)));
+		removed=_mm_sub_epi16(removed,floorMask);
+		}
+	Misc::UInt16 removedCounts[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(removedCounts),removed);
+	for(int i=0;i<8;++i)
+		numRemoved+=removedCounts[i];
+	
+	#endif
+	
+	/* Test the remaining pixels: */
+	for(;x<width;++x)
+		if(row[x]<maxValidDepth&&rowBase+cx*float(x)+cd*float(row[x])<=0.0f)
+			{
+			row[x]=FrameSource::invalidDepth;
+			++numRemoved;
+			}
+	
+	return numRemoved;
+	}
+
+}
+
+/**********************************
+Methods of class FloorPlaneRemover:
+**********************************/
+
+bool FloorPlaneRemover::estimateFloor(const FrameBuffer& depthFrame,const FloorPlaneRemover::Vector& up,FloorPlaneRemover::Scalar maxTilt,FloorPlaneRemover::Scalar inlierDistance,FloorPlaneRemover::Plane& newFloor,FloorPlaneRemover::Scalar& newWSign) const
+	{
+	/* Unproject a regular grid of valid depth pixels into camera space: */
+	std::vector<Point> points;
+	const PTransform::Matrix& pm=depthProjection.getMatrix();
+	Scalar wSum(0);
+	const DepthPixel* dfPtr=depthFrame.getData<DepthPixel>();
+	for(unsigned int y=sampleStep/2;y<depthSize[1];y+=sampleStep)
+		for(unsigned int x=sampleStep/2;x<depthSize[0];x+=sampleStep)
+			{
+			DepthPixel d=dfPtr[y*depthSize[0]+x];
+			if(d<maxValidDepth)
+				{
+				Point dip(Scalar(x)+Scalar(0.5),Scalar(y)+Scalar(0.5),Scalar(d));
+				points.push_back(depthProjection.transform(dip));
+				wSum+=pm(3,0)*dip[0]+pm(3,1)*dip[1]+pm(3,2)*dip[2]+pm(3,3);
+				}
+			}
+	size_t numPoints=points.size();
+	if(numPoints<3||Scalar(numPoints)*Scalar(minInlierFraction)<Scalar(3))
+		return false;
+	
+	/* Find the best-supported floor plane candidate among planes through random point triples: */
+	Vector nUp=up;
+	nUp.normalize();
+	Scalar minCosTilt=Math::cos(Math::rad(maxTilt));
+	size_t bestNumInliers=0;
+	Plane bestPlane;
+	for(unsigned int hypothesis=0;hypothesis<numHypotheses;++hypothesis)
+		{
+		/* Create a candidate plane through three random points: */
+		const Point& p0=points[Math::randUniformCO(0,numPoints)];
+		const Point& p1=points[Math::randUniformCO(0,numPoints)];
+		const Point& p2=points[Math::randUniformCO(0,numPoints)];
+		Vector normal=(p1-p0)^(p2-p0);
+		Scalar normalLen=normal.mag();
+		if(normalLen==Scalar(0))
+			continue;
+		normal/=normalLen;
+		
+		/* Reject candidates that are not approximately horizontal: */
+		if(Math::abs(normal*nUp)<minCosTilt)
+			continue;
+		
+		/* Orient the candidate's normal towards the camera and reject candidates above the camera: */
+		Plane candidate(normal,p0);
+		if(candidate.getOffset()>Scalar(0))
+			candidate=Plane(-normal,p0);
+		if(candidate.getOffset()>=Scalar(0))
+			continue;
+		
+		/* Count the candidate's supporting points: */
+		size_t numInliers=0;
+		for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+			if(Math::abs(candidate.calcDistance(*pIt))<=inlierDistance)
+				++numInliers;
+		if(bestNumInliers<numInliers)
+			{
+			bestNumInliers=numInliers;
+			bestPlane=candidate;
+			}
+		}
+	if(Scalar(bestNumInliers)<Scalar(numPoints)*Scalar(minInlierFraction))
+		return false;
+	
+	/* Refine the best candidate by fitting a plane to its supporting points: */
+	typedef Geometry::PCACalculator<3>::Point PPoint;
+	typedef Geometry::PCACalculator<3>::Vector PVector;
+	Geometry::PCACalculator<3> pca;
+	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+		if(Math::abs(bestPlane.calcDistance(*pIt))<=inlierDistance)
+			pca.accumulatePoint(PPoint(*pIt));
+	PPoint centroid=pca.calcCentroid();
+	pca.calcCovariance();
+	double evs[3];
+	pca.calcEigenvalues(evs);
+	PVector pNormal=pca.calcEigenvector(evs[2]);
+	Vector normal(pNormal);
+	if(normal*bestPlane.getNormal()<Scalar(0))
+		normal=-normal;
+	newFloor=Plane(normal,Point(centroid));
+	newFloor.normalize();
+	
+	/* Reject the refined plane if it drifted out of the allowed tilt range or above the camera: */
+	if(newFloor.getNormal()*nUp<minCosTilt&&-(newFloor.getNormal()*nUp)<minCosTilt)
+		return false;
+	if(newFloor.getOffset()>=Scalar(0))
+		return false;
+	
+	newWSign=wSum>=Scalar(0)?Scalar(1):Scalar(-1);
+	return true;
+	}
+
+void* FloorPlaneRemover::estimationThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next estimation frame and grab the current estimation parameters: */
+		FrameBuffer frame;
+		Vector eUp;
+		Scalar eMaxTilt,eInlierDistance;
+		{
+		Threads::MutexCond::Lock estimationLock(estimationCond);
+		while(!shutdown&&!haveEstimationFrame)
+			estimationCond.wait(estimationLock);
+		if(shutdown)
+			break;
+		frame=estimationFrame;
+		eUp=up;
+		eMaxTilt=maxTilt;
+		eInlierDistance=inlierDistance;
+		}
+		
+		/* Estimate a floor plane: */
+		Plane newFloor;
+		Scalar newWSign(1);
+		if(estimateFloor(frame,eUp,eMaxTilt,eInlierDistance,newFloor,newWSign))
+			{
+			/* Install the new floor plane: */
+			Threads::Spinlock::Lock floorLock(floorMutex);
+			floorValid=true;
+			floor=newFloor;
+			wSign=newWSign;
+			}
+		
+		/* Mark the estimation frame as processed: */
+		{
+		Threads::MutexCond::Lock estimationLock(estimationCond);
+		estimationFrame=FrameBuffer();
+		haveEstimationFrame=false;
+		}
+		}
+	
+	return 0;
+	}
+
+FloorPlaneRemover::FloorPlaneRemover(const Size& sDepthSize,const FrameSource::IntrinsicParameters& ips)
+	:depthSize(sDepthSize),depthProjection(ips.depthProjection),
+	 up(0,1,0),maxTilt(30),inlierDistance(2),
+	 estimationInterval(30),frameCounter(0),
+	 haveEstimationFrame(false),shutdown(false),
+	 floorValid(false),floor(Vector(0,1,0),Scalar(0)),wSign(1),removalMargin(3),
+	 numRemovedPixels(0)
+	{
+	/* Start the estimation thread: */
+	estimationThread.start(this,&FloorPlaneRemover::estimationThreadMethod);
+	}
+
+FloorPlaneRemover::~FloorPlaneRemover(void)
+	{
+	/* Shut down the estimation thread: */
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	shutdown=true;
+	estimationCond.signal();
+	}
+	estimationThread.join();
+	}
+
+void FloorPlaneRemover::setUpDirection(const FloorPlaneRemover::Vector& newUp)
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	up=newUp;
+	}
+
+void FloorPlaneRemover::setMaxTilt(FloorPlaneRemover::Scalar newMaxTilt)
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	maxTilt=newMaxTilt;
+	}
+
+void FloorPlaneRemover::setInlierDistance(FloorPlaneRemover::Scalar newInlierDistance)
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	inlierDistance=newInlierDistance;
+	}
+
+void FloorPlaneRemover::setEstimationInterval(unsigned int newEstimationInterval)
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	estimationInterval=newEstimationInterval>0?newEstimationInterval:1;
+	}
+
+void FloorPlaneRemover::setRemovalMargin(FloorPlaneRemover::Scalar newRemovalMargin)
+	{
+	Threads::Spinlock::Lock floorLock(floorMutex);
+	removalMargin=newRemovalMargin;
+	}
+
+bool FloorPlaneRemover::hasFloor(void) const
+	{
+	Threads::Spinlock::Lock floorLock(floorMutex);
+	return floorValid;
+	}
+
+FloorPlaneRemover::Plane FloorPlaneRemover::getFloor(void) const
+	{
+	Threads::Spinlock::Lock floorLock(floorMutex);
+	return floor;
+	}
+
+void FloorPlaneRemover::removeFloor(FrameBuffer& depthFrame)
+	{
+	/* Hand a copy of the depth frame to the estimation thread if an estimation is due and the thread is idle: */
+	{
+	Threads::MutexCond::Lock estimationLock(estimationCond);
+	if(++frameCounter>=estimationInterval&&!haveEstimationFrame)
+		{
+		estimationFrame=FrameBuffer(depthSize,depthSize.volume()*sizeof(DepthPixel),MemoryAccounting::FRAME_FILTER);
+		estimationFrame.timeStamp=depthFrame.timeStamp;
+		estimationFrame.metadata=depthFrame.metadata;
+		memcpy(estimationFrame.getData<DepthPixel>(),depthFrame.getData<DepthPixel>(),depthSize.volume()*sizeof(DepthPixel));
+		haveEstimationFrame=true;
+		frameCounter=0;
+		estimationCond.signal();
+		}
+	}
+	
+	/* Get the current floor plane: */
+	Plane f;
+	Scalar ws,margin;
+	{
+	Threads::Spinlock::Lock floorLock(floorMutex);
+	if(!floorValid)
+		{
+		numRemovedPixels=0;
+		return;
+		}
+	f=floor;
+	ws=wSign;
+	margin=removalMargin;
+	}
+	
+	/*********************************************************************
+	Convert the floor plane into a linear test in depth image space: a
+	pixel (x, y, d) unprojects to homogeneous camera-space point P*(x, y,
+	d, 1), whose height above the floor times its homogeneous weight is
+	(P^T*(n, -o))*(x, y, d, 1). Pixels with height at most the removal
+	margin are on or below the floor.
+	*********************************************************************/
+	
+	const PTransform::Matrix& pm=depthProjection.getMatrix();
+	const Vector& n=f.getNormal();
+	Scalar h[4];
+	for(int j=0;j<4;++j)
+		h[j]=ws*(n[0]*pm(0,j)+n[1]*pm(1,j)+n[2]*pm(2,j)-(f.getOffset()+margin)*pm(3,j));
+	
+	/* Remove floor pixels row by row, testing pixel centers: */
+	numRemovedPixels=0;
+	DepthPixel* rowPtr=depthFrame.getData<DepthPixel>();
+	for(unsigned int y=0;y<depthSize[1];++y,rowPtr+=depthSize[0])
+		{
+		float rowBase=float(h[0]*Scalar(0.5)+h[1]*(Scalar(y)+Scalar(0.5))+h[3]);
+		numRemovedPixels+=removeRow(rowPtr,depthSize[0],rowBase,float(h[0]),float(h[2]));
+		}
+	}
+
+}
@@ -0,0 +1,101 @@
+/***********************************************************************
+FloorPlaneRemover - Class to detect the floor plane in depth frames
+using a robust plane estimator running at low rate in a background
+thread, and to remove floor pixels from every depth frame.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FLOORPLANEREMOVER_INCLUDED
+#define KINECT_FLOORPLANEREMOVER_INCLUDED
+
+#include <stddef.h>
+#include <Threads/Spinlock.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <Geometry/Plane.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+
+namespace Kinect {
+
+class FloorPlaneRemover
+	{
+	/* Embedded classes: */
+	public:
+	typedef FrameSource::IntrinsicParameters::PTransform PTransform; // Type for projective transformations
+	typedef PTransform::Scalar Scalar; // Scalar type for camera space
+	typedef PTransform::Point Point; // Type for points in depth image or camera space
+	typedef PTransform::Vector Vector; // Type for vectors in camera space
+	typedef Geometry::Plane<Scalar,3> Plane; // Type for planes in camera space
+	
+	/* Elements: */
+	private:
+	Size depthSize; // Size of incoming depth frames
+	PTransform depthProjection; // Projection from depth image space into camera space
+	
+	/* Estimation parameters and state: */
+	Threads::MutexCond estimationCond; // Condition variable protecting the estimation parameters and signaling new frames to the estimation thread
+	Vector up; // Approximate up direction in camera space; the sign is ignored
+	Scalar maxTilt; // Maximum angle between the floor plane's normal vector and the up direction in degrees
+	Scalar inlierDistance; // Maximum distance from a plane in camera space units for a point to support that plane
+	unsigned int estimationInterval; // Number of depth frames between floor plane estimations
+	unsigned int frameCounter; // Number of depth frames since the last floor plane estimation was started
+	FrameBuffer estimationFrame; // Depth frame handed to the estimation thread
+	bool haveEstimationFrame; // Flag whether the estimation frame has not yet been processed
+	bool shutdown; // Flag to shut down the estimation thread
+	Threads::Thread estimationThread; // Thread running the floor plane estimator
+	
+	/* Current floor plane: */
+	mutable Threads::Spinlock floorMutex; // Mutex protecting the current floor plane
+	bool floorValid; // Flag whether a floor plane has been detected
+	Plane floor; // Current floor plane in camera space, with the normal vector pointing up towards the camera
+	Scalar wSign; // Sign of the homogeneous weight of depth image-space points above the floor
+	Scalar removalMargin; // Height above the floor plane in camera space units below which pixels are removed
+	
+	size_t numRemovedPixels; // Number of pixels removed from the most recent depth frame
+	
+	/* Private methods: */
+	bool estimateFloor(const FrameBuffer& depthFrame,const Vector& up,Scalar maxTilt,Scalar inlierDistance,Plane& newFloor,Scalar& newWSign) const; // Estimates a floor plane from the given depth frame; returns false if no floor plane was found
+	void* estimationThreadMethod(void); // Thread method running the floor plane estimator
+	
+	/* Constructors and destructors: */
+	public:
+	FloorPlaneRemover(const Size& sDepthSize,const FrameSource::IntrinsicParameters& ips); // Creates a floor remover for depth frames of the given size from a camera with the given intrinsic parameters
+	~FloorPlaneRemover(void);
+	
+	/* Methods: */
+	void setUpDirection(const Vector& newUp); // Sets the approximate up direction in camera space, for example from an accelerometer
+	void setMaxTilt(Scalar newMaxTilt); // Sets the maximum angle between the floor's normal vector and the up direction in degrees
+	void setInlierDistance(Scalar newInlierDistance); // Sets the maximum distance for points supporting a floor plane candidate
+	void setEstimationInterval(unsigned int newEstimationInterval); // Sets the number of depth frames between floor plane estimations
+	void setRemovalMargin(Scalar newRemovalMargin); // Sets the height above the floor plane below which pixels are removed
+	bool hasFloor(void) const; // Returns true if a floor plane has been detected
+	Plane getFloor(void) const; // Returns the current floor plane in camera space
+	void removeFloor(FrameBuffer& depthFrame); // Hands the given depth frame to the estimator if due, and invalidates all pixels on or below the current floor plane in place
+	size_t getNumRemovedPixels(void) const // Returns the number of pixels removed from the most recent depth frame
+		{
+		return numRemovedPixels;
+		}
+	};
+
+}
+
+#endif
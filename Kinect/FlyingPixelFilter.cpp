@@ -0,0 +1,243 @@
+/***********************************************************************
+FlyingPixelFilter - Class to invalidate flying and mixed pixels at depth
+discontinuities in depth frames before triangulation, processing bands
+of frame rows in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FlyingPixelFilter.h>
+
+#include <Misc/FunctionCalls.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+
+inline bool isDiscontinuous(unsigned int d,unsigned int a,unsigned int b,unsigned int threshold,unsigned int curvatureFactor) // Returns true if a pixel is at a depth discontinuity between two opposite valid neighbors
+	{
+	if(a>=maxValidDepth||b>=maxValidDepth)
+		return false;
+	
+	/* Check if the pixel is separated from both neighbors: */
+	unsigned int ja=a>d?a-d:d-a;
+	unsigned int jb=b>d?b-d:d-b;
+	if(ja<=threshold||jb<=threshold)
+		return false;
+	
+	/* Pixels in front of or behind both neighbors are flying: */
+	if((a>d)==(b>d))
+		return true;
+	
+	/* Pixels between their neighbors are mixed unless they lie on a locally planar steep surface: */
+	unsigned int secondDiff=ja>jb?ja-jb:jb-ja;
+	return (secondDiff<<4)>curvatureFactor*(ja+jb);
+	}
+
+inline DepthPixel filterPixel(const DepthPixel* up,const DepthPixel* row,const DepthPixel* down,unsigned int x,unsigned int width,unsigned int ratioFactor,unsigned int curvatureFactor,size_t& numRejected) // Filters a single pixel, using only neighbors that exist
+	{
+	unsigned int d=row[x];
+	if(d>=maxValidDepth)
+		return DepthPixel(d);
+	unsigned int threshold=(d*ratioFactor)>>16;
+	bool flying=x>0&&x<width-1&&isDiscontinuous(d,row[x-1],row[x+1],threshold,curvatureFactor);
+	flying=flying||(up!=0&&down!=0&&isDiscontinuous(d,up[x],down[x],threshold,curvatureFactor));
+	if(flying)
+		{
+		++numRejected;
+		return FrameSource::invalidDepth;
+		}
+	else
+		return DepthPixel(d);
+	}
+
+#ifdef __SSE2__
+
+inline __m128i nonZero(__m128i v) // Returns a mask of all non-zero 16-bit elements
+	{
+	return _mm_andnot_si128(_mm_cmpeq_epi16(v,_mm_setzero_si128()),_mm_set1_epi16(-1));
+	}
+
+inline __m128i isDiscontinuous(__m128i d,__m128i a,__m128i b,__m128i threshold,__m128i curvatureFactor,__m128i maxValid) // Vectorized version of the discontinuity test on eight pixels
+	{
+	/* Check that both neighbors are valid: */
+	__m128i valid=_mm_and_si128(nonZero(_mm_subs_epu16(maxValid,a)),nonZero(_mm_subs_epu16(maxValid,b)));
+	
+	/* Check if the pixels are separated from both neighbors: */
+	__m128i aAbove=_mm_subs_epu16(a,d);
+	__m128i bAbove=_mm_subs_epu16(b,d);
+	__m128i ja=_mm_or_si128(aAbove,_mm_subs_epu16(d,a));
+	__m128i jb=_mm_or_si128(bAbove,_mm_subs_epu16(d,b));
+	__m128i separated=_mm_and_si128(nonZero(_mm_subs_epu16(ja,threshold)),nonZero(_mm_subs_epu16(jb,threshold)));
+	
+	/* Check for flying pixels: */
+	__m128i flying=_mm_cmpeq_epi16(nonZero(aAbove),nonZero(bAbove));
+	
+	/* Check for mixed pixels: */
+	__m128i secondDiff=_mm_or_si128(_mm_subs_epu16(ja,jb),_mm_subs_epu16(jb,ja));
+	__m128i mixed=nonZero(_mm_subs_epu16(_mm_slli_epi16(secondDiff,4),_mm_mullo_epi16(curvatureFactor,_mm_add_epi16(ja,jb))));
+	
+	return _mm_and_si128(_mm_and_si128(valid,separated),_mm_or_si128(flying,mixed));
+	}
+
+#endif
+
+size_t filterRow(const DepthPixel* up,const DepthPixel* row,const DepthPixel* down,unsigned int width,unsigned int ratioFactor,unsigned int curvatureFactor,DepthPixel* out) // Filters a row of pixels given its upper and lower neighbor rows, which can be null
+	{
+	size_t numRejected=0;
+	
+	/* Filter the first pixel: */
+	out[0]=filterPixel(up,row,down,0,width,ratioFactor,curvatureFactor,numRejected);
+	unsigned int x=1;
+	
+	#ifdef __SSE2__
+	
+	/* Filter blocks of eight interior pixels: */
+	__m128i maxValid=_mm_set1_epi16(short(maxValidDepth));
+	__m128i ratio=_mm_set1_epi16(short(ratioFactor));
+	__m128i curv=_mm_set1_epi16(short(curvatureFactor));
+	__m128i invalid=_mm_set1_epi16(short(FrameSource::invalidDepth));
+	__m128i rejected=_mm_setzero_si128();
+	for(;x+9<=width;x+=8)
+		{
+		__m128i d=_mm_loadu_si128(reinterpret_cast<const __m128i*>(row+x));
+		__m128i threshold=_mm_mulhi_epu16(d,ratio);
+		__m128i flag=isDiscontinuous(d,_mm_loadu_si128(reinterpret_cast<const __m128i*>(row+x-1)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(row+x+1)),threshold,curv,maxValid);
+		if(up!=0&&down!=0)
+			flag=_mm_or_si128(flag,isDiscontinuous(d,_mm_loadu_si128(reinterpret_cast<const __m128i*>(up+x)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(down+x)),threshold,curv,maxValid));
+		flag=_mm_and_si128(flag,nonZero(_mm_subs_epu16(maxValid,d)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out+x),_mm_or_si128(_mm_and_si128(flag,invalid),_mm_andnot_si128(flag,d)));
+		
+		/* Count rejected pixels; flags are -1 for rejected pixels: */
+		rejected=_mm_sub_epi16(rejected,flag);
+		}
+	Misc::UInt16 rejectedCounts[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(rejectedCounts),rejected);
+	for(int i=0;i<8;++i)
+		numRejected+=rejectedCounts[i];
+	
+	#endif
+	
+	/* Filter the remaining pixels: */
+	for(;x<width;++x)
+		out[x]=filterPixel(up,row,down,x,width,ratioFactor,curvatureFactor,numRejected);
+	
+	return numRejected;
+	}
+
+}
+
+/**********************************
+Methods of class FlyingPixelFilter:
+**********************************/
+
+size_t FlyingPixelFilter::filterBand(unsigned int firstRow,unsigned int lastRow)
+	{
+	unsigned int width=inFrame->getSize(0);
+	unsigned int height=inFrame->getSize(1);
+	const DepthPixel* in=inFrame->getData<DepthPixel>();
+	DepthPixel* out=outFrame->getData<DepthPixel>();
+	
+	/* Filter all rows in the band, skipping the vertical test on the frame's first and last rows: */
+	size_t result=0;
+	for(unsigned int y=firstRow;y<lastRow;++y)
+		{
+		const DepthPixel* row=in+size_t(y)*size_t(width);
+		const DepthPixel* up=y>0?row-width:0;
+		const DepthPixel* down=y<height-1?row+width:0;
+		result+=filterRow(up,row,down,width,ratioFactor,curvatureFactor,out+size_t(y)*size_t(width));
+		}
+	
+	return result;
+	}
+
+void FlyingPixelFilter::processBand(unsigned int bandIndex)
+	{
+	/* Filter the band: */
+	unsigned int height=inFrame->getSize(1);
+	unsigned int firstRow=bandIndex*bandHeight;
+	unsigned int lastRow=height-firstRow<bandHeight?height:firstRow+bandHeight;
+	size_t numRejected=filterBand(firstRow,lastRow);
+	
+	/* Count the band's invalidated pixels: */
+	Threads::Mutex::Lock rejectedLock(rejectedMutex);
+	numRejectedPixels+=numRejected;
+	}
+
+FlyingPixelFilter::FlyingPixelFilter(unsigned int numThreads)
+	:depthRatio(0.0),curvature(0.0),ratioFactor(0),curvatureFactor(0),
+	 inFrame(0),outFrame(0),
+	 numRejectedPixels(0),
+	 jobPool(numThreads)
+	{
+	/* Set default thresholds: */
+	setDepthRatio(0.04);
+	setCurvature(0.5);
+	}
+
+FlyingPixelFilter::~FlyingPixelFilter(void)
+	{
+	}
+
+void FlyingPixelFilter::setDepthRatio(double newDepthRatio)
+	{
+	/* Clamp the ratio to the range of the fixed-point factor: */
+	depthRatio=newDepthRatio<0.0?0.0:newDepthRatio;
+	double factor=depthRatio*65536.0+0.5;
+	ratioFactor=factor<65535.0?Misc::UInt16(factor):Misc::UInt16(65535);
+	}
+
+void FlyingPixelFilter::setCurvature(double newCurvature)
+	{
+	/* Clamp the curvature to the range of the fixed-point factor: */
+	curvature=newCurvature<0.0?0.0:newCurvature>1.0?1.0:newCurvature;
+	curvatureFactor=Misc::UInt16(curvature*16.0+0.5);
+	}
+
+FrameBuffer FlyingPixelFilter::filter(const FrameBuffer& depthFrame)
+	{
+	/* Create the result frame: */
+	const Size& size=depthFrame.getSize();
+	FrameBuffer result(size,size.volume()*sizeof(DepthPixel),MemoryAccounting::FRAME_FILTER);
+	result.timeStamp=depthFrame.timeStamp;
+	result.metadata=depthFrame.metadata;
+	
+	/* Filter all bands of the frame in parallel: */
+	inFrame=&depthFrame;
+	outFrame=&result;
+	numRejectedPixels=0;
+	jobPool.run((size[1]+bandHeight-1)/bandHeight,Misc::VoidMethodCall<unsigned int,FlyingPixelFilter>(this,&FlyingPixelFilter::processBand));
+	inFrame=0;
+	outFrame=0;
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,81 @@
+/***********************************************************************
+FlyingPixelFilter - Class to invalidate flying and mixed pixels at depth
+discontinuities in depth frames before triangulation, processing bands
+of frame rows in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FLYINGPIXELFILTER_INCLUDED
+#define KINECT_FLYINGPIXELFILTER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/SizedTypes.h>
+#include <Threads/Mutex.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ParallelJobPool.h>
+
+namespace Kinect {
+
+class FlyingPixelFilter
+	{
+	/* Elements: */
+	private:
+	double depthRatio; // Depth jump to both neighbors along a frame axis, relative to a pixel's depth value, above which the pixel is considered to be at a discontinuity
+	double curvature; // Second-order depth difference along a frame axis, relative to the sum of depth jumps, above which a pixel between its neighbors is considered mixed instead of lying on a steep surface
+	Misc::UInt16 ratioFactor; // Depth ratio as 0.16 fixed-point factor
+	Misc::UInt16 curvatureFactor; // Curvature as 4.4 fixed-point factor
+	static const unsigned int bandHeight=16; // Number of frame rows in each band processed by a single thread
+	const FrameBuffer* inFrame; // Depth frame currently being filtered
+	FrameBuffer* outFrame; // Filtered depth frame currently being written
+	Threads::Mutex rejectedMutex; // Mutex protecting the rejected pixel counter
+	size_t numRejectedPixels; // Number of pixels invalidated in the current frame
+	ParallelJobPool jobPool; // Pool of threads filtering bands of the current frame
+	
+	/* Private methods: */
+	size_t filterBand(unsigned int firstRow,unsigned int lastRow); // Filters the given range of rows of the current frame; returns number of invalidated pixels
+	void processBand(unsigned int bandIndex); // Filters the band of the given index of the current frame
+	
+	/* Constructors and destructors: */
+	public:
+	FlyingPixelFilter(unsigned int numThreads =2); // Creates a filter using the given total number of threads
+	~FlyingPixelFilter(void);
+	
+	/* Methods: */
+	double getDepthRatio(void) const // Returns the relative depth jump threshold
+		{
+		return depthRatio;
+		}
+	double getCurvature(void) const // Returns the relative curvature threshold
+		{
+		return curvature;
+		}
+	void setDepthRatio(double newDepthRatio); // Sets the relative depth jump threshold; must not be called while a frame is being filtered
+	void setCurvature(double newCurvature); // Sets the relative curvature threshold between 0 (invalidate all pixels between neighbors) and 1 (only invalidate isolated pixels); must not be called while a frame is being filtered
+	FrameBuffer filter(const FrameBuffer& depthFrame); // Returns a copy of the given depth frame in which all flying and mixed pixels are invalid
+	size_t getNumRejectedPixels(void) const // Returns the number of pixels invalidated in the most recently filtered frame
+		{
+		return numRejectedPixels;
+		}
+	};
+
+}
+
+#endif
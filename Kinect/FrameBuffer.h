@@ -34,7 +34,10 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <iostream>
 #endif
 #include <Threads/Atomic.h>
+#include <Kinect/Config.h>
 #include <Kinect/Types.h>
+#include <Kinect/FrameMetadata.h>
+#include <Kinect/MemoryAccounting.h>
 
 namespace Kinect {
 
@@ -47,20 +50,33 @@ class FrameBuffer
 		/* Elements: */
 		public:
 		Threads::Atomic<unsigned int> refCount; // Reference counter
+		#if KINECT_CONFIG_MEMORY_ACCOUNTING
+		MemoryAccounting::Tag tag; // Owner tag to which the buffer is accounted
+		size_t bufferSize; // Size of the buffer in bytes, excluding the header
+		#endif
 		#if KINECT_FRAMEBUFFER_DEBUGLOCK
 		int destroyed;
 		#endif
 		
 		/* Constructors and destructors: */
-		BufferHeader(void)
+		BufferHeader(MemoryAccounting::Tag sTag,size_t sBufferSize)
 			:refCount(1)
+			#if KINECT_CONFIG_MEMORY_ACCOUNTING
+			 ,tag(sTag),bufferSize(sBufferSize)
+			#endif
 			#if KINECT_FRAMEBUFFER_DEBUGLOCK
 			 ,destroyed(0)
 			#endif
 			{
+			#if KINECT_CONFIG_MEMORY_ACCOUNTING
+			MemoryAccounting::allocate(tag,bufferSize);
+			#endif
 			}
 		~BufferHeader(void)
 			{
+			#if KINECT_CONFIG_MEMORY_ACCOUNTING
+			MemoryAccounting::release(tag,bufferSize);
+			#endif
 			#if KINECT_FRAMEBUFFER_DEBUGLOCK
 			destroyed=1;
 			#endif
@@ -91,6 +107,7 @@ class FrameBuffer
 	void* buffer; // Pointer to the reference-counted frame buffer
 	public:
 	double timeStamp; // Frame's time stamp in originating camera's own clock
+	FrameMetadata metadata; // Frame's metadata as reported by the originating camera
 	
 	/* Constructors and destructors: */
 	public:
@@ -98,18 +115,18 @@ class FrameBuffer
 		:size(0,0),buffer(0),timeStamp(0.0)
 		{
 		}
-	FrameBuffer(const Size& sSize,size_t bufferSize) // Allocates a new frame buffer of the given frame size and size in bytes
+	FrameBuffer(const Size& sSize,size_t bufferSize,MemoryAccounting::Tag tag =MemoryAccounting::UNTAGGED) // Allocates a new frame buffer of the given frame size and size in bytes, accounted to the given owner tag
 		:size(sSize),buffer(0),timeStamp(0.0)
 		{
 		/* Allocate the enlarged frame buffer: */
 		unsigned char* paddedBuffer=new unsigned char[bufferSize+sizeof(BufferHeader)];
-		new(paddedBuffer) BufferHeader;
+		new(paddedBuffer) BufferHeader(tag,bufferSize);
 		
 		/* Store the actual buffer pointer: */
 		buffer=paddedBuffer+sizeof(BufferHeader);
 		}
 	FrameBuffer(const FrameBuffer& source) // Copy constructor
-		:size(source.size),buffer(source.buffer),timeStamp(source.timeStamp)
+		:size(source.size),buffer(source.buffer),timeStamp(source.timeStamp),metadata(source.metadata)
 		{
 		/* Reference the source's buffer: */
 		if(buffer!=0)
@@ -142,8 +159,9 @@ class FrameBuffer
 			if(buffer!=0)
 				static_cast<BufferHeader*>(buffer)[-1].ref();
 			
-			/* Copy the time stamp: */
+			/* Copy the time stamp and metadata: */
 			timeStamp=source.timeStamp;
+			metadata=source.metadata;
 			}
 		return *this;
 		}
@@ -166,6 +184,14 @@ class FrameBuffer
 		{
 		return buffer!=0;
 		}
+	size_t getAccountedSize(void) const // Returns the size of the frame's buffer in bytes as accounted to its owner tag, or zero if the frame is invalid or memory accounting is disabled
+		{
+		#if KINECT_CONFIG_MEMORY_ACCOUNTING
+		return buffer!=0?static_cast<BufferHeader*>(buffer)[-1].bufferSize:0;
+		#else
+		return 0;
+		#endif
+		}
 	const Size& getSize(void) const // Returns the frame size
 		{
 		return size;
@@ -0,0 +1,247 @@
+/***********************************************************************
+FrameChangeDetector - Class to detect whether a depth or color frame
+differs from the most recently emitted frame of the same stream by more
+than sensor noise, so that consumers can skip re-meshing, compressing,
+sending, or writing frames of static scenes.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FrameChangeDetector.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <Misc/StdError.h>
+#include <Math/Math.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int countChanges(const Misc::UInt16* a,const Misc::UInt16* b,unsigned int numElements,unsigned int threshold) // Returns the number of elements whose absolute difference exceeds the given threshold
+	{
+	unsigned int result=0;
+	unsigned int i=0;
+	
+	#ifdef __SSE2__
+	
+	/* Process eight elements at a time: */
+	__m128i thresh=_mm_set1_epi16(short(threshold));
+	__m128i one=_mm_set1_epi16(1);
+	__m128i zero=_mm_setzero_si128();
+	__m128i sums=zero;
+	for(;i+8<=numElements;i+=8)
+		{
+		__m128i va=_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i));
+		__m128i vb=_mm_loadu_si128(reinterpret_cast<const __m128i*>(b+i));
+		__m128i diff=_mm_or_si128(_mm_subs_epu16(va,vb),_mm_subs_epu16(vb,va));
+		
+		/* Mark elements above the threshold with one, and sum the marks' bytes: */
+		__m128i changed=_mm_andnot_si128(_mm_cmpeq_epi16(_mm_subs_epu16(diff,thresh),zero),one);
+		sums=_mm_add_epi64(sums,_mm_sad_epu8(changed,zero));
+		}
+	result=(unsigned int)(_mm_cvtsi128_si32(sums))+(unsigned int)(_mm_cvtsi128_si32(_mm_srli_si128(sums,8)));
+	
+	#endif
+	
+	/* Process the remaining elements: */
+	for(;i<numElements;++i)
+		{
+		unsigned int diff=a[i]>b[i]?a[i]-b[i]:b[i]-a[i];
+		if(diff>threshold)
+			++result;
+		}
+	
+	return result;
+	}
+
+inline unsigned int countChanges(const Misc::UInt8* a,const Misc::UInt8* b,unsigned int numElements,unsigned int threshold) // Ditto, for 8-bit elements
+	{
+	unsigned int result=0;
+	unsigned int i=0;
+	
+	#ifdef __SSE2__
+	
+	/* Process sixteen elements at a time: */
+	__m128i thresh=_mm_set1_epi8(char(threshold>255U?255U:threshold));
+	__m128i one=_mm_set1_epi8(1);
+	__m128i zero=_mm_setzero_si128();
+	__m128i sums=zero;
+	for(;i+16<=numElements;i+=16)
+		{
+		__m128i va=_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i));
+		__m128i vb=_mm_loadu_si128(reinterpret_cast<const __m128i*>(b+i));
+		__m128i diff=_mm_or_si128(_mm_subs_epu8(va,vb),_mm_subs_epu8(vb,va));
+		
+		/* Mark elements above the threshold with one, and sum the marks: */
+		__m128i changed=_mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(diff,thresh),zero),one);
+		sums=_mm_add_epi64(sums,_mm_sad_epu8(changed,zero));
+		}
+	result=(unsigned int)(_mm_cvtsi128_si32(sums))+(unsigned int)(_mm_cvtsi128_si32(_mm_srli_si128(sums,8)));
+	
+	#endif
+	
+	/* Process the remaining elements: */
+	for(;i<numElements;++i)
+		{
+		unsigned int diff=a[i]>b[i]?a[i]-b[i]:b[i]-a[i];
+		if(diff>threshold)
+			++result;
+		}
+	
+	return result;
+	}
+
+template <class ElementParam>
+inline
+FrameChangeDetector::TileMask
+compareFrames(const ElementParam* frame,const ElementParam* reference,const Size& frameSize,unsigned int numComponents,const unsigned int tileEdges[2][FrameChangeDetector::numTiles+1],unsigned int threshold,const unsigned int tileThresholds[]) // Returns the mask of changed tiles between two frames
+	{
+	const unsigned int numTiles=FrameChangeDetector::numTiles;
+	FrameChangeDetector::TileMask result(0);
+	size_t stride=size_t(frameSize[0])*numComponents;
+	unsigned int counts[numTiles];
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		{
+		/* Count the changed components of all tiles in this tile row: */
+		for(unsigned int tx=0;tx<numTiles;++tx)
+			counts[tx]=0;
+		FrameChangeDetector::TileMask rowMask(0);
+		for(unsigned int y=tileEdges[1][ty];y<tileEdges[1][ty+1];++y)
+			{
+			const ElementParam* fRow=frame+y*stride;
+			const ElementParam* rRow=reference+y*stride;
+			for(unsigned int tx=0;tx<numTiles;++tx)
+				{
+				/* Skip tiles that are already known to have changed: */
+				FrameChangeDetector::TileMask tileBit=FrameChangeDetector::TileMask(1)<<(ty*numTiles+tx);
+				if(rowMask&tileBit)
+					continue;
+				
+				unsigned int x0=tileEdges[0][tx]*numComponents;
+				unsigned int x1=tileEdges[0][tx+1]*numComponents;
+				counts[tx]+=countChanges(fRow+x0,rRow+x0,x1-x0,threshold);
+				if(counts[tx]>=tileThresholds[ty*numTiles+tx])
+					rowMask|=tileBit;
+				}
+			}
+		result|=rowMask;
+		}
+	
+	return result;
+	}
+
+}
+
+/************************************
+Methods of class FrameChangeDetector:
+************************************/
+
+void FrameChangeDetector::updateTileThresholds(void)
+	{
+	for(unsigned int ty=0;ty<numTiles;++ty)
+		for(unsigned int tx=0;tx<numTiles;++tx)
+			{
+			/* Calculate the number of changed components that mark the tile as changed, but at least one: */
+			unsigned int numElements=(tileEdges[0][tx+1]-tileEdges[0][tx])*(tileEdges[1][ty+1]-tileEdges[1][ty])*numComponents;
+			unsigned int threshold=(unsigned int)(Math::ceil(double(numElements)*tileFraction));
+			tileThresholds[ty*numTiles+tx]=threshold>0?threshold:1U;
+			}
+	}
+
+FrameChangeDetector::FrameChangeDetector(const Size& sFrameSize,bool sDepth,unsigned int sNumComponents)
+	:frameSize(sFrameSize),depth(sDepth),numComponents(sDepth?1U:sNumComponents),
+	 pixelThreshold(sDepth?4U:12U),tileFraction(0.002),
+	 maxStaticFrames(30),
+	 numStaticFrames(0),changedTiles(allTiles)
+	{
+	if(numComponents==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid number of pixel components");
+	
+	/* Calculate the tile grid, which matches the one of DepthTileCuller: */
+	for(int i=0;i<2;++i)
+		for(unsigned int t=0;t<=numTiles;++t)
+			tileEdges[i][t]=(frameSize[i]*t)/numTiles;
+	updateTileThresholds();
+	}
+
+void FrameChangeDetector::setPixelThreshold(unsigned int newPixelThreshold)
+	{
+	pixelThreshold=newPixelThreshold;
+	}
+
+void FrameChangeDetector::setTileFraction(double newTileFraction)
+	{
+	tileFraction=newTileFraction;
+	updateTileThresholds();
+	}
+
+void FrameChangeDetector::setMaxStaticFrames(unsigned int newMaxStaticFrames)
+	{
+	maxStaticFrames=newMaxStaticFrames;
+	}
+
+FrameChangeDetector::TileMask FrameChangeDetector::compare(const FrameBuffer& frame) const
+	{
+	/* Everything changed if there is no reference frame: */
+	if(!reference.isValid())
+		return allTiles;
+	
+	if(frame.getSize(0)!=frameSize[0]||frame.getSize(1)!=frameSize[1])
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Frame size does not match detector");
+	
+	/* Compare the frame's contents in their native element type: */
+	if(depth)
+		return compareFrames(frame.getData<Misc::UInt16>(),reference.getData<Misc::UInt16>(),frameSize,numComponents,tileEdges,pixelThreshold,tileThresholds);
+	else
+		return compareFrames(frame.getData<Misc::UInt8>(),reference.getData<Misc::UInt8>(),frameSize,numComponents,tileEdges,pixelThreshold,tileThresholds);
+	}
+
+bool FrameChangeDetector::update(const FrameBuffer& frame)
+	{
+	changedTiles=compare(frame);
+	
+	/* Emit the frame if it changed, or if too many frames have been suppressed in a row: */
+	if(changedTiles!=0||(maxStaticFrames!=0&&numStaticFrames>=maxStaticFrames))
+		{
+		/* Compare future frames against this frame: */
+		reference=frame;
+		numStaticFrames=0;
+		return true;
+		}
+	else
+		{
+		++numStaticFrames;
+		return false;
+		}
+	}
+
+void FrameChangeDetector::reset(void)
+	{
+	/* Drop the reference frame: */
+	reference=FrameBuffer();
+	numStaticFrames=0;
+	}
+
+}
@@ -0,0 +1,88 @@
+/***********************************************************************
+FrameChangeDetector - Class to detect whether a depth or color frame
+differs from the most recently emitted frame of the same stream by more
+than sensor noise, so that consumers can skip re-meshing, compressing,
+sending, or writing frames of static scenes.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FRAMECHANGEDETECTOR_INCLUDED
+#define KINECT_FRAMECHANGEDETECTOR_INCLUDED
+
+#include <Misc/SizedTypes.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+
+namespace Kinect {
+
+class FrameChangeDetector
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::UInt64 TileMask; // Type for bit masks of frame tiles in row-major order
+	
+	static const unsigned int numTiles=8; // Number of tiles in each frame dimension
+	static const TileMask allTiles=~TileMask(0); // Tile mask with all tiles set
+	
+	/* Elements: */
+	private:
+	Size frameSize; // Size of compared frames in pixels
+	bool depth; // Flag whether compared frames are depth frames of 16-bit pixels, or color frames of 8-bit components
+	unsigned int numComponents; // Number of components per pixel
+	unsigned int tileEdges[2][numTiles+1]; // Pixel positions of the tile grid's vertical and horizontal edges
+	unsigned int pixelThreshold; // Largest per-component difference that is considered sensor noise
+	double tileFraction; // Fraction of a tile's components that must change for the tile to be considered changed
+	unsigned int tileThresholds[numTiles*numTiles]; // Number of changed components at which each tile is considered changed
+	unsigned int maxStaticFrames; // Maximum number of consecutive unchanged frames after which a frame is emitted regardless; 0 never forces frames
+	FrameBuffer reference; // Most recently emitted frame, or invalid if the next frame must be emitted
+	unsigned int numStaticFrames; // Number of consecutive unchanged frames since the reference frame
+	TileMask changedTiles; // Mask of tiles that changed in the most recently checked frame
+	
+	/* Private methods: */
+	void updateTileThresholds(void); // Recalculates the per-tile change thresholds
+	
+	/* Constructors and destructors: */
+	public:
+	FrameChangeDetector(const Size& sFrameSize,bool sDepth,unsigned int sNumComponents =1); // Creates a change detector for depth frames or color frames with the given number of components per pixel, of the given size
+	
+	/* Methods: */
+	unsigned int getPixelThreshold(void) const // Returns the noise threshold
+		{
+		return pixelThreshold;
+		}
+	void setPixelThreshold(unsigned int newPixelThreshold); // Sets the largest per-component difference that is considered sensor noise
+	void setTileFraction(double newTileFraction); // Sets the fraction of a tile's components that must change for the tile to be considered changed
+	void setMaxStaticFrames(unsigned int newMaxStaticFrames); // Sets the maximum number of consecutive unchanged frames after which a frame is emitted regardless; 0 never forces frames
+	TileMask compare(const FrameBuffer& frame) const; // Returns the mask of tiles in which the given frame differs from the most recently emitted frame; returns all tiles if there is no such frame
+	bool update(const FrameBuffer& frame); // Returns true if the given frame changed or must be emitted for other reasons, and makes it the new reference frame in that case
+	void reset(void); // Forces the next frame to be emitted
+	TileMask getChangedTiles(void) const // Returns the mask of tiles that changed in the most recent frame passed to update
+		{
+		return changedTiles;
+		}
+	unsigned int getNumStaticFrames(void) const // Returns the number of consecutive unchanged frames since the most recently emitted frame
+		{
+		return numStaticFrames;
+		}
+	};
+
+}
+
+#endif
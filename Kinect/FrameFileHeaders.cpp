@@ -0,0 +1,129 @@
+/***********************************************************************
+FrameFileHeaders - Structures to read the file headers of color and
+depth streams written by FrameSaver, and to create frame readers for
+the streams that follow them.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FrameFileHeaders.h>
+
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Geometry/GeometryMarshallers.h>
+#include <Kinect/FrameReader.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class ColorFileHeader:
+********************************/
+
+ColorFileHeader::ColorFileHeader(IO::File& source)
+	{
+	/* Read the format version and reject versions newer than the newest one written by this library: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion>getColorFormatVersion(COLOR_CODEC_THEORA,true))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported color stream format version %u",formatVersion);
+	
+	/* Read the color stream's compression codec: */
+	codec=readColorFrameCodec(source,formatVersion);
+	
+	/* Read the color camera's lens distortion correction parameters if the file has them: */
+	if(formatVersion>=2)
+		lensDistortion=FrameSource::IntrinsicParameters::readLensDistortion(source,true);
+	
+	/* Read the color camera's projection: */
+	projection=Misc::Marshaller<FrameSource::IntrinsicParameters::PTransform>::read(source);
+	}
+
+FrameReader* ColorFileHeader::createReader(IO::File& source) const
+	{
+	FrameReader* result=createColorFrameReader(codec,source);
+	result->setReadMetadata(hasColorFrameMetadata(formatVersion));
+	return result;
+	}
+
+/********************************
+Methods of class DepthFileHeader:
+********************************/
+
+DepthFileHeader::DepthFileHeader(IO::File& source)
+	:depthCorrection(0)
+	{
+	/* Read the format version and reject versions newer than the newest one written by this library: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion>getDepthFormatVersion(DEPTH_CODEC_HUFFMAN,true))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported depth stream format version %u",formatVersion);
+	
+	/* Check if there are per-pixel depth correction coefficients: */
+	if(formatVersion>=4)
+		{
+		/* Read B-spline based depth correction parameters: */
+		depthCorrection=new FrameSource::DepthCorrection(source);
+		}
+	else if(formatVersion>=2&&source.read<Misc::UInt8>()!=0)
+		{
+		/* Skip the obsolete depth correction buffer: */
+		Size size;
+		source.read<Misc::UInt32,unsigned int>(size.getComponents(),2);
+		source.skip<Misc::Float32>(size.volume()*2);
+		}
+	
+	try
+		{
+		/* Read the depth stream's compression codec: */
+		codec=readDepthFrameCodec(source,formatVersion);
+		
+		/* Read the depth camera's lens distortion correction parameters if the file has them: */
+		if(formatVersion>=5)
+			lensDistortion=FrameSource::IntrinsicParameters::readLensDistortion(source,formatVersion>=6);
+		
+		/* Read the depth camera's projection and extrinsic parameters: */
+		projection=Misc::Marshaller<FrameSource::IntrinsicParameters::PTransform>::read(source);
+		extrinsicParameters=Misc::Marshaller<FrameSource::ExtrinsicParameters>::read(source);
+		}
+	catch(...)
+		{
+		delete depthCorrection;
+		throw;
+		}
+	}
+
+DepthFileHeader::~DepthFileHeader(void)
+	{
+	delete depthCorrection;
+	}
+
+FrameSource::DepthCorrection* DepthFileHeader::detachDepthCorrection(void)
+	{
+	FrameSource::DepthCorrection* result=depthCorrection;
+	depthCorrection=0;
+	return result;
+	}
+
+FrameReader* DepthFileHeader::createReader(IO::File& source) const
+	{
+	FrameReader* result=createDepthFrameReader(codec,source);
+	result->setReadMetadata(hasDepthFrameMetadata(formatVersion));
+	return result;
+	}
+
+}
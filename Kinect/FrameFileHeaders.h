@@ -0,0 +1,84 @@
+/***********************************************************************
+FrameFileHeaders - Structures to read the file headers of color and
+depth streams written by FrameSaver, and to create frame readers for
+the streams that follow them.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FRAMEFILEHEADERS_INCLUDED
+#define KINECT_FRAMEFILEHEADERS_INCLUDED
+
+#include <Kinect/FrameSource.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+namespace Kinect {
+class FrameReader;
+}
+
+namespace Kinect {
+
+struct ColorFileHeader // Structure holding the file header of a color stream
+	{
+	/* Elements: */
+	public:
+	unsigned int formatVersion; // Color stream format version
+	ColorFrameCodec codec; // Codec used to compress the stream's frames
+	FrameSource::IntrinsicParameters::LensDistortion lensDistortion; // Color camera's lens distortion correction parameters
+	FrameSource::IntrinsicParameters::PTransform projection; // Color camera's projection matrix
+	
+	/* Constructors and destructors: */
+	ColorFileHeader(IO::File& source); // Reads a color stream's file header from the given source, which must be set to little endianness; throws exception if the header is not supported
+	
+	/* Methods: */
+	FrameReader* createReader(IO::File& source) const; // Returns a frame reader for the stream following the file header, which reads the codec's stream header from the given source
+	};
+
+struct DepthFileHeader // Structure holding the file header of a depth stream
+	{
+	/* Elements: */
+	public:
+	unsigned int formatVersion; // Depth stream format version
+	FrameSource::DepthCorrection* depthCorrection; // Depth camera's per-pixel depth correction parameters, or null if the file does not contain them
+	DepthFrameCodec codec; // Codec used to compress the stream's frames
+	FrameSource::IntrinsicParameters::LensDistortion lensDistortion; // Depth camera's lens distortion correction parameters
+	FrameSource::IntrinsicParameters::PTransform projection; // Depth camera's projection matrix
+	FrameSource::ExtrinsicParameters extrinsicParameters; // Depth camera's extrinsic parameters
+	
+	/* Constructors and destructors: */
+	private:
+	DepthFileHeader(const DepthFileHeader& source); // Prohibit copy constructor
+	DepthFileHeader& operator=(const DepthFileHeader& source); // Prohibit assignment operator
+	public:
+	DepthFileHeader(IO::File& source); // Reads a depth stream's file header from the given source, which must be set to little endianness; throws exception if the header is not supported
+	~DepthFileHeader(void);
+	
+	/* Methods: */
+	FrameSource::DepthCorrection* detachDepthCorrection(void); // Returns the depth correction parameters and releases ownership of them to the caller
+	FrameReader* createReader(IO::File& source) const; // Returns a frame reader for the stream following the file header, which reads the codec's stream header from the given source
+	};
+
+}
+
+#endif
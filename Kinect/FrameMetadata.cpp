@@ -0,0 +1,72 @@
+/***********************************************************************
+FrameMetadata - Structure for fixed-size blocks of per-frame metadata
+reported by 3D camera devices, such as device frame numbers, device
+clock time stamps, drop or corruption flags, and exposure settings.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/FrameMetadata.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+
+namespace Kinect {
+
+/******************************
+Methods of class FrameMetadata:
+******************************/
+
+void FrameMetadata::write(IO::File& file) const
+	{
+	/* Write the block size followed by the fields: */
+	file.write<Misc::UInt16>(Misc::UInt16(serializedSize));
+	file.write<Misc::UInt32>(flags);
+	file.write<Misc::UInt32>(frameNumber);
+	file.write<Misc::UInt64>(deviceTimeStamp);
+	file.write<Misc::Float32>(exposureTime);
+	file.write<Misc::Float32>(gain);
+	}
+
+void FrameMetadata::read(IO::File& file)
+	{
+	/* Read the block size and check that it contains at least the fields known to this version: */
+	unsigned int blockSize=file.read<Misc::UInt16>();
+	if(blockSize<serializedSize)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame metadata block size %u",blockSize);
+	
+	/* Read the known fields: */
+	flags=file.read<Misc::UInt32>();
+	frameNumber=file.read<Misc::UInt32>();
+	deviceTimeStamp=file.read<Misc::UInt64>();
+	exposureTime=file.read<Misc::Float32>();
+	gain=file.read<Misc::Float32>();
+	
+	/* Skip fields added by later versions: */
+	file.skip<Misc::UInt8>(blockSize-serializedSize);
+	}
+
+void FrameMetadata::skip(IO::File& file)
+	{
+	/* Read the block size and skip the block: */
+	unsigned int blockSize=file.read<Misc::UInt16>();
+	file.skip<Misc::UInt8>(blockSize);
+	}
+
+}
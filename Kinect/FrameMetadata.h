@@ -0,0 +1,86 @@
+/***********************************************************************
+FrameMetadata - Structure for fixed-size blocks of per-frame metadata
+reported by 3D camera devices, such as device frame numbers, device
+clock time stamps, drop or corruption flags, and exposure settings.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_FRAMEMETADATA_INCLUDED
+#define KINECT_FRAMEMETADATA_INCLUDED
+
+#include <Misc/SizedTypes.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+struct FrameMetadata
+	{
+	/* Embedded classes: */
+	public:
+	enum Flags // Enumerated type for metadata flags
+		{
+		HAS_FRAME_NUMBER=0x1U, // The frame number was assigned by the device or its driver
+		HAS_DEVICE_TIME_STAMP=0x2U, // The device time stamp was reported by the device
+		HAS_EXPOSURE=0x4U, // The exposure time and gain were reported by the device
+		DROPPED_BEFORE=0x8U, // One or more frames of the same stream were lost between the previous delivered frame and this one
+		CORRUPTED=0x10U // Parts of the frame's data were lost in transfer
+		};
+	
+	static const unsigned int serializedSize=24; // Size of the fields written by this version, excluding the block size prefix
+	
+	/* Elements: */
+	Misc::UInt32 flags; // Bit mask of metadata flags
+	Misc::UInt32 frameNumber; // Sequential frame number assigned by the device or its driver
+	Misc::UInt64 deviceTimeStamp; // Frame time stamp in the device's own clock units
+	Misc::Float32 exposureTime; // Sensor exposure time in milliseconds
+	Misc::Float32 gain; // Sensor gain in device-specific units
+	
+	/* Constructors and destructors: */
+	FrameMetadata(void) // Creates an empty metadata block
+		:flags(0U),frameNumber(0U),deviceTimeStamp(0U),exposureTime(0.0f),gain(0.0f)
+		{
+		}
+	
+	/* Methods: */
+	bool isEmpty(void) const // Returns true if the metadata block does not carry any information
+		{
+		return flags==0U;
+		}
+	void setFrameNumber(Misc::UInt32 newFrameNumber,Misc::UInt32& lastFrameNumber,bool& haveLastFrameNumber) // Sets the frame number and flags a drop if it does not follow the given previous frame number of the same stream; updates the previous frame number
+		{
+		flags|=HAS_FRAME_NUMBER;
+		frameNumber=newFrameNumber;
+		if(haveLastFrameNumber&&newFrameNumber!=lastFrameNumber+1U)
+			flags|=DROPPED_BEFORE;
+		lastFrameNumber=newFrameNumber;
+		haveLastFrameNumber=true;
+		}
+	void write(IO::File& file) const; // Writes the metadata block to the given file, prefixed by its size
+	void read(IO::File& file); // Reads a metadata block from the given file, skipping fields added by later versions
+	static void skip(IO::File& file); // Skips a metadata block in the given file
+	};
+
+}
+
+#endif
@@ -23,14 +23,58 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Kinect/FrameReader.h>
 
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <Kinect/FrameBuffer.h>
+
 namespace Kinect {
 
 /****************************
 Methods of class FrameReader:
 ****************************/
 
+void FrameReader::readFrameHeader(IO::File& source,FrameBuffer& frame)
+	{
+	/* Read the frame's time stamp: */
+	frame.timeStamp=source.read<Misc::Float64>();
+	
+	/* Read the frame's metadata if the stream has it: */
+	if(readMetadata)
+		lastMetadata.read(source);
+	frame.metadata=lastMetadata;
+	}
+
+double FrameReader::skipFrameHeader(IO::File& source)
+	{
+	/* Read the frame's time stamp: */
+	double result=source.read<Misc::Float64>();
+	
+	/* Read the frame's metadata if the stream has it: */
+	if(readMetadata)
+		lastMetadata.read(source);
+	
+	return result;
+	}
+
+FrameReader::FrameReader(void)
+	:memoryTag(MemoryAccounting::FRAME_READER),readMetadata(false)
+	{
+	}
+
 FrameReader::~FrameReader(void)
 	{
 	}
 
+void FrameReader::setReadMetadata(bool newReadMetadata)
+	{
+	readMetadata=newReadMetadata;
+	}
+
+double FrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* Decompress and discard the next frame; frames are independent by default: */
+	keyFrame=true;
+	return readNextFrame().timeStamp;
+	}
+
 }
@@ -25,8 +25,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define KINECT_FRAMEREADER_INCLUDED
 
 #include <Kinect/Types.h>
+#include <Kinect/MemoryAccounting.h>
+#include <Kinect/FrameMetadata.h>
 
 /* Forward declarations: */
+namespace IO {
+class File;
+}
 namespace Kinect {
 class FrameBuffer;
 }
@@ -38,9 +43,17 @@ class FrameReader
 	/* Elements: */
 	protected:
 	Size size; // Width and height of returned frames
+	MemoryAccounting::Tag memoryTag; // Owner tag to which returned frames are accounted
+	bool readMetadata; // Flag whether each frame's time stamp is followed by its metadata
+	FrameMetadata lastMetadata; // Metadata of the most recently read or skipped frame
+	
+	/* Protected methods: */
+	void readFrameHeader(IO::File& source,FrameBuffer& frame); // Reads a frame's time stamp and, if present, its metadata from the given source into the given frame
+	double skipFrameHeader(IO::File& source); // Reads a frame's time stamp and, if present, its metadata from the given source; returns the time stamp
 	
 	/* Constructors and destructors: */
 	public:
+	FrameReader(void);
 	virtual ~FrameReader(void);
 	
 	/* Methods: */
@@ -52,7 +65,25 @@ class FrameReader
 		{
 		return size[dimension];
 		}
+	MemoryAccounting::Tag getMemoryTag(void) const // Returns the owner tag to which returned frames are accounted
+		{
+		return memoryTag;
+		}
+	void setMemoryTag(MemoryAccounting::Tag newMemoryTag) // Sets the owner tag to which future returned frames are accounted
+		{
+		memoryTag=newMemoryTag;
+		}
+	bool getReadMetadata(void) const // Returns true if frame metadata is read
+		{
+		return readMetadata;
+		}
+	void setReadMetadata(bool newReadMetadata); // Sets whether frames in the stream carry metadata, as indicated by the stream's container; must be called before the first frame is read
+	const FrameMetadata& getLastMetadata(void) const // Returns the metadata of the most recently read or skipped frame
+		{
+		return lastMetadata;
+		}
 	virtual FrameBuffer readNextFrame(void) =0; // Returns the next color or depth frame
+	virtual double skipNextFrame(bool& keyFrame); // Skips the next color or depth frame without decompressing it if possible and returns its time stamp, or Math::Constants<double>::max at the end of the stream; sets keyFrame to true if decompression can start at the skipped frame
 	};
 
 }
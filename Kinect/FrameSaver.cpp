@@ -27,18 +27,12 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/SizedTypes.h>
 #include <IO/File.h>
 #include <IO/OpenFile.h>
+#include <Math/Constants.h>
 #include <Geometry/GeometryMarshallers.h>
-#include <Video/Config.h>
+#include <Kinect/MemoryAccounting.h>
 #include <Kinect/FrameSource.h>
-#include <Kinect/DepthFrameWriter.h>
-#include <Kinect/LossyDepthFrameWriter.h>
-#include <Kinect/ColorFrameWriter.h>
-
-#if VIDEO_CONFIG_HAVE_THEORA
-#define KINECT_FRAMESAVER_LOSSY 0 // Disabled until I figure out a codec that works
-#else
-#define KINECT_FRAMESAVER_LOSSY 0
-#endif
+#include <Kinect/FrameWriter.h>
+#include <Kinect/FrameChangeDetector.h>
 
 namespace Kinect {
 
@@ -46,11 +40,16 @@ namespace Kinect {
 Methods of class FrameSaver:
 ***************************/
 
-void FrameSaver::initialize(FrameSource& frameSource)
+void FrameSaver::initialize(FrameSource& frameSource,DepthFrameCodec depthCodec,ColorFrameCodec colorCodec,bool writeMetadata)
 	{
 	/* Write the file formats' version numbers to the depth and color files: */
-	colorFrameFile->write<Misc::UInt32>(2);
-	depthFrameFile->write<Misc::UInt32>(6);
+	unsigned int colorFormatVersion=getColorFormatVersion(colorCodec,writeMetadata);
+	colorFrameFile->write<Misc::UInt32>(colorFormatVersion);
+	unsigned int depthFormatVersion=getDepthFormatVersion(depthCodec,writeMetadata);
+	depthFrameFile->write<Misc::UInt32>(depthFormatVersion);
+	
+	/* Write the color stream's compression codec: */
+	writeColorFrameCodec(colorCodec,*colorFrameFile,colorFormatVersion);
 	
 	/* Write the frame source's depth correction parameters: */
 	FrameSource::DepthCorrection* dc=frameSource.getDepthCorrectionParameters();
@@ -66,17 +65,8 @@ void FrameSaver::initialize(FrameSource& frameSource)
 			depthFrameFile->write<Misc::SInt32>(0);
 		}
 	
-	#if KINECT_FRAMESAVER_LOSSY
-	
-	/* Signal whether the depth stream will contain losslessly compressed frames (lossy compression disabled for now): */
-	depthFrameFile->write<Misc::UInt8>(1);
-	
-	#else
-	
-	/* Signal that the depth stream will contain losslessly compressed frames: */
-	depthFrameFile->write<Misc::UInt8>(0);
-	
-	#endif
+	/* Write the depth stream's compression codec: */
+	writeDepthFrameCodec(depthCodec,*depthFrameFile,depthFormatVersion);
 	
 	/* Write the frame source's intrinsic color and depth camera parameters to their respective files: */
 	FrameSource::IntrinsicParameters ips=frameSource.getIntrinsicParameters();
@@ -89,12 +79,12 @@ void FrameSaver::initialize(FrameSource& frameSource)
 	Misc::Marshaller<FrameSource::ExtrinsicParameters>::write(frameSource.getExtrinsicParameters(),*depthFrameFile);
 	
 	/* Create the color and depth frame writers: */
-	colorFrameWriter=new ColorFrameWriter(*colorFrameFile,frameSource.getActualFrameSize(FrameSource::COLOR),frameSource.getColorSpace());
-	#if KINECT_FRAMESAVER_LOSSY
-	depthFrameWriter=new LossyDepthFrameWriter(*depthFrameFile,frameSource.getActualFrameSize(FrameSource::DEPTH));
-	#else
-	depthFrameWriter=new DepthFrameWriter(*depthFrameFile,frameSource.getActualFrameSize(FrameSource::DEPTH));
-	#endif
+	colorFrameWriter=createColorFrameWriter(colorCodec,*colorFrameFile,frameSource.getActualFrameSize(FrameSource::COLOR),frameSource.getColorSpace());
+	numColorComponents=frameSource.getColorSpace()==FrameSource::BAYER_BGGR?1U:3U;
+	depthFrameWriter=createDepthFrameWriter(depthCodec,*depthFrameFile,frameSource.getActualFrameSize(FrameSource::DEPTH));
+	rawDepthFrameWriter=dynamic_cast<KinectV1DepthFrameWriter*>(depthFrameWriter);
+	colorFrameWriter->setWriteMetadata(writeMetadata);
+	depthFrameWriter->setWriteMetadata(hasDepthFrameMetadata(depthFormatVersion));
 	
 	/* Start the frame writing threads: */
 	colorFrameWritingThread.start(this,&FrameSaver::colorFrameWritingThreadMethod);
@@ -119,10 +109,12 @@ void* FrameSaver::colorFrameWritingThreadMethod(void)
 		/* Grab the next frame: */
 		fb=colorFrames.front();
 		colorFrames.pop_front();
+		MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,fb.getAccountedSize());
 		}
 		
-		/* Write the next frame to the color frame file: */
-		colorFrameWriter->writeFrame(fb);
+		/* Write the next frame to the color frame file unless it is identical to the most recently written frame up to sensor noise: */
+		if(colorChangeDetector==0||colorChangeDetector->update(fb))
+			colorFrameWriter->writeFrame(fb);
 		}
 	
 	return 0;
@@ -133,6 +125,7 @@ void* FrameSaver::depthFrameWritingThreadMethod(void)
 	while(true)
 		{
 		FrameBuffer fb;
+		KinectV1RawDepthFrame rawFrame;
 		{
 		/* Wait until there is an unsaved frame in the queue: */
 		Threads::MutexCond::Lock depthFramesLock(depthFramesCond);
@@ -146,41 +139,56 @@ void* FrameSaver::depthFrameWritingThreadMethod(void)
 		/* Grab the next frame: */
 		fb=depthFrames.front();
 		depthFrames.pop_front();
+		rawFrame=rawDepthFrames.front();
+		rawDepthFrames.pop_front();
+		MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,fb.getAccountedSize());
+		MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,rawFrame.data.getAccountedSize());
 		}
 		
-		/* Write the next frame to the depth frame file: */
-		depthFrameWriter->writeFrame(fb);
+		if(rawFrame.data.isValid())
+			{
+			/* Write the next frame's compressed data to the depth frame file as-is, or, if the decoded frame is present, mark removed pixels and skip the frame if it is identical to the most recently written frame up to sensor noise: */
+			if(!fb.isValid())
+				rawDepthFrameWriter->writeRawFrame(rawFrame);
+			else if(depthChangeDetector==0||depthChangeDetector->update(fb))
+				rawDepthFrameWriter->writeRawFrame(rawFrame,fb);
+			}
+		else if(depthChangeDetector==0||depthChangeDetector->update(fb))
+			{
+			/* Write the next frame to the depth frame file unless it is identical to the most recently written frame up to sensor noise: */
+			depthFrameWriter->writeFrame(fb);
+			}
 		}
 	
 	return 0;
 	}
 
-FrameSaver::FrameSaver(FrameSource& frameSource,const char* colorFrameFileName,const char* depthFrameFileName)
+FrameSaver::FrameSaver(FrameSource& frameSource,const char* colorFrameFileName,const char* depthFrameFileName,DepthFrameCodec depthCodec,ColorFrameCodec colorCodec,bool writeMetadata)
 	:timeStampOffset(0.0),
 	 done(false),
 	 colorFrameFile(IO::openFile(colorFrameFileName,IO::File::WriteOnly)),
-	 colorFrameWriter(0),
+	 colorFrameWriter(0),numColorComponents(3),colorChangeDetector(0),
 	 depthFrameFile(IO::openFile(depthFrameFileName,IO::File::WriteOnly)),
-	 depthFrameWriter(0)
+	 depthFrameWriter(0),rawDepthFrameWriter(0),rawDepthTimeStamp(-Math::Constants<double>::max),depthChangeDetector(0)
 	{
 	/* Initialize the frame files: */
 	colorFrameFile->setEndianness(Misc::LittleEndian);
 	depthFrameFile->setEndianness(Misc::LittleEndian);
 	
 	/* Initialize the frame saver: */
-	initialize(frameSource);
+	initialize(frameSource,depthCodec,colorCodec,writeMetadata);
 	}
 
-FrameSaver::FrameSaver(FrameSource& frameSource,IO::FilePtr sColorFrameFile,IO::FilePtr sDepthFrameFile)
+FrameSaver::FrameSaver(FrameSource& frameSource,IO::FilePtr sColorFrameFile,IO::FilePtr sDepthFrameFile,DepthFrameCodec depthCodec,ColorFrameCodec colorCodec,bool writeMetadata)
 	:timeStampOffset(0.0),
 	 done(false),
 	 colorFrameFile(sColorFrameFile),
-	 colorFrameWriter(0),
+	 colorFrameWriter(0),numColorComponents(3),colorChangeDetector(0),
 	 depthFrameFile(sDepthFrameFile),
-	 depthFrameWriter(0)
+	 depthFrameWriter(0),rawDepthFrameWriter(0),rawDepthTimeStamp(-Math::Constants<double>::max),depthChangeDetector(0)
 	{
 	/* Initialize the frame saver: */
-	initialize(frameSource);
+	initialize(frameSource,depthCodec,colorCodec,writeMetadata);
 	}
 
 FrameSaver::~FrameSaver(void)
@@ -194,9 +202,14 @@ FrameSaver::~FrameSaver(void)
 	colorFrameWritingThread.join();
 	depthFrameWritingThread.join();
 	
-	/* Delete the frame writers: */
+	/* Delete the frame writers and change detectors: */
 	delete colorFrameWriter;
 	delete depthFrameWriter;
+	delete colorChangeDetector;
+	delete depthChangeDetector;
+	
+	/* Release a compressed depth frame that was still waiting for its decoded version: */
+	MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,pendingRawDepthFrame.data.getAccountedSize());
 	}
 
 void FrameSaver::setTimeStampOffset(double newTimeStampOffset)
@@ -205,11 +218,33 @@ void FrameSaver::setTimeStampOffset(double newTimeStampOffset)
 	timeStampOffset=newTimeStampOffset;
 	}
 
+void FrameSaver::skipStaticFrames(unsigned int depthThreshold,unsigned int colorThreshold,double tileFraction,unsigned int maxStaticFrames)
+	{
+	/* Create change detectors matching the depth and color frame writers: */
+	delete depthChangeDetector;
+	depthChangeDetector=new FrameChangeDetector(depthFrameWriter->getSize(),true);
+	depthChangeDetector->setPixelThreshold(depthThreshold);
+	depthChangeDetector->setTileFraction(tileFraction);
+	depthChangeDetector->setMaxStaticFrames(maxStaticFrames);
+	delete colorChangeDetector;
+	colorChangeDetector=new FrameChangeDetector(colorFrameWriter->getSize(),false,numColorComponents);
+	colorChangeDetector->setPixelThreshold(colorThreshold);
+	colorChangeDetector->setTileFraction(tileFraction);
+	colorChangeDetector->setMaxStaticFrames(maxStaticFrames);
+	}
+
+bool FrameSaver::needsDecodedDepthFrames(void) const
+	{
+	/* Decoded depth frames are needed to detect static depth frames: */
+	return depthChangeDetector!=0;
+	}
+
 void FrameSaver::saveColorFrame(const FrameBuffer& newFrame)
 	{
 	/* Enqueue the color frame: */
 	Threads::MutexCond::Lock colorFramesLock(colorFramesCond);
 	colorFrames.push_back(newFrame);
+	MemoryAccounting::hold(MemoryAccounting::FRAME_SAVER,newFrame.getAccountedSize());
 	
 	/* Offset the new frame's time stamp: */
 	colorFrames.back().timeStamp-=timeStampOffset;
@@ -220,9 +255,25 @@ void FrameSaver::saveColorFrame(const FrameBuffer& newFrame)
 
 void FrameSaver::saveDepthFrame(const FrameBuffer& newFrame)
 	{
-	/* Enqueue the depth frame: */
 	Threads::MutexCond::Lock depthFramesLock(depthFramesCond);
+	
+	/* Ignore the depth frame if it was already queued in compressed form: */
+	if(rawDepthFrameWriter!=0&&newFrame.timeStamp==rawDepthTimeStamp)
+		return;
+	
+	/* Enqueue the depth frame, together with its compressed version if that is waiting for it: */
 	depthFrames.push_back(newFrame);
+	MemoryAccounting::hold(MemoryAccounting::FRAME_SAVER,newFrame.getAccountedSize());
+	if(pendingRawDepthFrame.data.isValid()&&pendingRawDepthFrame.data.timeStamp==newFrame.timeStamp)
+		{
+		rawDepthFrames.push_back(pendingRawDepthFrame);
+		rawDepthFrames.back().data.timeStamp-=timeStampOffset;
+		MemoryAccounting::hold(MemoryAccounting::FRAME_SAVER,pendingRawDepthFrame.data.getAccountedSize());
+		}
+	else
+		rawDepthFrames.push_back(KinectV1RawDepthFrame());
+	MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,pendingRawDepthFrame.data.getAccountedSize());
+	pendingRawDepthFrame=KinectV1RawDepthFrame();
 	
 	/* Offset the new frame's time stamp: */
 	depthFrames.back().timeStamp-=timeStampOffset;
@@ -231,4 +282,34 @@ void FrameSaver::saveDepthFrame(const FrameBuffer& newFrame)
 	depthFramesCond.signal();
 	}
 
+void FrameSaver::saveRawDepthFrame(const KinectV1RawDepthFrame& newRawFrame)
+	{
+	/* Ignore the compressed frame if the depth frame writer can not pass it through: */
+	if(rawDepthFrameWriter==0)
+		return;
+	
+	Threads::MutexCond::Lock depthFramesLock(depthFramesCond);
+	
+	/* Hold on to the compressed depth frame until its decoded version arrives if pixels need to be marked as removed, or if depth frames need to be checked for changes: */
+	if(newRawFrame.removedPixels||depthChangeDetector!=0)
+		{
+		MemoryAccounting::unhold(MemoryAccounting::FRAME_SAVER,pendingRawDepthFrame.data.getAccountedSize());
+		pendingRawDepthFrame=newRawFrame;
+		MemoryAccounting::hold(MemoryAccounting::FRAME_SAVER,pendingRawDepthFrame.data.getAccountedSize());
+		return;
+		}
+	
+	/* Enqueue the compressed depth frame without a decoded version: */
+	depthFrames.push_back(FrameBuffer());
+	rawDepthFrames.push_back(newRawFrame);
+	MemoryAccounting::hold(MemoryAccounting::FRAME_SAVER,newRawFrame.data.getAccountedSize());
+	rawDepthTimeStamp=newRawFrame.data.timeStamp;
+	
+	/* Offset the new frame's time stamp: */
+	rawDepthFrames.back().data.timeStamp-=timeStampOffset;
+	
+	/* Wake up the depth frame saver: */
+	depthFramesCond.signal();
+	}
+
 }
@@ -31,11 +31,15 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/MutexCond.h>
 #include <Threads/Thread.h>
 #include <Kinect/FrameBuffer.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
 
 /* Forward declarations: */
 namespace Kinect {
 class FrameSource;
 class FrameWriter;
+class FrameChangeDetector;
 }
 
 namespace Kinect {
@@ -50,28 +54,38 @@ class FrameSaver
 	std::deque<FrameBuffer> colorFrames; // Queue of color frames still to be saved
 	IO::FilePtr colorFrameFile; // File receiving color frames
 	FrameWriter* colorFrameWriter; // Helper object to compress and write color frames
+	unsigned int numColorComponents; // Number of components per color frame pixel
+	FrameChangeDetector* colorChangeDetector; // Detector to skip color frames of static scenes, or null if all color frames are written
 	Threads::Thread colorFrameWritingThread; // Thread saving color frames
 	Threads::MutexCond depthFramesCond; // Condition variable to signal new frames in the depth queue
-	std::deque<FrameBuffer> depthFrames; // Queue of depth frames still to be saved
+	std::deque<FrameBuffer> depthFrames; // Queue of decoded depth frames still to be saved, or invalid frames for compressed depth frames queued without their decoded versions
+	std::deque<KinectV1RawDepthFrame> rawDepthFrames; // Queue of depth frames in a first-generation Kinect camera's native format matching the decoded depth frame queue, with invalid data for depth frames that need to be re-encoded
 	IO::FilePtr depthFrameFile; // File receiving depth frames
 	FrameWriter* depthFrameWriter; // Helper object to compress and write depth frames
+	KinectV1DepthFrameWriter* rawDepthFrameWriter; // Depth frame writer if it can write compressed depth frames without re-encoding them, or null
+	double rawDepthTimeStamp; // Time stamp of the most recently queued compressed depth frame, before offsetting
+	KinectV1RawDepthFrame pendingRawDepthFrame; // Compressed depth frame with removed pixels waiting for its decoded and processed version
+	FrameChangeDetector* depthChangeDetector; // Detector to skip depth frames of static scenes, or null if all depth frames are written
 	Threads::Thread depthFrameWritingThread; // Thread saving depth frames
 	
 	/* Private methods: */
-	void initialize(FrameSource& frameSource); // Initializes the frame files and writers
+	void initialize(FrameSource& frameSource,DepthFrameCodec depthCodec,ColorFrameCodec colorCodec,bool writeMetadata); // Initializes the frame files and writers
 	void* colorFrameWritingThreadMethod(void); // Thread method saving color frames
 	void* depthFrameWritingThreadMethod(void); // Thread method saving depth frames
 	
 	/* Constructors and destructors: */
 	public:
-	FrameSaver(FrameSource& frameSource,const char* colorFrameFileName,const char* depthFrameFileName); // Creates frame saver for the given frame source, writing to two files of the given names
-	FrameSaver(FrameSource& frameSource,IO::FilePtr sColorFrameFile,IO::FilePtr sDepthFrameFile); // Ditto, to the two already opened files
+	FrameSaver(FrameSource& frameSource,const char* colorFrameFileName,const char* depthFrameFileName,DepthFrameCodec depthCodec =DEPTH_CODEC_HUFFMAN,ColorFrameCodec colorCodec =COLOR_CODEC_THEORA,bool writeMetadata =false); // Creates frame saver for the given frame source, writing to two files of the given names and compressing depth and color frames with the given codecs; writes per-frame metadata if the given flag is true
+	FrameSaver(FrameSource& frameSource,IO::FilePtr sColorFrameFile,IO::FilePtr sDepthFrameFile,DepthFrameCodec depthCodec =DEPTH_CODEC_HUFFMAN,ColorFrameCodec colorCodec =COLOR_CODEC_THEORA,bool writeMetadata =false); // Ditto, to the two already opened files
 	~FrameSaver(void);
 	
 	/* Methods: */
 	void setTimeStampOffset(double newTimeStampOffset); // Sets the time stamp offset for all subsequent frames
+	void skipStaticFrames(unsigned int depthThreshold,unsigned int colorThreshold,double tileFraction,unsigned int maxStaticFrames); // Skips writing depth and color frames that do not differ from the most recently written frames by more than the given per-pixel thresholds; must be called before the first frame is queued
+	bool needsDecodedDepthFrames(void) const; // Returns true if each compressed depth frame passed to saveRawDepthFrame must be followed by its decoded version, because static depth frames are skipped
 	void saveColorFrame(const FrameBuffer& newFrame); // Queues a new color frame for writing
 	void saveDepthFrame(const FrameBuffer& newFrame); // Queues a new depth frame for writing
+	void saveRawDepthFrame(const KinectV1RawDepthFrame& newRawFrame); // Queues a depth frame in a first-generation Kinect camera's native format for writing without re-encoding, if the depth codec supports it; the decoded frame subsequently passed to saveDepthFrame is then ignored, unless it is needed to mark pixels removed by background or floor removal or to detect static depth frames
 	};
 
 }
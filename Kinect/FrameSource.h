@@ -62,7 +62,8 @@ class FrameSource
 	enum ColorSpace // Color space used by the source's color stream
 		{
 		RGB=0, // RGB color space
-		YPCBCR // Y'CbCr color space compatible with JPEG, MPEG, and Theora codecs
+		YPCBCR, // Y'CbCr color space compatible with JPEG, MPEG, and Theora codecs
+		BAYER_BGGR // Raw Bayer color filter array with one component per pixel and a blue pixel at the origin
 		};
 	
 	typedef Realtime::TimePointMonotonic Time; // Type for timestamp base points
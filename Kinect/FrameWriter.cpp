@@ -23,14 +23,34 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Kinect/FrameWriter.h>
 
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <Kinect/FrameBuffer.h>
+
 namespace Kinect {
 
 /****************************
 Methods of class FrameWriter:
 ****************************/
 
+size_t FrameWriter::writeFrameHeader(IO::File& sink,const FrameBuffer& frame)
+	{
+	/* Write the frame's time stamp: */
+	sink.write<Misc::Float64>(frame.timeStamp);
+	size_t result=sizeof(Misc::Float64);
+	
+	/* Write the frame's metadata if requested: */
+	if(writeMetadata)
+		{
+		frame.metadata.write(sink);
+		result+=sizeof(Misc::UInt16)+FrameMetadata::serializedSize;
+		}
+	
+	return result;
+	}
+
 FrameWriter::FrameWriter(const Size& sSize)
-	:size(sSize)
+	:size(sSize),writeMetadata(false)
 	{
 	}
 
@@ -38,4 +58,9 @@ FrameWriter::~FrameWriter(void)
 	{
 	}
 
+void FrameWriter::setWriteMetadata(bool newWriteMetadata)
+	{
+	writeMetadata=newWriteMetadata;
+	}
+
 }
@@ -28,6 +28,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Kinect/Types.h>
 
 /* Forward declarations: */
+namespace IO {
+class File;
+}
 namespace Kinect {
 class FrameBuffer;
 }
@@ -39,6 +42,10 @@ class FrameWriter
 	/* Elements: */
 	protected:
 	Size size; // Width and height of provided frames
+	bool writeMetadata; // Flag whether to write each frame's metadata after its time stamp
+	
+	/* Protected methods: */
+	size_t writeFrameHeader(IO::File& sink,const FrameBuffer& frame); // Writes the given frame's time stamp and, if enabled, its metadata to the given sink; returns number of bytes written
 	
 	/* Constructors and destructors: */
 	public:
@@ -54,7 +61,20 @@ class FrameWriter
 		{
 		return size[dimension];
 		}
+	bool getWriteMetadata(void) const // Returns true if frame metadata is written
+		{
+		return writeMetadata;
+		}
+	void setWriteMetadata(bool newWriteMetadata); // Enables or disables writing frame metadata; the stream's container must indicate the presence of metadata to readers
 	virtual size_t writeFrame(const FrameBuffer& frame) =0; // Writes the given color or depth frame; returns size of written data in bytes
+	virtual bool wasKeyFrame(void) const // Returns true if the most recently written frame can be decoded without any previous frames
+		{
+		return true;
+		}
+	virtual void requestKeyFrame(void) // Requests that the next written frame can be decoded without any previous frames
+		{
+		/* Frames are compressed independently by default: */
+		}
 	};
 
 }
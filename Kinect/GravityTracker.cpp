@@ -0,0 +1,125 @@
+/***********************************************************************
+GravityTracker - Class to continuously track the direction of gravity
+in a Kinect v1 camera's coordinate system by low-pass filtering the
+accelerometer in the camera's motor unit in a background thread.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/GravityTracker.h>
+
+#include <unistd.h>
+#include <stdexcept>
+#include <Misc/MessageLogger.h>
+#include <Math/Math.h>
+
+namespace Kinect {
+
+/*******************************
+Methods of class GravityTracker:
+*******************************/
+
+void* GravityTracker::pollingThreadMethod(void)
+	{
+	unsigned int numErrors=0;
+	while(keepPolling)
+		{
+		try
+			{
+			/* Read the accelerometer; at rest, it measures the reaction to gravity, i.e., the up direction: */
+			float accels[3];
+			motor.readAccelerometers(accels);
+			Vector up(accels[0],accels[1],accels[2]);
+			
+			/* Blend the new reading into the filtered up direction: */
+			{
+			Threads::Spinlock::Lock upLock(upMutex);
+			if(numSamples==0)
+				filteredUp=up;
+			else
+				{
+				double alpha=1.0-Math::exp(-double(pollInterval)*1.0e-6/filterTimeConstant);
+				filteredUp+=(up-filteredUp)*alpha;
+				}
+			++numSamples;
+			}
+			
+			numErrors=0;
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Log the first of a series of errors and carry on: */
+			if(numErrors==0)
+				Misc::formattedConsoleError("Kinect::GravityTracker: Unable to read accelerometer due to exception %s",err.what());
+			++numErrors;
+			}
+		
+		/* Wait for the next reading: */
+		usleep(pollInterval);
+		}
+	
+	return 0;
+	}
+
+GravityTracker::GravityTracker(size_t motorIndex,double sFilterTimeConstant)
+	:motor(motorIndex),
+	 pollInterval(20000),filterTimeConstant(sFilterTimeConstant),
+	 filteredUp(Vector::zero),numSamples(0),
+	 keepPolling(true)
+	{
+	/* Start the polling thread: */
+	pollingThread.start(this,&GravityTracker::pollingThreadMethod);
+	}
+
+GravityTracker::~GravityTracker(void)
+	{
+	/* Shut down the polling thread: */
+	keepPolling=false;
+	pollingThread.join();
+	}
+
+void GravityTracker::setFilterTimeConstant(double newFilterTimeConstant)
+	{
+	Threads::Spinlock::Lock upLock(upMutex);
+	filterTimeConstant=newFilterTimeConstant;
+	}
+
+bool GravityTracker::hasUpDirection(void) const
+	{
+	Threads::Spinlock::Lock upLock(upMutex);
+	return numSamples>0;
+	}
+
+GravityTracker::Vector GravityTracker::getUpDirection(void) const
+	{
+	Vector result;
+	{
+	Threads::Spinlock::Lock upLock(upMutex);
+	result=filteredUp;
+	}
+	
+	/* Normalize the up direction if there is one: */
+	Scalar len=result.mag();
+	if(len>Scalar(0))
+		result/=len;
+	
+	return result;
+	}
+
+}
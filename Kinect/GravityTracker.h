@@ -0,0 +1,92 @@
+/***********************************************************************
+GravityTracker - Class to continuously track the direction of gravity
+in a Kinect v1 camera's coordinate system by low-pass filtering the
+accelerometer in the camera's motor unit in a background thread.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_GRAVITYTRACKER_INCLUDED
+#define KINECT_GRAVITYTRACKER_INCLUDED
+
+#include <Threads/Spinlock.h>
+#include <Threads/Thread.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Rotation.h>
+#include <Kinect/Motor.h>
+
+namespace Kinect {
+
+class GravityTracker
+	{
+	/* Embedded classes: */
+	public:
+	typedef double Scalar; // Scalar type for camera space
+	typedef Geometry::Point<Scalar,3> Point; // Type for points in camera space
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors in camera space
+	typedef Geometry::Rotation<Scalar,3> Rotation; // Type for rotations
+	
+	/* Elements: */
+	private:
+	Motor motor; // The motor unit containing the accelerometer
+	unsigned int pollInterval; // Interval between accelerometer readings in microseconds
+	double filterTimeConstant; // Time constant of the exponential low-pass filter in seconds
+	mutable Threads::Spinlock upMutex; // Mutex protecting the filtered up direction
+	Vector filteredUp; // Low-pass filtered accelerometer reading, pointing up in camera space
+	unsigned int numSamples; // Number of accelerometer readings that went into the filtered up direction
+	volatile bool keepPolling; // Flag to shut down the polling thread
+	Threads::Thread pollingThread; // Thread polling the accelerometer
+	
+	/* Private methods: */
+	void* pollingThreadMethod(void); // Thread method polling and filtering the accelerometer
+	
+	/* Constructors and destructors: */
+	public:
+	GravityTracker(size_t motorIndex =0,double sFilterTimeConstant =1.0); // Starts tracking gravity using the index-th Kinect motor device, with the given low-pass filter time constant in seconds
+	~GravityTracker(void);
+	
+	/* Methods: */
+	void setFilterTimeConstant(double newFilterTimeConstant); // Sets the time constant of the low-pass filter in seconds
+	bool hasUpDirection(void) const; // Returns true if at least one accelerometer reading has been received
+	Vector getUpDirection(void) const; // Returns the current normalized up direction, i.e., the direction opposite to gravity, in camera space
+	Vector getGravity(void) const // Returns the current normalized gravity vector in camera space
+		{
+		return -getUpDirection();
+		}
+	template <class TransformParam>
+	static TransformParam alignTransform(const TransformParam& transform,const Vector& cameraUp,const Vector& worldUp,const Point& worldPivot) // Returns the given camera-to-world transformation rotated around the given world-space pivot point such that the given up directions in camera space and world space agree, which corrects pitch and roll but not yaw
+		{
+		/* Transform the camera's up direction to world space: */
+		Point center=transform.transform(Point::origin);
+		Vector transformedUp=transform.transform(Point::origin+cameraUp)-center;
+		
+		/* Rotate the transformed up direction onto the world's up direction: */
+		return TransformParam::rotateAround(worldPivot,Rotation::rotateFromTo(transformedUp,worldUp))*transform;
+		}
+	template <class TransformParam>
+	static TransformParam alignTransform(const TransformParam& transform,const Vector& cameraUp,const Vector& worldUp) // Ditto, rotating around the camera's center, which leaves the camera's position unchanged
+		{
+		return alignTransform(transform,cameraUp,worldUp,transform.transform(Point::origin));
+		}
+	};
+
+}
+
+#endif
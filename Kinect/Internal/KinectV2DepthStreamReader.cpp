@@ -343,8 +343,9 @@ void* KinectV2DepthStreamReader::depthThreadMethod(void)
 			}
 		
 		/* Quantize the depth image: */
-		FrameBuffer depthFrame(Size(512,424),424*512*sizeof(FrameSource::DepthPixel));
+		FrameBuffer depthFrame(Size(512,424),424*512*sizeof(FrameSource::DepthPixel),MemoryAccounting::CAMERA);
 		depthFrame.timeStamp=nextFrameTimeStamp;
+		depthFrame.metadata.setFrameNumber(nextFrameNumber,lastDepthFrameNumber,haveLastDepthFrameNumber);
 		diPtr=depthImage;
 		FrameSource::DepthPixel* fRowPtr=depthFrame.getData<FrameSource::DepthPixel>();
 		for(int y=0;y<424;++y,fRowPtr+=512)
@@ -384,7 +385,7 @@ KinectV2DepthStreamReader::KinectV2DepthStreamReader(CameraV2& sCamera)
 	 rawImageReadyCallback(0),
 	 arctanTable(0),
 	 confidenceTable(0),xTable(0),zTable(0),
-	 depthImage(0),depthFrameNumber(0),
+	 depthImage(0),depthFrameNumber(0),lastDepthFrameNumber(0),haveLastDepthFrameNumber(false),
 	 imageReadyCallback(0)
 	{
 	for(int i=0;i<10;++i)
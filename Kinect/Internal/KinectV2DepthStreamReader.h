@@ -96,6 +96,8 @@ class KinectV2DepthStreamReader
 	float* depthImage; // Final depth image
 	float filterDistanceThreshold; // Threshold value for edge-retaining low-pass filter
 	unsigned int depthFrameNumber; // Index of depth image currently in the buffer
+	Misc::UInt32 lastDepthFrameNumber; // Index of the most recently delivered depth frame, to detect lost frames
+	bool haveLastDepthFrameNumber; // Flag whether a depth frame has been delivered since streaming started
 	float zMin,zMax; // Z value range for quantization
 	unsigned int dMax; // Maximum integer depth value
 	float A,B; // Z-to-depth conversion formula coefficients
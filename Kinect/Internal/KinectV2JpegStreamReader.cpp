@@ -160,8 +160,8 @@ void* KinectV2JpegStreamReader::decompressionThreadMethod(void)
 			}
 		
 		/* Shave the Kinect2 image header off the first transfer buffer: */
-		// const Misc::UInt32* header=reinterpret_cast<const Misc::UInt32*>(sourceManager.next_input_byte);
-		// unsigned int frameNumber=header[0];
+		const Misc::UInt32* header=reinterpret_cast<const Misc::UInt32*>(sourceManager.next_input_byte);
+		Misc::UInt32 frameNumber=header[0];
 		// unsigned int magic0=header[1];
 		sourceManager.bytes_in_buffer-=2*sizeof(Misc::UInt32);
 		sourceManager.next_input_byte+=2*sizeof(Misc::UInt32);
@@ -184,7 +184,7 @@ void* KinectV2JpegStreamReader::decompressionThreadMethod(void)
 		
 		/* Create a frame buffer to hold the decompressed image: */
 		Size frameSize(decompressor.output_width,decompressor.output_height);
-		FrameBuffer decompressedFrame(frameSize,frameSize.volume()*sizeof(FrameSource::ColorPixel));
+		FrameBuffer decompressedFrame(frameSize,frameSize.volume()*sizeof(FrameSource::ColorPixel),MemoryAccounting::CAMERA);
 		
 		/*************************************************************
 		This is where we would synchronize clocks to account for
@@ -225,6 +225,9 @@ void* KinectV2JpegStreamReader::decompressionThreadMethod(void)
 		
 		if(!error)
 			{
+			/* Assign the camera's frame number, which flags the image if any previous images were lost or failed to decompress: */
+			decompressedFrame.metadata.setFrameNumber(frameNumber,lastFrameNumber,haveLastFrameNumber);
+			
 			/* Call the callback: */
 			(*imageReadyCallback)(decompressedFrame);
 			}
@@ -237,6 +240,7 @@ KinectV2JpegStreamReader::KinectV2JpegStreamReader(CameraV2& sCamera)
 	:camera(sCamera),forceRgb(false),
 	 transferPool(0),currentTransfer(0),
 	 imageHeight(0),imageRowPointers(0),
+	 lastFrameNumber(0),haveLastFrameNumber(false),
 	 imageReadyCallback(0)
 	{
 	/* Initialize the JPEG error manager: */
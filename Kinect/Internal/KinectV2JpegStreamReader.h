@@ -27,6 +27,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <stddef.h>
 #include <stdio.h>
 #include <jpeglib.h>
+#include <Misc/SizedTypes.h>
 #include <Threads/Thread.h>
 #include <Threads/MutexCond.h>
 #include <USB/TransferPool.h>
@@ -66,6 +67,8 @@ class KinectV2JpegStreamReader
 	FrameSource::ColorPixel** imageRowPointers; // Array of pointers to image rows to flip image during decompression
 	size_t frameSize; // Total compressed image size for the current image
 	bool error; // Flag to remember errors while decompressing the current image
+	Misc::UInt32 lastFrameNumber; // Camera-assigned number of the most recently delivered image, to detect lost images
+	bool haveLastFrameNumber; // Flag whether an image has been delivered since streaming started
 	ImageReadyCallback* imageReadyCallback; // Function called whenever a new image has been decompressed
 	
 	/* Private methods: */
@@ -0,0 +1,268 @@
+/***********************************************************************
+KinectV1DepthFrameReader - Class to read depth frames from a source that
+were compressed in the RLE/differential format produced natively by
+first-generation Kinect cameras.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/KinectV1DepthFrameReader.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Math/Constants.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int getNybble(const Misc::UInt8*& sPtr,const Misc::UInt8* sEnd,bool& sFull)
+	{
+	/* Return zero if the data is exhausted: */
+	if(sPtr==sEnd)
+		return 0x0U;
+	
+	unsigned int result;
+	if(sFull)
+		{
+		/* Return the high nybble: */
+		result=(*sPtr>>4)&0x0fU;
+		
+		/* Mark the high nybble read: */
+		sFull=false;
+		}
+	else
+		{
+		/* Return the low nybble: */
+		result=(*sPtr)&0x0fU;
+		
+		/* Go to the next source byte and mark the high nybble unread: */
+		++sPtr;
+		sFull=true;
+		}
+	
+	return result;
+	}
+
+}
+
+/*****************************************
+Methods of class KinectV1DepthFrameReader:
+*****************************************/
+
+KinectV1DepthFrameReader::KinectV1DepthFrameReader(IO::File& sSource)
+	:source(sSource)
+	{
+	/* Read the frame size from the source: */
+	for(int i=0;i<2;++i)
+		size[i]=source.read<Misc::UInt32>();
+	
+	/* Read and check the stream format version: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>KinectV1DepthFrameWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported Kinect v1 depth stream format version %u",formatVersion);
+	}
+
+KinectV1DepthFrameReader::~KinectV1DepthFrameReader(void)
+	{
+	}
+
+FrameBuffer KinectV1DepthFrameReader::readNextFrame(void)
+	{
+	/* Create the result frame: */
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),memoryTag);
+	
+	/* Return a dummy frame if the file is over: */
+	if(source.eof())
+		{
+		result.timeStamp=Math::Constants<double>::max;
+		return result;
+		}
+	
+	/* Read the frame's time stamp, metadata, and encoded data from the source: */
+	readFrameHeader(source,result);
+	size_t codeSize=source.read<Misc::UInt32>();
+	codeBuffer.resize(codeSize);
+	if(codeSize>0)
+		source.read(&codeBuffer[0],codeSize);
+	
+	/* Decode the frame; frames truncated in transfer from the camera are padded with invalid pixels, exactly as the camera would do: */
+	FrameSource::DepthPixel* frame=result.getData<FrameSource::DepthPixel>();
+	decodeFrame(codeSize>0?&codeBuffer[0]:0,codeSize,size,frame);
+	
+	if(formatVersion>=2)
+		{
+		/* Read the frame's removal mask: */
+		size_t maskSize=source.read<Misc::UInt32>();
+		maskBuffer.resize(maskSize);
+		if(maskSize>0)
+			source.read(&maskBuffer[0],maskSize);
+		
+		/* Invalidate pixels that were removed after the frame was decoded, alternating between runs of kept and removed pixels: */
+		const Misc::UInt8* mPtr=maskSize>0?&maskBuffer[0]:0;
+		const Misc::UInt8* mEnd=mPtr+maskSize;
+		FrameSource::DepthPixel* fPtr=frame;
+		FrameSource::DepthPixel* fEnd=frame+size.volume();
+		bool removed=false;
+		while(mPtr!=mEnd)
+			{
+			/* Read the next run length: */
+			size_t runLength=0;
+			for(unsigned int shift=0;;shift+=7)
+				{
+				if(mPtr==mEnd||shift>28)
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Corrupted removal mask");
+				unsigned int group=*(mPtr++);
+				runLength|=size_t(group&0x7fU)<<shift;
+				if((group&0x80U)==0x0U)
+					break;
+				}
+			if(runLength>size_t(fEnd-fPtr))
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Corrupted removal mask");
+			
+			/* Skip kept pixels or invalidate removed pixels: */
+			if(removed)
+				{
+				for(size_t i=0;i<runLength;++i,++fPtr)
+					*fPtr=FrameSource::invalidDepth;
+				}
+			else
+				fPtr+=runLength;
+			removed=!removed;
+			}
+		}
+	
+	return result;
+	}
+
+double KinectV1DepthFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* All frames are compressed independently: */
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata and skip the encoded frame and its removal mask: */
+	double result=skipFrameHeader(source);
+	size_t codeSize=source.read<Misc::UInt32>();
+	source.skip<Misc::UInt8>(codeSize);
+	if(formatVersion>=2)
+		{
+		size_t maskSize=source.read<Misc::UInt32>();
+		source.skip<Misc::UInt8>(maskSize);
+		}
+	
+	return result;
+	}
+
+size_t KinectV1DepthFrameReader::decodeFrame(const Misc::UInt8* data,size_t dataSize,const Size& frameSize,Misc::UInt16* frame)
+	{
+	const Misc::UInt8* sPtr=data;
+	const Misc::UInt8* sEnd=data+dataSize;
+	bool sFull=true;
+	unsigned int width=frameSize[0];
+	unsigned int height=frameSize[1];
+	FrameSource::DepthPixel* dRowPtr=frame+size_t(width)*(height-1);
+	
+	/* Process rows: */
+	bool overrun=false;
+	for(unsigned int y=0;y<height;++y,dRowPtr-=width) // Flip the depth image vertically
+		{
+		FrameSource::DepthPixel* dPtr=dRowPtr;
+		FrameSource::DepthPixel* dEnd=dPtr+width;
+		
+		/* Process RLE/differential code groups from the raw depth stream: */
+		unsigned int lastPixel=FrameSource::invalidDepth;
+		while(dPtr!=dEnd)
+			{
+			/* Fill the rest of the frame with invalid pixels if the data ended prematurely: */
+			if(sPtr==sEnd||overrun)
+				{
+				overrun=true;
+				for(;dPtr!=dEnd;++dPtr)
+					*dPtr=FrameSource::invalidDepth;
+				break;
+				}
+			
+			/* Parse the next code group: */
+			unsigned int code=getNybble(sPtr,sEnd,sFull);
+			if(code==0x0fU) // It's either a literal depth value or a large-step differential
+				{
+				unsigned int value=getNybble(sPtr,sEnd,sFull);
+				if(value<0x08U) // It's a literal depth value
+					{
+					/* Read the rest of the literal depth value: */
+					for(int i=0;i<3;++i)
+						value=(value<<4)|getNybble(sPtr,sEnd,sFull);
+					
+					/* Store the depth value: */
+					lastPixel=value;
+					*dPtr=FrameSource::DepthPixel(lastPixel);
+					++dPtr;
+					}
+				else // It's a large-step differential
+					{
+					/* Read the rest of the differential: */
+					value=(value<<4)|getNybble(sPtr,sEnd,sFull);
+					
+					/* Calculate and store the depth value: */
+					lastPixel=(lastPixel+value)-0xc0U;
+					*dPtr=FrameSource::DepthPixel(lastPixel);
+					++dPtr;
+					}
+				}
+			else if(code==0x0eU) // It's an RLE span
+				{
+				/* Read the repetition count: */
+				unsigned int numReps=getNybble(sPtr,sEnd,sFull)+1;
+				
+				/* Copy the last pixel value: */
+				while(numReps>0&&dPtr!=dEnd)
+					{
+					*dPtr=FrameSource::DepthPixel(lastPixel);
+					++dPtr;
+					--numReps;
+					}
+				}
+			else // It's a small-step differential
+				{
+				/* Calculate and store the depth value: */
+				lastPixel=(lastPixel+code)-0x06U;
+				*dPtr=FrameSource::DepthPixel(lastPixel);
+				++dPtr;
+				}
+			}
+		}
+	
+	/* Return the number of consumed bytes, including a partially consumed last byte: */
+	if(overrun)
+		return 0;
+	return size_t(sPtr-data)+(sFull?0:1);
+	}
+
+}
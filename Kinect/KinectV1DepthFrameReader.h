@@ -0,0 +1,64 @@
+/***********************************************************************
+KinectV1DepthFrameReader - Class to read depth frames from a source that
+were compressed in the RLE/differential format produced natively by
+first-generation Kinect cameras.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_KINECTV1DEPTHFRAMEREADER_INCLUDED
+#define KINECT_KINECTV1DEPTHFRAMEREADER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/FrameReader.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class KinectV1DepthFrameReader:public FrameReader
+	{
+	/* Elements: */
+	private:
+	IO::File& source; // Data source for compressed depth frames
+	unsigned int formatVersion; // Version number of the source's Kinect v1 depth stream format
+	std::vector<Misc::UInt8> codeBuffer; // Buffer holding the current encoded frame
+	std::vector<Misc::UInt8> maskBuffer; // Buffer holding the current frame's encoded removal mask
+	
+	/* Constructors and destructors: */
+	public:
+	KinectV1DepthFrameReader(IO::File& sSource); // Creates a depth frame reader associated with the given data source
+	virtual ~KinectV1DepthFrameReader(void);
+	
+	/* Methods from FrameReader: */
+	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
+	
+	/* New methods: */
+	static size_t decodeFrame(const Misc::UInt8* data,size_t dataSize,const Size& frameSize,Misc::UInt16* frame); // Decodes a frame of the given size from the given compressed data into the given pixel buffer, flipping it vertically; fills pixels with invalid depth if the data ended prematurely; returns the number of consumed bytes, or zero if the data ended prematurely
+	};
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+/***********************************************************************
+KinectV1DepthFrameWriter - Class to write depth frames to a sink in the
+RLE/differential-compressed format produced natively by first-generation
+Kinect cameras, either by encoding depth frames or by passing frames
+received from a camera through without re-encoding them.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/KinectV1DepthFrameWriter.h>
+
+#include <IO/File.h>
+#include <Kinect/FrameSource.h>
+
+namespace Kinect {
+
+namespace {
+
+/***************
+Helper classes:
+***************/
+
+class NybbleWriter // Helper class to append nybbles to a byte buffer, high nybble first
+	{
+	/* Elements: */
+	private:
+	Misc::UInt8* dPtr; // Current write position
+	bool dFull; // Flag whether the byte at the current write position has its high nybble set
+	
+	/* Constructors and destructors: */
+	public:
+	NybbleWriter(Misc::UInt8* sDPtr)
+		:dPtr(sDPtr),dFull(false)
+		{
+		}
+	
+	/* Methods: */
+	void put(unsigned int nybble)
+		{
+		if(dFull)
+			{
+			/* Set the low nybble and go to the next byte: */
+			*dPtr|=Misc::UInt8(nybble);
+			++dPtr;
+			dFull=false;
+			}
+		else
+			{
+			/* Set the high nybble: */
+			*dPtr=Misc::UInt8(nybble<<4);
+			dFull=true;
+			}
+		}
+	Misc::UInt8* finish(void) // Pads the last byte with a zero nybble and returns the end of the written data
+		{
+		if(dFull)
+			{
+			++dPtr;
+			dFull=false;
+			}
+		return dPtr;
+		}
+	};
+
+inline unsigned int clampDepth(FrameSource::DepthPixel pixel) // Maps depth values that cannot be represented as literals to invalid depth
+	{
+	return pixel<0x8000U?pixel:FrameSource::invalidDepth;
+	}
+
+inline Misc::UInt8* putRunLength(Misc::UInt8* dPtr,unsigned int runLength) // Appends a run length in groups of seven bits, lowest group first, and returns the end of the written data
+	{
+	while(runLength>=0x80U)
+		{
+		*(dPtr++)=Misc::UInt8((runLength&0x7fU)|0x80U);
+		runLength>>=7;
+		}
+	*(dPtr++)=Misc::UInt8(runLength);
+	return dPtr;
+	}
+
+}
+
+/*****************************************
+Methods of class KinectV1DepthFrameWriter:
+*****************************************/
+
+KinectV1DepthFrameWriter::KinectV1DepthFrameWriter(IO::File& sSink,const Size& sSize)
+	:FrameWriter(sSize),
+	 sink(sSink)
+	{
+	/* Write the frame size and stream format version to the sink: */
+	for(int i=0;i<2;++i)
+		sink.write<Misc::UInt32>(size[i]);
+	Misc::UInt32 fv=formatVersion;
+	sink.write<Misc::UInt32>(fv);
+	
+	/* Allocate a code buffer for the worst case of five nybbles per pixel: */
+	codeBuffer.resize((size_t(size.volume())*5+1)/2);
+	
+	/* Allocate a mask buffer for the worst case of alternating single-pixel runs, plus empty first and last runs: */
+	maskBuffer.resize(size_t(size.volume())+2);
+	}
+
+KinectV1DepthFrameWriter::~KinectV1DepthFrameWriter(void)
+	{
+	}
+
+size_t KinectV1DepthFrameWriter::writeFrame(const FrameBuffer& frame)
+	{
+	/*********************************************************************
+	Encode the frame exactly as a first-generation Kinect camera would:
+	rows are stored bottom-up, and each row starts from an invalid depth
+	value. Code groups are small differentials in a single nybble, runs
+	of repeated pixels, large differentials, or literal depth values.
+	*********************************************************************/
+	
+	NybbleWriter writer(&codeBuffer[0]);
+	unsigned int width=size[0];
+	unsigned int height=size[1];
+	const FrameSource::DepthPixel* rowPtr=frame.getData<FrameSource::DepthPixel>()+size_t(width)*(height-1);
+	for(unsigned int y=0;y<height;++y,rowPtr-=width)
+		{
+		unsigned int lastPixel=FrameSource::invalidDepth;
+		unsigned int x=0;
+		while(x<width)
+			{
+			unsigned int pixel=clampDepth(rowPtr[x]);
+			if(pixel==lastPixel)
+				{
+				/* Find the length of the run of repeated pixels: */
+				unsigned int runLength=1;
+				while(x+runLength<width&&clampDepth(rowPtr[x+runLength])==lastPixel)
+					++runLength;
+				x+=runLength;
+				
+				/* Write the run as RLE spans of at most 16 pixels, and a single zero differential if one pixel is left over: */
+				while(runLength>=2)
+					{
+					unsigned int spanLength=runLength<16?runLength:16;
+					writer.put(0x0eU);
+					writer.put(spanLength-1);
+					runLength-=spanLength;
+					}
+				if(runLength==1)
+					writer.put(0x06U);
+				}
+			else
+				{
+				int delta=int(pixel)-int(lastPixel);
+				if(delta>=-6&&delta<=7)
+					{
+					/* Write a small-step differential: */
+					writer.put((unsigned int)(delta+6));
+					}
+				else if(delta>=-64&&delta<=63)
+					{
+					/* Write a large-step differential: */
+					unsigned int value=(unsigned int)(delta+0xc0);
+					writer.put(0x0fU);
+					writer.put(value>>4);
+					writer.put(value&0x0fU);
+					}
+				else
+					{
+					/* Write a literal depth value: */
+					writer.put(0x0fU);
+					for(int shift=12;shift>=0;shift-=4)
+						writer.put((pixel>>shift)&0x0fU);
+					}
+				lastPixel=pixel;
+				++x;
+				}
+			}
+		}
+	size_t codeSize=writer.finish()-&codeBuffer[0];
+	
+	/* Write the frame's time stamp and encoded data, and an empty removal mask: */
+	size_t result=writeFrameHeader(sink,frame);
+	sink.write<Misc::UInt32>(Misc::UInt32(codeSize));
+	sink.write(&codeBuffer[0],codeSize);
+	sink.write<Misc::UInt32>(0);
+	
+	return result+sizeof(Misc::UInt32)*2+codeSize;
+	}
+
+size_t KinectV1DepthFrameWriter::writeRawFrame(const KinectV1RawDepthFrame& rawFrame)
+	{
+	/* Write the frame's time stamp and the camera's compressed data as-is, and an empty removal mask: */
+	size_t result=writeFrameHeader(sink,rawFrame.data);
+	sink.write<Misc::UInt32>(Misc::UInt32(rawFrame.dataSize));
+	sink.write(rawFrame.data.getData<Misc::UInt8>(),rawFrame.dataSize);
+	sink.write<Misc::UInt32>(0);
+	
+	return result+sizeof(Misc::UInt32)*2+rawFrame.dataSize;
+	}
+
+size_t KinectV1DepthFrameWriter::writeRawFrame(const KinectV1RawDepthFrame& rawFrame,const FrameBuffer& frame)
+	{
+	/* Write the compressed frame with an empty removal mask if no pixels were removed after decoding: */
+	if(!rawFrame.removedPixels)
+		return writeRawFrame(rawFrame);
+	
+	/*********************************************************************
+	Encode the removal mask as alternating run lengths of kept and invalid
+	pixels in the decoded frame's pixel order, starting with kept pixels.
+	Pixels that were already invalid in the compressed frame are included,
+	which keeps the runs long and the mask small.
+	*********************************************************************/
+	
+	Misc::UInt8* maskPtr=&maskBuffer[0];
+	const FrameSource::DepthPixel* fPtr=frame.getData<FrameSource::DepthPixel>();
+	const FrameSource::DepthPixel* fEnd=fPtr+size.volume();
+	while(fPtr!=fEnd)
+		{
+		/* Find the next run of kept pixels: */
+		const FrameSource::DepthPixel* runStart=fPtr;
+		while(fPtr!=fEnd&&*fPtr<FrameSource::invalidDepth)
+			++fPtr;
+		maskPtr=putRunLength(maskPtr,(unsigned int)(fPtr-runStart));
+		
+		/* Find the next run of invalid pixels: */
+		runStart=fPtr;
+		while(fPtr!=fEnd&&*fPtr>=FrameSource::invalidDepth)
+			++fPtr;
+		maskPtr=putRunLength(maskPtr,(unsigned int)(fPtr-runStart));
+		}
+	size_t maskSize=maskPtr-&maskBuffer[0];
+	
+	/* Write the frame's time stamp, the camera's compressed data as-is, and the removal mask: */
+	size_t result=writeFrameHeader(sink,rawFrame.data);
+	sink.write<Misc::UInt32>(Misc::UInt32(rawFrame.dataSize));
+	sink.write(rawFrame.data.getData<Misc::UInt8>(),rawFrame.dataSize);
+	sink.write<Misc::UInt32>(Misc::UInt32(maskSize));
+	sink.write(&maskBuffer[0],maskSize);
+	
+	return result+sizeof(Misc::UInt32)*2+rawFrame.dataSize+maskSize;
+	}
+
+}
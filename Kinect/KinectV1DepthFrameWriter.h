@@ -0,0 +1,84 @@
+/***********************************************************************
+KinectV1DepthFrameWriter - Class to write depth frames to a sink in the
+RLE/differential-compressed format produced natively by first-generation
+Kinect cameras, either by encoding depth frames or by passing frames
+received from a camera through without re-encoding them.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_KINECTV1DEPTHFRAMEWRITER_INCLUDED
+#define KINECT_KINECTV1DEPTHFRAMEWRITER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameWriter.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+struct KinectV1RawDepthFrame // Structure holding a depth frame in a first-generation Kinect camera's native compressed format
+	{
+	/* Elements: */
+	public:
+	FrameBuffer data; // Buffer holding the compressed frame data, with the decoded frame's size and time stamp
+	size_t dataSize; // Size of the compressed frame data in bytes
+	bool removedPixels; // Flag whether background or floor removal invalidated pixels in the decoded version of the frame
+	
+	/* Constructors and destructors: */
+	KinectV1RawDepthFrame(void)
+		:dataSize(0),removedPixels(false)
+		{
+		}
+	};
+
+class KinectV1DepthFrameWriter:public FrameWriter
+	{
+	/* Embedded classes: */
+	public:
+	static const Misc::UInt32 formatVersion=2; // Version number of the Kinect v1 depth stream format
+	
+	/* Elements: */
+	private:
+	IO::File& sink; // Data sink for the compressed depth frame stream
+	std::vector<Misc::UInt8> codeBuffer; // Buffer receiving the encoded frame
+	std::vector<Misc::UInt8> maskBuffer; // Buffer receiving the encoded removal mask of a compressed frame
+	
+	/* Constructors and destructors: */
+	public:
+	KinectV1DepthFrameWriter(IO::File& sSink,const Size& sSize); // Creates a depth frame writer for the given sink and frame size
+	virtual ~KinectV1DepthFrameWriter(void);
+	
+	/* Methods from FrameWriter: */
+	virtual size_t writeFrame(const FrameBuffer& frame); // Encodes and writes the given depth frame; depth values of 32768 and above are written as invalid
+	
+	/* New methods: */
+	size_t writeRawFrame(const KinectV1RawDepthFrame& rawFrame); // Writes a frame received from a first-generation Kinect camera without re-encoding it; returns size of written data in bytes
+	size_t writeRawFrame(const KinectV1RawDepthFrame& rawFrame,const FrameBuffer& frame); // Ditto, and marks the pixels that are invalid in the given decoded and processed version of the frame as removed
+	};
+
+}
+
+#endif
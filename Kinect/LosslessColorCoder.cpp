@@ -0,0 +1,318 @@
+/***********************************************************************
+LosslessColorCoder - Class to compress and decompress color frames
+losslessly using a reversible color transform, gradient-adjusted
+prediction, and an interleaved rANS entropy coder, processing
+horizontal frame tiles in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/LosslessColorCoder.h>
+
+#include <Misc/StdError.h>
+#include <Misc/FunctionCalls.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const int channelOrders[2][3]={{0,1,2},{1,0,2}}; // Order in which color channels are coded, without and with green subtraction
+
+inline int predict(const int* cur,const int* prev,unsigned int x,bool firstRow) // Predicts a transformed color value from its left, upper, and upper-left neighbors
+	{
+	if(firstRow)
+		return x>0?cur[-3]:0;
+	if(x==0)
+		return prev[0];
+	
+	/* Use the median edge detector: */
+	int a=cur[-3];
+	int b=prev[0];
+	int c=prev[-3];
+	if(c>=(a>b?a:b))
+		return a<b?a:b;
+	else if(c<=(a<b?a:b))
+		return a>b?a:b;
+	else
+		return a+b-c;
+	}
+
+inline int predictBayer(const FrameSource::ColorComponent* pixel,size_t rowStride2,unsigned int x,bool firstRows) // Predicts a Bayer component from its nearest left, upper, and upper-left neighbors of the same color
+	{
+	if(firstRows)
+		return x>=2?int(pixel[-2]):0;
+	if(x<2)
+		return int(pixel[-rowStride2]);
+	
+	/* Use the median edge detector on same-color neighbors two pixels away: */
+	int a=int(pixel[-2]);
+	int b=int(pixel[-rowStride2]);
+	int c=int(pixel[-rowStride2-2]);
+	if(c>=(a>b?a:b))
+		return a<b?a:b;
+	else if(c<=(a<b?a:b))
+		return a>b?a:b;
+	else
+		return a+b-c;
+	}
+
+}
+
+/*****************************************
+Methods of class LosslessColorCoder::Tile:
+*****************************************/
+
+LosslessColorCoder::Tile::Tile(void)
+	:firstRow(0),numRows(0),
+	 tables(3,RansCoder::FrequencyTable(256)),
+	 code(0),codeSize(0)
+	{
+	}
+
+/***********************************
+Methods of class LosslessColorCoder:
+***********************************/
+
+void LosslessColorCoder::encodeTile(LosslessColorCoder::Tile& tile)
+	{
+	const int* channelOrder=channelOrders[subtractGreen?1:0];
+	unsigned int width=size[0];
+	
+	/* Calculate residual symbols for all pixels in the tile: */
+	tile.symbols.resize(size_t(tile.numRows)*size_t(width)*3);
+	Misc::UInt8* sPtr=&tile.symbols[0];
+	tile.rowBuffer.resize(size_t(width)*3*2);
+	int* cur=&tile.rowBuffer[0];
+	int* prev=cur+width*3;
+	const FrameSource::ColorPixel* pPtr=reinterpret_cast<const FrameSource::ColorPixel*>(encodeFrame)+size_t(tile.firstRow)*size_t(width);
+	for(unsigned int y=0;y<tile.numRows;++y)
+		{
+		int* cPtr=cur;
+		int* prPtr=prev;
+		for(unsigned int x=0;x<width;++x,++pPtr)
+			{
+			int base=0;
+			for(int c=0;c<3;++c,++cPtr,++prPtr,++sPtr)
+				{
+				/* Transform the color value and predict it from its neighbors: */
+				int value=int((*pPtr)[channelOrder[c]]);
+				*cPtr=value-base;
+				*sPtr=Misc::UInt8((*cPtr-predict(cPtr,prPtr,x,y==0))&0xff);
+				
+				/* Subtract green from red and blue if requested: */
+				if(c==0&&subtractGreen)
+					base=value;
+				}
+			}
+		
+		/* Swap the row buffers: */
+		int* t=cur;
+		cur=prev;
+		prev=t;
+		}
+	
+	/* Count the residual symbols of each color plane and create the tile's frequency tables: */
+	size_t counts[3][256];
+	for(int c=0;c<3;++c)
+		for(int i=0;i<256;++i)
+			counts[c][i]=0;
+	size_t numSymbols=tile.symbols.size();
+	for(size_t i=0;i<numSymbols;i+=3)
+		for(int c=0;c<3;++c)
+			++counts[c][tile.symbols[i+c]];
+	for(int c=0;c<3;++c)
+		tile.tables[c].setCounts(counts[c]);
+	
+	/* Encode the symbol sequence in reverse order: */
+	tile.codeBuffer.resize(RansCoder::Encoder::getMaxSize(numSymbols));
+	RansCoder::Encoder encoder(&tile.codeBuffer[0]+tile.codeBuffer.size());
+	for(size_t i=numSymbols;i>0;--i)
+		encoder.encode((i-1)&(RansCoder::numStates-1),tile.tables[(i-1)%3].getEncodeSymbol(tile.symbols[i-1]));
+	tile.codeSize=encoder.finish();
+	tile.code=encoder.getData();
+	}
+
+void LosslessColorCoder::decodeTile(LosslessColorCoder::Tile& tile)
+	{
+	const int* channelOrder=channelOrders[subtractGreen?1:0];
+	unsigned int width=size[0];
+	
+	/* Decode all pixels in the tile: */
+	RansCoder::Decoder decoder(tile.code,tile.codeSize);
+	unsigned int stateIndex=0;
+	tile.rowBuffer.resize(size_t(width)*3*2);
+	int* cur=&tile.rowBuffer[0];
+	int* prev=cur+width*3;
+	FrameSource::ColorPixel* pPtr=reinterpret_cast<FrameSource::ColorPixel*>(decodeFrame)+size_t(tile.firstRow)*size_t(width);
+	for(unsigned int y=0;y<tile.numRows;++y)
+		{
+		int* cPtr=cur;
+		int* prPtr=prev;
+		for(unsigned int x=0;x<width;++x,++pPtr)
+			{
+			int base=0;
+			for(int c=0;c<3;++c,++cPtr,++prPtr)
+				{
+				/* Decode the residual and reconstruct the color value: */
+				int residual=int(decoder.decode(stateIndex,tile.tables[c]));
+				stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+				int value=(base+predict(cPtr,prPtr,x,y==0)+residual)&0xff;
+				*cPtr=value-base;
+				(*pPtr)[channelOrder[c]]=FrameSource::ColorComponent(value);
+				
+				/* Add green to red and blue if requested: */
+				if(c==0&&subtractGreen)
+					base=value;
+				}
+			}
+		
+		/* Swap the row buffers: */
+		int* t=cur;
+		cur=prev;
+		prev=t;
+		}
+	}
+
+void LosslessColorCoder::encodeBayerTile(LosslessColorCoder::Tile& tile)
+	{
+	unsigned int width=size[0];
+	size_t rowStride2=size_t(width)*2;
+	
+	/* Calculate residual symbols for all pixels in the tile: */
+	tile.symbols.resize(size_t(tile.numRows)*size_t(width));
+	Misc::UInt8* sPtr=&tile.symbols[0];
+	const FrameSource::ColorComponent* pPtr=encodeFrame+size_t(tile.firstRow)*size_t(width);
+	for(unsigned int y=0;y<tile.numRows;++y)
+		for(unsigned int x=0;x<width;++x,++pPtr,++sPtr)
+			*sPtr=Misc::UInt8((int(*pPtr)-predictBayer(pPtr,rowStride2,x,y<2))&0xff);
+	
+	/* Count the residual symbols of each Bayer pattern phase and create the tile's frequency tables: */
+	size_t counts[4][256];
+	for(int p=0;p<4;++p)
+		for(int i=0;i<256;++i)
+			counts[p][i]=0;
+	sPtr=&tile.symbols[0];
+	for(unsigned int y=0;y<tile.numRows;++y)
+		for(unsigned int x=0;x<width;++x,++sPtr)
+			++counts[((y&0x1U)<<1)|(x&0x1U)][*sPtr];
+	for(int p=0;p<4;++p)
+		tile.tables[p].setCounts(counts[p]);
+	
+	/* Encode the symbol sequence in reverse order: */
+	size_t numSymbols=tile.symbols.size();
+	tile.codeBuffer.resize(RansCoder::Encoder::getMaxSize(numSymbols));
+	RansCoder::Encoder encoder(&tile.codeBuffer[0]+tile.codeBuffer.size());
+	size_t i=numSymbols;
+	for(unsigned int y=tile.numRows;y>0;--y)
+		for(unsigned int x=width;x>0;--x)
+			{
+			--i;
+			encoder.encode(i&(RansCoder::numStates-1),tile.tables[(((y-1)&0x1U)<<1)|((x-1)&0x1U)].getEncodeSymbol(tile.symbols[i]));
+			}
+	tile.codeSize=encoder.finish();
+	tile.code=encoder.getData();
+	}
+
+void LosslessColorCoder::decodeBayerTile(LosslessColorCoder::Tile& tile)
+	{
+	unsigned int width=size[0];
+	size_t rowStride2=size_t(width)*2;
+	
+	/* Decode all pixels in the tile: */
+	RansCoder::Decoder decoder(tile.code,tile.codeSize);
+	unsigned int stateIndex=0;
+	FrameSource::ColorComponent* pPtr=decodeFrame+size_t(tile.firstRow)*size_t(width);
+	for(unsigned int y=0;y<tile.numRows;++y)
+		for(unsigned int x=0;x<width;++x,++pPtr)
+			{
+			/* Decode the residual and reconstruct the component value: */
+			int residual=int(decoder.decode(stateIndex,tile.tables[((y&0x1U)<<1)|(x&0x1U)]));
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			*pPtr=FrameSource::ColorComponent((predictBayer(pPtr,rowStride2,x,y<2)+residual)&0xff);
+			}
+	}
+
+void LosslessColorCoder::processTile(unsigned int tileIndex)
+	{
+	if(bayer)
+		{
+		if(encoding)
+			encodeBayerTile(tiles[tileIndex]);
+		else
+			decodeBayerTile(tiles[tileIndex]);
+		}
+	else if(encoding)
+		encodeTile(tiles[tileIndex]);
+	else
+		decodeTile(tiles[tileIndex]);
+	}
+
+void LosslessColorCoder::runBatch(void)
+	{
+	/* Process all tiles in parallel; the job pool forwards the first tile error: */
+	jobPool.run((unsigned int)(tiles.size()),Misc::VoidMethodCall<unsigned int,LosslessColorCoder>(this,&LosslessColorCoder::processTile));
+	}
+
+LosslessColorCoder::LosslessColorCoder(const Size& sSize,bool sSubtractGreen,bool sBayer,unsigned int tileHeight,unsigned int numThreads)
+	:size(sSize),subtractGreen(sSubtractGreen&&!sBayer),bayer(sBayer),
+	 encoding(true),encodeFrame(0),decodeFrame(0),
+	 jobPool(numThreads)
+	{
+	if(tileHeight==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid tile height");
+	if(bayer&&(tileHeight&0x1U)!=0x0U)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Tile height %u is not even for Bayer frames",tileHeight);
+	
+	/* Split the frame into horizontal tiles: */
+	unsigned int numTiles=(size[1]+tileHeight-1)/tileHeight;
+	tiles.resize(numTiles);
+	for(unsigned int i=0;i<numTiles;++i)
+		{
+		tiles[i].firstRow=i*tileHeight;
+		tiles[i].numRows=size[1]-tiles[i].firstRow<tileHeight?size[1]-tiles[i].firstRow:tileHeight;
+		if(bayer)
+			tiles[i].tables.resize(4,RansCoder::FrequencyTable(256));
+		}
+	}
+
+LosslessColorCoder::~LosslessColorCoder(void)
+	{
+	}
+
+void LosslessColorCoder::encode(const FrameSource::ColorComponent* frame)
+	{
+	encoding=true;
+	encodeFrame=frame;
+	runBatch();
+	encodeFrame=0;
+	}
+
+void LosslessColorCoder::decode(FrameSource::ColorComponent* frame)
+	{
+	encoding=false;
+	decodeFrame=frame;
+	runBatch();
+	decodeFrame=0;
+	}
+
+}
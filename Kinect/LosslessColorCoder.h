@@ -0,0 +1,103 @@
+/***********************************************************************
+LosslessColorCoder - Class to compress and decompress color frames
+losslessly using a reversible color transform, gradient-adjusted
+prediction, and an interleaved rANS entropy coder, processing
+horizontal frame tiles in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_LOSSLESSCOLORCODER_INCLUDED
+#define KINECT_LOSSLESSCOLORCODER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/ParallelJobPool.h>
+
+namespace Kinect {
+
+class LosslessColorCoder
+	{
+	/* Embedded classes: */
+	public:
+	struct Tile // Structure holding the coding state of a horizontal frame tile
+		{
+		/* Elements: */
+		public:
+		unsigned int firstRow; // Index of the tile's first frame row
+		unsigned int numRows; // Number of frame rows in the tile
+		std::vector<RansCoder::FrequencyTable> tables; // Residual frequency tables for the tile's three color planes, or for the four Bayer pattern phases
+		std::vector<Misc::UInt8> symbols; // Buffer of residual symbols
+		std::vector<int> rowBuffer; // Buffer holding transformed color values of the current and previous tile rows
+		std::vector<Misc::UInt8> codeBuffer; // Buffer holding the tile's encoded data
+		const Misc::UInt8* code; // Pointer to the beginning of the tile's encoded data
+		size_t codeSize; // Size of the tile's encoded data
+		
+		/* Constructors and destructors: */
+		Tile(void); // Creates an empty tile
+		};
+	
+	/* Elements: */
+	private:
+	Size size; // Frame size
+	bool subtractGreen; // Flag whether color frames are transformed from RGB into green and green-relative red and blue before prediction
+	bool bayer; // Flag whether frames are raw Bayer color filter arrays with a single color component per pixel
+	std::vector<Tile> tiles; // List of frame tiles
+	bool encoding; // Flag whether the current batch of tiles is being encoded or decoded
+	const FrameSource::ColorComponent* encodeFrame; // Frame currently being encoded
+	FrameSource::ColorComponent* decodeFrame; // Frame currently being decoded
+	ParallelJobPool jobPool; // Pool of threads processing the tiles of the current frame
+	
+	/* Private methods: */
+	void encodeTile(Tile& tile); // Encodes the given tile from the current frame
+	void decodeTile(Tile& tile); // Decodes the given tile into the current frame
+	void encodeBayerTile(Tile& tile); // Encodes the given tile from the current Bayer frame
+	void decodeBayerTile(Tile& tile); // Decodes the given tile into the current Bayer frame
+	void processTile(unsigned int tileIndex); // Encodes or decodes the tile of the given index
+	void runBatch(void); // Processes all tiles of the current frame using all threads; throws exception if any tile fails to decode
+	
+	/* Constructors and destructors: */
+	public:
+	LosslessColorCoder(const Size& sSize,bool sSubtractGreen,bool sBayer,unsigned int tileHeight,unsigned int numThreads); // Creates a coder for frames of the given size and tile height using the given total number of threads; tile height must be even for Bayer frames
+	~LosslessColorCoder(void);
+	
+	/* Methods: */
+	unsigned int getNumTiles(void) const // Returns the number of tiles per frame
+		{
+		return (unsigned int)(tiles.size());
+		}
+	Tile& getTile(unsigned int tileIndex) // Returns the tile of the given index
+		{
+		return tiles[tileIndex];
+		}
+	bool isBayer(void) const // Returns true if the coder processes raw Bayer frames
+		{
+		return bayer;
+		}
+	void encode(const FrameSource::ColorComponent* frame); // Encodes the given frame of RGB pixels or Bayer components into the tiles' frequency tables and encoded data
+	void decode(FrameSource::ColorComponent* frame); // Decodes the given frame from the tiles' frequency tables and encoded data; throws exception on malformed data
+	};
+
+}
+
+#endif
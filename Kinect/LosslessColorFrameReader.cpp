@@ -0,0 +1,164 @@
+/***********************************************************************
+LosslessColorFrameReader - Class to read losslessly compressed color
+frames from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/LosslessColorFrameReader.h>
+
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Math/Constants.h>
+#include <Video/Colorspaces.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/BayerDemosaic.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/LosslessColorCoder.h>
+#include <Kinect/LosslessColorFrameWriter.h>
+
+namespace Kinect {
+
+/*****************************************
+Methods of class LosslessColorFrameReader:
+*****************************************/
+
+LosslessColorFrameReader::LosslessColorFrameReader(IO::File& sSource,unsigned int numThreads)
+	:source(sSource),
+	 formatVersion(0),colorSpace(FrameSource::RGB),
+	 coder(0),
+	 convertToRgb(false)
+	{
+	/* Read the frame size from the source: */
+	for(int i=0;i<2;++i)
+		size[i]=source.read<Misc::UInt32>();
+	
+	/* Read and check the versioned stream header: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>LosslessColorFrameWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported lossless color stream format version %u",formatVersion);
+	unsigned int cs=source.read<Misc::UInt8>();
+	if(cs>FrameSource::BAYER_BGGR)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported color space %u",cs);
+	colorSpace=FrameSource::ColorSpace(cs);
+	bool subtractGreen=source.read<Misc::UInt8>()!=0;
+	unsigned int tileHeight=source.read<Misc::UInt32>();
+	unsigned int numStates=source.read<Misc::UInt8>();
+	unsigned int scaleBits=source.read<Misc::UInt8>();
+	if(numStates!=RansCoder::numStates||scaleBits!=RansCoder::scaleBits)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported rANS coder layout with %u states and %u-bit frequencies",numStates,scaleBits);
+	
+	/* Create the tile coder: */
+	coder=new LosslessColorCoder(size,subtractGreen,colorSpace==FrameSource::BAYER_BGGR,tileHeight,numThreads);
+	}
+
+LosslessColorFrameReader::~LosslessColorFrameReader(void)
+	{
+	delete coder;
+	}
+
+FrameBuffer LosslessColorFrameReader::readNextFrame(void)
+	{
+	/* Create the result frame; Bayer frames have a single component per pixel: */
+	bool bayer=colorSpace==FrameSource::BAYER_BGGR;
+	FrameBuffer result(size,size.volume()*(bayer?sizeof(FrameSource::ColorComponent):sizeof(FrameSource::ColorPixel)),memoryTag);
+	
+	/* Return a dummy frame if the file is over: */
+	if(source.eof())
+		{
+		result.timeStamp=Math::Constants<double>::max;
+		return result;
+		}
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	readFrameHeader(source,result);
+	
+	/* Read all encoded tiles: */
+	for(unsigned int tileIndex=0;tileIndex<coder->getNumTiles();++tileIndex)
+		{
+		LosslessColorCoder::Tile& tile=coder->getTile(tileIndex);
+		for(std::vector<RansCoder::FrequencyTable>::iterator tIt=tile.tables.begin();tIt!=tile.tables.end();++tIt)
+			tIt->read(source);
+		
+		/* Read the tile's code block, which must at least hold the coder's initial states: */
+		tile.codeSize=source.read<Misc::UInt32>();
+		if(tile.codeSize<RansCoder::minCodeSize)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated code block of %u bytes in tile %u",(unsigned int)(tile.codeSize),tileIndex);
+		tile.codeBuffer.resize(tile.codeSize);
+		source.read(&tile.codeBuffer[0],tile.codeSize);
+		tile.code=&tile.codeBuffer[0];
+		}
+	
+	/* Decode all tiles in parallel: */
+	coder->decode(result.getData<FrameSource::ColorComponent>());
+	
+	if(convertToRgb&&bayer)
+		{
+		/* Demosaic the decoded Bayer frame: */
+		return demosaicBayerFrame(result);
+		}
+	else if(convertToRgb&&colorSpace==FrameSource::YPCBCR)
+		{
+		/* Convert the decoded frame from Y'CbCr to RGB: */
+		FrameSource::ColorPixel* resultBuffer=result.getData<FrameSource::ColorPixel>();
+		FrameSource::ColorPixel* resultEnd=resultBuffer+size.volume();
+		for(FrameSource::ColorPixel* rPtr=resultBuffer;rPtr!=resultEnd;++rPtr)
+			{
+			FrameSource::ColorComponent ypcbcr[3];
+			for(int i=0;i<3;++i)
+				ypcbcr[i]=rPtr->components[i];
+			Video::ypcbcrToRgb(ypcbcr,rPtr->components);
+			}
+		}
+	
+	return result;
+	}
+
+double LosslessColorFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* All frames are compressed independently: */
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	double result=skipFrameHeader(source);
+	
+	/* Skip all encoded tiles: */
+	for(unsigned int tileIndex=0;tileIndex<coder->getNumTiles();++tileIndex)
+		{
+		LosslessColorCoder::Tile& tile=coder->getTile(tileIndex);
+		for(std::vector<RansCoder::FrequencyTable>::iterator tIt=tile.tables.begin();tIt!=tile.tables.end();++tIt)
+			tIt->read(source);
+		size_t codeSize=source.read<Misc::UInt32>();
+		source.skip<Misc::UInt8>(codeSize);
+		}
+	
+	return result;
+	}
+
+void LosslessColorFrameReader::setConvertToRgb(bool newConvertToRgb)
+	{
+	convertToRgb=newConvertToRgb;
+	}
+
+}
@@ -0,0 +1,69 @@
+/***********************************************************************
+LosslessColorFrameReader - Class to read losslessly compressed color
+frames from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_LOSSLESSCOLORFRAMEREADER_INCLUDED
+#define KINECT_LOSSLESSCOLORFRAMEREADER_INCLUDED
+
+#include <Kinect/FrameSource.h>
+#include <Kinect/FrameReader.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+namespace Kinect {
+class LosslessColorCoder;
+}
+
+namespace Kinect {
+
+class LosslessColorFrameReader:public FrameReader
+	{
+	/* Elements: */
+	private:
+	IO::File& source; // Data source for compressed color frames
+	unsigned int formatVersion; // Version number of the source's lossless color stream format
+	FrameSource::ColorSpace colorSpace; // Color space of the source's color frames
+	LosslessColorCoder* coder; // Tile-parallel lossless color coder
+	bool convertToRgb; // Flag whether to convert color frames stored in Y'CbCr color space or as raw Bayer patterns to RGB for further processing
+	
+	/* Constructors and destructors: */
+	public:
+	LosslessColorFrameReader(IO::File& sSource,unsigned int numThreads =2); // Creates a lossless color frame reader for the given source, using the given total number of threads
+	virtual ~LosslessColorFrameReader(void);
+	
+	/* Methods from FrameReader: */
+	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
+	
+	/* New methods: */
+	FrameSource::ColorSpace getColorSpace(void) const // Returns the color space of returned frames
+		{
+		return convertToRgb?FrameSource::RGB:colorSpace;
+		}
+	void setConvertToRgb(bool newConvertToRgb); // Sets the RGB color space conversion flag
+	};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+/***********************************************************************
+LosslessColorFrameWriter - Class to write color frames to a sink after
+compressing them losslessly.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/LosslessColorFrameWriter.h>
+
+#include <IO/File.h>
+#include <Kinect/FrameBuffer.h>
+
+namespace Kinect {
+
+/*****************************************
+Methods of class LosslessColorFrameWriter:
+*****************************************/
+
+LosslessColorFrameWriter::LosslessColorFrameWriter(IO::File& sSink,const Size& sSize,FrameSource::ColorSpace sColorSpace,unsigned int numThreads)
+	:FrameWriter(sSize),
+	 sink(sSink),
+	 coder(size,sColorSpace==FrameSource::RGB,sColorSpace==FrameSource::BAYER_BGGR,defaultTileHeight,numThreads)
+	{
+	/* Write the frame size to the sink: */
+	for(int i=0;i<2;++i)
+		sink.write<Misc::UInt32>(size[i]);
+	
+	/* Write the versioned stream header: */
+	Misc::UInt32 fv=formatVersion;
+	sink.write<Misc::UInt32>(fv);
+	sink.write<Misc::UInt8>(Misc::UInt8(sColorSpace));
+	sink.write<Misc::UInt8>(sColorSpace==FrameSource::RGB?1:0);
+	Misc::UInt32 th=defaultTileHeight;
+	sink.write<Misc::UInt32>(th);
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::numStates));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::scaleBits));
+	}
+
+LosslessColorFrameWriter::~LosslessColorFrameWriter(void)
+	{
+	}
+
+size_t LosslessColorFrameWriter::writeFrame(const FrameBuffer& frame)
+	{
+	size_t result=0;
+	
+	/* Write the frame's time stamp to the sink: */
+	result+=writeFrameHeader(sink,frame);
+	
+	/* Encode all tiles of the frame in parallel: */
+	coder.encode(frame.getData<FrameSource::ColorComponent>());
+	
+	/* Write the encoded tiles to the sink in order: */
+	for(unsigned int tileIndex=0;tileIndex<coder.getNumTiles();++tileIndex)
+		{
+		LosslessColorCoder::Tile& tile=coder.getTile(tileIndex);
+		for(std::vector<RansCoder::FrequencyTable>::const_iterator tIt=tile.tables.begin();tIt!=tile.tables.end();++tIt)
+			result+=tIt->write(sink);
+		sink.write<Misc::UInt32>(Misc::UInt32(tile.codeSize));
+		sink.write(tile.code,tile.codeSize);
+		result+=sizeof(Misc::UInt32)+tile.codeSize;
+		}
+	
+	return result;
+	}
+
+}
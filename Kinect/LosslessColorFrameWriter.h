@@ -0,0 +1,63 @@
+/***********************************************************************
+LosslessColorFrameWriter - Class to write color frames to a sink after
+compressing them losslessly.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_LOSSLESSCOLORFRAMEWRITER_INCLUDED
+#define KINECT_LOSSLESSCOLORFRAMEWRITER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/SizedTypes.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FrameWriter.h>
+#include <Kinect/LosslessColorCoder.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class LosslessColorFrameWriter:public FrameWriter
+	{
+	/* Stream format constants shared with LosslessColorFrameReader: */
+	public:
+	static const Misc::UInt32 formatVersion=1; // Version number of the lossless color stream format
+	static const unsigned int defaultTileHeight=64; // Default number of frame rows per tile
+	
+	/* Elements: */
+	private:
+	IO::File& sink; // Data sink for the compressed color frame stream
+	LosslessColorCoder coder; // Tile-parallel lossless color coder
+	
+	/* Constructors and destructors: */
+	public:
+	LosslessColorFrameWriter(IO::File& sSink,const Size& sSize,FrameSource::ColorSpace sColorSpace,unsigned int numThreads =2); // Creates a lossless color frame writer for the given sink, frame size, and color space, using the given total number of threads
+	virtual ~LosslessColorFrameWriter(void);
+	
+	/* Methods from FrameWriter: */
+	virtual size_t writeFrame(const FrameBuffer& frame);
+	};
+
+}
+
+#endif
@@ -32,6 +32,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Video/TheoraFrame.h>
 #include <Video/TheoraInfo.h>
 #include <Video/TheoraComment.h>
+#include <theora/codec.h>
 #include <Video/TheoraPacket.h>
 #endif
 #include <Kinect/FrameBuffer.h>
@@ -93,7 +94,7 @@ LossyDepthFrameReader::~LossyDepthFrameReader(void)
 FrameBuffer LossyDepthFrameReader::readNextFrame(void)
 	{
 	/* Create the result frame: */
-	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel));
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),memoryTag);
 	
 	/* Return a dummy frame if the file is over: */
 	if(source.eof())
@@ -102,8 +103,8 @@ FrameBuffer LossyDepthFrameReader::readNextFrame(void)
 		return result;
 		}
 	
-	/* Read the frame's time stamp from the source: */
-	result.timeStamp=source.read<Misc::Float64>();
+	/* Read the frame's time stamp and metadata from the source: */
+	readFrameHeader(source,result);
 	
 	if(sourceHasTheora)
 		{
@@ -191,4 +192,30 @@ FrameBuffer LossyDepthFrameReader::readNextFrame(void)
 	return result;
 	}
 
+double LossyDepthFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	double result=skipFrameHeader(source);
+	
+	if(sourceHasTheora)
+		{
+		#if VIDEO_CONFIG_HAVE_THEORA
+		
+		/* Read the frame's Theora packet and check whether it starts a new group of pictures: */
+		Video::TheoraPacket packet;
+		packet.read(source);
+		keyFrame=th_packet_iskeyframe(&packet)>0;
+		
+		#endif
+		}
+	
+	return result;
+	}
+
 }
@@ -54,6 +54,7 @@ class LossyDepthFrameReader:public FrameReader
 	
 	/* Methods from FrameReader: */
 	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
 	};
 
 }
@@ -33,6 +33,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Video/OggPage.h>
 #include <Video/TheoraInfo.h>
 #include <Video/TheoraComment.h>
+#include <theora/codec.h>
 #endif
 #include <Kinect/FrameBuffer.h>
 #include <Kinect/FrameSource.h>
@@ -46,6 +47,10 @@ Methods of class LossyDepthFrameWriter:
 LossyDepthFrameWriter::LossyDepthFrameWriter(IO::File& sSink,const Size& sSize)
 	:FrameWriter(sSize),
 	 sink(sSink)
+	 #if VIDEO_CONFIG_HAVE_THEORA
+	 ,
+	 keyFrameRequested(false),keyFrame(true)
+	 #endif
 	{
 	/* Write the frame size to the sink: */
 	for(int i=0;i<2;++i)
@@ -104,8 +109,7 @@ size_t LossyDepthFrameWriter::writeFrame(const FrameBuffer& frame)
 	size_t result=0;
 	
 	/* Write the frame's time stamp to the sink: */
-	sink.write<Misc::Float64>(frame.timeStamp);
-	result+=sizeof(Misc::Float64);
+	result+=writeFrameHeader(sink,frame);
 	
 	#if VIDEO_CONFIG_HAVE_THEORA
 	
@@ -144,13 +148,25 @@ size_t LossyDepthFrameWriter::writeFrame(const FrameBuffer& frame)
 		crRowPtr+=theoraFrame.planes[2].stride;
 		}
 	
-	/* Feed the converted Y'CbCr 4:2:0 frame to the Theora encoder: */
+	/* Feed the converted Y'CbCr 4:2:0 frame to the Theora encoder, temporarily forcing a key frame interval of one frame if a key frame was requested: */
+	if(keyFrameRequested)
+		theoraEncoder.setKeyframeFrequency(1);
 	theoraEncoder.encodeFrame(theoraFrame);
+	if(keyFrameRequested)
+		{
+		theoraEncoder.setKeyframeFrequency(64);
+		keyFrameRequested=false;
+		}
 	
 	/* Write all encoded Theora packets to the sink: */
+	keyFrame=false;
 	Video::TheoraPacket packet;
 	while(theoraEncoder.emitPacket(packet))
 		{
+		/* Check if the packet contains an intra-coded frame: */
+		if(th_packet_iskeyframe(&packet)>0)
+			keyFrame=true;
+		
 		/* Write the packet to the sink: */
 		packet.write(sink);
 		result+=packet.getWireSize();
@@ -161,4 +177,20 @@ size_t LossyDepthFrameWriter::writeFrame(const FrameBuffer& frame)
 	return result;
 	}
 
+bool LossyDepthFrameWriter::wasKeyFrame(void) const
+	{
+	#if VIDEO_CONFIG_HAVE_THEORA
+	return keyFrame;
+	#else
+	return true;
+	#endif
+	}
+
+void LossyDepthFrameWriter::requestKeyFrame(void)
+	{
+	#if VIDEO_CONFIG_HAVE_THEORA
+	keyFrameRequested=true;
+	#endif
+	}
+
 }
@@ -47,7 +47,9 @@ class LossyDepthFrameWriter:public FrameWriter
 	#if VIDEO_CONFIG_HAVE_THEORA
 	Video::TheoraEncoder theoraEncoder; // Theora encoder object
 	Video::TheoraFrame theoraFrame; // Frame buffer for frames in Y'CbCr 4:2:0 pixel format
+	bool keyFrameRequested; // Flag whether the next frame must be intra-coded
 	#endif
+	bool keyFrame; // Flag whether the most recently written frame was an intra-coded Theora frame
 	
 	/* Constructors and destructors: */
 	public:
@@ -56,6 +58,8 @@ class LossyDepthFrameWriter:public FrameWriter
 	
 	/* Methods from FrameWriter: */
 	virtual size_t writeFrame(const FrameBuffer& frame);
+	virtual bool wasKeyFrame(void) const;
+	virtual void requestKeyFrame(void);
 	};
 
 }
@@ -0,0 +1,204 @@
+/***********************************************************************
+MarkerTracker - Class to fuse time-stamped 3D marker detections from
+one or more calibrated cameras into a fixed set of tracked markers, and
+to predict marker positions and velocities using alpha-beta filters.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/MarkerTracker.h>
+
+#include <algorithm>
+#include <Misc/StdError.h>
+#include <Math/Math.h>
+
+namespace Kinect {
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct Assignment // Structure for potential assignments of detections to markers
+	{
+	/* Elements: */
+	public:
+	unsigned int markerIndex; // Index of the marker
+	unsigned int detectionIndex; // Index of the detection
+	MarkerTracker::Scalar dist2; // Squared distance between the marker's predicted position and the detection
+	
+	/* Methods: */
+	bool operator<(const Assignment& other) const
+		{
+		return dist2<other.dist2;
+		}
+	};
+
+}
+
+/*******************************
+Methods of class MarkerTracker:
+*******************************/
+
+MarkerTracker::MarkerTracker(unsigned int sNumMarkers)
+	:markers(sNumMarkers),
+	 alpha(0.6),beta(0.0),
+	 gateRadius(10.0),lostTimeout(0.25),maxPredictionInterval(0.1)
+	{
+	/* Derive the default velocity gain: */
+	setFilterGain(alpha);
+	}
+
+void MarkerTracker::setFilterGains(MarkerTracker::Scalar newAlpha,MarkerTracker::Scalar newBeta)
+	{
+	if(newAlpha<=Scalar(0)||newAlpha>Scalar(1)||newBeta<Scalar(0)||newBeta>Scalar(2))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid filter gains %f, %f",double(newAlpha),double(newBeta));
+	
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	alpha=newAlpha;
+	beta=newBeta;
+	}
+
+void MarkerTracker::setFilterGain(MarkerTracker::Scalar newAlpha)
+	{
+	/* Calculate the velocity gain of a critically damped filter, i.e., of double exponential smoothing: */
+	Scalar theta=Math::sqrt(Scalar(1)-Math::clamp(newAlpha,Scalar(0),Scalar(1)));
+	setFilterGains(newAlpha,Math::sqr(Scalar(1)-theta));
+	}
+
+void MarkerTracker::setGateRadius(MarkerTracker::Scalar newGateRadius)
+	{
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	gateRadius=newGateRadius;
+	}
+
+void MarkerTracker::setLostTimeout(double newLostTimeout)
+	{
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	lostTimeout=newLostTimeout;
+	}
+
+void MarkerTracker::setMaxPredictionInterval(double newMaxPredictionInterval)
+	{
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	maxPredictionInterval=newMaxPredictionInterval;
+	}
+
+void MarkerTracker::addDetections(double timeStamp,const MarkerTracker::PointList& detections)
+	{
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	
+	/* Collect all pairs of tracked markers and detections that are within the gate radius: */
+	Scalar gateRadius2=Math::sqr(gateRadius);
+	std::vector<Assignment> assignments;
+	unsigned int numMarkers=markers.size();
+	unsigned int numDetections=detections.size();
+	for(unsigned int mi=0;mi<numMarkers;++mi)
+		{
+		const Marker& m=markers[mi];
+		if(m.initialized&&timeStamp-m.lastDetectionTime<=lostTimeout)
+			{
+			Point predicted=m.predict(timeStamp);
+			for(unsigned int di=0;di<numDetections;++di)
+				{
+				Scalar dist2=Geometry::sqrDist(predicted,detections[di]);
+				if(dist2<=gateRadius2)
+					{
+					Assignment a;
+					a.markerIndex=mi;
+					a.detectionIndex=di;
+					a.dist2=dist2;
+					assignments.push_back(a);
+					}
+				}
+			}
+		}
+	
+	/* Greedily assign detections to markers in order of increasing distance: */
+	std::sort(assignments.begin(),assignments.end());
+	std::vector<bool> markerAssigned(numMarkers,false);
+	std::vector<bool> detectionAssigned(numDetections,false);
+	for(std::vector<Assignment>::iterator aIt=assignments.begin();aIt!=assignments.end();++aIt)
+		if(!markerAssigned[aIt->markerIndex]&&!detectionAssigned[aIt->detectionIndex])
+			{
+			markerAssigned[aIt->markerIndex]=true;
+			detectionAssigned[aIt->detectionIndex]=true;
+			
+			/* Calculate the detection's residual against the marker's predicted position: */
+			Marker& m=markers[aIt->markerIndex];
+			Point predicted=m.predict(timeStamp);
+			Vector residual=detections[aIt->detectionIndex]-predicted;
+			double dt=timeStamp-m.timeStamp;
+			if(dt>0.0)
+				{
+				/* Advance the filter to the detection's time stamp: */
+				m.position=predicted+residual*alpha;
+				if(dt>=1.0e-3)
+					m.velocity+=residual*(beta/Scalar(dt));
+				m.timeStamp=timeStamp;
+				}
+			else
+				{
+				/* Correct the position of the filter state for an out-of-order detection from another camera: */
+				m.position+=residual*alpha;
+				}
+			if(m.lastDetectionTime<timeStamp)
+				m.lastDetectionTime=timeStamp;
+			}
+	
+	/* Start tracking unassigned detections with untracked or lost markers: */
+	unsigned int mi=0;
+	for(unsigned int di=0;di<numDetections;++di)
+		if(!detectionAssigned[di])
+			{
+			/* Find the next free marker: */
+			while(mi<numMarkers&&markers[mi].initialized&&timeStamp-markers[mi].lastDetectionTime<=lostTimeout)
+				++mi;
+			if(mi>=numMarkers)
+				break;
+			
+			/* Initialize the marker's filter state: */
+			Marker& m=markers[mi];
+			m.initialized=true;
+			m.timeStamp=timeStamp;
+			m.position=detections[di];
+			m.velocity=Vector::zero;
+			m.lastDetectionTime=timeStamp;
+			++mi;
+			}
+	}
+
+MarkerTracker::MarkerState MarkerTracker::getMarkerState(unsigned int markerIndex,double predictionTime) const
+	{
+	Threads::Spinlock::Lock markersLock(markersMutex);
+	
+	const Marker& m=markers[markerIndex];
+	MarkerState result;
+	result.valid=m.initialized&&predictionTime-m.lastDetectionTime<=lostTimeout;
+	
+	/* Extrapolate the marker's position, but not too far: */
+	double dt=Math::clamp(predictionTime-m.timeStamp,-maxPredictionInterval,maxPredictionInterval);
+	result.position=m.position+m.velocity*Scalar(dt);
+	result.velocity=m.velocity;
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,105 @@
+/***********************************************************************
+MarkerTracker - Class to fuse time-stamped 3D marker detections from
+one or more calibrated cameras into a fixed set of tracked markers, and
+to predict marker positions and velocities using alpha-beta filters.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_MARKERTRACKER_INCLUDED
+#define KINECT_MARKERTRACKER_INCLUDED
+
+#include <vector>
+#include <Threads/Spinlock.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+namespace Kinect {
+
+class MarkerTracker
+	{
+	/* Embedded classes: */
+	public:
+	typedef double Scalar; // Scalar type for world space
+	typedef Geometry::Point<Scalar,3> Point; // Type for points in world space
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors in world space
+	typedef std::vector<Point> PointList; // Type for lists of marker detections
+	
+	struct MarkerState // Structure for predicted marker states
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag whether the marker has been detected recently enough to be tracked
+		Point position; // Predicted marker position in world space
+		Vector velocity; // Estimated marker velocity in world space units per second
+		};
+	
+	private:
+	struct Marker // Structure for filter states of tracked markers
+		{
+		/* Elements: */
+		public:
+		bool initialized; // Flag whether the marker has been assigned a detection
+		double timeStamp; // Time stamp of the filter state
+		Point position; // Filtered position at the filter state's time stamp
+		Vector velocity; // Filtered velocity
+		double lastDetectionTime; // Time stamp of the most recent detection assigned to the marker
+		
+		/* Constructors and destructors: */
+		Marker(void)
+			:initialized(false),timeStamp(0.0),position(Point::origin),velocity(Vector::zero),lastDetectionTime(0.0)
+			{
+			}
+		
+		/* Methods: */
+		Point predict(double predictionTime) const // Returns the marker's position extrapolated to the given time stamp
+			{
+			return position+velocity*(predictionTime-timeStamp);
+			}
+		};
+	
+	/* Elements: */
+	mutable Threads::Spinlock markersMutex; // Mutex protecting the marker filter states
+	std::vector<Marker> markers; // Filter states of all tracked markers
+	Scalar alpha,beta; // Position and velocity gains of the alpha-beta filters
+	Scalar gateRadius; // Maximum distance between a marker's predicted position and a detection to assign the detection to the marker
+	double lostTimeout; // Time after the most recent detection after which a marker is considered lost
+	double maxPredictionInterval; // Maximum interval over which marker positions are extrapolated
+	
+	/* Constructors and destructors: */
+	public:
+	MarkerTracker(unsigned int sNumMarkers); // Creates a tracker for the given number of markers
+	
+	/* Methods: */
+	unsigned int getNumMarkers(void) const // Returns the number of tracked markers
+		{
+		return markers.size();
+		}
+	void setFilterGains(Scalar newAlpha,Scalar newBeta); // Sets the position and velocity gains of the alpha-beta filters
+	void setFilterGain(Scalar newAlpha); // Sets the position gain and derives a critically damped velocity gain from it
+	void setGateRadius(Scalar newGateRadius); // Sets the maximum distance between predicted and detected marker positions
+	void setLostTimeout(double newLostTimeout); // Sets the time after which undetected markers are considered lost
+	void setMaxPredictionInterval(double newMaxPredictionInterval); // Sets the maximum extrapolation interval
+	void addDetections(double timeStamp,const PointList& detections); // Updates the marker filters with the given list of world-space marker positions detected in a single camera frame captured at the given time stamp; can be called concurrently for frames from different cameras
+	MarkerState getMarkerState(unsigned int markerIndex,double predictionTime) const; // Returns the state of the given marker predicted for the given time stamp
+	};
+
+}
+
+#endif
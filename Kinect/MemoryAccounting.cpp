@@ -0,0 +1,363 @@
+/***********************************************************************
+MemoryAccounting - Functions to track the number and size of live
+frame and mesh buffers per owner tag, to find out which subsystems hold
+on to how much buffer memory.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/MemoryAccounting.h>
+
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <Misc/StdError.h>
+#include <Threads/Atomic.h>
+#include <Threads/Mutex.h>
+
+namespace Kinect {
+
+namespace MemoryAccounting {
+
+namespace {
+
+/****************
+Static variables:
+****************/
+
+#if KINECT_CONFIG_MEMORY_ACCOUNTING
+
+struct TagCounters // Structure holding the counters of one owner tag
+	{
+	/* Elements: */
+	public:
+	char name[32]; // Tag's name, truncated to fit
+	Threads::Atomic<size_t> liveBuffers;
+	Threads::Atomic<size_t> liveBytes;
+	Threads::Atomic<size_t> peakBytes;
+	Threads::Atomic<size_t> numAllocations;
+	Threads::Atomic<size_t> heldBuffers;
+	Threads::Atomic<size_t> heldBytes;
+	Threads::Atomic<size_t> peakHeldBytes;
+	};
+
+Threads::Mutex registerMutex; // Mutex serializing registration of new owner tags
+Threads::Atomic<unsigned int> numTags(0); // Number of registered owner tags; zero until the library tags have been registered
+TagCounters tagCounters[maxNumTags]; // Counters of all possible owner tags
+
+#endif
+
+const char* libraryTagNames[NUM_LIBRARY_TAGS]=
+	{
+	"Untagged","Camera","FrameReader","FilePlayback","NetworkStream","FrameFilter","Projector","FrameSaver"
+	};
+
+/****************
+Helper functions:
+****************/
+
+#if KINECT_CONFIG_MEMORY_ACCOUNTING
+
+void setName(TagCounters& tc,const char* name)
+	{
+	strncpy(tc.name,name,sizeof(tc.name)-1);
+	tc.name[sizeof(tc.name)-1]='\0';
+	}
+
+void initLibraryTags(void) // Registers the library tags on first use; must be called with the registration mutex locked
+	{
+	if(numTags.get()==0)
+		{
+		for(unsigned int i=0;i<NUM_LIBRARY_TAGS;++i)
+			setName(tagCounters[i],libraryTagNames[i]);
+		numTags.set(NUM_LIBRARY_TAGS);
+		}
+	}
+
+char* appendString(char* bufPtr,char* bufEnd,const char* string) // Appends a string to a text buffer without using any non-async-signal-safe functions
+	{
+	while(*string!='\0'&&bufPtr!=bufEnd)
+		*(bufPtr++)=*(string++);
+	return bufPtr;
+	}
+
+char* appendNumber(char* bufPtr,char* bufEnd,size_t number,int width) // Appends a right-aligned decimal number to a text buffer
+	{
+	/* Convert the number to decimal digits in reverse order: */
+	char digits[24];
+	int numDigits=0;
+	do
+		{
+		digits[numDigits++]=char('0'+number%10);
+		number/=10;
+		}
+	while(number!=0);
+	
+	/* Pad and write the digits: */
+	for(int i=numDigits;i<width&&bufPtr!=bufEnd;++i)
+		*(bufPtr++)=' ';
+	while(numDigits>0&&bufPtr!=bufEnd)
+		*(bufPtr++)=digits[--numDigits];
+	return bufPtr;
+	}
+
+void writeAll(int fd,const char* buffer,size_t size)
+	{
+	while(size>0)
+		{
+		ssize_t written=::write(fd,buffer,size);
+		if(written<=0)
+			break;
+		buffer+=written;
+		size-=size_t(written);
+		}
+	}
+
+#endif
+
+void dumpSignalHandler(int)
+	{
+	dump(STDERR_FILENO);
+	}
+
+}
+
+/**************************
+Namespace-global functions:
+**************************/
+
+bool isEnabled(void)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	return true;
+	#else
+	return false;
+	#endif
+	}
+
+Tag registerTag(const char* name)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	Threads::Mutex::Lock registerLock(registerMutex);
+	initLibraryTags();
+	
+	/* Return an existing tag of the same name: */
+	unsigned int nt=numTags.get();
+	for(unsigned int i=0;i<nt;++i)
+		if(strncmp(tagCounters[i].name,name,sizeof(tagCounters[i].name)-1)==0)
+			return i;
+	
+	/* Account to the untagged bucket if there is no more room: */
+	if(nt>=maxNumTags)
+		return UNTAGGED;
+	
+	/* Name the new tag before publishing it to concurrent readers: */
+	setName(tagCounters[nt],name);
+	numTags.set(nt+1);
+	
+	return nt;
+	#else
+	return UNTAGGED;
+	#endif
+	}
+
+void allocate(Tag tag,size_t bytes)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	if(tag>=maxNumTags)
+		tag=UNTAGGED;
+	TagCounters& tc=tagCounters[tag];
+	tc.liveBuffers.preAdd(1);
+	tc.numAllocations.preAdd(1);
+	size_t live=tc.liveBytes.preAdd(bytes);
+	
+	/* Raise the high-water mark if it was exceeded: */
+	size_t peak=tc.peakBytes.get();
+	while(live>peak&&!tc.peakBytes.ifCompareAndSwap(peak,live))
+		peak=tc.peakBytes.get();
+	#endif
+	}
+
+void release(Tag tag,size_t bytes)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	if(tag>=maxNumTags)
+		tag=UNTAGGED;
+	TagCounters& tc=tagCounters[tag];
+	tc.liveBuffers.preSub(1);
+	tc.liveBytes.preSub(bytes);
+	#endif
+	}
+
+void hold(Tag holder,size_t bytes)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	if(bytes==0)
+		return;
+	if(holder>=maxNumTags)
+		holder=UNTAGGED;
+	TagCounters& tc=tagCounters[holder];
+	tc.heldBuffers.preAdd(1);
+	size_t held=tc.heldBytes.preAdd(bytes);
+	
+	/* Raise the high-water mark if it was exceeded: */
+	size_t peak=tc.peakHeldBytes.get();
+	while(held>peak&&!tc.peakHeldBytes.ifCompareAndSwap(peak,held))
+		peak=tc.peakHeldBytes.get();
+	#endif
+	}
+
+void unhold(Tag holder,size_t bytes)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	if(bytes==0)
+		return;
+	if(holder>=maxNumTags)
+		holder=UNTAGGED;
+	TagCounters& tc=tagCounters[holder];
+	tc.heldBuffers.preSub(1);
+	tc.heldBytes.preSub(bytes);
+	#endif
+	}
+
+unsigned int getNumTags(void)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	unsigned int nt=numTags.get();
+	return nt!=0?nt:(unsigned int)(NUM_LIBRARY_TAGS);
+	#else
+	return NUM_LIBRARY_TAGS;
+	#endif
+	}
+
+TagStats getStats(Tag tag)
+	{
+	if(tag>=getNumTags())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid owner tag %u",tag);
+	
+	TagStats result;
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	const TagCounters& tc=tagCounters[tag];
+	result.name=tag<NUM_LIBRARY_TAGS?libraryTagNames[tag]:tc.name;
+	result.liveBuffers=tc.liveBuffers.get();
+	result.liveBytes=tc.liveBytes.get();
+	result.peakBytes=tc.peakBytes.get();
+	result.numAllocations=tc.numAllocations.get();
+	result.heldBuffers=tc.heldBuffers.get();
+	result.heldBytes=tc.heldBytes.get();
+	result.peakHeldBytes=tc.peakHeldBytes.get();
+	#else
+	result.name=libraryTagNames[tag];
+	result.liveBuffers=0;
+	result.liveBytes=0;
+	result.peakBytes=0;
+	result.numAllocations=0;
+	result.heldBuffers=0;
+	result.heldBytes=0;
+	result.peakHeldBytes=0;
+	#endif
+	
+	return result;
+	}
+
+void getStats(std::vector<TagStats>& stats)
+	{
+	unsigned int nt=getNumTags();
+	stats.clear();
+	stats.reserve(nt);
+	for(unsigned int i=0;i<nt;++i)
+		stats.push_back(getStats(i));
+	}
+
+void resetPeaks(void)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	unsigned int nt=getNumTags();
+	for(unsigned int i=0;i<nt;++i)
+		{
+		tagCounters[i].peakBytes.set(tagCounters[i].liveBytes.get());
+		tagCounters[i].peakHeldBytes.set(tagCounters[i].heldBytes.get());
+		}
+	#endif
+	}
+
+void dump(int fd)
+	{
+	#if KINECT_CONFIG_MEMORY_ACCOUNTING
+	/* Format the statistics into a stack buffer, as nothing in here may allocate memory or take locks: */
+	char buffer[(maxNumTags+2)*160];
+	char* bufEnd=buffer+sizeof(buffer);
+	char* bufPtr=buffer;
+	bufPtr=appendString(bufPtr,bufEnd,"Kinect buffer memory by owner tag:\n  Owner tag                  buffers       live kB       peak kB   allocations  held buffers       held kB  peak held kB\n");
+	size_t totalBuffers=0;
+	size_t totalBytes=0;
+	unsigned int nt=getNumTags();
+	for(unsigned int i=0;i<nt;++i)
+		{
+		const TagCounters& tc=tagCounters[i];
+		size_t liveBuffers=tc.liveBuffers.get();
+		size_t liveBytes=tc.liveBytes.get();
+		
+		/* Write the tag's name left-aligned in a fixed-width column: */
+		const char* name=i<NUM_LIBRARY_TAGS?libraryTagNames[i]:tc.name;
+		char* lineStart=bufPtr;
+		bufPtr=appendString(bufPtr,bufEnd,"  ");
+		bufPtr=appendString(bufPtr,bufEnd,name);
+		while(bufPtr-lineStart<22&&bufPtr!=bufEnd)
+			*(bufPtr++)=' ';
+		
+		bufPtr=appendNumber(bufPtr,bufEnd,liveBuffers,14);
+		bufPtr=appendNumber(bufPtr,bufEnd,(liveBytes+512)/1024,14);
+		bufPtr=appendNumber(bufPtr,bufEnd,(tc.peakBytes.get()+512)/1024,14);
+		bufPtr=appendNumber(bufPtr,bufEnd,tc.numAllocations.get(),14);
+		bufPtr=appendNumber(bufPtr,bufEnd,tc.heldBuffers.get(),14);
+		bufPtr=appendNumber(bufPtr,bufEnd,(tc.heldBytes.get()+512)/1024,14);
+		bufPtr=appendNumber(bufPtr,bufEnd,(tc.peakHeldBytes.get()+512)/1024,14);
+		bufPtr=appendString(bufPtr,bufEnd,"\n");
+		
+		totalBuffers+=liveBuffers;
+		totalBytes+=liveBytes;
+		}
+	bufPtr=appendString(bufPtr,bufEnd,"  Total               ");
+	bufPtr=appendNumber(bufPtr,bufEnd,totalBuffers,14);
+	bufPtr=appendNumber(bufPtr,bufEnd,(totalBytes+512)/1024,14);
+	bufPtr=appendString(bufPtr,bufEnd,"\n");
+	
+	writeAll(fd,buffer,bufPtr-buffer);
+	#else
+	static const char message[]="Kinect buffer memory accounting is disabled\n";
+	ssize_t result=::write(fd,message,sizeof(message)-1);
+	(void)result;
+	#endif
+	}
+
+void installDumpSignalHandler(int signum)
+	{
+	struct sigaction dumpAction;
+	memset(&dumpAction,0,sizeof(struct sigaction));
+	dumpAction.sa_handler=dumpSignalHandler;
+	sigemptyset(&dumpAction.sa_mask);
+	dumpAction.sa_flags=SA_RESTART;
+	if(sigaction(signum,&dumpAction,0)!=0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Cannot install handler for signal %d",signum);
+	}
+
+}
+
+}
@@ -0,0 +1,103 @@
+/***********************************************************************
+MemoryAccounting - Functions to track the number and size of live
+frame and mesh buffers per owner tag, to find out which subsystems hold
+on to how much buffer memory.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_MEMORYACCOUNTING_INCLUDED
+#define KINECT_MEMORYACCOUNTING_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Kinect/Config.h>
+
+namespace Kinect {
+
+namespace MemoryAccounting {
+
+/***********************************************************************
+Buffers are accounted to the owner tag passed to their constructors,
+i.e., to the site that allocated them. Containers that hold on to
+buffers, such as frame queues, additionally account the buffers they
+currently reference to a holder tag, to find out which subsystem keeps
+buffers alive; a buffer referenced by several holders is counted once
+per holder. Accounting is compiled in only if
+KINECT_CONFIG_MEMORY_ACCOUNTING is set; otherwise, tags are accepted
+and ignored, and all statistics are zero.
+***********************************************************************/
+
+typedef unsigned int Tag; // Type for owner tags
+
+enum LibraryTag // Enumerated type for owner tags of buffers allocated by the Kinect library
+	{
+	UNTAGGED=0, // Buffers allocated without an owner tag
+	CAMERA, // Frames captured from cameras or generated by synthetic frame sources
+	FRAME_READER, // Frames decompressed by frame readers without a more specific tag
+	FILE_PLAYBACK, // Frames decompressed by file frame sources
+	NETWORK_STREAM, // Frames decompressed from streams received from remote 3D video servers
+	FRAME_FILTER, // Frames created by depth frame filters and stitchers
+	PROJECTOR, // Depth frames and meshes held by facade projectors
+	FRAME_SAVER, // Holder tag for frames queued for writing by frame savers
+	NUM_LIBRARY_TAGS
+	};
+
+static const unsigned int maxNumTags=32; // Maximum number of library and application owner tags
+
+struct TagStats // Structure holding the buffer statistics of one owner tag
+	{
+	/* Elements: */
+	public:
+	const char* name; // Tag's name
+	size_t liveBuffers; // Number of currently allocated buffers
+	size_t liveBytes; // Total size of currently allocated buffers in bytes
+	size_t peakBytes; // Highest total size of simultaneously allocated buffers in bytes
+	size_t numAllocations; // Total number of buffers allocated since program start
+	size_t heldBuffers; // Number of buffers currently held by the tag's containers
+	size_t heldBytes; // Total size of currently held buffers in bytes
+	size_t peakHeldBytes; // Highest total size of simultaneously held buffers in bytes
+	};
+
+bool isEnabled(void); // Returns true if memory accounting is compiled into the Kinect library
+Tag registerTag(const char* name); // Returns the owner tag of the given name, registering a new tag if there is none; returns UNTAGGED if there are too many tags
+void allocate(Tag tag,size_t bytes); // Accounts a new buffer of the given size to the given tag
+void release(Tag tag,size_t bytes); // Removes a released buffer of the given size from the given tag
+void hold(Tag holder,size_t bytes); // Accounts a buffer of the given size as held by the given holder tag; ignores zero-size or invalid buffers
+void unhold(Tag holder,size_t bytes); // Removes a buffer of the given size that is no longer held from the given holder tag
+unsigned int getNumTags(void); // Returns the number of registered owner tags, including all library tags
+TagStats getStats(Tag tag); // Returns the current statistics of the given owner tag
+void getStats(std::vector<TagStats>& stats); // Returns the current statistics of all registered owner tags
+void resetPeaks(void); // Resets the high-water marks of all owner tags to their current live sizes
+void dump(int fd); // Writes the current statistics of all owner tags to the given file descriptor; async-signal-safe
+void installDumpSignalHandler(int signum); // Dumps statistics to stderr whenever the process receives the given signal
+
+template <class BufferParam>
+inline void assignHeld(Tag holder,BufferParam& slot,const BufferParam& newBuffer) // Assigns a frame or mesh buffer to a container slot held by the given holder tag, moving the holder's accounting from the slot's previous buffer
+	{
+	unhold(holder,slot.getAccountedSize());
+	slot=newBuffer;
+	hold(holder,slot.getAccountedSize());
+	}
+
+}
+
+}
+
+#endif
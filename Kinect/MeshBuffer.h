@@ -28,6 +28,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/Atomic.h>
 #include <GL/gl.h>
 #include <GL/GLVertex.h>
+#include <Kinect/Config.h>
+#include <Kinect/MemoryAccounting.h>
 
 namespace Kinect {
 
@@ -38,6 +40,13 @@ class MeshBuffer
 	typedef GLVertex<void,0,void,0,void,GLfloat,3> Vertex; // Type for vertices
 	typedef GLuint Index; // Type for triangle vertex indices
 	
+	struct PackedNormal // Type for unit-length per-vertex normal vectors in world space, packed for glNormalPointer(GL_BYTE,sizeof(PackedNormal),...)
+		{
+		/* Elements: */
+		public:
+		GLbyte components[4]; // Normal vector components scaled to [-127, 127], followed by a padding byte; all zero for invalid vertices
+		};
+	
 	private:
 	struct BufferHeader
 		{
@@ -48,13 +57,32 @@ class MeshBuffer
 		Vertex* vertices; // Pointer to the vertex array
 		unsigned int maxNumTriangles; // Number of triangles for which the buffer has been allocated
 		Index* triangleIndices; // Pointer to the triangle vertex index array
+		unsigned int maxNumNormals; // Number of normal vectors for which the buffer has been allocated
+		PackedNormal* normals; // Pointer to the per-vertex normal vector array, or null if the buffer has no normal vectors
+		#if KINECT_CONFIG_MEMORY_ACCOUNTING
+		MemoryAccounting::Tag tag; // Owner tag to which the buffer is accounted
+		size_t bufferSize; // Size of the buffer in bytes, including the header
+		#endif
 		
 		/* Constructors and destructors: */
-		BufferHeader(unsigned int sMaxNumVertices,unsigned int sMaxNumTriangles)
+		BufferHeader(unsigned int sMaxNumVertices,unsigned int sMaxNumTriangles,unsigned int sMaxNumNormals,MemoryAccounting::Tag sTag,size_t sBufferSize)
 			:refCount(1),
 			 maxNumVertices(sMaxNumVertices),vertices(reinterpret_cast<Vertex*>(this+1)),
-			 maxNumTriangles(sMaxNumTriangles),triangleIndices(reinterpret_cast<Index*>(vertices+maxNumVertices))
+			 maxNumTriangles(sMaxNumTriangles),triangleIndices(reinterpret_cast<Index*>(vertices+maxNumVertices)),
+			 maxNumNormals(sMaxNumNormals),normals(sMaxNumNormals>0?reinterpret_cast<PackedNormal*>(triangleIndices+maxNumTriangles*3):0)
+			 #if KINECT_CONFIG_MEMORY_ACCOUNTING
+			 ,tag(sTag),bufferSize(sBufferSize)
+			 #endif
 			{
+			#if KINECT_CONFIG_MEMORY_ACCOUNTING
+			MemoryAccounting::allocate(tag,bufferSize);
+			#endif
+			}
+		~BufferHeader(void)
+			{
+			#if KINECT_CONFIG_MEMORY_ACCOUNTING
+			MemoryAccounting::release(tag,bufferSize);
+			#endif
 			}
 		
 		/* Methods: */
@@ -88,17 +116,17 @@ class MeshBuffer
 		 timeStamp(0.0)
 		{
 		}
-	MeshBuffer(unsigned int allocNumVertices,unsigned int allocNumTriangles) // Allocates a new mesh buffer for the given number of vertices and triangles
+	MeshBuffer(unsigned int allocNumVertices,unsigned int allocNumTriangles,unsigned int allocNumNormals =0,MemoryAccounting::Tag tag =MemoryAccounting::UNTAGGED) // Allocates a new mesh buffer for the given number of vertices, triangles, and optional per-vertex normal vectors, accounted to the given owner tag
 		:buffer(0),
 		 numVertices(0),numTriangles(0),
 		 timeStamp(0.0)
 		{
 		/* Calculate the required buffer size: */
-		size_t bufferSize=sizeof(BufferHeader)+allocNumVertices*sizeof(Vertex)+allocNumTriangles*3*sizeof(Index);
+		size_t bufferSize=sizeof(BufferHeader)+allocNumVertices*sizeof(Vertex)+allocNumTriangles*3*sizeof(Index)+allocNumNormals*sizeof(PackedNormal);
 		
 		/* Allocate the mesh buffer including the header: */
 		unsigned char* paddedBuffer=new unsigned char[bufferSize];
-		buffer=new(paddedBuffer) BufferHeader(allocNumVertices,allocNumTriangles);
+		buffer=new(paddedBuffer) BufferHeader(allocNumVertices,allocNumTriangles,allocNumNormals,tag,bufferSize);
 		}
 	MeshBuffer(const MeshBuffer& source) // Copy constructor
 		:buffer(source.buffer),
@@ -152,6 +180,14 @@ class MeshBuffer
 		{
 		return buffer!=0;
 		}
+	size_t getAccountedSize(void) const // Returns the size of the mesh's buffer in bytes as accounted to its owner tag, or zero if the buffer is invalid or memory accounting is disabled
+		{
+		#if KINECT_CONFIG_MEMORY_ACCOUNTING
+		return buffer!=0?buffer->bufferSize:0;
+		#else
+		return 0;
+		#endif
+		}
 	
 	/* Methods that can only be called on valid buffers: */
 	bool isPrivate(void) // Returns true if there is exactly one reference to the buffer
@@ -182,6 +218,22 @@ class MeshBuffer
 		{
 		return buffer->triangleIndices;
 		}
+	bool hasNormals(void) const // Returns true if the buffer has per-vertex normal vectors
+		{
+		return buffer!=0&&buffer->normals!=0;
+		}
+	unsigned int getMaxNumNormals(void) const // Returns the number of normal vectors the buffer can hold
+		{
+		return buffer->maxNumNormals;
+		}
+	const PackedNormal* getNormals(void) const // Returns a pointer to the buffer's per-vertex normal vector array, or null; normal vectors are indexed like depth frame pixels
+		{
+		return buffer->normals;
+		}
+	PackedNormal* getNormals(void) // Ditto
+		{
+		return buffer->normals;
+		}
 	};
 
 }
@@ -29,9 +29,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/FunctionCalls.h>
 #include <Cluster/ClusterPipe.h>
 #include <Geometry/GeometryMarshallers.h>
-#include <Kinect/ColorFrameReader.h>
-#include <Kinect/DepthFrameReader.h>
-#include <Kinect/LossyDepthFrameReader.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
 
 namespace Kinect {
 
@@ -79,8 +79,11 @@ MultiplexedFrameSource::Stream::Stream(MultiplexedFrameSource* sOwner,unsigned i
 		depthCorrection=new DepthCorrection(0,Size(1,1));
 		}
 	
-	/* Check if the depth stream uses lossy compression: */
-	bool depthIsLossy=streamFormatVersions[1]>=3&&source.read<Misc::UInt8>()!=0;
+	/* Read the depth stream's compression codec: */
+	DepthFrameCodec depthCodec=readDepthFrameCodec(source,streamFormatVersions[1]);
+	
+	/* Read the color stream's compression codec: */
+	ColorFrameCodec colorCodec=readColorFrameCodec(source,streamFormatVersions[0]);
 	
 	/* Read the color camera's lens distortion correction parameters if the file stream has it: */
 	if(streamFormatVersions[0]>=2)
@@ -101,20 +104,15 @@ MultiplexedFrameSource::Stream::Stream(MultiplexedFrameSource* sOwner,unsigned i
 	eps=Misc::Marshaller<ExtrinsicParameters>::read(source);
 	
 	/* Create the frame readers: */
-	owner->colorFrameReaders[index]=new ColorFrameReader(source);
-	if(depthIsLossy)
-		{
-		#if VIDEO_CONFIG_HAVE_THEORA
-		owner->depthFrameReaders[index]=new LossyDepthFrameReader(source);
-		#else
-		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Lossy depth compression not supported due to lack of Theora library");
-		#endif
-		}
-	else
-		owner->depthFrameReaders[index]=new DepthFrameReader(source);
+	owner->colorFrameReaders[index]=createColorFrameReader(colorCodec,source);
+	owner->depthFrameReaders[index]=createDepthFrameReader(depthCodec,source);
+	owner->colorFrameReaders[index]->setMemoryTag(MemoryAccounting::NETWORK_STREAM);
+	owner->depthFrameReaders[index]->setMemoryTag(MemoryAccounting::NETWORK_STREAM);
+	owner->depthFrameReaders[index]->setReadMetadata(hasDepthFrameMetadata(streamFormatVersions[1]));
 	
-	/* Set the color space to Y'CbCr: */
-	colorSpace=YPCBCR;
+	/* Set the color space to the color reader's color space, and keep it for later codec changes: */
+	colorSpace=Kinect::getColorSpace(*owner->colorFrameReaders[index]);
+	owner->colorSpaces[index]=colorSpace;
 	}
 
 MultiplexedFrameSource::Stream::~Stream(void)
@@ -202,6 +200,55 @@ void MultiplexedFrameSource::Stream::stopStreaming(void)
 Methods of class MultiplexedFrameSource:
 ***************************************/
 
+void MultiplexedFrameSource::readStreamHeaders(unsigned int frameId)
+	{
+	unsigned int streamIndex=frameId>>1;
+	
+	/* Read the stream's new format version: */
+	unsigned int formatVersion=pipe->read<Misc::UInt32>();
+	
+	if(frameId&0x1U)
+		{
+		/* Read the new depth codec and create a new depth frame reader: */
+		DepthFrameCodec depthCodec=readDepthFrameCodec(*pipe,formatVersion);
+		FrameReader* newReader=createDepthFrameReader(depthCodec,*pipe);
+		if(newReader->getSize()!=depthFrameReaders[streamIndex]->getSize())
+			{
+			delete newReader;
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size of stream %u changed",streamIndex);
+			}
+		newReader->setMemoryTag(MemoryAccounting::NETWORK_STREAM);
+		newReader->setReadMetadata(hasDepthFrameMetadata(formatVersion));
+		
+		/* Replace the old depth frame reader: */
+		delete depthFrameReaders[streamIndex];
+		depthFrameReaders[streamIndex]=newReader;
+		}
+	else
+		{
+		/* Read the new color codec and create a new color frame reader: */
+		ColorFrameCodec colorCodec=readColorFrameCodec(*pipe,formatVersion);
+		FrameReader* newReader=createColorFrameReader(colorCodec,*pipe);
+		if(newReader->getSize()!=colorFrameReaders[streamIndex]->getSize())
+			{
+			delete newReader;
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Color frame size of stream %u changed",streamIndex);
+			}
+		newReader->setMemoryTag(MemoryAccounting::NETWORK_STREAM);
+		
+		/* Convert frames through RGB if the new codec's native color space differs from the stream's announced color space, and replace the old color frame reader: */
+		if(getColorSpace(*newReader)!=colorSpaces[streamIndex])
+			setConvertToRgb(*newReader,true);
+		delete colorFrameReaders[streamIndex];
+		colorFrameReaders[streamIndex]=newReader;
+		}
+	
+	/* Store the new format version with the stream if it still exists: */
+	Threads::Mutex::Lock streamLock(streamMutex);
+	if(streams[streamIndex]!=0)
+		streams[streamIndex]->streamFormatVersions[frameId&0x1U]=formatVersion;
+	}
+
 void* MultiplexedFrameSource::receivingThreadMethod(void)
 	{
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
@@ -235,10 +282,10 @@ void* MultiplexedFrameSource::receivingThreadMethod(void)
 							Threads::Spinlock::Lock streamingLock(streams[i]->streamingMutex);
 							if(streams[i]->streaming)
 								{
-								/* Push the streamer's frames: */
-								if(streams[i]->colorStreamingCallback!=0)
+								/* Push the streamer's frames unless they were culled by the server: */
+								if(streams[i]->colorStreamingCallback!=0&&receivedFrames[i*2+0])
 									(*streams[i]->colorStreamingCallback)(frames[i*2+0]);
-								if(streams[i]->depthStreamingCallback!=0)
+								if(streams[i]->depthStreamingCallback!=0&&receivedFrames[i*2+1])
 									(*streams[i]->depthStreamingCallback)(frames[i*2+1]);
 								}
 							}
@@ -251,23 +298,49 @@ void* MultiplexedFrameSource::receivingThreadMethod(void)
 				numMissingDepthFrames=numStreams;
 				}
 			
+			/* Check if the server refreshed a stream's headers after a codec change: */
+			if(frameId&0x40000000U)
+				{
+				frameId&=~0x40000000U;
+				if(frameId>=numStreams*2)
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame identifier %u",frameId);
+				readStreamHeaders(frameId);
+				continue;
+				}
+			
+			/* Check if the server culled the new frame: */
+			bool culled=(frameId&0x80000000U)!=0x0U;
+			frameId&=~0x80000000U;
+			if(frameId>=numStreams*2)
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame identifier %u",frameId);
+			receivedFrames[frameId]=!culled;
+			
 			/* Read the new frame: */
 			unsigned int streamIndex=frameId>>1;
 			if(frameId&0x1U)
 				{
 				/* Receive a depth frame: */
-				frames[frameId]=depthFrameReaders[streamIndex]->readNextFrame();
+				if(!culled)
+					frames[frameId]=depthFrameReaders[streamIndex]->readNextFrame();
 				--numMissingDepthFrames;
 				}
 			else
 				{
 				/* Receive a color frame: */
-				frames[frameId]=colorFrameReaders[streamIndex]->readNextFrame();
+				if(!culled)
+					{
+					frames[frameId]=colorFrameReaders[streamIndex]->readNextFrame();
+					
+					/* Convert the frame back to the stream's announced color space after a codec change: */
+					if(getColorSpace(*colorFrameReaders[streamIndex])!=colorSpaces[streamIndex])
+						frames[frameId]=convertRgbFrame(frames[frameId],colorSpaces[streamIndex]);
+					}
 				--numMissingColorFrames;
 				}
 			
 			/* Adjust the new frame's time stamp: */
-			frames[frameId].timeStamp-=timeStampOffset;
+			if(!culled)
+				frames[frameId].timeStamp-=timeStampOffset;
 			}
 		}
 	catch(const std::runtime_error& err)
@@ -284,7 +357,8 @@ MultiplexedFrameSource::MultiplexedFrameSource(Comm::PipePtr sPipe)
 	 numStreams(0),
 	 colorFrameReaders(0),
 	 depthFrameReaders(0),
-	 frames(0),
+	 colorSpaces(0),
+	 frames(0),receivedFrames(0),
 	 numStreamsAlive(0),
 	 streams(0)
 	{
@@ -298,7 +372,7 @@ MultiplexedFrameSource::MultiplexedFrameSource(Comm::PipePtr sPipe)
 	
 	/* Write client's endianness flag and protocol version number: */
 	pipe->write<Misc::UInt32>(0x12345678U);
-	pipe->write<Misc::UInt32>(1U);
+	pipe->write<Misc::UInt32>(3U);
 	pipe->flush();
 	
 	/* Determine server's endianness: */
@@ -318,11 +392,13 @@ MultiplexedFrameSource::MultiplexedFrameSource(Comm::PipePtr sPipe)
 	numStreams=pipe->read<Misc::UInt32>();
 	colorFrameReaders=new FrameReader*[numStreams];
 	depthFrameReaders=new FrameReader*[numStreams];
+	colorSpaces=new FrameSource::ColorSpace[numStreams];
 	streams=new Stream*[numStreams];
 	for(unsigned int i=0;i<numStreams;++i)
 		{
 		colorFrameReaders[i]=0;
 		depthFrameReaders[i]=0;
+		colorSpaces[i]=FrameSource::RGB;
 		streams[i]=0;
 		}
 	bool allStreamsOk=true;
@@ -353,12 +429,16 @@ MultiplexedFrameSource::MultiplexedFrameSource(Comm::PipePtr sPipe)
 		/* Clean up and signal an error: */
 		delete[] colorFrameReaders;
 		delete[] depthFrameReaders;
+		delete[] colorSpaces;
 		delete[] streams;
 		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Error while initializing component streams");
 		}
 	
 	/* Allocate the frame buffer array: */
 	frames=new FrameBuffer[numStreams*2];
+	receivedFrames=new bool[numStreams*2];
+	for(unsigned int i=0;i<numStreams*2;++i)
+		receivedFrames[i]=false;
 	
 	/* Start the demultiplexer thread: */
 	receivingThread.start(this,&MultiplexedFrameSource::receivingThreadMethod);
@@ -379,10 +459,12 @@ MultiplexedFrameSource::~MultiplexedFrameSource(void)
 		}
 	delete[] colorFrameReaders;
 	delete[] depthFrameReaders;
+	delete[] colorSpaces;
 	delete[] streams;
 	
 	/* Delete the frame buffers: */
 	delete[] frames;
+	delete[] receivedFrames;
 	
 	/* Say goodbye to the server: */
 	try
@@ -402,4 +484,23 @@ MultiplexedFrameSource* MultiplexedFrameSource::create(Comm::PipePtr sPipe)
 	return new MultiplexedFrameSource(sPipe);
 	}
 
+void MultiplexedFrameSource::setViewRegion(unsigned int numPlanes,const Geometry::Plane<double,3>* planes,double margin)
+	{
+	/* Bail out if the server does not support view-dependent streaming: */
+	if(serverProtocolVersion<2)
+		return;
+	
+	/* Send a view region update message to the server: */
+	pipe->write<Misc::UInt32>(1);
+	pipe->write<Misc::UInt32>(numPlanes);
+	pipe->write<Misc::Float64>(margin);
+	for(unsigned int i=0;i<numPlanes;++i)
+		{
+		for(int j=0;j<3;++j)
+			pipe->write<Misc::Float64>(planes[i].getNormal()[j]);
+		pipe->write<Misc::Float64>(planes[i].getOffset());
+		}
+	pipe->flush();
+	}
+
 }
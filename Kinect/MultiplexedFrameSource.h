@@ -30,6 +30,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Comm/Pipe.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <Geometry/ProjectiveTransformation.h>
+#include <Geometry/Plane.h>
 #include <Kinect/FrameBuffer.h>
 #include <Kinect/FrameSource.h>
 
@@ -84,13 +85,16 @@ class MultiplexedFrameSource
 	unsigned int numStreams; // Number of streams in the multiplexer
 	FrameReader** colorFrameReaders; // Array of color stream readers for the component streams
 	FrameReader** depthFrameReaders; // Array of depth stream readers for the component streams
+	FrameSource::ColorSpace* colorSpaces; // Array of color spaces of the component streams' color frames as announced to consumers when the streams were created
 	FrameBuffer* frames; // Array of color and depth frames in the current metaframe
+	bool* receivedFrames; // Array of flags whether the color and depth frames in the current metaframe were received, or culled by the server
 	Threads::Mutex streamMutex; // Mutex serializing access to the stream array
 	unsigned int numStreamsAlive; // Number of streams that are still receiving frames
 	Stream** streams; // Array of pointers to streams
 	Threads::Thread receivingThread; // The demultiplexer thread
 	
 	/* Private methods: */
+	void readStreamHeaders(unsigned int frameId); // Reads refreshed headers of the given color or depth stream from the source and replaces the stream's frame reader
 	void* receivingThreadMethod(void); // Thread method demultiplexing streams from the source
 	
 	/* Constructors and destructors: */
@@ -109,6 +113,11 @@ class MultiplexedFrameSource
 		{
 		return streams[streamIndex];
 		}
+	bool canSetViewRegion(void) const // Returns true if the server supports view-dependent streaming
+		{
+		return serverProtocolVersion>=2;
+		}
+	void setViewRegion(unsigned int numPlanes,const Geometry::Plane<double,3>* planes,double margin); // Asks the server to only send frame data that can be seen from inside the convex world-space region bounded by the given planes, expanded by the given margin; numPlanes==0 requests all frame data
 	};
 
 }
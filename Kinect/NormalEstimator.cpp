@@ -0,0 +1,299 @@
+/***********************************************************************
+NormalEstimator - Class to estimate per-pixel world-space normal vectors
+of the surfaces seen in depth frames from central depth differences,
+using multiple threads processing bands of frame rows.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/NormalEstimator.h>
+
+#include <Misc/StdError.h>
+#include <Misc/FunctionCalls.h>
+#include <Math/Math.h>
+#include <Geometry/ProjectiveTransformation.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+
+const unsigned int maxValidDepth=FrameSource::invalidDepth-1; // Pixels at or above this value do not generate triangles
+
+inline bool isNeighbor(unsigned int d,unsigned int n,unsigned int maxDepthJump) // Returns true if a neighboring pixel is valid and on the same surface as a valid pixel
+	{
+	return n<maxValidDepth&&(n>d?n-d:d-n)<=maxDepthJump;
+	}
+
+inline GLbyte packComponent(float c) // Converts a normal vector component to a signed byte
+	{
+	return GLbyte(Math::floor(c*127.0f+0.5f));
+	}
+
+}
+
+/********************************
+Methods of class NormalEstimator:
+********************************/
+
+void NormalEstimator::processBand(unsigned int firstRow,unsigned int lastRow)
+	{
+	unsigned int width=depthSize[0];
+	unsigned int height=depthSize[1];
+	const DepthPixel* in=inFrame->getData<DepthPixel>();
+	const IntrinsicParameters::Point2* pcs=pixelCenters.empty()?0:&pixelCenters[0];
+	
+	/* Allocate per-row buffers holding the tangent planes of all pixels as structures of arrays: */
+	std::vector<float> planeBuffer(size_t(width)*4);
+	float* planes[4];
+	for(int i=0;i<4;++i)
+		planes[i]=&planeBuffer[size_t(width)*i];
+	
+	for(unsigned int y=firstRow;y<lastRow;++y)
+		{
+		size_t rowIndex=size_t(y)*size_t(width);
+		const DepthPixel* row=in+rowIndex;
+		
+		/*******************************************************************
+		Calculate each valid pixel's tangent plane in depth image space from
+		central differences to its neighbors, falling back to one-sided
+		differences at depth discontinuities and frame boundaries.
+		*******************************************************************/
+		
+		for(unsigned int x=0;x<width;++x)
+			{
+			unsigned int d=row[x];
+			if(d>=maxValidDepth)
+				{
+				/* Invalid pixels get null planes, resulting in null normals: */
+				for(int i=0;i<4;++i)
+					planes[i][x]=0.0f;
+				continue;
+				}
+			
+			/* Calculate the pixel's position in depth image space: */
+			size_t index=rowIndex+x;
+			float p[3];
+			if(pcs!=0)
+				{
+				p[0]=float(pcs[index][0]);
+				p[1]=float(pcs[index][1]);
+				}
+			else
+				{
+				p[0]=float(x)+0.5f;
+				p[1]=float(y)+0.5f;
+				}
+			p[2]=depthCorrection!=0?depthCorrection[index].correct(float(d)):float(d);
+			
+			/* Find the pixel's valid neighbors on the same surface: */
+			size_t i0=x>0&&isNeighbor(d,row[x-1],maxDepthJump)?index-1:index;
+			size_t i1=x<width-1&&isNeighbor(d,row[x+1],maxDepthJump)?index+1:index;
+			size_t j0=y>0&&isNeighbor(d,in[index-width],maxDepthJump)?index-width:index;
+			size_t j1=y<height-1&&isNeighbor(d,in[index+width],maxDepthJump)?index+width:index;
+			
+			float n[3];
+			if(i0!=i1&&j0!=j1)
+				{
+				/* Calculate the tangent vectors along both frame axes: */
+				float t[2][3];
+				size_t ends[2][2]={{i0,i1},{j0,j1}};
+				for(int axis=0;axis<2;++axis)
+					{
+					float e[2][3];
+					for(int end=0;end<2;++end)
+						{
+						size_t ei=ends[axis][end];
+						if(pcs!=0)
+							{
+							e[end][0]=float(pcs[ei][0]);
+							e[end][1]=float(pcs[ei][1]);
+							}
+						else
+							{
+							e[end][0]=float(ei%width)+0.5f;
+							e[end][1]=float(ei/width)+0.5f;
+							}
+						e[end][2]=depthCorrection!=0?depthCorrection[ei].correct(float(in[ei])):float(in[ei]);
+						}
+					for(int i=0;i<3;++i)
+						t[axis][i]=e[1][i]-e[0][i];
+					}
+				
+				/* Calculate the normal vector such that it matches the one calculated by the facade projector's shader: */
+				n[0]=t[1][1]*t[0][2]-t[1][2]*t[0][1];
+				n[1]=t[1][2]*t[0][0]-t[1][0]*t[0][2];
+				n[2]=t[1][0]*t[0][1]-t[1][1]*t[0][0];
+				}
+			else
+				{
+				/* Face isolated pixels and pixels on thin ridges towards the camera: */
+				n[0]=0.0f;
+				n[1]=0.0f;
+				n[2]=-1.0f;
+				}
+			
+			/* Store the tangent plane: */
+			planes[0][x]=n[0];
+			planes[1][x]=n[1];
+			planes[2][x]=n[2];
+			planes[3][x]=-(n[0]*p[0]+n[1]*p[1]+n[2]*p[2]);
+			}
+		
+		/*******************************************************************
+		Transform the tangent planes to world space, normalize their normal
+		vectors, and pack them into the output array.
+		*******************************************************************/
+		
+		MeshBuffer::PackedNormal* out=outNormals+rowIndex;
+		unsigned int x=0;
+		
+		#ifdef __SSE2__
+		
+		/* Process blocks of four pixels: */
+		__m128 pt[3][4];
+		for(int i=0;i<3;++i)
+			for(int j=0;j<4;++j)
+				pt[i][j]=_mm_set1_ps(planeTransform[i][j]);
+		__m128 minLen2=_mm_set1_ps(1.0e-30f);
+		__m128 half=_mm_set1_ps(0.5f);
+		__m128 threeHalves=_mm_set1_ps(1.5f);
+		__m128 scale=_mm_set1_ps(127.0f);
+		for(;x+4<=width;x+=4)
+			{
+			/* Load the tangent planes: */
+			__m128 pl[4];
+			for(int j=0;j<4;++j)
+				pl[j]=_mm_loadu_ps(planes[j]+x);
+			
+			/* Transform the planes' normal vectors to world space: */
+			__m128 wn[3];
+			for(int i=0;i<3;++i)
+				{
+				wn[i]=_mm_mul_ps(pt[i][0],pl[0]);
+				for(int j=1;j<4;++j)
+					wn[i]=_mm_add_ps(wn[i],_mm_mul_ps(pt[i][j],pl[j]));
+				}
+			
+			/* Normalize the normal vectors using one Newton-Raphson step on the reciprocal square root; null normals stay null: */
+			__m128 len2=_mm_max_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(wn[0],wn[0]),_mm_mul_ps(wn[1],wn[1])),_mm_mul_ps(wn[2],wn[2])),minLen2);
+			__m128 r=_mm_rsqrt_ps(len2);
+			r=_mm_mul_ps(r,_mm_sub_ps(threeHalves,_mm_mul_ps(_mm_mul_ps(half,len2),_mm_mul_ps(r,r))));
+			r=_mm_mul_ps(r,scale);
+			
+			/* Convert the normal vectors to integers and interleave them into four (x, y, z, 0) quadruples: */
+			__m128i nx=_mm_cvtps_epi32(_mm_mul_ps(wn[0],r));
+			__m128i ny=_mm_cvtps_epi32(_mm_mul_ps(wn[1],r));
+			__m128i nz=_mm_cvtps_epi32(_mm_mul_ps(wn[2],r));
+			__m128i xyLo=_mm_unpacklo_epi32(nx,ny);
+			__m128i xyHi=_mm_unpackhi_epi32(nx,ny);
+			__m128i z0Lo=_mm_unpacklo_epi32(nz,_mm_setzero_si128());
+			__m128i z0Hi=_mm_unpackhi_epi32(nz,_mm_setzero_si128());
+			__m128i n01=_mm_packs_epi32(_mm_unpacklo_epi64(xyLo,z0Lo),_mm_unpackhi_epi64(xyLo,z0Lo));
+			__m128i n23=_mm_packs_epi32(_mm_unpacklo_epi64(xyHi,z0Hi),_mm_unpackhi_epi64(xyHi,z0Hi));
+			
+			/* Store the packed normal vectors: */
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out+x),_mm_packs_epi16(n01,n23));
+			}
+		
+		#endif
+		
+		/* Process the remaining pixels: */
+		for(;x<width;++x)
+			{
+			float wn[3];
+			for(int i=0;i<3;++i)
+				wn[i]=planeTransform[i][0]*planes[0][x]+planeTransform[i][1]*planes[1][x]+planeTransform[i][2]*planes[2][x]+planeTransform[i][3]*planes[3][x];
+			float len2=wn[0]*wn[0]+wn[1]*wn[1]+wn[2]*wn[2];
+			float r=len2>1.0e-30f?1.0f/Math::sqrt(len2):0.0f;
+			for(int i=0;i<3;++i)
+				out[x].components[i]=packComponent(wn[i]*r);
+			out[x].components[3]=0;
+			}
+		}
+	}
+
+void NormalEstimator::processJob(unsigned int bandIndex)
+	{
+	unsigned int firstRow=bandIndex*bandHeight;
+	unsigned int lastRow=depthSize[1]-firstRow<bandHeight?depthSize[1]:firstRow+bandHeight;
+	processBand(firstRow,lastRow);
+	}
+
+NormalEstimator::NormalEstimator(unsigned int numThreads)
+	:depthSize(0,0),
+	 inFrame(0),depthCorrection(0),maxDepthJump(0),outNormals(0),
+	 jobPool(numThreads)
+	{
+	for(int i=0;i<3;++i)
+		for(int j=0;j<4;++j)
+			planeTransform[i][j]=0.0f;
+	}
+
+NormalEstimator::~NormalEstimator(void)
+	{
+	}
+
+void NormalEstimator::setIntrinsicParameters(const Size& newDepthSize,const NormalEstimator::IntrinsicParameters& ips)
+	{
+	depthSize=newDepthSize;
+	
+	/* Pre-compute undistorted pixel centers if the camera has lens distortion: */
+	pixelCenters.clear();
+	if(!ips.depthLensDistortion.isIdentity())
+		{
+		pixelCenters.reserve(depthSize.volume());
+		for(unsigned int y=0;y<depthSize[1];++y)
+			for(unsigned int x=0;x<depthSize[0];++x)
+				pixelCenters.push_back(ips.undistortDepthPixel(x,y));
+		}
+	}
+
+void NormalEstimator::estimate(const FrameBuffer& depthFrame,const NormalEstimator::PixelCorrection* newDepthCorrection,const NormalEstimator::PTransform& worldDepthProjection,FrameSource::DepthPixel newMaxDepthJump,MeshBuffer::PackedNormal* normals)
+	{
+	if(depthFrame.getSize(0)!=depthSize[0]||depthFrame.getSize(1)!=depthSize[1])
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size does not match intrinsic parameters");
+	
+	/* Tangent planes transform with the inverse transpose of the point transformation: */
+	PTransform inverseProjection=Geometry::invert(worldDepthProjection);
+	const PTransform::Matrix& ipm=inverseProjection.getMatrix();
+	for(int i=0;i<3;++i)
+		for(int j=0;j<4;++j)
+			planeTransform[i][j]=float(ipm(j,i));
+	
+	/* Process all bands of the frame in parallel: */
+	inFrame=&depthFrame;
+	depthCorrection=newDepthCorrection;
+	maxDepthJump=newMaxDepthJump;
+	outNormals=normals;
+	jobPool.run((depthSize[1]+bandHeight-1)/bandHeight,Misc::VoidMethodCall<unsigned int,NormalEstimator>(this,&NormalEstimator::processJob));
+	inFrame=0;
+	outNormals=0;
+	}
+
+}
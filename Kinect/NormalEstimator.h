@@ -0,0 +1,73 @@
+/***********************************************************************
+NormalEstimator - Class to estimate per-pixel world-space normal vectors
+of the surfaces seen in depth frames from central depth differences,
+using multiple threads processing bands of frame rows.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_NORMALESTIMATOR_INCLUDED
+#define KINECT_NORMALESTIMATOR_INCLUDED
+
+#include <vector>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/ParallelJobPool.h>
+
+namespace Kinect {
+
+class NormalEstimator
+	{
+	/* Embedded classes: */
+	public:
+	typedef FrameSource::DepthCorrection::PixelCorrection PixelCorrection; // Type for per-pixel depth correction factors
+	typedef FrameSource::IntrinsicParameters IntrinsicParameters; // Type for combined depth and color camera intrinsic parameters
+	typedef IntrinsicParameters::PTransform PTransform; // Type for projective transformations
+	
+	/* Elements: */
+	private:
+	Size depthSize; // Size of depth frames
+	std::vector<IntrinsicParameters::Point2> pixelCenters; // Undistorted depth image-space pixel centers if the camera has lens distortion; empty otherwise
+	static const unsigned int bandHeight=16; // Number of frame rows in each band processed by a single thread
+	const FrameBuffer* inFrame; // Depth frame currently being processed
+	const PixelCorrection* depthCorrection; // Per-pixel depth correction factors for the current frame, or null
+	FrameSource::DepthPixel maxDepthJump; // Maximum depth value difference between neighboring pixels on the same surface for the current frame
+	float planeTransform[3][4]; // Upper three rows of the inverse transpose of the current depth image-to-world space projection, to transform tangent planes
+	MeshBuffer::PackedNormal* outNormals; // Normal vector array currently being written
+	ParallelJobPool jobPool; // Pool of threads processing bands of the current frame
+	
+	/* Private methods: */
+	void processBand(unsigned int firstRow,unsigned int lastRow); // Estimates normal vectors for the given range of rows of the current frame
+	void processJob(unsigned int bandIndex); // Estimates normal vectors for the band of the given index of the current frame
+	
+	/* Constructors and destructors: */
+	public:
+	NormalEstimator(unsigned int numThreads =2); // Creates a normal estimator using the given total number of threads
+	~NormalEstimator(void);
+	
+	/* Methods: */
+	void setIntrinsicParameters(const Size& newDepthSize,const IntrinsicParameters& ips); // Sets the depth frame size and the depth camera's lens distortion; must not be called while a frame is being processed
+	void estimate(const FrameBuffer& depthFrame,const PixelCorrection* newDepthCorrection,const PTransform& worldDepthProjection,FrameSource::DepthPixel newMaxDepthJump,MeshBuffer::PackedNormal* normals); // Writes unit-length world-space normal vectors for all pixels of the given depth frame into the given array, using the given per-pixel depth correction factors (can be null), depth image-to-world space projection, and maximum depth difference between neighbors on the same surface
+	};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+/***********************************************************************
+OctreePointCloudReader - Class to decompress a stream of world-space
+point clouds written by OctreePointCloudWriter.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/OctreePointCloudReader.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Kinect/OctreePointCloudWriter.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int compactBits(Misc::UInt64 v) // Extracts every third bit of the given value, starting at the lowest bit
+	{
+	v&=0x1249249249249249ULL;
+	v=(v|(v>>2))&0x10c30c30c30c30c3ULL;
+	v=(v|(v>>4))&0x100f00f00f00f00fULL;
+	v=(v|(v>>8))&0x1f0000ff0000ffULL;
+	v=(v|(v>>16))&0x1f00000000ffffULL;
+	v=(v|(v>>32))&0x1fffffULL;
+	return (unsigned int)(v);
+	}
+
+inline unsigned int countBits(unsigned int mask) // Returns the number of set bits in an occupancy mask
+	{
+	unsigned int result=0;
+	for(;mask!=0;mask&=mask-1U)
+		++result;
+	return result;
+	}
+
+}
+
+/***************************************
+Methods of class OctreePointCloudReader:
+***************************************/
+
+void OctreePointCloudReader::decodeSubtree(Misc::UInt64 prefix,unsigned int parentOccupancy,unsigned int depth,PointCloud& cloud)
+	{
+	RansCoder::Decoder decoder(&codeBuffer[0],codeBuffer.size());
+	unsigned int stateIndex=0;
+	
+	/* Expand the subtree's interior nodes in breadth-first order: */
+	std::vector<Misc::UInt64> nodes(1,prefix);
+	std::vector<Misc::UInt8> parentOccupancies(1,Misc::UInt8(parentOccupancy));
+	std::vector<Misc::UInt64> children;
+	std::vector<Misc::UInt8> childParentOccupancies;
+	for(unsigned int level=0;level<depth;++level)
+		{
+		children.clear();
+		childParentOccupancies.clear();
+		for(size_t i=0;i<nodes.size();++i)
+			{
+			/* Decode the node's occupancy mask using the context of its parent's occupancy: */
+			unsigned int context=countBits(parentOccupancies[i])-1U;
+			unsigned int occupancy=decoder.decode(stateIndex,tables[context]);
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			if(occupancy==0)
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Corrupted octree node");
+			
+			/* Create the node's occupied children in Morton order: */
+			for(unsigned int child=0;child<8;++child)
+				if(occupancy&(1U<<child))
+					{
+					children.push_back((nodes[i]<<3)|Misc::UInt64(child));
+					childParentOccupancies.push_back(Misc::UInt8(occupancy));
+					}
+			}
+		nodes.swap(children);
+		parentOccupancies.swap(childParentOccupancies);
+		}
+	
+	/* Append the centers of all leaf voxels to the point cloud: */
+	Scalar voxelSize=getVoxelSize();
+	for(std::vector<Misc::UInt64>::iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		{
+		Point p;
+		for(int i=0;i<3;++i)
+			p[i]=origin[i]+(Scalar(compactBits((*nIt)>>i))+Scalar(0.5))*voxelSize;
+		cloud.points.push_back(p);
+		}
+	
+	if(colors)
+		{
+		/* Decode the leaves' colors from their per-component residuals: */
+		unsigned int predicted[3]={0,0,0};
+		for(size_t i=0;i<nodes.size();++i)
+			{
+			PointCloud::Color color;
+			for(unsigned int j=0;j<OctreePointCloudWriter::numColorTables;++j)
+				{
+				unsigned int residual=decoder.decode(stateIndex,tables[OctreePointCloudWriter::numOccupancyContexts+j]);
+				stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+				predicted[j]=(predicted[j]+residual)&0xffU;
+				color[j]=PointCloud::Color::Component(predicted[j]);
+				}
+			cloud.colors.push_back(color);
+			}
+		}
+	}
+
+OctreePointCloudReader::OctreePointCloudReader(IO::File& sSource)
+	:source(sSource),
+	 formatVersion(0),
+	 tables(OctreePointCloudWriter::numOccupancyContexts+OctreePointCloudWriter::numColorTables,RansCoder::FrequencyTable(RansCoder::maxNumSymbols))
+	{
+	/* Read and check the versioned octree stream header: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>OctreePointCloudWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported octree point cloud stream format version %u",formatVersion);
+	unsigned int numStates=source.read<Misc::UInt8>();
+	unsigned int scaleBits=source.read<Misc::UInt8>();
+	if(numStates!=RansCoder::numStates||scaleBits!=RansCoder::scaleBits)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported rANS coder layout with %u states and %u-bit frequencies",numStates,scaleBits);
+	for(int i=0;i<3;++i)
+		origin[i]=Scalar(source.read<Misc::Float32>());
+	cubeSize=Scalar(source.read<Misc::Float32>());
+	streamNumLevels=source.read<Misc::UInt8>();
+	subtreeLevel=source.read<Misc::UInt8>();
+	if(streamNumLevels<1||streamNumLevels>OctreePointCloudWriter::maxNumLevels||subtreeLevel>streamNumLevels)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid octree depth %u with subtree level %u",streamNumLevels,subtreeLevel);
+	colors=source.read<Misc::UInt8>()!=0;
+	numLevels=streamNumLevels;
+	}
+
+bool OctreePointCloudReader::readNextFrame(PointCloud& cloud)
+	{
+	/* Bail out if the stream is over: */
+	if(source.eof())
+		return false;
+	
+	/* Read the frame header: */
+	cloud.clear();
+	cloud.timeStamp=source.read<Misc::Float64>();
+	numLevels=source.read<Misc::UInt8>();
+	if(numLevels<1||numLevels>streamNumLevels)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame octree depth %u",numLevels);
+	size_t numVoxels=source.read<Misc::UInt32>();
+	if(numVoxels==0)
+		return true;
+	cloud.points.reserve(numVoxels);
+	if(colors)
+		cloud.colors.reserve(numVoxels);
+	
+	/* Read the frame's frequency tables: */
+	unsigned int numTables=OctreePointCloudWriter::numOccupancyContexts;
+	if(colors)
+		numTables+=OctreePointCloudWriter::numColorTables;
+	for(unsigned int table=0;table<numTables;++table)
+		tables[table].read(source);
+	
+	/* Expand the top levels of the octree from their raw occupancy masks: */
+	unsigned int splitLevel=numLevels<subtreeLevel?numLevels:subtreeLevel;
+	std::vector<Misc::UInt64> roots(1,0);
+	std::vector<Misc::UInt8> rootParentOccupancies(1,Misc::UInt8(0x01U));
+	for(unsigned int level=0;level<splitLevel;++level)
+		{
+		std::vector<Misc::UInt64> children;
+		std::vector<Misc::UInt8> childParentOccupancies;
+		for(std::vector<Misc::UInt64>::iterator rIt=roots.begin();rIt!=roots.end();++rIt)
+			{
+			unsigned int occupancy=source.read<Misc::UInt8>();
+			if(occupancy==0)
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Corrupted octree node");
+			for(unsigned int child=0;child<8;++child)
+				if(occupancy&(1U<<child))
+					{
+					children.push_back(((*rIt)<<3)|Misc::UInt64(child));
+					childParentOccupancies.push_back(Misc::UInt8(occupancy));
+					}
+			}
+		roots.swap(children);
+		rootParentOccupancies.swap(childParentOccupancies);
+		}
+	
+	/* Read the sizes of the encoded subtrees: */
+	std::vector<size_t> codeSizes;
+	codeSizes.reserve(roots.size());
+	for(size_t i=0;i<roots.size();++i)
+		codeSizes.push_back(source.read<Misc::UInt32>());
+	
+	/* Decode all subtrees in Morton order: */
+	for(size_t i=0;i<roots.size();++i)
+		{
+		/* Reject empty code blocks, which the writer never produces because every block starts with the coder's initial states: */
+		if(codeSizes[i]==0)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Empty code block for subtree %u",(unsigned int)(i));
+		codeBuffer.resize(codeSizes[i]);
+		source.read(&codeBuffer[0],codeSizes[i]);
+		decodeSubtree(roots[i],rootParentOccupancies[i],numLevels-splitLevel,cloud);
+		}
+	if(cloud.points.size()!=numVoxels)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Decoded %u voxels instead of %u",(unsigned int)(cloud.points.size()),(unsigned int)(numVoxels));
+	
+	return true;
+	}
+
+}
@@ -0,0 +1,96 @@
+/***********************************************************************
+OctreePointCloudReader - Class to decompress a stream of world-space
+point clouds written by OctreePointCloudWriter.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_OCTREEPOINTCLOUDREADER_INCLUDED
+#define KINECT_OCTREEPOINTCLOUDREADER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/PointCloud.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class OctreePointCloudReader
+	{
+	/* Embedded classes: */
+	public:
+	typedef PointCloud::Scalar Scalar; // Scalar type for world space
+	typedef PointCloud::Point Point; // Type for points in world space
+	
+	/* Elements: */
+	private:
+	IO::File& source; // Data source for the compressed point cloud stream
+	unsigned int formatVersion; // Version number of the source's octree stream format
+	Point origin; // Minimum corner of the cube enclosing all encoded points
+	Scalar cubeSize; // Edge length of the cube enclosing all encoded points
+	unsigned int streamNumLevels; // Maximum octree depth of the stream
+	unsigned int subtreeLevel; // Octree level at which frames are split into independently coded subtrees
+	bool colors; // Flag whether the stream contains per-point colors
+	unsigned int numLevels; // Octree depth of the most recently read frame
+	std::vector<RansCoder::FrequencyTable> tables; // Per-frame occupancy and color residual frequency tables
+	std::vector<Misc::UInt8> codeBuffer; // Buffer holding the current encoded subtree
+	
+	/* Private methods: */
+	void decodeSubtree(Misc::UInt64 prefix,unsigned int parentOccupancy,unsigned int depth,PointCloud& cloud); // Decodes the subtree of the given root node from the code buffer and appends its voxels to the given point cloud
+	
+	/* Constructors and destructors: */
+	public:
+	OctreePointCloudReader(IO::File& sSource); // Creates a point cloud reader associated with the given data source
+	
+	/* Methods: */
+	const Point& getOrigin(void) const // Returns the minimum corner of the stream's bounding cube
+		{
+		return origin;
+		}
+	Scalar getCubeSize(void) const // Returns the edge length of the stream's bounding cube
+		{
+		return cubeSize;
+		}
+	unsigned int getStreamNumLevels(void) const // Returns the stream's maximum octree depth
+		{
+		return streamNumLevels;
+		}
+	bool hasColors(void) const // Returns true if the stream contains per-point colors
+		{
+		return colors;
+		}
+	unsigned int getNumLevels(void) const // Returns the octree depth of the most recently read frame
+		{
+		return numLevels;
+		}
+	Scalar getVoxelSize(void) const // Returns the voxel size of the most recently read frame
+		{
+		return cubeSize/Scalar(Misc::UInt64(1)<<numLevels);
+		}
+	bool readNextFrame(PointCloud& cloud); // Replaces the given point cloud's contents with the centers of the next frame's occupied voxels; returns false if the stream is over
+	};
+
+}
+
+#endif
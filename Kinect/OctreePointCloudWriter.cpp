@@ -0,0 +1,373 @@
+/***********************************************************************
+OctreePointCloudWriter - Class to compress a stream of fused world-space
+point clouds by quantizing them into voxel octrees and entropy-coding
+the octrees' node occupancy with context-modeled rANS coding.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/OctreePointCloudWriter.h>
+
+#include <algorithm>
+#include <Misc/StdError.h>
+#include <Misc/FunctionCalls.h>
+#include <IO/File.h>
+
+namespace Kinect {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Misc::UInt64 spreadBits(Misc::UInt64 v) // Inserts two zero bits between each of the lowest 21 bits of the given value
+	{
+	v&=0x1fffffULL;
+	v=(v|(v<<32))&0x1f00000000ffffULL;
+	v=(v|(v<<16))&0x1f0000ff0000ffULL;
+	v=(v|(v<<8))&0x100f00f00f00f00fULL;
+	v=(v|(v<<4))&0x10c30c30c30c30c3ULL;
+	v=(v|(v<<2))&0x1249249249249249ULL;
+	return v;
+	}
+
+inline unsigned int countBits(unsigned int mask) // Returns the number of set bits in an occupancy mask
+	{
+	unsigned int result=0;
+	for(;mask!=0;mask&=mask-1U)
+		++result;
+	return result;
+	}
+
+void buildParents(const std::vector<Misc::UInt64>& children,std::vector<Misc::UInt64>& parents,std::vector<Misc::UInt8>& occupancies) // Calculates the sorted Morton code prefixes and occupancy masks of the parents of the given sorted list of octree nodes
+	{
+	parents.clear();
+	occupancies.clear();
+	for(std::vector<Misc::UInt64>::const_iterator cIt=children.begin();cIt!=children.end();++cIt)
+		{
+		Misc::UInt64 parent=(*cIt)>>3;
+		if(parents.empty()||parents.back()!=parent)
+			{
+			parents.push_back(parent);
+			occupancies.push_back(0);
+			}
+		occupancies.back()|=Misc::UInt8(1U<<((*cIt)&0x7U));
+		}
+	}
+
+}
+
+/***************************************
+Methods of class OctreePointCloudWriter:
+***************************************/
+
+void OctreePointCloudWriter::buildSymbols(OctreePointCloudWriter::Subtree& subtree)
+	{
+	/* Sort the subtree's points into Morton order: */
+	std::sort(subtree.voxels.begin(),subtree.voxels.end());
+	
+	/* Merge points falling into the same voxel, averaging their colors: */
+	unsigned int depth=numLevels-splitLevel;
+	std::vector<std::vector<Misc::UInt64> > levelNodes(depth+1);
+	std::vector<Misc::UInt64>& leaves=levelNodes[depth];
+	std::vector<PointCloud::Color> leafColors;
+	std::vector<Voxel>::iterator vIt=subtree.voxels.begin();
+	while(vIt!=subtree.voxels.end())
+		{
+		unsigned int sums[3]={0,0,0};
+		unsigned int numPoints=0;
+		std::vector<Voxel>::iterator runIt;
+		for(runIt=vIt;runIt!=subtree.voxels.end()&&runIt->code==vIt->code;++runIt,++numPoints)
+			if(colors)
+				for(int i=0;i<3;++i)
+					sums[i]+=runIt->color[i];
+		leaves.push_back(vIt->code);
+		if(colors)
+			{
+			PointCloud::Color color;
+			for(int i=0;i<3;++i)
+				color[i]=PointCloud::Color::Component((sums[i]+numPoints/2)/numPoints);
+			leafColors.push_back(color);
+			}
+		vIt=runIt;
+		}
+	
+	/* Build the subtree's interior nodes bottom-up: */
+	std::vector<std::vector<Misc::UInt8> > levelOccupancies(depth);
+	for(unsigned int level=depth;level>0;--level)
+		buildParents(levelNodes[level],levelNodes[level-1],levelOccupancies[level-1]);
+	
+	/*********************************************************************
+	Emit the occupancy masks of all interior nodes in breadth-first order,
+	each tagged with a context given by the number of occupied children of
+	the node's parent, i.e., the node's occupied siblings. Dense parents
+	tend to have dense children, and sparse surfaces sparse ones.
+	*********************************************************************/
+	
+	size_t localCounts[numOccupancyContexts+numColorTables][RansCoder::maxNumSymbols];
+	for(unsigned int table=0;table<numOccupancyContexts+numColorTables;++table)
+		for(unsigned int i=0;i<RansCoder::maxNumSymbols;++i)
+			localCounts[table][i]=0;
+	subtree.symbols.clear();
+	for(unsigned int level=0;level<depth;++level)
+		{
+		const std::vector<Misc::UInt64>& nodes=levelNodes[level];
+		const std::vector<Misc::UInt8>& occupancies=levelOccupancies[level];
+		size_t parentIndex=0;
+		for(size_t i=0;i<nodes.size();++i)
+			{
+			/* Find the node's parent's occupancy mask: */
+			unsigned int parentOccupancy=subtree.parentOccupancy;
+			if(level>0)
+				{
+				while(levelNodes[level-1][parentIndex]!=(nodes[i]>>3))
+					++parentIndex;
+				parentOccupancy=levelOccupancies[level-1][parentIndex];
+				}
+			
+			unsigned int context=countBits(parentOccupancy)-1U;
+			subtree.symbols.push_back(Misc::UInt16((context<<8)|occupancies[i]));
+			++localCounts[context][occupancies[i]];
+			}
+		}
+	
+	if(colors)
+		{
+		/* Emit the leaves' colors as per-component residuals from the previous leaf in Morton order: */
+		unsigned int predicted[3]={0,0,0};
+		for(std::vector<PointCloud::Color>::iterator lcIt=leafColors.begin();lcIt!=leafColors.end();++lcIt)
+			for(unsigned int i=0;i<numColorTables;++i)
+				{
+				unsigned int residual=(unsigned int)((*lcIt)[i]-predicted[i])&0xffU;
+				subtree.symbols.push_back(Misc::UInt16(((numOccupancyContexts+i)<<8)|residual));
+				++localCounts[numOccupancyContexts+i][residual];
+				predicted[i]=(*lcIt)[i];
+				}
+		}
+	
+	/* Merge the subtree's symbol counts into the frame's: */
+	{
+	Threads::Mutex::Lock countLock(countMutex);
+	for(unsigned int table=0;table<numOccupancyContexts+numColorTables;++table)
+		for(unsigned int i=0;i<RansCoder::maxNumSymbols;++i)
+			counts[table][i]+=localCounts[table][i];
+	numVoxels+=leaves.size();
+	}
+	}
+
+void OctreePointCloudWriter::encodeSymbols(OctreePointCloudWriter::Subtree& subtree)
+	{
+	/* Encode the symbol sequence in reverse order: */
+	subtree.codeBuffer.resize(RansCoder::Encoder::getMaxSize(subtree.symbols.size()));
+	RansCoder::Encoder encoder(&subtree.codeBuffer[0]+subtree.codeBuffer.size());
+	for(size_t i=subtree.symbols.size();i>0;--i)
+		{
+		Misc::UInt16 symbol=subtree.symbols[i-1];
+		encoder.encode((i-1)&(RansCoder::numStates-1),tables[symbol>>8].getEncodeSymbol(symbol&0xffU));
+		}
+	subtree.codeSize=encoder.finish();
+	subtree.code=encoder.getData();
+	}
+
+void OctreePointCloudWriter::processJob(unsigned int jobIndex)
+	{
+	/* Process the subtree: */
+	if(pass==0)
+		buildSymbols(*jobs[jobIndex]);
+	else
+		encodeSymbols(*jobs[jobIndex]);
+	}
+
+void OctreePointCloudWriter::runPass(int newPass)
+	{
+	/* Process all subtrees of the pass in parallel: */
+	pass=newPass;
+	jobPool.run((unsigned int)(jobs.size()),Misc::VoidMethodCall<unsigned int,OctreePointCloudWriter>(this,&OctreePointCloudWriter::processJob));
+	}
+
+OctreePointCloudWriter::OctreePointCloudWriter(IO::File& sSink,const OctreePointCloudWriter::Point& sOrigin,OctreePointCloudWriter::Scalar sCubeSize,unsigned int sNumLevels,bool sColors,unsigned int numThreads)
+	:sink(sSink),
+	 origin(sOrigin),cubeSize(sCubeSize),colors(sColors),
+	 streamNumLevels(sNumLevels),minNumLevels(sNumLevels),numLevels(sNumLevels),maxFrameSize(0),
+	 tables(numOccupancyContexts+numColorTables,RansCoder::FrequencyTable(RansCoder::maxNumSymbols)),
+	 subtrees(size_t(1)<<(3*subtreeLevel)),
+	 splitLevel(0),numVoxels(0),
+	 pass(0),
+	 jobPool(numThreads)
+	{
+	/* Check the stream parameters: */
+	if(streamNumLevels<1||streamNumLevels>maxNumLevels)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Octree depth %u out of range [1, %u]",streamNumLevels,maxNumLevels);
+	if(!(cubeSize>Scalar(0)))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid bounding cube size");
+	
+	/* Write the versioned octree stream header: */
+	Misc::UInt32 fv=formatVersion;
+	sink.write<Misc::UInt32>(fv);
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::numStates));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::scaleBits));
+	for(int i=0;i<3;++i)
+		sink.write<Misc::Float32>(Misc::Float32(origin[i]));
+	sink.write<Misc::Float32>(Misc::Float32(cubeSize));
+	sink.write<Misc::UInt8>(Misc::UInt8(streamNumLevels));
+	sink.write<Misc::UInt8>(Misc::UInt8(subtreeLevel));
+	sink.write<Misc::UInt8>(colors?Misc::UInt8(1):Misc::UInt8(0));
+	}
+
+OctreePointCloudWriter::~OctreePointCloudWriter(void)
+	{
+	}
+
+void OctreePointCloudWriter::setMaxFrameSize(size_t newMaxFrameSize,unsigned int newMinNumLevels)
+	{
+	maxFrameSize=newMaxFrameSize;
+	minNumLevels=newMinNumLevels<1?1:newMinNumLevels>streamNumLevels?streamNumLevels:newMinNumLevels;
+	
+	/* Clamp the current octree depth to the new range: */
+	if(maxFrameSize==0||numLevels>streamNumLevels)
+		numLevels=streamNumLevels;
+	if(numLevels<minNumLevels)
+		numLevels=minNumLevels;
+	}
+
+size_t OctreePointCloudWriter::writeFrame(const PointCloud& cloud)
+	{
+	if(colors&&cloud.colors.size()!=cloud.points.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Point cloud does not have per-point colors");
+	
+	/* Split the octree into subtrees below the top levels: */
+	splitLevel=numLevels<subtreeLevel?numLevels:subtreeLevel;
+	unsigned int subtreeShift=3*(numLevels-splitLevel);
+	
+	/* Quantize all points inside the bounding cube and sort them into their subtrees: */
+	Scalar scale=Scalar(Misc::UInt64(1)<<numLevels)/cubeSize;
+	Misc::UInt64 gridSize=Misc::UInt64(1)<<numLevels;
+	for(std::vector<Subtree>::iterator sIt=subtrees.begin();sIt!=subtrees.end();++sIt)
+		sIt->voxels.clear();
+	for(size_t i=0;i<cloud.points.size();++i)
+		{
+		/* Calculate the point's voxel index and drop points outside the cube: */
+		Misc::UInt64 coords[3];
+		bool inside=true;
+		for(int j=0;j<3&&inside;++j)
+			{
+			Scalar c=(cloud.points[i][j]-origin[j])*scale;
+			inside=c>=Scalar(0)&&c<Scalar(gridSize);
+			coords[j]=inside?Misc::UInt64(c):0;
+			}
+		if(!inside)
+			continue;
+		
+		Voxel voxel;
+		voxel.code=spreadBits(coords[0])|(spreadBits(coords[1])<<1)|(spreadBits(coords[2])<<2);
+		if(colors)
+			voxel.color=cloud.colors[i];
+		subtrees[voxel.code>>subtreeShift].voxels.push_back(voxel);
+		}
+	
+	/* Collect the non-empty subtrees in Morton order: */
+	std::vector<Subtree*> newJobs;
+	std::vector<Misc::UInt64> topNodes;
+	for(size_t i=0;i<subtrees.size();++i)
+		if(!subtrees[i].voxels.empty())
+			{
+			subtrees[i].prefix=i;
+			newJobs.push_back(&subtrees[i]);
+			topNodes.push_back(i);
+			}
+	jobs.swap(newJobs);
+	
+	/* Build the top levels of the octree above the subtrees: */
+	std::vector<std::vector<Misc::UInt64> > topLevelNodes(splitLevel+1);
+	std::vector<std::vector<Misc::UInt8> > topLevelOccupancies(splitLevel);
+	topLevelNodes[splitLevel]=topNodes;
+	for(unsigned int level=splitLevel;level>0;--level)
+		buildParents(topLevelNodes[level],topLevelNodes[level-1],topLevelOccupancies[level-1]);
+	if(splitLevel>0)
+		{
+		/* Assign each subtree root its parent's occupancy mask: */
+		size_t parentIndex=0;
+		for(std::vector<Subtree*>::iterator jIt=jobs.begin();jIt!=jobs.end();++jIt)
+			{
+			while(topLevelNodes[splitLevel-1][parentIndex]!=((*jIt)->prefix>>3))
+				++parentIndex;
+			(*jIt)->parentOccupancy=topLevelOccupancies[splitLevel-1][parentIndex];
+			}
+		}
+	
+	/* Convert all subtrees to symbols in parallel: */
+	for(unsigned int table=0;table<numOccupancyContexts+numColorTables;++table)
+		for(unsigned int i=0;i<RansCoder::maxNumSymbols;++i)
+			counts[table][i]=0;
+	numVoxels=0;
+	runPass(0);
+	
+	/* Write the frame header to the sink: */
+	size_t result=0;
+	sink.write<Misc::Float64>(cloud.timeStamp);
+	sink.write<Misc::UInt8>(Misc::UInt8(numLevels));
+	sink.write<Misc::UInt32>(Misc::UInt32(numVoxels));
+	result+=sizeof(Misc::Float64)+sizeof(Misc::UInt8)+sizeof(Misc::UInt32);
+	
+	if(numVoxels>0)
+		{
+		/* Create the frame's frequency tables and write them to the sink: */
+		unsigned int numTables=colors?numOccupancyContexts+numColorTables:numOccupancyContexts;
+		for(unsigned int table=0;table<numTables;++table)
+			{
+			tables[table].setCounts(counts[table]);
+			result+=tables[table].write(sink);
+			}
+		
+		/* Encode all subtrees in parallel: */
+		runPass(1);
+		
+		/* Write the top levels' occupancy masks in breadth-first order: */
+		for(unsigned int level=0;level<splitLevel;++level)
+			for(std::vector<Misc::UInt8>::iterator oIt=topLevelOccupancies[level].begin();oIt!=topLevelOccupancies[level].end();++oIt)
+				{
+				sink.write<Misc::UInt8>(*oIt);
+				++result;
+				}
+		
+		/* Write the encoded subtrees to the sink: */
+		for(std::vector<Subtree*>::iterator jIt=jobs.begin();jIt!=jobs.end();++jIt)
+			sink.write<Misc::UInt32>(Misc::UInt32((*jIt)->codeSize));
+		result+=jobs.size()*sizeof(Misc::UInt32);
+		for(std::vector<Subtree*>::iterator jIt=jobs.begin();jIt!=jobs.end();++jIt)
+			{
+			sink.write((*jIt)->code,(*jIt)->codeSize);
+			result+=(*jIt)->codeSize;
+			}
+		}
+	
+	if(maxFrameSize>0)
+		{
+		/* Adjust the octree depth for the next frame; one more level roughly quadruples the number of voxels on surfaces: */
+		if(result>maxFrameSize&&numLevels>minNumLevels)
+			--numLevels;
+		else if(result*4<maxFrameSize&&numLevels<streamNumLevels)
+			++numLevels;
+		}
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,139 @@
+/***********************************************************************
+OctreePointCloudWriter - Class to compress a stream of fused world-space
+point clouds by quantizing them into voxel octrees and entropy-coding
+the octrees' node occupancy with context-modeled rANS coding. Streams
+are written to files; KinectServer does not serve them to clients.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_OCTREEPOINTCLOUDWRITER_INCLUDED
+#define KINECT_OCTREEPOINTCLOUDWRITER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/Mutex.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/PointCloud.h>
+#include <Kinect/ParallelJobPool.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class OctreePointCloudWriter
+	{
+	/* Embedded classes: */
+	public:
+	typedef PointCloud::Scalar Scalar; // Scalar type for world space
+	typedef PointCloud::Point Point; // Type for points in world space
+	
+	/* Stream format constants shared with OctreePointCloudReader: */
+	static const Misc::UInt32 formatVersion=1; // Version number of the octree point cloud stream format
+	static const unsigned int maxNumLevels=21; // Maximum octree depth, such that voxel Morton codes fit into 64 bits
+	static const unsigned int subtreeLevel=2; // Octree level at which frames are split into independently coded subtrees
+	static const unsigned int numOccupancyContexts=8; // Number of occupancy frequency tables, selected by the number of occupied siblings of a node
+	static const unsigned int numColorTables=3; // Number of color residual frequency tables, one per color component
+	
+	private:
+	struct Voxel // Structure for quantized points
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 code; // Morton code of the voxel containing the point
+		PointCloud::Color color; // Point's color
+		
+		/* Methods: */
+		bool operator<(const Voxel& other) const // Orders voxels by Morton code
+			{
+			return code<other.code;
+			}
+		};
+	
+	struct Subtree // Structure holding the coding state of one octree subtree
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 prefix; // Morton code prefix of the subtree's root node
+		unsigned int parentOccupancy; // Occupancy mask of the subtree root's parent node
+		std::vector<Voxel> voxels; // Quantized points inside the subtree
+		std::vector<Misc::UInt16> symbols; // Tagged symbols encoding the subtree
+		std::vector<Misc::UInt8> codeBuffer; // Buffer receiving the encoded subtree
+		const Misc::UInt8* code; // Start of the encoded subtree inside the code buffer
+		size_t codeSize; // Size of the encoded subtree
+		};
+	
+	/* Elements: */
+	IO::File& sink; // Data sink for the compressed point cloud stream
+	Point origin; // Minimum corner of the cube enclosing all encoded points
+	Scalar cubeSize; // Edge length of the cube enclosing all encoded points
+	bool colors; // Flag whether per-point colors are encoded
+	unsigned int streamNumLevels; // Maximum octree depth of the stream
+	unsigned int minNumLevels; // Minimum octree depth selectable by rate control
+	unsigned int numLevels; // Octree depth used for the next frame
+	size_t maxFrameSize; // Target maximum size of an encoded frame in bytes, or 0 to disable rate control
+	std::vector<RansCoder::FrequencyTable> tables; // Per-frame occupancy and color residual frequency tables
+	std::vector<Subtree> subtrees; // Coding state of all possible subtrees, indexed by their roots' Morton code prefixes
+	std::vector<Subtree*> jobs; // Non-empty subtrees of the current frame in Morton order
+	unsigned int splitLevel; // Level at which the current frame is split into subtrees
+	Threads::Mutex countMutex; // Mutex protecting the frame's symbol and voxel counts
+	size_t counts[numOccupancyContexts+numColorTables][RansCoder::maxNumSymbols]; // Symbol counts of the current frame
+	size_t numVoxels; // Number of occupied voxels in the current frame
+	int pass; // Current processing pass; 0: build and count symbols, 1: encode symbols
+	ParallelJobPool jobPool; // Pool of threads processing the subtrees of the current frame
+	
+	/* Private methods: */
+	void buildSymbols(Subtree& subtree); // Converts a subtree's quantized points into a sequence of tagged symbols and accumulates symbol counts
+	void encodeSymbols(Subtree& subtree); // Entropy-codes a subtree's tagged symbols
+	void processJob(unsigned int jobIndex); // Processes the subtree job of the given index in the current pass
+	void runPass(int newPass); // Processes all subtrees of the current frame in the given pass using all threads
+	
+	/* Constructors and destructors: */
+	public:
+	OctreePointCloudWriter(IO::File& sSink,const Point& sOrigin,Scalar sCubeSize,unsigned int sNumLevels,bool sColors,unsigned int numThreads =2); // Creates a writer for the given sink, encoding points inside the given cube at the given maximum octree depth, with or without per-point colors, using the given total number of threads
+	private:
+	OctreePointCloudWriter(const OctreePointCloudWriter& source); // Prohibit copy constructor
+	OctreePointCloudWriter& operator=(const OctreePointCloudWriter& source); // Prohibit assignment operator
+	public:
+	~OctreePointCloudWriter(void);
+	
+	/* Methods: */
+	unsigned int getNumLevels(void) const // Returns the octree depth that will be used for the next frame
+		{
+		return numLevels;
+		}
+	Scalar getVoxelSize(void) const // Returns the voxel size that will be used for the next frame
+		{
+		return cubeSize/Scalar(Misc::UInt64(1)<<numLevels);
+		}
+	size_t getNumVoxels(void) const // Returns the number of occupied voxels in the most recently written frame
+		{
+		return numVoxels;
+		}
+	void setMaxFrameSize(size_t newMaxFrameSize,unsigned int newMinNumLevels =6); // Enables rate control adjusting the octree depth between the given minimum and the stream's maximum depth to keep encoded frames below the given size in bytes; disables rate control and returns to the maximum depth if size is 0
+	size_t writeFrame(const PointCloud& cloud); // Writes the given point cloud to the sink; returns the number of bytes written
+	};
+
+}
+
+#endif
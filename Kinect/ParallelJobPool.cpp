@@ -0,0 +1,156 @@
+/***********************************************************************
+ParallelJobPool - Class to process batches of independent, indexed jobs
+using the caller's thread and a pool of persistent worker threads.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/ParallelJobPool.h>
+
+#include <stdexcept>
+#include <Misc/StdError.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class ParallelJobPool:
+********************************/
+
+void ParallelJobPool::processJobs(void)
+	{
+	while(true)
+		{
+		/* Grab the next unprocessed job: */
+		const JobFunction* function;
+		unsigned int jobIndex;
+		{
+		Threads::MutexCond::Lock jobLock(jobCond);
+		if(nextJob>=numJobs)
+			break;
+		function=jobFunction;
+		jobIndex=nextJob;
+		++nextJob;
+		}
+		
+		/* Process the job: */
+		std::string error;
+		try
+			{
+			(*function)(jobIndex);
+			}
+		catch(const std::runtime_error& err)
+			{
+			error=err.what();
+			}
+		
+		/* Mark the job as finished: */
+		{
+		Threads::MutexCond::Lock jobLock(jobCond);
+		if(!error.empty()&&jobError.empty())
+			jobError=error;
+		if(--numPendingJobs==0)
+			jobCond.broadcast();
+		}
+		}
+	}
+
+void* ParallelJobPool::workerThreadMethod(void)
+	{
+	unsigned int lastGeneration=0;
+	while(true)
+		{
+		/* Wait for the next batch of jobs: */
+		{
+		Threads::MutexCond::Lock jobLock(jobCond);
+		while(!shutdown&&generation==lastGeneration)
+			jobCond.wait(jobLock);
+		if(shutdown)
+			break;
+		lastGeneration=generation;
+		}
+		
+		/* Process jobs from the batch: */
+		processJobs();
+		}
+	
+	return 0;
+	}
+
+ParallelJobPool::ParallelJobPool(unsigned int numThreads)
+	:jobFunction(0),
+	 generation(0),numJobs(0),nextJob(0),numPendingJobs(0),
+	 shutdown(false),
+	 numWorkerThreads(numThreads>1?numThreads-1:0),workerThreads(0)
+	{
+	/* Start the worker threads: */
+	if(numWorkerThreads>0)
+		{
+		workerThreads=new Threads::Thread[numWorkerThreads];
+		for(unsigned int i=0;i<numWorkerThreads;++i)
+			workerThreads[i].start(this,&ParallelJobPool::workerThreadMethod);
+		}
+	}
+
+ParallelJobPool::~ParallelJobPool(void)
+	{
+	/* Shut down the worker threads: */
+	{
+	Threads::MutexCond::Lock jobLock(jobCond);
+	shutdown=true;
+	jobCond.broadcast();
+	}
+	for(unsigned int i=0;i<numWorkerThreads;++i)
+		workerThreads[i].join();
+	delete[] workerThreads;
+	}
+
+void ParallelJobPool::run(unsigned int newNumJobs,const ParallelJobPool::JobFunction& newJobFunction)
+	{
+	/* Start a new batch of jobs and wake up the worker threads: */
+	{
+	Threads::MutexCond::Lock jobLock(jobCond);
+	jobFunction=&newJobFunction;
+	numJobs=newNumJobs;
+	nextJob=0;
+	numPendingJobs=newNumJobs;
+	jobError.clear();
+	++generation;
+	jobCond.broadcast();
+	}
+	
+	/* Help processing jobs: */
+	processJobs();
+	
+	/* Wait until all jobs are finished: */
+	{
+	Threads::MutexCond::Lock jobLock(jobCond);
+	while(numPendingJobs>0)
+		jobCond.wait(jobLock);
+	
+	/* Retire the batch such that late worker threads do not find any jobs or a stale job function: */
+	numJobs=0;
+	jobFunction=0;
+	}
+	
+	/* Check if any job failed: */
+	if(!jobError.empty())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"%s",jobError.c_str());
+	}
+
+}
@@ -0,0 +1,76 @@
+/***********************************************************************
+ParallelJobPool - Class to process batches of independent, indexed jobs
+using the caller's thread and a pool of persistent worker threads.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_PARALLELJOBPOOL_INCLUDED
+#define KINECT_PARALLELJOBPOOL_INCLUDED
+
+#include <string>
+#include <Misc/FunctionCalls.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+
+namespace Kinect {
+
+class ParallelJobPool
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::FunctionCall<unsigned int> JobFunction; // Type for functions processing the job of the given index in the current batch
+	
+	/* Elements: */
+	private:
+	Threads::MutexCond jobCond; // Condition variable protecting the job processing state
+	const JobFunction* jobFunction; // Function processing jobs of the current batch
+	unsigned int generation; // Counter incremented for each new batch of jobs
+	unsigned int numJobs; // Number of jobs in the current batch
+	unsigned int nextJob; // Index of the next unprocessed job in the current batch
+	unsigned int numPendingJobs; // Number of jobs in the current batch that are not finished yet
+	std::string jobError; // Error message from the first job in the current batch that failed
+	bool shutdown; // Flag to shut down the worker threads
+	unsigned int numWorkerThreads; // Number of worker threads supporting the caller's thread
+	Threads::Thread* workerThreads; // Array of worker threads
+	
+	/* Private methods: */
+	void processJobs(void); // Processes jobs from the current batch until none are left
+	void* workerThreadMethod(void); // Thread method for worker threads
+	
+	/* Constructors and destructors: */
+	public:
+	ParallelJobPool(unsigned int numThreads); // Creates a pool using the given total number of threads, including the caller's
+	private:
+	ParallelJobPool(const ParallelJobPool& source); // Prohibit copy constructor
+	ParallelJobPool& operator=(const ParallelJobPool& source); // Prohibit assignment operator
+	public:
+	~ParallelJobPool(void);
+	
+	/* Methods: */
+	unsigned int getNumThreads(void) const // Returns the total number of threads processing jobs, including the caller's
+		{
+		return numWorkerThreads+1;
+		}
+	void run(unsigned int newNumJobs,const JobFunction& newJobFunction); // Calls the given function for job indices 0 to newNumJobs-1 in parallel and returns when all jobs are finished; throws exception if any job threw; must not be called concurrently
+	};
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+/***********************************************************************
+PointCloud - Structure to represent a set of world-space points with
+optional per-point colors, fused from the depth and color frames of one
+or more cameras at a single point in time.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_POINTCLOUD_INCLUDED
+#define KINECT_POINTCLOUD_INCLUDED
+
+#include <vector>
+#include <Geometry/Point.h>
+#include <Kinect/FrameSource.h>
+
+namespace Kinect {
+
+struct PointCloud
+	{
+	/* Embedded classes: */
+	public:
+	typedef float Scalar; // Scalar type for world space
+	typedef Geometry::Point<Scalar,3> Point; // Type for points in world space
+	typedef FrameSource::ColorPixel Color; // Type for per-point colors
+	
+	/* Elements: */
+	double timeStamp; // Time stamp of the point cloud
+	std::vector<Point> points; // List of points in world space
+	std::vector<Color> colors; // List of per-point colors in the color space of the originating frame sources; either empty or of the same size as the point list
+	
+	/* Constructors and destructors: */
+	PointCloud(void) // Creates an empty point cloud
+		:timeStamp(0.0)
+		{
+		}
+	
+	/* Methods: */
+	bool hasColors(void) const // Returns true if the point cloud has per-point colors
+		{
+		return !colors.empty();
+		}
+	void clear(void) // Removes all points from the point cloud
+		{
+		points.clear();
+		colors.clear();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+/***********************************************************************
+PointCloudFuser - Class to convert depth frames and optional registered
+color frames from one or more calibrated cameras into a single
+world-space point cloud.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/PointCloudFuser.h>
+
+#include <Misc/StdError.h>
+#include <Math/Math.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/PointCloud.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class PointCloudFuser:
+********************************/
+
+void PointCloudFuser::addPoints(unsigned int cameraIndex,const FrameBuffer& depthFrame,const FrameBuffer* colorFrame,PointCloud& cloud) const
+	{
+	if(cameraIndex>=cameras.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid camera index %u",cameraIndex);
+	const Camera& camera=*cameras[cameraIndex];
+	const ProjectorBase& projector=camera.projector;
+	typedef ProjectorBase::Point Point;
+	typedef Point::Scalar Scalar;
+	
+	/* Check that the depth frame and the point cloud match the camera and the request: */
+	const Size& depthSize=projector.getDepthFrameSize();
+	if(depthFrame.getSize(0)!=depthSize[0]||depthFrame.getSize(1)!=depthSize[1])
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Depth frame size does not match camera %u",cameraIndex);
+	if(colorFrame!=0&&cloud.colors.size()!=cloud.points.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Cannot add colored points to an uncolored point cloud");
+	
+	/* Access the color frame if there is one: */
+	const FrameSource::ColorPixel* colors=colorFrame!=0?colorFrame->getData<FrameSource::ColorPixel>():0;
+	int colorWidth=colorFrame!=0?int(colorFrame->getSize(0)):0;
+	int colorHeight=colorFrame!=0?int(colorFrame->getSize(1)):0;
+	const FrameSource::IntrinsicParameters::PTransform& colorProjection=projector.getIntrinsicParameters().colorProjection;
+	
+	/* Unproject all valid depth pixels: */
+	const FrameSource::DepthPixel* dPtr=depthFrame.getData<FrameSource::DepthPixel>();
+	const FrameSource::DepthCorrection::PixelCorrection* dcPtr=projector.getDepthCorrection();
+	const FrameSource::IntrinsicParameters::Point2* pcPtr=camera.pixelCenters.empty()?0:&camera.pixelCenters[0];
+	unsigned int index=0;
+	for(unsigned int y=0;y<depthSize[1];++y)
+		for(unsigned int x=0;x<depthSize[0];++x,++index)
+			{
+			/* Skip invalid pixels, which do not generate triangles either: */
+			if(dPtr[index]>=FrameSource::invalidDepth-1U)
+				continue;
+			
+			/* Calculate the pixel's position in depth image space: */
+			Point dip;
+			if(pcPtr!=0)
+				{
+				dip[0]=Scalar(pcPtr[index][0]);
+				dip[1]=Scalar(pcPtr[index][1]);
+				}
+			else
+				{
+				dip[0]=Scalar(x)+Scalar(0.5);
+				dip[1]=Scalar(y)+Scalar(0.5);
+				}
+			dip[2]=dcPtr!=0?Scalar(dcPtr[index].correct(float(dPtr[index]))):Scalar(dPtr[index]);
+			
+			/* Transform the pixel to world space: */
+			cloud.points.push_back(PointCloud::Point(projector.worldDepthProjection.transform(dip)));
+			
+			if(colors!=0)
+				{
+				/* Project the pixel into normalized color image space and look up its color: */
+				Point ci=colorProjection.transform(dip);
+				int cx=int(Math::floor(ci[0]*Scalar(colorWidth)));
+				int cy=int(Math::floor(ci[1]*Scalar(colorHeight)));
+				cx=cx<0?0:cx>=colorWidth?colorWidth-1:cx;
+				cy=cy<0?0:cy>=colorHeight?colorHeight-1:cy;
+				cloud.colors.push_back(colors[cy*colorWidth+cx]);
+				}
+			}
+	}
+
+PointCloudFuser::PointCloudFuser(void)
+	{
+	}
+
+PointCloudFuser::~PointCloudFuser(void)
+	{
+	for(std::vector<Camera*>::iterator cIt=cameras.begin();cIt!=cameras.end();++cIt)
+		delete *cIt;
+	}
+
+unsigned int PointCloudFuser::addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps)
+	{
+	/* Initialize the new camera's projector: */
+	Camera* camera=new Camera;
+	camera->projector.setDepthFrameSize(depthSize);
+	camera->projector.setDepthCorrection(depthCorrection);
+	camera->projector.setIntrinsicParameters(ips);
+	camera->projector.setExtrinsicParameters(eps);
+	
+	/* Pre-compute undistorted pixel centers if the camera has lens distortion: */
+	if(!ips.depthLensDistortion.isIdentity())
+		{
+		camera->pixelCenters.reserve(depthSize.volume());
+		for(unsigned int y=0;y<depthSize[1];++y)
+			for(unsigned int x=0;x<depthSize[0];++x)
+				camera->pixelCenters.push_back(ips.undistortDepthPixel(x,y));
+		}
+	
+	cameras.push_back(camera);
+	return cameras.size()-1;
+	}
+
+unsigned int PointCloudFuser::addCamera(FrameSource& frameSource)
+	{
+	/* Query the frame source's calibration parameters: */
+	FrameSource::DepthCorrection* depthCorrection=frameSource.getDepthCorrectionParameters();
+	unsigned int result=addCamera(frameSource.getActualFrameSize(FrameSource::DEPTH),depthCorrection,frameSource.getIntrinsicParameters(),frameSource.getExtrinsicParameters());
+	delete depthCorrection;
+	
+	return result;
+	}
+
+}
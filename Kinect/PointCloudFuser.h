@@ -0,0 +1,87 @@
+/***********************************************************************
+PointCloudFuser - Class to convert depth frames and optional registered
+color frames from one or more calibrated cameras into a single
+world-space point cloud.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_POINTCLOUDFUSER_INCLUDED
+#define KINECT_POINTCLOUDFUSER_INCLUDED
+
+#include <vector>
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ProjectorBase.h>
+
+/* Forward declarations: */
+namespace Kinect {
+class FrameBuffer;
+struct PointCloud;
+}
+
+namespace Kinect {
+
+class PointCloudFuser
+	{
+	/* Embedded classes: */
+	private:
+	struct Camera // Structure holding per-camera unprojection state
+		{
+		/* Elements: */
+		public:
+		ProjectorBase projector; // Projector holding the camera's intrinsic and extrinsic parameters and per-pixel depth correction
+		std::vector<FrameSource::IntrinsicParameters::Point2> pixelCenters; // Undistorted depth image-space pixel centers if the camera has lens distortion; empty otherwise
+		};
+	
+	/* Elements: */
+	std::vector<Camera*> cameras; // List of cameras feeding the fuser
+	
+	/* Private methods: */
+	void addPoints(unsigned int cameraIndex,const FrameBuffer& depthFrame,const FrameBuffer* colorFrame,PointCloud& cloud) const; // Appends the valid pixels of the given depth frame and optional color frame to the given point cloud
+	
+	/* Constructors and destructors: */
+	public:
+	PointCloudFuser(void); // Creates a point cloud fuser without cameras
+	private:
+	PointCloudFuser(const PointCloudFuser& source); // Prohibit copy constructor
+	PointCloudFuser& operator=(const PointCloudFuser& source); // Prohibit assignment operator
+	public:
+	~PointCloudFuser(void);
+	
+	/* Methods: */
+	unsigned int addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps); // Adds a camera with the given depth frame size and calibration parameters; returns the camera's index
+	unsigned int addCamera(FrameSource& frameSource); // Adds a camera using the given frame source's calibration parameters; returns the camera's index
+	unsigned int getNumCameras(void) const // Returns the number of cameras feeding the fuser
+		{
+		return cameras.size();
+		}
+	void addDepthFrame(unsigned int cameraIndex,const FrameBuffer& depthFrame,PointCloud& cloud) const // Appends the valid pixels of the given camera's depth frame to the given uncolored point cloud
+		{
+		addPoints(cameraIndex,depthFrame,0,cloud);
+		}
+	void addFrames(unsigned int cameraIndex,const FrameBuffer& depthFrame,const FrameBuffer& colorFrame,PointCloud& cloud) const // Appends the valid pixels of the given camera's depth frame, colored by the given registered color frame, to the given colored point cloud
+		{
+		addPoints(cameraIndex,depthFrame,&colorFrame,cloud);
+		}
+	};
+
+}
+
+#endif
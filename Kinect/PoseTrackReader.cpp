@@ -0,0 +1,136 @@
+/***********************************************************************
+PoseTrackReader - Class to read a time-stamped stream of camera poses
+written by PoseTrackWriter, and to interpolate camera poses at the time
+stamps of recorded color or depth frames.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/PoseTrackReader.h>
+
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class PoseTrackReader:
+********************************/
+
+void PoseTrackReader::readSamples(IO::File& file)
+	{
+	/* Read and check the file format version number: */
+	file.setEndianness(Misc::LittleEndian);
+	unsigned int formatVersion=file.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>PoseTrackWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported pose track file format version %u",formatVersion);
+	
+	/* Read all pose samples: */
+	while(!file.eof())
+		{
+		Sample s;
+		s.timeStamp=file.read<Misc::Float64>();
+		Pose::Vector t;
+		for(int i=0;i<3;++i)
+			t[i]=file.read<Misc::Float32>();
+		double q[4];
+		for(int i=0;i<4;++i)
+			q[i]=file.read<Misc::Float32>();
+		
+		/* Re-normalize the quaternion after its round trip through single precision: */
+		double qLen=Math::sqrt(q[0]*q[0]+q[1]*q[1]+q[2]*q[2]+q[3]*q[3]);
+		s.pose=Pose(t,Pose::Rotation::fromQuaternion(q[0]/qLen,q[1]/qLen,q[2]/qLen,q[3]/qLen));
+		
+		if(!samples.empty()&&s.timeStamp<=samples.back().timeStamp)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Pose samples are not in increasing time stamp order");
+		samples.push_back(s);
+		}
+	}
+
+PoseTrackReader::PoseTrackReader(const char* fileName)
+	{
+	/* Open the pose track file and read its samples: */
+	IO::FilePtr file=IO::openFile(fileName);
+	readSamples(*file);
+	}
+
+PoseTrackReader::PoseTrackReader(IO::File& file)
+	{
+	readSamples(file);
+	}
+
+PoseTrackReader::Pose PoseTrackReader::getPose(double timeStamp) const
+	{
+	/* Handle the boundary cases: */
+	if(samples.empty())
+		return Pose::identity;
+	if(timeStamp<=samples.front().timeStamp)
+		return samples.front().pose;
+	if(timeStamp>=samples.back().timeStamp)
+		return samples.back().pose;
+	
+	/* Find the pair of samples bracketing the given time stamp: */
+	size_t l=0;
+	size_t r=samples.size()-1;
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(samples[m].timeStamp<=timeStamp)
+			l=m;
+		else
+			r=m;
+		}
+	const Sample& s0=samples[l];
+	const Sample& s1=samples[r];
+	double w=(timeStamp-s0.timeStamp)/(s1.timeStamp-s0.timeStamp);
+	
+	/* Interpolate the translation linearly: */
+	Pose::Vector t=s0.pose.getTranslation()*(1.0-w)+s1.pose.getTranslation()*w;
+	
+	/* Interpolate the rotation spherically along the shorter arc: */
+	const double* q0=s0.pose.getRotation().getQuaternion();
+	const double* q1=s1.pose.getRotation().getQuaternion();
+	double d=q0[0]*q1[0]+q0[1]*q1[1]+q0[2]*q1[2]+q0[3]*q1[3];
+	double sign=1.0;
+	if(d<0.0)
+		{
+		d=-d;
+		sign=-1.0;
+		}
+	double w0=1.0-w;
+	double w1=w;
+	if(d<0.9995)
+		{
+		double theta=Math::acos(d);
+		double sinTheta=Math::sin(theta);
+		w0=Math::sin((1.0-w)*theta)/sinTheta;
+		w1=Math::sin(w*theta)/sinTheta;
+		}
+	double q[4];
+	for(int i=0;i<4;++i)
+		q[i]=w0*q0[i]+sign*w1*q1[i];
+	double qLen=Math::sqrt(q[0]*q[0]+q[1]*q[1]+q[2]*q[2]+q[3]*q[3]);
+	
+	return Pose(t,Pose::Rotation::fromQuaternion(q[0]/qLen,q[1]/qLen,q[2]/qLen,q[3]/qLen));
+	}
+
+}
@@ -0,0 +1,83 @@
+/***********************************************************************
+PoseTrackReader - Class to read a time-stamped stream of camera poses
+written by PoseTrackWriter, and to interpolate camera poses at the time
+stamps of recorded color or depth frames.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_POSETRACKREADER_INCLUDED
+#define KINECT_POSETRACKREADER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Kinect/PoseTrackWriter.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class PoseTrackReader
+	{
+	/* Embedded classes: */
+	public:
+	typedef PoseTrackWriter::Pose Pose; // Type for camera poses
+	
+	private:
+	struct Sample // Structure for time-stamped pose samples
+		{
+		/* Elements: */
+		public:
+		double timeStamp; // Time stamp at which the pose was sampled
+		Pose pose; // Sampled pose
+		};
+	
+	/* Elements: */
+	std::vector<Sample> samples; // List of pose samples in increasing time stamp order
+	
+	/* Private methods: */
+	void readSamples(IO::File& file); // Reads all pose samples from the given pose track file
+	
+	/* Constructors and destructors: */
+	public:
+	PoseTrackReader(const char* fileName); // Reads the pose track file of the given name
+	PoseTrackReader(IO::File& file); // Ditto, from the already opened file
+	
+	/* Methods: */
+	size_t getNumSamples(void) const // Returns the number of pose samples in the track
+		{
+		return samples.size();
+		}
+	double getFirstTimeStamp(void) const // Returns the time stamp of the first pose sample; track must not be empty
+		{
+		return samples.front().timeStamp;
+		}
+	double getLastTimeStamp(void) const // Returns the time stamp of the last pose sample; track must not be empty
+		{
+		return samples.back().timeStamp;
+		}
+	Pose getPose(double timeStamp) const; // Returns the pose at the given time stamp, interpolated between the bracketing samples and clamped to the track's time range; returns the identity if the track is empty
+	};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+/***********************************************************************
+PoseTrackWriter - Class to write a time-stamped stream of camera poses
+sampled from a tracking system alongside recorded color and depth
+streams, to replay tracked captures without the tracking system.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/PoseTrackWriter.h>
+
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+
+namespace Kinect {
+
+/********************************
+Methods of class PoseTrackWriter:
+********************************/
+
+void PoseTrackWriter::writeHeader(void)
+	{
+	/* Write the file format version number: */
+	file->setEndianness(Misc::LittleEndian);
+	Misc::UInt32 fv=formatVersion;
+	file->write<Misc::UInt32>(fv);
+	}
+
+PoseTrackWriter::PoseTrackWriter(const char* fileName)
+	:file(IO::openFile(fileName,IO::File::WriteOnly)),
+	 timeStampOffset(0.0),lastTimeStamp(-Math::Constants<double>::max),numSamples(0)
+	{
+	writeHeader();
+	}
+
+PoseTrackWriter::PoseTrackWriter(IO::FilePtr sFile)
+	:file(sFile),
+	 timeStampOffset(0.0),lastTimeStamp(-Math::Constants<double>::max),numSamples(0)
+	{
+	writeHeader();
+	}
+
+PoseTrackWriter::~PoseTrackWriter(void)
+	{
+	}
+
+void PoseTrackWriter::setTimeStampOffset(double newTimeStampOffset)
+	{
+	/* Copy the new time stamp offset: */
+	timeStampOffset=newTimeStampOffset;
+	}
+
+void PoseTrackWriter::writePose(double timeStamp,const Pose& pose)
+	{
+	/* Ignore the sample if it is not newer than the previous one, to keep the track sorted for playback: */
+	if(timeStamp<=lastTimeStamp)
+		return;
+	lastTimeStamp=timeStamp;
+	
+	/* Write the sample's time stamp at full precision, and its translation and rotation quaternion at single precision: */
+	file->write<Misc::Float64>(timeStamp-timeStampOffset);
+	const Pose::Vector& t=pose.getTranslation();
+	for(int i=0;i<3;++i)
+		file->write<Misc::Float32>(Misc::Float32(t[i]));
+	const double* q=pose.getRotation().getQuaternion();
+	for(int i=0;i<4;++i)
+		file->write<Misc::Float32>(Misc::Float32(q[i]));
+	
+	++numSamples;
+	}
+
+}
@@ -0,0 +1,69 @@
+/***********************************************************************
+PoseTrackWriter - Class to write a time-stamped stream of camera poses
+sampled from a tracking system alongside recorded color and depth
+streams, to replay tracked captures without the tracking system.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_POSETRACKWRITER_INCLUDED
+#define KINECT_POSETRACKWRITER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <Geometry/OrthonormalTransformation.h>
+
+namespace Kinect {
+
+class PoseTrackWriter
+	{
+	/* Embedded classes: */
+	public:
+	typedef Geometry::OrthonormalTransformation<double,3> Pose; // Type for camera poses
+	static const Misc::UInt32 formatVersion=1; // Version number of the pose track file format
+	
+	/* Elements: */
+	private:
+	IO::FilePtr file; // File receiving pose samples
+	double timeStampOffset; // Offset value subtracted from the time stamps of all incoming pose samples
+	double lastTimeStamp; // Time stamp of the most recently written pose sample, before offsetting
+	size_t numSamples; // Number of pose samples written so far
+	
+	/* Private methods: */
+	void writeHeader(void); // Writes the pose track file header
+	
+	/* Constructors and destructors: */
+	public:
+	PoseTrackWriter(const char* fileName); // Creates a pose track writer for the file of the given name
+	PoseTrackWriter(IO::FilePtr sFile); // Ditto, for the already opened file
+	~PoseTrackWriter(void);
+	
+	/* Methods: */
+	void setTimeStampOffset(double newTimeStampOffset); // Sets the time stamp offset for all subsequent pose samples; must match the offset of the accompanying FrameSaver
+	size_t getNumSamples(void) const // Returns the number of pose samples written so far
+		{
+		return numSamples;
+		}
+	void writePose(double timeStamp,const Pose& pose); // Writes a pose sample taken at the given time stamp, in the time base of the recorded frames; ignores samples that are not newer than the previous sample
+	};
+
+}
+
+#endif
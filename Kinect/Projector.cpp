@@ -31,6 +31,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLContextData.h>
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLTransformationWrappers.h>
+#include <Kinect/BayerDemosaic.h>
 
 namespace Kinect {
 
@@ -208,13 +209,16 @@ void Projector::setFilterDepthFrames(bool newFilterDepthFrames,bool newLowpassDe
 	lowpassDepthFrames=newLowpassDepthFrames;
 	}
 
-void Projector::processDepthFrame(const FrameBuffer& depthFrame,MeshBuffer& meshBuffer) const
+void Projector::processDepthFrame(const FrameBuffer& rawDepthFrame,MeshBuffer& meshBuffer) const
 	{
-	/* Check if the buffer is invalid, or is still referenced by someone else: */
-	if(!meshBuffer.isValid()||!meshBuffer.isPrivate())
+	/* Invalidate flying and mixed pixels and fill small holes if requested: */
+	FrameBuffer depthFrame=fillDepthHoles(filterFlyingPixels(rawDepthFrame));
+	
+	/* Check if the buffer is invalid, is still referenced by someone else, or does not match the normal calculation setting: */
+	if(!meshBuffer.isValid()||!meshBuffer.isPrivate()||meshBuffer.hasNormals()!=computeNormals)
 		{
 		/* Create a new mesh buffer of the largest possible size: */
-		meshBuffer=MeshBuffer(depthSize.volume(),(depthSize[1]-1)*(depthSize[0]-1)*2);
+		meshBuffer=MeshBuffer(depthSize.volume(),(depthSize[1]-1)*(depthSize[0]-1)*2,computeNormals?depthSize.volume():0,MemoryAccounting::PROJECTOR);
 		
 		/* Initialize the x and y positions of all vertices: */
 		MeshBuffer::Vertex* vPtr=meshBuffer.getVertices();
@@ -556,6 +560,9 @@ void Projector::processDepthFrame(const FrameBuffer& depthFrame,MeshBuffer& mesh
 			}
 		}
 	
+	/* Calculate per-vertex normal vectors if requested: */
+	calcNormals(depthFrame,meshBuffer);
+	
 	/* Copy the depth buffer's time stamp: */
 	meshBuffer.timeStamp=depthFrame.timeStamp;
 	}
@@ -587,8 +594,11 @@ void Projector::setMesh(const MeshBuffer& newMesh)
 
 void Projector::setColorFrame(const FrameBuffer& newColorFrame)
 	{
-	/* Post the new color frame into the triple buffer: */
-	colorFrames.postNewValue(newColorFrame);
+	/* Post the new color frame into the triple buffer, demosaicing raw Bayer frames first: */
+	if(colorSpace==FrameSource::BAYER_BGGR)
+		colorFrames.postNewValue(demosaicBayerFrame(newColorFrame));
+	else
+		colorFrames.postNewValue(newColorFrame);
 	}
 
 void Projector::stopStreaming(void)
@@ -45,6 +45,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLLightTracker.h>
 #include <GL/GLTransformationWrappers.h>
 #include <Kinect/Internal/Config.h>
+#include <Kinect/BayerDemosaic.h>
 
 #if DEBUGGING
 #include <iostream>
@@ -136,8 +137,9 @@ void* Projector2::depthFrameProcessingThreadMethod(void)
 		if(filterDepthFrames)
 			{
 			const FrameSource::DepthPixel* dfPtr=rawDepthFrame.getData<FrameSource::DepthPixel>();
-			newMesh.first=FrameBuffer(depthSize,depthSize.volume()*sizeof(FrameSource::DepthPixel));
+			newMesh.first=FrameBuffer(depthSize,depthSize.volume()*sizeof(FrameSource::DepthPixel),MemoryAccounting::PROJECTOR);
 			newMesh.first.timeStamp=rawDepthFrame.timeStamp;
+			newMesh.first.metadata=rawDepthFrame.metadata;
 			FrameSource::DepthPixel* mPtr=newMesh.first.getData<FrameSource::DepthPixel>();
 			FrameSource::DepthPixel* mEnd=mPtr+depthSize.volume();
 			
@@ -342,7 +344,7 @@ void Projector2::buildRenderingShader(DataItem* dataItem,GLLightTracker* lightTr
 		fragmentShaderDeclarations+="\
 			uniform sampler2D colorSampler; // Sampler for color image texture\n";
 		
-		if(colorSpace==FrameSource::RGB)
+		if(colorSpace!=FrameSource::YPCBCR)
 			{
 			/* Add to fragment shader's main function: */
 			fragmentShaderMain+="\
@@ -638,13 +640,16 @@ void Projector2::setIlluminate(bool newIlluminate)
 	++renderingShaderSettingsVersion;
 	}
 
-void Projector2::processDepthFrame(const FrameBuffer& depthFrame,MeshBuffer& meshBuffer) const
+void Projector2::processDepthFrame(const FrameBuffer& rawDepthFrame,MeshBuffer& meshBuffer) const
 	{
-	/* Check if the buffer is invalid, or is still referenced by someone else: */
-	if(!meshBuffer.isValid()||!meshBuffer.isPrivate())
+	/* Invalidate flying and mixed pixels and fill small holes if requested: */
+	FrameBuffer depthFrame=fillDepthHoles(filterFlyingPixels(rawDepthFrame));
+	
+	/* Check if the buffer is invalid, is still referenced by someone else, or does not match the normal calculation setting: */
+	if(!meshBuffer.isValid()||!meshBuffer.isPrivate()||meshBuffer.hasNormals()!=computeNormals)
 		{
 		/* Create a new mesh buffer of the largest possible size: */
-		meshBuffer=MeshBuffer(0,(depthSize[1]-1)*(depthSize[0]-1)*2);
+		meshBuffer=MeshBuffer(0,(depthSize[1]-1)*(depthSize[0]-1)*2,computeNormals?depthSize.volume():0,MemoryAccounting::PROJECTOR);
 		meshBuffer.numVertices=0;
 		}
 	
@@ -938,6 +943,9 @@ void Projector2::processDepthFrame(const FrameBuffer& depthFrame,MeshBuffer& mes
 			}
 		}
 	
+	/* Calculate per-vertex normal vectors if requested: */
+	calcNormals(depthFrame,meshBuffer);
+	
 	/* Copy the depth buffer's time stamp: */
 	meshBuffer.timeStamp=depthFrame.timeStamp;
 	}
@@ -972,8 +980,11 @@ void Projector2::setMesh(const FrameBuffer& newDepthFrame,const MeshBuffer& newM
 
 void Projector2::setColorFrame(const FrameBuffer& newColorFrame)
 	{
-	/* Post the new color frame into the triple buffer: */
-	colorFrames.postNewValue(newColorFrame);
+	/* Post the new color frame into the triple buffer, demosaicing raw Bayer frames first: */
+	if(colorSpace==FrameSource::BAYER_BGGR)
+		colorFrames.postNewValue(demosaicBayerFrame(newColorFrame));
+	else
+		colorFrames.postNewValue(newColorFrame);
 	}
 
 void Projector2::stopStreaming(void)
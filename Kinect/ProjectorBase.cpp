@@ -25,6 +25,10 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Kinect/ProjectorBase.h>
 
 #include <Math/Math.h>
+#include <Kinect/FlyingPixelFilter.h>
+#include <Kinect/DepthHoleFiller.h>
+#include <Kinect/NormalEstimator.h>
+#include <Kinect/MeshBuffer.h>
 
 namespace Kinect {
 
@@ -35,14 +39,24 @@ Methods of class ProjectorBase:
 ProjectorBase::ProjectorBase(void)
 	:depthSize(0,0),
 	 depthCorrection(0),colorSpace(FrameSource::RGB),
-	 triangleDepthRange(5)
+	 triangleDepthRange(5),
+	 removeFlyingPixels(false),flyingPixelDepthRatio(0.04),flyingPixelCurvature(0.5),
+	 flyingPixelFilter(0),numFlyingPixels(0),
+	 fillHoles(false),maxHoleSize(8),holeDepthRatio(0.01),
+	 holeFiller(0),numFilledPixels(0),
+	 computeNormals(false),normalEstimator(0),normalEstimatorOutdated(true)
 	{
 	}
 
 ProjectorBase::ProjectorBase(FrameSource& frameSource)
 	:depthSize(frameSource.getActualFrameSize(FrameSource::DEPTH)),
 	 depthCorrection(0),colorSpace(frameSource.getColorSpace()),
-	 triangleDepthRange(5)
+	 triangleDepthRange(5),
+	 removeFlyingPixels(false),flyingPixelDepthRatio(0.04),flyingPixelCurvature(0.5),
+	 flyingPixelFilter(0),numFlyingPixels(0),
+	 fillHoles(false),maxHoleSize(8),holeDepthRatio(0.01),
+	 holeFiller(0),numFilledPixels(0),
+	 computeNormals(false),normalEstimator(0),normalEstimatorOutdated(true)
 	{
 	/* Query the source's depth correction parameters and calculate the depth correction buffer: */
 	FrameSource::DepthCorrection* dc=frameSource.getDepthCorrectionParameters();
@@ -58,14 +72,105 @@ ProjectorBase::ProjectorBase(FrameSource& frameSource)
 
 ProjectorBase::~ProjectorBase(void)
 	{
-	/* Release the depth correction buffer: */
+	/* Release the depth correction buffer, the flying pixel filter, the hole filler, and the normal estimator: */
 	delete[] depthCorrection;
+	delete flyingPixelFilter;
+	delete holeFiller;
+	delete normalEstimator;
+	}
+
+FrameBuffer ProjectorBase::filterFlyingPixels(const FrameBuffer& depthFrame) const
+	{
+	if(removeFlyingPixels)
+		{
+		/* Create the flying pixel filter if it doesn't exist yet: */
+		if(flyingPixelFilter==0)
+			flyingPixelFilter=new FlyingPixelFilter;
+		
+		/* Filter the depth frame with the current thresholds: */
+		flyingPixelFilter->setDepthRatio(flyingPixelDepthRatio);
+		flyingPixelFilter->setCurvature(flyingPixelCurvature);
+		FrameBuffer result=flyingPixelFilter->filter(depthFrame);
+		numFlyingPixels=flyingPixelFilter->getNumRejectedPixels();
+		return result;
+		}
+	else
+		{
+		/* Release the flying pixel filter if it still exists: */
+		if(flyingPixelFilter!=0)
+			{
+			delete flyingPixelFilter;
+			flyingPixelFilter=0;
+			}
+		numFlyingPixels=0;
+		
+		return depthFrame;
+		}
+	}
+
+FrameBuffer ProjectorBase::fillDepthHoles(const FrameBuffer& depthFrame) const
+	{
+	if(fillHoles)
+		{
+		/* Create the hole filler if it doesn't exist yet: */
+		if(holeFiller==0)
+			holeFiller=new DepthHoleFiller;
+		
+		/* Fill the depth frame with the current thresholds: */
+		holeFiller->setMaxHoleSize(maxHoleSize);
+		holeFiller->setDepthRatio(holeDepthRatio);
+		FrameBuffer result=holeFiller->fill(depthFrame);
+		numFilledPixels=holeFiller->getNumFilledPixels();
+		return result;
+		}
+	else
+		{
+		/* Release the hole filler if it still exists: */
+		if(holeFiller!=0)
+			{
+			delete holeFiller;
+			holeFiller=0;
+			}
+		numFilledPixels=0;
+		
+		return depthFrame;
+		}
+	}
+
+void ProjectorBase::calcNormals(const FrameBuffer& depthFrame,MeshBuffer& meshBuffer) const
+	{
+	if(computeNormals&&meshBuffer.hasNormals())
+		{
+		/* Create the normal estimator if it doesn't exist yet: */
+		if(normalEstimator==0)
+			{
+			normalEstimator=new NormalEstimator;
+			normalEstimatorOutdated=true;
+			}
+		
+		/* Update the normal estimator's cached intrinsic parameters if necessary: */
+		if(normalEstimatorOutdated)
+			{
+			normalEstimator->setIntrinsicParameters(depthSize,intrinsicParameters);
+			normalEstimatorOutdated=false;
+			}
+		
+		/* Estimate normal vectors for all depth pixels, using the triangle depth range to detect depth discontinuities: */
+		normalEstimator->estimate(depthFrame,depthCorrection,worldDepthProjection,triangleDepthRange,meshBuffer.getNormals());
+		}
+	else if(!computeNormals&&normalEstimator!=0)
+		{
+		/* Release the normal estimator: */
+		delete normalEstimator;
+		normalEstimator=0;
+		}
 	}
 
 void ProjectorBase::setDepthFrameSize(const Size& newDepthFrameSize)
 	{
 	/* Copy the depth frame size: */
 	depthSize=newDepthFrameSize;
+	normalEstimatorOutdated=true;
 	}
 
 void ProjectorBase::setDepthCorrection(const FrameSource::DepthCorrection* dc)
@@ -85,6 +190,7 @@ void ProjectorBase::setIntrinsicParameters(const FrameSource::IntrinsicParameter
 	{
 	/* Replace the stored intrinsic parameters: */
 	intrinsicParameters=ips;
+	normalEstimatorOutdated=true;
 	
 	/* Calculate the combined world-space depth projection matrix: */
 	worldDepthProjection=extrinsicParameters;
@@ -113,6 +219,28 @@ void ProjectorBase::setTriangleDepthRange(FrameSource::DepthPixel newTriangleDep
 	triangleDepthRange=newTriangleDepthRange;
 	}
 
+void ProjectorBase::setRemoveFlyingPixels(bool newRemoveFlyingPixels,double newDepthRatio,double newCurvature)
+	{
+	/* Just set the flag and thresholds; the depth frame processing thread will take care of the rest: */
+	removeFlyingPixels=newRemoveFlyingPixels;
+	flyingPixelDepthRatio=newDepthRatio;
+	flyingPixelCurvature=newCurvature;
+	}
+
+void ProjectorBase::setFillHoles(bool newFillHoles,unsigned int newMaxHoleSize,double newDepthRatio)
+	{
+	/* Just set the flag and thresholds; the depth frame processing thread will take care of the rest: */
+	fillHoles=newFillHoles;
+	maxHoleSize=newMaxHoleSize;
+	holeDepthRatio=newDepthRatio;
+	}
+
+void ProjectorBase::setComputeNormals(bool newComputeNormals)
+	{
+	/* Just set the flag; the depth frame processing thread will take care of the rest: */
+	computeNormals=newComputeNormals;
+	}
+
 ProjectorBase::Point ProjectorBase::projectPoint(const ProjectorBase::Point& p) const
 	{
 	/* Transform the point from world space to depth image space: */
@@ -25,9 +25,19 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef KINECT_PROJECTORBASE_INCLUDED
 #define KINECT_PROJECTORBASE_INCLUDED
 
+#include <stddef.h>
 #include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
 #include <Kinect/FrameSource.h>
 
+/* Forward declarations: */
+namespace Kinect {
+class FlyingPixelFilter;
+class DepthHoleFiller;
+class NormalEstimator;
+class MeshBuffer;
+}
+
 namespace Kinect {
 
 class ProjectorBase
@@ -49,6 +59,25 @@ class ProjectorBase
 	PTransform worldDepthProjection; // Projection transformation from depth image space into 3D world space
 	FrameSource::ColorSpace colorSpace; // Color space of frame source's color stream
 	FrameSource::DepthPixel triangleDepthRange; // Maximum depth distance between a triangle's vertices
+	bool removeFlyingPixels; // Flag whether flying and mixed pixels at depth discontinuities are invalidated before triangulation
+	double flyingPixelDepthRatio; // Relative depth jump threshold for flying pixel removal
+	double flyingPixelCurvature; // Relative curvature threshold for flying pixel removal
+	mutable FlyingPixelFilter* flyingPixelFilter; // Filter to invalidate flying and mixed pixels; created and destroyed on demand by the depth frame processing thread
+	mutable size_t numFlyingPixels; // Number of pixels invalidated in the most recently processed depth frame
+	bool fillHoles; // Flag whether small holes in depth frames are filled before triangulation
+	unsigned int maxHoleSize; // Maximum number of consecutive invalid pixels along a frame row or column that are filled
+	double holeDepthRatio; // Maximum relative per-pixel depth change across filled holes
+	mutable DepthHoleFiller* holeFiller; // Filler for small holes; created and destroyed on demand by the depth frame processing thread
+	mutable size_t numFilledPixels; // Number of pixels filled in the most recently processed depth frame
+	bool computeNormals; // Flag whether per-vertex world-space normal vectors are calculated for generated meshes
+	mutable NormalEstimator* normalEstimator; // Estimator for per-vertex normal vectors; created and destroyed on demand by the depth frame processing thread
+	mutable bool normalEstimatorOutdated; // Flag whether the normal estimator's cached intrinsic parameters need to be updated
+	
+	/* Protected methods: */
+	protected:
+	FrameBuffer filterFlyingPixels(const FrameBuffer& depthFrame) const; // Returns the given depth frame with flying and mixed pixels invalidated if flying pixel removal is enabled; must only be called from one thread
+	FrameBuffer fillDepthHoles(const FrameBuffer& depthFrame) const; // Returns the given depth frame with small holes filled if hole filling is enabled; must only be called from one thread
+	void calcNormals(const FrameBuffer& depthFrame,MeshBuffer& meshBuffer) const; // Writes per-vertex normal vectors for the given depth frame into the given mesh buffer if normal calculation is enabled and the mesh buffer has room for normals; must only be called from one thread
 	
 	/* Constructors and destructors: */
 	public:
@@ -91,6 +120,29 @@ class ProjectorBase
 	void setExtrinsicParameters(const FrameSource::ExtrinsicParameters& eps); // Sets the projector's extrinsic camera parameters
 	void setColorSpace(const FrameSource::ColorSpace newColorSpace); // Sets the color stream's color space
 	void setTriangleDepthRange(FrameSource::DepthPixel newTriangleDepthRange); // Sets the maximum depth range for valid triangles
+	bool getRemoveFlyingPixels(void) const // Returns true if flying pixel removal is enabled
+		{
+		return removeFlyingPixels;
+		}
+	void setRemoveFlyingPixels(bool newRemoveFlyingPixels,double newDepthRatio =0.04,double newCurvature =0.5); // Enables or disables flying pixel removal with the given relative depth jump and curvature thresholds
+	size_t getNumFlyingPixels(void) const // Returns the number of pixels invalidated in the most recently processed depth frame
+		{
+		return numFlyingPixels;
+		}
+	bool getFillHoles(void) const // Returns true if hole filling is enabled
+		{
+		return fillHoles;
+		}
+	void setFillHoles(bool newFillHoles,unsigned int newMaxHoleSize =8,double newDepthRatio =0.01); // Enables or disables filling of holes up to the given size whose bounding depth values differ by at most the given relative depth change per pixel
+	size_t getNumFilledPixels(void) const // Returns the number of pixels filled in the most recently processed depth frame
+		{
+		return numFilledPixels;
+		}
+	bool getComputeNormals(void) const // Returns true if per-vertex normal vectors are calculated
+		{
+		return computeNormals;
+		}
+	void setComputeNormals(bool newComputeNormals); // Enables or disables calculation of per-vertex world-space normal vectors for generated meshes
 	Point projectPoint(const Point& p) const; // Projects a point from world space into depth image space
 	};
 
@@ -0,0 +1,196 @@
+/***********************************************************************
+RansCoder - Class containing the building blocks of an interleaved
+range asymmetric numeral system (rANS) entropy coder with static or
+adaptive frequency tables and table-driven decoding.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/RansCoder.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+
+namespace Kinect {
+
+/******************************************
+Methods of class RansCoder::FrequencyTable:
+******************************************/
+
+void RansCoder::FrequencyTable::finalize(void)
+	{
+	/* Check that the symbol frequencies exactly fill the decoding slot table before touching it: */
+	unsigned int sum=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		sum+=symbols[symbol].freq;
+	if(sum!=scale)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Symbol frequencies do not add up to %u",scale);
+	
+	/* Calculate the start of each symbol's slot range and fill in the decoding slots: */
+	unsigned int start=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		{
+		symbols[symbol].start=Misc::UInt16(start);
+		for(unsigned int bias=0;bias<symbols[symbol].freq;++bias,++start)
+			{
+			slots[start].freq=symbols[symbol].freq;
+			slots[start].bias=Misc::UInt16(bias);
+			slots[start].symbol=Misc::UInt16(symbol);
+			}
+		}
+	}
+
+RansCoder::FrequencyTable::FrequencyTable(unsigned int sNumSymbols)
+	:numSymbols(sNumSymbols)
+	{
+	if(numSymbols<1||numSymbols>maxNumSymbols)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid alphabet size %u",numSymbols);
+	
+	/* Start with a uniform distribution: */
+	setUniform();
+	}
+
+void RansCoder::FrequencyTable::setUniform(void)
+	{
+	/* Distribute the available slots as evenly as possible: */
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		symbols[symbol].freq=Misc::UInt16(scale/numSymbols+(symbol<scale%numSymbols?1U:0U));
+	
+	finalize();
+	}
+
+void RansCoder::FrequencyTable::setCounts(const size_t counts[])
+	{
+	/* Calculate the total symbol count: */
+	size_t total=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		total+=counts[symbol];
+	if(total==0)
+		{
+		/* Fall back to a uniform distribution: */
+		setUniform();
+		return;
+		}
+	
+	/* Scale all counts, but ensure that all occurring symbols have a non-zero frequency: */
+	unsigned int sum=0;
+	unsigned int maxSymbol=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		{
+		unsigned int freq=0;
+		if(counts[symbol]>0)
+			{
+			freq=(unsigned int)((Misc::UInt64(counts[symbol])*Misc::UInt64(scale))/Misc::UInt64(total));
+			if(freq==0)
+				freq=1;
+			}
+		symbols[symbol].freq=Misc::UInt16(freq);
+		sum+=freq;
+		if(symbols[maxSymbol].freq<freq)
+			maxSymbol=symbol;
+		}
+	
+	/* Correct rounding errors by adjusting the frequencies of the most frequent symbols: */
+	while(sum!=scale)
+		{
+		if(sum<scale)
+			{
+			/* Give the remainder to the most frequent symbol: */
+			symbols[maxSymbol].freq+=Misc::UInt16(scale-sum);
+			sum=scale;
+			}
+		else
+			{
+			/* Find the currently most frequent symbol and take as much as possible from it: */
+			unsigned int takeSymbol=0;
+			for(unsigned int symbol=1;symbol<numSymbols;++symbol)
+				if(symbols[takeSymbol].freq<symbols[symbol].freq)
+					takeSymbol=symbol;
+			unsigned int take=sum-scale;
+			if(take>symbols[takeSymbol].freq-1U)
+				take=symbols[takeSymbol].freq-1U;
+			symbols[takeSymbol].freq-=Misc::UInt16(take);
+			sum-=take;
+			}
+		}
+	
+	finalize();
+	}
+
+void RansCoder::FrequencyTable::read(IO::File& source)
+	{
+	/* Read all symbol frequencies as one- or two-byte variable-length quantities: */
+	unsigned int sum=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		{
+		unsigned int freq=source.read<Misc::UInt8>();
+		if(freq&0x80U)
+			freq=((freq&0x7fU)<<8)|source.read<Misc::UInt8>();
+		if(freq>scale)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid symbol frequency %u",freq);
+		symbols[symbol].freq=Misc::UInt16(freq);
+		sum+=freq;
+		}
+	
+	/* Reject tables from corrupted streams that would overflow the decoding slot table: */
+	if(sum!=scale)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Symbol frequencies add up to %u instead of %u",sum,scale);
+	
+	finalize();
+	}
+
+size_t RansCoder::FrequencyTable::write(IO::File& sink) const
+	{
+	/* Write all symbol frequencies as one- or two-byte variable-length quantities: */
+	size_t result=0;
+	for(unsigned int symbol=0;symbol<numSymbols;++symbol)
+		{
+		unsigned int freq=symbols[symbol].freq;
+		if(freq>=0x80U)
+			{
+			sink.write<Misc::UInt8>(Misc::UInt8(0x80U|(freq>>8)));
+			++result;
+			}
+		sink.write<Misc::UInt8>(Misc::UInt8(freq&0xffU));
+		++result;
+		}
+	
+	return result;
+	}
+
+/***********************************
+Methods of class RansCoder::Decoder:
+***********************************/
+
+void RansCoder::Decoder::underflow(void)
+	{
+	throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated rANS stream");
+	}
+
+RansCoder::Decoder::Decoder(const Misc::UInt8* buffer,size_t bufferSize)
+	:ptr(buffer),end(buffer+bufferSize)
+	{
+	/* Read the initial coder states: */
+	if(bufferSize<minCodeSize)
+		underflow();
+	for(unsigned int i=0;i<numStates;++i,ptr+=4)
+		states[i]=Misc::UInt32(ptr[0])|(Misc::UInt32(ptr[1])<<8)|(Misc::UInt32(ptr[2])<<16)|(Misc::UInt32(ptr[3])<<24);
+	}
+
+}
@@ -0,0 +1,194 @@
+/***********************************************************************
+RansCoder - Class containing the building blocks of an interleaved
+range asymmetric numeral system (rANS) entropy coder with static or
+adaptive frequency tables and table-driven decoding.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_RANSCODER_INCLUDED
+#define KINECT_RANSCODER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/SizedTypes.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class RansCoder
+	{
+	/* Embedded classes: */
+	public:
+	static const unsigned int scaleBits=12; // Number of bits of precision in normalized symbol frequencies
+	static const unsigned int scale=1U<<scaleBits; // Sum of all normalized symbol frequencies
+	static const unsigned int maxNumSymbols=256; // Maximum number of symbols in a frequency table's alphabet
+	static const unsigned int numStates=4; // Number of interleaved rANS coder states
+	static const Misc::UInt32 lowerBound=1U<<23; // Lower bound of normalized coder state intervals
+	static const unsigned int minCodeSize=numStates*4; // Size of the smallest encoded data, which holds only the flushed coder states
+	
+	struct EncodeSymbol // Structure to encode a symbol
+		{
+		/* Elements: */
+		public:
+		Misc::UInt16 start; // Start of the symbol's slot range
+		Misc::UInt16 freq; // Size of the symbol's slot range
+		};
+	
+	struct DecodeSlot // Structure to decode a slot
+		{
+		/* Elements: */
+		public:
+		Misc::UInt16 freq; // Size of the slot range containing this slot
+		Misc::UInt16 bias; // Offset of this slot from the start of its slot range
+		Misc::UInt16 symbol; // Symbol represented by the slot range
+		};
+	
+	class FrequencyTable // Class for normalized symbol frequency tables
+		{
+		/* Elements: */
+		private:
+		unsigned int numSymbols; // Number of symbols in the table's alphabet
+		EncodeSymbol symbols[maxNumSymbols]; // Array of encoding symbols
+		DecodeSlot slots[scale]; // Array of decoding slots
+		
+		/* Private methods: */
+		void finalize(void); // Calculates symbol range starts and decoding slots after frequencies have been set
+		
+		/* Constructors and destructors: */
+		public:
+		FrequencyTable(unsigned int sNumSymbols); // Creates a uniform frequency table for an alphabet of the given size
+		
+		/* Methods: */
+		unsigned int getNumSymbols(void) const // Returns the table's alphabet size
+			{
+			return numSymbols;
+			}
+		void setUniform(void); // Assigns the same frequency to all symbols
+		void setCounts(const size_t counts[]); // Assigns normalized frequencies from the given array of symbol counts; every symbol with non-zero count will be encodable
+		void read(IO::File& source); // Reads a normalized frequency table from the given source
+		size_t write(IO::File& sink) const; // Writes the normalized frequency table to the given sink; returns number of bytes written
+		const EncodeSymbol& getEncodeSymbol(unsigned int symbol) const // Returns the encoding structure for the given symbol
+			{
+			return symbols[symbol];
+			}
+		const DecodeSlot& getDecodeSlot(Misc::UInt32 state) const // Returns the decoding structure for the given coder state
+			{
+			return slots[state&(scale-1U)];
+			}
+		};
+	
+	class Encoder // Class to encode a sequence of symbols in reverse order into a memory buffer
+		{
+		/* Elements: */
+		private:
+		Misc::UInt32 states[numStates]; // Interleaved coder states
+		Misc::UInt8* bufferEnd; // End of the output buffer
+		Misc::UInt8* ptr; // Current output position; moves towards the beginning of the buffer
+		
+		/* Constructors and destructors: */
+		public:
+		Encoder(Misc::UInt8* sBufferEnd) // Creates an encoder writing backwards from the given buffer end
+			:bufferEnd(sBufferEnd),ptr(sBufferEnd)
+			{
+			for(unsigned int i=0;i<numStates;++i)
+				states[i]=lowerBound;
+			}
+		
+		/* Methods: */
+		static size_t getMaxSize(size_t numSymbols) // Returns an upper bound on the size of an encoded sequence of the given length
+			{
+			return numSymbols*2+numStates*4;
+			}
+		void encode(unsigned int stateIndex,const EncodeSymbol& symbol) // Encodes the given symbol using the given interleaved state
+			{
+			Misc::UInt32& x=states[stateIndex];
+			
+			/* Renormalize the state: */
+			Misc::UInt32 xMax=((lowerBound>>scaleBits)<<8)*symbol.freq;
+			while(x>=xMax)
+				{
+				*(--ptr)=Misc::UInt8(x&0xffU);
+				x>>=8;
+				}
+			
+			/* Push the symbol into the state: */
+			x=((x/symbol.freq)<<scaleBits)+(x%symbol.freq)+symbol.start;
+			}
+		size_t finish(void) // Flushes all coder states and returns the total size of the encoded data
+			{
+			for(int i=numStates-1;i>=0;--i)
+				{
+				ptr-=4;
+				for(int j=0;j<4;++j)
+					ptr[j]=Misc::UInt8((states[i]>>(j*8))&0xffU);
+				}
+			return size_t(bufferEnd-ptr);
+			}
+		const Misc::UInt8* getData(void) const // Returns the beginning of the encoded data after finish() has been called
+			{
+			return ptr;
+			}
+		};
+	
+	class Decoder // Class to decode a sequence of symbols from a memory buffer
+		{
+		/* Elements: */
+		private:
+		Misc::UInt32 states[numStates]; // Interleaved coder states
+		const Misc::UInt8* ptr; // Current input position
+		const Misc::UInt8* end; // End of the input buffer
+		
+		/* Private methods: */
+		void underflow(void); // Throws an exception after a buffer underrun
+		
+		/* Constructors and destructors: */
+		public:
+		Decoder(const Misc::UInt8* buffer,size_t bufferSize); // Creates a decoder for the given encoded data
+		
+		/* Methods: */
+		unsigned int decode(unsigned int stateIndex,const FrequencyTable& table) // Decodes the next symbol using the given interleaved state
+			{
+			Misc::UInt32& x=states[stateIndex];
+			
+			/* Look up the slot range containing the current state: */
+			const DecodeSlot& slot=table.getDecodeSlot(x);
+			
+			/* Pop the symbol from the state: */
+			x=Misc::UInt32(slot.freq)*(x>>scaleBits)+slot.bias;
+			
+			/* Renormalize the state: */
+			while(x<lowerBound)
+				{
+				if(ptr==end)
+					underflow();
+				x=(x<<8)|Misc::UInt32(*(ptr++));
+				}
+			
+			return slot.symbol;
+			}
+		};
+	};
+
+}
+
+#endif
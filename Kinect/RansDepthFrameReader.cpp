@@ -0,0 +1,176 @@
+/***********************************************************************
+RansDepthFrameReader - Class to read depth frames compressed with an
+interleaved rANS entropy coder from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/RansDepthFrameReader.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Math/Constants.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/RansDepthFrameWriter.h>
+
+namespace Kinect {
+
+/*************************************
+Methods of class RansDepthFrameReader:
+*************************************/
+
+RansDepthFrameReader::RansDepthFrameReader(IO::File& sSource)
+	:source(sSource),
+	 formatVersion(0),perFrameTables(false),
+	 residualTable(RansDepthFrameWriter::numResidualSymbols),spanLengthTable(RansDepthFrameWriter::numSpanLengthSymbols),rawTable(256)
+	{
+	/* Read the frame size from the source: */
+	for(int i=0;i<2;++i)
+		size[i]=source.read<Misc::UInt32>();
+	
+	/* Create the Hilbert curve offset array: */
+	hilbertCurve.init(size);
+	
+	/* Read and check the versioned rANS stream header: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>RansDepthFrameWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported rANS depth stream format version %u",formatVersion);
+	unsigned int tableMode=source.read<Misc::UInt8>();
+	if(tableMode>RansDepthFrameWriter::PER_FRAME_TABLES)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported frequency table mode %u",tableMode);
+	perFrameTables=tableMode==RansDepthFrameWriter::PER_FRAME_TABLES;
+	unsigned int numStates=source.read<Misc::UInt8>();
+	unsigned int scaleBits=source.read<Misc::UInt8>();
+	if(numStates!=RansCoder::numStates||scaleBits!=RansCoder::scaleBits)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported rANS coder layout with %u states and %u-bit frequencies",numStates,scaleBits);
+	
+	if(!perFrameTables)
+		{
+		/* Read the static frequency tables: */
+		residualTable.read(source);
+		spanLengthTable.read(source);
+		}
+	}
+
+RansDepthFrameReader::~RansDepthFrameReader(void)
+	{
+	}
+
+FrameBuffer RansDepthFrameReader::readNextFrame(void)
+	{
+	/* Create the result frame: */
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),memoryTag);
+	
+	/* Return a dummy frame if the file is over: */
+	if(source.eof())
+		{
+		result.timeStamp=Math::Constants<double>::max;
+		return result;
+		}
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	readFrameHeader(source,result);
+	
+	if(perFrameTables)
+		{
+		/* Read the frame's frequency tables: */
+		residualTable.read(source);
+		spanLengthTable.read(source);
+		}
+	
+	/* Read the encoded frame, which must at least hold the coder's initial states: */
+	size_t codeSize=source.read<Misc::UInt32>();
+	if(codeSize<RansCoder::minCodeSize)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated code block of %u bytes",(unsigned int)(codeSize));
+	codeBuffer.resize(codeSize);
+	source.read(&codeBuffer[0],codeSize);
+	
+	/* Decode all pixels in Hilbert curve order: */
+	RansCoder::Decoder decoder(&codeBuffer[0],codeSize);
+	unsigned int stateIndex=0;
+	FrameSource::DepthPixel* resultBuffer=result.getData<FrameSource::DepthPixel>();
+	const unsigned int* hcPtr=hilbertCurve.getOffsets();
+	const unsigned int* hcEnd=hcPtr+size.volume();
+	unsigned int predicted=0;
+	while(hcPtr!=hcEnd)
+		{
+		unsigned int symbol=decoder.decode(stateIndex,residualTable);
+		stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+		if(symbol>=RansDepthFrameWriter::deltaSymbolOffset-RansDepthFrameWriter::maxDelta)
+			{
+			/* Apply the delta to the predicted pixel value: */
+			predicted=predicted+symbol-RansDepthFrameWriter::deltaSymbolOffset;
+			resultBuffer[*hcPtr]=FrameSource::DepthPixel(predicted);
+			++hcPtr;
+			}
+		else if(symbol==RansDepthFrameWriter::escapeSymbol)
+			{
+			/* Read a raw pixel value: */
+			predicted=decoder.decode(stateIndex,rawTable)<<8;
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			predicted|=decoder.decode(stateIndex,rawTable);
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			resultBuffer[*hcPtr]=FrameSource::DepthPixel(predicted);
+			++hcPtr;
+			}
+		else if(symbol==RansDepthFrameWriter::invalidSpanSymbol)
+			{
+			/* Read a span of invalid pixels: */
+			unsigned int spanLength=decoder.decode(stateIndex,spanLengthTable)+1U;
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			if(spanLength>(unsigned int)(hcEnd-hcPtr))
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid span overruns frame");
+			for(;spanLength>0;--spanLength,++hcPtr)
+				resultBuffer[*hcPtr]=FrameSource::invalidDepth;
+			}
+		else
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid residual symbol %u",symbol);
+		}
+	
+	return result;
+	}
+
+double RansDepthFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* All frames are compressed independently: */
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	double result=skipFrameHeader(source);
+	
+	if(perFrameTables)
+		{
+		/* Read the frame's frequency tables to find their variable-length encoded size: */
+		residualTable.read(source);
+		spanLengthTable.read(source);
+		}
+	
+	/* Skip the encoded frame: */
+	size_t codeSize=source.read<Misc::UInt32>();
+	source.skip<Misc::UInt8>(codeSize);
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,65 @@
+/***********************************************************************
+RansDepthFrameReader - Class to read depth frames compressed with an
+interleaved rANS entropy coder from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_RANSDEPTHFRAMEREADER_INCLUDED
+#define KINECT_RANSDEPTHFRAMEREADER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/HilbertCurve.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/FrameReader.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class RansDepthFrameReader:public FrameReader
+	{
+	/* Elements: */
+	private:
+	IO::File& source; // Data source for compressed depth frames
+	HilbertCurve hilbertCurve; // Object to traverse depth frames in Hilbert curve order
+	unsigned int formatVersion; // Version number of the source's rANS stream format
+	bool perFrameTables; // Flag whether frequency tables are sent with every frame
+	RansCoder::FrequencyTable residualTable; // Frequency table for pixel residuals
+	RansCoder::FrequencyTable spanLengthTable; // Frequency table for invalid span lengths
+	RansCoder::FrequencyTable rawTable; // Uniform frequency table for raw pixel value bytes
+	std::vector<Misc::UInt8> codeBuffer; // Buffer holding the current encoded frame
+	
+	/* Constructors and destructors: */
+	public:
+	RansDepthFrameReader(IO::File& sSource); // Creates a depth frame reader associated with the given data source
+	virtual ~RansDepthFrameReader(void);
+	
+	/* Methods from FrameReader: */
+	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
+	};
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+/***********************************************************************
+RansDepthFrameWriter - Class to write depth frames to a sink after
+compressing them with an interleaved rANS entropy coder.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/RansDepthFrameWriter.h>
+
+#include <IO/File.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/DepthFrameWriter.h>
+
+namespace Kinect {
+
+/*************************************
+Methods of class RansDepthFrameWriter:
+*************************************/
+
+void RansDepthFrameWriter::initStaticTables(void)
+	{
+	/*********************************************************************
+	Derive symbol weights from the code lengths of the Huffman codes used
+	by the lossless depth codec, which were generated from representative
+	depth streams. A code of length n approximates a probability of 2^-n.
+	*********************************************************************/
+	
+	/* Assign weights to pixel residuals: */
+	size_t residualCounts[numResidualSymbols];
+	for(unsigned int i=0;i<numResidualSymbols;++i)
+		residualCounts[i]=0;
+	residualCounts[invalidSpanSymbol]=size_t(1)<<(16-DepthFrameWriter::pixelDeltaCodes[0][1]);
+	residualCounts[escapeSymbol]=size_t(1)<<(16-8);
+	for(int delta=-maxDelta;delta<=maxDelta;++delta)
+		{
+		unsigned int codeLength=14; // Default for deltas not covered by the Huffman code
+		if(delta>=-15&&delta<=15)
+			codeLength=DepthFrameWriter::pixelDeltaCodes[delta+16][1];
+		residualCounts[delta+int(deltaSymbolOffset)]=size_t(1)<<(16-codeLength);
+		}
+	residualTable.setCounts(residualCounts);
+	
+	/* Assign weights to invalid span lengths: */
+	size_t spanLengthCounts[numSpanLengthSymbols];
+	for(unsigned int i=0;i<numSpanLengthSymbols;++i)
+		spanLengthCounts[i]=size_t(1)<<(16-DepthFrameWriter::spanLengthCodes[i][1]);
+	spanLengthTable.setCounts(spanLengthCounts);
+	}
+
+RansDepthFrameWriter::RansDepthFrameWriter(IO::File& sSink,const Size& sSize,RansDepthFrameWriter::TableMode sTableMode)
+	:FrameWriter(sSize),
+	 sink(sSink),
+	 tableMode(sTableMode),
+	 residualTable(numResidualSymbols),spanLengthTable(numSpanLengthSymbols),rawTable(256)
+	{
+	/* Create the Hilbert curve offset array: */
+	hilbertCurve.init(size);
+	
+	/* Write the frame size to the sink: */
+	for(int i=0;i<2;++i)
+		sink.write<Misc::UInt32>(size[i]);
+	
+	/* Write the versioned rANS stream header: */
+	Misc::UInt32 fv=formatVersion;
+	sink.write<Misc::UInt32>(fv);
+	sink.write<Misc::UInt8>(Misc::UInt8(tableMode));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::numStates));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::scaleBits));
+	
+	if(tableMode==STATIC_TABLES)
+		{
+		/* Create the static frequency tables and write them to the sink: */
+		initStaticTables();
+		residualTable.write(sink);
+		spanLengthTable.write(sink);
+		}
+	
+	/* Reserve space for a typical frame's symbols: */
+	symbols.reserve(size.volume());
+	}
+
+RansDepthFrameWriter::~RansDepthFrameWriter(void)
+	{
+	}
+
+size_t RansDepthFrameWriter::writeFrame(const FrameBuffer& frame)
+	{
+	size_t result=0;
+	
+	/* Write the frame's time stamp: */
+	result+=writeFrameHeader(sink,frame);
+	
+	/*********************************************************************
+	Convert the frame into a sequence of symbols tagged with the index of
+	their frequency table (0: residuals, 1: span lengths, 2: raw bytes).
+	Pixels are predicted from the most recent valid pixel along the
+	Hilbert curve, even across spans of invalid pixels.
+	*********************************************************************/
+	
+	symbols.clear();
+	const FrameSource::DepthPixel* frameBuffer=frame.getData<FrameSource::DepthPixel>();
+	const unsigned int* hcPtr=hilbertCurve.getOffsets();
+	const unsigned int* hcEnd=hcPtr+size.volume();
+	int predicted=0;
+	while(hcPtr!=hcEnd)
+		{
+		int pixelValue=frameBuffer[*hcPtr];
+		if(pixelValue!=FrameSource::invalidDepth)
+			{
+			/* Encode the pixel value's delta from the prediction, or escape to a raw value: */
+			int delta=pixelValue-predicted;
+			if(delta>=-maxDelta&&delta<=maxDelta)
+				symbols.push_back(Misc::UInt16(delta+int(deltaSymbolOffset)));
+			else
+				{
+				symbols.push_back(Misc::UInt16(escapeSymbol));
+				symbols.push_back(Misc::UInt16(0x200U|(pixelValue>>8)));
+				symbols.push_back(Misc::UInt16(0x200U|(pixelValue&0xff)));
+				}
+			predicted=pixelValue;
+			++hcPtr;
+			}
+		else
+			{
+			/* Collect a span of invalid pixels: */
+			unsigned int spanLength=1;
+			for(++hcPtr;hcPtr!=hcEnd&&frameBuffer[*hcPtr]==FrameSource::invalidDepth&&spanLength<numSpanLengthSymbols;++hcPtr)
+				++spanLength;
+			symbols.push_back(Misc::UInt16(invalidSpanSymbol));
+			symbols.push_back(Misc::UInt16(0x100U|(spanLength-1U)));
+			}
+		}
+	
+	if(tableMode==PER_FRAME_TABLES)
+		{
+		/* Count the frame's residual and span length symbols: */
+		size_t counts[2][RansCoder::maxNumSymbols];
+		for(int table=0;table<2;++table)
+			for(unsigned int i=0;i<RansCoder::maxNumSymbols;++i)
+				counts[table][i]=0;
+		for(std::vector<Misc::UInt16>::iterator sIt=symbols.begin();sIt!=symbols.end();++sIt)
+			if(*sIt<0x200U)
+				++counts[*sIt>>8][*sIt&0xffU];
+		
+		/* Create the frame's frequency tables and write them to the sink: */
+		residualTable.setCounts(counts[0]);
+		spanLengthTable.setCounts(counts[1]);
+		result+=residualTable.write(sink);
+		result+=spanLengthTable.write(sink);
+		}
+	
+	/* Encode the symbol sequence in reverse order: */
+	const RansCoder::FrequencyTable* tables[3]={&residualTable,&spanLengthTable,&rawTable};
+	codeBuffer.resize(RansCoder::Encoder::getMaxSize(symbols.size()));
+	RansCoder::Encoder encoder(&codeBuffer[0]+codeBuffer.size());
+	for(size_t i=symbols.size();i>0;--i)
+		{
+		Misc::UInt16 symbol=symbols[i-1];
+		encoder.encode((i-1)&(RansCoder::numStates-1),tables[symbol>>8]->getEncodeSymbol(symbol&0xffU));
+		}
+	size_t codeSize=encoder.finish();
+	
+	/* Write the encoded frame to the sink: */
+	sink.write<Misc::UInt32>(Misc::UInt32(codeSize));
+	sink.write(encoder.getData(),codeSize);
+	result+=sizeof(Misc::UInt32)+codeSize;
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,85 @@
+/***********************************************************************
+RansDepthFrameWriter - Class to write depth frames to a sink after
+compressing them with an interleaved rANS entropy coder.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_RANSDEPTHFRAMEWRITER_INCLUDED
+#define KINECT_RANSDEPTHFRAMEWRITER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/HilbertCurve.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/FrameWriter.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class RansDepthFrameWriter:public FrameWriter
+	{
+	/* Embedded classes: */
+	public:
+	enum TableMode // Enumerated type for frequency table handling
+		{
+		STATIC_TABLES=0, // Frequency tables are written once, in the stream header
+		PER_FRAME_TABLES // Frequency tables are calculated for and written with every frame
+		};
+	
+	/* Stream format constants shared with RansDepthFrameReader: */
+	static const Misc::UInt32 formatVersion=1; // Version number of the rANS depth stream format
+	static const unsigned int numResidualSymbols=64; // Size of the pixel residual alphabet
+	static const unsigned int invalidSpanSymbol=0; // Residual symbol starting a span of invalid pixels
+	static const unsigned int escapeSymbol=1; // Residual symbol announcing a raw 16-bit pixel value
+	static const int maxDelta=30; // Largest pixel value delta encoded as a single residual symbol
+	static const unsigned int deltaSymbolOffset=32; // Offset from pixel value deltas to residual symbols
+	static const unsigned int numSpanLengthSymbols=256; // Size of the invalid span length alphabet
+	
+	/* Elements: */
+	private:
+	IO::File& sink; // Data sink for the compressed depth frame stream
+	HilbertCurve hilbertCurve; // Object to traverse depth frames in Hilbert curve order
+	TableMode tableMode; // Frequency table handling mode
+	RansCoder::FrequencyTable residualTable; // Frequency table for pixel residuals
+	RansCoder::FrequencyTable spanLengthTable; // Frequency table for invalid span lengths
+	RansCoder::FrequencyTable rawTable; // Uniform frequency table for raw pixel value bytes
+	std::vector<Misc::UInt16> symbols; // Buffer of tagged symbols for the current frame
+	std::vector<Misc::UInt8> codeBuffer; // Buffer receiving the encoded frame
+	
+	/* Private methods: */
+	void initStaticTables(void); // Derives static frequency tables from the lossless depth codec's Huffman code lengths
+	
+	/* Constructors and destructors: */
+	public:
+	RansDepthFrameWriter(IO::File& sSink,const Size& sSize,TableMode sTableMode =PER_FRAME_TABLES); // Creates a depth frame writer for the given sink, frame size, and frequency table mode
+	virtual ~RansDepthFrameWriter(void);
+	
+	/* Methods from FrameWriter: */
+	virtual size_t writeFrame(const FrameBuffer& frame);
+	};
+
+}
+
+#endif
@@ -43,6 +43,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLGeometryVertex.h>
 #include <GL/GLTransformationWrappers.h>
 #include <Kinect/Internal/Config.h>
+#include <Kinect/BayerDemosaic.h>
 
 #define KINECT_SHADERPROJECTOR_USE_ZIGZAGSTRIP 0
 
@@ -321,8 +322,11 @@ void ShaderProjector::setDepthFrame(const FrameBuffer& newDepthFrame)
 
 void ShaderProjector::setColorFrame(const FrameBuffer& newColorFrame)
 	{
-	/* Post the new color frame into the triple buffer: */
-	colorFrames.postNewValue(newColorFrame);
+	/* Post the new color frame into the triple buffer, demosaicing raw Bayer frames first: */
+	if(colorSpace==FrameSource::BAYER_BGGR)
+		colorFrames.postNewValue(demosaicBayerFrame(newColorFrame));
+	else
+		colorFrames.postNewValue(newColorFrame);
 	}
 
 void ShaderProjector::updateFrames(void)
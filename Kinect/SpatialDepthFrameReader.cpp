@@ -0,0 +1,177 @@
+/***********************************************************************
+SpatialDepthFrameReader - Class to read depth frames compressed with a
+two-dimensional context-modeling predictor and an interleaved rANS
+entropy coder from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/SpatialDepthFrameReader.h>
+
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Math/Constants.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/SpatialDepthFrameWriter.h>
+
+namespace Kinect {
+
+/****************************************
+Methods of class SpatialDepthFrameReader:
+****************************************/
+
+SpatialDepthFrameReader::SpatialDepthFrameReader(IO::File& sSource)
+	:source(sSource),
+	 formatVersion(0)
+	{
+	/* Read the frame size from the source: */
+	for(int i=0;i<2;++i)
+		size[i]=source.read<Misc::UInt32>();
+	
+	/* Read and check the versioned stream header: */
+	formatVersion=source.read<Misc::UInt32>();
+	if(formatVersion<1||formatVersion>SpatialDepthFrameWriter::formatVersion)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported spatial depth stream format version %u",formatVersion);
+	unsigned int numContexts=source.read<Misc::UInt8>();
+	if(numContexts!=SpatialDepthFrameWriter::numContexts)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported number of residual contexts %u",numContexts);
+	unsigned int numStates=source.read<Misc::UInt8>();
+	unsigned int scaleBits=source.read<Misc::UInt8>();
+	if(numStates!=RansCoder::numStates||scaleBits!=RansCoder::scaleBits)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported rANS coder layout with %u states and %u-bit frequencies",numStates,scaleBits);
+	
+	/* Create the frequency tables: */
+	SpatialDepthFrameWriter::initTables(tables);
+	}
+
+SpatialDepthFrameReader::~SpatialDepthFrameReader(void)
+	{
+	}
+
+FrameBuffer SpatialDepthFrameReader::readNextFrame(void)
+	{
+	/* Create the result frame: */
+	FrameBuffer result(size,size.volume()*sizeof(FrameSource::DepthPixel),memoryTag);
+	
+	/* Return a dummy frame if the file is over: */
+	if(source.eof())
+		{
+		result.timeStamp=Math::Constants<double>::max;
+		return result;
+		}
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	readFrameHeader(source,result);
+	
+	/* Read the frame's adaptive frequency tables: */
+	for(unsigned int table=0;table<SpatialDepthFrameWriter::rawTable;++table)
+		tables[table].read(source);
+	
+	/* Read the encoded frame, which must at least hold the coder's initial states: */
+	size_t codeSize=source.read<Misc::UInt32>();
+	if(codeSize<RansCoder::minCodeSize)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated code block of %u bytes",(unsigned int)(codeSize));
+	codeBuffer.resize(codeSize);
+	source.read(&codeBuffer[0],codeSize);
+	RansCoder::Decoder decoder(&codeBuffer[0],codeSize);
+	unsigned int stateIndex=0;
+	
+	/* Decode the frame's invalid pixel map, marking valid pixels with a placeholder value: */
+	FrameSource::DepthPixel* resultBuffer=result.getData<FrameSource::DepthPixel>();
+	FrameSource::DepthPixel* rPtr=resultBuffer;
+	FrameSource::DepthPixel* rEnd=resultBuffer+size.volume();
+	bool runValid=true;
+	for(;rPtr!=rEnd;runValid=!runValid)
+		{
+		/* Read the run's length: */
+		const RansCoder::FrequencyTable& runTable=runValid?tables[SpatialDepthFrameWriter::validRunTable]:tables[SpatialDepthFrameWriter::invalidRunTable];
+		size_t runLength=0;
+		unsigned int symbol;
+		do
+			{
+			symbol=decoder.decode(stateIndex,runTable);
+			stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+			runLength+=symbol;
+			}
+		while(symbol==SpatialDepthFrameWriter::runContinueSymbol);
+		if(runLength>size_t(rEnd-rPtr))
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Pixel run overruns frame");
+		
+		/* Fill in the run: */
+		FrameSource::DepthPixel value=runValid?FrameSource::DepthPixel(0):FrameSource::invalidDepth;
+		for(;runLength>0;--runLength,++rPtr)
+			*rPtr=value;
+		}
+	
+	/* Decode the prediction residuals of all valid pixels in raster order: */
+	rPtr=resultBuffer;
+	int lastValid=0;
+	for(unsigned int y=0;y<size[1];++y)
+		for(unsigned int x=0;x<size[0];++x,++rPtr)
+			if(*rPtr!=FrameSource::invalidDepth)
+				{
+				/* Predict the pixel value from its already decoded causal neighbors: */
+				unsigned int context;
+				int predicted=SpatialDepthFrameWriter::predict(rPtr,x,y,size[0],lastValid,context);
+				
+				/* Decode the residual: */
+				unsigned int symbol=decoder.decode(stateIndex,tables[context]);
+				stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+				if(symbol!=SpatialDepthFrameWriter::escapeSymbol)
+					lastValid=predicted+int(symbol)-int(SpatialDepthFrameWriter::residualSymbolOffset);
+				else
+					{
+					/* Read a raw pixel value: */
+					const RansCoder::FrequencyTable& rawTable=tables[SpatialDepthFrameWriter::rawTable];
+					lastValid=int(decoder.decode(stateIndex,rawTable))<<8;
+					stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+					lastValid|=int(decoder.decode(stateIndex,rawTable));
+					stateIndex=(stateIndex+1)&(RansCoder::numStates-1);
+					}
+				*rPtr=FrameSource::DepthPixel(lastValid);
+				}
+	
+	return result;
+	}
+
+double SpatialDepthFrameReader::skipNextFrame(bool& keyFrame)
+	{
+	/* All frames are compressed independently: */
+	keyFrame=true;
+	
+	/* Return an invalid time stamp if the file is over: */
+	if(source.eof())
+		return Math::Constants<double>::max;
+	
+	/* Read the frame's time stamp and metadata from the source: */
+	double result=skipFrameHeader(source);
+	
+	/* Read the frame's adaptive frequency tables to find their variable-length encoded size: */
+	for(unsigned int table=0;table<SpatialDepthFrameWriter::rawTable;++table)
+		tables[table].read(source);
+	
+	/* Skip the encoded frame: */
+	size_t codeSize=source.read<Misc::UInt32>();
+	source.skip<Misc::UInt8>(codeSize);
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,61 @@
+/***********************************************************************
+SpatialDepthFrameReader - Class to read depth frames compressed with a
+two-dimensional context-modeling predictor and an interleaved rANS
+entropy coder from a source.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_SPATIALDEPTHFRAMEREADER_INCLUDED
+#define KINECT_SPATIALDEPTHFRAMEREADER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/FrameReader.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class SpatialDepthFrameReader:public FrameReader
+	{
+	/* Elements: */
+	private:
+	IO::File& source; // Data source for compressed depth frames
+	unsigned int formatVersion; // Version number of the source's spatial stream format
+	std::vector<RansCoder::FrequencyTable> tables; // Frequency tables for residual contexts, validity run lengths, and raw bytes
+	std::vector<Misc::UInt8> codeBuffer; // Buffer holding the current encoded frame
+	
+	/* Constructors and destructors: */
+	public:
+	SpatialDepthFrameReader(IO::File& sSource); // Creates a depth frame reader associated with the given data source
+	virtual ~SpatialDepthFrameReader(void);
+	
+	/* Methods from FrameReader: */
+	virtual FrameBuffer readNextFrame(void);
+	virtual double skipNextFrame(bool& keyFrame);
+	};
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+/***********************************************************************
+SpatialDepthFrameWriter - Class to write depth frames to a sink after
+compressing them with a two-dimensional context-modeling predictor and
+an interleaved rANS entropy coder.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/SpatialDepthFrameWriter.h>
+
+#include <IO/File.h>
+#include <Kinect/FrameBuffer.h>
+
+namespace Kinect {
+
+/****************************************
+Methods of class SpatialDepthFrameWriter:
+****************************************/
+
+SpatialDepthFrameWriter::SpatialDepthFrameWriter(IO::File& sSink,const Size& sSize)
+	:FrameWriter(sSize),
+	 sink(sSink)
+	{
+	/* Create the frequency tables: */
+	initTables(tables);
+	
+	/* Write the frame size to the sink: */
+	for(int i=0;i<2;++i)
+		sink.write<Misc::UInt32>(size[i]);
+	
+	/* Write the versioned stream header: */
+	Misc::UInt32 fv=formatVersion;
+	sink.write<Misc::UInt32>(fv);
+	sink.write<Misc::UInt8>(Misc::UInt8(numContexts));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::numStates));
+	sink.write<Misc::UInt8>(Misc::UInt8(RansCoder::scaleBits));
+	
+	/* Reserve space for a typical frame's symbols: */
+	symbols.reserve(size.volume());
+	}
+
+SpatialDepthFrameWriter::~SpatialDepthFrameWriter(void)
+	{
+	}
+
+size_t SpatialDepthFrameWriter::writeFrame(const FrameBuffer& frame)
+	{
+	size_t result=0;
+	
+	/* Write the frame's time stamp: */
+	result+=writeFrameHeader(sink,frame);
+	
+	symbols.clear();
+	const FrameSource::DepthPixel* frameBuffer=frame.getData<FrameSource::DepthPixel>();
+	size_t numPixels=size.volume();
+	
+	/*********************************************************************
+	Encode the frame's invalid pixel map as alternating runs of valid and
+	invalid pixels in raster order, starting with a (possibly empty) run
+	of valid pixels. Long runs are split using a continuation symbol.
+	*********************************************************************/
+	
+	bool runValid=true;
+	for(size_t index=0;index<numPixels;runValid=!runValid)
+		{
+		/* Find the end of the current run: */
+		size_t runStart=index;
+		while(index<numPixels&&(frameBuffer[index]!=FrameSource::invalidDepth)==runValid)
+			++index;
+		
+		/* Write the run's length: */
+		Misc::UInt16 tag=Misc::UInt16(runValid?validRunTable<<8:invalidRunTable<<8);
+		size_t runLength=index-runStart;
+		for(;runLength>=runContinueSymbol;runLength-=runContinueSymbol)
+			symbols.push_back(tag|Misc::UInt16(runContinueSymbol));
+		symbols.push_back(tag|Misc::UInt16(runLength));
+		}
+	
+	/* Encode the prediction residuals of all valid pixels in raster order: */
+	const FrameSource::DepthPixel* fPtr=frameBuffer;
+	int lastValid=0;
+	for(unsigned int y=0;y<size[1];++y)
+		for(unsigned int x=0;x<size[0];++x,++fPtr)
+			if(*fPtr!=FrameSource::invalidDepth)
+				{
+				/* Predict the pixel value from its causal neighbors: */
+				unsigned int context;
+				int pixelValue=*fPtr;
+				int residual=pixelValue-predict(fPtr,x,y,size[0],lastValid,context);
+				
+				/* Encode the residual, or escape to a raw value: */
+				Misc::UInt16 tag=Misc::UInt16(context<<8);
+				if(residual>=-maxResidual&&residual<=maxResidual)
+					symbols.push_back(tag|Misc::UInt16(residual+int(residualSymbolOffset)));
+				else
+					{
+					symbols.push_back(tag|Misc::UInt16(escapeSymbol));
+					symbols.push_back(Misc::UInt16((rawTable<<8)|(pixelValue>>8)));
+					symbols.push_back(Misc::UInt16((rawTable<<8)|(pixelValue&0xff)));
+					}
+				lastValid=pixelValue;
+				}
+	
+	/* Count the frame's symbols: */
+	std::vector<size_t> counts(rawTable*RansCoder::maxNumSymbols,0);
+	for(std::vector<Misc::UInt16>::iterator sIt=symbols.begin();sIt!=symbols.end();++sIt)
+		if((*sIt>>8)<rawTable)
+			++counts[*sIt];
+	
+	/* Create the frame's adaptive frequency tables and write them to the sink: */
+	for(unsigned int table=0;table<rawTable;++table)
+		{
+		tables[table].setCounts(&counts[table*RansCoder::maxNumSymbols]);
+		result+=tables[table].write(sink);
+		}
+	
+	/* Encode the symbol sequence in reverse order: */
+	codeBuffer.resize(RansCoder::Encoder::getMaxSize(symbols.size()));
+	RansCoder::Encoder encoder(&codeBuffer[0]+codeBuffer.size());
+	for(size_t i=symbols.size();i>0;--i)
+		{
+		Misc::UInt16 symbol=symbols[i-1];
+		encoder.encode((i-1)&(RansCoder::numStates-1),tables[symbol>>8].getEncodeSymbol(symbol&0xffU));
+		}
+	size_t codeSize=encoder.finish();
+	
+	/* Write the encoded frame to the sink: */
+	sink.write<Misc::UInt32>(Misc::UInt32(codeSize));
+	sink.write(encoder.getData(),codeSize);
+	result+=sizeof(Misc::UInt32)+codeSize;
+	
+	return result;
+	}
+
+void SpatialDepthFrameWriter::initTables(std::vector<RansCoder::FrequencyTable>& tables)
+	{
+	tables.clear();
+	tables.reserve(numTables);
+	for(unsigned int i=0;i<numContexts;++i)
+		tables.push_back(RansCoder::FrequencyTable(numResidualSymbols));
+	tables.push_back(RansCoder::FrequencyTable(numRunLengthSymbols));
+	tables.push_back(RansCoder::FrequencyTable(numRunLengthSymbols));
+	tables.push_back(RansCoder::FrequencyTable(256));
+	}
+
+}
@@ -0,0 +1,143 @@
+/***********************************************************************
+SpatialDepthFrameWriter - Class to write depth frames to a sink after
+compressing them with a two-dimensional context-modeling predictor and
+an interleaved rANS entropy coder.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_SPATIALDEPTHFRAMEWRITER_INCLUDED
+#define KINECT_SPATIALDEPTHFRAMEWRITER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/RansCoder.h>
+#include <Kinect/FrameWriter.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace Kinect {
+
+class SpatialDepthFrameWriter:public FrameWriter
+	{
+	/* Stream format constants shared with SpatialDepthFrameReader: */
+	public:
+	static const Misc::UInt32 formatVersion=1; // Version number of the spatial depth stream format
+	static const unsigned int numContexts=8; // Number of residual coding contexts
+	static const unsigned int incompleteContext=numContexts-1; // Context for pixels with incomplete causal neighborhoods
+	static const unsigned int numResidualSymbols=64; // Size of the pixel residual alphabet
+	static const unsigned int escapeSymbol=0; // Residual symbol announcing a raw 16-bit pixel value
+	static const int maxResidual=31; // Largest prediction residual encoded as a single residual symbol
+	static const unsigned int residualSymbolOffset=32; // Offset from prediction residuals to residual symbols
+	static const unsigned int numRunLengthSymbols=256; // Size of the validity run length alphabet
+	static const unsigned int runContinueSymbol=numRunLengthSymbols-1; // Run length symbol announcing that the run continues
+	static const unsigned int validRunTable=numContexts; // Index of the frequency table for runs of valid pixels
+	static const unsigned int invalidRunTable=numContexts+1; // Index of the frequency table for runs of invalid pixels
+	static const unsigned int rawTable=numContexts+2; // Index of the uniform frequency table for raw pixel value bytes
+	static const unsigned int numTables=numContexts+3; // Total number of frequency tables
+	
+	/* Elements: */
+	private:
+	IO::File& sink; // Data sink for the compressed depth frame stream
+	std::vector<RansCoder::FrequencyTable> tables; // Frequency tables for residual contexts, validity run lengths, and raw bytes
+	std::vector<Misc::UInt16> symbols; // Buffer of symbols for the current frame, tagged with the indices of their frequency tables
+	std::vector<Misc::UInt8> codeBuffer; // Buffer receiving the encoded frame
+	
+	/* Constructors and destructors: */
+	public:
+	SpatialDepthFrameWriter(IO::File& sSink,const Size& sSize); // Creates a depth frame writer for the given sink and frame size
+	virtual ~SpatialDepthFrameWriter(void);
+	
+	/* Methods from FrameWriter: */
+	virtual size_t writeFrame(const FrameBuffer& frame);
+	
+	/* New methods: */
+	static void initTables(std::vector<RansCoder::FrequencyTable>& tables); // Creates the set of frequency tables used by the spatial depth codec
+	static int predict(const FrameSource::DepthPixel* pixel,unsigned int x,unsigned int y,unsigned int width,int lastValid,unsigned int& context) // Predicts the value of the given pixel in a frame of the given width from its valid causal neighbors; returns coding context
+		{
+		/* Collect the valid left, upper-left, upper, and upper-right neighbors of the pixel: */
+		int a=-1,b=-1,c=-1,d=-1;
+		if(x>0&&pixel[-1]!=FrameSource::invalidDepth)
+			a=pixel[-1];
+		if(y>0)
+			{
+			const FrameSource::DepthPixel* up=pixel-width;
+			if(up[0]!=FrameSource::invalidDepth)
+				b=up[0];
+			if(x>0&&up[-1]!=FrameSource::invalidDepth)
+				c=up[-1];
+			if(x+1<width&&up[1]!=FrameSource::invalidDepth)
+				d=up[1];
+			}
+		
+		if(a>=0&&b>=0&&c>=0)
+			{
+			/* Select a context based on the local gradient activity: */
+			int activity=(a>c?a-c:c-a)+(b>c?b-c:c-b);
+			if(d>=0)
+				activity+=d>b?d-b:b-d;
+			if(activity==0)
+				context=0;
+			else if(activity<=2)
+				context=1;
+			else if(activity<=4)
+				context=2;
+			else if(activity<=8)
+				context=3;
+			else if(activity<=16)
+				context=4;
+			else if(activity<=32)
+				context=5;
+			else
+				context=6;
+			
+			/* Use the median edge detector to predict the pixel: */
+			if(c>=(a>b?a:b))
+				return a<b?a:b;
+			else if(c<=(a<b?a:b))
+				return a>b?a:b;
+			else
+				return a+b-c;
+			}
+		
+		/* Fall back to the best available neighbor: */
+		context=incompleteContext;
+		if(a>=0&&b>=0)
+			return (a+b+1)>>1;
+		else if(a>=0)
+			return a;
+		else if(b>=0)
+			return b;
+		else if(d>=0)
+			return d;
+		else if(c>=0)
+			return c;
+		else
+			return lastValid;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,478 @@
+/***********************************************************************
+SubjectTracker - Class to segment foreground depth pixels from one or
+more cameras into connected components in world space, and to track
+those components as subjects with stable IDs and bounding boxes across
+frames and cameras.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/SubjectTracker.h>
+
+#include <algorithm>
+#include <Misc/FunctionCalls.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Images/ExtractBlobs.h>
+
+namespace Kinect {
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef FrameSource::DepthPixel DepthPixel;
+typedef SubjectTracker::Scalar Scalar;
+typedef SubjectTracker::Point Point;
+typedef SubjectTracker::Box Box;
+
+struct WorldBlob:public Images::Blob<DepthPixel> // Structure to accumulate world-space bounding boxes and centroids of foreground components
+	{
+	/* Embedded classes: */
+	public:
+	typedef DepthPixel Pixel;
+	typedef Images::Blob<DepthPixel> Base;
+	
+	struct Creator:public Base::Creator
+		{
+		/* Elements: */
+		public:
+		unsigned int width; // Width of depth frames
+		const FrameSource::DepthCorrection::PixelCorrection* depthCorrection; // 2D array of per-pixel depth correction factors, or null
+		const FrameSource::IntrinsicParameters::Point2* pixelCenters; // 2D array of undistorted pixel centers, or null
+		const FrameSource::IntrinsicParameters::PTransform* worldDepthProjection; // Projection from depth image space into world space
+		};
+	
+	/* Elements: */
+	Box box; // Bounding box of the component in world space
+	double pxs,pys,pzs; // Accumulated world-space pixel positions
+	
+	/* Private methods: */
+	static Point unproject(unsigned int x,unsigned int y,const Pixel& pixel,const Creator& creator) // Returns the world-space position of the given pixel
+		{
+		unsigned int index=y*creator.width+x;
+		Point dip;
+		if(creator.pixelCenters!=0)
+			{
+			dip[0]=Scalar(creator.pixelCenters[index][0]);
+			dip[1]=Scalar(creator.pixelCenters[index][1]);
+			}
+		else
+			{
+			dip[0]=Scalar(x)+Scalar(0.5);
+			dip[1]=Scalar(y)+Scalar(0.5);
+			}
+		dip[2]=creator.depthCorrection!=0?Scalar(creator.depthCorrection[index].correct(float(pixel))):Scalar(pixel);
+		return creator.worldDepthProjection->transform(dip);
+		}
+	
+	/* Constructors and destructors: */
+	WorldBlob(unsigned int x,unsigned int y,const Pixel& pixel,const Creator& creator)
+		:Base(x,y,pixel,creator)
+		{
+		Point p=unproject(x,y,pixel,creator);
+		box=Box(p,p);
+		pxs=double(p[0]);
+		pys=double(p[1]);
+		pzs=double(p[2]);
+		}
+	
+	/* Methods: */
+	void addPixel(unsigned int x,unsigned int y,const Pixel& pixel,const Creator& creator)
+		{
+		Base::addPixel(x,y,pixel,creator);
+		
+		Point p=unproject(x,y,pixel,creator);
+		box.addPoint(p);
+		pxs+=double(p[0]);
+		pys+=double(p[1]);
+		pzs+=double(p[2]);
+		}
+	void merge(const WorldBlob& other,const Creator& creator)
+		{
+		Base::merge(other,creator);
+		
+		box.addBox(other.box);
+		pxs+=other.pxs;
+		pys+=other.pys;
+		pzs+=other.pzs;
+		}
+	};
+
+class BlobForegroundSelector // Functor class to select foreground pixels
+	{
+	/* Methods: */
+	public:
+	bool operator()(unsigned int x,unsigned int y,const DepthPixel& pixel) const
+		{
+		return pixel<FrameSource::invalidDepth-1;
+		}
+	};
+
+class BlobMergeChecker // Functor class to check whether two pixels can belong to the same component
+	{
+	/* Elements: */
+	private:
+	int maxDepthDist;
+	
+	/* Constructors and destructors: */
+	public:
+	BlobMergeChecker(int sMaxDepthDist)
+		:maxDepthDist(sMaxDepthDist)
+		{
+		}
+	
+	/* Methods: */
+	bool operator()(unsigned int x1,unsigned int y1,const DepthPixel& pixel1,unsigned int x2,unsigned int y2,const DepthPixel& pixel2) const
+		{
+		return Math::abs(int(pixel1)-int(pixel2))<=maxDepthDist;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+Scalar calcBoxDistance(const Box& box1,const Box& box2) // Returns the largest per-axis gap between two boxes, or zero if they overlap
+	{
+	Scalar result(0);
+	for(int i=0;i<3;++i)
+		{
+		Scalar gap=box1.min[i]>box2.max[i]?box1.min[i]-box2.max[i]:box2.min[i]-box1.max[i];
+		if(result<gap)
+			result=gap;
+		}
+	return result;
+	}
+
+unsigned int findRoot(std::vector<unsigned int>& parents,unsigned int index) // Returns the root of the given observation's cluster
+	{
+	while(parents[index]!=index)
+		index=parents[index]=parents[parents[index]];
+	return index;
+	}
+
+struct Match // Structure for candidate matches between tracked and detected subjects
+	{
+	/* Elements: */
+	public:
+	Scalar dist2; // Squared distance between predicted and detected centroids
+	unsigned int trackIndex; // Index of the tracked subject
+	unsigned int detectionIndex; // Index of the detected subject
+	
+	/* Methods: */
+	bool operator<(const Match& other) const
+		{
+		return dist2<other.dist2;
+		}
+	};
+
+}
+
+/*******************************
+Methods of class SubjectTracker:
+*******************************/
+
+std::vector<SubjectTracker::Observation> SubjectTracker::extractObservations(const SubjectTracker::Camera& camera,const FrameBuffer& depthFrame) const
+	{
+	/* Extract all foreground components from the depth frame: */
+	const Size& depthSize=camera.projector.getDepthFrameSize();
+	WorldBlob::Creator blobCreator;
+	blobCreator.width=depthSize[0];
+	blobCreator.depthCorrection=camera.projector.getDepthCorrection();
+	blobCreator.pixelCenters=camera.pixelCenters.empty()?0:&camera.pixelCenters[0];
+	blobCreator.worldDepthProjection=&camera.projector.worldDepthProjection;
+	BlobForegroundSelector bfs;
+	BlobMergeChecker bmc(maxBlobMergeDist);
+	std::vector<WorldBlob> blobs=Images::extractBlobs<WorldBlob>(depthSize,depthFrame.getData<DepthPixel>(),bfs,bmc,blobCreator);
+	
+	/* Keep all large-enough components: */
+	std::vector<Observation> result;
+	for(std::vector<WorldBlob>::iterator bIt=blobs.begin();bIt!=blobs.end();++bIt)
+		if(bIt->numPixels>=minNumPixels)
+			{
+			Observation o;
+			o.box=bIt->box;
+			double np=double(bIt->numPixels);
+			o.centroid=Point(Scalar(bIt->pxs/np),Scalar(bIt->pys/np),Scalar(bIt->pzs/np));
+			o.numPixels=bIt->numPixels;
+			result.push_back(o);
+			}
+	
+	return result;
+	}
+
+void SubjectTracker::updateSubjects(double timeStamp)
+	{
+	/* Gather the current observations of all cameras: */
+	std::vector<const Observation*> observations;
+	std::vector<unsigned int> observationCameras;
+	for(unsigned int cameraIndex=0;cameraIndex<cameras.size();++cameraIndex)
+		for(std::vector<Observation>::const_iterator oIt=cameras[cameraIndex]->observations.begin();oIt!=cameras[cameraIndex]->observations.end();++oIt)
+			{
+			observations.push_back(&*oIt);
+			observationCameras.push_back(cameraIndex);
+			}
+	
+	/* Cluster observations whose bounding boxes are close to each other: */
+	unsigned int numObservations=observations.size();
+	std::vector<unsigned int> parents(numObservations);
+	for(unsigned int i=0;i<numObservations;++i)
+		parents[i]=i;
+	for(unsigned int i=0;i<numObservations;++i)
+		for(unsigned int j=i+1;j<numObservations;++j)
+			if(calcBoxDistance(observations[i]->box,observations[j]->box)<=mergeDistance)
+				{
+				unsigned int r1=findRoot(parents,i);
+				unsigned int r2=findRoot(parents,j);
+				if(r1!=r2)
+					parents[r2]=r1;
+				}
+	
+	/* Create one detected subject per cluster, with the pixel-weighted average of its observations' centroids: */
+	SubjectList detections;
+	std::vector<Vector> centroidSums;
+	std::vector<unsigned int> clusterDetections(numObservations,~0x0U);
+	for(unsigned int i=0;i<numObservations;++i)
+		{
+		unsigned int root=findRoot(parents,i);
+		if(clusterDetections[root]==~0x0U)
+			{
+			clusterDetections[root]=detections.size();
+			Subject s;
+			s.box=Box::empty;
+			s.velocity=Vector::zero;
+			s.numPixels=0;
+			s.cameraMask=0x0U;
+			s.firstSeen=s.lastSeen=timeStamp;
+			detections.push_back(s);
+			centroidSums.push_back(Vector::zero);
+			}
+		unsigned int detectionIndex=clusterDetections[root];
+		Subject& s=detections[detectionIndex];
+		s.box.addBox(observations[i]->box);
+		centroidSums[detectionIndex]+=(observations[i]->centroid-Point::origin)*Scalar(observations[i]->numPixels);
+		s.numPixels+=observations[i]->numPixels;
+		if(observationCameras[i]<32)
+			s.cameraMask|=0x1U<<observationCameras[i];
+		}
+	
+	/* Reject detections whose sizes do not match the subject size range: */
+	SubjectList::iterator dDest=detections.begin();
+	for(unsigned int i=0;i<detections.size();++i)
+		{
+		detections[i].centroid=Point::origin+centroidSums[i]/Scalar(detections[i].numPixels);
+		Vector size=detections[i].box.getSize();
+		Scalar extent=Math::max(size[0],Math::max(size[1],size[2]));
+		if(extent>=minSubjectExtent&&extent<=maxSubjectExtent)
+			*(dDest++)=detections[i];
+		}
+	detections.erase(dDest,detections.end());
+	
+	/* Collect all candidate matches between tracked subjects' predicted centroids and detected subjects: */
+	std::vector<Match> matches;
+	Scalar maxDist2=Math::sqr(maxTrackDistance);
+	for(unsigned int i=0;i<subjects.size();++i)
+		{
+		double dt=timeStamp-subjects[i].lastSeen;
+		Point predicted=subjects[i].centroid;
+		if(dt>0.0)
+			predicted+=subjects[i].velocity*Scalar(dt);
+		for(unsigned int j=0;j<detections.size();++j)
+			{
+			Match m;
+			m.dist2=Geometry::sqrDist(predicted,detections[j].centroid);
+			if(m.dist2<=maxDist2)
+				{
+				m.trackIndex=i;
+				m.detectionIndex=j;
+				matches.push_back(m);
+				}
+			}
+		}
+	
+	/* Greedily assign detected subjects to tracked subjects in order of increasing distance: */
+	std::sort(matches.begin(),matches.end());
+	std::vector<bool> trackMatched(subjects.size(),false);
+	std::vector<bool> detectionMatched(detections.size(),false);
+	for(std::vector<Match>::iterator mIt=matches.begin();mIt!=matches.end();++mIt)
+		if(!trackMatched[mIt->trackIndex]&&!detectionMatched[mIt->detectionIndex])
+			{
+			Subject& s=subjects[mIt->trackIndex];
+			const Subject& d=detections[mIt->detectionIndex];
+			
+			/* Update the subject's velocity estimate with exponential smoothing: */
+			double dt=timeStamp-s.lastSeen;
+			if(dt>0.0)
+				s.velocity=s.velocity*Scalar(0.5)+((d.centroid-s.centroid)/Scalar(dt))*Scalar(0.5);
+			
+			/* Update the subject's state: */
+			s.box=d.box;
+			s.centroid=d.centroid;
+			s.numPixels=d.numPixels;
+			s.cameraMask=d.cameraMask;
+			s.lastSeen=timeStamp;
+			
+			trackMatched[mIt->trackIndex]=true;
+			detectionMatched[mIt->detectionIndex]=true;
+			}
+	
+	/* Drop tracked subjects that have not been detected for too long: */
+	SubjectList::iterator sDest=subjects.begin();
+	for(unsigned int i=0;i<subjects.size();++i)
+		if(trackMatched[i]||timeStamp-subjects[i].lastSeen<=trackTimeout)
+			*(sDest++)=subjects[i];
+	subjects.erase(sDest,subjects.end());
+	
+	/* Start tracking all unmatched detected subjects: */
+	for(unsigned int j=0;j<detections.size();++j)
+		if(!detectionMatched[j])
+			{
+			detections[j].id=nextId++;
+			subjects.push_back(detections[j]);
+			}
+	}
+
+SubjectTracker::SubjectTracker(void)
+	:maxBlobMergeDist(8),
+	 minNumPixels(500),
+	 mergeDistance(10),
+	 minSubjectExtent(0),maxSubjectExtent(Math::Constants<Scalar>::max),
+	 maxTrackDistance(50),
+	 trackTimeout(0.5),
+	 nextId(0),
+	 trackingCallback(0)
+	{
+	}
+
+SubjectTracker::~SubjectTracker(void)
+	{
+	for(std::vector<Camera*>::iterator cIt=cameras.begin();cIt!=cameras.end();++cIt)
+		delete *cIt;
+	delete trackingCallback;
+	}
+
+unsigned int SubjectTracker::addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps)
+	{
+	/* Initialize the new camera's projector: */
+	Camera* camera=new Camera;
+	camera->projector.setDepthFrameSize(depthSize);
+	camera->projector.setDepthCorrection(depthCorrection);
+	camera->projector.setIntrinsicParameters(ips);
+	camera->projector.setExtrinsicParameters(eps);
+	
+	/* Pre-compute undistorted pixel centers if the camera has lens distortion: */
+	if(!ips.depthLensDistortion.isIdentity())
+		{
+		camera->pixelCenters.reserve(depthSize.volume());
+		for(unsigned int y=0;y<depthSize[1];++y)
+			for(unsigned int x=0;x<depthSize[0];++x)
+				camera->pixelCenters.push_back(ips.undistortDepthPixel(x,y));
+		}
+	
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	cameras.push_back(camera);
+	return cameras.size()-1;
+	}
+
+unsigned int SubjectTracker::addCamera(FrameSource& frameSource)
+	{
+	/* Query the frame source's calibration parameters: */
+	FrameSource::DepthCorrection* depthCorrection=frameSource.getDepthCorrectionParameters();
+	unsigned int result=addCamera(frameSource.getActualFrameSize(FrameSource::DEPTH),depthCorrection,frameSource.getIntrinsicParameters(),frameSource.getExtrinsicParameters());
+	delete depthCorrection;
+	
+	return result;
+	}
+
+void SubjectTracker::setMaxBlobMergeDist(int newMaxBlobMergeDist)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	maxBlobMergeDist=newMaxBlobMergeDist;
+	}
+
+void SubjectTracker::setMinNumPixels(unsigned int newMinNumPixels)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	minNumPixels=newMinNumPixels;
+	}
+
+void SubjectTracker::setMergeDistance(SubjectTracker::Scalar newMergeDistance)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	mergeDistance=newMergeDistance;
+	}
+
+void SubjectTracker::setSubjectExtentRange(SubjectTracker::Scalar newMinSubjectExtent,SubjectTracker::Scalar newMaxSubjectExtent)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	minSubjectExtent=newMinSubjectExtent;
+	maxSubjectExtent=newMaxSubjectExtent;
+	}
+
+void SubjectTracker::setMaxTrackDistance(SubjectTracker::Scalar newMaxTrackDistance)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	maxTrackDistance=newMaxTrackDistance;
+	}
+
+void SubjectTracker::setTrackTimeout(double newTrackTimeout)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	trackTimeout=newTrackTimeout;
+	}
+
+void SubjectTracker::setTrackingCallback(SubjectTracker::TrackingCallback* newTrackingCallback)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	delete trackingCallback;
+	trackingCallback=newTrackingCallback;
+	}
+
+SubjectTracker::SubjectList SubjectTracker::processFrame(unsigned int cameraIndex,const FrameBuffer& depthFrame)
+	{
+	/* Extract foreground components from the depth frame outside the lock to process multiple cameras in parallel: */
+	Camera* camera;
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	camera=cameras[cameraIndex];
+	}
+	std::vector<Observation> observations=extractObservations(*camera,depthFrame);
+	
+	/* Update the tracked subjects: */
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	camera->observations.swap(observations);
+	updateSubjects(depthFrame.timeStamp);
+	
+	/* Notify the tracking callback: */
+	if(trackingCallback!=0)
+		(*trackingCallback)(subjects);
+	
+	return subjects;
+	}
+
+SubjectTracker::SubjectList SubjectTracker::getSubjects(void)
+	{
+	Threads::Mutex::Lock trackerLock(trackerMutex);
+	return subjects;
+	}
+
+}
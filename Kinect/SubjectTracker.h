@@ -0,0 +1,139 @@
+/***********************************************************************
+SubjectTracker - Class to segment foreground depth pixels from one or
+more cameras into connected components in world space, and to track
+those components as subjects with stable IDs and bounding boxes across
+frames and cameras.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_SUBJECTTRACKER_INCLUDED
+#define KINECT_SUBJECTTRACKER_INCLUDED
+
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Box.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/ProjectorBase.h>
+
+/* Forward declarations: */
+namespace Misc {
+template <class ParameterParam>
+class FunctionCall;
+}
+
+namespace Kinect {
+
+class SubjectTracker
+	{
+	/* Embedded classes: */
+	public:
+	typedef ProjectorBase::Point Point; // Type for points in depth image and world space
+	typedef Point::Scalar Scalar; // Type for scalar values
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors in world space
+	typedef Geometry::Box<Scalar,3> Box; // Type for axis-aligned bounding boxes in world space
+	
+	struct Subject // Structure for tracked subjects
+		{
+		/* Elements: */
+		public:
+		unsigned int id; // Subject's ID, stable for as long as the subject is tracked
+		Box box; // Subject's axis-aligned bounding box in world space
+		Point centroid; // Subject's centroid in world space
+		Vector velocity; // Subject's estimated centroid velocity in world space units per second
+		unsigned int numPixels; // Total number of foreground pixels supporting the subject in the most recent frames of all cameras
+		unsigned int cameraMask; // Bit mask of the cameras that saw the subject in their most recent frames; only the first 32 cameras are represented
+		double firstSeen; // Time stamp at which the subject was first detected
+		double lastSeen; // Time stamp at which the subject was most recently detected
+		};
+	
+	typedef std::vector<Subject> SubjectList; // Type for lists of tracked subjects
+	typedef Misc::FunctionCall<const SubjectList&> TrackingCallback; // Type for functions called with the list of tracked subjects after each processed frame
+	
+	private:
+	struct Observation // Structure for foreground components seen by a single camera
+		{
+		/* Elements: */
+		public:
+		Box box; // Component's bounding box in world space
+		Point centroid; // Component's centroid in world space
+		unsigned int numPixels; // Number of pixels in the component
+		};
+	
+	struct Camera // Structure holding per-camera segmentation state
+		{
+		/* Elements: */
+		public:
+		ProjectorBase projector; // Projector holding the camera's intrinsic and extrinsic parameters and per-pixel depth correction
+		std::vector<FrameSource::IntrinsicParameters::Point2> pixelCenters; // Undistorted depth image-space pixel centers if the camera has lens distortion; empty otherwise
+		std::vector<Observation> observations; // Foreground components extracted from the camera's most recent depth frame
+		};
+	
+	/* Elements: */
+	std::vector<Camera*> cameras; // List of cameras feeding the tracker
+	int maxBlobMergeDist; // Maximum depth value distance of neighboring pixels to join the same component
+	unsigned int minNumPixels; // Minimum number of pixels for a component to be considered
+	Scalar mergeDistance; // Maximum distance between the bounding boxes of components from different cameras to fuse them into the same subject
+	Scalar minSubjectExtent; // Minimum size of a subject's bounding box along its largest axis
+	Scalar maxSubjectExtent; // Maximum size of a subject's bounding box along its largest axis
+	Scalar maxTrackDistance; // Maximum distance between a subject's predicted and detected centroids to continue tracking it
+	double trackTimeout; // Time after which a subject that is no longer detected is dropped in seconds
+	Threads::Mutex trackerMutex; // Mutex serializing tracking updates from multiple cameras' streaming threads
+	unsigned int nextId; // ID to assign to the next newly detected subject
+	SubjectList subjects; // List of currently tracked subjects
+	TrackingCallback* trackingCallback; // Function called with the list of tracked subjects after each processed frame
+	
+	/* Private methods: */
+	std::vector<Observation> extractObservations(const Camera& camera,const FrameBuffer& depthFrame) const; // Extracts foreground components from the given depth frame of the given camera
+	void updateSubjects(double timeStamp); // Fuses the current observations of all cameras and updates the list of tracked subjects
+	
+	/* Constructors and destructors: */
+	public:
+	SubjectTracker(void); // Creates a subject tracker without cameras
+	private:
+	SubjectTracker(const SubjectTracker& source); // Prohibit copy constructor
+	SubjectTracker& operator=(const SubjectTracker& source); // Prohibit assignment operator
+	public:
+	~SubjectTracker(void);
+	
+	/* Methods: */
+	unsigned int addCamera(const Size& depthSize,const FrameSource::DepthCorrection* depthCorrection,const FrameSource::IntrinsicParameters& ips,const FrameSource::ExtrinsicParameters& eps); // Adds a camera with the given depth frame size and calibration parameters; returns the camera's index
+	unsigned int addCamera(FrameSource& frameSource); // Adds a camera using the given frame source's calibration parameters; returns the camera's index
+	unsigned int getNumCameras(void) const // Returns the number of cameras feeding the tracker
+		{
+		return cameras.size();
+		}
+	void setMaxBlobMergeDist(int newMaxBlobMergeDist); // Sets the maximum depth value distance of neighboring pixels in the same component
+	void setMinNumPixels(unsigned int newMinNumPixels); // Sets the minimum number of pixels in a component
+	void setMergeDistance(Scalar newMergeDistance); // Sets the maximum distance between components from different cameras belonging to the same subject
+	void setSubjectExtentRange(Scalar newMinSubjectExtent,Scalar newMaxSubjectExtent); // Sets the range of sizes of subjects' bounding boxes along their largest axes, to reject clutter
+	void setMaxTrackDistance(Scalar newMaxTrackDistance); // Sets the maximum distance a subject can move between updates and keep its ID
+	void setTrackTimeout(double newTrackTimeout); // Sets the time after which undetected subjects are dropped in seconds
+	void setTrackingCallback(TrackingCallback* newTrackingCallback); // Sets the function called after each processed frame; class takes ownership of new-allocated function object
+	SubjectList processFrame(unsigned int cameraIndex,const FrameBuffer& depthFrame); // Segments the given depth frame from the given camera and returns the updated list of tracked subjects; can be called concurrently for different cameras
+	SubjectList getSubjects(void); // Returns the current list of tracked subjects
+	};
+
+}
+
+#endif
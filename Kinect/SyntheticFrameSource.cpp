@@ -0,0 +1,477 @@
+/***********************************************************************
+SyntheticFrameSource - Class for frame sources that ray-cast scenes of
+analytic, optionally moving, planes and spheres through a depth camera
+model, and deliver deterministic depth and registered color frames with
+the camera's depth quantization and a configurable noise model.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Kinect/SyntheticFrameSource.h>
+
+#include <string.h>
+#include <stdexcept>
+#include <Misc/FunctionCalls.h>
+#include <Misc/StdError.h>
+#include <Misc/MessageLogger.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Geometry/ProjectiveTransformation.h>
+
+namespace Kinect {
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class RandomGenerator // Class for deterministic pseudo-random number sequences using the SplitMix64 generator
+	{
+	/* Elements: */
+	private:
+	Misc::UInt64 state; // Generator state
+	
+	/* Constructors and destructors: */
+	public:
+	RandomGenerator(Misc::UInt64 seed,double time) // Creates a generator for the frame at the given time
+		{
+		/* Mix the seed with the bit pattern of the frame's time stamp: */
+		Misc::UInt64 timeBits;
+		memcpy(&timeBits,&time,sizeof(Misc::UInt64));
+		state=seed^(timeBits*0x9e3779b97f4a7c15ULL);
+		}
+	
+	/* Methods: */
+	Misc::UInt64 next(void) // Returns the next 64-bit pseudo-random number
+		{
+		Misc::UInt64 z=(state+=0x9e3779b97f4a7c15ULL);
+		z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+		z=(z^(z>>27))*0x94d049bb133111ebULL;
+		return z^(z>>31);
+		}
+	double uniform(void) // Returns a uniformly distributed number in [0, 1)
+		{
+		return double(next()>>11)*(1.0/9007199254740992.0);
+		}
+	double gaussian(void) // Returns a normally distributed number with zero mean and unit standard deviation
+		{
+		double u1=1.0-uniform();
+		double u2=uniform();
+		return Math::sqrt(-2.0*Math::log(u1))*Math::cos(2.0*Math::Constants<double>::pi*u2);
+		}
+	};
+
+}
+
+/*******************************************
+Methods of class SyntheticFrameSource::Body:
+*******************************************/
+
+SyntheticFrameSource::Point SyntheticFrameSource::Body::getCenter(double time) const
+	{
+	return center+velocity*Scalar(time)+amplitude*Math::sin(Scalar(2)*Math::Constants<Scalar>::pi*frequency*Scalar(time));
+	}
+
+/*************************************
+Methods of class SyntheticFrameSource:
+*************************************/
+
+void SyntheticFrameSource::createRays(void)
+	{
+	const IntrinsicParameters::PTransform& dp=intrinsicParameters.depthProjection;
+	cameraDepthProjection=Geometry::invert(dp);
+	Scalar farDepth=Scalar(invalidDepth-1);
+	
+	/* Create rays through the undistorted centers of all depth pixels, starting at the near plane: */
+	const Size& depthSize=frameSizes[DEPTH];
+	depthRays.clear();
+	depthRays.reserve(depthSize.volume());
+	bool distorted=!intrinsicParameters.depthLensDistortion.isIdentity();
+	for(unsigned int y=0;y<depthSize[1];++y)
+		for(unsigned int x=0;x<depthSize[0];++x)
+			{
+			IntrinsicParameters::Point2 dip=distorted?intrinsicParameters.undistortDepthPixel(x,y):IntrinsicParameters::Point2(Scalar(x)+Scalar(0.5),Scalar(y)+Scalar(0.5));
+			Ray ray;
+			ray.origin=dp.transform(Point(dip[0],dip[1],Scalar(0)));
+			ray.direction=dp.transform(Point(dip[0],dip[1],farDepth))-ray.origin;
+			ray.direction.normalize();
+			depthRays.push_back(ray);
+			}
+	
+	/* Create rays through the centers of all color pixels, which are registered to undistorted depth image space: */
+	const Size& colorSize=frameSizes[COLOR];
+	colorRays.clear();
+	colorRays.reserve(colorSize.volume());
+	Scalar sx=Scalar(depthSize[0])/Scalar(colorSize[0]);
+	Scalar sy=Scalar(depthSize[1])/Scalar(colorSize[1]);
+	for(unsigned int y=0;y<colorSize[1];++y)
+		for(unsigned int x=0;x<colorSize[0];++x)
+			{
+			Scalar dipX=(Scalar(x)+Scalar(0.5))*sx;
+			Scalar dipY=(Scalar(y)+Scalar(0.5))*sy;
+			Ray ray;
+			ray.origin=dp.transform(Point(dipX,dipY,Scalar(0)));
+			ray.direction=dp.transform(Point(dipX,dipY,farDepth))-ray.origin;
+			ray.direction.normalize();
+			colorRays.push_back(ray);
+			}
+	}
+
+bool SyntheticFrameSource::castRay(const SyntheticFrameSource::Ray& ray,const std::vector<SyntheticFrameSource::Body>& cameraBodies,SyntheticFrameSource::Hit& hit) const
+	{
+	bool result=false;
+	hit.lambda=Math::Constants<Scalar>::max;
+	for(std::vector<Body>::const_iterator bIt=cameraBodies.begin();bIt!=cameraBodies.end();++bIt)
+		{
+		if(bIt->type==PLANE)
+			{
+			/* Intersect the ray with the plane: */
+			Scalar denominator=bIt->normal*ray.direction;
+			if(denominator!=Scalar(0))
+				{
+				Scalar lambda=((bIt->center-ray.origin)*bIt->normal)/denominator;
+				if(lambda>=Scalar(0)&&lambda<hit.lambda)
+					{
+					hit.lambda=lambda;
+					hit.normal=bIt->normal;
+					hit.color=bIt->color;
+					result=true;
+					}
+				}
+			}
+		else
+			{
+			/* Intersect the ray with the sphere: */
+			Vector oc=ray.origin-bIt->center;
+			Scalar ph=oc*ray.direction;
+			Scalar discriminant=ph*ph-(oc.sqr()-bIt->radius*bIt->radius);
+			if(discriminant>=Scalar(0))
+				{
+				Scalar root=Math::sqrt(discriminant);
+				Scalar lambda=-ph-root;
+				if(lambda<Scalar(0))
+					lambda=-ph+root;
+				if(lambda>=Scalar(0)&&lambda<hit.lambda)
+					{
+					hit.lambda=lambda;
+					hit.normal=(ray.origin+ray.direction*lambda)-bIt->center;
+					hit.normal/=bIt->radius;
+					hit.color=bIt->color;
+					result=true;
+					}
+				}
+			}
+		}
+	
+	return result;
+	}
+
+void SyntheticFrameSource::getCameraBodies(double time,std::vector<SyntheticFrameSource::Body>& cameraBodies) const
+	{
+	/* Transform all bodies from world space to camera space at the given time: */
+	ExtrinsicParameters worldCamera=Geometry::invert(extrinsicParameters);
+	cameraBodies.clear();
+	cameraBodies.reserve(bodies.size());
+	for(std::vector<Body>::const_iterator bIt=bodies.begin();bIt!=bodies.end();++bIt)
+		{
+		Body cb=*bIt;
+		Point center=bIt->getCenter(time);
+		cb.center=worldCamera.transform(center);
+		if(cb.type==PLANE)
+			{
+			cb.normal=worldCamera.transform(center+bIt->normal)-cb.center;
+			cb.normal.normalize();
+			}
+		cameraBodies.push_back(cb);
+		}
+	}
+
+void* SyntheticFrameSource::streamingThreadMethod(void)
+	{
+	try
+		{
+		for(unsigned int frameIndex=0;runStreamingThread;++frameIndex)
+			{
+			/* Generate the next frames: */
+			double time=double(frameIndex)/frameRate;
+			FrameBuffer colorFrame,depthFrame;
+			if(colorStreamingCallback!=0)
+				colorFrame=renderColorFrame(time);
+			if(depthStreamingCallback!=0)
+				depthFrame=renderDepthFrame(time);
+			
+			/* Wait until the next frames are due: */
+			Realtime::TimePointMonotonic::sleep(timeBase+Realtime::TimeVector(time));
+			
+			/* Post the next frames to the consumers: */
+			if(colorStreamingCallback!=0)
+				(*colorStreamingCallback)(colorFrame);
+			if(depthStreamingCallback!=0)
+				(*depthStreamingCallback)(depthFrame);
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Print an error message: */
+		Misc::formattedUserError("Kinect::SyntheticFrameSource::streamingThreadMethod: Terminating streaming due to exception %s",err.what());
+		}
+	
+	return 0;
+	}
+
+SyntheticFrameSource::SyntheticFrameSource(const Size& sColorSize,const Size& sDepthSize,const FrameSource::IntrinsicParameters& sIntrinsicParameters,const FrameSource::ExtrinsicParameters& sExtrinsicParameters,double sFrameRate)
+	:intrinsicParameters(sIntrinsicParameters),
+	 extrinsicParameters(sExtrinsicParameters),
+	 frameRate(sFrameRate),
+	 dropoutProbability(0),minCosine(0),
+	 seed(0),
+	 runStreamingThread(false),colorStreamingCallback(0),depthStreamingCallback(0)
+	{
+	if(sColorSize.volume()==0||sDepthSize.volume()==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame size");
+	if(!(frameRate>0.0))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid frame rate %f",frameRate);
+	frameSizes[COLOR]=sColorSize;
+	frameSizes[DEPTH]=sDepthSize;
+	depthNoise[0]=depthNoise[1]=Scalar(0);
+	
+	/* Create the per-pixel rays: */
+	createRays();
+	}
+
+SyntheticFrameSource::~SyntheticFrameSource(void)
+	{
+	/* Stop streaming, just in case: */
+	stopStreaming();
+	}
+
+FrameSource::IntrinsicParameters SyntheticFrameSource::getIntrinsicParameters(void)
+	{
+	return intrinsicParameters;
+	}
+
+FrameSource::ExtrinsicParameters SyntheticFrameSource::getExtrinsicParameters(void)
+	{
+	return extrinsicParameters;
+	}
+
+const Size& SyntheticFrameSource::getActualFrameSize(int sensor) const
+	{
+	return frameSizes[sensor];
+	}
+
+void SyntheticFrameSource::startStreaming(FrameSource::StreamingCallback* newColorStreamingCallback,FrameSource::StreamingCallback* newDepthStreamingCallback)
+	{
+	/* Set the streaming callbacks: */
+	delete colorStreamingCallback;
+	colorStreamingCallback=newColorStreamingCallback;
+	delete depthStreamingCallback;
+	depthStreamingCallback=newDepthStreamingCallback;
+	
+	/* Start the streaming thread: */
+	runStreamingThread=colorStreamingCallback!=0||depthStreamingCallback!=0;
+	if(runStreamingThread)
+		streamingThread.start(this,&SyntheticFrameSource::streamingThreadMethod);
+	}
+
+void SyntheticFrameSource::stopStreaming(void)
+	{
+	/* Stop the streaming thread: */
+	if(runStreamingThread)
+		{
+		runStreamingThread=false;
+		streamingThread.join();
+		}
+	
+	/* Delete the callbacks: */
+	delete colorStreamingCallback;
+	colorStreamingCallback=0;
+	delete depthStreamingCallback;
+	depthStreamingCallback=0;
+	}
+
+FrameSource::IntrinsicParameters SyntheticFrameSource::createIntrinsicParameters(const Size& depthSize,SyntheticFrameSource::Scalar fovY,SyntheticFrameSource::Scalar zMin,SyntheticFrameSource::Scalar zMax,unsigned int dMax)
+	{
+	if(!(zMin>Scalar(0)&&zMax>zMin))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid depth range [%f, %f]",zMin,zMax);
+	
+	IntrinsicParameters result;
+	typedef IntrinsicParameters::PTransform PTransform;
+	
+	/* Calculate the focal length and principal point of a centered pinhole camera: */
+	Scalar f=Scalar(depthSize[1])*Scalar(0.5)/Math::tan(Math::rad(fovY)*Scalar(0.5));
+	Scalar cx=Scalar(depthSize[0])*Scalar(0.5);
+	Scalar cy=Scalar(depthSize[1])*Scalar(0.5);
+	
+	/* Calculate the coefficients of the d = B - A/z quantization formula mapping zMin to 0 and zMax to dMax: */
+	Scalar a=(Scalar(dMax)*zMax*zMin)/(zMax-zMin);
+	Scalar b=Scalar(dMax)+(Scalar(dMax)*zMin)/(zMax-zMin);
+	
+	/* Calculate the un-projection matrix from 3D depth image space into 3D camera space: */
+	PTransform::Matrix& dum=result.depthProjection.getMatrix();
+	dum=PTransform::Matrix::zero;
+	dum(0,0)=Scalar(1)/f;
+	dum(0,3)=-cx/f;
+	dum(1,1)=Scalar(1)/f;
+	dum(1,3)=-cy/f;
+	dum(2,3)=Scalar(-1);
+	dum(3,2)=Scalar(-1)/a;
+	dum(3,3)=b/a;
+	
+	/* Register color frames to depth frames by mapping depth image space to normalized color image space: */
+	result.colorProjection=PTransform::scale(PTransform::Scale(Scalar(1)/Scalar(depthSize[0]),Scalar(1)/Scalar(depthSize[1]),Scalar(1)));
+	
+	/* Update the intrinsic transformations: */
+	result.updateTransforms();
+	
+	return result;
+	}
+
+unsigned int SyntheticFrameSource::addPlane(const SyntheticFrameSource::Point& point,const SyntheticFrameSource::Vector& normal,const FrameSource::ColorPixel& color)
+	{
+	Body body;
+	body.type=PLANE;
+	body.center=point;
+	body.normal=normal;
+	body.normal.normalize();
+	body.radius=Scalar(0);
+	body.color=color;
+	body.velocity=Vector::zero;
+	body.amplitude=Vector::zero;
+	body.frequency=Scalar(0);
+	bodies.push_back(body);
+	
+	return bodies.size()-1;
+	}
+
+unsigned int SyntheticFrameSource::addSphere(const SyntheticFrameSource::Point& center,SyntheticFrameSource::Scalar radius,const FrameSource::ColorPixel& color)
+	{
+	Body body;
+	body.type=SPHERE;
+	body.center=center;
+	body.normal=Vector::zero;
+	body.radius=radius;
+	body.color=color;
+	body.velocity=Vector::zero;
+	body.amplitude=Vector::zero;
+	body.frequency=Scalar(0);
+	bodies.push_back(body);
+	
+	return bodies.size()-1;
+	}
+
+void SyntheticFrameSource::setMotion(unsigned int bodyIndex,const SyntheticFrameSource::Vector& velocity,const SyntheticFrameSource::Vector& amplitude,SyntheticFrameSource::Scalar frequency)
+	{
+	if(bodyIndex>=bodies.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid body index %u",bodyIndex);
+	bodies[bodyIndex].velocity=velocity;
+	bodies[bodyIndex].amplitude=amplitude;
+	bodies[bodyIndex].frequency=frequency;
+	}
+
+void SyntheticFrameSource::setDepthNoise(SyntheticFrameSource::Scalar constant,SyntheticFrameSource::Scalar quadratic)
+	{
+	depthNoise[0]=constant;
+	depthNoise[1]=quadratic;
+	}
+
+void SyntheticFrameSource::setDropout(SyntheticFrameSource::Scalar newDropoutProbability,SyntheticFrameSource::Scalar newMinCosine)
+	{
+	dropoutProbability=newDropoutProbability;
+	minCosine=newMinCosine;
+	}
+
+void SyntheticFrameSource::setSeed(Misc::UInt64 newSeed)
+	{
+	seed=newSeed;
+	}
+
+FrameBuffer SyntheticFrameSource::renderDepthFrame(double time) const
+	{
+	const Size& depthSize=frameSizes[DEPTH];
+	FrameBuffer result(depthSize,depthSize.volume()*sizeof(DepthPixel),MemoryAccounting::CAMERA);
+	result.timeStamp=time;
+	
+	/* Position the scene's bodies at the given time: */
+	std::vector<Body> cameraBodies;
+	getCameraBodies(time,cameraBodies);
+	RandomGenerator rng(seed,time);
+	
+	/* Cast a ray through every depth pixel: */
+	DepthPixel* dPtr=result.getData<DepthPixel>();
+	for(std::vector<Ray>::const_iterator rIt=depthRays.begin();rIt!=depthRays.end();++rIt,++dPtr)
+		{
+		*dPtr=invalidDepth;
+		Hit hit;
+		if(!castRay(*rIt,cameraBodies,hit))
+			continue;
+		
+		/* Drop pixels at grazing viewing angles, and random pixels: */
+		if(Math::abs(hit.normal*rIt->direction)<minCosine||rng.uniform()<dropoutProbability)
+			continue;
+		
+		/* Displace the intersection along the ray by distance-dependent noise: */
+		Point p=rIt->origin+rIt->direction*hit.lambda;
+		Scalar dist2=Geometry::sqrDist(p,Point::origin);
+		Scalar sigma=depthNoise[0]+depthNoise[1]*dist2;
+		if(sigma>Scalar(0))
+			p+=rIt->direction*(sigma*Scalar(rng.gaussian()));
+		
+		/* Quantize the intersection's depth image-space depth value: */
+		Scalar depth=Math::floor(cameraDepthProjection.transform(p)[2]+Scalar(0.5));
+		if(depth>=Scalar(0)&&depth<Scalar(invalidDepth-1))
+			*dPtr=DepthPixel(depth);
+		}
+	
+	return result;
+	}
+
+FrameBuffer SyntheticFrameSource::renderColorFrame(double time) const
+	{
+	const Size& colorSize=frameSizes[COLOR];
+	FrameBuffer result(colorSize,colorSize.volume()*sizeof(ColorPixel),MemoryAccounting::CAMERA);
+	result.timeStamp=time;
+	
+	/* Position the scene's bodies at the given time: */
+	std::vector<Body> cameraBodies;
+	getCameraBodies(time,cameraBodies);
+	
+	/* Cast a ray through every color pixel and shade intersections with a headlight: */
+	ColorPixel* cPtr=result.getData<ColorPixel>();
+	for(std::vector<Ray>::const_iterator rIt=colorRays.begin();rIt!=colorRays.end();++rIt,++cPtr)
+		{
+		Hit hit;
+		if(castRay(*rIt,cameraBodies,hit))
+			{
+			Scalar intensity=Scalar(0.25)+Scalar(0.75)*Math::abs(hit.normal*rIt->direction);
+			for(int i=0;i<3;++i)
+				(*cPtr)[i]=ColorComponent(Scalar(hit.color[i])*intensity+Scalar(0.5));
+			}
+		else
+			{
+			for(int i=0;i<3;++i)
+				(*cPtr)[i]=ColorComponent(0);
+			}
+		}
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,145 @@
+/***********************************************************************
+SyntheticFrameSource - Class for frame sources that ray-cast scenes of
+analytic, optionally moving, planes and spheres through a depth camera
+model, and deliver deterministic depth and registered color frames with
+the camera's depth quantization and a configurable noise model.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef KINECT_SYNTHETICFRAMESOURCE_INCLUDED
+#define KINECT_SYNTHETICFRAMESOURCE_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/Thread.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+
+namespace Kinect {
+
+class SyntheticFrameSource:public FrameSource
+	{
+	/* Embedded classes: */
+	public:
+	typedef IntrinsicParameters::Scalar Scalar; // Scalar type for camera and world space
+	typedef Geometry::Point<Scalar,3> Point; // Type for points in camera and world space
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors in camera and world space
+	
+	enum BodyType // Enumerated type for analytic scene primitives
+		{
+		PLANE=0,SPHERE
+		};
+	
+	struct Body // Structure describing an analytic scene primitive and its motion in world space
+		{
+		/* Elements: */
+		public:
+		BodyType type; // Primitive type
+		Point center; // A point on the plane, or the sphere's center, at time zero
+		Vector normal; // Plane's unit normal vector
+		Scalar radius; // Sphere's radius
+		ColorPixel color; // Body's RGB color
+		Vector velocity; // Linear velocity of the body's center
+		Vector amplitude; // Amplitude of a sinusoidal oscillation of the body's center
+		Scalar frequency; // Frequency of the body's oscillation in Hz
+		
+		/* Methods: */
+		Point getCenter(double time) const; // Returns the body's center at the given time
+		};
+	
+	private:
+	struct Ray // Structure for per-pixel rays in camera space
+		{
+		/* Elements: */
+		public:
+		Point origin; // Ray's intersection with the camera's near plane
+		Vector direction; // Ray's unit direction vector
+		};
+	
+	struct Hit // Structure describing the intersection of a pixel ray with the scene
+		{
+		/* Elements: */
+		public:
+		Scalar lambda; // Ray parameter of the intersection
+		Vector normal; // Surface normal vector at the intersection in camera space
+		ColorPixel color; // Color of the intersected body
+		};
+	
+	/* Elements: */
+	Size frameSizes[2]; // Sizes of color and depth frames
+	IntrinsicParameters intrinsicParameters; // Intrinsic parameters of the simulated camera
+	ExtrinsicParameters extrinsicParameters; // Extrinsic parameters of the simulated camera
+	IntrinsicParameters::PTransform cameraDepthProjection; // Projection from camera space to depth image space
+	std::vector<Ray> depthRays; // Camera-space rays through the centers of all depth pixels
+	std::vector<Ray> colorRays; // Camera-space rays through the centers of all color pixels
+	std::vector<Body> bodies; // List of bodies in the scene
+	double frameRate; // Frame rate of streamed frames in Hz
+	Scalar depthNoise[2]; // Constant and quadratic coefficients of the standard deviation of depth noise as a function of distance from the camera
+	Scalar dropoutProbability; // Probability of a valid pixel being randomly invalidated
+	Scalar minCosine; // Minimum cosine between a surface's normal vector and the viewing direction for a pixel to be valid
+	Misc::UInt64 seed; // Seed of the per-frame pseudo-random number generators
+	volatile bool runStreamingThread; // Flag to shut down the streaming thread
+	StreamingCallback* colorStreamingCallback; // Callback to be called when a new color frame has been generated
+	StreamingCallback* depthStreamingCallback; // Callback to be called when a new depth frame has been generated
+	Threads::Thread streamingThread; // Thread generating color and depth frames
+	
+	/* Private methods: */
+	void createRays(void); // Creates camera-space pixel rays for the current frame sizes and intrinsic parameters
+	bool castRay(const Ray& ray,const std::vector<Body>& cameraBodies,Hit& hit) const; // Intersects the given ray with the given bodies in camera space; returns true if there is an intersection
+	void getCameraBodies(double time,std::vector<Body>& cameraBodies) const; // Transforms all bodies into camera space at the given time
+	void* streamingThreadMethod(void); // Thread method generating color and depth frames
+	
+	/* Constructors and destructors: */
+	public:
+	SyntheticFrameSource(const Size& sColorSize,const Size& sDepthSize,const IntrinsicParameters& sIntrinsicParameters,const ExtrinsicParameters& sExtrinsicParameters,double sFrameRate =30.0); // Creates a synthetic frame source with the given frame sizes, camera parameters, and frame rate
+	virtual ~SyntheticFrameSource(void);
+	
+	/* Methods from class FrameSource: */
+	virtual IntrinsicParameters getIntrinsicParameters(void);
+	virtual ExtrinsicParameters getExtrinsicParameters(void);
+	virtual const Size& getActualFrameSize(int sensor) const;
+	virtual void startStreaming(StreamingCallback* newColorStreamingCallback,StreamingCallback* newDepthStreamingCallback);
+	virtual void stopStreaming(void);
+	
+	/* New methods: */
+	static IntrinsicParameters createIntrinsicParameters(const Size& depthSize,Scalar fovY,Scalar zMin,Scalar zMax,unsigned int dMax =2047U); // Returns intrinsic parameters of a distortion-free depth camera with the given frame size and vertical field of view in degrees, mapping camera-space distances between zMin and zMax to raw depth values between 0 and dMax using the d = B - A/z quantization formula of Kinect v2 and RealSense cameras; color frames are registered to depth frames
+	double getFrameRate(void) const // Returns the frame rate of streamed frames
+		{
+		return frameRate;
+		}
+	unsigned int addPlane(const Point& point,const Vector& normal,const ColorPixel& color); // Adds a plane through the given point with the given normal vector and color to the scene; returns the body's index
+	unsigned int addSphere(const Point& center,Scalar radius,const ColorPixel& color); // Adds a sphere with the given center, radius, and color to the scene; returns the body's index
+	void setMotion(unsigned int bodyIndex,const Vector& velocity,const Vector& amplitude,Scalar frequency); // Sets the given body's linear velocity and sinusoidal oscillation
+	const std::vector<Body>& getBodies(void) const // Returns the list of bodies in the scene
+		{
+		return bodies;
+		}
+	void setDepthNoise(Scalar constant,Scalar quadratic); // Sets the standard deviation of depth noise along pixel rays to constant + quadratic*distance^2
+	void setDropout(Scalar newDropoutProbability,Scalar newMinCosine); // Sets the probability of random pixel dropouts, and the minimum cosine of the viewing angle below which pixels are invalid
+	void setSeed(Misc::UInt64 newSeed); // Sets the seed of the pseudo-random number generators; frames generated for the same time with the same seed are identical
+	FrameBuffer renderDepthFrame(double time) const; // Returns a depth frame of the scene at the given time, with the given time as time stamp
+	FrameBuffer renderColorFrame(double time) const; // Returns a color frame of the scene at the given time, with the given time as time stamp
+	};
+
+}
+
+#endif
@@ -23,43 +23,260 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include "KinectServer.h"
 
+#include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 #include <errno.h>
 #include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/timerfd.h>
 #include <iostream>
+#include <sstream>
 #include <Misc/SizedTypes.h>
 #include <Misc/PrintInteger.h>
 #include <Misc/StdError.h>
 #include <Misc/FunctionCalls.h>
 #include <Misc/Time.h>
+#include <Misc/Marshaller.h>
+#include <Misc/StandardMarshallers.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/CompoundValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <USB/DeviceList.h>
 #include <IO/File.h>
+#include <Comm/ListeningUNIXSocket.h>
+#include <Comm/UNIXPipe.h>
 #include <Geometry/GeometryMarshallers.h>
-#include <Video/Config.h>
 #include <Kinect/Internal/Config.h>
 #include <Kinect/DirectFrameSource.h>
 #include <Kinect/OpenDirectFrameSource.h>
+#include <Kinect/Camera.h>
 #include <Kinect/ColorFrameWriter.h>
-#include <Kinect/DepthFrameWriter.h>
-#include <Kinect/LossyDepthFrameWriter.h>
+#include <Kinect/FrameChangeDetector.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+Kinect::FrameWriter* createDepthCompressor(Kinect::DepthFrameCodec codec,IO::File& sink,const Kinect::Size& size) // Creates a depth frame compressor that writes frames in the depth stream format version announced for the given codec
+	{
+	Kinect::FrameWriter* result=Kinect::createDepthFrameWriter(codec,sink,size);
+	result->setWriteMetadata(Kinect::hasDepthFrameMetadata(Kinect::getDepthFormatVersion(codec)));
+	return result;
+	}
+
+void unlinkSocket(const std::string& socketName) // Removes the UNIX domain socket of the given name, but leaves any other kind of file alone
+	{
+	struct stat socketStat;
+	if(lstat(socketName.c_str(),&socketStat)==0&&S_ISSOCK(socketStat.st_mode))
+		unlink(socketName.c_str());
+	}
+
+/****************************************
+Helper functions for shard communication:
+****************************************/
+
+void copyBlock(IO::File& source,size_t size,IO::File& sink) // Copies a block of data of the given size from the given source to the given sink
+	{
+	Misc::UInt8 buffer[16384];
+	while(size>0)
+		{
+		size_t blockSize=size<sizeof(buffer)?size:sizeof(buffer);
+		source.read<Misc::UInt8>(buffer,blockSize);
+		sink.write<Misc::UInt8>(buffer,blockSize);
+		size-=blockSize;
+		}
+	}
+
+void skipHeaderBlock(IO::File& source) // Skips a stream's codec and size-prefixed compressor headers sent by a shard worker
+	{
+	source.skip<Misc::UInt32>(1);
+	size_t headerSize=source.read<Misc::UInt32>();
+	source.skip<Misc::UInt8>(headerSize);
+	}
+
+void readCameraParameters(IO::File& source,std::string& serialNumber,Kinect::Size& depthSize,Kinect::FrameSource::DepthCorrection*& depthCorrection,Kinect::FrameSource::IntrinsicParameters& ips,Kinect::FrameSource::ExtrinsicParameters& eps) // Reads a camera's parameters written by a shard worker, up to the camera's stream headers
+	{
+	/* Read the camera's serial number and depth frame size: */
+	serialNumber=Misc::Marshaller<std::string>::read(source);
+	for(int i=0;i<2;++i)
+		depthSize[i]=source.read<Misc::UInt32>();
+	
+	/* Read the camera's depth correction parameters if it has them: */
+	depthCorrection=0;
+	if(source.read<Misc::UInt8>()!=0)
+		depthCorrection=new Kinect::FrameSource::DepthCorrection(source);
+	
+	/* Read the camera's intrinsic and extrinsic parameters: */
+	ips.colorLensDistortion=Kinect::FrameSource::IntrinsicParameters::readLensDistortion(source,true);
+	ips.depthLensDistortion=Kinect::FrameSource::IntrinsicParameters::readLensDistortion(source,true);
+	ips.colorProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(source);
+	ips.depthProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(source);
+	ips.updateTransforms();
+	eps=Misc::Marshaller<Kinect::FrameSource::ExtrinsicParameters>::read(source);
+	}
+
+}
 
 /******************************************
 Methods of class KinectServer::CameraState:
 ******************************************/
 
+void KinectServer::CameraState::updateColorCompressor(void)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	
+	/* Compare the next frame against nothing and compress it as a key frame if a full frame was requested: */
+	if(forceColorFrame)
+		{
+		if(colorChangeDetector!=0)
+			colorChangeDetector->reset();
+		colorCompressor->requestKeyFrame();
+		forceColorFrame=false;
+		}
+	
+	/* Bail out if there is no new codec, or if clients have not yet been sent the headers of the previous change: */
+	if(requestedColorCodec==colorCodecs[colorGeneration&0x1U]||sentColorGeneration!=colorGeneration)
+		return;
+	
+	try
+		{
+		/* Create a compressor for the new codec and extract its stream header data into the next generation's slot: */
+		unsigned int nextSlot=(colorGeneration+1U)&0x1U;
+		Kinect::FrameWriter* newColorCompressor=Kinect::createColorFrameWriter(requestedColorCodec,colorFile,camera->getActualFrameSize(Kinect::FrameSource::COLOR),camera->getColorSpace());
+		colorFile.storeBuffers(colorHeaders[nextSlot]);
+		colorCodecs[nextSlot]=requestedColorCodec;
+		
+		/* Replace the current compressor: */
+		delete colorCompressor;
+		colorCompressor=newColorCompressor;
+		++colorGeneration;
+		
+		/* Always send the first frame compressed with the new codec: */
+		if(colorChangeDetector!=0)
+			colorChangeDetector->reset();
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"KinectServer: Unable to switch to "<<Kinect::getColorFrameCodecName(requestedColorCodec)<<" color frame codec due to exception "<<err.what()<<std::endl;
+		requestedColorCodec=colorCodecs[colorGeneration&0x1U];
+		}
+	}
+
+void KinectServer::CameraState::updateDepthCompressor(void)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	
+	/* Compare the next frame against nothing and compress it as a key frame if a full frame was requested: */
+	if(forceDepthFrame)
+		{
+		if(depthChangeDetector!=0)
+			depthChangeDetector->reset();
+		depthCompressor->requestKeyFrame();
+		forceDepthFrame=false;
+		}
+	
+	/* Bail out if there is no new codec, or if clients have not yet been sent the headers of the previous change: */
+	if(requestedDepthCodec==depthCodecs[depthGeneration&0x1U]||sentDepthGeneration!=depthGeneration)
+		return;
+	
+	try
+		{
+		/* Create a compressor for the new codec and extract its stream header data into the next generation's slot: */
+		unsigned int nextSlot=(depthGeneration+1U)&0x1U;
+		Kinect::FrameWriter* newDepthCompressor=createDepthCompressor(requestedDepthCodec,depthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
+		depthFile.storeBuffers(depthHeaders[nextSlot]);
+		depthCodecs[nextSlot]=requestedDepthCodec;
+		
+		/* Replace the current compressor: */
+		delete depthCompressor;
+		depthCompressor=newDepthCompressor;
+		++depthGeneration;
+		
+		/* Only receive compressed depth frames from first-generation Kinect cameras if the new codec can pass them through: */
+		Kinect::Camera* kinectV1=dynamic_cast<Kinect::Camera*>(camera);
+		if(kinectV1!=0)
+			kinectV1->setDeliverRawDepthFrames(requestedDepthCodec==Kinect::DEPTH_CODEC_KINECTV1);
+		
+		/* Always send the first frame compressed with the new codec: */
+		if(depthChangeDetector!=0)
+			depthChangeDetector->reset();
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"KinectServer: Unable to switch to "<<Kinect::getDepthFrameCodecName(requestedDepthCodec)<<" depth frame codec due to exception "<<err.what()<<std::endl;
+		requestedDepthCodec=depthCodecs[depthGeneration&0x1U];
+		}
+	}
+
+void KinectServer::CameraState::applyCameraSettings(void)
+	{
+	/* Retrieve the requested camera settings: */
+	unsigned int settings;
+	bool removeBackground,removeFloor,replaceBackground;
+	int backgroundFuzz;
+	unsigned int maxDepth,numBackgroundFrames;
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	settings=pendingSettings;
+	pendingSettings=0x0U;
+	removeBackground=requestedRemoveBackground;
+	backgroundFuzz=requestedBackgroundFuzz;
+	maxDepth=requestedMaxDepth;
+	removeFloor=requestedRemoveFloor;
+	numBackgroundFrames=requestedNumBackgroundFrames;
+	replaceBackground=requestedReplaceBackground;
+	}
+	
+	/* Apply the requested settings while the camera is between depth frames: */
+	if(settings&SET_REMOVE_BACKGROUND)
+		camera->setRemoveBackground(removeBackground);
+	if(settings&SET_BACKGROUND_FUZZ)
+		camera->setBackgroundRemovalFuzz(backgroundFuzz);
+	if(settings&SET_MAX_DEPTH)
+		camera->setMaxDepth(maxDepth,false);
+	if(settings&SET_REMOVE_FLOOR)
+		camera->setRemoveFloor(removeFloor);
+	if(settings&CAPTURE_BACKGROUND)
+		camera->captureBackground(numBackgroundFrames,replaceBackground);
+	}
+
 void KinectServer::CameraState::colorStreamingCallback(const Kinect::FrameBuffer& frame)
 	{
-	/* Pass the frame to the color compressor: */
-	colorCompressor->writeFrame(frame);
+	/* Apply a pending codec change between frames: */
+	updateColorCompressor();
+	
+	/* Pass the frame to the color compressor unless it is identical to the most recently compressed frame up to sensor noise: */
+	bool unchanged=colorChangeDetector!=0&&!colorChangeDetector->update(frame);
+	if(unchanged&&!colorCompressor->wasKeyFrame())
+		{
+		/* Compress the first frame of a static scene as a key frame, which can be re-sent to clients that do not understand unchanged frame markers: */
+		colorCompressor->requestKeyFrame();
+		unchanged=false;
+		}
+	if(!unchanged)
+		colorCompressor->writeFrame(frame);
 	
 	/* Store the compressed frame data in the color frame triple buffer: */
 	CompressedFrame& compressedFrame=colorFrames.startNewValue();
 	compressedFrame.index=colorFrameIndex;
+	compressedFrame.generation=colorGeneration;
 	compressedFrame.timeStamp=frame.timeStamp;
+	compressedFrame.dataSize=colorFile.getDataSize();
 	colorFile.storeBuffers(compressedFrame.data);
+	compressedFrame.keyFrame=!unchanged&&colorCompressor->wasKeyFrame();
+	compressedFrame.unchanged=unchanged;
+	compressedFrame.updateHeldSize();
 	colorFrames.postNewValue();
 	++colorFrameIndex;
 	
@@ -69,16 +286,60 @@ void KinectServer::CameraState::colorStreamingCallback(const Kinect::FrameBuffer
 		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Write error on pipe");
 	}
 
+void KinectServer::CameraState::rawDepthStreamingCallback(const Kinect::KinectV1RawDepthFrame& rawFrame)
+	{
+	/* Keep the compressed frame until its decoded version arrives, which happens immediately afterwards in the same thread: */
+	rawDepthFrame=rawFrame;
+	}
+
 void KinectServer::CameraState::depthStreamingCallback(const Kinect::FrameBuffer& frame)
 	{
-	/* Pass the frame to the depth compressor: */
-	depthCompressor->writeFrame(frame);
+	/* Apply pending camera settings and a pending codec change between frames: */
+	applyCameraSettings();
+	updateDepthCompressor();
+	
+	/* Pass the frame to the depth compressor unless it is identical to the most recently compressed frame up to sensor noise: */
+	bool unchanged=depthChangeDetector!=0&&!depthChangeDetector->update(frame);
+	if(unchanged&&!depthCompressor->wasKeyFrame())
+		{
+		/* Compress the first frame of a static scene as a key frame, which can be re-sent to clients that do not understand unchanged frame markers: */
+		depthCompressor->requestKeyFrame();
+		unchanged=false;
+		}
+	if(!unchanged)
+		{
+		/* Pass the camera's compressed frame through if the depth codec uses the camera's native format: */
+		Kinect::KinectV1DepthFrameWriter* rawDepthCompressor=dynamic_cast<Kinect::KinectV1DepthFrameWriter*>(depthCompressor);
+		if(rawDepthCompressor!=0&&rawDepthFrame.data.isValid()&&rawDepthFrame.data.timeStamp==frame.timeStamp)
+			rawDepthCompressor->writeRawFrame(rawDepthFrame,frame);
+		else
+			depthCompressor->writeFrame(frame);
+		}
+	
+	/* Release the compressed frame: */
+	rawDepthFrame.data=Kinect::FrameBuffer();
 	
 	/* Store the compressed frame data in the depth frame triple buffer: */
 	CompressedFrame& compressedFrame=depthFrames.startNewValue();
 	compressedFrame.index=depthFrameIndex;
+	compressedFrame.generation=depthGeneration;
 	compressedFrame.timeStamp=frame.timeStamp;
+	compressedFrame.dataSize=depthFile.getDataSize();
 	depthFile.storeBuffers(compressedFrame.data);
+	compressedFrame.keyFrame=!unchanged&&depthCompressor->wasKeyFrame();
+	compressedFrame.unchanged=unchanged;
+	
+	/* Release an uncompressed frame left in the triple buffer slot by an earlier frame: */
+	compressedFrame.frame=Kinect::FrameBuffer();
+	if(!unchanged)
+		{
+		/* Calculate the frame's tile depth ranges for view-dependent culling, and keep the uncompressed frame if it can be cropped: */
+		depthTileCuller->calcTileRanges(frame,compressedFrame.tileRanges);
+		compressedFrame.validTiles=Kinect::DepthTileCuller::calcValidTiles(compressedFrame.tileRanges);
+		if(depthCodecs[depthGeneration&0x1U]!=Kinect::DEPTH_CODEC_THEORA)
+			compressedFrame.frame=frame;
+		}
+	compressedFrame.updateHeldSize();
 	depthFrames.postNewValue();
 	++depthFrameIndex;
 	
@@ -88,13 +349,18 @@ void KinectServer::CameraState::depthStreamingCallback(const Kinect::FrameBuffer
 		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Write error on pipe");
 	}
 
-KinectServer::CameraState::CameraState(const char* serialNumber,bool sLossyDepthCompression)
-	:camera(Kinect::openDirectFrameSource(serialNumber,false)),cameraIndex(0U),
+KinectServer::CameraState::CameraState(const char* sSerialNumber,Kinect::DepthFrameCodec sDepthCodec,Kinect::ColorFrameCodec sColorCodec,bool bayerPassthrough)
+	:camera(Kinect::openDirectFrameSource(sSerialNumber,false)),serialNumber(camera->getSerialNumber()),cameraIndex(0U),
 	 depthCorrection(0),framePipeFd(-1),
-	 colorFile(16384),colorCompressor(0),
-	 colorFrameIndex(0),hasSentColorFrame(false),
-	 depthFile(16384),lossyDepthCompression(sLossyDepthCompression),depthCompressor(0),
-	 depthFrameIndex(0),hasSentDepthFrame(false)
+	 shard(0),shardCameraIndex(0),online(true),
+	 pendingSettings(0x0U),requestedRemoveBackground(false),requestedBackgroundFuzz(0),requestedMaxDepth(0),requestedRemoveFloor(false),
+	 requestedNumBackgroundFrames(0),requestedReplaceBackground(false),
+	 colorFile(16384),requestedColorCodec(sColorCodec),colorGeneration(0),sentColorGeneration(0),colorCompressor(0),
+	 colorFrameIndex(0),hasSentColorFrame(false),colorChangeDetector(0),forceColorFrame(false),hasLastColorFrame(false),
+	 depthFile(16384),requestedDepthCodec(sDepthCodec),depthGeneration(0),sentDepthGeneration(0),depthCompressor(0),
+	 depthFrameIndex(0),hasSentDepthFrame(false),
+	 depthTileCuller(0),croppedDepthFile(16384),croppedDepthCompressor(0),
+	 depthChangeDetector(0),forceDepthFrame(false),hasLastDepthFrame(false),lastFrameFile(16384)
 	{
 	/* Retrieve the camera's depth correction parameters: */
 	depthCorrection=camera->getDepthCorrectionParameters();
@@ -103,30 +369,80 @@ KinectServer::CameraState::CameraState(const char* serialNumber,bool sLossyDepth
 	ips=camera->getIntrinsicParameters();
 	eps=camera->getExtrinsicParameters();
 	
+	/* Receive compressed depth frames from first-generation Kinect cameras while the depth codec can pass them through; decoded frames are still needed for change detection and culling: */
+	Kinect::Camera* kinectV1=dynamic_cast<Kinect::Camera*>(camera);
+	if(kinectV1!=0)
+		{
+		kinectV1->setRawDepthStreamingCallback(Misc::createFunctionCall(this,&KinectServer::CameraState::rawDepthStreamingCallback));
+		kinectV1->setDeliverRawDepthFrames(sDepthCodec==Kinect::DEPTH_CODEC_KINECTV1);
+		}
+	
+	/* Request raw Bayer color frames from first-generation Kinect cameras: */
+	if(bayerPassthrough)
+		{
+		if(kinectV1!=0)
+			kinectV1->setBayerPassthrough(true);
+		else
+			std::cerr<<"KinectServer: Camera with serial number "<<sSerialNumber<<" does not support raw Bayer color frames"<<std::endl;
+		}
+	
 	/* Create the color and depth frame compressors: */
-	colorCompressor=new Kinect::ColorFrameWriter(colorFile,camera->getActualFrameSize(Kinect::FrameSource::COLOR),camera->getColorSpace());
-	#if VIDEO_CONFIG_HAVE_THEORA
-	if(lossyDepthCompression)
-		depthCompressor=new Kinect::LossyDepthFrameWriter(depthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
-	else
-		depthCompressor=new Kinect::DepthFrameWriter(depthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
-	#else
-	depthCompressor=new Kinect::DepthFrameWriter(depthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
-	#endif
+	colorCodecs[0]=colorCodecs[1]=sColorCodec;
+	depthCodecs[0]=depthCodecs[1]=sDepthCodec;
+	colorCompressor=Kinect::createColorFrameWriter(sColorCodec,colorFile,camera->getActualFrameSize(Kinect::FrameSource::COLOR),camera->getColorSpace());
+	depthCompressor=createDepthCompressor(sDepthCodec,depthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
 	
 	/* Extract the color and depth compressors' stream header data: */
-	colorFile.storeBuffers(colorHeaders);
-	depthFile.storeBuffers(depthHeaders);
+	colorFile.storeBuffers(colorHeaders[0]);
+	depthFile.storeBuffers(depthHeaders[0]);
+	
+	/* Create a tile culler for view-dependent streaming: */
+	Kinect::Size depthSize=camera->getActualFrameSize(Kinect::FrameSource::DEPTH);
+	depthTileCuller=new Kinect::DepthTileCuller(depthSize,depthCorrection,ips,eps);
+	
+	/* Create a second depth compressor for cropped frames if the depth codec compresses each frame independently: */
+	if(sDepthCodec!=Kinect::DEPTH_CODEC_THEORA)
+		{
+		croppedDepthCompressor=createDepthCompressor(sDepthCodec,croppedDepthFile,depthSize);
+		
+		/* Discard the cropped depth compressor's stream header data, which is identical to the depth compressor's: */
+		IO::VariableMemoryFile::BufferChain croppedDepthHeaders;
+		croppedDepthFile.storeBuffers(croppedDepthHeaders);
+		}
+	}
+
+KinectServer::CameraState::CameraState(KinectServer::ShardState* sShard,const std::string& sSerialNumber,const Kinect::Size& depthSize,Kinect::FrameSource::DepthCorrection* sDepthCorrection,const Kinect::FrameSource::IntrinsicParameters& sIps,const Kinect::FrameSource::ExtrinsicParameters& sEps)
+	:camera(0),serialNumber(sSerialNumber),cameraIndex(0U),
+	 depthCorrection(sDepthCorrection),ips(sIps),eps(sEps),framePipeFd(-1),
+	 shard(sShard),shardCameraIndex(0),online(false),
+	 pendingSettings(0x0U),requestedRemoveBackground(false),requestedBackgroundFuzz(0),requestedMaxDepth(0),requestedRemoveFloor(false),
+	 requestedNumBackgroundFrames(0),requestedReplaceBackground(false),
+	 colorFile(16384),requestedColorCodec(Kinect::COLOR_CODEC_THEORA),colorGeneration(0),sentColorGeneration(0),colorCompressor(0),
+	 colorFrameIndex(0),hasSentColorFrame(true),colorChangeDetector(0),forceColorFrame(false),hasLastColorFrame(false),
+	 depthFile(16384),requestedDepthCodec(Kinect::DEPTH_CODEC_HUFFMAN),depthGeneration(0),sentDepthGeneration(0),depthCompressor(0),
+	 depthFrameIndex(0),hasSentDepthFrame(true),
+	 depthTileCuller(0),croppedDepthFile(16384),croppedDepthCompressor(0),
+	 depthChangeDetector(0),forceDepthFrame(false),hasLastDepthFrame(false),lastFrameFile(16384)
+	{
+	/* Create a tile culler for view-dependent streaming; frames compressed by a shard worker can be culled, but not cropped: */
+	depthTileCuller=new Kinect::DepthTileCuller(depthSize,depthCorrection,ips,eps);
 	}
 
 KinectServer::CameraState::~CameraState(void)
 	{
 	/* Stop streaming: */
-	camera->stopStreaming();
+	if(camera!=0)
+		camera->stopStreaming();
 	
 	/* Destroy the color and depth compressors: */
 	delete colorCompressor;
 	delete depthCompressor;
+	delete croppedDepthCompressor;
+	
+	/* Destroy the tile culler and change detectors: */
+	delete depthTileCuller;
+	delete colorChangeDetector;
+	delete depthChangeDetector;
 	
 	/* Destroy the depth correction parameters: */
 	delete depthCorrection;
@@ -142,11 +458,153 @@ void KinectServer::CameraState::startStreaming(const Kinect::FrameSource::Time&
 	camera->startStreaming(Misc::createFunctionCall(this,&KinectServer::CameraState::colorStreamingCallback),Misc::createFunctionCall(this,&KinectServer::CameraState::depthStreamingCallback));
 	}
 
+void KinectServer::CameraState::enableStaticFrameSkipping(unsigned int depthThreshold,unsigned int colorThreshold,double tileFraction,unsigned int maxStaticFrames)
+	{
+	/* Create a change detector for depth frames: */
+	delete depthChangeDetector;
+	depthChangeDetector=new Kinect::FrameChangeDetector(camera->getActualFrameSize(Kinect::FrameSource::DEPTH),true);
+	depthChangeDetector->setPixelThreshold(depthThreshold);
+	depthChangeDetector->setTileFraction(tileFraction);
+	depthChangeDetector->setMaxStaticFrames(maxStaticFrames);
+	
+	/* Create a change detector for color frames, which have a single component per pixel if they are raw Bayer frames: */
+	delete colorChangeDetector;
+	unsigned int numColorComponents=camera->getColorSpace()==Kinect::FrameSource::BAYER_BGGR?1U:3U;
+	colorChangeDetector=new Kinect::FrameChangeDetector(camera->getActualFrameSize(Kinect::FrameSource::COLOR),false,numColorComponents);
+	colorChangeDetector->setPixelThreshold(colorThreshold);
+	colorChangeDetector->setTileFraction(tileFraction);
+	colorChangeDetector->setMaxStaticFrames(maxStaticFrames);
+	}
+
+void KinectServer::CameraState::requestFullFrames(void)
+	{
+	if(shard!=0)
+		{
+		/* Forward the request to the shard worker serving the camera: */
+		if(shard->pipe!=0)
+			{
+			try
+				{
+				shard->pipe->write<Misc::UInt32>(SHARD_FULL_FRAMES);
+				shard->pipe->write<Misc::UInt32>(shardCameraIndex);
+				shard->pipe->flush();
+				}
+			catch(const std::runtime_error&)
+				{
+				/* Ignore the error; the run loop will notice the shard worker's failure: */
+				}
+			}
+		}
+	else
+		{
+		Threads::Mutex::Lock settingsLock(settingsMutex);
+		forceColorFrame=true;
+		forceDepthFrame=true;
+		}
+	}
+
+void KinectServer::CameraState::requestColorCodec(Kinect::ColorFrameCodec newColorCodec)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedColorCodec=newColorCodec;
+	}
+
+void KinectServer::CameraState::requestDepthCodec(Kinect::DepthFrameCodec newDepthCodec)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedDepthCodec=newDepthCodec;
+	}
+
+bool KinectServer::CameraState::getRemoveBackground(void)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	return (pendingSettings&SET_REMOVE_BACKGROUND)?requestedRemoveBackground:camera->getRemoveBackground();
+	}
+
+int KinectServer::CameraState::getBackgroundFuzz(void)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	return (pendingSettings&SET_BACKGROUND_FUZZ)?requestedBackgroundFuzz:camera->getBackgroundRemovalFuzz();
+	}
+
+bool KinectServer::CameraState::getRemoveFloor(void)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	return (pendingSettings&SET_REMOVE_FLOOR)?requestedRemoveFloor:camera->getRemoveFloor();
+	}
+
+void KinectServer::CameraState::requestRemoveBackground(bool newRemoveBackground)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedRemoveBackground=newRemoveBackground;
+	pendingSettings|=SET_REMOVE_BACKGROUND;
+	}
+
+void KinectServer::CameraState::requestBackgroundFuzz(int newBackgroundFuzz)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedBackgroundFuzz=newBackgroundFuzz;
+	pendingSettings|=SET_BACKGROUND_FUZZ;
+	}
+
+void KinectServer::CameraState::requestMaxDepth(unsigned int newMaxDepth)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedMaxDepth=newMaxDepth;
+	pendingSettings|=SET_MAX_DEPTH;
+	}
+
+void KinectServer::CameraState::requestRemoveFloor(bool newRemoveFloor)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedRemoveFloor=newRemoveFloor;
+	pendingSettings|=SET_REMOVE_FLOOR;
+	}
+
+void KinectServer::CameraState::requestBackgroundCapture(unsigned int numFrames,bool replace)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	requestedNumBackgroundFrames=numFrames;
+	requestedReplaceBackground=replace;
+	pendingSettings|=CAPTURE_BACKGROUND;
+	}
+
+void KinectServer::CameraState::setSentColorGeneration(unsigned int newSentColorGeneration)
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	sentColorGeneration=newSentColorGeneration;
+	}
+
+void KinectServer::CameraState::setSentDepthGeneration(unsigned int newSentDepthGeneration)
+	{
+	{
+	Threads::Mutex::Lock settingsLock(settingsMutex);
+	sentDepthGeneration=newSentDepthGeneration;
+	}
+	
+	/* Replace the cropped depth compressor, which is only used by the run loop and only if the camera is served by this process: */
+	delete croppedDepthCompressor;
+	croppedDepthCompressor=0;
+	Kinect::DepthFrameCodec depthCodec=getDepthCodec();
+	if(camera!=0&&depthCodec!=Kinect::DEPTH_CODEC_THEORA)
+		{
+		croppedDepthCompressor=createDepthCompressor(depthCodec,croppedDepthFile,camera->getActualFrameSize(Kinect::FrameSource::DEPTH));
+		
+		/* Discard the cropped depth compressor's stream header data, which is identical to the depth compressor's: */
+		IO::VariableMemoryFile::BufferChain croppedDepthHeaders;
+		croppedDepthFile.storeBuffers(croppedDepthHeaders);
+		}
+	}
+
 void KinectServer::CameraState::writeHeaders(IO::File& sink) const
 	{
 	/* Write the stream format versions: */
-	sink.write<Misc::UInt32>(2);
-	sink.write<Misc::UInt32>(6);
+	Kinect::ColorFrameCodec colorCodec=getColorCodec();
+	Kinect::DepthFrameCodec depthCodec=getDepthCodec();
+	unsigned int colorFormatVersion=Kinect::getColorFormatVersion(colorCodec);
+	unsigned int depthFormatVersion=Kinect::getDepthFormatVersion(depthCodec);
+	sink.write<Misc::UInt32>(colorFormatVersion);
+	sink.write<Misc::UInt32>(depthFormatVersion);
 	
 	/* Write the camera's depth correction parameters: */
 	if(depthCorrection!=0)
@@ -158,12 +616,11 @@ void KinectServer::CameraState::writeHeaders(IO::File& sink) const
 		dc.write(sink);
 		}
 	
-	/* Check whether the depth stream uses lossy compression: */
-	#if VIDEO_CONFIG_HAVE_THEORA
-	sink.write<Misc::UInt8>(lossyDepthCompression?1:0);
-	#else
-	sink.write<Misc::UInt8>(0);
-	#endif
+	/* Write the depth stream's compression codec: */
+	Kinect::writeDepthFrameCodec(depthCodec,sink,depthFormatVersion);
+	
+	/* Write the color stream's compression codec: */
+	Kinect::writeColorFrameCodec(colorCodec,sink,colorFormatVersion);
 	
 	/* Write the color and depth cameras' intrinsic parameters to the sink: */
 	ips.writeLensDistortion(ips.colorLensDistortion,sink);
@@ -175,8 +632,109 @@ void KinectServer::CameraState::writeHeaders(IO::File& sink) const
 	Misc::Marshaller<Kinect::FrameSource::ExtrinsicParameters>::write(eps,sink);
 	
 	/* Write the color and depth compression headers: */
-	colorHeaders.writeToSink(sink);
-	depthHeaders.writeToSink(sink);
+	colorHeaders[sentColorGeneration&0x1U].writeToSink(sink);
+	depthHeaders[sentDepthGeneration&0x1U].writeToSink(sink);
+	}
+
+void KinectServer::CameraState::writeColorHeaders(IO::File& sink) const
+	{
+	/* Write the color stream's format version and codec: */
+	Kinect::ColorFrameCodec colorCodec=getColorCodec();
+	unsigned int colorFormatVersion=Kinect::getColorFormatVersion(colorCodec);
+	sink.write<Misc::UInt32>(colorFormatVersion);
+	Kinect::writeColorFrameCodec(colorCodec,sink,colorFormatVersion);
+	
+	/* Write the color compression headers: */
+	colorHeaders[sentColorGeneration&0x1U].writeToSink(sink);
+	}
+
+void KinectServer::CameraState::writeDepthHeaders(IO::File& sink) const
+	{
+	/* Write the depth stream's format version and codec: */
+	Kinect::DepthFrameCodec depthCodec=getDepthCodec();
+	unsigned int depthFormatVersion=Kinect::getDepthFormatVersion(depthCodec);
+	sink.write<Misc::UInt32>(depthFormatVersion);
+	Kinect::writeDepthFrameCodec(depthCodec,sink,depthFormatVersion);
+	
+	/* Write the depth compression headers: */
+	depthHeaders[sentDepthGeneration&0x1U].writeToSink(sink);
+	}
+
+void KinectServer::CameraState::writeDescription(IO::File& sink) const
+	{
+	/* Write the camera's serial number and depth frame size: */
+	Misc::Marshaller<std::string>::write(serialNumber,sink);
+	Kinect::Size depthSize=camera->getActualFrameSize(Kinect::FrameSource::DEPTH);
+	for(int i=0;i<2;++i)
+		sink.write<Misc::UInt32>(depthSize[i]);
+	
+	/* Write the camera's depth correction parameters if it has them: */
+	sink.write<Misc::UInt8>(depthCorrection!=0?1U:0U);
+	if(depthCorrection!=0)
+		depthCorrection->write(sink);
+	
+	/* Write the color and depth cameras' intrinsic parameters and the camera's extrinsic parameters: */
+	ips.writeLensDistortion(ips.colorLensDistortion,sink);
+	ips.writeLensDistortion(ips.depthLensDistortion,sink);
+	Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::write(ips.colorProjection,sink);
+	Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::write(ips.depthProjection,sink);
+	Misc::Marshaller<Kinect::FrameSource::ExtrinsicParameters>::write(eps,sink);
+	
+	/* Write the color and depth streams' current headers: */
+	writeColorHeaderBlock(sink);
+	writeDepthHeaderBlock(sink);
+	}
+
+void KinectServer::CameraState::writeColorHeaderBlock(IO::File& sink) const
+	{
+	/* Write the color stream's codec: */
+	sink.write<Misc::UInt32>(Misc::UInt32(getColorCodec()));
+	
+	/* Write the color compression headers prefixed by their size: */
+	IO::VariableMemoryFile headers;
+	colorHeaders[sentColorGeneration&0x1U].writeToSink(headers);
+	sink.write<Misc::UInt32>(Misc::UInt32(headers.getDataSize()));
+	headers.writeToSink(sink);
+	}
+
+void KinectServer::CameraState::writeDepthHeaderBlock(IO::File& sink) const
+	{
+	/* Write the depth stream's codec: */
+	sink.write<Misc::UInt32>(Misc::UInt32(getDepthCodec()));
+	
+	/* Write the depth compression headers prefixed by their size: */
+	IO::VariableMemoryFile headers;
+	depthHeaders[sentDepthGeneration&0x1U].writeToSink(headers);
+	sink.write<Misc::UInt32>(Misc::UInt32(headers.getDataSize()));
+	headers.writeToSink(sink);
+	}
+
+void KinectServer::CameraState::readColorHeaderBlock(IO::File& source,unsigned int slot)
+	{
+	/* Read the color stream's codec: */
+	Misc::UInt32 codec=source.read<Misc::UInt32>();
+	if(codec>=Misc::UInt32(Kinect::COLOR_CODEC_NUM_CODECS))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid color frame codec %u",(unsigned int)(codec));
+	colorCodecs[slot]=Kinect::ColorFrameCodec(codec);
+	
+	/* Read the color compression headers into the given slot: */
+	size_t headerSize=source.read<Misc::UInt32>();
+	copyBlock(source,headerSize,colorFile);
+	colorFile.storeBuffers(colorHeaders[slot]);
+	}
+
+void KinectServer::CameraState::readDepthHeaderBlock(IO::File& source,unsigned int slot)
+	{
+	/* Read the depth stream's codec: */
+	Misc::UInt32 codec=source.read<Misc::UInt32>();
+	if(codec>=Misc::UInt32(Kinect::DEPTH_CODEC_NUM_CODECS))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid depth frame codec %u",(unsigned int)(codec));
+	depthCodecs[slot]=Kinect::DepthFrameCodec(codec);
+	
+	/* Read the depth compression headers into the given slot: */
+	size_t headerSize=source.read<Misc::UInt32>();
+	copyBlock(source,headerSize,depthFile);
+	depthFile.storeBuffers(depthHeaders[slot]);
 	}
 
 namespace {
@@ -190,6 +748,54 @@ enum State
 	START,STREAMING
 	};
 
+struct CroppedDepthFrame // Structure holding a depth frame cropped to a set of visible tiles
+	{
+	/* Elements: */
+	public:
+	Kinect::DepthTileCuller::TileMask visibleTiles; // Mask of tiles retained in the cropped frame
+	IO::VariableMemoryFile::BufferChain data; // Cropped frame's compressed data
+	};
+
+/****************
+Helper functions:
+****************/
+
+std::vector<std::string> splitCommandLine(const std::string& commandLine) // Splits a control command line into whitespace-separated tokens
+	{
+	std::vector<std::string> result;
+	std::string::const_iterator clIt=commandLine.begin();
+	while(true)
+		{
+		while(clIt!=commandLine.end()&&isspace((unsigned char)(*clIt)))
+			++clIt;
+		if(clIt==commandLine.end())
+			break;
+		std::string::const_iterator tokenStart=clIt;
+		while(clIt!=commandLine.end()&&!isspace((unsigned char)(*clIt)))
+			++clIt;
+		result.push_back(std::string(tokenStart,clIt));
+		}
+	return result;
+	}
+
+long parseInteger(const std::string& token) // Parses a decimal integer; throws exception if the token is not an integer
+	{
+	char* endPtr=0;
+	long result=strtol(token.c_str(),&endPtr,10);
+	if(token.empty()||*endPtr!='\0')
+		throw std::runtime_error(token+" is not an integer");
+	return result;
+	}
+
+bool parseBool(const std::string& token) // Parses a boolean value; throws exception if the token is not a boolean
+	{
+	if(token=="true"||token=="on"||token=="1")
+		return true;
+	if(token=="false"||token=="off"||token=="0")
+		return false;
+	throw std::runtime_error(token+" is not a boolean value");
+	}
+
 }
 
 /******************************************
@@ -201,7 +807,10 @@ KinectServer::ClientState::ClientState(KinectServer* sServer,Comm::ListeningTCPS
 	 pipe(listenSocket),
 	 state(START),
 	 protocolVersion(0),
-	 streaming(false)
+	 streaming(false),
+	 viewRegionMargin(0.0),
+	 visibleTiles(sServer->numCameras,~Kinect::DepthTileCuller::TileMask(0)),
+	 colorSynced(sServer->numCameras,true),depthSynced(sServer->numCameras,true)
 	{
 	#ifdef VERBOSE
 	/* Assemble the client name: */
@@ -212,83 +821,319 @@ KinectServer::ClientState::ClientState(KinectServer* sServer,Comm::ListeningTCPS
 	#endif
 	}
 
+/*****************************************
+Methods of class KinectServer::ShardState:
+*****************************************/
+
+KinectServer::ShardState::ShardState(KinectServer* sServer,unsigned int sShardIndex,const std::string& sName,unsigned int numConfigCameras)
+	:server(sServer),shardIndex(sShardIndex),name(sName),
+	 configCameras(numConfigCameras,0),numCameras(0),
+	 status(SHARD_DOWN),pid(0),pipe(0),started(false),
+	 numRestarts(0),numFrames(0),numBytes(0),numDroppedFrames(0)
+	{
+	}
+
 /*****************************
 Methods of class KinectServer:
 *****************************/
 
-void KinectServer::newFrameCallback(void)
+bool KinectServer::hasLegacyClients(void) const
 	{
-	/* Read the camera index and frame type: */
-	Misc::UInt32 frameIndex;
-	if(read(framePipeFds[0],&frameIndex,sizeof(frameIndex))!=sizeof(frameIndex))
-		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Read error on pipe");
-	unsigned int cameraIndex=frameIndex>>1;
+	for(ClientStateList::const_iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+		if((*csIt)->streaming&&(*csIt)->protocolVersion<2U)
+			return true;
+	return false;
+	}
+
+void KinectServer::sendFrame(KinectServer::ClientState* client,unsigned int frameIndex,const IO::VariableMemoryFile::BufferChain* data)
+	{
+	/* Write the meta frame index: */
+	client->pipe.write<Misc::UInt32>(metaFrameIndex);
 	
-	/* Check if the frame is a color or depth frame: */
-	if(frameIndex&0x01U) // New frame is a depth frame
+	if(data!=0)
 		{
-		/* Check if the camera has not yet sent a depth frame in the current meta frame: */
-		if(!cameraStates[cameraIndex]->hasSentDepthFrame&&cameraStates[cameraIndex]->depthFrames.lockNewValue())
+		/* Write the frame identifier and the compressed frame: */
+		client->pipe.write<Misc::UInt32>(frameIndex);
+		data->writeToSink(client->pipe);
+		}
+	else
+		{
+		/* Write the frame identifier with the culled flag set, and no frame data: */
+		client->pipe.write<Misc::UInt32>(frameIndex|0x80000000U);
+		}
+	client->pipe.flush();
+	}
+
+void KinectServer::sendHeaderRefresh(unsigned int frameIndex)
+	{
+	CameraState* cs=cameraStates[frameIndex>>1];
+	for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+		if((*csIt)->streaming)
 			{
-			#ifdef VERBOSE2
-			std::cout<<" depth "<<cameraIndex<<", "<<cameraStates[cameraIndex]->depthFrames.getLockedValue().index<<", "<<cameraStates[cameraIndex]->depthFrames.getLockedValue().timeStamp<<';';
-			#endif
-			
-			/* Send the camera's new depth frame to all connected clients: */
-			for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
-				if((*csIt)->streaming)
+			try
+				{
+				/* Clients using older protocols cannot switch codecs in mid-stream: */
+				if((*csIt)->protocolVersion<3U)
+					throw std::runtime_error("Client does not support stream header refreshes");
+				
+				/* Write the meta frame index and the frame identifier with the header refresh flag set: */
+				(*csIt)->pipe.write<Misc::UInt32>(metaFrameIndex);
+				(*csIt)->pipe.write<Misc::UInt32>(frameIndex|0x40000000U);
+				
+				/* Write the stream's new headers: */
+				if(frameIndex&0x01U)
 					{
-					try
-						{
-						/* Write the meta frame index and frame identifier: */
-						(*csIt)->pipe.write<Misc::UInt32>(metaFrameIndex);
-						(*csIt)->pipe.write<Misc::UInt32>(frameIndex);
-						
-						/* Write the compressed depth frame: */
-						cameraStates[cameraIndex]->depthFrames.getLockedValue().data.writeToSink((*csIt)->pipe);
-						(*csIt)->pipe.flush();
-						}
-					catch(const std::runtime_error& err)
-						{
-						#ifdef VERBOSE
-						std::cout<<"KinectServer: Disconnecting client "<<(*csIt)->clientName<<" due to exception "<<err.what()<<std::endl;
-						#endif
-						disconnectClient(*csIt,true,false);
-						
-						/* Remove the client from the list by moving the last element forward: */
+					cs->writeDepthHeaders((*csIt)->pipe);
+					(*csIt)->depthSynced[frameIndex>>1]=false;
+					}
+				else
+					{
+					cs->writeColorHeaders((*csIt)->pipe);
+					(*csIt)->colorSynced[frameIndex>>1]=false;
+					}
+				(*csIt)->pipe.flush();
+				}
+			catch(const std::runtime_error& err)
+				{
+				#ifdef VERBOSE
+				std::cout<<"KinectServer: Disconnecting client "<<(*csIt)->clientName<<" due to exception "<<err.what()<<std::endl;
+				#endif
+				disconnectClient(*csIt,true,false);
+				
+				/* Remove the client from the list by moving the last element forward: */
+				*csIt=clients.back();
+				--csIt;
+				clients.pop_back();
+				}
+			}
+	}
+
+void KinectServer::startMetaFrame(void)
+	{
+	/* Wait for a depth and a color frame from each online camera: */
+	numMissingColorFrames=0;
+	numMissingDepthFrames=0;
+	for(unsigned int i=0;i<numCameras;++i)
+		{
+		CameraState* cs=cameraStates[i];
+		cs->hasSentColorFrame=!cs->online;
+		cs->hasSentDepthFrame=!cs->online;
+		if(cs->online)
+			{
+			++numMissingColorFrames;
+			++numMissingDepthFrames;
+			}
+		}
+	}
+
+void KinectServer::checkMetaFrame(void)
+	{
+	/* Check if the current meta frame is complete: */
+	if(numMissingDepthFrames==0U&&numMissingColorFrames==0U)
+		{
+		/* Start the next meta frame: */
+		++metaFrameIndex;
+		startMetaFrame();
+		
+		#ifdef VERBOSE2
+		std::cout<<std::endl;
+		std::cout<<"Meta frame "<<metaFrameIndex;
+		#endif
+		}
+	}
+
+void KinectServer::distributeFrame(unsigned int frameIndex)
+	{
+	unsigned int cameraIndex=frameIndex>>1;
+	CameraState* cs=cameraStates[cameraIndex];
+	
+	/* Check if the frame is a color or depth frame: */
+	if(frameIndex&0x01U) // New frame is a depth frame
+		{
+		/* Check if the camera has not yet sent a depth frame in the current meta frame: */
+		if(!cs->hasSentDepthFrame&&cs->depthFrames.lockNewValue())
+			{
+			const CameraState::CompressedFrame& frame=cs->depthFrames.getLockedValue();
+			
+			#ifdef VERBOSE2
+			std::cout<<" depth "<<cameraIndex<<", "<<frame.index<<", "<<frame.timeStamp<<';';
+			#endif
+			
+			/* Send the depth stream's new headers to all clients if the frame was compressed with a new codec: */
+			if(frame.generation!=cs->sentDepthGeneration)
+				{
+				cs->setSentDepthGeneration(frame.generation);
+				sendHeaderRefresh(frameIndex);
+				cs->hasLastDepthFrame=false;
+				}
+			
+			/* Keep a copy of a changed frame to re-send it instead of unchanged frames to clients that do not understand unchanged frame markers: */
+			if(!frame.unchanged&&hasLegacyClients())
+				{
+				frame.data.writeToSink(cs->lastFrameFile);
+				cs->lastFrameFile.storeBuffers(cs->lastDepthFrame);
+				cs->hasLastDepthFrame=true;
+				}
+			
+			/* Send the camera's new depth frame to all connected clients, culled or cropped to their view regions: */
+			bool missingLastFrame=false; // Flag whether a client that does not understand unchanged frame markers could not be sent an unchanged frame
+			std::vector<CroppedDepthFrame*> croppedFrames;
+			for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+				if((*csIt)->streaming)
+					{
+					try
+						{
+						if(frame.unchanged)
+							{
+							if((*csIt)->protocolVersion>=2U)
+								{
+								/* Send a culled frame marker to let the client keep the camera's previous depth frame: */
+								sendFrame(*csIt,frameIndex,0);
+								}
+							else if(cs->hasLastDepthFrame)
+								{
+								/* Re-send the previous frame to a client that does not understand markers: */
+								sendFrame(*csIt,frameIndex,&cs->lastDepthFrame);
+								}
+							else
+								{
+								/* Skip the frame, which drops the current meta frame on the client's side, until a changed frame has been kept: */
+								missingLastFrame=true;
+								}
+							continue;
+							}
+						
+						const IO::VariableMemoryFile::BufferChain* data=&frame.data;
+						if(!(*csIt)->viewRegion.empty())
+							{
+							/* Determine the frame's tiles that are visible from the client's view region: */
+							Kinect::DepthTileCuller::TileMask visibleTiles=cs->depthTileCuller->calcVisibleTiles(frame.tileRanges,(*csIt)->viewRegion,(*csIt)->viewRegionMargin);
+							(*csIt)->visibleTiles[cameraIndex]=visibleTiles;
+							if(visibleTiles==0)
+								{
+								/* Cull the entire frame: */
+								data=0;
+								}
+							else if(visibleTiles!=frame.validTiles&&cs->croppedDepthCompressor!=0)
+								{
+								/* Find a cropped version of the frame for the same set of visible tiles: */
+								std::vector<CroppedDepthFrame*>::iterator cdfIt;
+								for(cdfIt=croppedFrames.begin();cdfIt!=croppedFrames.end()&&(*cdfIt)->visibleTiles!=visibleTiles;++cdfIt)
+									;
+								if(cdfIt==croppedFrames.end())
+									{
+									/* Crop and compress the frame: */
+									CroppedDepthFrame* cdf=new CroppedDepthFrame;
+									croppedFrames.push_back(cdf);
+									cdf->visibleTiles=visibleTiles;
+									cs->croppedDepthCompressor->writeFrame(cs->depthTileCuller->maskFrame(frame.frame,visibleTiles));
+									cs->croppedDepthFile.storeBuffers(cdf->data);
+									cdfIt=croppedFrames.end()-1;
+									}
+								data=&(*cdfIt)->data;
+								}
+							}
+						
+						/* Don't resume an interrupted stream until the next key frame, unless the client does not understand culled frame markers: */
+						if(data!=0&&(*csIt)->protocolVersion>=2U&&!(*csIt)->depthSynced[cameraIndex]&&!frame.keyFrame)
+							data=0;
+						(*csIt)->depthSynced[cameraIndex]=data!=0;
+						
+						/* Send the compressed depth frame or a culled frame marker: */
+						sendFrame(*csIt,frameIndex,data);
+						}
+					catch(const std::runtime_error& err)
+						{
+						#ifdef VERBOSE
+						std::cout<<"KinectServer: Disconnecting client "<<(*csIt)->clientName<<" due to exception "<<err.what()<<std::endl;
+						#endif
+						disconnectClient(*csIt,true,false);
+						
+						/* Remove the client from the list by moving the last element forward: */
 						*csIt=clients.back();
 						--csIt;
 						clients.pop_back();
 						}
 					}
 			
+			/* Send a changed frame soon if a client could not be sent the current unchanged frame: */
+			if(missingLastFrame)
+				cs->requestFullFrames();
+			
+			/* Release the cropped frames: */
+			for(std::vector<CroppedDepthFrame*>::iterator cdfIt=croppedFrames.begin();cdfIt!=croppedFrames.end();++cdfIt)
+				delete *cdfIt;
+			
 			/* Reduce the number of outstanding depth frames in the current meta frame: */
-			cameraStates[cameraIndex]->hasSentDepthFrame=true;
+			cs->hasSentDepthFrame=true;
 			--numMissingDepthFrames;
 			}
 		}
 	else // New frame is a color frame
 		{
 		/* Check if the camera has not yet sent a color frame in the current meta frame: */
-		if(!cameraStates[cameraIndex]->hasSentColorFrame&&cameraStates[cameraIndex]->colorFrames.lockNewValue())
+		if(!cs->hasSentColorFrame&&cs->colorFrames.lockNewValue())
 			{
+			const CameraState::CompressedFrame& frame=cs->colorFrames.getLockedValue();
+			
 			#ifdef VERBOSE2
-			std::cout<<" color "<<cameraIndex<<", "<<cameraStates[cameraIndex]->colorFrames.getLockedValue().index<<", "<<cameraStates[cameraIndex]->colorFrames.getLockedValue().timeStamp<<';';
+			std::cout<<" color "<<cameraIndex<<", "<<frame.index<<", "<<frame.timeStamp<<';';
 			#endif
 			
-			/* Send the camera's new color frame to all connected clients: */
+			/* Send the color stream's new headers to all clients if the frame was compressed with a new codec: */
+			if(frame.generation!=cs->sentColorGeneration)
+				{
+				cs->setSentColorGeneration(frame.generation);
+				sendHeaderRefresh(frameIndex);
+				cs->hasLastColorFrame=false;
+				}
+			
+			/* Keep a copy of a changed frame to re-send it instead of unchanged frames to clients that do not understand unchanged frame markers: */
+			if(!frame.unchanged&&hasLegacyClients())
+				{
+				frame.data.writeToSink(cs->lastFrameFile);
+				cs->lastFrameFile.storeBuffers(cs->lastColorFrame);
+				cs->hasLastColorFrame=true;
+				}
+			
+			/* Send the camera's new color frame to all connected clients that can see any part of the camera's most recent depth frame: */
+			bool missingLastFrame=false; // Flag whether a client that does not understand unchanged frame markers could not be sent an unchanged frame
 			for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
 				if((*csIt)->streaming)
 					{
 					try
 						{
-						/* Write the meta frame index and frame identifier: */
-						(*csIt)->pipe.write<Misc::UInt32>(metaFrameIndex);
-						(*csIt)->pipe.write<Misc::UInt32>(frameIndex);
+						if(frame.unchanged)
+							{
+							if((*csIt)->protocolVersion>=2U)
+								{
+								/* Send a culled frame marker to let the client keep the camera's previous color frame: */
+								sendFrame(*csIt,frameIndex,0);
+								}
+							else if(cs->hasLastColorFrame)
+								{
+								/* Re-send the previous frame to a client that does not understand markers: */
+								sendFrame(*csIt,frameIndex,&cs->lastColorFrame);
+								}
+							else
+								{
+								/* Skip the frame, which drops the current meta frame on the client's side, until a changed frame has been kept: */
+								missingLastFrame=true;
+								}
+							continue;
+							}
+						
+						const IO::VariableMemoryFile::BufferChain* data=&frame.data;
+						if(!(*csIt)->viewRegion.empty()&&(*csIt)->visibleTiles[cameraIndex]==0)
+							data=0;
 						
-						/* Write the compressed color frame: */
-						cameraStates[cameraIndex]->colorFrames.getLockedValue().data.writeToSink((*csIt)->pipe);
-						(*csIt)->pipe.flush();
+						/* Don't resume an interrupted stream until the next key frame, unless the client does not understand culled frame markers: */
+						if(data!=0&&(*csIt)->protocolVersion>=2U&&!(*csIt)->colorSynced[cameraIndex]&&!frame.keyFrame)
+							data=0;
+						(*csIt)->colorSynced[cameraIndex]=data!=0;
+						
+						/* Send the compressed color frame or a culled frame marker: */
+						sendFrame(*csIt,frameIndex,data);
 						}
 					catch(const std::runtime_error& err)
 						{
@@ -304,186 +1149,1178 @@ void KinectServer::newFrameCallback(void)
 						}
 					}
 			
+			/* Send a changed frame soon if a client could not be sent the current unchanged frame: */
+			if(missingLastFrame)
+				cs->requestFullFrames();
+			
 			/* Reduce the number of outstanding color frames in the current meta frame: */
-			cameraStates[cameraIndex]->hasSentColorFrame=true;
+			cs->hasSentColorFrame=true;
 			--numMissingColorFrames;
 			}
 		}
 	
 	/* Check if the current meta frame is complete: */
-	if(numMissingDepthFrames==0U&&numMissingColorFrames==0U)
+	checkMetaFrame();
+	}
+
+void KinectServer::writeShardFrame(unsigned int frameIndex,const KinectServer::CameraState::CompressedFrame& frame)
+	{
+	/* Write the frame's identifier, sequence number, time stamp, and flags: */
+	IO::File& pipe=*frontEndPipe;
+	pipe.write<Misc::UInt32>(SHARD_FRAME);
+	pipe.write<Misc::UInt32>(frameIndex);
+	pipe.write<Misc::UInt32>(frame.index);
+	pipe.write<Misc::Float64>(frame.timeStamp);
+	pipe.write<Misc::UInt8>(frame.keyFrame?1U:0U);
+	pipe.write<Misc::UInt8>(frame.unchanged?1U:0U);
+	
+	/* Write a depth frame's tile depth ranges to let the front end cull the frame against clients' view regions: */
+	if((frameIndex&0x01U)&&!frame.unchanged)
 		{
-		/* Start the next meta frame: */
-		++metaFrameIndex;
-		for(unsigned int i=0;i<numCameras;++i)
+		pipe.write<Misc::UInt64>(frame.validTiles);
+		for(unsigned int i=0;i<Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles;++i)
+			{
+			pipe.write<Misc::UInt16>(frame.tileRanges[i].min);
+			pipe.write<Misc::UInt16>(frame.tileRanges[i].max);
+			}
+		}
+	
+	/* Write the frame's compressed data prefixed by its size: */
+	pipe.write<Misc::UInt32>(Misc::UInt32(frame.dataSize));
+	frame.data.writeToSink(pipe);
+	pipe.flush();
+	}
+
+void KinectServer::forwardFrame(unsigned int frameIndex)
+	{
+	CameraState* cs=cameraStates[frameIndex>>1];
+	try
+		{
+		/* Check if the frame is a color or depth frame: */
+		if(frameIndex&0x01U)
 			{
-			cameraStates[i]->hasSentColorFrame=false;
-			cameraStates[i]->hasSentDepthFrame=false;
+			if(cs->depthFrames.lockNewValue())
+				{
+				const CameraState::CompressedFrame& frame=cs->depthFrames.getLockedValue();
+				
+				/* Send the depth stream's new headers to the front end if the frame was compressed with a new codec: */
+				if(frame.generation!=cs->sentDepthGeneration)
+					{
+					cs->setSentDepthGeneration(frame.generation);
+					frontEndPipe->write<Misc::UInt32>(SHARD_HEADERS);
+					frontEndPipe->write<Misc::UInt32>(frameIndex);
+					cs->writeDepthHeaderBlock(*frontEndPipe);
+					}
+				
+				/* Forward the frame: */
+				writeShardFrame(frameIndex,frame);
+				}
 			}
-		numMissingColorFrames=numCameras;
-		numMissingDepthFrames=numCameras;
+		else
+			{
+			if(cs->colorFrames.lockNewValue())
+				{
+				const CameraState::CompressedFrame& frame=cs->colorFrames.getLockedValue();
+				
+				/* Send the color stream's new headers to the front end if the frame was compressed with a new codec: */
+				if(frame.generation!=cs->sentColorGeneration)
+					{
+					cs->setSentColorGeneration(frame.generation);
+					frontEndPipe->write<Misc::UInt32>(SHARD_HEADERS);
+					frontEndPipe->write<Misc::UInt32>(frameIndex);
+					cs->writeColorHeaderBlock(*frontEndPipe);
+					}
+				
+				/* Forward the frame: */
+				writeShardFrame(frameIndex,frame);
+				}
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Shut down the shard worker: */
+		std::cerr<<"KinectServer: Lost connection to front end due to exception "<<err.what()<<std::endl;
+		dispatcher.stop();
+		}
+	}
+
+void KinectServer::newFrameCallback(void)
+	{
+	/* Read the camera index and frame type: */
+	Misc::UInt32 frameIndex;
+	if(read(framePipeFds[0],&frameIndex,sizeof(frameIndex))!=sizeof(frameIndex))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Read error on pipe");
+	
+	/* Forward the frame to the front end in a shard worker process, or send it to all streaming clients: */
+	if(frontEndPipe!=0)
+		forwardFrame(frameIndex);
+	else
+		distributeFrame(frameIndex);
+	}
+
+void KinectServer::newConnectionCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	
+	/* Create a new client state object and add it to the list: */
+	ClientState* newClient=new ClientState(thisPtr,*thisPtr->listeningSocket);
+	
+	#ifdef VERBOSE
+	std::cout<<"KinectServer: Connecting new client "<<newClient->clientName<<std::endl;
+	#endif
+	
+	thisPtr->clients.push_back(newClient);
+	
+	/* Add an event listener for incoming messages from the client: */
+	newClient->listenerKey=thisPtr->dispatcher.addIOEventListener(newClient->pipe.getFd(),Threads::EventDispatcher::Read,thisPtr->clientMessageCallback,newClient);
+	}
+
+void KinectServer::disconnectClient(KinectServer::ClientState* client,bool removeListener,bool removeFromList)
+	{
+	if(removeListener)
+		{
+		/* Stop listening on the client's pipe: */
+		dispatcher.removeIOEventListener(client->listenerKey);
+		}
+	
+	/* Check if the client is still streaming: */
+	if(client->streaming)
+		--numStreamingClients;
+	
+	/* Disconnect the client: */
+	delete client;
+	
+	if(removeFromList)
+		{
+		/* Remove the dead client from the list: */
+		for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+			if(*csIt==client)
+				{
+				/* Remove it and stop searching: */
+				*csIt=clients.back();
+				clients.pop_back();
+				break;
+				}
+		}
+	}
+
+void KinectServer::clientMessageCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	ClientState* client=static_cast<ClientState*>(event.getUserData());
+	KinectServer* thisPtr=client->server;
+	
+	try
+		{
+		/* Read some data from the socket into the socket's read buffer and check if client hung up: */
+		if(client->pipe.readSomeData()==0)
+			throw std::runtime_error("Client terminated connection");
 		
-		#ifdef VERBOSE2
-		std::cout<<std::endl;
-		std::cout<<"Meta frame "<<metaFrameIndex;
+		/* Process messages as long as there is data in the read buffer: */
+		while(client->pipe.canReadImmediately())
+			{
+			switch(client->state)
+				{
+				case START:
+					{
+					/* Read endianness flag and protocol version from new client: */
+					Misc::UInt32 endiannessFlag=client->pipe.read<Misc::UInt32>();
+					if(endiannessFlag==0x78563412U)
+						client->pipe.setSwapOnRead(true);
+					else if(endiannessFlag!=0x12345678U)
+						throw std::runtime_error("Client has unrecognized endianness");
+					client->protocolVersion=client->pipe.read<Misc::UInt32>();
+					if(client->protocolVersion>3U)
+						client->protocolVersion=3U;
+					
+					/* Send stream initialization states to the new client: */
+					#ifdef VERBOSE
+					std::cout<<"KinectServer: Sending stream headers to client "<<client->clientName<<std::endl;
+					#endif
+					client->pipe.write<Misc::UInt32>(0x12345678U);
+					client->pipe.write<Misc::UInt32>(client->protocolVersion);
+					Kinect::FrameSource::Time now;
+					client->pipe.write<Misc::Float64>(double(now-thisPtr->timeBase));
+					client->pipe.write<Misc::UInt32>(thisPtr->numCameras);
+					for(unsigned i=0;i<thisPtr->numCameras;++i)
+						thisPtr->cameraStates[i]->writeHeaders(client->pipe);
+					
+					/* Finish the reply message: */
+					client->pipe.flush();
+					
+					/* Increase the number of streaming clients: */
+					++thisPtr->numStreamingClients;
+					
+					/* Send full frames from all cameras to the new client even if the scene is static, which are kept to be re-sent if the client does not understand unchanged frame markers: */
+					for(unsigned int i=0;i<thisPtr->numCameras;++i)
+						thisPtr->cameraStates[i]->requestFullFrames();
+					
+					/* Go to streaming state: */
+					client->state=STREAMING;
+					client->streaming=true;
+					#ifdef VERBOSE
+					std::cout<<"KinectServer: Client "<<client->clientName<<" entered streaming mode"<<std::endl;
+					#endif
+					
+					break;
+					}
+				
+				case STREAMING:
+					{
+					/* Read a message from the client: */
+					Misc::UInt32 message=client->pipe.read<Misc::UInt32>();
+					
+					if(message==0U) // Disconnect request
+						{
+						/* Cleanly disconnect this client: */
+						#ifdef VERBOSE
+						std::cout<<"KinectServer: Disconnecting client "<<client->clientName<<std::endl;
+						#endif
+						thisPtr->disconnectClient(client,false,true);
+						
+						/* Stop listening: */
+						event.removeListener();
+						
+						/* Stop processing messages: */
+						goto doneWithMessages;
+						}
+					else if(message==1U&&client->protocolVersion>=2U) // View region update
+						{
+						/* Read the new view region's margin and bounding planes: */
+						unsigned int numPlanes=client->pipe.read<Misc::UInt32>();
+						if(numPlanes>64U)
+							throw std::runtime_error("Too many view region planes");
+						client->viewRegionMargin=client->pipe.read<Misc::Float64>();
+						client->viewRegion.clear();
+						for(unsigned int i=0;i<numPlanes;++i)
+							{
+							Kinect::DepthTileCuller::Plane::Vector normal;
+							for(int j=0;j<3;++j)
+								normal[j]=client->pipe.read<Misc::Float64>();
+							double offset=client->pipe.read<Misc::Float64>();
+							if(Geometry::sqr(normal)==0.0)
+								throw std::runtime_error("Invalid view region plane");
+							client->viewRegion.push_back(Kinect::DepthTileCuller::Plane(normal,offset));
+							client->viewRegion.back().normalize();
+							}
+						
+						/* Consider all tiles visible until the next depth frames arrive, and send full frames to fill in previously culled tiles: */
+						for(unsigned int i=0;i<thisPtr->numCameras;++i)
+							{
+							client->visibleTiles[i]=~Kinect::DepthTileCuller::TileMask(0);
+							thisPtr->cameraStates[i]->requestFullFrames();
+							}
+						
+						#ifdef VERBOSE
+						std::cout<<"KinectServer: Client "<<client->clientName<<" set a view region with "<<numPlanes<<" planes"<<std::endl;
+						#endif
+						}
+					else
+						throw std::runtime_error("Protocol error in STREAMING state");
+					
+					break;
+					}
+				}
+			}
+		doneWithMessages:
+		;
+		}
+	catch(const std::runtime_error& err)
+		{
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Disconnecting client "<<client->clientName<<" due to exception "<<err.what()<<std::endl;
+		#endif
+		thisPtr->disconnectClient(client,false,true);
+		
+		/* Stop listening: */
+		event.removeListener();
+		}
+	}
+
+void KinectServer::newControlConnectionCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	
+	/* Accept the incoming control connection: */
+	int fd=accept(thisPtr->controlSocketFd,0,0);
+	if(fd<0)
+		{
+		std::cerr<<"KinectServer: Unable to accept control connection due to error "<<strerror(errno)<<std::endl;
+		return;
+		}
+	
+	/* Create a new control client state object and add it to the list: */
+	ControlClientState* newControlClient=new ControlClientState;
+	newControlClient->server=thisPtr;
+	newControlClient->fd=fd;
+	newControlClient->waitingForShard=false;
+	thisPtr->controlClients.push_back(newControlClient);
+	
+	/* Add an event listener for incoming commands from the control client: */
+	newControlClient->listenerKey=thisPtr->dispatcher.addIOEventListener(fd,Threads::EventDispatcher::Read,thisPtr->controlMessageCallback,newControlClient);
+	}
+
+void KinectServer::disconnectControlClient(KinectServer::ControlClientState* controlClient)
+	{
+	/* Close the control connection: */
+	close(controlClient->fd);
+	
+	/* Remove the control client from the list: */
+	for(ControlClientStateList::iterator ccsIt=controlClients.begin();ccsIt!=controlClients.end();++ccsIt)
+		if(*ccsIt==controlClient)
+			{
+			/* Remove it and stop searching: */
+			*ccsIt=controlClients.back();
+			controlClients.pop_back();
+			break;
+			}
+	
+	/* Drop replies to commands the control client forwarded to shard workers: */
+	for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+		for(std::deque<ControlClientState*>::iterator pccIt=(*sIt)->pendingControlClients.begin();pccIt!=(*sIt)->pendingControlClients.end();++pccIt)
+			if(*pccIt==controlClient)
+				*pccIt=0;
+	
+	delete controlClient;
+	}
+
+void KinectServer::controlMessageCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	ControlClientState* controlClient=static_cast<ControlClientState*>(event.getUserData());
+	KinectServer* thisPtr=controlClient->server;
+	
+	/* Read some data from the control connection and check if the client hung up: */
+	char buffer[1024];
+	ssize_t readSize=read(controlClient->fd,buffer,sizeof(buffer));
+	if(readSize<=0||controlClient->lineBuffer.size()+size_t(readSize)>65536)
+		{
+		thisPtr->disconnectControlClient(controlClient);
+		event.removeListener();
+		return;
+		}
+	controlClient->lineBuffer.append(buffer,buffer+readSize);
+	
+	/* Execute all complete command lines: */
+	if(!thisPtr->executeControlCommands(controlClient))
+		{
+		thisPtr->disconnectControlClient(controlClient);
+		event.removeListener();
+		}
+	}
+
+bool KinectServer::sendControlReply(KinectServer::ControlClientState* controlClient,const std::string& reply)
+	{
+	const char* replyPtr=reply.data();
+	size_t replySize=reply.size();
+	while(replySize>0)
+		{
+		ssize_t writeSize=write(controlClient->fd,replyPtr,replySize);
+		if(writeSize<=0)
+			return false;
+		replyPtr+=writeSize;
+		replySize-=size_t(writeSize);
+		}
+	
+	return true;
+	}
+
+bool KinectServer::executeControlCommands(KinectServer::ControlClientState* controlClient)
+	{
+	/* Execute complete command lines in order until a command has to wait for a shard worker's reply: */
+	std::string::size_type lineEnd;
+	while(!controlClient->waitingForShard&&(lineEnd=controlClient->lineBuffer.find('\n'))!=std::string::npos)
+		{
+		std::string commandLine(controlClient->lineBuffer,0,lineEnd);
+		controlClient->lineBuffer.erase(0,lineEnd+1);
+		
+		/* Execute the command and send the reply unless the command was forwarded: */
+		std::string reply=processControlCommand(controlClient,commandLine);
+		if(reply.empty())
+			controlClient->waitingForShard=true;
+		else if(!sendControlReply(controlClient,reply))
+			return false;
+		}
+	
+	return true;
+	}
+
+void KinectServer::resumeControlClient(KinectServer::ControlClientState* controlClient,const std::string& reply)
+	{
+	/* Send the reply to the forwarded command and execute the control client's remaining command lines: */
+	controlClient->waitingForShard=false;
+	if(!sendControlReply(controlClient,reply)||!executeControlCommands(controlClient))
+		{
+		dispatcher.removeIOEventListener(controlClient->listenerKey);
+		disconnectControlClient(controlClient);
+		}
+	}
+
+std::string KinectServer::processControlCommand(KinectServer::ControlClientState* controlClient,const std::string& commandLine)
+	{
+	std::vector<std::string> tokens=splitCommandLine(commandLine);
+	std::ostringstream reply;
+	try
+		{
+		if(tokens.empty()||tokens[0]=="help")
+			{
+			/* List the supported commands and parameters: */
+			reply<<"OK 5\n";
+			reply<<"list\n";
+			reply<<"shards\n";
+			reply<<"get <camera> (removeBackground|backgroundFuzz|removeFloor|depthCodec|colorCodec)\n";
+			reply<<"set <camera> (removeBackground|backgroundFuzz|maxDepth|removeFloor|depthCodec|colorCodec) <value>\n";
+			reply<<"capture <camera> <numFrames> [replace]\n";
+			}
+		else if(tokens[0]=="list")
+			{
+			/* List all cameras with their current codecs: */
+			reply<<"OK "<<numCameras<<'\n';
+			for(unsigned int i=0;i<numCameras;++i)
+				{
+				CameraState* cs=cameraStates[i];
+				reply<<i<<' '<<cs->serialNumber<<' '<<Kinect::getDepthFrameCodecName(cs->getDepthCodec())<<' '<<Kinect::getColorFrameCodecName(cs->getColorCodec());
+				if(!cs->online)
+					reply<<" offline";
+				reply<<'\n';
+				}
+			}
+		else if(tokens[0]=="shards")
+			{
+			/* List all shard workers with their states and statistics: */
+			static const char* statusNames[]={"starting","running","failed","down"};
+			reply<<"OK "<<shards.size()<<'\n';
+			Kinect::FrameSource::Time now;
+			for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+				{
+				ShardState* shard=*sIt;
+				unsigned int numOnlineCameras=0;
+				for(std::vector<CameraState*>::iterator csIt=shard->configCameras.begin();csIt!=shard->configCameras.end();++csIt)
+					if(*csIt!=0&&(*csIt)->online)
+						++numOnlineCameras;
+				reply<<shard->shardIndex<<' '<<shard->name<<' '<<statusNames[shard->status]<<" for "<<double(now-shard->stateTime)<<" s";
+				reply<<", pid "<<shard->pid<<", cameras "<<numOnlineCameras<<'/'<<shard->numCameras;
+				reply<<", frames "<<shard->numFrames<<", bytes "<<shard->numBytes<<", dropped "<<shard->numDroppedFrames<<", restarts "<<shard->numRestarts<<'\n';
+				}
+			}
+		else if(tokens[0]=="get"||tokens[0]=="set"||tokens[0]=="capture")
+			{
+			/* Check the command's arguments: */
+			bool isSet=tokens[0]=="set";
+			bool isCapture=tokens[0]=="capture";
+			size_t minNumTokens=isSet?4:3;
+			size_t maxNumTokens=isCapture?4:minNumTokens;
+			if(tokens.size()<minNumTokens||tokens.size()>maxNumTokens)
+				throw std::runtime_error("Wrong number of arguments");
+			long cameraIndex=parseInteger(tokens[1]);
+			if(cameraIndex<0||cameraIndex>=long(numCameras))
+				throw std::runtime_error("Invalid camera index "+tokens[1]);
+			CameraState* cs=cameraStates[cameraIndex];
+			if(cs->shard!=0)
+				{
+				/* Forward the command to the shard worker serving the camera, which will reply asynchronously: */
+				ShardState* shard=cs->shard;
+				if(shard->pipe==0||controlClient==0)
+					throw std::runtime_error("Camera "+tokens[1]+" is served by shard "+shard->name+", which is not running");
+				std::ostringstream forwardedCommand;
+				forwardedCommand<<tokens[0]<<' '<<cs->shardCameraIndex;
+				for(size_t i=2;i<tokens.size();++i)
+					forwardedCommand<<' '<<tokens[i];
+				shard->pipe->write<Misc::UInt32>(SHARD_CONTROL_COMMAND);
+				Misc::Marshaller<std::string>::write(forwardedCommand.str(),*shard->pipe);
+				shard->pipe->flush();
+				shard->pendingControlClients.push_back(controlClient);
+				
+				return std::string();
+				}
+			
+			/* Queue setting changes with the camera's state to be applied by its depth streaming thread between frames: */
+			if(isCapture)
+				{
+				/* Capture a new background, optionally replacing the current one: */
+				long numFrames=parseInteger(tokens[2]);
+				if(numFrames<=0)
+					throw std::runtime_error("Invalid number of background frames "+tokens[2]);
+				bool replace=tokens.size()==4;
+				if(replace&&tokens[3]!="replace")
+					throw std::runtime_error("Unknown capture option "+tokens[3]);
+				cs->requestBackgroundCapture((unsigned int)(numFrames),replace);
+				reply<<"OK\n";
+				}
+			else if(tokens[2]=="removeBackground")
+				{
+				if(isSet)
+					{
+					cs->requestRemoveBackground(parseBool(tokens[3]));
+					reply<<"OK\n";
+					}
+				else
+					reply<<"OK "<<(cs->getRemoveBackground()?"true":"false")<<'\n';
+				}
+			else if(tokens[2]=="backgroundFuzz")
+				{
+				if(isSet)
+					{
+					cs->requestBackgroundFuzz(int(parseInteger(tokens[3])));
+					reply<<"OK\n";
+					}
+				else
+					reply<<"OK "<<cs->getBackgroundFuzz()<<'\n';
+				}
+			else if(tokens[2]=="maxDepth")
+				{
+				if(!isSet)
+					throw std::runtime_error("Parameter maxDepth can only be set");
+				long maxDepth=parseInteger(tokens[3]);
+				if(maxDepth<0)
+					throw std::runtime_error("Invalid maximum depth "+tokens[3]);
+				cs->requestMaxDepth((unsigned int)(maxDepth));
+				reply<<"OK\n";
+				}
+			else if(tokens[2]=="removeFloor")
+				{
+				if(isSet)
+					{
+					cs->requestRemoveFloor(parseBool(tokens[3]));
+					reply<<"OK\n";
+					}
+				else
+					reply<<"OK "<<(cs->getRemoveFloor()?"true":"false")<<'\n';
+				}
+			else if(tokens[2]=="depthCodec")
+				{
+				if(isSet)
+					{
+					/* Request the new codec, which will be applied at the next depth frame and announced to clients via a header refresh: */
+					Kinect::DepthFrameCodec depthCodec=Kinect::parseDepthFrameCodec(tokens[3].c_str());
+					if(!Kinect::isDepthFrameCodecSupported(depthCodec))
+						throw std::runtime_error(std::string(Kinect::getDepthFrameCodecName(depthCodec))+" depth frame codec not supported");
+					cs->requestDepthCodec(depthCodec);
+					reply<<"OK\n";
+					}
+				else
+					reply<<"OK "<<Kinect::getDepthFrameCodecName(cs->getDepthCodec())<<'\n';
+				}
+			else if(tokens[2]=="colorCodec")
+				{
+				if(isSet)
+					{
+					/* Request the new codec, which will be applied at the next color frame and announced to clients via a header refresh: */
+					cs->requestColorCodec(Kinect::parseColorFrameCodec(tokens[3].c_str()));
+					reply<<"OK\n";
+					}
+				else
+					reply<<"OK "<<Kinect::getColorFrameCodecName(cs->getColorCodec())<<'\n';
+				}
+			else
+				throw std::runtime_error("Unknown parameter "+tokens[2]);
+			}
+		else
+			throw std::runtime_error("Unknown command "+tokens[0]);
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Discard any partial reply and report the error: */
+		reply.str(std::string());
+		reply<<"ERROR "<<err.what()<<'\n';
+		}
+	
+	return reply.str();
+	}
+
+void KinectServer::frontEndMessageCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	Comm::UNIXPipe& pipe=*thisPtr->frontEndPipe;
+	
+	try
+		{
+		/* Read some data from the pipe and check if the front end hung up: */
+		if(pipe.readSomeData()==0)
+			throw std::runtime_error("Front end terminated connection");
+		
+		/* Process messages as long as there is data in the read buffer: */
+		while(pipe.canReadImmediately())
+			{
+			Misc::UInt32 message=pipe.read<Misc::UInt32>();
+			if(message==SHARD_START)
+				{
+				/* Start streaming on all cameras using the front end's time base: */
+				thisPtr->timeBase.tv_sec=time_t(pipe.read<Misc::SInt64>());
+				thisPtr->timeBase.tv_nsec=long(pipe.read<Misc::SInt64>());
+				#ifdef VERBOSE
+				std::cout<<"KinectServer: Starting streaming on "<<thisPtr->numCameras<<" cameras"<<std::endl;
+				#endif
+				for(unsigned int i=0;i<thisPtr->numCameras;++i)
+					thisPtr->cameraStates[i]->startStreaming(thisPtr->timeBase);
+				}
+			else if(message==SHARD_FULL_FRAMES)
+				{
+				unsigned int cameraIndex=pipe.read<Misc::UInt32>();
+				if(cameraIndex>=thisPtr->numCameras)
+					throw std::runtime_error("Invalid camera index");
+				thisPtr->cameraStates[cameraIndex]->requestFullFrames();
+				}
+			else if(message==SHARD_CONTROL_COMMAND)
+				{
+				/* Execute the control command and send the reply to the front end: */
+				std::string commandLine=Misc::Marshaller<std::string>::read(pipe);
+				std::string reply=thisPtr->processControlCommand(0,commandLine);
+				pipe.write<Misc::UInt32>(SHARD_CONTROL_REPLY);
+				Misc::Marshaller<std::string>::write(reply,pipe);
+				pipe.flush();
+				}
+			else
+				throw std::runtime_error("Protocol error");
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Shut down the shard worker: */
+		std::cerr<<"KinectServer: Lost connection to front end due to exception "<<err.what()<<std::endl;
+		event.removeListener();
+		thisPtr->dispatcher.stop();
+		}
+	}
+
+void KinectServer::startShards(Misc::ConfigurationFileSection& configFileSection,const std::vector<std::string>& shardNames)
+	{
+	/* Create an abstract socket on which shard workers connect to the front end: */
+	std::ostringstream socketName;
+	socketName<<"KinectServer-"<<getpid()<<"-shards";
+	shardSocketName=socketName.str();
+	shardListeningSocket=new Comm::ListeningUNIXSocket(shardSocketName.c_str(),int(shardNames.size()),true);
+	
+	/* Start a worker process for each shard: */
+	for(unsigned int i=0;i<shardNames.size();++i)
+		{
+		Misc::ConfigurationFileSection shardSection=configFileSection.getSection(shardNames[i].c_str());
+		std::vector<std::string> cameraNames=shardSection.retrieveValue<std::vector<std::string> >("./cameras");
+		shards.push_back(new ShardState(this,i,shardNames[i],cameraNames.size()));
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Starting worker process for shard "<<shardNames[i]<<" with "<<cameraNames.size()<<" cameras"<<std::endl;
 		#endif
+		startShard(shards.back());
+		}
+	
+	/* Wait for all workers to open their cameras and connect to the front end: */
+	Kinect::FrameSource::Time startTime;
+	unsigned int numStarting=shards.size();
+	while(numStarting>0)
+		{
+		/* Wait for the next connection, but check on the workers at least once per second: */
+		Kinect::FrameSource::Time now;
+		double waitTime=shardStartupTimeout-double(now-startTime);
+		if(waitTime<=0.0)
+			break;
+		struct pollfd pollFd;
+		pollFd.fd=shardListeningSocket->getFd();
+		pollFd.events=POLLIN;
+		pollFd.revents=0;
+		if(poll(&pollFd,1,waitTime<1.0?int(waitTime*1000.0)+1:1000)>0)
+			{
+			try
+				{
+				acceptShard(true);
+				--numStarting;
+				}
+			catch(const std::runtime_error& err)
+				{
+				std::cerr<<"KinectServer: Rejected shard worker connection due to exception "<<err.what()<<std::endl;
+				}
+			}
+		
+		/* Check for workers that terminated before connecting: */
+		for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+			{
+			int status;
+			if((*sIt)->status==SHARD_STARTING&&waitpid((*sIt)->pid,&status,WNOHANG)==(*sIt)->pid)
+				{
+				std::cerr<<"KinectServer: Worker process for shard "<<(*sIt)->name<<" terminated during startup"<<std::endl;
+				(*sIt)->pid=0;
+				(*sIt)->status=SHARD_DOWN;
+				(*sIt)->stateTime.set();
+				--numStarting;
+				}
+			}
+		}
+	
+	/* Collect the proxy states of all cameras opened by shard workers: */
+	std::vector<CameraState*> shardCameras;
+	for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+		{
+		ShardState* shard=*sIt;
+		if(shard->status==SHARD_STARTING)
+			{
+			/* Kill a worker that did not connect in time: */
+			std::cerr<<"KinectServer: Worker process for shard "<<shard->name<<" did not connect in time"<<std::endl;
+			kill(shard->pid,SIGKILL);
+			shard->status=SHARD_FAILED;
+			shard->stateTime.set();
+			}
+		for(std::vector<CameraState*>::iterator csIt=shard->configCameras.begin();csIt!=shard->configCameras.end();++csIt)
+			if(*csIt!=0)
+				{
+				shardCameras.push_back(*csIt);
+				++shard->numCameras;
+				}
+		}
+	numCameras=shardCameras.size();
+	cameraStates=new CameraState*[numCameras];
+	for(unsigned int i=0;i<numCameras;++i)
+		cameraStates[i]=shardCameras[i];
+	
+	/* Create a timer to supervise the shard workers once per second: */
+	shardTimerFd=timerfd_create(CLOCK_MONOTONIC,0);
+	if(shardTimerFd<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to create shard supervision timer");
+	struct itimerspec timerInterval;
+	timerInterval.it_interval.tv_sec=1;
+	timerInterval.it_interval.tv_nsec=0;
+	timerInterval.it_value=timerInterval.it_interval;
+	if(timerfd_settime(shardTimerFd,0,&timerInterval,0)<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to start shard supervision timer");
+	dispatcher.addIOEventListener(shardTimerFd,Threads::EventDispatcher::Read,shardTimerCallback,this);
+	
+	/* Add an event listener for connections from restarted shard workers: */
+	dispatcher.addIOEventListener(shardListeningSocket->getFd(),Threads::EventDispatcher::Read,newShardConnectionCallback,this);
+	}
+
+void KinectServer::startShard(KinectServer::ShardState* shard)
+	{
+	/* Format the worker's command line arguments before forking: */
+	char shardIndexBuffer[16];
+	char* shardIndex=Misc::print(shard->shardIndex,shardIndexBuffer+sizeof(shardIndexBuffer)-1);
+	
+	/* Create a child process: */
+	pid_t pid=fork();
+	if(pid<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to start worker process for shard %s",shard->name.c_str());
+	if(pid==0)
+		{
+		/* Close all file descriptors inherited from the front end except standard input, output, and error: */
+		long maxFd=sysconf(_SC_OPEN_MAX);
+		for(long fd=3;fd<maxFd;++fd)
+			close(int(fd));
+		
+		/* Replace the child process with a new instance of the server executable running as a shard worker: */
+		execl("/proc/self/exe","KinectServer","-shard",shardIndex,shardSocketName.c_str(),static_cast<char*>(0));
+		_exit(1);
+		}
+	
+	/* Wait for the worker to connect: */
+	shard->pid=pid;
+	shard->status=SHARD_STARTING;
+	shard->stateTime.set();
+	}
+
+KinectServer::ShardState* KinectServer::acceptShard(bool initial)
+	{
+	/* Accept the incoming connection: */
+	Comm::UNIXPipe* pipe=new Comm::UNIXPipe(*shardListeningSocket);
+	try
+		{
+		/* Identify the connecting worker by its shard index and process ID: */
+		struct ucred peerCredentials;
+		socklen_t peerCredentialsSize=sizeof(struct ucred);
+		if(getsockopt(pipe->getFd(),SOL_SOCKET,SO_PEERCRED,&peerCredentials,&peerCredentialsSize)<0)
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to identify shard worker process");
+		unsigned int shardIndex=pipe->read<Misc::UInt32>();
+		if(shardIndex>=shards.size()||shards[shardIndex]->status!=SHARD_STARTING||shards[shardIndex]->pid!=peerCredentials.pid)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unexpected connection from process %d",int(peerCredentials.pid));
+		ShardState* shard=shards[shardIndex];
+		
+		/* Read the descriptions of the cameras opened by the worker: */
+		unsigned int numShardCameras=pipe->read<Misc::UInt32>();
+		shard->cameras.clear();
+		for(unsigned int i=0;i<numShardCameras;++i)
+			{
+			/* Read the camera's index in the shard's list of cameras and its parameters: */
+			unsigned int configIndex=pipe->read<Misc::UInt32>();
+			if(configIndex>=shard->configCameras.size())
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid camera index %u",configIndex);
+			std::string serialNumber;
+			Kinect::Size depthSize;
+			Kinect::FrameSource::DepthCorrection* depthCorrection;
+			Kinect::FrameSource::IntrinsicParameters ips;
+			Kinect::FrameSource::ExtrinsicParameters eps;
+			readCameraParameters(*pipe,serialNumber,depthSize,depthCorrection,ips,eps);
+			
+			CameraState*& cs=shard->configCameras[configIndex];
+			if(cs==0&&initial)
+				{
+				/* Create a proxy state for the camera and read its initial stream headers: */
+				cs=new CameraState(shard,serialNumber,depthSize,depthCorrection,ips,eps);
+				cs->readColorHeaderBlock(*pipe,0U);
+				cs->readDepthHeaderBlock(*pipe,0U);
+				}
+			else
+				{
+				/* Keep the parameters the camera had when the server started: */
+				delete depthCorrection;
+				
+				if(cs!=0)
+					{
+					/* Read the restarted worker's stream headers, which will be sent to clients as header refreshes: */
+					readShardHeaders(cs,cs->cameraIndex*2U,*pipe);
+					readShardHeaders(cs,cs->cameraIndex*2U+1U,*pipe);
+					}
+				else
+					{
+					/* Ignore a camera that could not be opened when the server started: */
+					skipHeaderBlock(*pipe);
+					skipHeaderBlock(*pipe);
+					}
+				}
+			
+			/* Map the worker's camera index to the camera's proxy state, and restart the camera's frame sequences: */
+			shard->cameras.push_back(cs);
+			if(cs!=0)
+				{
+				cs->shardCameraIndex=i;
+				cs->colorFrameIndex=0;
+				cs->depthFrameIndex=0;
+				}
+			}
+		
+		/* Listen for messages from the worker: */
+		shard->pipe=pipe;
+		shard->status=SHARD_RUNNING;
+		shard->started=false;
+		shard->stateTime.set();
+		shard->lastMessageTime=shard->stateTime;
+		shard->listenerKey=dispatcher.addIOEventListener(pipe->getFd(),Threads::EventDispatcher::Read,shardMessageCallback,shard);
+		
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Shard "<<shard->name<<" connected with "<<numShardCameras<<" cameras"<<std::endl;
+		#endif
+		
+		return shard;
+		}
+	catch(...)
+		{
+		/* Close the connection and re-throw the exception: */
+		delete pipe;
+		throw;
+		}
+	}
+
+void KinectServer::startShardStreaming(KinectServer::ShardState* shard)
+	{
+	try
+		{
+		/* Send the front end's time base to the worker to start streaming with consistent frame time stamps: */
+		shard->pipe->write<Misc::UInt32>(SHARD_START);
+		shard->pipe->write<Misc::SInt64>(timeBase.tv_sec);
+		shard->pipe->write<Misc::SInt64>(timeBase.tv_nsec);
+		shard->pipe->flush();
+		shard->started=true;
+		shard->lastMessageTime.set();
+		
+		/* Bring the shard's cameras online; they will join the next meta frame: */
+		for(std::vector<CameraState*>::iterator csIt=shard->cameras.begin();csIt!=shard->cameras.end();++csIt)
+			if(*csIt!=0)
+				(*csIt)->online=true;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"KinectServer: Disconnecting shard "<<shard->name<<" due to exception "<<err.what()<<std::endl;
+		shardFailed(shard,true);
+		}
+	}
+
+void KinectServer::shardFailed(KinectServer::ShardState* shard,bool removeListener)
+	{
+	/* Disconnect from the worker: */
+	if(removeListener)
+		dispatcher.removeIOEventListener(shard->listenerKey);
+	delete shard->pipe;
+	shard->pipe=0;
+	shard->status=SHARD_FAILED;
+	shard->stateTime.set();
+	
+	/* Ask the worker process to terminate; it will be killed if it does not terminate in time: */
+	if(shard->pid!=0)
+		kill(shard->pid,SIGTERM);
+	
+	/* Take the shard's cameras offline, and stop waiting for their frames in the current meta frame: */
+	for(std::vector<CameraState*>::iterator csIt=shard->cameras.begin();csIt!=shard->cameras.end();++csIt)
+		if(*csIt!=0)
+			{
+			CameraState* cs=*csIt;
+			cs->online=false;
+			if(!cs->hasSentColorFrame)
+				{
+				cs->hasSentColorFrame=true;
+				--numMissingColorFrames;
+				}
+			if(!cs->hasSentDepthFrame)
+				{
+				cs->hasSentDepthFrame=true;
+				--numMissingDepthFrames;
+				}
+			}
+	shard->cameras.clear();
+	checkMetaFrame();
+	
+	/* Fail all control commands waiting for replies from the worker: */
+	while(!shard->pendingControlClients.empty())
+		{
+		ControlClientState* controlClient=shard->pendingControlClients.front();
+		shard->pendingControlClients.pop_front();
+		if(controlClient!=0)
+			resumeControlClient(controlClient,"ERROR Shard "+shard->name+" failed\n");
+		}
+	}
+
+void KinectServer::readShardHeaders(KinectServer::CameraState* cs,unsigned int frameIndex,IO::File& source)
+	{
+	if(frameIndex&0x01U)
+		{
+		/* Announce pending depth stream headers to clients first, as frames compressed with them might not have been sent yet: */
+		if(cs->depthGeneration!=cs->sentDepthGeneration)
+			{
+			cs->setSentDepthGeneration(cs->depthGeneration);
+			sendHeaderRefresh(frameIndex);
+			}
+		
+		/* Read the new headers into the next header generation: */
+		++cs->depthGeneration;
+		cs->readDepthHeaderBlock(source,cs->depthGeneration&0x1U);
+		}
+	else
+		{
+		/* Announce pending color stream headers to clients first, as frames compressed with them might not have been sent yet: */
+		if(cs->colorGeneration!=cs->sentColorGeneration)
+			{
+			cs->setSentColorGeneration(cs->colorGeneration);
+			sendHeaderRefresh(frameIndex);
+			}
+		
+		/* Read the new headers into the next header generation: */
+		++cs->colorGeneration;
+		cs->readColorHeaderBlock(source,cs->colorGeneration&0x1U);
 		}
 	}
 
-void KinectServer::newConnectionCallback(Threads::EventDispatcher::IOEvent& event)
+void KinectServer::receiveShardFrame(KinectServer::ShardState* shard)
 	{
-	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	IO::File& pipe=*shard->pipe;
 	
-	/* Create a new client state object and add it to the list: */
-	ClientState* newClient=new ClientState(thisPtr,thisPtr->listeningSocket);
+	/* Read the frame's identifier, sequence number, time stamp, and flags: */
+	unsigned int shardFrameIndex=pipe.read<Misc::UInt32>();
+	if((shardFrameIndex>>1)>=shard->cameras.size())
+		throw std::runtime_error("Invalid camera index");
+	CameraState* cs=shard->cameras[shardFrameIndex>>1];
+	bool isDepth=(shardFrameIndex&0x01U)!=0;
+	unsigned int index=pipe.read<Misc::UInt32>();
+	double timeStamp=pipe.read<Misc::Float64>();
+	bool keyFrame=pipe.read<Misc::UInt8>()!=0;
+	bool unchanged=pipe.read<Misc::UInt8>()!=0;
 	
-	#ifdef VERBOSE
-	std::cout<<"KinectServer: Connecting new client "<<newClient->clientName<<std::endl;
-	#endif
+	if(cs==0)
+		{
+		/* Skip the frame of a camera unknown to the front end: */
+		if(isDepth&&!unchanged)
+			{
+			pipe.skip<Misc::UInt64>(1);
+			pipe.skip<Misc::UInt16>(Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles*2);
+			}
+		size_t dataSize=pipe.read<Misc::UInt32>();
+		pipe.skip<Misc::UInt8>(dataSize);
+		return;
+		}
 	
-	thisPtr->clients.push_back(newClient);
+	/* Store the frame in the camera's color or depth frame triple buffer: */
+	Threads::TripleBuffer<CameraState::CompressedFrame>& frames=isDepth?cs->depthFrames:cs->colorFrames;
+	CameraState::CompressedFrame& frame=frames.startNewValue();
+	frame.index=index;
+	frame.generation=isDepth?cs->depthGeneration:cs->colorGeneration;
+	frame.timeStamp=timeStamp;
+	frame.keyFrame=keyFrame;
+	frame.unchanged=unchanged;
+	if(isDepth&&!unchanged)
+		{
+		/* Read the depth frame's tile depth ranges: */
+		frame.validTiles=pipe.read<Misc::UInt64>();
+		for(unsigned int i=0;i<Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles;++i)
+			{
+			frame.tileRanges[i].min=pipe.read<Misc::UInt16>();
+			frame.tileRanges[i].max=pipe.read<Misc::UInt16>();
+			}
+		}
+	frame.dataSize=pipe.read<Misc::UInt32>();
+	IO::VariableMemoryFile& frameFile=isDepth?cs->depthFile:cs->colorFile;
+	copyBlock(pipe,frame.dataSize,frameFile);
+	frameFile.storeBuffers(frame.data);
+	frame.updateHeldSize();
+	frames.postNewValue();
 	
-	/* Add an event listener for incoming messages from the client: */
-	newClient->listenerKey=thisPtr->dispatcher.addIOEventListener(newClient->pipe.getFd(),Threads::EventDispatcher::Read,thisPtr->clientMessageCallback,newClient);
+	/* Update the shard's statistics, counting frames the worker's cameras skipped: */
+	unsigned int& nextIndex=isDepth?cs->depthFrameIndex:cs->colorFrameIndex;
+	if(index>nextIndex)
+		shard->numDroppedFrames+=index-nextIndex;
+	nextIndex=index+1;
+	++shard->numFrames;
+	shard->numBytes+=frame.dataSize;
+	
+	/* Send the frame to all streaming clients: */
+	distributeFrame(cs->cameraIndex*2U+(isDepth?1U:0U));
 	}
 
-void KinectServer::disconnectClient(KinectServer::ClientState* client,bool removeListener,bool removeFromList)
+void KinectServer::newShardConnectionCallback(Threads::EventDispatcher::IOEvent& event)
 	{
-	if(removeListener)
+	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	
+	try
 		{
-		/* Stop listening on the client's pipe: */
-		dispatcher.removeIOEventListener(client->listenerKey);
+		/* Accept the connection from a restarted worker and tell it to start streaming: */
+		ShardState* shard=thisPtr->acceptShard(false);
+		thisPtr->startShardStreaming(shard);
 		}
-	
-	/* Check if the client is still streaming: */
-	if(client->streaming)
-		--numStreamingClients;
-	
-	/* Disconnect the client: */
-	delete client;
-	
-	if(removeFromList)
+	catch(const std::runtime_error& err)
 		{
-		/* Remove the dead client from the list: */
-		for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
-			if(*csIt==client)
-				{
-				/* Remove it and stop searching: */
-				*csIt=clients.back();
-				clients.pop_back();
-				break;
-				}
+		std::cerr<<"KinectServer: Rejected shard worker connection due to exception "<<err.what()<<std::endl;
 		}
 	}
 
-void KinectServer::clientMessageCallback(Threads::EventDispatcher::IOEvent& event)
+void KinectServer::shardMessageCallback(Threads::EventDispatcher::IOEvent& event)
 	{
-	ClientState* client=static_cast<ClientState*>(event.getUserData());
-	KinectServer* thisPtr=client->server;
+	ShardState* shard=static_cast<ShardState*>(event.getUserData());
+	KinectServer* thisPtr=shard->server;
 	
 	try
 		{
-		/* Read some data from the socket into the socket's read buffer and check if client hung up: */
-		if(client->pipe.readSomeData()==0)
-			throw std::runtime_error("Client terminated connection");
+		/* Read some data from the pipe and check if the worker hung up: */
+		if(shard->pipe->readSomeData()==0)
+			throw std::runtime_error("Shard worker terminated connection");
+		shard->lastMessageTime.set();
 		
 		/* Process messages as long as there is data in the read buffer: */
-		while(client->pipe.canReadImmediately())
+		while(shard->pipe->canReadImmediately())
 			{
-			switch(client->state)
+			Misc::UInt32 message=shard->pipe->read<Misc::UInt32>();
+			if(message==SHARD_HEADERS)
 				{
-				case START:
-					{
-					/* Read endianness flag and protocol version from new client: */
-					Misc::UInt32 endiannessFlag=client->pipe.read<Misc::UInt32>();
-					if(endiannessFlag==0x78563412U)
-						client->pipe.setSwapOnRead(true);
-					else if(endiannessFlag!=0x12345678U)
-						throw std::runtime_error("Client has unrecognized endianness");
-					client->protocolVersion=client->pipe.read<Misc::UInt32>();
-					if(client->protocolVersion>1U)
-						client->protocolVersion=1U;
-					
-					/* Send stream initialization states to the new client: */
-					#ifdef VERBOSE
-					std::cout<<"KinectServer: Sending stream headers to client "<<client->clientName<<std::endl;
-					#endif
-					client->pipe.write<Misc::UInt32>(0x12345678U);
-					client->pipe.write<Misc::UInt32>(client->protocolVersion);
-					Kinect::FrameSource::Time now;
-					client->pipe.write<Misc::Float64>(double(now-thisPtr->timeBase));
-					client->pipe.write<Misc::UInt32>(thisPtr->numCameras);
-					for(unsigned i=0;i<thisPtr->numCameras;++i)
-						thisPtr->cameraStates[i]->writeHeaders(client->pipe);
-					
-					/* Finish the reply message: */
-					client->pipe.flush();
-					
-					/* Increase the number of streaming clients: */
-					++thisPtr->numStreamingClients;
-					
-					/* Go to streaming state: */
-					client->state=STREAMING;
-					client->streaming=true;
-					#ifdef VERBOSE
-					std::cout<<"KinectServer: Client "<<client->clientName<<" entered streaming mode"<<std::endl;
-					#endif
-					
-					break;
-					}
-				
-				case STREAMING:
-					{
-					/* Read a message from the client: */
-					Misc::UInt32 message=client->pipe.read<Misc::UInt32>();
-					
-					if(message==0U) // Disconnect request
-						{
-						/* Cleanly disconnect this client: */
-						#ifdef VERBOSE
-						std::cout<<"KinectServer: Disconnecting client "<<client->clientName<<std::endl;
-						#endif
-						thisPtr->disconnectClient(client,false,true);
-						
-						/* Stop listening: */
-						event.removeListener();
-						
-						/* Stop processing messages: */
-						goto doneWithMessages;
-						}
-					else
-						throw std::runtime_error("Protocol error in STREAMING state");
-						
-					break;
-					}
+				/* Read new stream headers for one of the worker's cameras: */
+				unsigned int shardFrameIndex=shard->pipe->read<Misc::UInt32>();
+				if((shardFrameIndex>>1)>=shard->cameras.size())
+					throw std::runtime_error("Invalid camera index");
+				CameraState* cs=shard->cameras[shardFrameIndex>>1];
+				if(cs!=0)
+					thisPtr->readShardHeaders(cs,cs->cameraIndex*2U+(shardFrameIndex&0x01U),*shard->pipe);
+				else
+					skipHeaderBlock(*shard->pipe);
+				}
+			else if(message==SHARD_FRAME)
+				thisPtr->receiveShardFrame(shard);
+			else if(message==SHARD_CONTROL_REPLY)
+				{
+				/* Send the reply to the control client that issued the oldest forwarded command: */
+				std::string reply=Misc::Marshaller<std::string>::read(*shard->pipe);
+				if(shard->pendingControlClients.empty())
+					throw std::runtime_error("Unexpected control reply");
+				ControlClientState* controlClient=shard->pendingControlClients.front();
+				shard->pendingControlClients.pop_front();
+				if(controlClient!=0)
+					thisPtr->resumeControlClient(controlClient,reply);
 				}
+			else
+				throw std::runtime_error("Protocol error");
 			}
-		doneWithMessages:
-		;
 		}
 	catch(const std::runtime_error& err)
 		{
-		#ifdef VERBOSE
-		std::cout<<"KinectServer: Disconnecting client "<<client->clientName<<" due to exception "<<err.what()<<std::endl;
-		#endif
-		thisPtr->disconnectClient(client,false,true);
+		std::cerr<<"KinectServer: Disconnecting shard "<<shard->name<<" due to exception "<<err.what()<<std::endl;
+		thisPtr->shardFailed(shard,false);
 		
 		/* Stop listening: */
 		event.removeListener();
 		}
 	}
 
-KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection)
-	:numCameras(0),cameraStates(0),
-	 listeningSocket(configFileSection.retrieveValue<int>("./listenPortId",26000),5),
-	 numStreamingClients(0)
+void KinectServer::shardTimerCallback(Threads::EventDispatcher::IOEvent& event)
 	{
-	/* Create a pipe to signal arrival of new frames to the run loop: */
-	if(pipe(framePipeFds)<0)
-		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to open frame notification pipe");
+	KinectServer* thisPtr=static_cast<KinectServer*>(event.getUserData());
+	
+	/* Acknowledge the timer expiration: */
+	Misc::UInt64 numExpirations;
+	if(read(thisPtr->shardTimerFd,&numExpirations,sizeof(numExpirations))!=sizeof(numExpirations))
+		return;
 	
-	/* Read the list of cameras: */
-	std::vector<std::string> cameraNames=configFileSection.retrieveValue<std::vector<std::string> >("./cameras",std::vector<std::string>());
+	Kinect::FrameSource::Time now;
+	for(std::vector<ShardState*>::iterator sIt=thisPtr->shards.begin();sIt!=thisPtr->shards.end();++sIt)
+		{
+		ShardState* shard=*sIt;
+		
+		/* Reap a terminated worker process: */
+		int status;
+		if(shard->pid!=0&&waitpid(shard->pid,&status,WNOHANG)==shard->pid)
+			{
+			if(WIFSIGNALED(status))
+				std::cerr<<"KinectServer: Worker process "<<shard->pid<<" for shard "<<shard->name<<" was terminated by signal "<<WTERMSIG(status)<<std::endl;
+			else
+				std::cerr<<"KinectServer: Worker process "<<shard->pid<<" for shard "<<shard->name<<" exited with status "<<WEXITSTATUS(status)<<std::endl;
+			shard->pid=0;
+			if(shard->status==SHARD_RUNNING)
+				thisPtr->shardFailed(shard,true);
+			shard->status=SHARD_DOWN;
+			shard->stateTime=now;
+			}
+		
+		switch(shard->status)
+			{
+			case SHARD_STARTING:
+				/* Kill a worker that does not connect in time: */
+				if(double(now-shard->stateTime)>=thisPtr->shardStartupTimeout)
+					{
+					std::cerr<<"KinectServer: Worker process for shard "<<shard->name<<" did not connect in time"<<std::endl;
+					kill(shard->pid,SIGKILL);
+					shard->status=SHARD_FAILED;
+					shard->stateTime=now;
+					}
+				break;
+			
+			case SHARD_RUNNING:
+				/* Kill a streaming worker that stopped sending frames: */
+				if(shard->started&&!shard->cameras.empty()&&double(now-shard->lastMessageTime)>=thisPtr->shardTimeout)
+					{
+					std::cerr<<"KinectServer: Shard "<<shard->name<<" stopped sending frames"<<std::endl;
+					thisPtr->shardFailed(shard,true);
+					if(shard->pid!=0)
+						kill(shard->pid,SIGKILL);
+					}
+				break;
+			
+			case SHARD_FAILED:
+				/* Kill a failed worker that does not terminate in time: */
+				if(shard->pid!=0&&double(now-shard->stateTime)>=thisPtr->shardTimeout)
+					kill(shard->pid,SIGKILL);
+				break;
+			
+			case SHARD_DOWN:
+				/* Restart a shard serving cameras after a delay: */
+				if(shard->numCameras>0&&double(now-shard->stateTime)>=thisPtr->shardRestartDelay)
+					{
+					#ifdef VERBOSE
+					std::cout<<"KinectServer: Restarting worker process for shard "<<shard->name<<std::endl;
+					#endif
+					try
+						{
+						thisPtr->startShard(shard);
+						++shard->numRestarts;
+						}
+					catch(const std::runtime_error& err)
+						{
+						std::cerr<<"KinectServer: Unable to restart shard "<<shard->name<<" due to exception "<<err.what()<<std::endl;
+						shard->stateTime=now;
+						}
+					}
+				break;
+			}
+		}
+	}
+
+void KinectServer::openCameras(Misc::ConfigurationFileSection& configFileSection,const std::vector<std::string>& cameraNames,std::vector<unsigned int>* cameraNameIndices)
+	{
 	numCameras=cameraNames.size();
 	cameraStates=new CameraState*[numCameras];
 	
@@ -497,11 +2334,24 @@ KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection)
 		
 		try
 			{
+			/* Select the camera's depth frame codec, defaulting to the legacy lossy compression flag: */
+			const char* defaultDepthCodec=cameraSection.retrieveValue<bool>("./lossyDepthCompression",false)?"Theora":"Huffman";
+			Kinect::DepthFrameCodec depthCodec=Kinect::parseDepthFrameCodec(cameraSection.retrieveString("./depthCodec",defaultDepthCodec).c_str());
+			if(!Kinect::isDepthFrameCodecSupported(depthCodec))
+				{
+				std::cerr<<"KinectServer: "<<Kinect::getDepthFrameCodecName(depthCodec)<<" depth frame codec not supported; using Huffman codec instead"<<std::endl;
+				depthCodec=Kinect::DEPTH_CODEC_HUFFMAN;
+				}
+			
+			/* Select the camera's color frame codec and whether to stream raw Bayer color frames: */
+			Kinect::ColorFrameCodec colorCodec=Kinect::parseColorFrameCodec(cameraSection.retrieveString("./colorCodec","Theora").c_str());
+			bool bayerPassthrough=cameraSection.retrieveValue<bool>("./bayerPassthrough",false);
+			
 			/* Create a streamer for the Kinect device of the requested serial number: */
 			#ifdef VERBOSE
 			std::cout<<"KinectServer: Creating streamer for camera with serial number "<<serialNumber<<std::endl;
 			#endif
-			cameraStates[numFoundCameras]=new CameraState(serialNumber.c_str(),cameraSection.retrieveValue<bool>("./lossyDepthCompression",false));
+			cameraStates[numFoundCameras]=new CameraState(serialNumber.c_str(),depthCodec,colorCodec,bayerPassthrough);
 			
 			/* Check if camera is to remove background: */
 			if(cameraSection.retrieveValue<bool>("./removeBackground",true))
@@ -555,6 +2405,21 @@ KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection)
 				camera->setRemoveBackground(true);
 				}
 			
+			/* Check whether to skip depth and color frames while the camera's scene is static: */
+			if(cameraSection.retrieveValue<bool>("./skipStaticFrames",configFileSection.retrieveValue<bool>("./skipStaticFrames",false)))
+				{
+				unsigned int depthThreshold=cameraSection.retrieveValue<unsigned int>("./staticDepthThreshold",4);
+				unsigned int colorThreshold=cameraSection.retrieveValue<unsigned int>("./staticColorThreshold",12);
+				double tileFraction=cameraSection.retrieveValue<double>("./staticTileFraction",0.002);
+				unsigned int maxStaticFrames=cameraSection.retrieveValue<unsigned int>("./maxStaticFrames",30);
+				#ifdef VERBOSE
+				std::cout<<"KinectServer: Skipping static frames with depth threshold "<<depthThreshold<<", color threshold "<<colorThreshold<<", and forced frames every "<<maxStaticFrames<<" frames"<<std::endl;
+				#endif
+				cameraStates[numFoundCameras]->enableStaticFrameSkipping(depthThreshold,colorThreshold,tileFraction,maxStaticFrames);
+				}
+			
+			if(cameraNameIndices!=0)
+				cameraNameIndices->push_back(i);
 			++numFoundCameras;
 			}
 		catch(const std::runtime_error& err)
@@ -563,28 +2428,149 @@ KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection)
 			}
 		}
 	
+	numCameras=numFoundCameras;
+	}
+
+KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection)
+	:numCameras(0),cameraStates(0),
+	 listeningSocket(new Comm::ListeningTCPSocket(configFileSection.retrieveValue<int>("./listenPortId",26000),5)),
+	 numStreamingClients(0),
+	 controlSocketFd(-1),
+	 shardListeningSocket(0),shardTimerFd(-1),
+	 shardStartupTimeout(configFileSection.retrieveValue<double>("./shardStartupTimeout",30.0)),
+	 shardTimeout(configFileSection.retrieveValue<double>("./shardTimeout",5.0)),
+	 shardRestartDelay(configFileSection.retrieveValue<double>("./shardRestartDelay",2.0)),
+	 frontEndPipe(0)
+	{
+	/* Create a pipe to signal arrival of new frames to the run loop: */
+	if(pipe(framePipeFds)<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to open frame notification pipe");
+	
+	/* Check whether to serve the cameras via shard worker processes: */
+	std::vector<std::string> shardNames=configFileSection.retrieveValue<std::vector<std::string> >("./shards",std::vector<std::string>());
+	if(!shardNames.empty())
+		startShards(configFileSection,shardNames);
+	else
+		{
+		/* Read the list of cameras and connect to all requested Kinect devices: */
+		std::vector<std::string> cameraNames=configFileSection.retrieveValue<std::vector<std::string> >("./cameras",std::vector<std::string>());
+		openCameras(configFileSection,cameraNames,0);
+		}
+	
 	/* Initialize streaming state: */
 	#ifdef VERBOSE
-	std::cout<<"KinectServer: "<<numFoundCameras<<" cameras initialized"<<std::endl;
+	std::cout<<"KinectServer: "<<numCameras<<" cameras initialized"<<std::endl;
 	#endif
-	numCameras=numFoundCameras;
 	metaFrameIndex=0;
-	numMissingColorFrames=numCameras;
-	numMissingDepthFrames=numCameras;
 	for(unsigned int i=0;i<numCameras;++i)
 		{
 		cameraStates[i]->cameraIndex=i;
 		cameraStates[i]->framePipeFd=framePipeFds[1];
 		}
+	startMetaFrame();
 	
 	/* Add an event listener for frame arrival messages: */
 	dispatcher.addIOEventListener(framePipeFds[0],Threads::EventDispatcher::Read,newFrameCallbackWrapper,this);
 	
 	/* Add an event listener for incoming connections on the listening socket: */
 	#ifdef VERBOSE
-	std::cout<<"KinectServer: Listening for incoming connections on TCP port "<<listeningSocket.getPortId()<<std::endl;
+	std::cout<<"KinectServer: Listening for incoming connections on TCP port "<<listeningSocket->getPortId()<<std::endl;
+	#endif
+	dispatcher.addIOEventListener(listeningSocket->getFd(),Threads::EventDispatcher::Read,newConnectionCallback,this);
+	
+	/* Check whether to open a local control socket: */
+	controlSocketName=configFileSection.retrieveString("./controlSocketName",std::string());
+	if(!controlSocketName.empty())
+		{
+		struct sockaddr_un controlAddress;
+		memset(&controlAddress,0,sizeof(struct sockaddr_un));
+		controlAddress.sun_family=AF_UNIX;
+		if(controlSocketName.size()>=sizeof(controlAddress.sun_path))
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Control socket name %s is too long",controlSocketName.c_str());
+		strcpy(controlAddress.sun_path,controlSocketName.c_str());
+		
+		/* Remove a stale socket left behind by a previous server instance, and create and bind the control socket: */
+		unlinkSocket(controlSocketName);
+		controlSocketFd=socket(AF_UNIX,SOCK_STREAM,0);
+		if(controlSocketFd<0)
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to create control socket");
+		if(bind(controlSocketFd,reinterpret_cast<struct sockaddr*>(&controlAddress),sizeof(struct sockaddr_un))<0||listen(controlSocketFd,5)<0)
+			{
+			int error=errno;
+			close(controlSocketFd);
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,error,"Unable to bind control socket to %s",controlSocketName.c_str());
+			}
+		
+		/* Add an event listener for incoming control connections: */
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Listening for control connections on "<<controlSocketName<<std::endl;
+		#endif
+		dispatcher.addIOEventListener(controlSocketFd,Threads::EventDispatcher::Read,newControlConnectionCallback,this);
+		}
+	}
+
+KinectServer::KinectServer(Misc::ConfigurationFileSection& configFileSection,unsigned int shardIndex,const char* frontEndSocketName)
+	:numCameras(0),cameraStates(0),
+	 listeningSocket(0),
+	 numStreamingClients(0),
+	 controlSocketFd(-1),
+	 shardListeningSocket(0),shardTimerFd(-1),
+	 shardStartupTimeout(0.0),shardTimeout(0.0),shardRestartDelay(0.0),
+	 frontEndPipe(0)
+	{
+	/* Create a pipe to signal arrival of new frames to the run loop: */
+	if(pipe(framePipeFds)<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to open frame notification pipe");
+	
+	/* Find the shard's configuration: */
+	std::vector<std::string> shardNames=configFileSection.retrieveValue<std::vector<std::string> >("./shards",std::vector<std::string>());
+	if(shardIndex>=shardNames.size())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid shard index %u",shardIndex);
+	Misc::ConfigurationFileSection shardSection=configFileSection.getSection(shardNames[shardIndex].c_str());
+	
+	/* Pin the worker and its streaming threads to the shard's CPUs, e.g., to those close to the shard's USB controller: */
+	std::vector<int> cpus=shardSection.retrieveValue<std::vector<int> >("./cpus",std::vector<int>());
+	if(!cpus.empty())
+		{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for(std::vector<int>::iterator cIt=cpus.begin();cIt!=cpus.end();++cIt)
+			CPU_SET(*cIt,&cpuSet);
+		if(sched_setaffinity(0,sizeof(cpu_set_t),&cpuSet)<0)
+			std::cerr<<"KinectServer: Unable to pin shard "<<shardNames[shardIndex]<<" to its CPUs due to error "<<strerror(errno)<<std::endl;
+		}
+	
+	/* Connect to the shard's cameras: */
+	std::vector<std::string> cameraNames=shardSection.retrieveValue<std::vector<std::string> >("./cameras");
+	std::vector<unsigned int> cameraNameIndices;
+	openCameras(configFileSection,cameraNames,&cameraNameIndices);
+	
+	/* Initialize streaming state: */
+	#ifdef VERBOSE
+	std::cout<<"KinectServer: "<<numCameras<<" cameras initialized in shard "<<shardNames[shardIndex]<<std::endl;
 	#endif
-	dispatcher.addIOEventListener(listeningSocket.getFd(),Threads::EventDispatcher::Read,newConnectionCallback,this);
+	metaFrameIndex=0;
+	for(unsigned int i=0;i<numCameras;++i)
+		{
+		cameraStates[i]->cameraIndex=i;
+		cameraStates[i]->framePipeFd=framePipeFds[1];
+		}
+	startMetaFrame();
+	
+	/* Connect to the front end and describe the shard's cameras: */
+	frontEndPipe=new Comm::UNIXPipe(frontEndSocketName,true);
+	frontEndPipe->write<Misc::UInt32>(shardIndex);
+	frontEndPipe->write<Misc::UInt32>(numCameras);
+	for(unsigned int i=0;i<numCameras;++i)
+		{
+		frontEndPipe->write<Misc::UInt32>(cameraNameIndices[i]);
+		cameraStates[i]->writeDescription(*frontEndPipe);
+		}
+	frontEndPipe->flush();
+	
+	/* Add event listeners for frame arrival messages and for messages from the front end: */
+	dispatcher.addIOEventListener(framePipeFds[0],Threads::EventDispatcher::Read,newFrameCallbackWrapper,this);
+	dispatcher.addIOEventListener(frontEndPipe->getFd(),Threads::EventDispatcher::Read,frontEndMessageCallback,this);
 	}
 
 KinectServer::~KinectServer(void)
@@ -596,6 +2582,56 @@ KinectServer::~KinectServer(void)
 	for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
 		delete *csIt;
 	
+	/* Close all control connections and the control socket: */
+	for(ControlClientStateList::iterator ccsIt=controlClients.begin();ccsIt!=controlClients.end();++ccsIt)
+		{
+		close((*ccsIt)->fd);
+		delete *ccsIt;
+		}
+	if(controlSocketFd>=0)
+		{
+		close(controlSocketFd);
+		unlinkSocket(controlSocketName);
+		}
+	
+	if(!shards.empty())
+		{
+		/* Disconnect from all shard workers and ask them to terminate: */
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Shutting down all shard workers"<<std::endl;
+		#endif
+		for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+			{
+			delete (*sIt)->pipe;
+			if((*sIt)->pid!=0)
+				kill((*sIt)->pid,SIGTERM);
+			}
+		
+		/* Wait for all workers to terminate, and kill those that do not terminate in time: */
+		Kinect::FrameSource::Time shutdownTime;
+		for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+			{
+			while((*sIt)->pid!=0)
+				{
+				int status;
+				pid_t result=waitpid((*sIt)->pid,&status,WNOHANG);
+				if(result==(*sIt)->pid||result<0)
+					(*sIt)->pid=0;
+				else if(double(Kinect::FrameSource::Time()-shutdownTime)>=shardTimeout)
+					{
+					kill((*sIt)->pid,SIGKILL);
+					waitpid((*sIt)->pid,&status,0);
+					(*sIt)->pid=0;
+					}
+				else
+					usleep(10000);
+				}
+			delete *sIt;
+			}
+		delete shardListeningSocket;
+		close(shardTimerFd);
+		}
+	
 	/* Delete all camera states: */
 	#ifdef VERBOSE
 	std::cout<<"KinectServer: Disconnecting from all cameras"<<std::endl;
@@ -604,6 +2640,10 @@ KinectServer::~KinectServer(void)
 		delete cameraStates[i];
 	delete[] cameraStates;
 	
+	/* Close the front end connection and the listening socket: */
+	delete frontEndPipe;
+	delete listeningSocket;
+	
 	/* Close the frame notification pipe: */
 	for(int i=0;i<2;++i)
 		close(framePipeFds[i]);
@@ -611,13 +2651,28 @@ KinectServer::~KinectServer(void)
 
 void KinectServer::run(void)
 	{
-	/* Start streaming on all connected cameras: */
-	#ifdef VERBOSE
-	std::cout<<"KinectServer: Starting streaming on "<<numCameras<<" cameras"<<std::endl;
-	#endif
-	timeBase.set();
-	for(unsigned int i=0;i<numCameras;++i)
-		cameraStates[i]->startStreaming(timeBase);
+	/* Shard workers start streaming when the front end tells them to: */
+	if(frontEndPipe==0)
+		{
+		/* Start streaming on all connected cameras: */
+		#ifdef VERBOSE
+		std::cout<<"KinectServer: Starting streaming on "<<numCameras<<" cameras"<<std::endl;
+		#endif
+		timeBase.set();
+		if(shards.empty())
+			{
+			for(unsigned int i=0;i<numCameras;++i)
+				cameraStates[i]->startStreaming(timeBase);
+			}
+		else
+			{
+			/* Start streaming on all connected shard workers, and wait for frames from their cameras: */
+			for(std::vector<ShardState*>::iterator sIt=shards.begin();sIt!=shards.end();++sIt)
+				if((*sIt)->status==SHARD_RUNNING)
+					startShardStreaming(*sIt);
+			startMetaFrame();
+			}
+		}
 	
 	#ifdef VERBOSE2
 	std::cout<<"Meta frame "<<metaFrameIndex;
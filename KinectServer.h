@@ -24,34 +24,58 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef KINECTSERVER_INCLUDED
 #define KINECTSERVER_INCLUDED
 
-#ifdef VERBOSE
+#include <sys/types.h>
 #include <string>
-#endif
 #include <vector>
+#include <deque>
+#include <Misc/SizedTypes.h>
 #include <IO/VariableMemoryFile.h>
+#include <Threads/Mutex.h>
 #include <Threads/TripleBuffer.h>
 #include <Threads/EventDispatcher.h>
 #include <Comm/ListeningTCPSocket.h>
 #include <Comm/TCPPipe.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <Geometry/ProjectiveTransformation.h>
+#include <Kinect/MemoryAccounting.h>
 #include <Kinect/FrameBuffer.h>
 #include <Kinect/FrameSource.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/DepthTileCuller.h>
+#include <Kinect/KinectV1DepthFrameWriter.h>
 
 /* Forward declarations: */
 class libusb_device;
 namespace Misc {
 class ConfigurationFileSection;
 }
+namespace Comm {
+class ListeningUNIXSocket;
+class UNIXPipe;
+}
 namespace Kinect {
 class DirectFrameSource;
 class FrameWriter;
+class FrameChangeDetector;
 }
 
 class KinectServer
 	{
 	/* Embedded classes: */
 	private:
+	enum ShardMessage // Enumerated type for messages exchanged between the front end and shard worker processes
+		{
+		SHARD_START=0, // Front end tells a worker to start streaming using the front end's time base
+		SHARD_FULL_FRAMES, // Front end requests full frames from one of a worker's cameras
+		SHARD_CONTROL_COMMAND, // Front end forwards a control command for one of a worker's cameras
+		SHARD_HEADERS, // Worker sends the new stream headers of one of its cameras' streams
+		SHARD_FRAME, // Worker sends a compressed frame from one of its cameras
+		SHARD_CONTROL_REPLY // Worker replies to a forwarded control command
+		};
+	
+	struct ShardState;
+	
 	struct CameraState // Structure to hold state related to capturing and compressing a color and depth stream from a Kinect camera
 		{
 		/* Embedded classes: */
@@ -61,51 +85,148 @@ class KinectServer
 			/* Elements: */
 			public:
 			unsigned int index; // Frame's sequence number as delivered from the camera
+			unsigned int generation; // Header generation of the compressor that compressed the frame
 			double timeStamp; // Frame's time stamp
 			IO::VariableMemoryFile::BufferChain data; // Frame's compressed data
+			size_t dataSize; // Size of the frame's compressed data in bytes
+			bool keyFrame; // Flag whether the frame can be decompressed without any previous frames
+			Kinect::FrameBuffer frame; // Frame's uncompressed data if it is a depth frame that can be cropped to clients' view regions
+			Kinect::DepthTileCuller::TileRange tileRanges[Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles]; // Valid depth value ranges of a depth frame's tiles
+			Kinect::DepthTileCuller::TileMask validTiles; // Mask of a depth frame's tiles containing valid pixels
+			bool unchanged; // Flag whether the frame was not compressed because it did not differ from the most recently compressed frame
+			Kinect::MemoryAccounting::Tag holderTag; // Holder tag to which the frame's compressed data and uncompressed frame are accounted
+			size_t heldSize; // Number of bytes currently accounted to the holder tag
 			
 			/* Constructors and destructors: */
 			CompressedFrame(void) // Dummy constructor
-				:index(0),timeStamp(0.0)
+				:index(0),generation(0),timeStamp(0.0),dataSize(0),keyFrame(true),validTiles(0),unchanged(false),
+				 holderTag(Kinect::MemoryAccounting::registerTag("KinectServer")),heldSize(0)
+				{
+				}
+			~CompressedFrame(void)
 				{
+				Kinect::MemoryAccounting::unhold(holderTag,heldSize);
 				}
+			
+			/* Methods: */
+			void updateHeldSize(void) // Accounts the frame's current compressed data and uncompressed frame to the holder tag, replacing the previous contents of the frame's triple buffer slot
+				{
+				Kinect::MemoryAccounting::unhold(holderTag,heldSize);
+				heldSize=dataSize+frame.getAccountedSize();
+				Kinect::MemoryAccounting::hold(holderTag,heldSize);
+				}
+			};
+		
+		enum CameraSetting // Enumerated type for camera settings that can be changed while the camera is streaming
+			{
+			SET_REMOVE_BACKGROUND=0x1,
+			SET_BACKGROUND_FUZZ=0x2,
+			SET_MAX_DEPTH=0x4,
+			SET_REMOVE_FLOOR=0x8,
+			CAPTURE_BACKGROUND=0x10
 			};
 		
 		/* Elements: */
 		public:
-		Kinect::DirectFrameSource* camera; // Camera generating the depth and color streams
+		Kinect::DirectFrameSource* camera; // Camera generating the depth and color streams, or null if the camera is served by a shard worker process
+		std::string serialNumber; // Camera's serial number
 		unsigned int cameraIndex; // Camera index to identify depth and color frames
 		Kinect::FrameSource::DepthCorrection* depthCorrection; // Camera's depth correction parameters
 		Kinect::FrameSource::IntrinsicParameters ips; // Camera's intrinsic parameters
 		Kinect::FrameSource::ExtrinsicParameters eps; // Camera's extrinsic parameters
 		int framePipeFd; // Pipe to signal arrival of new depth or color frames to the run loop
+		ShardState* shard; // Shard worker process serving the camera, or null if the camera is served by this process
+		unsigned int shardCameraIndex; // Index of the camera in its shard worker's list of cameras
+		bool online; // Flag whether the camera is currently delivering frames; false while its shard worker is down
+		Threads::Mutex settingsMutex; // Mutex protecting codec change requests, header generation counters, full frame requests, and camera setting requests
+		unsigned int pendingSettings; // Bit mask of requested camera settings that have not yet been applied by the depth streaming thread
+		bool requestedRemoveBackground; // Requested background removal flag
+		int requestedBackgroundFuzz; // Requested background removal fuzz value
+		unsigned int requestedMaxDepth; // Requested maximum depth value
+		bool requestedRemoveFloor; // Requested floor removal flag
+		unsigned int requestedNumBackgroundFrames; // Number of frames to capture for a requested background capture
+		bool requestedReplaceBackground; // Flag whether a requested background capture replaces the current background
 		
 		IO::VariableMemoryFile colorFile; // In-memory file to receive compressed color frame data
+		Kinect::ColorFrameCodec requestedColorCodec; // Codec to be used for the next compressed color frame
+		unsigned int colorGeneration; // Header generation of the current color compressor; incremented on every codec change
+		unsigned int sentColorGeneration; // Header generation of the color stream as seen by clients
+		Kinect::ColorFrameCodec colorCodecs[2]; // Color codecs of the current and next header generations, indexed by generation modulo two
 		Kinect::FrameWriter* colorCompressor; // Compressor for color frames
-		IO::VariableMemoryFile::BufferChain colorHeaders; // Write buffer containing the color compressor's header data
-		unsigned int colorFrameIndex; // Sequential frame index for color frames
+		IO::VariableMemoryFile::BufferChain colorHeaders[2]; // Write buffers containing the color compressors' header data of the current and next header generations
+		unsigned int colorFrameIndex; // Sequential frame index for color frames; index of the next expected color frame if the camera is served by a shard worker
 		Threads::TripleBuffer<CompressedFrame> colorFrames; // Triple buffer of compressed color frames
 		bool hasSentColorFrame; // Flag whether the camera has sent a color frame as part of the current meta-frame
+		Kinect::FrameChangeDetector* colorChangeDetector; // Detector to skip color frames of static scenes, or null if all color frames are sent
+		bool forceColorFrame; // Flag to send the next color frame even if the scene is static
+		IO::VariableMemoryFile::BufferChain lastColorFrame; // Copy of the most recently sent changed color frame, to be re-sent instead of unchanged frames to clients that do not understand unchanged frame markers
+		bool hasLastColorFrame; // Flag whether the last changed color frame was copied
 		
 		IO::VariableMemoryFile depthFile; // In-memory file to receive compressed depth frame data
-		bool lossyDepthCompression; // Flag whether this camera streams lossy-compressed depth frames
+		Kinect::DepthFrameCodec requestedDepthCodec; // Codec to be used for the next compressed depth frame
+		unsigned int depthGeneration; // Header generation of the current depth compressor; incremented on every codec change
+		unsigned int sentDepthGeneration; // Header generation of the depth stream as seen by clients
+		Kinect::DepthFrameCodec depthCodecs[2]; // Depth codecs of the current and next header generations, indexed by generation modulo two
 		Kinect::FrameWriter* depthCompressor; // Compressor for depth frames
-		IO::VariableMemoryFile::BufferChain depthHeaders; // Write buffer containing the depth compressor's header data
+		Kinect::KinectV1RawDepthFrame rawDepthFrame; // The camera's most recent depth frame in its native compressed format, if the camera is a first-generation Kinect and the depth codec passes compressed frames through
+		IO::VariableMemoryFile::BufferChain depthHeaders[2]; // Write buffers containing the depth compressors' header data of the current and next header generations
 		unsigned int depthFrameIndex; // Sequential frame index for depth frames
 		Threads::TripleBuffer<CompressedFrame> depthFrames; // Triple buffer of compressed depth frames
 		bool hasSentDepthFrame; // Flag whether the camera has sent a depth frame as part of the current meta-frame
+		Kinect::DepthTileCuller* depthTileCuller; // Culler to determine which tiles of depth frames are visible from clients' view regions
+		IO::VariableMemoryFile croppedDepthFile; // In-memory file to receive compressed depth frames cropped to clients' view regions
+		Kinect::FrameWriter* croppedDepthCompressor; // Compressor for cropped depth frames, or null if the depth codec depends on previous frames
+		Kinect::FrameChangeDetector* depthChangeDetector; // Detector to skip depth frames of static scenes, or null if all depth frames are sent
+		bool forceDepthFrame; // Flag to send the next depth frame even if the scene is static
+		IO::VariableMemoryFile::BufferChain lastDepthFrame; // Copy of the most recently sent changed depth frame, to be re-sent instead of unchanged frames to clients that do not understand unchanged frame markers
+		bool hasLastDepthFrame; // Flag whether the last changed depth frame was copied
+		IO::VariableMemoryFile lastFrameFile; // In-memory file to copy changed color and depth frames
 		
 		/* Private methods: */
+		void updateColorCompressor(void); // Replaces the color compressor if a new codec was requested and clients have caught up with the previous change, and handles full frame requests; called from the color streaming thread
+		void updateDepthCompressor(void); // Ditto for the depth compressor
+		void applyCameraSettings(void); // Applies requested camera settings to the camera between depth frames; called from the depth streaming thread
 		void colorStreamingCallback(const Kinect::FrameBuffer& frame);
+		void rawDepthStreamingCallback(const Kinect::KinectV1RawDepthFrame& rawFrame);
 		void depthStreamingCallback(const Kinect::FrameBuffer& frame);
 		
 		/* Constructors and destructors: */
-		CameraState(const char* serialNumber,bool sLossyDepthCompression); // Creates a capture and compression state for the given Kinect camera device
+		CameraState(const char* sSerialNumber,Kinect::DepthFrameCodec sDepthCodec,Kinect::ColorFrameCodec sColorCodec,bool bayerPassthrough); // Creates a capture and compression state for the given Kinect camera device using the given depth and color frame codecs, optionally capturing raw Bayer color frames
+		CameraState(ShardState* sShard,const std::string& sSerialNumber,const Kinect::Size& depthSize,Kinect::FrameSource::DepthCorrection* sDepthCorrection,const Kinect::FrameSource::IntrinsicParameters& sIps,const Kinect::FrameSource::ExtrinsicParameters& sEps); // Creates a proxy state for a camera served by the given shard worker, with the given parameters; adopts the depth correction object; stream headers must be read separately
 		~CameraState(void);
 		
 		/* Methods: */
 		void startStreaming(const Kinect::FrameSource::Time& timeBase); // Starts streaming from the Kinect camera
+		void enableStaticFrameSkipping(unsigned int depthThreshold,unsigned int colorThreshold,double tileFraction,unsigned int maxStaticFrames); // Skips compressing and sending depth and color frames that do not differ from the most recently sent frames by more than the given per-pixel thresholds; must be called before streaming starts
+		void requestFullFrames(void); // Requests to send the next depth and color frames as key frames even if the scene is static
+		Kinect::ColorFrameCodec getColorCodec(void) const // Returns the color codec of the stream as seen by clients; must be called from the run loop
+			{
+			return colorCodecs[sentColorGeneration&0x1U];
+			}
+		Kinect::DepthFrameCodec getDepthCodec(void) const // Ditto for the depth codec
+			{
+			return depthCodecs[sentDepthGeneration&0x1U];
+			}
+		void requestColorCodec(Kinect::ColorFrameCodec newColorCodec); // Requests to compress color frames with the given codec, starting at the next color frame
+		void requestDepthCodec(Kinect::DepthFrameCodec newDepthCodec); // Ditto for depth frames
+		bool getRemoveBackground(void); // Returns the camera's background removal flag, including a requested but not yet applied change
+		int getBackgroundFuzz(void); // Ditto for the background removal fuzz value
+		bool getRemoveFloor(void); // Ditto for the floor removal flag
+		void requestRemoveBackground(bool newRemoveBackground); // Requests to enable or disable background removal, starting at the next depth frame
+		void requestBackgroundFuzz(int newBackgroundFuzz); // Ditto for the background removal fuzz value
+		void requestMaxDepth(unsigned int newMaxDepth); // Ditto for the maximum depth value
+		void requestRemoveFloor(bool newRemoveFloor); // Ditto for floor removal
+		void requestBackgroundCapture(unsigned int numFrames,bool replace); // Requests to capture a new background from the given number of frames, starting at the next depth frame
+		void setSentColorGeneration(unsigned int newSentColorGeneration); // Notifies the color streaming thread that clients have seen the given color header generation; must be called from the run loop
+		void setSentDepthGeneration(unsigned int newSentDepthGeneration); // Ditto for the depth header generation
 		void writeHeaders(IO::File& sink) const; // Writes the camera's streaming headers to the given sink
+		void writeColorHeaders(IO::File& sink) const; // Writes the color stream's format version, codec, and compressor headers to the given sink as part of a header refresh
+		void writeDepthHeaders(IO::File& sink) const; // Ditto for the depth stream
+		void writeDescription(IO::File& sink) const; // Writes the camera's parameters and current stream headers to a shard worker's front end
+		void writeColorHeaderBlock(IO::File& sink) const; // Writes the color stream's codec and size-prefixed compressor headers to a shard worker's front end
+		void writeDepthHeaderBlock(IO::File& sink) const; // Ditto for the depth stream
+		void readColorHeaderBlock(IO::File& source,unsigned int slot); // Reads the color stream's codec and compressor headers sent by a shard worker into the given header generation slot
+		void readDepthHeaderBlock(IO::File& source,unsigned int slot); // Ditto for the depth stream
 		};
 	
 	struct ClientState // Class containing state of connected client
@@ -121,6 +242,11 @@ class KinectServer
 		int state; // Client's current position in the KinectServer protocol state machine
 		unsigned int protocolVersion; // Version of the KinectServer protocol to use with this client
 		bool streaming; // Flag whether client is currently in streaming mode
+		Kinect::DepthTileCuller::ViewRegion viewRegion; // Client's convex view region in world space; empty if the client wants to see everything
+		double viewRegionMargin; // Distance by which to expand the client's view region
+		std::vector<Kinect::DepthTileCuller::TileMask> visibleTiles; // Masks of tiles of each camera's most recent depth frame that are visible from the client's view region
+		std::vector<bool> colorSynced; // Flags whether the client has received an unbroken sequence of color frames from each camera
+		std::vector<bool> depthSynced; // Flags whether the client has received an unbroken sequence of depth frames from each camera
 		
 		/* Constructors and destructors: */
 		ClientState(KinectServer* sServer,Comm::ListeningTCPSocket& listenSocket); // Accepts next incoming connection on given listening socket and establishes 3D video streaming connection
@@ -128,6 +254,51 @@ class KinectServer
 	
 	typedef std::vector<ClientState*> ClientStateList; // Type for list of connected clients
 	
+	struct ControlClientState // Structure containing state of a connected control client
+		{
+		/* Elements: */
+		public:
+		KinectServer* server; // Pointer to server object handling this control client
+		int fd; // File descriptor of the control connection
+		Threads::EventDispatcher::ListenerKey listenerKey; // Key with which this control client is listening for I/O events
+		std::string lineBuffer; // Buffer holding a partially-received command line
+		bool waitingForShard; // Flag whether the control client is waiting for the reply to a command forwarded to a shard worker
+		};
+	
+	typedef std::vector<ControlClientState*> ControlClientStateList; // Type for list of connected control clients
+	
+	enum ShardStatus // Enumerated type for states of shard worker processes
+		{
+		SHARD_STARTING=0,SHARD_RUNNING,SHARD_FAILED,SHARD_DOWN
+		};
+	
+	struct ShardState // Structure containing the front end's state of a shard worker process serving a subset of the cameras
+		{
+		/* Elements: */
+		public:
+		KinectServer* server; // Pointer to server object supervising this shard worker
+		unsigned int shardIndex; // Index of the shard in the server's list of shards
+		std::string name; // Name of the shard's configuration file section
+		std::vector<CameraState*> configCameras; // Proxy states of the cameras in the shard's configured list of cameras, or null for cameras that could not be opened at startup
+		unsigned int numCameras; // Number of non-null proxy states in the configured list of cameras
+		std::vector<CameraState*> cameras; // Proxy states of the cameras opened by the current worker process, indexed by the worker's camera index; null for cameras unknown to the front end
+		ShardStatus status; // Current state of the shard worker process
+		pid_t pid; // Process ID of the shard worker process, or 0 if there is no worker process
+		Comm::UNIXPipe* pipe; // Pipe connected to the shard worker, or null if the worker is not connected
+		Threads::EventDispatcher::ListenerKey listenerKey; // Key with which the shard worker is listening for I/O events
+		bool started; // Flag whether the shard worker was told to start streaming
+		Kinect::FrameSource::Time stateTime; // Time at which the shard worker entered its current state
+		Kinect::FrameSource::Time lastMessageTime; // Time at which the most recent message from the shard worker arrived
+		std::deque<ControlClientState*> pendingControlClients; // Control clients waiting for replies to commands forwarded to the shard worker, in order of forwarding; null for disconnected control clients
+		unsigned int numRestarts; // Number of times the shard worker process was restarted
+		Misc::UInt64 numFrames; // Number of frames received from the shard worker
+		Misc::UInt64 numBytes; // Number of bytes of compressed frame data received from the shard worker
+		Misc::UInt64 numDroppedFrames; // Number of frames dropped by the shard worker's cameras, determined from gaps in frame indices
+		
+		/* Constructors and destructors: */
+		ShardState(KinectServer* sServer,unsigned int sShardIndex,const std::string& sName,unsigned int numConfigCameras);
+		};
+	
 	/* Elements: */
 	private:
 	Kinect::FrameSource::Time timeBase; // Time point at which server started streaming
@@ -135,14 +306,33 @@ class KinectServer
 	CameraState** cameraStates; // Array of pointers to camera state objects
 	int framePipeFds[2]; // Pipe to signal arrivals of new depth or color frames to the run loop
 	Threads::EventDispatcher dispatcher; // Event dispatcher to handle communication with multiple clients in parallel
-	Comm::ListeningTCPSocket listeningSocket; // Socket listening for incoming client connections
+	Comm::ListeningTCPSocket* listeningSocket; // Socket listening for incoming client connections, or null in shard worker processes
 	ClientStateList clients; // List of currently connected clients
 	int numStreamingClients; // Number of clients that are currently streaming
 	unsigned int metaFrameIndex; // Index of the current meta-frame
 	unsigned int numMissingDepthFrames; // Number of outstanding depth frames for this meta-frame
 	unsigned int numMissingColorFrames; // Number of outstanding color frames for this meta-frame
+	std::string controlSocketName; // File name of the local control socket, or empty if there is no control channel
+	int controlSocketFd; // Socket listening for incoming control connections, or -1
+	ControlClientStateList controlClients; // List of currently connected control clients
+	std::vector<ShardState*> shards; // List of shard worker processes serving the cameras; empty if the cameras are served by this process
+	std::string shardSocketName; // Name of the abstract UNIX domain socket on which shard workers connect to the front end
+	Comm::ListeningUNIXSocket* shardListeningSocket; // Socket listening for connections from shard workers, or null
+	int shardTimerFd; // Timer to periodically supervise shard workers, or -1
+	double shardStartupTimeout; // Maximum time for a shard worker to open its cameras and connect to the front end
+	double shardTimeout; // Maximum time between messages from a streaming shard worker before it is considered hung
+	double shardRestartDelay; // Delay before restarting a terminated shard worker
+	Comm::UNIXPipe* frontEndPipe; // Pipe connected to the front end in shard worker processes, or null
 	
 	/* Private methods: */
+	void openCameras(Misc::ConfigurationFileSection& configFileSection,const std::vector<std::string>& cameraNames,std::vector<unsigned int>* cameraNameIndices); // Opens the cameras configured in the given sections of the given server configuration section; stores the indices of successfully opened cameras' names if the pointer is not null
+	void startMetaFrame(void); // Waits for a depth and a color frame from each online camera in the current meta-frame
+	void checkMetaFrame(void); // Starts the next meta-frame if the current meta-frame is complete
+	bool hasLegacyClients(void) const; // Returns true if any streaming clients use protocol version 1, which does not support culled or unchanged frame markers
+	void sendFrame(ClientState* client,unsigned int frameIndex,const IO::VariableMemoryFile::BufferChain* data); // Sends a compressed frame, or a culled frame marker if the data pointer is null, to the given client
+	void distributeFrame(unsigned int frameIndex); // Sends the most recent depth or color frame of the given camera to all streaming clients
+	void writeShardFrame(unsigned int frameIndex,const CameraState::CompressedFrame& frame); // Forwards the given compressed depth or color frame to the front end
+	void forwardFrame(unsigned int frameIndex); // Forwards the most recent depth or color frame of the given camera to the front end
 	void newFrameCallback(void); // Callback called when a new depth or color frame arrives from one of the cameras
 	static void newFrameCallbackWrapper(Threads::EventDispatcher::IOEvent& event) // Wrapper function for above
 		{
@@ -151,10 +341,30 @@ class KinectServer
 	static void newConnectionCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a connection attempt is made at the listening socket
 	void disconnectClient(ClientState* client,bool removeListener,bool removeFromList); // Disconnects the given client due to a communication error; removes listener and/or dead client from list if respective flags are true
 	static void clientMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a message from a client arrives
+	void sendHeaderRefresh(unsigned int frameIndex); // Sends the refreshed stream headers of the given color or depth stream to all streaming clients
+	static void newControlConnectionCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a connection attempt is made at the control socket
+	void disconnectControlClient(ControlClientState* controlClient); // Closes the given control connection and removes it from the list
+	static void controlMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when data from a control client arrives
+	bool sendControlReply(ControlClientState* controlClient,const std::string& reply); // Sends the given reply to the given control client; returns false on error
+	bool executeControlCommands(ControlClientState* controlClient); // Executes all complete command lines received from the given control client until a command is forwarded to a shard worker; returns false on error
+	void resumeControlClient(ControlClientState* controlClient,const std::string& reply); // Sends the reply to a forwarded command to the given control client and executes its remaining command lines
+	std::string processControlCommand(ControlClientState* controlClient,const std::string& commandLine); // Executes the given control command and returns a reply, which may span multiple lines, or an empty string if the command was forwarded to a shard worker on behalf of the given control client
+	static void frontEndMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a message from the front end arrives in a shard worker process
+	void startShards(Misc::ConfigurationFileSection& configFileSection,const std::vector<std::string>& shardNames); // Starts worker processes for the given shards and waits for them to connect and describe their cameras
+	void startShard(ShardState* shard); // Starts a worker process for the given shard
+	ShardState* acceptShard(bool initial); // Accepts a connection from a shard worker and reads its camera descriptions; creates proxy states for the shard's cameras if the flag is true
+	void startShardStreaming(ShardState* shard); // Tells the given connected shard worker to start streaming and brings its cameras online
+	void shardFailed(ShardState* shard,bool removeListener); // Disconnects the given failed shard worker, takes its cameras offline, and asks it to terminate; removes listener if flag is true
+	void readShardHeaders(CameraState* cs,unsigned int frameIndex,IO::File& source); // Reads new headers of the given camera's color or depth stream sent by its shard worker into the stream's next header generation
+	void receiveShardFrame(ShardState* shard); // Receives a compressed frame from the given shard worker and sends it to all streaming clients
+	static void newShardConnectionCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a restarted shard worker connects to the front end
+	static void shardMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a message from a shard worker arrives
+	static void shardTimerCallback(Threads::EventDispatcher::IOEvent& event); // Callback called periodically to supervise shard workers
 	
 	/* Constructors and destructors: */
 	public:
-	KinectServer(Misc::ConfigurationFileSection& configFileSection);
+	KinectServer(Misc::ConfigurationFileSection& configFileSection); // Creates a server for the cameras configured in the given section; serves cameras via shard worker processes if the section configures shards
+	KinectServer(Misc::ConfigurationFileSection& configFileSection,unsigned int shardIndex,const char* frontEndSocketName); // Creates a shard worker process serving the cameras of the given shard to the front end listening on the given abstract UNIX domain socket
 	~KinectServer(void);
 	
 	/* Methods: */
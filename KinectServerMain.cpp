@@ -21,11 +21,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 ***********************************************************************/
 
 #include <string.h>
+#include <stdlib.h>
 #include <signal.h>
 #include <string>
 #include <iostream>
 #include <Misc/ConfigurationFile.h>
 #include <Comm/Pipe.h>
+#include <Kinect/MemoryAccounting.h>
 #include <Kinect/Internal/Config.h>
 
 #include "KinectServer.h"
@@ -39,8 +41,39 @@ void termSignalHandler(int)
 		server->stop();
 	}
 
-int main(void)
+int main(int argc,char* argv[])
 	{
+	/* Parse the command line: */
+	bool shardWorker=false;
+	unsigned int shardIndex=0;
+	const char* frontEndSocketName=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"shard")==0)
+				{
+				/* Run as a worker process serving one shard of the server's cameras: */
+				if(i+2<argc)
+					{
+					shardWorker=true;
+					shardIndex=(unsigned int)(atoi(argv[i+1]));
+					frontEndSocketName=argv[i+2];
+					i+=2;
+					}
+				else
+					{
+					std::cerr<<"KinectServerMain: Dangling -shard option"<<std::endl;
+					return 1;
+					}
+				}
+			else
+				std::cerr<<"KinectServerMain: Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"KinectServerMain: Ignoring command line argument "<<argv[i]<<std::endl;
+		}
+	
 	/* Ignore SIGPIPE and leave handling of pipe errors to TCP sockets: */
 	Comm::ignorePipeSignals();
 	
@@ -51,6 +84,23 @@ int main(void)
 	if(sigaction(SIGINT,&sigIntAction,0)!=0)
 		std::cerr<<"KinectServerMain: Cannot intercept SIG_INT signals. Server won't shut down cleanly."<<std::endl;
 	
+	/* Shut down cleanly on SIG_TERM as well, which the front end sends to its shard workers: */
+	if(sigaction(SIGTERM,&sigIntAction,0)!=0)
+		std::cerr<<"KinectServerMain: Cannot intercept SIG_TERM signals. Server won't shut down cleanly."<<std::endl;
+	
+	/* Dump frame buffer memory statistics on SIG_USR1 if memory accounting is enabled: */
+	if(Kinect::MemoryAccounting::isEnabled())
+		{
+		try
+			{
+			Kinect::MemoryAccounting::installDumpSignalHandler(SIGUSR1);
+			}
+		catch(const std::runtime_error& err)
+			{
+			std::cerr<<"KinectServerMain: "<<err.what()<<std::endl;
+			}
+		}
+	
 	try
 		{
 		/* Open the server's configuration file: */
@@ -59,9 +109,12 @@ int main(void)
 		serverConfigName.append(KINECT_INTERNAL_CONFIG_KINECTSERVER_CONFIGURATIONFILENAME);
 		Misc::ConfigurationFile serverConfig(serverConfigName.c_str());
 		
-		/* Create a Kinect server object: */
+		/* Create a Kinect server object, or a worker for one of the server's shards: */
 		Misc::ConfigurationFileSection serverSection=serverConfig.getSection("KinectServer");
-		server=new KinectServer(serverSection);
+		if(shardWorker)
+			server=new KinectServer(serverSection,shardIndex,frontEndSocketName);
+		else
+			server=new KinectServer(serverSection);
 		
 		/* Run the server's main loop: */
 		server->run();
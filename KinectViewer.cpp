@@ -61,6 +61,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Kinect/OpenDirectFrameSource.h>
 #include <Kinect/FileFrameSource.h>
 #include <Kinect/MultiplexedFrameSource.h>
+#include <Kinect/DepthTileCuller.h>
 #include <Kinect/ProjectorHeader.h>
 #include <Kinect/FrameSaver.h>
 
@@ -247,6 +248,20 @@ GLMotif::PopupWindow* KinectViewer::KinectStreamer::createStreamerDialog(void)
 	filterDepthFramesToggle->setToggle(projector->getFilterDepthFrames());
 	filterDepthFramesToggle->getValueChangedCallbacks().add(this,&KinectViewer::KinectStreamer::filterDepthFramesCallback);
 	
+	/* Create a toggle button to invalidate flying pixels at depth discontinuities: */
+	GLMotif::ToggleButton* removeFlyingPixelsToggle=new GLMotif::ToggleButton("RemoveFlyingPixelsToggle",processBox,"Remove Flying Pixels");
+	removeFlyingPixelsToggle->setBorderWidth(0.0f);
+	removeFlyingPixelsToggle->setBorderType(GLMotif::Widget::PLAIN);
+	removeFlyingPixelsToggle->setToggle(projector->getRemoveFlyingPixels());
+	removeFlyingPixelsToggle->getValueChangedCallbacks().add(this,&KinectViewer::KinectStreamer::removeFlyingPixelsCallback);
+	
+	/* Create a toggle button to fill small holes in depth frames: */
+	GLMotif::ToggleButton* fillHolesToggle=new GLMotif::ToggleButton("FillHolesToggle",processBox,"Fill Holes");
+	fillHolesToggle->setBorderWidth(0.0f);
+	fillHolesToggle->setBorderType(GLMotif::Widget::PLAIN);
+	fillHolesToggle->setToggle(projector->getFillHoles());
+	fillHolesToggle->getValueChangedCallbacks().add(this,&KinectViewer::KinectStreamer::fillHolesCallback);
+	
 	#endif
 	
 	new GLMotif::Label("TriangleDepthRangeLabel",processBox,"Triangle Depth Range");
@@ -259,7 +274,7 @@ GLMotif::PopupWindow* KinectViewer::KinectStreamer::createStreamerDialog(void)
 	triangleDepthRangeSlider->getValueChangedCallbacks().add(this,&KinectViewer::KinectStreamer::triangleDepthRangeCallback);
 	
 	#if !KINECT_CONFIG_USE_SHADERPROJECTOR
-	processBox->setColumnWeight(2,1.0);
+	processBox->setColumnWeight(4,1.0);
 	#else
 	processBox->setColumnWeight(1,1.0);
 	#endif
@@ -317,6 +332,18 @@ void KinectViewer::KinectStreamer::filterDepthFramesCallback(GLMotif::ToggleButt
 	projector->setFilterDepthFrames(cbData->set,false);
 	}
 
+void KinectViewer::KinectStreamer::removeFlyingPixelsCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+	{
+	/* Set the projector's flying pixel removal flag: */
+	projector->setRemoveFlyingPixels(cbData->set);
+	}
+
+void KinectViewer::KinectStreamer::fillHolesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+	{
+	/* Set the projector's hole filling flag: */
+	projector->setFillHoles(cbData->set);
+	}
+
 #endif
 
 void KinectViewer::KinectStreamer::triangleDepthRangeCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData)
@@ -530,7 +557,7 @@ void KinectViewer::startSavingStreams(const char* saveFileNameBase)
 		depthFileName.append(".depth");
 		
 		/* Attach a frame saver to the streamer: */
-		Kinect::FrameSaver* frameSaver=new Kinect::FrameSaver(streamers[i]->getFrameSource(),colorFileName.c_str(),depthFileName.c_str());
+		Kinect::FrameSaver* frameSaver=new Kinect::FrameSaver(streamers[i]->getFrameSource(),colorFileName.c_str(),depthFileName.c_str(),saveDepthCodec,saveColorCodec,saveFrameMetadata);
 		frameSaver->setTimeStampOffset(double(now-timeBase));
 		streamers[i]->setFrameSaver(frameSaver);
 		}
@@ -610,6 +637,7 @@ void KinectViewer::saveStreamsCancelCallback(GLMotif::FileSelectionDialog::Cance
 KinectViewer::KinectViewer(int& argc,char**& argv)
 	:Vrui::Application(argc,argv),
 	 saveStreamsToggle(0),saveStreamsDirectory(IO::Directory::getCurrent()),saveStreamsFileSelectionDialog(0),
+	 saveColorCodec(Kinect::COLOR_CODEC_THEORA),saveDepthCodec(Kinect::DEPTH_CODEC_HUFFMAN),saveFrameMetadata(false),
 	 soundRecorder(0),soundPlayer(0),
 	 mainMenu(0)
 	{
@@ -617,8 +645,10 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 	bool printHelp=false;
 	bool highres=false;
 	bool compressDepth=false;
+	bool bayerPassthrough=false;
 	int triangleDepthRange=-1;
 	const char* saveFileName=0;
+	Kinect::DepthTileCuller::ViewRegion viewRegion;
 	for(int i=1;i<argc;++i)
 		{
 		if(argv[i][0]=='-')
@@ -633,6 +663,10 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 				compressDepth=true;
 			else if(strcasecmp(argv[i]+1,"nocompress")==0)
 				compressDepth=false;
+			else if(strcasecmp(argv[i]+1,"bayer")==0)
+				bayerPassthrough=true;
+			else if(strcasecmp(argv[i]+1,"nobayer")==0)
+				bayerPassthrough=false;
 			else if(strcasecmp(argv[i]+1,"tdr")==0)
 				{
 				++i;
@@ -644,6 +678,29 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 				++i;
 				saveFileName=argv[i];
 				}
+			else if(strcasecmp(argv[i]+1,"saveColorCodec")==0)
+				{
+				++i;
+				saveColorCodec=Kinect::parseColorFrameCodec(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"saveDepthCodec")==0)
+				{
+				++i;
+				saveDepthCodec=Kinect::parseDepthFrameCodec(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"saveMetadata")==0)
+				saveFrameMetadata=true;
+			else if(strcasecmp(argv[i]+1,"region")==0)
+				{
+				/* Read a world-space box to which to restrict all subsequent 3D video streaming servers: */
+				Kinect::ProjectorBase::Point min,max;
+				for(int j=0;j<3;++j)
+					min[j]=atof(argv[i+1+j]);
+				for(int j=0;j<3;++j)
+					max[j]=atof(argv[i+4+j]);
+				i+=6;
+				viewRegion=Kinect::DepthTileCuller::makeBoxRegion(min,max);
+				}
 			else if(strcasecmp(argv[i]+1,"c")==0)
 				{
 				++i;
@@ -664,6 +721,9 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 						
 						/* Set depth frame compression: */
 						kinectV1->setCompressDepthFrames(compressDepth);
+						
+						/* Select raw Bayer color frames: */
+						kinectV1->setBayerPassthrough(bayerPassthrough);
 						}
 					
 					/* Enable background removal if the camera has a default background image: */
@@ -720,6 +780,15 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 				/* Open a multiplexed frame source for the given server host name and port number: */
 				Kinect::MultiplexedFrameSource* source=Kinect::MultiplexedFrameSource::create(Comm::openTCPPipe(argv[i-1],atoi(argv[i])));
 				
+				/* Restrict the server's streams to the current view region: */
+				if(!viewRegion.empty())
+					{
+					if(source->canSetViewRegion())
+						source->setViewRegion(viewRegion.size(),&viewRegion[0],0.0);
+					else
+						std::cerr<<"3D video streaming server "<<argv[i-1]<<':'<<argv[i]<<" does not support view regions"<<std::endl;
+					}
+				
 				/* Add a new streamer for each component stream in the multiplexer: */
 				for(unsigned int i=0;i<source->getNumStreams();++i)
 					{
@@ -756,16 +825,28 @@ KinectViewer::KinectViewer(int& argc,char**& argv)
 		std::cout<<"     Requests compressed depth frames from all subsequent first-generation Kinect cameras"<<std::endl;
 		std::cout<<"  -nocompress"<<std::endl;
 		std::cout<<"     Requests uncompressed depth frames from all subsequent first-generation Kinect cameras"<<std::endl;
+		std::cout<<"  -bayer"<<std::endl;
+		std::cout<<"     Requests raw Bayer color frames from all subsequent first-generation Kinect cameras, to be demosaiced on display"<<std::endl;
+		std::cout<<"  -nobayer"<<std::endl;
+		std::cout<<"     Requests demosaiced RGB color frames from all subsequent first-generation Kinect cameras"<<std::endl;
 		std::cout<<"  -tdr <triangle depth range>"<<std::endl;
 		std::cout<<"     Sets the initial triangle depth range of all subsequent 3D video sources"<<std::endl;
 		std::cout<<"  -save <stream file name base>"<<std::endl;
 		std::cout<<"     Saves 3D video streams from all connected sources"<<std::endl;
+		std::cout<<"  -saveColorCodec <codec name>"<<std::endl;
+		std::cout<<"     Selects the codec to compress saved color streams (Theora or Lossless)"<<std::endl;
+		std::cout<<"  -saveDepthCodec <codec name>"<<std::endl;
+		std::cout<<"     Selects the codec to compress saved depth streams (Huffman, Theora, Rans, or Spatial)"<<std::endl;
+		std::cout<<"  -saveMetadata"<<std::endl;
+		std::cout<<"     Saves per-frame device metadata, such as frame numbers and drop flags, with saved streams; requires an updated player"<<std::endl;
 		std::cout<<"  -c <camera index>"<<std::endl;
 		std::cout<<"     Connects to the local 3D camera of the given index (0: first camera on USB bus)"<<std::endl;
 		std::cout<<"  -f <stream file base name>"<<std::endl;
 		std::cout<<"     Opens a previously recorded pair of color and depth stream files for playback"<<std::endl;
 		std::cout<<"  -s <sound file name>"<<std::endl;
 		std::cout<<"     Opens a previously recorded sound file for playback"<<std::endl;
+		std::cout<<"  -region <min x> <min y> <min z> <max x> <max y> <max z>"<<std::endl;
+		std::cout<<"     Requests only 3D video visible inside the given world-space box from all subsequent 3D video stream servers"<<std::endl;
 		std::cout<<"  -p <host name of 3D video stream server> <port number of 3D video stream server>"<<std::endl;
 		std::cout<<"     Connects to a 3D video streaming server identified by host name and port number"<<std::endl;
 		}
@@ -41,6 +41,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Geometry/OrthogonalTransformation.h>
 #endif
 #include <Kinect/FrameSource.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
 #include <Kinect/ProjectorType.h>
 
 /* Forward declarations: */
@@ -104,6 +106,8 @@ class KinectViewer:public Vrui::Application
 		#endif
 		#if !KINECT_CONFIG_USE_SHADERPROJECTOR
 		void filterDepthFramesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+		void removeFlyingPixelsCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+		void fillHolesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
 		#endif
 		void triangleDepthRangeCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData);
 		void streamerDialogCloseCallback(Misc::CallbackData* cbData);
@@ -137,6 +141,9 @@ class KinectViewer:public Vrui::Application
 	GLMotif::ToggleButton* saveStreamsToggle; // Toggle button to save 3D video streams to files
 	IO::DirectoryPtr saveStreamsDirectory; // Last directory used/viewed when saving 3D video streams to files
 	GLMotif::FileSelectionDialog* saveStreamsFileSelectionDialog; // Pointer to file selection dialog if user is preparing to save 3D video streams
+	Kinect::ColorFrameCodec saveColorCodec; // Codec used to compress saved color streams
+	Kinect::DepthFrameCodec saveDepthCodec; // Codec used to compress saved depth streams
+	bool saveFrameMetadata; // Flag whether to save per-frame device metadata with saved streams
 	Sound::SoundRecorder* soundRecorder; // Recorder to save sound from the default sound source while saving 3D video streams
 	Sound::SoundPlayer* soundPlayer; // Player to play back sound from a previously saved 3D video stream
 	// Vrui::InputDevice* cameraDevice; // Pointer to the device to which the depth camera is attached
@@ -0,0 +1,650 @@
+/***********************************************************************
+MarkerTrackingDaemon - Server to track disk or sphere markers with one
+or more calibrated 3D cameras, and to stream predicted marker positions
+to VR applications as tracker states using the VR device daemon
+protocol.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "MarkerTrackingDaemon.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <iostream>
+#include <Misc/PrintInteger.h>
+#include <Misc/StdError.h>
+#include <Misc/FunctionCalls.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/CompoundValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <Vrui/Internal/VRDeviceDescriptor.h>
+#include <Vrui/Internal/BatteryState.h>
+#include <Kinect/Internal/Config.h>
+#include <Kinect/DirectFrameSource.h>
+#include <Kinect/OpenDirectFrameSource.h>
+#include <Kinect/SyntheticFrameSource.h>
+
+/***************************************************
+Methods of class MarkerTrackingDaemon::CameraState:
+***************************************************/
+
+void MarkerTrackingDaemon::CameraState::colorStreamingCallback(const Kinect::FrameBuffer& frame)
+	{
+	/* Forward the color frame to the sphere extractor, which needs it to find white spheres: */
+	if(sphereExtractor!=0)
+		sphereExtractor->setColorFrame(frame);
+	}
+
+void MarkerTrackingDaemon::CameraState::depthStreamingCallback(const Kinect::FrameBuffer& frame)
+	{
+	/* Forward the depth frame to the marker extractor; extractors drop frames they cannot keep up with: */
+	if(diskExtractor!=0)
+		diskExtractor->submitFrame(frame);
+	if(sphereExtractor!=0)
+		sphereExtractor->setDepthFrame(frame);
+	}
+
+void MarkerTrackingDaemon::CameraState::diskExtractionCallback(const Kinect::DiskExtractor::DiskList& disks)
+	{
+	/* Transform the disk centers to world space: */
+	detections.clear();
+	for(Kinect::DiskExtractor::DiskList::const_iterator dIt=disks.begin();dIt!=disks.end();++dIt)
+		detections.push_back(Kinect::MarkerTracker::Point(eps.transform(Kinect::FrameSource::ExtrinsicParameters::Point(dIt->center))));
+	
+	submitDetections(diskExtractor->getExtractionTimeStamp());
+	}
+
+void MarkerTrackingDaemon::CameraState::sphereExtractionCallback(const SphereExtractor::SphereList& spheres)
+	{
+	/* Transform the sphere centers to world space: */
+	detections.clear();
+	for(SphereExtractor::SphereList::const_iterator sIt=spheres.begin();sIt!=spheres.end();++sIt)
+		detections.push_back(Kinect::MarkerTracker::Point(eps.transform(Kinect::FrameSource::ExtrinsicParameters::Point(sIt->getCenter()))));
+	
+	submitDetections(sphereExtractor->getExtractionTimeStamp());
+	}
+
+void MarkerTrackingDaemon::CameraState::submitDetections(double timeStamp)
+	{
+	/* Update the marker filters: */
+	daemon->markerTracker.addDetections(timeStamp,detections);
+	
+	/* Notify the run loop: */
+	Misc::UInt32 ci=cameraIndex;
+	if(write(daemon->detectionPipeFds[1],&ci,sizeof(ci))!=sizeof(ci))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Write error on pipe");
+	}
+
+MarkerTrackingDaemon::CameraState::CameraState(MarkerTrackingDaemon* sDaemon,Kinect::FrameSource* sCamera,MarkerTrackingDaemon::MarkerType markerType,const Misc::ConfigurationFileSection& configFileSection)
+	:daemon(sDaemon),cameraIndex(0),camera(sCamera),depthCorrection(0),
+	 diskExtractor(0),sphereExtractor(0)
+	{
+	/* Retrieve the camera's per-pixel depth correction factors: */
+	const Kinect::Size& depthSize=camera->getActualFrameSize(Kinect::FrameSource::DEPTH);
+	Kinect::FrameSource::DepthCorrection* dc=camera->getDepthCorrectionParameters();
+	if(dc!=0)
+		{
+		depthCorrection=dc->getPixelCorrection(depthSize);
+		delete dc;
+		}
+	
+	/* Retrieve the camera's extrinsic parameters: */
+	eps=camera->getExtrinsicParameters();
+	
+	if(markerType==DISKS)
+		{
+		/* Create a disk extractor: */
+		diskExtractor=new Kinect::DiskExtractor(depthSize,depthCorrection,camera->getIntrinsicParameters());
+		diskExtractor->setMaxBlobMergeDist(configFileSection.retrieveValue<int>("./maxBlobMergeDist",2));
+		diskExtractor->setMinNumPixels(configFileSection.retrieveValue<unsigned int>("./minNumPixels",250));
+		diskExtractor->setDiskRadius(daemon->markerRadius);
+		diskExtractor->setDiskRadiusMargin(configFileSection.retrieveValue<double>("./diskRadiusMargin",1.1));
+		diskExtractor->setDiskFlatness(configFileSection.retrieveValue<double>("./diskFlatness",1.0));
+		}
+	else
+		{
+		/* Create a sphere extractor: */
+		sphereExtractor=new SphereExtractor(*camera,depthCorrection);
+		sphereExtractor->setMaxBlobMergeDist(configFileSection.retrieveValue<int>("./maxBlobMergeDist",1));
+		sphereExtractor->setSphereRadius(daemon->markerRadius);
+		unsigned int minWhite=configFileSection.retrieveValue<unsigned int>("./minWhite",128);
+		unsigned int maxSpread=configFileSection.retrieveValue<unsigned int>("./maxSpread",32);
+		size_t minBlobSize=configFileSection.retrieveValue<unsigned int>("./minNumPixels",1000);
+		double radiusTolerance=configFileSection.retrieveValue<double>("./radiusTolerance",0.2);
+		double maxResidual=configFileSection.retrieveValue<double>("./maxResidual",0.3);
+		sphereExtractor->setMatchLimits(minWhite,maxSpread,minBlobSize,radiusTolerance,maxResidual);
+		}
+	}
+
+MarkerTrackingDaemon::CameraState::~CameraState(void)
+	{
+	/* Stop streaming: */
+	camera->stopStreaming();
+	
+	/* Destroy the marker extractors, the camera, and the depth correction factors: */
+	if(diskExtractor!=0)
+		diskExtractor->stopStreaming();
+	delete diskExtractor;
+	delete sphereExtractor;
+	delete camera;
+	delete[] depthCorrection;
+	}
+
+void MarkerTrackingDaemon::CameraState::startStreaming(const Kinect::FrameSource::Time& timeBase)
+	{
+	/* Start extracting markers in the background: */
+	if(diskExtractor!=0)
+		diskExtractor->startStreaming(Misc::createFunctionCall(this,&MarkerTrackingDaemon::CameraState::diskExtractionCallback));
+	if(sphereExtractor!=0)
+		sphereExtractor->startStreaming(Misc::createFunctionCall(this,&MarkerTrackingDaemon::CameraState::sphereExtractionCallback));
+	
+	/* Start streaming: */
+	camera->setTimeBase(timeBase);
+	camera->startStreaming(Misc::createFunctionCall(this,&MarkerTrackingDaemon::CameraState::colorStreamingCallback),Misc::createFunctionCall(this,&MarkerTrackingDaemon::CameraState::depthStreamingCallback));
+	}
+
+/***************************************************
+Methods of class MarkerTrackingDaemon::ClientState:
+***************************************************/
+
+MarkerTrackingDaemon::ClientState::ClientState(MarkerTrackingDaemon* sDaemon,Comm::ListeningTCPSocket& listenSocket)
+	:daemon(sDaemon),
+	 pipe(listenSocket),
+	 state(START),
+	 protocolVersion(0),
+	 streaming(false)
+	{
+	/* Send tracker updates immediately instead of coalescing them: */
+	int flag=1;
+	setsockopt(pipe.getFd(),IPPROTO_TCP,TCP_NODELAY,&flag,sizeof(flag));
+	
+	#ifdef VERBOSE
+	/* Assemble the client name: */
+	clientName=pipe.getPeerHostName();
+	clientName.push_back(':');
+	char portId[10];
+	clientName.append(Misc::print(pipe.getPeerPortId(),portId+sizeof(portId)-1));
+	#endif
+	}
+
+/**************************************
+Methods of class MarkerTrackingDaemon:
+**************************************/
+
+void MarkerTrackingDaemon::updateDeviceState(void)
+	{
+	typedef Vrui::VRDeviceState::TrackerState TS;
+	
+	/* Predict all markers' states for the current time plus the prediction interval: */
+	Kinect::FrameSource::Time now;
+	double predictionTime=double(now-timeBase)+predictionInterval;
+	Vrui::VRDeviceState::TimeStamp timeStamp=getTimeStamp(predictionTime);
+	for(unsigned int i=0;i<markerTracker.getNumMarkers();++i)
+		{
+		Kinect::MarkerTracker::MarkerState ms=markerTracker.getMarkerState(i,predictionTime);
+		
+		/* Markers are tracked in position only: */
+		TS ts;
+		ts.positionOrientation=TS::PositionOrientation::translate(TS::PositionOrientation::Vector(ms.position-Kinect::MarkerTracker::Point::origin));
+		ts.linearVelocity=TS::LinearVelocity(ms.velocity);
+		ts.angularVelocity=TS::AngularVelocity::zero;
+		deviceState.setTrackerState(i,ts);
+		deviceState.setTrackerTimeStamp(i,timeStamp);
+		deviceState.setTrackerValid(i,ms.valid);
+		}
+	}
+
+void MarkerTrackingDaemon::sendConnectReply(MarkerTrackingDaemon::ClientState* client)
+	{
+	IO::File& pipe=client->pipe;
+	pipe.write(MessageIdType(CONNECT_REPLY));
+	pipe.write(Misc::UInt32(client->protocolVersion));
+	
+	/* Send the device layout and the virtual input devices: */
+	deviceState.writeLayout(pipe);
+	if(client->protocolVersion>=2U)
+		{
+		pipe.write(Misc::UInt32(virtualDevices.size()));
+		for(std::vector<Vrui::VRDeviceDescriptor*>::iterator vdIt=virtualDevices.begin();vdIt!=virtualDevices.end();++vdIt)
+			(*vdIt)->write(pipe,client->protocolVersion);
+		}
+	
+	/* Markers are not battery-powered: */
+	if(client->protocolVersion>=5U)
+		{
+		Vrui::BatteryState batteryState;
+		for(size_t i=0;i<virtualDevices.size();++i)
+			batteryState.write(pipe);
+		}
+	
+	/* There are no HMD configurations, power features, or haptic features: */
+	if(client->protocolVersion>=4U)
+		pipe.write(Misc::UInt32(0));
+	if(client->protocolVersion>=6U)
+		{
+		pipe.write(Misc::UInt32(0));
+		pipe.write(Misc::UInt32(0));
+		}
+	
+	pipe.flush();
+	}
+
+void MarkerTrackingDaemon::sendDeviceState(MarkerTrackingDaemon::ClientState* client)
+	{
+	client->pipe.write(MessageIdType(PACKET_REPLY));
+	deviceState.write(client->pipe,client->protocolVersion>=3U,client->protocolVersion>=5U);
+	client->pipe.flush();
+	}
+
+void MarkerTrackingDaemon::newDetectionCallback(void)
+	{
+	/* Read the index of the camera that processed a depth frame: */
+	Misc::UInt32 cameraIndex;
+	if(read(detectionPipeFds[0],&cameraIndex,sizeof(cameraIndex))!=sizeof(cameraIndex))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Read error on pipe");
+	
+	if(numStreamingClients>0)
+		{
+		/* Send the updated device state to all streaming clients: */
+		updateDeviceState();
+		for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();)
+			{
+			bool alive=true;
+			if((*csIt)->streaming)
+				{
+				try
+					{
+					sendDeviceState(*csIt);
+					}
+				catch(const std::runtime_error& err)
+					{
+					#ifdef VERBOSE
+					std::cout<<"MarkerTrackingDaemon: Disconnecting client "<<(*csIt)->clientName<<" due to exception "<<err.what()<<std::endl;
+					#endif
+					
+					/* Disconnect the client and remove it from the list: */
+					disconnectClient(*csIt,true,false);
+					*csIt=clients.back();
+					clients.pop_back();
+					alive=false;
+					}
+				}
+			if(alive)
+				++csIt;
+			}
+		}
+	}
+
+void MarkerTrackingDaemon::newConnectionCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	MarkerTrackingDaemon* thisPtr=static_cast<MarkerTrackingDaemon*>(event.getUserData());
+	
+	/* Create a new client state object and add it to the list: */
+	ClientState* newClient=new ClientState(thisPtr,thisPtr->listeningSocket);
+	
+	#ifdef VERBOSE
+	std::cout<<"MarkerTrackingDaemon: Connecting new client "<<newClient->clientName<<std::endl;
+	#endif
+	
+	thisPtr->clients.push_back(newClient);
+	
+	/* Add an event listener for incoming messages from the client: */
+	newClient->listenerKey=thisPtr->dispatcher.addIOEventListener(newClient->pipe.getFd(),Threads::EventDispatcher::Read,thisPtr->clientMessageCallback,newClient);
+	}
+
+void MarkerTrackingDaemon::disconnectClient(MarkerTrackingDaemon::ClientState* client,bool removeListener,bool removeFromList)
+	{
+	if(removeListener)
+		{
+		/* Stop listening on the client's pipe: */
+		dispatcher.removeIOEventListener(client->listenerKey);
+		}
+	
+	/* Check if the client is still streaming: */
+	if(client->streaming)
+		--numStreamingClients;
+	
+	/* Disconnect the client: */
+	delete client;
+	
+	if(removeFromList)
+		{
+		/* Remove the dead client from the list: */
+		for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+			if(*csIt==client)
+				{
+				/* Remove it and stop searching: */
+				*csIt=clients.back();
+				clients.pop_back();
+				break;
+				}
+		}
+	}
+
+void MarkerTrackingDaemon::clientMessageCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	ClientState* client=static_cast<ClientState*>(event.getUserData());
+	MarkerTrackingDaemon* thisPtr=client->daemon;
+	
+	try
+		{
+		/* Read some data from the socket into the socket's read buffer and check if client hung up: */
+		if(client->pipe.readSomeData()==0)
+			throw std::runtime_error("Client terminated connection");
+		
+		/* Process messages as long as there is data in the read buffer: */
+		while(client->pipe.canReadImmediately())
+			{
+			MessageIdType message=client->pipe.read<MessageIdType>();
+			
+			if(message==DISCONNECT_REQUEST)
+				{
+				/* Cleanly disconnect this client: */
+				#ifdef VERBOSE
+				std::cout<<"MarkerTrackingDaemon: Disconnecting client "<<client->clientName<<std::endl;
+				#endif
+				thisPtr->disconnectClient(client,false,true);
+				
+				/* Stop listening: */
+				event.removeListener();
+				
+				/* Stop processing messages: */
+				return;
+				}
+			
+			switch(client->state)
+				{
+				case START:
+					if(message==CONNECT_REQUEST)
+						{
+						/* Negotiate the protocol version: */
+						unsigned int clientProtocolVersion=client->pipe.read<Misc::UInt32>();
+						if(clientProtocolVersion<1U)
+							throw std::runtime_error("Unsupported client protocol version");
+						client->protocolVersion=clientProtocolVersion;
+						if(client->protocolVersion>maxProtocolVersion)
+							client->protocolVersion=maxProtocolVersion;
+						
+						/* Send the device layout: */
+						thisPtr->sendConnectReply(client);
+						client->state=CONNECTED;
+						}
+					else
+						throw std::runtime_error("Protocol error in START state");
+					
+					break;
+				
+				case CONNECTED:
+					if(message==ACTIVATE_REQUEST)
+						client->state=ACTIVE;
+					else
+						throw std::runtime_error("Protocol error in CONNECTED state");
+					
+					break;
+				
+				case ACTIVE:
+					if(message==PACKET_REQUEST)
+						{
+						/* Send the current device state: */
+						thisPtr->updateDeviceState();
+						thisPtr->sendDeviceState(client);
+						}
+					else if(message==STARTSTREAM_REQUEST)
+						{
+						if(!client->streaming)
+							{
+							/* Enter streaming mode and send the current device state: */
+							client->streaming=true;
+							++thisPtr->numStreamingClients;
+							thisPtr->updateDeviceState();
+							thisPtr->sendDeviceState(client);
+							#ifdef VERBOSE
+							std::cout<<"MarkerTrackingDaemon: Client "<<client->clientName<<" entered streaming mode"<<std::endl;
+							#endif
+							}
+						}
+					else if(message==STOPSTREAM_REQUEST)
+						{
+						if(client->streaming)
+							{
+							/* Leave streaming mode: */
+							client->streaming=false;
+							--thisPtr->numStreamingClients;
+							client->pipe.write(MessageIdType(STOPSTREAM_REPLY));
+							client->pipe.flush();
+							}
+						}
+					else if(message==DEACTIVATE_REQUEST)
+						{
+						/* Leave streaming mode and go back to connected state: */
+						if(client->streaming)
+							{
+							client->streaming=false;
+							--thisPtr->numStreamingClients;
+							}
+						client->state=CONNECTED;
+						}
+					else if(message==POWEROFF_REQUEST)
+						{
+						/* Ignore the request; there are no power features: */
+						client->pipe.skip<Misc::UInt16>(1);
+						}
+					else if(message==HAPTICTICK_REQUEST)
+						{
+						/* Ignore the request; there are no haptic features: */
+						client->pipe.skip<Misc::UInt16>(2);
+						}
+					else
+						throw std::runtime_error("Protocol error in ACTIVE state");
+					
+					break;
+				}
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		#ifdef VERBOSE
+		std::cout<<"MarkerTrackingDaemon: Disconnecting client "<<client->clientName<<" due to exception "<<err.what()<<std::endl;
+		#endif
+		thisPtr->disconnectClient(client,false,true);
+		
+		/* Stop listening: */
+		event.removeListener();
+		}
+	}
+
+MarkerTrackingDaemon::MarkerTrackingDaemon(Misc::ConfigurationFileSection& configFileSection,bool synthetic)
+	:markerRadius(0.0),syntheticCamera(0),
+	 markerTracker(configFileSection.retrieveValue<std::vector<std::string> >("./markerNames",std::vector<std::string>(1,"Marker0")).size()),
+	 predictionInterval(configFileSection.retrieveValue<double>("./predictionInterval",0.0)),
+	 listeningSocket(configFileSection.retrieveValue<int>("./listenPortId",8556),5),
+	 numStreamingClients(0)
+	{
+	/* Initialize the time base and its equivalent VR device state time stamp: */
+	timeBaseStamp=Misc::UInt32(Misc::UInt64(timeBase.tv_sec)*1000000U+Misc::UInt64((timeBase.tv_nsec+500)/1000));
+	
+	/* Create a pipe to signal arrival of new marker detections to the run loop: */
+	if(pipe(detectionPipeFds)<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to open detection notification pipe");
+	
+	/* Read the list of tracked markers and configure the marker tracker: */
+	std::vector<std::string> markerNames=configFileSection.retrieveValue<std::vector<std::string> >("./markerNames",std::vector<std::string>(1,"Marker0"));
+	if(markerNames.empty())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"No markers defined");
+	double filterGain=configFileSection.retrieveValue<double>("./filterGain",0.6);
+	if(configFileSection.hasTag("./filterVelocityGain"))
+		markerTracker.setFilterGains(filterGain,configFileSection.retrieveValue<double>("./filterVelocityGain"));
+	else
+		markerTracker.setFilterGain(filterGain);
+	markerTracker.setGateRadius(configFileSection.retrieveValue<double>("./gateRadius",10.0));
+	markerTracker.setLostTimeout(configFileSection.retrieveValue<double>("./lostTimeout",0.25));
+	markerTracker.setMaxPredictionInterval(configFileSection.retrieveValue<double>("./maxPredictionInterval",0.1));
+	
+	/* Create the device layout and one position-tracked virtual input device per marker: */
+	deviceState.setLayout(markerNames.size(),0,0);
+	for(unsigned int i=0;i<markerNames.size();++i)
+		{
+		Vrui::VRDeviceDescriptor* vd=new Vrui::VRDeviceDescriptor;
+		vd->name=markerNames[i];
+		vd->trackType=Vrui::VRDeviceDescriptor::TRACK_POS;
+		vd->trackerIndex=i;
+		virtualDevices.push_back(vd);
+		deviceState.setTrackerValid(i,false);
+		}
+	
+	/* Select the marker type: */
+	std::string markerTypeName=configFileSection.retrieveString("./markerType","Disk");
+	MarkerType markerType;
+	if(markerTypeName=="Disk")
+		markerType=DISKS;
+	else if(markerTypeName=="Sphere")
+		markerType=SPHERES;
+	else
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unknown marker type %s",markerTypeName.c_str());
+	if(synthetic)
+		markerType=SPHERES;
+	markerRadius=configFileSection.retrieveValue<double>("./markerRadius",markerType==DISKS?6.0:4.0*2.54);
+	
+	if(synthetic)
+		{
+		/* Create a synthetic camera looking at a white sphere moving in front of a gray wall: */
+		Kinect::Size depthSize(640,480);
+		syntheticCamera=new Kinect::SyntheticFrameSource(depthSize,depthSize,Kinect::SyntheticFrameSource::createIntrinsicParameters(depthSize,45.0,50.0,500.0),Kinect::FrameSource::ExtrinsicParameters::identity);
+		Kinect::FrameSource::ColorPixel wallColor;
+		Kinect::FrameSource::ColorPixel markerColor;
+		for(int i=0;i<3;++i)
+			{
+			wallColor[i]=96;
+			markerColor[i]=255;
+			}
+		syntheticCamera->addPlane(Kinect::SyntheticFrameSource::Point(0.0,0.0,-300.0),Kinect::SyntheticFrameSource::Vector(0.0,0.0,1.0),wallColor);
+		unsigned int sphereIndex=syntheticCamera->addSphere(Kinect::SyntheticFrameSource::Point(0.0,0.0,-150.0),markerRadius,markerColor);
+		syntheticCamera->setMotion(sphereIndex,Kinect::SyntheticFrameSource::Vector::zero,Kinect::SyntheticFrameSource::Vector(30.0,15.0,0.0),0.5);
+		syntheticCamera->setDepthNoise(0.1,0.0);
+		
+		#ifdef VERBOSE
+		std::cout<<"MarkerTrackingDaemon: Tracking a sphere marker with a synthetic camera"<<std::endl;
+		#endif
+		cameraStates.push_back(new CameraState(this,syntheticCamera,SPHERES,configFileSection));
+		}
+	else
+		{
+		/* Read the list of cameras: */
+		std::vector<std::string> cameraNames=configFileSection.retrieveValue<std::vector<std::string> >("./cameras",std::vector<std::string>());
+		for(std::vector<std::string>::iterator cnIt=cameraNames.begin();cnIt!=cameraNames.end();++cnIt)
+			{
+			/* Read the camera's serial number: */
+			Misc::ConfigurationFileSection cameraSection=configFileSection.getSection(cnIt->c_str());
+			std::string serialNumber=cameraSection.retrieveString("./serialNumber");
+			
+			try
+				{
+				/* Open the camera: */
+				#ifdef VERBOSE
+				std::cout<<"MarkerTrackingDaemon: Opening camera with serial number "<<serialNumber<<std::endl;
+				#endif
+				Kinect::DirectFrameSource* camera=Kinect::openDirectFrameSource(serialNumber.c_str(),false);
+				
+				/* Remove the background to isolate markers: */
+				if(cameraSection.retrieveValue<bool>("./removeBackground",true))
+					{
+					/* Check whether to load a previously saved background file: */
+					std::string backgroundFile=cameraSection.retrieveValue<std::string>("./backgroundFile",std::string());
+					if(!backgroundFile.empty())
+						{
+						std::string fullBackgroundFileName=KINECT_INTERNAL_CONFIG_CONFIGDIR;
+						fullBackgroundFileName.push_back('/');
+						fullBackgroundFileName.append(backgroundFile);
+						camera->loadBackground(fullBackgroundFileName.c_str());
+						}
+					
+					/* Check whether to capture background: */
+					unsigned int captureBackgroundFrames=cameraSection.retrieveValue<unsigned int>("./captureBackgroundFrames",0);
+					if(captureBackgroundFrames>0)
+						camera->captureBackground(captureBackgroundFrames,false);
+					
+					/* Check whether to set a maximum depth value: */
+					unsigned int maxDepth=cameraSection.retrieveValue<unsigned int>("./maxDepth",0);
+					if(maxDepth>0)
+						camera->setMaxDepth(maxDepth,false);
+					
+					camera->setBackgroundRemovalFuzz(cameraSection.retrieveValue<int>("./backgroundFuzz",camera->getBackgroundRemovalFuzz()));
+					camera->setRemoveBackground(true);
+					}
+				
+				cameraStates.push_back(new CameraState(this,camera,markerType,configFileSection));
+				}
+			catch(const std::runtime_error& err)
+				{
+				std::cerr<<"MarkerTrackingDaemon: Could not open camera with serial number "<<serialNumber<<" due to exception "<<err.what()<<std::endl;
+				}
+			}
+		}
+	for(unsigned int i=0;i<cameraStates.size();++i)
+		cameraStates[i]->cameraIndex=i;
+	#ifdef VERBOSE
+	std::cout<<"MarkerTrackingDaemon: "<<cameraStates.size()<<" cameras initialized"<<std::endl;
+	#endif
+	
+	/* Add an event listener for marker detection messages: */
+	dispatcher.addIOEventListener(detectionPipeFds[0],Threads::EventDispatcher::Read,newDetectionCallbackWrapper,this);
+	
+	/* Add an event listener for incoming connections on the listening socket: */
+	#ifdef VERBOSE
+	std::cout<<"MarkerTrackingDaemon: Listening for incoming connections on TCP port "<<listeningSocket.getPortId()<<std::endl;
+	#endif
+	dispatcher.addIOEventListener(listeningSocket.getFd(),Threads::EventDispatcher::Read,newConnectionCallback,this);
+	}
+
+MarkerTrackingDaemon::~MarkerTrackingDaemon(void)
+	{
+	/* Forcefully disconnect all clients: */
+	for(ClientStateList::iterator csIt=clients.begin();csIt!=clients.end();++csIt)
+		delete *csIt;
+	
+	/* Delete all camera states: */
+	for(std::vector<CameraState*>::iterator csIt=cameraStates.begin();csIt!=cameraStates.end();++csIt)
+		delete *csIt;
+	
+	/* Delete all virtual input devices: */
+	for(std::vector<Vrui::VRDeviceDescriptor*>::iterator vdIt=virtualDevices.begin();vdIt!=virtualDevices.end();++vdIt)
+		delete *vdIt;
+	
+	/* Close the detection notification pipe: */
+	for(int i=0;i<2;++i)
+		close(detectionPipeFds[i]);
+	}
+
+void MarkerTrackingDaemon::run(void)
+	{
+	/* Start streaming on all cameras: */
+	#ifdef VERBOSE
+	std::cout<<"MarkerTrackingDaemon: Starting streaming on "<<cameraStates.size()<<" cameras"<<std::endl;
+	#endif
+	for(std::vector<CameraState*>::iterator csIt=cameraStates.begin();csIt!=cameraStates.end();++csIt)
+		(*csIt)->startStreaming(timeBase);
+	
+	/* Run the main loop and dispatch events until stopped: */
+	dispatcher.dispatchEvents();
+	}
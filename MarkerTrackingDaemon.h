@@ -0,0 +1,181 @@
+/***********************************************************************
+MarkerTrackingDaemon - Server to track disk or sphere markers with one
+or more calibrated 3D cameras, and to stream predicted marker positions
+to VR applications as tracker states using the VR device daemon
+protocol.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef MARKERTRACKINGDAEMON_INCLUDED
+#define MARKERTRACKINGDAEMON_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/EventDispatcher.h>
+#include <Comm/ListeningTCPSocket.h>
+#include <Comm/TCPPipe.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <Vrui/Internal/VRDeviceProtocol.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/DiskExtractor.h>
+#include <Kinect/MarkerTracker.h>
+
+#include "SphereExtractor.h"
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFileSection;
+}
+namespace Vrui {
+class VRDeviceDescriptor;
+}
+namespace Kinect {
+class SyntheticFrameSource;
+}
+
+class MarkerTrackingDaemon:public Vrui::VRDeviceProtocol
+	{
+	/* Embedded classes: */
+	private:
+	enum MarkerType // Enumerated type for types of tracked markers
+		{
+		DISKS=0,SPHERES
+		};
+	
+	struct CameraState // Structure to hold state related to extracting markers from the depth stream of a 3D camera
+		{
+		/* Elements: */
+		public:
+		MarkerTrackingDaemon* daemon; // Pointer to the daemon owning this camera
+		unsigned int cameraIndex; // Camera index to identify marker detections
+		Kinect::FrameSource* camera; // Camera generating the depth and color streams
+		Kinect::FrameSource::DepthCorrection::PixelCorrection* depthCorrection; // Camera's per-pixel depth correction factors, or null
+		Kinect::FrameSource::ExtrinsicParameters eps; // Camera's extrinsic parameters, transforming detected markers to world space
+		Kinect::DiskExtractor* diskExtractor; // Extractor for disk markers, or null
+		SphereExtractor* sphereExtractor; // Extractor for sphere markers, or null
+		Kinect::MarkerTracker::PointList detections; // List of world-space marker positions extracted from the most recent depth frame
+		
+		/* Private methods: */
+		void colorStreamingCallback(const Kinect::FrameBuffer& frame);
+		void depthStreamingCallback(const Kinect::FrameBuffer& frame);
+		void diskExtractionCallback(const Kinect::DiskExtractor::DiskList& disks);
+		void sphereExtractionCallback(const SphereExtractor::SphereList& spheres);
+		void submitDetections(double timeStamp); // Forwards the current list of detections to the marker tracker and notifies the run loop
+		
+		/* Constructors and destructors: */
+		CameraState(MarkerTrackingDaemon* sDaemon,Kinect::FrameSource* sCamera,MarkerType markerType,const Misc::ConfigurationFileSection& configFileSection); // Creates a marker extraction state for the given camera, which is adopted by the state object, using marker extraction parameters from the given configuration file section
+		~CameraState(void);
+		
+		/* Methods: */
+		void startStreaming(const Kinect::FrameSource::Time& timeBase); // Starts streaming from the camera
+		};
+	
+	enum ClientProtocolState // Enumerated type for states of the VR device daemon protocol state machine
+		{
+		START=0,CONNECTED,ACTIVE
+		};
+	
+	struct ClientState // Class containing state of connected client
+		{
+		/* Elements: */
+		public:
+		MarkerTrackingDaemon* daemon; // Pointer to daemon object handling this client, to simplify event handling
+		Comm::TCPPipe pipe; // Pipe connected to the client
+		#ifdef VERBOSE
+		std::string clientName; // Name of the client, to keep track of connections in verbose mode
+		#endif
+		Threads::EventDispatcher::ListenerKey listenerKey; // Key with which this client is listening for I/O events
+		ClientProtocolState state; // Client's current position in the protocol state machine
+		unsigned int protocolVersion; // Version of the VR device daemon protocol to use with this client
+		bool streaming; // Flag whether client is currently in streaming mode
+		
+		/* Constructors and destructors: */
+		ClientState(MarkerTrackingDaemon* sDaemon,Comm::ListeningTCPSocket& listenSocket); // Accepts next incoming connection on given listening socket
+		};
+	
+	typedef std::vector<ClientState*> ClientStateList; // Type for list of connected clients
+	
+	/* Elements: */
+	static const unsigned int maxProtocolVersion=6U; // Highest VR device daemon protocol version served by the daemon
+	Kinect::FrameSource::Time timeBase; // Time point at which the daemon started; time base for all frame time stamps
+	Misc::UInt32 timeBaseStamp; // Time base point as a VR device state time stamp, i.e., lower-order bits of its monotonic time in microseconds
+	std::vector<CameraState*> cameraStates; // List of camera state objects
+	double markerRadius; // Radius of the tracked disk or sphere markers
+	Kinect::SyntheticFrameSource* syntheticCamera; // Synthetic camera viewing a moving sphere marker in test mode, or null
+	Kinect::MarkerTracker markerTracker; // Tracker fusing marker detections from all cameras
+	double predictionInterval; // Interval by which to predict marker positions ahead of the current time, to compensate for latency in clients
+	Vrui::VRDeviceState deviceState; // Current tracker states of all markers
+	std::vector<Vrui::VRDeviceDescriptor*> virtualDevices; // List of virtual input devices representing the markers
+	int detectionPipeFds[2]; // Pipe to signal arrivals of new marker detections to the run loop
+	Threads::EventDispatcher dispatcher; // Event dispatcher to handle communication with multiple clients in parallel
+	Comm::ListeningTCPSocket listeningSocket; // Socket listening for incoming client connections
+	ClientStateList clients; // List of currently connected clients
+	int numStreamingClients; // Number of clients that are currently streaming
+	
+	/* Private methods: */
+	Vrui::VRDeviceState::TimeStamp getTimeStamp(double time) const // Returns the VR device state time stamp of the given time relative to the time base
+		{
+		return Vrui::VRDeviceState::TimeStamp(timeBaseStamp+Misc::UInt32(Misc::SInt32(time*1.0e6+0.5)));
+		}
+	void updateDeviceState(void); // Updates the device state with marker states predicted for the current time
+	void sendConnectReply(ClientState* client); // Sends a connect reply with the device layout to the given client
+	void sendDeviceState(ClientState* client); // Sends the current device state to the given client
+	void newDetectionCallback(void); // Callback called when a camera processed a depth frame
+	static void newDetectionCallbackWrapper(Threads::EventDispatcher::IOEvent& event) // Wrapper function for above
+		{
+		static_cast<MarkerTrackingDaemon*>(event.getUserData())->newDetectionCallback();
+		}
+	static void newConnectionCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a connection attempt is made at the listening socket
+	void disconnectClient(ClientState* client,bool removeListener,bool removeFromList); // Disconnects the given client; removes listener and/or client from list if respective flags are true
+	static void clientMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a message from a client arrives
+	
+	/* Constructors and destructors: */
+	public:
+	MarkerTrackingDaemon(Misc::ConfigurationFileSection& configFileSection,bool synthetic =false); // Creates a daemon tracking markers with the configured cameras, or with a synthetic camera viewing a moving sphere if the flag is true
+	~MarkerTrackingDaemon(void);
+	
+	/* Methods: */
+	int getPortId(void) const // Returns the TCP port on which the daemon listens for clients
+		{
+		return listeningSocket.getPortId();
+		}
+	double getMarkerRadius(void) const // Returns the radius of the tracked markers
+		{
+		return markerRadius;
+		}
+	const Kinect::SyntheticFrameSource* getSyntheticCamera(void) const // Returns the synthetic camera in test mode, or null
+		{
+		return syntheticCamera;
+		}
+	double getTime(Vrui::VRDeviceState::TimeStamp timeStamp) const // Returns the time relative to the time base of the given VR device state time stamp; only valid within about half an hour of the time base
+		{
+		return double(Misc::SInt32(Misc::UInt32(timeStamp)-timeBaseStamp))*1.0e-6;
+		}
+	void run(void); // Runs the daemon state machine
+	void stop(void) // Stops the daemon state machine; can be called asynchronously
+		{
+		/* Stop the dispatcher's event handling: */
+		dispatcher.stop();
+		}
+	};
+
+#endif
@@ -0,0 +1,256 @@
+/***********************************************************************
+MarkerTrackingDaemonMain - Main program for the marker tracking daemon.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string>
+#include <iostream>
+#include <Misc/SizedTypes.h>
+#include <Misc/FunctionCalls.h>
+#include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
+#include <Threads/Mutex.h>
+#include <Threads/Thread.h>
+#include <Threads/EventDispatcherThread.h>
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Comm/Pipe.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <Vrui/Internal/VRDeviceDescriptor.h>
+#include <Vrui/Internal/VRDeviceClient.h>
+#include <Kinect/SyntheticFrameSource.h>
+#include <Kinect/Internal/Config.h>
+
+#include "MarkerTrackingDaemon.h"
+
+MarkerTrackingDaemon* trackingDaemon=0;
+
+void termSignalHandler(int)
+	{
+	/* Shut down the daemon: */
+	if(trackingDaemon!=0)
+		trackingDaemon->stop();
+	}
+
+class LoopbackTest // Class to connect a VR device client to the daemon and measure the latency and accuracy of received tracker states
+	{
+	/* Elements: */
+	private:
+	MarkerTrackingDaemon& daemon; // The daemon under test
+	double duration; // Duration of the test in seconds
+	Threads::Mutex statsMutex; // Mutex protecting the test statistics
+	unsigned int numPackets; // Number of received state packets
+	unsigned int numValid; // Number of received valid tracker states
+	double latencySum,latencyMin,latencyMax; // Statistics of the latency between tracker state time stamps and packet reception
+	unsigned int numErrors; // Number of tracker states compared against ground truth
+	double errorSum2; // Sum of squared position errors against ground truth
+	Threads::Thread testThread; // Thread running the test client
+	bool passed; // Flag whether the test passed
+	
+	/* Private methods: */
+	void packetCallback(Vrui::VRDeviceClient* client) // Called when the client receives a state packet
+		{
+		/* Get the current time as a VR device state time stamp: */
+		Realtime::TimePointMonotonic now;
+		Vrui::VRDeviceState::TimeStamp nowStamp=Vrui::VRDeviceState::TimeStamp(now.tv_sec*1000000+(now.tv_nsec+500)/1000);
+		
+		client->lockState();
+		const Vrui::VRDeviceState& state=client->getState();
+		Threads::Mutex::Lock statsLock(statsMutex);
+		++numPackets;
+		if(state.getNumTrackers()>0&&state.getTrackerValid(0))
+			{
+			++numValid;
+			
+			/* Update the latency statistics: */
+			Vrui::VRDeviceState::TimeStamp trackerStamp=state.getTrackerTimeStamp(0);
+			double latency=double(nowStamp-trackerStamp)*1.0e-3;
+			latencySum+=latency;
+			if(latencyMin>latency)
+				latencyMin=latency;
+			if(latencyMax<latency)
+				latencyMax=latency;
+			
+			/* Compare the tracker position against the synthetic sphere's position at the tracker state's time stamp: */
+			const Kinect::SyntheticFrameSource* camera=daemon.getSyntheticCamera();
+			if(camera!=0)
+				{
+				const std::vector<Kinect::SyntheticFrameSource::Body>& bodies=camera->getBodies();
+				for(std::vector<Kinect::SyntheticFrameSource::Body>::const_iterator bIt=bodies.begin();bIt!=bodies.end();++bIt)
+					if(bIt->type==Kinect::SyntheticFrameSource::SPHERE)
+						{
+						Kinect::SyntheticFrameSource::Point center=bIt->getCenter(daemon.getTime(trackerStamp));
+						Geometry::Vector<double,3> error=Geometry::Vector<double,3>(state.getTrackerState(0).positionOrientation.getTranslation())-(center-Kinect::SyntheticFrameSource::Point::origin);
+						errorSum2+=error.sqr();
+						++numErrors;
+						break;
+						}
+				}
+			}
+		client->unlockState();
+		}
+	void* testThreadMethod(void) // Runs the test client
+		{
+		try
+			{
+			/* Connect to the daemon: */
+			Threads::EventDispatcherThread dispatcher;
+			Vrui::VRDeviceClient client(dispatcher,"localhost",daemon.getPortId());
+			std::cout<<"LoopbackTest: Connected to daemon; "<<client.getNumVirtualDevices()<<" virtual devices:";
+			for(int i=0;i<client.getNumVirtualDevices();++i)
+				std::cout<<' '<<client.getVirtualDevice(i).name;
+			std::cout<<std::endl;
+			
+			/* Stream tracker states for the requested duration: */
+			client.activate();
+			client.startStream(Misc::createFunctionCall(this,&LoopbackTest::packetCallback));
+			Realtime::TimePointMonotonic::sleep(Realtime::TimePointMonotonic()+Realtime::TimeVector(duration));
+			client.stopStream();
+			client.deactivate();
+			
+			/* Print the test results: */
+			Threads::Mutex::Lock statsLock(statsMutex);
+			std::cout<<"LoopbackTest: Received "<<numPackets<<" packets, "<<numValid<<" with valid tracker states"<<std::endl;
+			passed=numValid>0;
+			if(numValid>0)
+				std::cout<<"LoopbackTest: Latency min "<<latencyMin<<" ms, mean "<<latencySum/double(numValid)<<" ms, max "<<latencyMax<<" ms"<<std::endl;
+			if(daemon.getSyntheticCamera()!=0)
+				{
+				if(numErrors>0)
+					{
+					double rmsError=Math::sqrt(errorSum2/double(numErrors));
+					std::cout<<"LoopbackTest: RMS position error against ground truth "<<rmsError<<std::endl;
+					passed=passed&&rmsError<daemon.getMarkerRadius();
+					}
+				else
+					passed=false;
+				}
+			}
+		catch(const std::runtime_error& err)
+			{
+			std::cerr<<"LoopbackTest: Test failed due to exception "<<err.what()<<std::endl;
+			passed=false;
+			}
+		
+		/* Shut down the daemon: */
+		daemon.stop();
+		
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	LoopbackTest(MarkerTrackingDaemon& sDaemon,double sDuration) // Starts a loopback test of the given duration against the given daemon
+		:daemon(sDaemon),duration(sDuration),
+		 numPackets(0),numValid(0),
+		 latencySum(0.0),latencyMin(Math::Constants<double>::max),latencyMax(0.0),
+		 numErrors(0),errorSum2(0.0),
+		 passed(false)
+		{
+		/* Start the test client thread: */
+		testThread.start(this,&LoopbackTest::testThreadMethod);
+		}
+	
+	/* Methods: */
+	bool waitForResult(void) // Waits for the test to finish and returns true if it passed
+		{
+		testThread.join();
+		return passed;
+		}
+	};
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	bool synthetic=false;
+	double loopbackTestDuration=0.0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"synthetic")==0)
+				synthetic=true;
+			else if(strcasecmp(argv[i]+1,"loopbackTest")==0)
+				{
+				++i;
+				if(i<argc)
+					loopbackTestDuration=atof(argv[i]);
+				else
+					std::cerr<<"MarkerTrackingDaemon: Ignoring dangling -loopbackTest option"<<std::endl;
+				}
+			else
+				std::cerr<<"MarkerTrackingDaemon: Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"MarkerTrackingDaemon: Ignoring command line argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Ignore SIGPIPE and leave handling of pipe errors to TCP sockets: */
+	Comm::ignorePipeSignals();
+	
+	/* Reroute SIG_INT signals to cleanly shut down the daemon: */
+	struct sigaction sigIntAction;
+	memset(&sigIntAction,0,sizeof(struct sigaction));
+	sigIntAction.sa_handler=termSignalHandler;
+	if(sigaction(SIGINT,&sigIntAction,0)!=0)
+		std::cerr<<"MarkerTrackingDaemon: Cannot intercept SIG_INT signals. Daemon won't shut down cleanly."<<std::endl;
+	
+	bool passed=true;
+	try
+		{
+		/* Open the daemon's configuration file: */
+		std::string daemonConfigName=KINECT_INTERNAL_CONFIG_CONFIGDIR;
+		daemonConfigName.push_back('/');
+		daemonConfigName.append(KINECT_INTERNAL_CONFIG_MARKERTRACKINGDAEMON_CONFIGURATIONFILENAME);
+		Misc::ConfigurationFile daemonConfig(daemonConfigName.c_str());
+		
+		/* Create a marker tracking daemon object: */
+		Misc::ConfigurationFileSection daemonSection=daemonConfig.getSection("MarkerTrackingDaemon");
+		trackingDaemon=new MarkerTrackingDaemon(daemonSection,synthetic);
+		
+		if(loopbackTestDuration>0.0)
+			{
+			/* Run the daemon's main loop while a test client streams tracker states from it: */
+			LoopbackTest test(*trackingDaemon,loopbackTestDuration);
+			trackingDaemon->run();
+			passed=test.waitForResult();
+			std::cout<<"LoopbackTest: "<<(passed?"Passed":"Failed")<<std::endl;
+			}
+		else
+			{
+			/* Run the daemon's main loop: */
+			trackingDaemon->run();
+			}
+		
+		/* Shut down the daemon: */
+		delete trackingDaemon;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"MarkerTrackingDaemon: Daemon terminated due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return passed?0:1;
+	}
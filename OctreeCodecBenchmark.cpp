@@ -0,0 +1,336 @@
+/***********************************************************************
+OctreeCodecBenchmark - Utility to fuse one or more recorded 3D video
+streams into a single world-space point cloud per meta-frame, compress
+the point clouds with the octree point cloud codec, and compare the
+result against the recorded per-camera depth streams.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/PointCloud.h>
+#include <Kinect/PointCloudFuser.h>
+#include <Kinect/OctreePointCloudWriter.h>
+#include <Kinect/OctreePointCloudReader.h>
+
+struct Stream // Structure holding the state of one recorded 3D video stream
+	{
+	/* Elements: */
+	public:
+	IO::FilePtr depthFile; // The stream's depth file
+	Kinect::FrameReader* depthReader; // Reader for the stream's depth frames
+	Kinect::FrameBuffer nextFrame; // The stream's next unprocessed depth frame
+	IO::FilePtr colorFile; // The stream's color file if colors are requested
+	Kinect::FrameReader* colorReader; // Reader for the stream's color frames if colors are requested
+	Kinect::FrameBuffer colorFrame; // The stream's most recent color frame
+	Kinect::FrameBuffer nextColorFrame; // The stream's next unprocessed color frame
+	};
+
+struct Compressor // Structure holding the octree codec under test and its statistics
+	{
+	/* Elements: */
+	public:
+	std::string fileName; // Name of the file receiving the compressed point cloud stream
+	bool keepFile; // Flag whether to keep the file after the benchmark
+	IO::FilePtr file; // File receiving the compressed point cloud stream
+	Kinect::OctreePointCloudWriter* writer; // Point cloud writer
+	Kinect::OctreePointCloudReader* reader; // Point cloud reader
+	bool colors; // Flag whether point clouds are compressed with colors
+	unsigned int numFrames; // Number of compressed meta-frames
+	size_t numPoints; // Total number of fused input points
+	size_t numVoxels; // Total number of occupied voxels
+	size_t compressedSize; // Total size of compressed meta-frames in bytes
+	double encodeTime,decodeTime; // Total encoding and decoding times in seconds
+	unsigned int minNumLevels,maxNumLevels; // Range of octree depths selected by rate control
+	unsigned int numMismatches; // Number of meta-frames that did not survive the round trip
+	Kinect::PointCloud decodedCloud; // Most recently decoded point cloud
+	
+	/* Constructors and destructors: */
+	Compressor(const char* sFileName,bool sKeepFile,const Kinect::PointCloud::Point& cubeOrigin,float cubeSize,unsigned int numLevels,bool sColors,unsigned int numThreads,size_t maxFrameSize,unsigned int minFrameLevels)
+		:fileName(sFileName),keepFile(sKeepFile),
+		 file(IO::openFile(sFileName,IO::File::ReadWrite)),
+		 writer(0),reader(0),colors(sColors),
+		 numFrames(0),numPoints(0),numVoxels(0),compressedSize(0),encodeTime(0.0),decodeTime(0.0),
+		 minNumLevels(numLevels),maxNumLevels(0),numMismatches(0)
+		{
+		file->setEndianness(Misc::LittleEndian);
+		writer=new Kinect::OctreePointCloudWriter(*file,cubeOrigin,cubeSize,numLevels,colors,numThreads);
+		if(maxFrameSize>0)
+			writer->setMaxFrameSize(maxFrameSize,minFrameLevels);
+		file->flush();
+		reader=new Kinect::OctreePointCloudReader(*file);
+		}
+	~Compressor(void)
+		{
+		delete reader;
+		delete writer;
+		file=0;
+		if(!keepFile)
+			unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	void testFrame(const Kinect::PointCloud& cloud) // Compresses and decompresses the given meta-frame
+		{
+		unsigned int frameLevels=writer->getNumLevels();
+		if(minNumLevels>frameLevels)
+			minNumLevels=frameLevels;
+		if(maxNumLevels<frameLevels)
+			maxNumLevels=frameLevels;
+		
+		/* Compress the meta-frame: */
+		Misc::Timer encodeTimer;
+		compressedSize+=writer->writeFrame(cloud);
+		encodeTimer.elapse();
+		encodeTime+=encodeTimer.getTime();
+		file->flush();
+		
+		/* Decompress the meta-frame: */
+		Misc::Timer decodeTimer;
+		reader->readNextFrame(decodedCloud);
+		decodeTimer.elapse();
+		decodeTime+=decodeTimer.getTime();
+		
+		/* Check that the round trip preserved all occupied voxels: */
+		if(decodedCloud.timeStamp!=cloud.timeStamp||decodedCloud.points.size()!=writer->getNumVoxels()||decodedCloud.colors.size()!=(colors?decodedCloud.points.size():0))
+			++numMismatches;
+		
+		++numFrames;
+		numPoints+=cloud.points.size();
+		numVoxels+=writer->getNumVoxels();
+		}
+	};
+
+Kinect::FrameReader* openDepthStream(IO::File& depthFile) // Skips the given depth file's header and returns a depth frame reader for it
+	{
+	depthFile.setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(depthFile);
+	return depthFileHeader.createReader(depthFile);
+	}
+
+Kinect::FrameReader* openColorStream(IO::File& colorFile) // Skips the given color file's header and returns a color frame reader for it delivering RGB frames
+	{
+	colorFile.setEndianness(Misc::LittleEndian);
+	Kinect::ColorFileHeader colorFileHeader(colorFile);
+	Kinect::FrameReader* result=colorFileHeader.createReader(colorFile);
+	Kinect::setConvertToRgb(*result,true);
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> streamNames;
+	unsigned int numLevels=10;
+	bool haveCube=false;
+	Kinect::PointCloud::Point cubeOrigin=Kinect::PointCloud::Point::origin;
+	float cubeSize=0.0f;
+	size_t maxFrameSize=0;
+	unsigned int minNumLevels=6;
+	bool colors=false;
+	unsigned int numThreads=2;
+	const char* outputFileName=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"levels")==0&&i+1<argc)
+				numLevels=(unsigned int)(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"cube")==0&&i+4<argc)
+				{
+				haveCube=true;
+				for(int j=0;j<3;++j)
+					cubeOrigin[j]=float(atof(argv[++i]));
+				cubeSize=float(atof(argv[++i]));
+				}
+			else if(strcasecmp(argv[i]+1,"maxFrameSize")==0&&i+1<argc)
+				maxFrameSize=size_t(atoi(argv[++i]))*1024;
+			else if(strcasecmp(argv[i]+1,"minLevels")==0&&i+1<argc)
+				minNumLevels=(unsigned int)(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"color")==0)
+				colors=true;
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"o")==0&&i+1<argc)
+				outputFileName=argv[++i];
+			else
+				std::cerr<<"Ignoring command line option "<<argv[i]<<std::endl;
+			}
+		else
+			streamNames.push_back(argv[i]);
+		}
+	if(streamNames.empty())
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-levels <max octree depth>] [-cube <x> <y> <z> <size>] [-maxFrameSize <KB>] [-minLevels <min octree depth>] [-color] [-threads <num threads>] [-o <output file name>] <stream file name base> [<stream file name base> ...]"<<std::endl;
+		return 1;
+		}
+	
+	/* Open all streams and add their cameras to the point cloud fuser: */
+	Kinect::PointCloudFuser fuser;
+	std::vector<Stream> streams;
+	size_t totalDepthFileSize=0;
+	for(std::vector<std::string>::iterator snIt=streamNames.begin();snIt!=streamNames.end();++snIt)
+		{
+		std::string colorFileName=*snIt;
+		colorFileName.append(".color");
+		std::string depthFileName=*snIt;
+		depthFileName.append(".depth");
+		
+		Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+		fuser.addCamera(source);
+		
+		Stream s;
+		s.depthFile=IO::openFile(depthFileName.c_str());
+		s.depthReader=openDepthStream(*s.depthFile);
+		s.nextFrame=s.depthReader->readNextFrame();
+		s.colorReader=0;
+		if(colors)
+			{
+			s.colorFile=IO::openFile(colorFileName.c_str());
+			s.colorReader=openColorStream(*s.colorFile);
+			s.colorFrame=s.colorReader->readNextFrame();
+			s.nextColorFrame=s.colorReader->readNextFrame();
+			}
+		struct stat depthFileStats;
+		if(stat(depthFileName.c_str(),&depthFileStats)==0)
+			totalDepthFileSize+=size_t(depthFileStats.st_size);
+		streams.push_back(s);
+		}
+	
+	/* Fuse depth frames in time stamp order into meta-frames containing at most one frame from each stream: */
+	Compressor* compressor=0;
+	Kinect::PointCloud cloud;
+	std::vector<bool> contributed(streams.size(),false);
+	bool cloudEmpty=true;
+	while(true)
+		{
+		/* Find the stream with the earliest next depth frame: */
+		unsigned int streamIndex=streams.size();
+		for(unsigned int i=0;i<streams.size();++i)
+			if(streams[i].nextFrame.timeStamp!=Math::Constants<double>::max&&(streamIndex==streams.size()||streams[streamIndex].nextFrame.timeStamp>streams[i].nextFrame.timeStamp))
+				streamIndex=i;
+		
+		/* Finish the current meta-frame if the stream already contributed to it, or if all streams are over: */
+		if(!cloudEmpty&&(streamIndex==streams.size()||contributed[streamIndex]))
+			{
+			if(compressor==0&&!cloud.points.empty())
+				{
+				if(!haveCube)
+					{
+					/* Enclose the first meta-frame's points in a cube with a 10% margin: */
+					Kinect::PointCloud::Point min=cloud.points.front();
+					Kinect::PointCloud::Point max=min;
+					for(std::vector<Kinect::PointCloud::Point>::iterator pIt=cloud.points.begin();pIt!=cloud.points.end();++pIt)
+						for(int i=0;i<3;++i)
+							{
+							if(min[i]>(*pIt)[i])
+								min[i]=(*pIt)[i];
+							if(max[i]<(*pIt)[i])
+								max[i]=(*pIt)[i];
+							}
+					for(int i=0;i<3;++i)
+						if(cubeSize<max[i]-min[i])
+							cubeSize=max[i]-min[i];
+					cubeSize*=1.1f;
+					for(int i=0;i<3;++i)
+						cubeOrigin[i]=(min[i]+max[i]-cubeSize)*0.5f;
+					}
+				
+				/* Create the octree codec: */
+				compressor=new Compressor(outputFileName!=0?outputFileName:"OctreeCodecBenchmark.tmp",outputFileName!=0,cubeOrigin,cubeSize,numLevels,colors,numThreads,maxFrameSize,minNumLevels);
+				}
+			if(compressor!=0)
+				compressor->testFrame(cloud);
+			
+			cloud.clear();
+			contributed.assign(streams.size(),false);
+			cloudEmpty=true;
+			}
+		if(streamIndex==streams.size())
+			break;
+		Stream& s=streams[streamIndex];
+		
+		/* Add the depth frame to the meta-frame: */
+		if(cloudEmpty)
+			cloud.timeStamp=s.nextFrame.timeStamp;
+		if(colors)
+			{
+			/* Find the most recent color frame: */
+			while(s.nextColorFrame.timeStamp<=s.nextFrame.timeStamp)
+				{
+				s.colorFrame=s.nextColorFrame;
+				s.nextColorFrame=s.colorReader->readNextFrame();
+				}
+			fuser.addFrames(streamIndex,s.nextFrame,s.colorFrame,cloud);
+			}
+		else
+			fuser.addDepthFrame(streamIndex,s.nextFrame,cloud);
+		contributed[streamIndex]=true;
+		cloudEmpty=false;
+		
+		/* Read the stream's next depth frame: */
+		s.nextFrame=s.depthReader->readNextFrame();
+		}
+	for(std::vector<Stream>::iterator sIt=streams.begin();sIt!=streams.end();++sIt)
+		{
+		delete sIt->colorReader;
+		delete sIt->depthReader;
+		}
+	if(compressor==0)
+		{
+		std::cerr<<"No valid depth pixels in the given streams"<<std::endl;
+		return 1;
+		}
+	
+	/* Print the results: */
+	double nf=double(compressor->numFrames);
+	std::cout<<compressor->numFrames<<" meta-frames from "<<streams.size()<<" camera(s)"<<std::endl;
+	std::cout<<std::fixed<<std::setprecision(3);
+	std::cout<<"Bounding cube: origin ("<<cubeOrigin[0]<<", "<<cubeOrigin[1]<<", "<<cubeOrigin[2]<<"), size "<<cubeSize<<std::endl;
+	std::cout<<"Octree depth: "<<compressor->minNumLevels<<" to "<<compressor->maxNumLevels<<" levels, finest voxel size "<<cubeSize/float(Misc::UInt64(1)<<compressor->maxNumLevels)<<std::endl;
+	std::cout<<std::setprecision(2);
+	std::cout<<"Points: "<<double(compressor->numPoints)/nf<<" per meta-frame fused into "<<double(compressor->numVoxels)/nf<<" voxels"<<std::endl;
+	std::cout<<"Octree stream: "<<double(compressor->compressedSize)/nf/1024.0<<" KB per meta-frame, "<<(compressor->numVoxels>0?double(compressor->compressedSize)*8.0/double(compressor->numVoxels):0.0)<<" bits per voxel"<<std::endl;
+	std::cout<<"Recorded depth streams: "<<double(totalDepthFileSize)/nf/1024.0<<" KB per meta-frame"<<std::endl;
+	std::cout<<"Encoding: "<<compressor->encodeTime*1000.0/nf<<" ms per meta-frame using "<<numThreads<<" thread(s)"<<std::endl;
+	std::cout<<"Decoding: "<<compressor->decodeTime*1000.0/nf<<" ms per meta-frame"<<std::endl;
+	std::cout<<"Round-trip mismatches: "<<compressor->numMismatches<<std::endl;
+	delete compressor;
+	
+	return 0;
+	}
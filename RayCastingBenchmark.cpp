@@ -0,0 +1,177 @@
+/***********************************************************************
+RayCastingBenchmark - Utility to measure the cost and accuracy of
+ray-casting queries against the facades reconstructed from recorded 3D
+video streams, by casting rays from the camera's center through a grid
+of valid depth pixels and checking that they hit those pixels.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/ProjectorBase.h>
+#include <Kinect/FacadeRayCaster.h>
+
+typedef Kinect::FrameSource::DepthPixel DepthPixel;
+typedef Kinect::FacadeRayCaster::Scalar Scalar;
+typedef Kinect::FacadeRayCaster::Point Point;
+typedef Kinect::FacadeRayCaster::Ray Ray;
+
+int main(int argc,char* argv[])
+	{
+	if(argc<2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <stream file name base> [<pixel stride> [<triangle depth range>]]"<<std::endl;
+		return 1;
+		}
+	std::string colorFileName=argv[1];
+	colorFileName.append(".color");
+	std::string depthFileName=argv[1];
+	depthFileName.append(".depth");
+	unsigned int stride=argc>=3?(unsigned int)(atoi(argv[2])):4U;
+	if(stride<1)
+		stride=1;
+	int triangleDepthRange=argc>=4?atoi(argv[3]):-1;
+	
+	/* Create a ray caster and a projector for the recording's depth camera: */
+	Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+	Kinect::FacadeRayCaster rayCaster;
+	rayCaster.addCamera(source);
+	Kinect::ProjectorBase projector(source);
+	if(triangleDepthRange>=0)
+		{
+		rayCaster.setTriangleDepthRange(0,DepthPixel(triangleDepthRange));
+		projector.setTriangleDepthRange(DepthPixel(triangleDepthRange));
+		}
+	
+	/* Open the depth stream and skip its file header: */
+	IO::FilePtr depthFile=IO::openFile(depthFileName.c_str());
+	depthFile->setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
+	Kinect::FrameReader* depthReader=depthFileHeader.createReader(*depthFile);
+	
+	const Kinect::Size& depthSize=projector.getDepthFrameSize();
+	std::cout<<"Casting rays through every "<<stride<<"th pixel of "<<depthSize[0]<<'x'<<depthSize[1]<<" depth frames with triangle depth range "<<projector.getTriangleDepthRange()<<std::endl;
+	
+	/* Calculate the camera's center in world space: */
+	Point center=projector.getExtrinsicParameters().transform(Point::origin);
+	
+	/* Process all depth frames: */
+	unsigned int numFrames=0;
+	double updateTime=0.0;
+	double castTime=0.0;
+	size_t numRays=0;
+	size_t numHits=0;
+	size_t numPixelHits=0;
+	std::vector<Ray> rays;
+	std::vector<Kinect::FacadeRayCaster::Hit> hits;
+	Kinect::FrameBuffer depthFrame=depthReader->readNextFrame();
+	while(depthFrame.timeStamp!=Math::Constants<double>::max)
+		{
+		/* Update the ray caster's facade: */
+		Misc::Timer updateTimer;
+		rayCaster.setDepthFrame(0,depthFrame);
+		updateTimer.elapse();
+		updateTime+=updateTimer.getTime();
+		
+		/* Create rays from the camera's center through a grid of valid pixels, such that a ray hitting its pixel has parameter 1: */
+		rays.clear();
+		const DepthPixel* dPtr=depthFrame.getData<DepthPixel>();
+		const Kinect::FrameSource::IntrinsicParameters& ips=projector.getIntrinsicParameters();
+		for(unsigned int y=0;y<depthSize[1];y+=stride)
+			for(unsigned int x=0;x<depthSize[0];x+=stride)
+				{
+				unsigned int index=y*depthSize[0]+x;
+				if(dPtr[index]>=Kinect::FrameSource::invalidDepth-1U)
+					continue;
+				
+				/* Unproject the pixel into world space: */
+				Point dip;
+				if(!ips.depthLensDistortion.isIdentity())
+					{
+					Kinect::FrameSource::IntrinsicParameters::Point2 up=ips.undistortDepthPixel(x,y);
+					dip[0]=Scalar(up[0]);
+					dip[1]=Scalar(up[1]);
+					}
+				else
+					{
+					dip[0]=Scalar(x)+Scalar(0.5);
+					dip[1]=Scalar(y)+Scalar(0.5);
+					}
+				const Kinect::FrameSource::DepthCorrection::PixelCorrection* dc=projector.getDepthCorrection();
+				dip[2]=dc!=0?Scalar(dc[index].correct(float(dPtr[index]))):Scalar(dPtr[index]);
+				Point wp=projector.worldDepthProjection.transform(dip);
+				
+				rays.push_back(Ray(center,wp-center));
+				}
+		
+		/* Cast the rays as one batch: */
+		hits.resize(rays.size());
+		Misc::Timer castTimer;
+		if(!rays.empty())
+			rayCaster.castRays(rays.size(),&rays[0],Scalar(2),&hits[0]);
+		castTimer.elapse();
+		castTime+=castTimer.getTime();
+		
+		/* Count the rays that hit anything, and the rays that hit their own pixels: */
+		numRays+=rays.size();
+		for(std::vector<Kinect::FacadeRayCaster::Hit>::iterator hIt=hits.begin();hIt!=hits.end();++hIt)
+			if(hIt->isValid())
+				{
+				++numHits;
+				if(Math::abs(hIt->lambda-Scalar(1))<=Scalar(0.001))
+					++numPixelHits;
+				}
+		
+		/* Read the next depth frame: */
+		++numFrames;
+		depthFrame=depthReader->readNextFrame();
+		}
+	
+	/* Clean up: */
+	delete depthReader;
+	
+	/* Print the results: */
+	std::cout<<numFrames<<" depth frames"<<std::endl;
+	if(numFrames>0&&numRays>0)
+		{
+		double nf=double(numFrames);
+		double nr=double(numRays);
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Facade update: "<<updateTime*1000.0/nf<<" ms/frame"<<std::endl;
+		std::cout<<"Ray casting: "<<nr/nf<<" rays/frame, "<<castTime*1.0e6/nr<<" us/ray"<<std::endl;
+		std::cout<<"Hits: "<<100.0*double(numHits)/nr<<"% of rays, "<<100.0*double(numPixelHits)/nr<<"% at their own pixels"<<std::endl;
+		}
+	
+	return 0;
+	}
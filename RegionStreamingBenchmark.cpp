@@ -0,0 +1,234 @@
+/***********************************************************************
+RegionStreamingBenchmark - Utility to measure the bandwidth saved by
+view-dependent 3D video streaming, by running a recorded 3D video stream
+through the culling and cropping stages of KinectServer for a client
+viewing everything and a client viewing a world-space box.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/VariableMemoryFile.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameWriter.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/ProjectorBase.h>
+#include <Kinect/DepthTileCuller.h>
+
+struct ClientStats // Structure to accumulate the data sent to one simulated client
+	{
+	/* Elements: */
+	public:
+	size_t colorBytes,depthBytes; // Total size of color and depth stream data sent to the client, including frame identifiers
+	unsigned int numCulledColorFrames,numCulledDepthFrames; // Number of frames replaced by culled frame markers
+	unsigned int numCroppedDepthFrames; // Number of depth frames cropped to the client's view region
+	
+	/* Constructors and destructors: */
+	ClientStats(void)
+		:colorBytes(0),depthBytes(0),
+		 numCulledColorFrames(0),numCulledDepthFrames(0),
+		 numCroppedDepthFrames(0)
+		{
+		}
+	};
+
+int main(int argc,char* argv[])
+	{
+	if(argc<8)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <stream file name base> <min x> <min y> <min z> <max x> <max y> <max z> [<margin>]"<<std::endl;
+		return 1;
+		}
+	std::string colorFileName=argv[1];
+	colorFileName.append(".color");
+	std::string depthFileName=argv[1];
+	depthFileName.append(".depth");
+	Kinect::ProjectorBase::Point min,max;
+	for(int i=0;i<3;++i)
+		{
+		min[i]=atof(argv[2+i]);
+		max[i]=atof(argv[5+i]);
+		}
+	double margin=argc>=9?atof(argv[8]):0.0;
+	Kinect::DepthTileCuller::ViewRegion viewRegion=Kinect::DepthTileCuller::makeBoxRegion(min,max);
+	
+	/* Retrieve the recording's camera parameters: */
+	Kinect::Size depthSize;
+	Kinect::FrameSource::DepthCorrection* depthCorrection;
+	Kinect::FrameSource::IntrinsicParameters ips;
+	Kinect::FrameSource::ExtrinsicParameters eps;
+	{
+	Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+	depthSize=source.getActualFrameSize(Kinect::FrameSource::DEPTH);
+	depthCorrection=source.getDepthCorrectionParameters();
+	ips=source.getIntrinsicParameters();
+	eps=source.getExtrinsicParameters();
+	}
+	
+	/* Create a tile culler for the recording's depth camera: */
+	Kinect::DepthTileCuller culler(depthSize,depthCorrection,ips,eps);
+	delete depthCorrection;
+	
+	/* Open the color stream and skip its file header: */
+	IO::SeekableFilePtr colorFile=IO::openSeekableFile(colorFileName.c_str());
+	colorFile->setEndianness(Misc::LittleEndian);
+	Kinect::ColorFileHeader colorFileHeader(*colorFile);
+	Kinect::FrameReader* colorReader=colorFileHeader.createReader(*colorFile);
+	
+	/* Open the depth stream and skip its file header: */
+	IO::FilePtr depthFile=IO::openFile(depthFileName.c_str());
+	depthFile->setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
+	Kinect::FrameReader* depthReader=depthFileHeader.createReader(*depthFile);
+	
+	/* Select the streaming depth codec like KinectServer; depth frames can only be cropped if they are compressed independently: */
+	Kinect::DepthFrameCodec streamCodec=depthFileHeader.codec!=Kinect::DEPTH_CODEC_THEORA?depthFileHeader.codec:Kinect::DEPTH_CODEC_HUFFMAN;
+	std::cout<<"Streaming "<<depthSize[0]<<'x'<<depthSize[1]<<" depth frames with the "<<Kinect::getDepthFrameCodecName(streamCodec)<<" codec and "<<Kinect::getColorFrameCodecName(colorFileHeader.codec)<<" color frames"<<std::endl;
+	
+	/* Create a depth compressor for full frames, and a depth compressor and decompressor for cropped frames: */
+	IO::VariableMemoryFile fullDepthFile(16384);
+	Kinect::FrameWriter* fullDepthWriter=Kinect::createDepthFrameWriter(streamCodec,fullDepthFile,depthSize);
+	const char* croppedDepthFileName="RegionStreamingBenchmarkCropped.tmp";
+	IO::FilePtr croppedDepthFile=IO::openFile(croppedDepthFileName,IO::File::ReadWrite);
+	croppedDepthFile->setEndianness(Misc::LittleEndian);
+	Kinect::FrameWriter* croppedDepthWriter=Kinect::createDepthFrameWriter(streamCodec,*croppedDepthFile,depthSize);
+	croppedDepthFile->flush();
+	Kinect::FrameReader* croppedDepthReader=Kinect::createDepthFrameReader(streamCodec,*croppedDepthFile);
+	
+	/* Process the color and depth streams in time stamp order: */
+	ClientStats fullClient,regionClient;
+	unsigned int numColorFrames=0,numDepthFrames=0,numMismatches=0;
+	double cullTime=0.0,cropTime=0.0;
+	Kinect::DepthTileCuller::TileMask visibleTiles=~Kinect::DepthTileCuller::TileMask(0);
+	bool colorSynced=true;
+	IO::SeekableFile::Offset colorPos=colorFile->getReadPos();
+	bool colorKeyFrame;
+	double colorTimeStamp=colorReader->skipNextFrame(colorKeyFrame);
+	Kinect::FrameBuffer depthFrame=depthReader->readNextFrame();
+	while(colorTimeStamp!=Math::Constants<double>::max||depthFrame.timeStamp!=Math::Constants<double>::max)
+		{
+		if(depthFrame.timeStamp<=colorTimeStamp)
+			{
+			/* Compress the full depth frame: */
+			size_t fullSize=fullDepthWriter->writeFrame(depthFrame);
+			IO::VariableMemoryFile::BufferChain fullData;
+			fullDepthFile.storeBuffers(fullData);
+			fullClient.depthBytes+=sizeof(Misc::UInt32)*2+fullSize;
+			
+			/* Determine the depth frame's tiles visible from the view region: */
+			Misc::Timer cullTimer;
+			Kinect::DepthTileCuller::TileRange tileRanges[Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles];
+			culler.calcTileRanges(depthFrame,tileRanges);
+			Kinect::DepthTileCuller::TileMask validTiles=Kinect::DepthTileCuller::calcValidTiles(tileRanges);
+			visibleTiles=culler.calcVisibleTiles(tileRanges,viewRegion,margin);
+			cullTimer.elapse();
+			cullTime+=cullTimer.getTime();
+			
+			regionClient.depthBytes+=sizeof(Misc::UInt32)*2;
+			if(visibleTiles==0)
+				++regionClient.numCulledDepthFrames;
+			else if(visibleTiles!=validTiles)
+				{
+				/* Crop and compress the depth frame: */
+				Misc::Timer cropTimer;
+				Kinect::FrameBuffer croppedFrame=culler.maskFrame(depthFrame,visibleTiles);
+				regionClient.depthBytes+=croppedDepthWriter->writeFrame(croppedFrame);
+				cropTimer.elapse();
+				cropTime+=cropTimer.getTime();
+				++regionClient.numCroppedDepthFrames;
+				
+				/* Check that the cropped frame decompresses correctly: */
+				croppedDepthFile->flush();
+				Kinect::FrameBuffer decodedFrame=croppedDepthReader->readNextFrame();
+				if(memcmp(decodedFrame.getData<Kinect::FrameSource::DepthPixel>(),croppedFrame.getData<Kinect::FrameSource::DepthPixel>(),depthSize.volume()*sizeof(Kinect::FrameSource::DepthPixel))!=0)
+					++numMismatches;
+				}
+			else
+				regionClient.depthBytes+=fullSize;
+			
+			/* Read the next depth frame: */
+			++numDepthFrames;
+			depthFrame=depthReader->readNextFrame();
+			}
+		else
+			{
+			/* Calculate the color frame's compressed size: */
+			IO::SeekableFile::Offset nextColorPos=colorFile->getReadPos();
+			size_t colorSize=size_t(nextColorPos-colorPos);
+			fullClient.colorBytes+=sizeof(Misc::UInt32)*2+colorSize;
+			
+			/* Cull the color frame if no part of the most recent depth frame is visible, and resume at the next key frame: */
+			regionClient.colorBytes+=sizeof(Misc::UInt32)*2;
+			colorSynced=visibleTiles!=0&&(colorSynced||colorKeyFrame);
+			if(colorSynced)
+				regionClient.colorBytes+=colorSize;
+			else
+				++regionClient.numCulledColorFrames;
+			
+			/* Skip the next color frame: */
+			++numColorFrames;
+			colorPos=nextColorPos;
+			colorTimeStamp=colorReader->skipNextFrame(colorKeyFrame);
+			}
+		}
+	
+	/* Clean up: */
+	delete colorReader;
+	delete depthReader;
+	delete fullDepthWriter;
+	delete croppedDepthReader;
+	delete croppedDepthWriter;
+	croppedDepthFile=0;
+	unlink(croppedDepthFileName);
+	
+	/* Print the results: */
+	size_t fullBytes=fullClient.colorBytes+fullClient.depthBytes;
+	size_t regionBytes=regionClient.colorBytes+regionClient.depthBytes;
+	std::cout<<numColorFrames<<" color frames, "<<numDepthFrames<<" depth frames"<<std::endl;
+	std::cout<<std::setw(16)<<std::left<<"Client"<<std::right<<std::setw(14)<<"Color bytes"<<std::setw(14)<<"Depth bytes"<<std::setw(14)<<"Total bytes"<<std::setw(14)<<"Culled color"<<std::setw(14)<<"Culled depth"<<std::setw(14)<<"Cropped depth"<<std::endl;
+	std::cout<<std::setw(16)<<std::left<<"Full view"<<std::right<<std::setw(14)<<fullClient.colorBytes<<std::setw(14)<<fullClient.depthBytes<<std::setw(14)<<fullBytes<<std::setw(14)<<0<<std::setw(14)<<0<<std::setw(14)<<0<<std::endl;
+	std::cout<<std::setw(16)<<std::left<<"View region"<<std::right<<std::setw(14)<<regionClient.colorBytes<<std::setw(14)<<regionClient.depthBytes<<std::setw(14)<<regionBytes<<std::setw(14)<<regionClient.numCulledColorFrames<<std::setw(14)<<regionClient.numCulledDepthFrames<<std::setw(14)<<regionClient.numCroppedDepthFrames<<std::endl;
+	std::cout<<std::fixed<<std::setprecision(2);
+	if(fullBytes>0)
+		std::cout<<"Bandwidth saved: "<<100.0*(1.0-double(regionBytes)/double(fullBytes))<<"%"<<std::endl;
+	if(numDepthFrames>0)
+		std::cout<<"Culling: "<<cullTime*1000.0/double(numDepthFrames)<<" ms/frame"<<std::endl;
+	if(regionClient.numCroppedDepthFrames>0)
+		std::cout<<"Cropping and compression: "<<cropTime*1000.0/double(regionClient.numCroppedDepthFrames)<<" ms/frame"<<std::endl;
+	std::cout<<numMismatches<<" cropped depth frames did not survive the round trip unchanged"<<std::endl;
+	
+	return numMismatches==0?0:1;
+	}
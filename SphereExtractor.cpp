@@ -28,6 +28,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Math/Matrix.h>
 #include <Geometry/LevenbergMarquardtMinimizer.h>
 #include <Images/ExtractBlobs.h>
+#include <Kinect/BayerDemosaic.h>
 
 namespace {
 
@@ -440,7 +441,10 @@ void* SphereExtractor::frameProcessingThreadMethod(void)
 		
 		/* Call the streaming callback with the list of found spheres: */
 		if(streamingCallback!=0)
+			{
+			extractionTimeStamp=depthFrame.timeStamp;
 			(*streamingCallback)(spheres);
+			}
 		}
 	
 	return 0;
@@ -450,11 +454,12 @@ SphereExtractor::SphereExtractor(Kinect::FrameSource& frameSource,const SphereEx
 	:depthFrameSize(frameSource.getActualFrameSize(Kinect::FrameSource::DEPTH)),depthPixels(0),dcBuffer(sDcBuffer),
 	 colorFrameSize(frameSource.getActualFrameSize(Kinect::FrameSource::COLOR)),
 	 intrinsicParameters(frameSource.getIntrinsicParameters()),
-	 colorSpace(frameSource.getColorSpace()),
+	 colorSpace(frameSource.getColorSpace()==Kinect::FrameSource::BAYER_BGGR?Kinect::FrameSource::RGB:frameSource.getColorSpace()),
+	 demosaicColorFrames(frameSource.getColorSpace()==Kinect::FrameSource::BAYER_BGGR),
 	 sphereRadius(0),
 	 minWhite(192),maxSpread(32),minBlobSize(10),radiusTolerance(0.2),maxResidual(0.1),
 	 inDepthFrameVersion(0),
-	 streamingCallback(0)
+	 streamingCallback(0),extractionTimeStamp(0.0)
 	{
 	/* Initialize the depth frame pixel buffer: */
 	depthPixels=new PixelPos[depthFrameSize.volume()];
@@ -530,9 +535,12 @@ void SphereExtractor::setDepthFrame(const Kinect::FrameBuffer& newDepthFrame)
 
 void SphereExtractor::setColorFrame(const Kinect::FrameBuffer& newColorFrame)
 	{
+	/* Demosaic raw Bayer color frames outside the lock: */
+	Kinect::FrameBuffer colorFrame=demosaicColorFrames?Kinect::demosaicBayerFrame(newColorFrame):newColorFrame;
+	
 	/* Put the new color frame into the color frame input slot: */
 	Threads::Mutex::Lock inColorFrameLock(inColorFrameMutex);
-	inColorFrame=newColorFrame;
+	inColorFrame=colorFrame;
 	}
 
 void SphereExtractor::stopStreaming(void)
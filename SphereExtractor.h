@@ -67,7 +67,8 @@ class SphereExtractor
 	const PixelDepthCorrection* dcBuffer; // Pointer to frame source's per-pixel depth correction buffer
 	Size colorFrameSize; // Width and height of source's color frames
 	IntrinsicParameters intrinsicParameters; // Frame source's intrinsic parameters
-	ColorSpace colorSpace; // Frame source's color space
+	ColorSpace colorSpace; // Color space of color frames after demosaicing
+	bool demosaicColorFrames; // Flag whether incoming color frames are raw Bayer frames that need to be demosaiced
 	int maxBlobMergeDist; // Maximum depth distance between adjacent pixels to merge their respective blobs
 	Scalar sphereRadius; // Radius of sphere in 3D camera space's measurement unit
 	ColorPixel::Component minWhite; // Minimum color component value to classify a pixel as white
@@ -83,6 +84,7 @@ class SphereExtractor
 	Kinect::FrameBuffer inColorFrame; // Most-recently arrived raw color frame
 	Threads::TripleBuffer<SphereList> sphereLists; // Triple buffer of recently extracted lists of spheres
 	StreamingCallback* streamingCallback; // Function to be called when spheres have been extracted from a depth frame
+	double extractionTimeStamp; // Time stamp of the depth frame from which the most recent list of spheres was extracted
 	
 	/* Private methods: */
 	void* frameProcessingThreadMethod(void); // Thread method for the background sphere extraction thread
@@ -100,6 +102,10 @@ class SphereExtractor
 	void setDepthFrame(const Kinect::FrameBuffer& newDepthFrame); // Submits a new depth frame for sphere extraction
 	void setColorFrame(const Kinect::FrameBuffer& newColorFrame); // Submits a new color frame for sphere extraction
 	void stopStreaming(void); // Stops background processing of depth frames
+	double getExtractionTimeStamp(void) const // Returns the time stamp of the depth frame from which the spheres passed to the streaming callback were extracted; only valid inside the callback
+		{
+		return extractionTimeStamp;
+		}
 	bool lockSpheres(void) // Locks the most recent list of extracted spheres; returns true if there is a new list
 		{
 		return sphereLists.lockNewValue();
@@ -0,0 +1,353 @@
+/***********************************************************************
+SpliceRecordings - Utility to extract time ranges from recorded pairs of
+color and depth stream files and concatenate them into a new pair of
+stream files, copying compressed frames without re-encoding them.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
+
+/**************
+Helper classes:
+**************/
+
+struct FrameIndex // Structure describing the position of a compressed frame in a stream file
+	{
+	/* Elements: */
+	public:
+	IO::SeekableFile::Offset begin,end; // Range of the frame's time stamp and compressed data in the stream file
+	double timeStamp; // The frame's original time stamp
+	};
+
+struct StreamClip // Structure describing the copied range of one stream of an input recording
+	{
+	/* Elements: */
+	public:
+	IO::SeekableFilePtr file; // The stream file
+	unsigned int codec; // Identifier of the stream's codec
+	bool hasMetadata; // Flag whether the stream's frames carry device metadata, which is copied along with their compressed data
+	std::vector<Misc::UInt8> fileHeader; // The stream file's header containing format version, codec, and camera calibration
+	std::vector<Misc::UInt8> streamHeader; // The codec's stream header following the file header
+	std::vector<FrameIndex> frames; // List of frames to be copied
+	
+	/* Methods: */
+	void readRange(IO::SeekableFile::Offset begin,IO::SeekableFile::Offset end,std::vector<Misc::UInt8>& buffer) // Reads a range of the stream file into the given buffer
+		{
+		buffer.resize(size_t(end-begin));
+		file->setReadPosAbs(begin);
+		if(!buffer.empty())
+			file->read(&buffer[0],buffer.size());
+		}
+	void index(Kinect::FrameReader& reader,double startTime,double endTime) // Finds all frames in the given time range, starting at the last key frame at or before the range's beginning
+		{
+		bool inRange=false;
+		while(true)
+			{
+			/* Skip the next frame: */
+			FrameIndex fi;
+			fi.begin=file->getReadPos();
+			bool keyFrame;
+			fi.timeStamp=reader.skipNextFrame(keyFrame);
+			if(fi.timeStamp==Math::Constants<double>::max||fi.timeStamp>endTime)
+				break;
+			fi.end=file->getReadPos();
+			
+			if(!inRange&&fi.timeStamp<startTime)
+				{
+				/* Only keep frames since the most recent key frame before the range: */
+				if(keyFrame)
+					frames.clear();
+				}
+			else
+				inRange=true;
+			frames.push_back(fi);
+			}
+		
+		/* Drop all frames if none were in range: */
+		if(!inRange)
+			frames.clear();
+		}
+	size_t copy(IO::File& sink,double timeStampOffset) // Writes all frames to the given sink with offset time stamps; returns size of written data
+		{
+		size_t result=0;
+		std::vector<Misc::UInt8> buffer;
+		for(std::vector<FrameIndex>::iterator fIt=frames.begin();fIt!=frames.end();++fIt)
+			{
+			/* Read the frame's compressed data following its time stamp: */
+			readRange(fIt->begin+sizeof(Misc::Float64),fIt->end,buffer);
+			
+			/* Write the frame with its new time stamp: */
+			sink.write<Misc::Float64>(fIt->timeStamp+timeStampOffset);
+			if(!buffer.empty())
+				sink.write(&buffer[0],buffer.size());
+			result+=sizeof(Misc::Float64)+buffer.size();
+			}
+		
+		return result;
+		}
+	};
+
+struct Input // Structure describing an input recording
+	{
+	/* Elements: */
+	public:
+	std::string fileNameBase; // Base name of the input recording's color and depth stream files
+	double startTime,endTime; // Range of time stamps to copy from the input recording
+	};
+
+/****************
+Helper functions:
+****************/
+
+Kinect::FrameReader* openColorStream(const std::string& fileName,StreamClip& clip)
+	{
+	/* Open the color stream file: */
+	clip.file=IO::openSeekableFile(fileName.c_str());
+	clip.file->setEndianness(Misc::LittleEndian);
+	
+	/* Read the file header: */
+	Kinect::ColorFileHeader header(*clip.file);
+	clip.codec=header.codec;
+	clip.hasMetadata=Kinect::hasColorFrameMetadata(header.formatVersion);
+	IO::SeekableFile::Offset fileHeaderEnd=clip.file->getReadPos();
+	
+	/* Create a color frame reader to read the codec's stream header: */
+	Kinect::FrameReader* reader=header.createReader(*clip.file);
+	IO::SeekableFile::Offset streamHeaderEnd=clip.file->getReadPos();
+	
+	/* Retrieve the raw file and stream headers: */
+	clip.readRange(0,fileHeaderEnd,clip.fileHeader);
+	clip.readRange(fileHeaderEnd,streamHeaderEnd,clip.streamHeader);
+	
+	return reader;
+	}
+
+Kinect::FrameReader* openDepthStream(const std::string& fileName,StreamClip& clip)
+	{
+	/* Open the depth stream file: */
+	clip.file=IO::openSeekableFile(fileName.c_str());
+	clip.file->setEndianness(Misc::LittleEndian);
+	
+	/* Read the file header: */
+	Kinect::DepthFileHeader header(*clip.file);
+	clip.codec=header.codec;
+	clip.hasMetadata=Kinect::hasDepthFrameMetadata(header.formatVersion);
+	IO::SeekableFile::Offset fileHeaderEnd=clip.file->getReadPos();
+	
+	/* Create a depth frame reader to read the codec's stream header: */
+	Kinect::FrameReader* reader=header.createReader(*clip.file);
+	IO::SeekableFile::Offset streamHeaderEnd=clip.file->getReadPos();
+	
+	/* Retrieve the raw file and stream headers: */
+	clip.readRange(0,fileHeaderEnd,clip.fileHeader);
+	clip.readRange(fileHeaderEnd,streamHeaderEnd,clip.streamHeader);
+	
+	return reader;
+	}
+
+void printUsage(const char* appName)
+	{
+	std::cout<<"Usage: "<<appName<<" <output file name base> ( [ -start <time> ] [ -end <time> ] <input file name base> )+"<<std::endl;
+	std::cout<<"  Copies the frames of each input recording between the given start and end"<<std::endl;
+	std::cout<<"  time stamps, in seconds, into a single output recording, in the order in"<<std::endl;
+	std::cout<<"  which input recordings appear on the command line. -start and -end only"<<std::endl;
+	std::cout<<"  apply to the next input recording. Color and depth frames are copied"<<std::endl;
+	std::cout<<"  without re-encoding; inter-frame compressed streams start at the last key"<<std::endl;
+	std::cout<<"  frame preceding the start time stamp. All input recordings must use the"<<std::endl;
+	std::cout<<"  same codecs and frame sizes, and either all or none must carry per-frame"<<std::endl;
+	std::cout<<"  metadata; the output recording uses the camera calibration of the first"<<std::endl;
+	std::cout<<"  input recording."<<std::endl;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* outputFileNameBase=0;
+	std::vector<Input> inputs;
+	double startTime=-Math::Constants<double>::max;
+	double endTime=Math::Constants<double>::max;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"start")==0)
+				{
+				++i;
+				if(i<argc)
+					startTime=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"end")==0)
+				{
+				++i;
+				if(i<argc)
+					endTime=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"h")==0)
+				{
+				printUsage(argv[0]);
+				return 0;
+				}
+			else
+				std::cerr<<"Ignoring unrecognized command line option "<<argv[i]<<std::endl;
+			}
+		else if(outputFileNameBase==0)
+			outputFileNameBase=argv[i];
+		else
+			{
+			Input input;
+			input.fileNameBase=argv[i];
+			input.startTime=startTime;
+			input.endTime=endTime;
+			inputs.push_back(input);
+			
+			/* Reset the time range for the next input recording: */
+			startTime=-Math::Constants<double>::max;
+			endTime=Math::Constants<double>::max;
+			}
+		}
+	if(outputFileNameBase==0||inputs.empty())
+		{
+		printUsage(argv[0]);
+		return 1;
+		}
+	
+	try
+		{
+		IO::FilePtr outputFiles[2];
+		std::vector<Misc::UInt8> outputStreamHeaders[2];
+		unsigned int outputCodecs[2]={0,0};
+		bool outputHasMetadata[2]={false,false};
+		double outputTime=0.0;
+		size_t totalSizes[2]={0,0};
+		size_t totalNumFrames[2]={0,0};
+		for(std::vector<Input>::iterator iIt=inputs.begin();iIt!=inputs.end();++iIt)
+			{
+			/* Open the input recording's stream files: */
+			StreamClip clips[2];
+			Kinect::FrameReader* readers[2]={0,0};
+			try
+				{
+				readers[0]=openColorStream(iIt->fileNameBase+".color",clips[0]);
+				readers[1]=openDepthStream(iIt->fileNameBase+".depth",clips[1]);
+				
+				/* Find the frames to copy from both streams: */
+				for(int i=0;i<2;++i)
+					clips[i].index(*readers[i],iIt->startTime,iIt->endTime);
+				}
+			catch(...)
+				{
+				for(int i=0;i<2;++i)
+					delete readers[i];
+				throw;
+				}
+			for(int i=0;i<2;++i)
+				delete readers[i];
+			
+			if(iIt==inputs.begin())
+				{
+				/* Create the output stream files and write the first input recording's headers: */
+				static const char* extensions[2]={".color",".depth"};
+				for(int i=0;i<2;++i)
+					{
+					std::string outputFileName=outputFileNameBase;
+					outputFileName.append(extensions[i]);
+					outputFiles[i]=IO::openFile(outputFileName.c_str(),IO::File::WriteOnly);
+					outputFiles[i]->setEndianness(Misc::LittleEndian);
+					outputFiles[i]->write(&clips[i].fileHeader[0],clips[i].fileHeader.size());
+					outputFiles[i]->write(&clips[i].streamHeader[0],clips[i].streamHeader.size());
+					outputStreamHeaders[i]=clips[i].streamHeader;
+					outputCodecs[i]=clips[i].codec;
+					outputHasMetadata[i]=clips[i].hasMetadata;
+					}
+				}
+			else
+				{
+				/* Check that the input recording's compressed frames can be appended to the output recording: */
+				for(int i=0;i<2;++i)
+					{
+					if(clips[i].codec!=outputCodecs[i]||clips[i].streamHeader!=outputStreamHeaders[i])
+						throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Recording %s uses a different %s codec or frame size than the first recording",iIt->fileNameBase.c_str(),i==0?"color":"depth");
+					if(clips[i].hasMetadata!=outputHasMetadata[i])
+						throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Recording %s %s per-frame metadata in its %s stream, unlike the first recording",iIt->fileNameBase.c_str(),clips[i].hasMetadata?"has":"does not have",i==0?"color":"depth");
+					}
+				}
+			
+			if(clips[0].frames.empty()&&clips[1].frames.empty())
+				{
+				std::cerr<<"Recording "<<iIt->fileNameBase<<" has no frames in the requested time range"<<std::endl;
+				continue;
+				}
+			
+			/* Align the earliest copied frame of both streams with the end of the output recording: */
+			double clipStart=Math::Constants<double>::max;
+			double clipEnd=-Math::Constants<double>::max;
+			for(int i=0;i<2;++i)
+				if(!clips[i].frames.empty())
+					{
+					if(clipStart>clips[i].frames.front().timeStamp)
+						clipStart=clips[i].frames.front().timeStamp;
+					if(clipEnd<clips[i].frames.back().timeStamp)
+						clipEnd=clips[i].frames.back().timeStamp;
+					}
+			double timeStampOffset=outputTime-clipStart;
+			
+			/* Copy the frames: */
+			for(int i=0;i<2;++i)
+				{
+				totalSizes[i]+=clips[i].copy(*outputFiles[i],timeStampOffset);
+				totalNumFrames[i]+=clips[i].frames.size();
+				}
+			std::cout<<"Copied "<<clips[0].frames.size()<<" color and "<<clips[1].frames.size()<<" depth frames from "<<iIt->fileNameBase<<", time stamps "<<clipStart<<" to "<<clipEnd<<std::endl;
+			
+			/* Continue the output recording one average depth frame interval after the end of this clip: */
+			double frameInterval=1.0/30.0;
+			const std::vector<FrameIndex>& depthFrames=clips[1].frames;
+			if(depthFrames.size()>=2)
+				frameInterval=(depthFrames.back().timeStamp-depthFrames.front().timeStamp)/double(depthFrames.size()-1);
+			outputTime=clipEnd+timeStampOffset+frameInterval;
+			}
+		
+		std::cout<<"Wrote "<<totalNumFrames[0]<<" color frames ("<<totalSizes[0]<<" bytes) and "<<totalNumFrames[1]<<" depth frames ("<<totalSizes[1]<<" bytes)"<<std::endl;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"SpliceRecordings: Terminated due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,204 @@
+/***********************************************************************
+StitchingBenchmark - Utility to stitch the depth frames of two or more
+recorded 3D video streams into meta-frames without redundant surface
+coverage, and compare the number of triangles generated from stitched
+and unstitched depth frames.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/Projector.h>
+#include <Kinect/FacadeStitcher.h>
+
+struct Stream // Structure holding the state of one recorded 3D video stream
+	{
+	/* Elements: */
+	public:
+	IO::FilePtr depthFile; // The stream's depth file
+	Kinect::FrameReader* depthReader; // Reader for the stream's depth frames
+	Kinect::FrameBuffer nextFrame; // The stream's next unprocessed depth frame
+	Kinect::Projector* projector; // Projector to triangulate the stream's depth frames
+	};
+
+Kinect::FrameReader* openDepthStream(IO::File& depthFile) // Skips the given depth file's header and returns a depth frame reader for it
+	{
+	depthFile.setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(depthFile);
+	Kinect::FrameReader* result=depthFileHeader.createReader(depthFile);
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> streamNames;
+	float maxOverlapDistance=-1.0f;
+	int triangleDepthRange=-1;
+	unsigned int numThreads=2;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"overlap")==0&&i+1<argc)
+				maxOverlapDistance=float(atof(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"tdr")==0&&i+1<argc)
+				triangleDepthRange=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++i]));
+			else
+				std::cerr<<"Ignoring command line option "<<argv[i]<<std::endl;
+			}
+		else
+			streamNames.push_back(argv[i]);
+		}
+	if(streamNames.size()<2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-overlap <max overlap distance>] [-tdr <triangle depth range>] [-threads <num threads>] <stream file name base> <stream file name base> [<stream file name base> ...]"<<std::endl;
+		return 1;
+		}
+	
+	/* Open all streams and add their cameras to the facade stitcher: */
+	Kinect::FacadeStitcher stitcher(numThreads);
+	if(maxOverlapDistance>=0.0f)
+		stitcher.setMaxOverlapDistance(maxOverlapDistance);
+	std::vector<Stream> streams;
+	for(std::vector<std::string>::iterator snIt=streamNames.begin();snIt!=streamNames.end();++snIt)
+		{
+		std::string colorFileName=*snIt;
+		colorFileName.append(".color");
+		std::string depthFileName=*snIt;
+		depthFileName.append(".depth");
+		
+		Kinect::FileFrameSource source(colorFileName.c_str(),depthFileName.c_str());
+		unsigned int cameraIndex=stitcher.addCamera(source);
+		
+		Stream s;
+		s.depthFile=IO::openFile(depthFileName.c_str());
+		s.depthReader=openDepthStream(*s.depthFile);
+		s.nextFrame=s.depthReader->readNextFrame();
+		s.projector=new Kinect::Projector(source);
+		if(triangleDepthRange>=0)
+			{
+			s.projector->setTriangleDepthRange(Kinect::FrameSource::DepthPixel(triangleDepthRange));
+			stitcher.setTriangleDepthRange(cameraIndex,Kinect::FrameSource::DepthPixel(triangleDepthRange));
+			}
+		streams.push_back(s);
+		}
+	
+	/* Group depth frames in time stamp order into meta-frames containing at most one frame from each stream: */
+	std::vector<Kinect::FrameBuffer> depthFrames(streams.size());
+	std::vector<Kinect::FrameBuffer> stitchedFrames(streams.size());
+	std::vector<bool> contributed(streams.size(),false);
+	bool metaFrameEmpty=true;
+	unsigned int numMetaFrames=0;
+	size_t numPlainTriangles=0,numStitchedTriangles=0;
+	size_t numValidPixels=0,numSuppressedPixels=0;
+	double stitchTime=0.0;
+	Kinect::MeshBuffer mesh;
+	while(true)
+		{
+		/* Find the stream with the earliest next depth frame: */
+		unsigned int streamIndex=streams.size();
+		for(unsigned int i=0;i<streams.size();++i)
+			if(streams[i].nextFrame.timeStamp!=Math::Constants<double>::max&&(streamIndex==streams.size()||streams[streamIndex].nextFrame.timeStamp>streams[i].nextFrame.timeStamp))
+				streamIndex=i;
+		
+		/* Finish the current meta-frame if the stream already contributed to it, or if all streams are over: */
+		if(!metaFrameEmpty&&(streamIndex==streams.size()||contributed[streamIndex]))
+			{
+			/* Triangulate the meta-frame's unstitched depth frames: */
+			for(unsigned int i=0;i<streams.size();++i)
+				if(depthFrames[i].isValid())
+					{
+					streams[i].projector->processDepthFrame(depthFrames[i],mesh);
+					numPlainTriangles+=mesh.numTriangles;
+					}
+			
+			/* Stitch the meta-frame, where streams that did not contribute keep their previous frames: */
+			Misc::Timer stitchTimer;
+			stitcher.stitch(&depthFrames[0],&stitchedFrames[0]);
+			stitchTimer.elapse();
+			stitchTime+=stitchTimer.getTime();
+			
+			/* Triangulate the stitched depth frames of the streams that contributed to the meta-frame: */
+			for(unsigned int i=0;i<streams.size();++i)
+				if(depthFrames[i].isValid())
+					{
+					streams[i].projector->processDepthFrame(stitchedFrames[i],mesh);
+					numStitchedTriangles+=mesh.numTriangles;
+					numValidPixels+=stitcher.getNumValidPixels(i);
+					numSuppressedPixels+=stitcher.getNumSuppressedPixels(i);
+					}
+			
+			++numMetaFrames;
+			for(unsigned int i=0;i<streams.size();++i)
+				depthFrames[i]=Kinect::FrameBuffer();
+			contributed.assign(streams.size(),false);
+			metaFrameEmpty=true;
+			}
+		if(streamIndex==streams.size())
+			break;
+		Stream& s=streams[streamIndex];
+		
+		/* Add the depth frame to the meta-frame: */
+		depthFrames[streamIndex]=s.nextFrame;
+		contributed[streamIndex]=true;
+		metaFrameEmpty=false;
+		
+		/* Read the stream's next depth frame: */
+		s.nextFrame=s.depthReader->readNextFrame();
+		}
+	for(std::vector<Stream>::iterator sIt=streams.begin();sIt!=streams.end();++sIt)
+		{
+		delete sIt->projector;
+		delete sIt->depthReader;
+		}
+	if(numMetaFrames==0)
+		{
+		std::cerr<<"No depth frames in the given streams"<<std::endl;
+		return 1;
+		}
+	
+	/* Print the results: */
+	double nmf=double(numMetaFrames);
+	std::cout<<numMetaFrames<<" meta-frames from "<<streams.size()<<" cameras, maximum overlap distance "<<stitcher.getMaxOverlapDistance()<<std::endl;
+	std::cout<<std::fixed<<std::setprecision(2);
+	std::cout<<"Unstitched: "<<double(numPlainTriangles)/nmf<<" triangles per meta-frame"<<std::endl;
+	std::cout<<"Stitched: "<<double(numStitchedTriangles)/nmf<<" triangles per meta-frame, "<<(numPlainTriangles>0?100.0*(1.0-double(numStitchedTriangles)/double(numPlainTriangles)):0.0)<<"% fewer"<<std::endl;
+	std::cout<<"Suppressed pixels: "<<double(numSuppressedPixels)/nmf<<" per meta-frame, "<<(numValidPixels>0?100.0*double(numSuppressedPixels)/double(numValidPixels):0.0)<<"% of valid pixels"<<std::endl;
+	std::cout<<"Stitching: "<<stitchTime*1000.0/nmf<<" ms per meta-frame using "<<numThreads<<" thread(s)"<<std::endl;
+	
+	return 0;
+	}
@@ -0,0 +1,219 @@
+/***********************************************************************
+SubjectTrackingBenchmark - Utility to measure the cost of foreground
+subject tracking on one or more recorded 3D video streams, the stability
+of the assigned subject IDs, and the meshing work saved by limiting
+triangulation to the tiles covered by tracked subjects.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Kinect 3D Video Capture Project (Kinect).
+
+The Kinect 3D Video Capture Project is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Kinect 3D Video Capture Project is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Kinect 3D Video Capture Project; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Constants.h>
+#include <Kinect/Types.h>
+#include <Kinect/FrameBuffer.h>
+#include <Kinect/MeshBuffer.h>
+#include <Kinect/FrameSource.h>
+#include <Kinect/FileFrameSource.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/FrameFileHeaders.h>
+#include <Kinect/DepthTileCuller.h>
+#include <Kinect/Projector.h>
+#include <Kinect/SubjectTracker.h>
+
+struct Stream // Structure holding the state of one recorded 3D video stream
+	{
+	/* Elements: */
+	public:
+	Kinect::FileFrameSource* source; // Frame source providing the stream's calibration parameters
+	Kinect::Projector* projector; // Projector to triangulate the stream's depth frames
+	Kinect::DepthTileCuller* culler; // Tile culler to limit depth frames to tracked subjects
+	IO::FilePtr depthFile; // The stream's depth file
+	Kinect::FrameReader* depthReader; // Reader for the stream's depth frames
+	Kinect::FrameBuffer nextFrame; // The stream's next unprocessed depth frame
+	};
+
+Kinect::FrameReader* openDepthStream(IO::File& depthFile) // Skips the given depth file's header and returns a depth frame reader for it
+	{
+	depthFile.setEndianness(Misc::LittleEndian);
+	Kinect::DepthFileHeader depthFileHeader(depthFile);
+	Kinect::FrameReader* result=depthFileHeader.createReader(depthFile);
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> streamNames;
+	unsigned int minNumPixels=500;
+	double mergeDistance=10.0;
+	double minExtent=0.0;
+	double maxExtent=Math::Constants<double>::max;
+	double maxTrackDistance=50.0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"minPixels")==0&&i+1<argc)
+				minNumPixels=(unsigned int)(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"mergeDistance")==0&&i+1<argc)
+				mergeDistance=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"extent")==0&&i+2<argc)
+				{
+				minExtent=atof(argv[++i]);
+				maxExtent=atof(argv[++i]);
+				}
+			else if(strcasecmp(argv[i]+1,"trackDistance")==0&&i+1<argc)
+				maxTrackDistance=atof(argv[++i]);
+			else
+				std::cerr<<"Ignoring command line option "<<argv[i]<<std::endl;
+			}
+		else
+			streamNames.push_back(argv[i]);
+		}
+	if(streamNames.empty())
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-minPixels <num pixels>] [-mergeDistance <dist>] [-extent <min> <max>] [-trackDistance <dist>] <stream file name base> [<stream file name base> ...]"<<std::endl;
+		return 1;
+		}
+	
+	/* Create a subject tracker: */
+	Kinect::SubjectTracker tracker;
+	tracker.setMinNumPixels(minNumPixels);
+	tracker.setMergeDistance(mergeDistance);
+	tracker.setSubjectExtentRange(minExtent,maxExtent);
+	tracker.setMaxTrackDistance(maxTrackDistance);
+	
+	/* Open all streams and add their cameras to the subject tracker: */
+	std::vector<Stream> streams;
+	for(std::vector<std::string>::iterator snIt=streamNames.begin();snIt!=streamNames.end();++snIt)
+		{
+		std::string colorFileName=*snIt;
+		colorFileName.append(".color");
+		std::string depthFileName=*snIt;
+		depthFileName.append(".depth");
+		
+		Stream s;
+		s.source=new Kinect::FileFrameSource(colorFileName.c_str(),depthFileName.c_str());
+		tracker.addCamera(*s.source);
+		s.projector=new Kinect::Projector(*s.source);
+		Kinect::FrameSource::DepthCorrection* dc=s.source->getDepthCorrectionParameters();
+		s.culler=new Kinect::DepthTileCuller(s.source->getActualFrameSize(Kinect::FrameSource::DEPTH),dc,s.source->getIntrinsicParameters(),s.source->getExtrinsicParameters());
+		delete dc;
+		s.depthFile=IO::openFile(depthFileName.c_str());
+		s.depthReader=openDepthStream(*s.depthFile);
+		s.nextFrame=s.depthReader->readNextFrame();
+		streams.push_back(s);
+		}
+	
+	/* Process all depth frames of all streams in time stamp order: */
+	unsigned int numFrames=0;
+	double trackingTime=0.0;
+	size_t numSubjects=0;
+	size_t numSubjectFrames=0;
+	unsigned int maxId=0;
+	bool haveSubjects=false;
+	size_t numValidTiles=0,numSubjectTiles=0;
+	size_t numTriangles=0,numSubjectTriangles=0;
+	Kinect::MeshBuffer mesh;
+	while(true)
+		{
+		/* Find the stream with the earliest next depth frame: */
+		Stream* stream=0;
+		unsigned int cameraIndex=0;
+		for(unsigned int i=0;i<streams.size();++i)
+			if(streams[i].nextFrame.timeStamp!=Math::Constants<double>::max&&(stream==0||stream->nextFrame.timeStamp>streams[i].nextFrame.timeStamp))
+				{
+				stream=&streams[i];
+				cameraIndex=i;
+				}
+		if(stream==0)
+			break;
+		Kinect::FrameBuffer depthFrame=stream->nextFrame;
+		
+		/* Track subjects: */
+		Misc::Timer trackingTimer;
+		Kinect::SubjectTracker::SubjectList subjects=tracker.processFrame(cameraIndex,depthFrame);
+		trackingTimer.elapse();
+		trackingTime+=trackingTimer.getTime();
+		
+		/* Accumulate subject statistics: */
+		Kinect::DepthTileCuller::TileMask subjectTiles=0;
+		Kinect::DepthTileCuller::TileRange tileRanges[Kinect::DepthTileCuller::numTiles*Kinect::DepthTileCuller::numTiles];
+		stream->culler->calcTileRanges(depthFrame,tileRanges);
+		for(Kinect::SubjectTracker::SubjectList::iterator sIt=subjects.begin();sIt!=subjects.end();++sIt)
+			{
+			if(sIt->lastSeen==depthFrame.timeStamp)
+				++numSubjectFrames;
+			if(maxId<sIt->id)
+				maxId=sIt->id;
+			haveSubjects=true;
+			
+			/* Add the tiles that can intersect the subject's bounding box: */
+			subjectTiles|=stream->culler->calcVisibleTiles(tileRanges,Kinect::DepthTileCuller::makeBoxRegion(sIt->box.min,sIt->box.max),0.0);
+			}
+		numSubjects+=subjects.size();
+		
+		/* Compare the triangulation of the full depth frame and of the subjects' tiles: */
+		Kinect::DepthTileCuller::TileMask validTiles=Kinect::DepthTileCuller::calcValidTiles(tileRanges);
+		for(Kinect::DepthTileCuller::TileMask mask=validTiles;mask!=0;mask&=mask-1)
+			++numValidTiles;
+		for(Kinect::DepthTileCuller::TileMask mask=subjectTiles;mask!=0;mask&=mask-1)
+			++numSubjectTiles;
+		stream->projector->processDepthFrame(depthFrame,mesh);
+		numTriangles+=mesh.numTriangles;
+		stream->projector->processDepthFrame(stream->culler->maskFrame(depthFrame,subjectTiles),mesh);
+		numSubjectTriangles+=mesh.numTriangles;
+		
+		/* Read the stream's next depth frame: */
+		++numFrames;
+		stream->nextFrame=stream->depthReader->readNextFrame();
+		}
+	
+	/* Clean up: */
+	for(std::vector<Stream>::iterator sIt=streams.begin();sIt!=streams.end();++sIt)
+		{
+		delete sIt->depthReader;
+		delete sIt->culler;
+		delete sIt->projector;
+		delete sIt->source;
+		}
+	
+	/* Print the results: */
+	std::cout<<numFrames<<" depth frames from "<<streams.size()<<" camera(s)"<<std::endl;
+	if(numFrames>0)
+		{
+		double nf=double(numFrames);
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Subject tracking: "<<trackingTime*1000.0/nf<<" ms/frame"<<std::endl;
+		std::cout<<"Tracked subjects: "<<double(numSubjects)/nf<<" per frame, "<<double(numSubjectFrames)/nf<<" detected per frame"<<std::endl;
+		std::cout<<"Subject IDs assigned: "<<(haveSubjects?maxId+1:0)<<std::endl;
+		std::cout<<"Tiles covered by subjects: "<<double(numSubjectTiles)/nf<<" of "<<double(numValidTiles)/nf<<" non-empty tiles per frame"<<std::endl;
+		std::cout<<"Triangles: "<<double(numTriangles)/nf<<" per frame for full frames, "<<double(numSubjectTriangles)/nf<<" per frame for subject tiles"<<std::endl;
+		}
+	
+	return 0;
+	}
@@ -33,9 +33,10 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/gl.h>
 #include <GL/GLTransformationWrappers.h>
 #include <Sound/SoundPlayer.h>
-#include <Kinect/ColorFrameReader.h>
-#include <Kinect/DepthFrameReader.h>
-#include <Kinect/LossyDepthFrameReader.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/VisletManager.h>
 
@@ -159,7 +160,7 @@ void* KinectPlayer::KinectStreamer::colorDecompressorThreadMethod(void)
 		while(numColorFrames==2)
 			frameQueueCond.wait(frameQueueLock);
 		mostRecentColorFrame=1-mostRecentColorFrame;
-		colorFrames[mostRecentColorFrame]=nextFrame;
+		Kinect::MemoryAccounting::assignHeld(memoryTag,colorFrames[mostRecentColorFrame],nextFrame);
 		++numColorFrames;
 		if(numColorFrames==1)
 			frameQueueCond.broadcast();
@@ -193,8 +194,8 @@ void* KinectPlayer::KinectStreamer::depthDecompressorThreadMethod(void)
 		while(numDepthFrames==2)
 			frameQueueCond.wait(frameQueueLock);
 		mostRecentDepthFrame=1-mostRecentDepthFrame;
-		depthFrames[mostRecentDepthFrame]=nextFrame;
-		meshes[mostRecentDepthFrame]=nextMesh;
+		Kinect::MemoryAccounting::assignHeld(memoryTag,depthFrames[mostRecentDepthFrame],nextFrame);
+		Kinect::MemoryAccounting::assignHeld(memoryTag,meshes[mostRecentDepthFrame],nextMesh);
 		++numDepthFrames;
 		if(numDepthFrames==1)
 			frameQueueCond.broadcast();
@@ -209,6 +210,7 @@ void* KinectPlayer::KinectStreamer::depthDecompressorThreadMethod(void)
 
 KinectPlayer::KinectStreamer::KinectStreamer(const KinectPlayerFactory::KinectConfig& config)
 	:colorDecompressor(0),depthDecompressor(0),
+	 memoryTag(Kinect::MemoryAccounting::registerTag("KinectPlayer")),
 	 numColorFrames(0),mostRecentColorFrame(0),
 	 numDepthFrames(0),mostRecentDepthFrame(0)
 	{
@@ -228,65 +230,39 @@ KinectPlayer::KinectStreamer::KinectStreamer(const KinectPlayerFactory::KinectCo
 	depthFile=IO::openFile(depthFileName.c_str());
 	depthFile->setEndianness(Misc::LittleEndian);
 	
-	/* Read the files' format version numbers: */
-	// unsigned int colorFormatVersion=colorFile->read<unsigned int>();
-	colorFile->skip<unsigned int>(1);
-	unsigned int depthFormatVersion=depthFile->read<unsigned int>();
+	/* Read the files' headers: */
+	Kinect::ColorFileHeader colorFileHeader(*colorFile);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
 	
-	/* Check if there are per-pixel depth correction coefficients: */
-	Kinect::FrameSource::DepthCorrection* depthCorrection=0;
-	if(depthFormatVersion>=4)
-		{
-		/* Read new B-spline based depth correction parameters: */
-		depthCorrection=new Kinect::FrameSource::DepthCorrection(*depthFile);
-		}
-	else
-		{
-		if(depthFormatVersion>=2&&depthFile->read<char>()!=0)
-			{
-			/* Skip the depth correction buffer: */
-			Kinect::Size size;
-			depthFile->read(size.getComponents(),2);
-			depthFile->skip<float>(size.volume()*2);
-			}
-		}
-	
-	/* Check if the depth stream uses lossy compression: */
-	bool depthIsLossy=depthFormatVersion>=3&&depthFile->read<unsigned char>()!=0;
-	
-	/* Read the color and depth projections from their respective files: */
+	/* Set the projector's color and depth projections: */
 	Kinect::FrameSource::IntrinsicParameters ips;
-	ips.colorProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(*colorFile);
-	ips.depthProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(*depthFile);
+	ips.colorProjection=colorFileHeader.projection;
+	ips.depthProjection=depthFileHeader.projection;
 	projector.setIntrinsicParameters(ips);
 	
-	/* Read the camera transformation from the depth file: */
-	Kinect::FrameSource::ExtrinsicParameters eps;
-	eps=Misc::Marshaller<Kinect::FrameSource::ExtrinsicParameters>::read(*depthFile);
-	projector.setExtrinsicParameters(eps);
+	/* Set the projector's camera transformation: */
+	projector.setExtrinsicParameters(depthFileHeader.extrinsicParameters);
 	
 	/* Create the color and depth decompressors: */
-	colorDecompressor=new Kinect::ColorFrameReader(*colorFile);
-	if(depthIsLossy)
+	colorDecompressor=colorFileHeader.createReader(*colorFile);
+	try
+		{
+		depthDecompressor=depthFileHeader.createReader(*depthFile);
+		}
+	catch(...)
 		{
-		#if VIDEO_CONFIG_HAVE_THEORA
-		depthDecompressor=new Kinect::LossyDepthFrameReader(*depthFile);
-		#else
 		delete colorDecompressor;
-		Misc::throwStdErr("KinectPlayer: Lossy depth compression not supported due to lack of Theora library");
-		#endif
+		colorDecompressor=0;
+		throw;
 		}
-	else
-		depthDecompressor=new Kinect::DepthFrameReader(*depthFile);
+	colorDecompressor->setMemoryTag(Kinect::MemoryAccounting::FILE_PLAYBACK);
+	depthDecompressor->setMemoryTag(Kinect::MemoryAccounting::FILE_PLAYBACK);
 	
 	/* Set the projector's depth frame size: */
 	projector.setDepthFrameSize(depthDecompressor->getSize());
 	
 	/* Set the projector's depth correction coefficients: */
-	projector.setDepthCorrection(depthCorrection);
-	
-	/* Clean up: */
-	delete depthCorrection;
+	projector.setDepthCorrection(depthFileHeader.depthCorrection);
 	
 	/* Start the color and depth decompression threads: */
 	colorDecompressorThread.start(this,&KinectPlayer::KinectStreamer::colorDecompressorThreadMethod);
@@ -304,6 +280,17 @@ KinectPlayer::KinectStreamer::~KinectStreamer(void)
 	/* Delete the color and depth decompressors: */
 	delete colorDecompressor;
 	delete depthDecompressor;
+	
+	/* Release the frames and meshes in the read-ahead queues: */
+	for(int i=0;i<2;++i)
+		{
+		Kinect::MemoryAccounting::assignHeld(memoryTag,colorFrames[i],Kinect::FrameBuffer());
+		Kinect::MemoryAccounting::assignHeld(memoryTag,depthFrames[i],Kinect::FrameBuffer());
+		Kinect::MemoryAccounting::assignHeld(memoryTag,meshes[i],Kinect::MeshBuffer());
+		}
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextColorFrame,Kinect::FrameBuffer());
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextDepthFrame,Kinect::FrameBuffer());
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextMesh,Kinect::MeshBuffer());
 	}
 
 void KinectPlayer::KinectStreamer::updateFrames(double currentTimeStamp)
@@ -321,7 +308,7 @@ void KinectPlayer::KinectStreamer::updateFrames(double currentTimeStamp)
 			Threads::MutexCond::Lock frameQueueLock(frameQueueCond);
 			while(numColorFrames==0)
 				frameQueueCond.wait(frameQueueLock);
-			nextColorFrame=colorFrames[(mostRecentColorFrame-numColorFrames+3)%2];
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextColorFrame,colorFrames[(mostRecentColorFrame-numColorFrames+3)%2]);
 			if(--numColorFrames==1)
 				frameQueueCond.broadcast();
 			}
@@ -334,8 +321,8 @@ void KinectPlayer::KinectStreamer::updateFrames(double currentTimeStamp)
 			Threads::MutexCond::Lock frameQueueLock(frameQueueCond);
 			while(numDepthFrames==0)
 				frameQueueCond.wait(frameQueueLock);
-			nextDepthFrame=depthFrames[(mostRecentDepthFrame-numDepthFrames+3)%2];
-			nextMesh=meshes[(mostRecentDepthFrame-numDepthFrames+3)%2];
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextDepthFrame,depthFrames[(mostRecentDepthFrame-numDepthFrames+3)%2]);
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextMesh,meshes[(mostRecentDepthFrame-numDepthFrames+3)%2]);
 			if(--numDepthFrames==1)
 				frameQueueCond.broadcast();
 			}
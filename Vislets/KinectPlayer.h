@@ -31,6 +31,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/MutexCond.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <Sound/SoundDataFormat.h>
+#include <Kinect/MemoryAccounting.h>
 #include <Kinect/FrameBuffer.h>
 #include <Kinect/MeshBuffer.h>
 #include <Kinect/ProjectorHeader.h>
@@ -102,6 +103,7 @@ class KinectPlayer:public Vrui::Vislet
 		Kinect::ProjectorType projector; // Projector to render a combined depth/color frame
 		Threads::MutexCond timeStampCond; // Condition variable to signal a change in the next time stamp value
 		double readAheadTimeStamp; // Time stamp up to which to read ahead in the depth and color files
+		Kinect::MemoryAccounting::Tag memoryTag; // Holder tag for frames and meshes in the read-ahead queues
 		Threads::MutexCond frameQueueCond; // Condition variable to signal arrival of a new depth or color frame
 		Kinect::FrameBuffer colorFrames[2]; // The two most recently read depth frames
 		int numColorFrames; // Number of color frames in queue
@@ -77,6 +77,12 @@ KinectRecorderFactory::KinectRecorderFactory(Vrui::VisletManager& visletManager)
 		config.maxDepth=kds.retrieveValue<unsigned int>("./maxDepth",0);
 		config.backgroundRemovalFuzz=kds.retrieveValue<int>("./backgroundRemovalFuzz",-1000000);
 		
+		/* Read the depth stream codec: */
+		config.depthCodec=Kinect::parseDepthFrameCodec(kds.retrieveString("./depthCodec",Kinect::getDepthFrameCodecName(Kinect::DEPTH_CODEC_HUFFMAN)).c_str());
+		
+		/* Read the per-frame metadata flag: */
+		config.saveFrameMetadata=kds.retrieveValue<bool>("./saveFrameMetadata",false);
+		
 		/* Store the configuration structure: */
 		kinectConfigs.push_back(config);
 		}
@@ -201,7 +207,11 @@ KinectRecorder::KinectStreamer::KinectStreamer(const KinectRecorderFactory::Kine
 	colorFrameFileName.push_back('-');
 	colorFrameFileName.append(config.deviceSerialNumber);
 	colorFrameFileName.append(".color");
-	frameSaver=new Kinect::FrameSaver(camera,colorFrameFileName.c_str(),depthFrameFileName.c_str());
+	frameSaver=new Kinect::FrameSaver(camera,colorFrameFileName.c_str(),depthFrameFileName.c_str(),config.depthCodec,Kinect::COLOR_CODEC_THEORA,config.saveFrameMetadata);
+	
+	/* Pass the camera's compressed depth frames through to the frame saver if the depth stream uses the camera's native format, and only decode them for background or floor removal or if the frame saver needs them: */
+	if(config.depthCodec==Kinect::DEPTH_CODEC_KINECTV1)
+		camera.setRawDepthStreamingCallback(Misc::createFunctionCall(frameSaver,&Kinect::FrameSaver::saveRawDepthFrame),frameSaver->needsDecodedDepthFrames());
 	}
 
 KinectRecorder::KinectStreamer::~KinectStreamer(void)
@@ -28,6 +28,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <vector>
 #include <Sound/SoundDataFormat.h>
 #include <Kinect/Camera.h>
+#include <Kinect/DepthFrameCodecs.h>
 #include <Vrui/Vislet.h>
 
 /* Forward declarations: */
@@ -59,6 +60,8 @@ class KinectRecorderFactory:public Vrui::VisletFactory
 		unsigned int captureBackgroundFrames; // Number of background frames to capture for background removal
 		unsigned int maxDepth; // Depth cutoff value for background removal
 		int backgroundRemovalFuzz; // Fuzz value for background removal
+		Kinect::DepthFrameCodec depthCodec; // Codec to compress recorded depth streams
+		bool saveFrameMetadata; // Flag whether to record per-frame device metadata alongside the color and depth streams
 		};
 	
 	struct SoundConfig // Structure containing configuration data for sound recording
@@ -31,6 +31,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/StdError.h>
 #include <Misc/FunctionCalls.h>
 #include <Misc/PrintInteger.h>
+#include <Misc/FileTests.h>
 #include <Misc/ValueCoder.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
@@ -41,7 +42,6 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Geometry/GeometryMarshallers.h>
 #include <GL/gl.h>
 #include <GL/GLTransformationWrappers.h>
-#include <Video/Config.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/InputDevice.h>
 #include <Vrui/DisplayState.h>
@@ -50,13 +50,14 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Kinect/FunctionCalls.h>
 #include <Kinect/Camera.h>
 #include <Kinect/OpenDirectFrameSource.h>
-#include <Kinect/DepthFrameReader.h>
-#if VIDEO_CONFIG_HAVE_THEORA
-#include <Kinect/LossyDepthFrameReader.h>
-#endif
-#include <Kinect/ColorFrameReader.h>
+#include <Kinect/FrameReader.h>
+#include <Kinect/ColorFrameCodecs.h>
+#include <Kinect/DepthFrameCodecs.h>
+#include <Kinect/FrameFileHeaders.h>
 #include <Kinect/MultiplexedFrameSource.h>
 #include <Kinect/FrameSaver.h>
+#include <Kinect/PoseTrackWriter.h>
+#include <Kinect/PoseTrackReader.h>
 
 /************************************
 Methods of class KinectViewerFactory:
@@ -265,7 +266,8 @@ KinectViewer::TrackedRenderer::TrackedRenderer(Kinect::FrameSource* sSource,Vrui
 	 trackingDevice(sTrackingDevice),
 	 trackingBufferSize(2048),timeStampBuffer(new double[trackingBufferSize]),trackingBuffer(new Vrui::TrackerState[trackingBufferSize]),
 	 numTrackingBufferEntries(0),tail(0),
-	 meshTimeStamp(0.0),meshTrackerState(Vrui::TrackerState::identity)
+	 meshTimeStamp(0.0),meshTrackerState(Vrui::TrackerState::identity),
+	 poseTrackWriter(0)
 	{
 	}
 
@@ -274,6 +276,9 @@ KinectViewer::TrackedRenderer::~TrackedRenderer(void)
 	/* Delete the tracking buffer: */
 	delete[] timeStampBuffer;
 	delete[] trackingBuffer;
+	
+	/* Destroy the pose track writer: */
+	delete poseTrackWriter;
 	}
 
 void KinectViewer::TrackedRenderer::startStreaming(const Kinect::FrameSource::Time& timeBase)
@@ -291,6 +296,11 @@ void KinectViewer::TrackedRenderer::frame(double newTimeStamp)
 	Kinect::FrameSource::Time now;
 	timeStampBuffer[tail]=double(now-sourceTimeBase);
 	trackingBuffer[tail]=trackingDevice->getTransformation();
+	if(poseTrackWriter!=0)
+		{
+		/* Save the device position/orientation in the time base of the saved streams: */
+		poseTrackWriter->writePose(timeStampBuffer[tail],Kinect::PoseTrackWriter::Pose(trackingBuffer[tail]));
+		}
 	if(numTrackingBufferEntries<trackingBufferSize)
 		++numTrackingBufferEntries;
 	if(++tail==trackingBufferSize)
@@ -342,6 +352,20 @@ void KinectViewer::TrackedRenderer::glRenderAction(GLContextData& contextData) c
 	glPopMatrix();
 	}
 
+void KinectViewer::TrackedRenderer::saveStreams(const std::string& saveFileName)
+	{
+	/* Call the base class method: */
+	LiveRenderer::saveStreams(saveFileName);
+	
+	/* Save the tracking device's positions/orientations alongside the streams if the frame saver was created: */
+	if(frameSaver!=0&&poseTrackWriter==0)
+		{
+		std::string poseFileName=saveFileName;
+		poseFileName.append(".pose");
+		poseTrackWriter=new Kinect::PoseTrackWriter(poseFileName.c_str());
+		}
+	}
+
 /**********************************************
 Methods of class KinectViewer::SynchedRenderer:
 **********************************************/
@@ -367,7 +391,7 @@ void* KinectViewer::SynchedRenderer::colorReaderThreadMethod(void)
 		while(numColorFrames==numQueueSlots)
 			colorFrameQueueFullCond.wait(frameQueueMutex);
 		mostRecentColorFrame=(mostRecentColorFrame+1)%numQueueSlots;
-		colorFrames[mostRecentColorFrame]=nextFrame;
+		Kinect::MemoryAccounting::assignHeld(memoryTag,colorFrames[mostRecentColorFrame],nextFrame);
 		if(++numColorFrames==1)
 			frameQueuesEmptyCond.broadcast();
 		}
@@ -402,7 +426,7 @@ void* KinectViewer::SynchedRenderer::depthReaderThreadMethod(void)
 		while(numDepthFrames==numQueueSlots)
 			depthFrameQueueFullCond.wait(frameQueueMutex);
 		mostRecentDepthFrame=(mostRecentDepthFrame+1)%numQueueSlots;
-		depthFrames[mostRecentDepthFrame]=nextFrame;
+		Kinect::MemoryAccounting::assignHeld(memoryTag,depthFrames[mostRecentDepthFrame],nextFrame);
 		
 		if(++numDepthFrames==1)
 			frameQueuesEmptyCond.broadcast();
@@ -420,8 +444,8 @@ void* KinectViewer::SynchedRenderer::depthReaderThreadMethod(void)
 		while(numDepthFrames==numQueueSlots)
 			depthFrameQueueFullCond.wait(frameQueueMutex);
 		mostRecentDepthFrame=(mostRecentDepthFrame+1)%numQueueSlots;
-		depthFrames[mostRecentDepthFrame]=nextFrame;
-		meshes[mostRecentDepthFrame]=nextMesh;
+		Kinect::MemoryAccounting::assignHeld(memoryTag,depthFrames[mostRecentDepthFrame],nextFrame);
+		Kinect::MemoryAccounting::assignHeld(memoryTag,meshes[mostRecentDepthFrame],nextMesh);
 		if(++numDepthFrames==1)
 			frameQueuesEmptyCond.broadcast();
 		}
@@ -440,6 +464,7 @@ KinectViewer::SynchedRenderer::SynchedRenderer(const std::string& fileName,doubl
 	 started(false),
 	 timeStampBase(0.0),colorFrameOffset(sColorFrameOffset),depthFrameOffset(sDepthFrameOffset),
 	 timeStamp(0.0),
+	 memoryTag(Kinect::MemoryAccounting::registerTag("SynchedRenderer")),
 	 numColorFrames(0),mostRecentColorFrame(0),
 	 numDepthFrames(0),mostRecentDepthFrame(0)
 	{
@@ -455,76 +480,45 @@ KinectViewer::SynchedRenderer::SynchedRenderer(const std::string& fileName,doubl
 	depthFile=IO::openFile(depthFileName.c_str());
 	depthFile->setEndianness(Misc::LittleEndian);
 	
-	/* Read the files' format version numbers: */
-	unsigned int colorFormatVersion=colorFile->read<Misc::UInt32>();
-	unsigned int depthFormatVersion=depthFile->read<Misc::UInt32>();
-	if(colorFormatVersion>2||depthFormatVersion>6)
-		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unsupported 3D video file format");
+	/* Read the files' headers: */
+	Kinect::ColorFileHeader colorFileHeader(*colorFile);
+	Kinect::DepthFileHeader depthFileHeader(*depthFile);
 	
-	/* Check if there are per-pixel depth correction coefficients: */
-	Kinect::FrameSource::DepthCorrection* depthCorrection=0;
-	if(depthFormatVersion>=4)
+	/* Take the depth correction parameters, or create a dummy depth correction object if the file has none: */
+	Kinect::FrameSource::DepthCorrection* depthCorrection=depthFileHeader.detachDepthCorrection();
+	if(depthCorrection!=0&&!depthCorrection->isValid())
 		{
-		/* Read new B-spline based depth correction parameters: */
-		depthCorrection=new Kinect::FrameSource::DepthCorrection(*depthFile);
-		if(!depthCorrection->isValid())
-			{
-			delete depthCorrection;
-			depthCorrection=0;
-			}
+		delete depthCorrection;
+		depthCorrection=0;
 		}
-	else
-		{
-		if(depthFormatVersion>=2&&depthFile->read<Misc::UInt8>()!=0)
-			{
-			/* Skip the depth correction buffer: */
-			Kinect::Size size;
-			depthFile->read<Misc::UInt32,unsigned int>(size.getComponents(),2);
-			depthFile->skip<Misc::Float32>(size.volume()*2);
-			}
-		
-		/* Create a dummy depth correction object: */
+	if(depthFileHeader.formatVersion<4)
 		depthCorrection=new Kinect::FrameSource::DepthCorrection(0,Kinect::Size(1,1));
-		}
-	
-	/* Check if the depth stream uses lossy compression: */
-	bool depthIsLossy=depthFormatVersion>=3&&depthFile->read<Misc::UInt8>()!=0;
 	
-	/* Read the color and depth projections from their respective files: */
+	/* Retrieve the color and depth cameras' intrinsic parameters: */
 	Kinect::FrameSource::IntrinsicParameters ips;
-	
-	/* Read the color camera's lens distortion correction parameters if they are present: */
-	if(colorFormatVersion>=2)
-		ips.colorLensDistortion=ips.readLensDistortion(*colorFile,true);
-	
-	/* Read the depth camera's lens distortion correction parameters if they are present: */
-	if(depthFormatVersion>=5)
-		ips.depthLensDistortion=ips.readLensDistortion(*depthFile,depthFormatVersion>=6);
-	
-	/* Read the intrinsic projection matrices: */
-	ips.colorProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(*colorFile);
-	ips.depthProjection=Misc::Marshaller<Kinect::FrameSource::IntrinsicParameters::PTransform>::read(*depthFile);
+	ips.colorLensDistortion=colorFileHeader.lensDistortion;
+	ips.depthLensDistortion=depthFileHeader.lensDistortion;
+	ips.colorProjection=colorFileHeader.projection;
+	ips.depthProjection=depthFileHeader.projection;
 	
 	/* Update the intrinsic parameter transformations: */
 	ips.updateTransforms();
 	
-	/* Read the camera transformation from the depth file: */
-	Kinect::FrameSource::ExtrinsicParameters eps;
-	eps=Misc::Marshaller<Kinect::FrameSource::ExtrinsicParameters>::read(*depthFile);
+	/* Retrieve the camera transformation from the depth file: */
+	Kinect::FrameSource::ExtrinsicParameters eps=depthFileHeader.extrinsicParameters;
 	
 	/* Create the color and depth readers: */
-	colorReader=new Kinect::ColorFrameReader(*colorFile);
-	if(depthIsLossy)
+	colorReader=colorFileHeader.createReader(*colorFile);
+	try
+		{
+		depthReader=depthFileHeader.createReader(*depthFile);
+		}
+	catch(...)
 		{
-		#if VIDEO_CONFIG_HAVE_THEORA
-		depthReader=new Kinect::LossyDepthFrameReader(*depthFile);
-		#else
 		delete colorReader;
-		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Lossy depth compression not supported due to lack of Theora library");
-		#endif
+		colorReader=0;
+		throw;
 		}
-	else
-		depthReader=new Kinect::DepthFrameReader(*depthFile);
 	
 	/* Create and initialize the projector: */
 	projector=new Kinect::ProjectorType();
@@ -533,9 +527,9 @@ KinectViewer::SynchedRenderer::SynchedRenderer(const std::string& fileName,doubl
 	projector->setIntrinsicParameters(ips);
 	projector->setExtrinsicParameters(eps);
 	#if KINECT_CONFIG_USE_PROJECTOR2||KINECT_CONFIG_USE_SHADERPROJECTOR
-	projector->setColorSpace(Kinect::FrameSource::YPCBCR);
+	projector->setColorSpace(Kinect::getColorSpace(*colorReader));
 	#else
-	static_cast<Kinect::ColorFrameReader*>(colorReader)->setConvertToRgb(true);
+	Kinect::setConvertToRgb(*colorReader,true);
 	#endif
 	
 	/* Clean up: */
@@ -556,6 +550,21 @@ KinectViewer::SynchedRenderer::~SynchedRenderer(void)
 	/* Delete the color and depth readers: */
 	delete colorReader;
 	delete depthReader;
+	
+	/* Release the frames and meshes in the read-ahead queues: */
+	for(int i=0;i<numQueueSlots;++i)
+		{
+		Kinect::MemoryAccounting::assignHeld(memoryTag,colorFrames[i],Kinect::FrameBuffer());
+		Kinect::MemoryAccounting::assignHeld(memoryTag,depthFrames[i],Kinect::FrameBuffer());
+		#if !KINECT_CONFIG_USE_SHADERPROJECTOR
+		Kinect::MemoryAccounting::assignHeld(memoryTag,meshes[i],Kinect::MeshBuffer());
+		#endif
+		}
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextColorFrame,Kinect::FrameBuffer());
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextDepthFrame,Kinect::FrameBuffer());
+	#if !KINECT_CONFIG_USE_SHADERPROJECTOR
+	Kinect::MemoryAccounting::assignHeld(memoryTag,nextMesh,Kinect::MeshBuffer());
+	#endif
 	}
 
 void KinectViewer::SynchedRenderer::startStreaming(const Kinect::FrameSource::Time& timeBase)
@@ -595,7 +604,7 @@ void KinectViewer::SynchedRenderer::frame(double newTimeStamp)
 			{
 			newColor=true;
 			currentColorFrame=nextColorFrame;
-			nextColorFrame=colorFrames[(mostRecentColorFrame-numColorFrames+numQueueSlots+1)%numQueueSlots];
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextColorFrame,colorFrames[(mostRecentColorFrame-numColorFrames+numQueueSlots+1)%numQueueSlots]);
 			if(--numColorFrames==numQueueSlots-1)
 				colorFrameQueueFullCond.broadcast();
 			}
@@ -605,10 +614,10 @@ void KinectViewer::SynchedRenderer::frame(double newTimeStamp)
 			{
 			newDepth=true;
 			currentDepthFrame=nextDepthFrame;
-			nextDepthFrame=depthFrames[(mostRecentDepthFrame-numDepthFrames+numQueueSlots+1)%numQueueSlots];
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextDepthFrame,depthFrames[(mostRecentDepthFrame-numDepthFrames+numQueueSlots+1)%numQueueSlots]);
 			#if !KINECT_CONFIG_USE_SHADERPROJECTOR
 			currentMesh=nextMesh;
-			nextMesh=meshes[(mostRecentDepthFrame-numDepthFrames+numQueueSlots+1)%numQueueSlots];
+			Kinect::MemoryAccounting::assignHeld(memoryTag,nextMesh,meshes[(mostRecentDepthFrame-numDepthFrames+numQueueSlots+1)%numQueueSlots]);
 			#endif
 			if(--numDepthFrames==numQueueSlots-1)
 				depthFrameQueueFullCond.broadcast();
@@ -637,8 +646,26 @@ Methods of class KinectViewer::TrackedSynchedRenderer:
 
 KinectViewer::TrackedSynchedRenderer::TrackedSynchedRenderer(const std::string& fileName,Vrui::InputDevice* sTrackingDevice,double sColorFrameOffset,double sDepthFrameOffset)
 	:SynchedRenderer(fileName,sColorFrameOffset,sDepthFrameOffset),
-	 trackingDevice(sTrackingDevice)
+	 trackingDevice(sTrackingDevice),poseTrack(0),
+	 trackingState(Vrui::TrackerState::identity)
+	{
+	/* Check if a pose track was recorded alongside the 3D video stream file: */
+	std::string poseFileName=fileName;
+	poseFileName.append(".pose");
+	if(Misc::doesPathExist(poseFileName.c_str()))
+		{
+		/* Replay the recorded pose track instead of the tracking device: */
+		poseTrack=new Kinect::PoseTrackReader(poseFileName.c_str());
+		std::cout<<"KinectViewer: Replaying "<<poseTrack->getNumSamples()<<" recorded camera poses from "<<poseFileName<<std::endl;
+		}
+	else if(trackingDevice==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"No tracking device and no recorded pose track for 3D video stream file %s",fileName.c_str());
+	}
+
+KinectViewer::TrackedSynchedRenderer::~TrackedSynchedRenderer(void)
 	{
+	/* Destroy the pose track: */
+	delete poseTrack;
 	}
 
 void KinectViewer::TrackedSynchedRenderer::frame(double newTimeStamp)
@@ -646,11 +673,19 @@ void KinectViewer::TrackedSynchedRenderer::frame(double newTimeStamp)
 	/* Call the base class method: */
 	SynchedRenderer::frame(newTimeStamp);
 	
-	/* Check if there is new depth data for this frame: */
-	// if(haveNewDepth())
+	if(poseTrack!=0)
 		{
-		/* Sample the tracking device and keep its state until a new depth frame arrives: */
-		trackingState=trackingDevice->getTransformation();
+		/* Interpolate the recorded pose at the capture time of the current depth frame: */
+		trackingState=Vrui::TrackerState(poseTrack->getPose(projector->getMeshTimeStamp()-getDepthFrameOffset()));
+		}
+	else
+		{
+		/* Check if there is new depth data for this frame: */
+		// if(haveNewDepth())
+			{
+			/* Sample the tracking device and keep its state until a new depth frame arrives: */
+			trackingState=trackingDevice->getTransformation();
+			}
 		}
 	}
 
@@ -973,7 +1008,9 @@ KinectViewer::KinectViewer(int numArguments,const char* const arguments[])
 				{
 				/* Add a synchronized renderer for the given video file: */
 				SynchedRenderer* newRenderer;
-				if(cameraTrackingDevice!=0)
+				std::string poseFileName=arguments[i];
+				poseFileName.append(".pose");
+				if(cameraTrackingDevice!=0||Misc::doesPathExist(poseFileName.c_str()))
 					{
 					/* Create a tracked synched renderer: */
 					newRenderer=new TrackedSynchedRenderer(arguments[i],cameraTrackingDevice,colorFrameOffset,depthFrameOffset);
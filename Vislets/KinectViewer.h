@@ -37,6 +37,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/ToolManager.h>
 #include <Vrui/Vislet.h>
 #include <Kinect/Config.h>
+#include <Kinect/MemoryAccounting.h>
 #include <Kinect/FrameSource.h>
 #include <Kinect/ProjectorHeader.h>
 
@@ -52,6 +53,8 @@ class MeshBuffer;
 #endif
 class FrameSaver;
 class FrameReader;
+class PoseTrackWriter;
+class PoseTrackReader;
 }
 
 class KinectViewer;
@@ -126,7 +129,7 @@ class KinectViewer:public Vrui::Vislet
 		virtual void frame(double newTimeStamp);
 		
 		/* New methods: */
-		void saveStreams(const std::string& saveFileName); // Prepares the renderer to save streams to a pair of files of the given name
+		virtual void saveStreams(const std::string& saveFileName); // Prepares the renderer to save streams to a pair of files of the given name
 		};
 	
 	class TrackedRenderer:public LiveRenderer // Class to render 3D video from a "live" source that is attached to a tracked input device
@@ -143,6 +146,7 @@ class KinectViewer:public Vrui::Vislet
 		size_t tail; // Index behind newest sample in tracking buffer
 		double meshTimeStamp; // Time stamp of the triangle mesh currently locked for rendering
 		Vrui::TrackerState meshTrackerState; // Tracked device position/orientation to display the triangle mesh currently locked in the projector
+		Kinect::PoseTrackWriter* poseTrackWriter; // Writer to save tracking device positions/orientations alongside saved streams, or null
 		
 		/* Constructors and destructors: */
 		TrackedRenderer(Kinect::FrameSource* sSource,Vrui::InputDevice* sTrackingDevice); // Creates a renderer for the given 3D video source and tracked input device and saves streams from source if save file name is non-empty; adopts source object
@@ -152,6 +156,9 @@ class KinectViewer:public Vrui::Vislet
 		virtual void startStreaming(const Kinect::FrameSource::Time& timeBase);
 		virtual void frame(double newTimeStamp);
 		virtual void glRenderAction(GLContextData& contextData) const;
+		
+		/* Methods from LiveRenderer: */
+		virtual void saveStreams(const std::string& saveFileName);
 		};
 	
 	class SynchedRenderer:public Renderer // Class to render 3D video from a time-synchronized 3D video stream file
@@ -172,6 +179,7 @@ class KinectViewer:public Vrui::Vislet
 		
 		double timeStamp; // Current display time stamp
 		static const int numQueueSlots=3; // Number of frames that can be read ahead from the input files
+		Kinect::MemoryAccounting::Tag memoryTag; // Holder tag for frames and meshes in the read-ahead queues
 		Threads::Mutex frameQueueMutex; // Mutex protecting the frame queue state and the condition variables
 		Threads::Cond frameQueuesEmptyCond; // Condition variable to wait when both frame queues are empty
 		
@@ -212,6 +220,10 @@ class KinectViewer:public Vrui::Vislet
 			{
 			return newDepth;
 			}
+		double getDepthFrameOffset(void) const // Returns the time offset applied to depth frames
+			{
+			return depthFrameOffset;
+			}
 		};
 	
 	class TrackedSynchedRenderer:public SynchedRenderer // Class to render 3D video recorded with a tracked camera from a time-synchronized 3D video stream file
@@ -219,11 +231,13 @@ class KinectViewer:public Vrui::Vislet
 		/* Elements: */
 		private:
 		Vrui::InputDevice* trackingDevice; // Pointer to the tracking device to which the synched source is attached
+		Kinect::PoseTrackReader* poseTrack; // Pose track recorded alongside the 3D video stream file, or null to use the tracking device
 		Vrui::TrackerState trackingState; // State of the tracking device at the time the current depth frame appeared
 		
 		/* Constructors and destructors: */
 		public:
-		TrackedSynchedRenderer(const std::string& fileName,Vrui::InputDevice* sTrackingDevice,double sColorFrameOffset,double sDepthFrameOffset); // Creates a renderer for the given 3D video stream file and tracked input device
+		TrackedSynchedRenderer(const std::string& fileName,Vrui::InputDevice* sTrackingDevice,double sColorFrameOffset,double sDepthFrameOffset); // Creates a renderer for the given 3D video stream file and tracked input device; replays the stream file's pose track instead of the tracking device if one was recorded
+		virtual ~TrackedSynchedRenderer(void);
 		
 		/* Methods from Renderer: */
 		virtual void frame(double newTimeStamp);